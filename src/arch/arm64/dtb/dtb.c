@@ -162,6 +162,7 @@ typedef struct {
     uint32_t size_cells;    /**< #size-cells for current node */
     int      depth;         /**< Current node depth */
     char     path[256];     /**< Current node path */
+    char     node_full[DTB_MAX_NAME_LEN];  /**< Current node name with unit address */
 } parse_context_t;
 
 /* ============================================================================
@@ -300,35 +301,46 @@ static void parse_property(parse_context_t *ctx, const char *node_name,
         return;
     }
     
-    /* Track other devices */
-    if (dtb_strcmp(prop_name, "compatible") == 0 && 
-        g_dtb_info.num_devices < DTB_MAX_DEVICES) {
-        /* Check if we already have this device */
-        for (uint32_t i = 0; i < g_dtb_info.num_devices; i++) {
-            if (dtb_strcmp(g_dtb_info.devices[i].name, node_name) == 0) {
-                return; /* Already tracked */
-            }
+    /* Track other devices, keyed by full node name (with unit address) so
+     * that repeated nodes such as the virtio_mmio slots stay distinct.
+     * Properties may precede "compatible", so the entry is created by
+     * whichever of compatible/reg/interrupts comes first. */
+    if (dtb_strcmp(prop_name, "compatible") != 0 &&
+        dtb_strcmp(prop_name, "reg") != 0 &&
+        dtb_strcmp(prop_name, "interrupts") != 0) {
+        return;
+    }
+
+    dtb_device_t *dev = NULL;
+    for (uint32_t i = 0; i < g_dtb_info.num_devices; i++) {
+        if (dtb_strcmp(g_dtb_info.devices[i].name, ctx->node_full) == 0) {
+            dev = &g_dtb_info.devices[i];
+            break;
         }
-        
-        uint32_t idx = g_dtb_info.num_devices++;
-        dtb_strncpy(g_dtb_info.devices[idx].name, node_name, DTB_MAX_NAME_LEN);
-        g_dtb_info.devices[idx].valid = true;
     }
-    
-    if (dtb_strcmp(prop_name, "reg") == 0) {
-        /* Find the device entry and update its address */
-        for (uint32_t i = 0; i < g_dtb_info.num_devices; i++) {
-            if (dtb_strcmp(g_dtb_info.devices[i].name, node_name) == 0 &&
-                g_dtb_info.devices[i].base_addr == 0) {
-                uint64_t base, size;
-                if (parse_reg_property(data, len, ctx->addr_cells, ctx->size_cells,
-                                       &base, &size)) {
-                    g_dtb_info.devices[i].base_addr = base;
-                    g_dtb_info.devices[i].size = size;
-                }
-                break;
+    if (dev == NULL) {
+        if (g_dtb_info.num_devices >= DTB_MAX_DEVICES) {
+            return;
+        }
+        dev = &g_dtb_info.devices[g_dtb_info.num_devices++];
+        dtb_strncpy(dev->name, ctx->node_full, DTB_MAX_NAME_LEN);
+    }
+
+    if (dtb_strcmp(prop_name, "compatible") == 0) {
+        dev->valid = true;
+    } else if (dtb_strcmp(prop_name, "reg") == 0) {
+        if (dev->base_addr == 0) {
+            uint64_t base, size;
+            if (parse_reg_property(data, len, ctx->addr_cells, ctx->size_cells,
+                                   &base, &size)) {
+                dev->base_addr = base;
+                dev->size = size;
             }
         }
+    } else if (len >= 8 && dev->irq == 0) {
+        /* GIC binding: <type number flags>, type 0 = SPI (+32), 1 = PPI (+16) */
+        uint32_t type = be32_to_cpu(data[0]);
+        dev->irq = be32_to_cpu(data[1]) + (type == 0 ? 32 : 16);
     }
 }
 
@@ -346,6 +358,7 @@ static bool parse_structure_block(const uint8_t *struct_block,
     ctx.size_cells = 1;
     ctx.depth = 0;
     ctx.path[0] = '\0';
+    ctx.node_full[0] = '\0';
     
     const uint32_t *p = (const uint32_t *)struct_block;
     const uint32_t *end = (const uint32_t *)(struct_block + struct_size);
@@ -363,6 +376,7 @@ static bool parse_structure_block(const uint8_t *struct_block,
                 p = (const uint32_t *)((uintptr_t)p + align4(name_len + 1));
                 
                 /* Extract node name without unit address */
+                dtb_strncpy(ctx.node_full, name, sizeof(ctx.node_full));
                 dtb_strncpy(current_node, name, sizeof(current_node));
                 char *at = current_node;
                 while (*at && *at != '@') at++;
@@ -375,6 +389,7 @@ static bool parse_structure_block(const uint8_t *struct_block,
             case FDT_END_NODE:
                 ctx.depth--;
                 current_node[0] = '\0';
+                ctx.node_full[0] = '\0';
                 break;
             
             case FDT_PROP: {
@@ -490,9 +505,12 @@ bool dtb_is_valid(void) {
 }
 
 const dtb_device_t *dtb_find_device(const char *compatible) {
+    size_t n = dtb_strlen(compatible);
     for (uint32_t i = 0; i < g_dtb_info.num_devices; i++) {
-        if (g_dtb_info.devices[i].valid &&
-            dtb_strcmp(g_dtb_info.devices[i].name, compatible) == 0) {
+        const char *name = g_dtb_info.devices[i].name;
+        /* Match the full node name or the name without unit address */
+        if (g_dtb_info.devices[i].valid && dtb_strstart(name, compatible) &&
+            (name[n] == '\0' || name[n] == '@')) {
             return &g_dtb_info.devices[i];
         }
     }
@@ -98,8 +98,8 @@ typedef struct {
  * Device Information
  * ========================================================================== */
 
-/** Maximum number of devices we can track */
-#define DTB_MAX_DEVICES     16
+/** Maximum number of devices we can track (QEMU virt alone has 32 virtio_mmio slots) */
+#define DTB_MAX_DEVICES     64
 
 /** Maximum device name length */
 #define DTB_MAX_NAME_LEN    32
@@ -15,10 +15,19 @@
  * 
  * For QEMU virt machine, the UART is at 0x09000000 with IRQ 33.
  * 
+ * Output is polled until serial_enable_tx_irq() is called. After that,
+ * characters go into a TX ring; the caller tops up the FIFO and leaves
+ * the TX interrupt unmasked while the ring is non-empty so the IRQ
+ * handler keeps draining it. A full ring drops new characters (counted
+ * in tx_dropped) instead of blocking. Panic mode bypasses the lock and
+ * drains the ring synchronously.
+ * 
  * Requirements: 9.3 - ARM64 device discovery and drivers
  */
 
 #include <drivers/arm/serial.h>
+#include <hal/hal.h>
+#include <kernel/sync/spinlock.h>
 #include <types.h>
 
 /* ============================================================================
@@ -123,6 +132,21 @@ static inline void pl011_write(uint32_t offset, uint32_t value) {
 
 static bool serial_initialized = false;
 
+/* ============================================================================
+ * TX Ring State
+ * ========================================================================== */
+
+/** Serializes producers against the TX interrupt handler */
+static spinlock_t serial_lock;
+
+/** TX ring; head/tail run freely and are masked on access */
+static char tx_ring[SERIAL_TX_RING_SIZE];
+static uint32_t tx_head;
+static uint32_t tx_tail;
+static bool tx_irq_enabled;
+static volatile bool serial_panicking;
+static serial_stats_t serial_stats;
+
 /* ============================================================================
  * Public API Implementation
  * ========================================================================== */
@@ -213,13 +237,9 @@ bool serial_is_initialized(void) {
 }
 
 /**
- * @brief Output a single character
- * 
- * Waits for the transmit FIFO to have space, then writes the character.
- * 
- * @param c Character to output
+ * @brief Poll one character out, waiting for FIFO space
  */
-void serial_putchar(char c) {
+static void serial_putchar_polled(char c) {
     /* Wait until transmit FIFO is not full */
     while (pl011_read(PL011_FR) & PL011_FR_TXFF) {
         __asm__ volatile("nop");
@@ -227,6 +247,67 @@ void serial_putchar(char c) {
     
     /* Write character to data register */
     pl011_write(PL011_DR, (uint32_t)c);
+    serial_stats.tx_bytes++;
+}
+
+/**
+ * @brief Move ring contents into the TX FIFO (serial_lock held)
+ * 
+ * The TX interrupt fires when the FIFO level drains past the trigger
+ * level, so it is only left unmasked while there is more to send.
+ */
+static void serial_tx_fill(void) {
+    while (tx_head != tx_tail && !(pl011_read(PL011_FR) & PL011_FR_TXFF)) {
+        pl011_write(PL011_DR, (uint32_t)tx_ring[tx_tail++ & (SERIAL_TX_RING_SIZE - 1)]);
+        serial_stats.tx_bytes++;
+    }
+    
+    uint32_t imsc = pl011_read(PL011_IMSC);
+    uint32_t want = (tx_head != tx_tail) ? (imsc | PL011_INT_TX) : (imsc & ~PL011_INT_TX);
+    if (want != imsc) {
+        pl011_write(PL011_IMSC, want);
+    }
+}
+
+/**
+ * @brief Queue one character (serial_lock held)
+ */
+static void serial_emit(char c) {
+    uint32_t used = tx_head - tx_tail;
+    if (used >= SERIAL_TX_RING_SIZE) {
+        /* The caller may have interrupts off; see if the FIFO has room */
+        serial_tx_fill();
+        used = tx_head - tx_tail;
+    }
+    if (used >= SERIAL_TX_RING_SIZE) {
+        serial_stats.tx_dropped++;
+        return;
+    }
+    tx_ring[tx_head++ & (SERIAL_TX_RING_SIZE - 1)] = c;
+    if (used + 1 > serial_stats.ring_high) {
+        serial_stats.ring_high = used + 1;
+    }
+}
+
+/**
+ * @brief Output a single character
+ * 
+ * Before serial_enable_tx_irq() (possibly with the MMU still off, where
+ * exclusive accesses are not usable) the character is polled out without
+ * taking the lock, as is everything in panic mode.
+ * 
+ * @param c Character to output
+ */
+void serial_putchar(char c) {
+    if (serial_panicking || !tx_irq_enabled) {
+        serial_putchar_polled(c);
+        return;
+    }
+    bool irq_state;
+    spinlock_lock_irqsave(&serial_lock, &irq_state);
+    serial_emit(c);
+    serial_tx_fill();
+    spinlock_unlock_irqrestore(&serial_lock, irq_state);
 }
 
 /**
@@ -241,12 +322,26 @@ void serial_print(const char *msg) {
         return;
     }
     
+    if (serial_panicking || !tx_irq_enabled) {
+        while (*msg) {
+            if (*msg == '\n') {
+                serial_putchar_polled('\r');
+            }
+            serial_putchar_polled(*msg++);
+        }
+        return;
+    }
+    
+    bool irq_state;
+    spinlock_lock_irqsave(&serial_lock, &irq_state);
     while (*msg) {
         if (*msg == '\n') {
-            serial_putchar('\r');
+            serial_emit('\r');
         }
-        serial_putchar(*msg++);
+        serial_emit(*msg++);
     }
+    serial_tx_fill();
+    spinlock_unlock_irqrestore(&serial_lock, irq_state);
 }
 
 /**
@@ -294,11 +389,25 @@ int serial_getchar_nonblock(void) {
 }
 
 /**
- * @brief Flush the transmit FIFO
+ * @brief Flush the TX ring and the transmit FIFO
  * 
  * Waits until all pending transmissions are complete.
  */
 void serial_flush(void) {
+    if (tx_irq_enabled && !serial_panicking) {
+        for (;;) {
+            bool irq_state;
+            spinlock_lock_irqsave(&serial_lock, &irq_state);
+            serial_tx_fill();
+            bool empty = (tx_head == tx_tail);
+            spinlock_unlock_irqrestore(&serial_lock, irq_state);
+            if (empty) {
+                break;
+            }
+            cpu_relax();
+        }
+    }
+    
     /* Wait until transmit FIFO is empty and UART is not busy */
     while (!(pl011_read(PL011_FR) & PL011_FR_TXFE) ||
            (pl011_read(PL011_FR) & PL011_FR_BUSY)) {
@@ -306,6 +415,60 @@ void serial_flush(void) {
     }
 }
 
+/* ============================================================================
+ * Interrupt-Driven Transmit
+ * ========================================================================== */
+
+/**
+ * @brief PL011 interrupt handler: acknowledge TX and keep draining the ring
+ */
+static void serial_irq_handler(void *data) {
+    (void)data;
+    spinlock_lock(&serial_lock);
+    if (pl011_read(PL011_MIS) & PL011_INT_TX) {
+        pl011_write(PL011_ICR, PL011_INT_TX);
+        serial_stats.tx_irqs++;
+    }
+    serial_tx_fill();
+    spinlock_unlock(&serial_lock);
+}
+
+/**
+ * @brief Switch to interrupt-driven transmit
+ */
+void serial_enable_tx_irq(void) {
+    hal_interrupt_register(PL011_IRQ, serial_irq_handler, NULL);
+    
+    bool irq_state;
+    spinlock_lock_irqsave(&serial_lock, &irq_state);
+    tx_irq_enabled = true;
+    spinlock_unlock_irqrestore(&serial_lock, irq_state);
+}
+
+/**
+ * @brief Enter panic mode
+ * 
+ * Interrupts must already be disabled. The lock holder may never release
+ * it, so the ring is drained without taking it.
+ */
+void serial_panic_mode(void) {
+    serial_panicking = true;
+    pl011_write(PL011_IMSC, pl011_read(PL011_IMSC) & ~PL011_INT_TX);
+    while (tx_head != tx_tail) {
+        serial_putchar_polled(tx_ring[tx_tail++ & (SERIAL_TX_RING_SIZE - 1)]);
+    }
+}
+
+/**
+ * @brief Get transmit statistics
+ * @param stats Output
+ */
+void serial_get_stats(serial_stats_t *stats) {
+    if (stats) {
+        *stats = serial_stats;
+    }
+}
+
 /* ============================================================================
  * Hex Output Helpers (for debugging)
  * ========================================================================== */
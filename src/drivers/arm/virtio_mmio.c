@@ -0,0 +1,228 @@
+/**
+ * @file virtio_mmio.c
+ * @brief VirtIO MMIO transport for ARM64
+ *
+ * Transports are discovered from the device tree ("virtio_mmio@..." nodes,
+ * one per slot on QEMU's virt machine; empty slots report device ID 0).
+ * Both the legacy (v1) and modern (v2) register layouts are supported:
+ * v1 registers the queue by page frame number with a 4KB used-ring
+ * alignment, v2 takes the three ring addresses separately. The queue
+ * memory layout from virtqueue.c satisfies both.
+ *
+ * Like virtio_gpu.c, the device window is accessed through its physical
+ * address (the low device region is identity mapped).
+ */
+
+#include <drivers/common/virtio.h>
+#include <drivers/common/virtqueue.h>
+#include <hal/hal.h>
+#include <lib/klog.h>
+#include <lib/kprintf.h>
+#include <lib/string.h>
+#include <dtb.h>
+
+#define VIRTIO_MMIO_MAX_DEVICES     8
+#define VIRTIO_MMIO_NODE_PREFIX     "virtio_mmio@"
+
+static virtio_device_t virtio_mmio_devices[VIRTIO_MMIO_MAX_DEVICES];
+static uint32_t virtio_mmio_device_count = 0;
+
+/* ============================================================================
+ * MMIO Access Helpers
+ * ========================================================================== */
+
+static inline uint32_t virtio_mmio_read32(virtio_device_t *vdev, uint32_t offset) {
+    return *(volatile uint32_t *)(vdev->base + offset);
+}
+
+static inline void virtio_mmio_write32(virtio_device_t *vdev, uint32_t offset, uint32_t value) {
+    *(volatile uint32_t *)(vdev->base + offset) = value;
+}
+
+/* ============================================================================
+ * Transport Operations
+ * ========================================================================== */
+
+static uint8_t virtio_mmio_get_status(virtio_device_t *vdev) {
+    return (uint8_t)virtio_mmio_read32(vdev, VIRTIO_MMIO_STATUS);
+}
+
+static void virtio_mmio_set_status(virtio_device_t *vdev, uint8_t status) {
+    virtio_mmio_write32(vdev, VIRTIO_MMIO_STATUS, status);
+}
+
+static uint64_t virtio_mmio_get_features(virtio_device_t *vdev) {
+    virtio_mmio_write32(vdev, VIRTIO_MMIO_DEVICE_FEATURES_SEL, 0);
+    uint64_t features = virtio_mmio_read32(vdev, VIRTIO_MMIO_DEVICE_FEATURES);
+    if (!vdev->legacy) {
+        virtio_mmio_write32(vdev, VIRTIO_MMIO_DEVICE_FEATURES_SEL, 1);
+        features |= (uint64_t)virtio_mmio_read32(vdev, VIRTIO_MMIO_DEVICE_FEATURES) << 32;
+    }
+    return features;
+}
+
+static void virtio_mmio_set_features(virtio_device_t *vdev, uint64_t features) {
+    virtio_mmio_write32(vdev, VIRTIO_MMIO_DRIVER_FEATURES_SEL, 0);
+    virtio_mmio_write32(vdev, VIRTIO_MMIO_DRIVER_FEATURES, (uint32_t)features);
+    if (!vdev->legacy) {
+        virtio_mmio_write32(vdev, VIRTIO_MMIO_DRIVER_FEATURES_SEL, 1);
+        virtio_mmio_write32(vdev, VIRTIO_MMIO_DRIVER_FEATURES, (uint32_t)(features >> 32));
+    }
+}
+
+static uint8_t virtio_mmio_read_config8(virtio_device_t *vdev, uint32_t offset) {
+    return *(volatile uint8_t *)(vdev->base + VIRTIO_MMIO_CONFIG + offset);
+}
+
+static void virtio_mmio_write_config8(virtio_device_t *vdev, uint32_t offset, uint8_t value) {
+    *(volatile uint8_t *)(vdev->base + VIRTIO_MMIO_CONFIG + offset) = value;
+}
+
+static uint16_t virtio_mmio_queue_size(virtio_device_t *vdev, uint16_t index) {
+    virtio_mmio_write32(vdev, VIRTIO_MMIO_QUEUE_SEL, index);
+    uint32_t max = virtio_mmio_read32(vdev, VIRTIO_MMIO_QUEUE_NUM_MAX);
+    if (max == 0) {
+        return 0;
+    }
+
+    /* The driver picks the size: largest power of two we support */
+    uint32_t num = VIRTQ_MAX_SIZE;
+    while (num > max) {
+        num >>= 1;
+    }
+    return (uint16_t)num;
+}
+
+static int virtio_mmio_queue_setup(virtio_device_t *vdev, virtqueue_t *vq) {
+    virtio_mmio_write32(vdev, VIRTIO_MMIO_QUEUE_SEL, vq->index);
+    virtio_mmio_write32(vdev, VIRTIO_MMIO_QUEUE_NUM, vq->num);
+
+    if (vdev->legacy) {
+        uint64_t pfn = (uint64_t)vq->ring_phys >> PAGE_SHIFT;
+        if (pfn > 0xFFFFFFFFULL) {
+            return -1;
+        }
+        virtio_mmio_write32(vdev, VIRTIO_MMIO_QUEUE_ALIGN, VIRTQ_ALIGN);
+        virtio_mmio_write32(vdev, VIRTIO_MMIO_QUEUE_PFN, (uint32_t)pfn);
+        return 0;
+    }
+
+    uint64_t desc = vq->ring_phys;
+    uint64_t avail = vq->avail_phys;
+    uint64_t used = vq->used_phys;
+    virtio_mmio_write32(vdev, VIRTIO_MMIO_QUEUE_DESC_LOW, (uint32_t)desc);
+    virtio_mmio_write32(vdev, VIRTIO_MMIO_QUEUE_DESC_HIGH, (uint32_t)(desc >> 32));
+    virtio_mmio_write32(vdev, VIRTIO_MMIO_QUEUE_AVAIL_LOW, (uint32_t)avail);
+    virtio_mmio_write32(vdev, VIRTIO_MMIO_QUEUE_AVAIL_HIGH, (uint32_t)(avail >> 32));
+    virtio_mmio_write32(vdev, VIRTIO_MMIO_QUEUE_USED_LOW, (uint32_t)used);
+    virtio_mmio_write32(vdev, VIRTIO_MMIO_QUEUE_USED_HIGH, (uint32_t)(used >> 32));
+    virtio_mmio_write32(vdev, VIRTIO_MMIO_QUEUE_READY, 1);
+    return 0;
+}
+
+static void virtio_mmio_notify(virtio_device_t *vdev, uint16_t index) {
+    __asm__ volatile("dsb sy" ::: "memory");
+    virtio_mmio_write32(vdev, VIRTIO_MMIO_QUEUE_NOTIFY, index);
+}
+
+static uint32_t virtio_mmio_ack_interrupt(virtio_device_t *vdev) {
+    uint32_t status = virtio_mmio_read32(vdev, VIRTIO_MMIO_INTERRUPT_STATUS);
+    if (status != 0) {
+        virtio_mmio_write32(vdev, VIRTIO_MMIO_INTERRUPT_ACK, status);
+    }
+    return status;
+}
+
+static void virtio_mmio_irq(void *data) {
+    virtio_device_t *vdev = (virtio_device_t *)data;
+    if (virtio_mmio_ack_interrupt(vdev) != 0 && vdev->irq_handler != NULL) {
+        vdev->irq_handler(vdev);
+    }
+}
+
+static int virtio_mmio_enable_irq(virtio_device_t *vdev) {
+    if (vdev->irq == 0) {
+        return -1;
+    }
+    hal_interrupt_register(vdev->irq, virtio_mmio_irq, vdev);
+    return 0;
+}
+
+static const virtio_transport_ops_t virtio_mmio_ops = {
+    .get_status     = virtio_mmio_get_status,
+    .set_status     = virtio_mmio_set_status,
+    .get_features   = virtio_mmio_get_features,
+    .set_features   = virtio_mmio_set_features,
+    .read_config8   = virtio_mmio_read_config8,
+    .write_config8  = virtio_mmio_write_config8,
+    .queue_size     = virtio_mmio_queue_size,
+    .queue_setup    = virtio_mmio_queue_setup,
+    .notify         = virtio_mmio_notify,
+    .ack_interrupt  = virtio_mmio_ack_interrupt,
+    .enable_irq     = virtio_mmio_enable_irq,
+};
+
+/* ============================================================================
+ * Device Discovery
+ * ========================================================================== */
+
+int virtio_scan(uint32_t device_id, virtio_probe_t probe) {
+    if (probe == NULL) {
+        return 0;
+    }
+
+    dtb_info_t *info = dtb_get_info();
+    if (info == NULL || !info->valid) {
+        LOG_WARN_MSG("virtio-mmio: no device tree\n");
+        return 0;
+    }
+
+    int claimed = 0;
+    size_t prefix_len = strlen(VIRTIO_MMIO_NODE_PREFIX);
+    for (uint32_t i = 0; i < info->num_devices; i++) {
+        const dtb_device_t *node = &info->devices[i];
+        if (!node->valid || node->base_addr == 0 ||
+            strncmp(node->name, VIRTIO_MMIO_NODE_PREFIX, prefix_len) != 0) {
+            continue;
+        }
+
+        volatile uint8_t *base = (volatile uint8_t *)(uintptr_t)node->base_addr;
+        uint32_t magic = *(volatile uint32_t *)(base + VIRTIO_MMIO_MAGIC_VALUE);
+        uint32_t version = *(volatile uint32_t *)(base + VIRTIO_MMIO_VERSION);
+        uint32_t id = *(volatile uint32_t *)(base + VIRTIO_MMIO_DEVICE_ID);
+        if (magic != VIRTIO_MMIO_MAGIC || id != device_id) {
+            continue;
+        }
+        if (version != 1 && version != 2) {
+            LOG_WARN_MSG("virtio-mmio: %s has unsupported version %u\n", node->name, version);
+            continue;
+        }
+        if (virtio_mmio_device_count >= VIRTIO_MMIO_MAX_DEVICES) {
+            LOG_WARN_MSG("virtio-mmio: too many devices\n");
+            break;
+        }
+
+        virtio_device_t *vdev = &virtio_mmio_devices[virtio_mmio_device_count];
+        memset(vdev, 0, sizeof(*vdev));
+        ksnprintf(vdev->name, sizeof(vdev->name), "mmio@%llx",
+                  (unsigned long long)node->base_addr);
+        vdev->ops = &virtio_mmio_ops;
+        vdev->device_id = device_id;
+        vdev->legacy = (version == 1);
+        vdev->base = (uintptr_t)base;
+        vdev->irq = node->irq;
+
+        if (vdev->legacy) {
+            virtio_mmio_write32(vdev, VIRTIO_MMIO_GUEST_PAGE_SIZE, PAGE_SIZE);
+        }
+
+        virtio_mmio_device_count++;
+        if (probe(vdev) == 0) {
+            claimed++;
+        } else {
+            virtio_mmio_set_status(vdev, 0);
+            virtio_mmio_device_count--;
+        }
+    }
+    return claimed;
+}
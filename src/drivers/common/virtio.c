@@ -0,0 +1,64 @@
+/**
+ * VirtIO 设备初始化的公共步骤（与传输层无关）
+ *
+ * 复位 -> ACKNOWLEDGE | DRIVER -> 特性协商（modern 需 FEATURES_OK 确认）
+ * -> 驱动建立队列 -> DRIVER_OK。
+ */
+
+#include <drivers/common/virtio.h>
+#include <lib/klog.h>
+
+void virtio_reset(virtio_device_t *vdev) {
+    vdev->ops->set_status(vdev, 0);
+    vdev->ops->set_status(vdev, VIRTIO_STATUS_ACKNOWLEDGE);
+    vdev->ops->set_status(vdev, VIRTIO_STATUS_ACKNOWLEDGE | VIRTIO_STATUS_DRIVER);
+}
+
+int virtio_negotiate(virtio_device_t *vdev, uint64_t wanted) {
+    uint64_t offered = vdev->ops->get_features(vdev);
+    if (!vdev->legacy) {
+        wanted |= VIRTIO_FEATURE(VIRTIO_F_VERSION_1);
+    }
+    vdev->features = offered & wanted;
+    if (!vdev->legacy && !virtio_has_feature(vdev, VIRTIO_F_VERSION_1)) {
+        LOG_ERROR_MSG("virtio: %s does not offer VERSION_1\n", vdev->name);
+        return -1;
+    }
+    vdev->ops->set_features(vdev, vdev->features);
+
+    if (vdev->legacy) {
+        return 0;
+    }
+    uint8_t status = vdev->ops->get_status(vdev);
+    vdev->ops->set_status(vdev, status | VIRTIO_STATUS_FEATURES_OK);
+    if (!(vdev->ops->get_status(vdev) & VIRTIO_STATUS_FEATURES_OK)) {
+        LOG_ERROR_MSG("virtio: %s rejected features 0x%llx\n",
+                      vdev->name, (unsigned long long)vdev->features);
+        return -1;
+    }
+    return 0;
+}
+
+void virtio_driver_ok(virtio_device_t *vdev) {
+    uint8_t status = vdev->ops->get_status(vdev);
+    vdev->ops->set_status(vdev, status | VIRTIO_STATUS_DRIVER_OK);
+}
+
+void virtio_fail(virtio_device_t *vdev) {
+    uint8_t status = vdev->ops->get_status(vdev);
+    vdev->ops->set_status(vdev, status | VIRTIO_STATUS_FAILED);
+}
+
+uint32_t virtio_config_read32(virtio_device_t *vdev, uint32_t offset) {
+    uint32_t value = 0;
+    for (uint32_t i = 0; i < 4; i++) {
+        value |= (uint32_t)vdev->ops->read_config8(vdev, offset + i) << (i * 8);
+    }
+    return value;
+}
+
+uint64_t virtio_config_read64(virtio_device_t *vdev, uint32_t offset) {
+    uint64_t lo = virtio_config_read32(vdev, offset);
+    uint64_t hi = virtio_config_read32(vdev, offset + 4);
+    return lo | (hi << 32);
+}
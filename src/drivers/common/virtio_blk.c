@@ -0,0 +1,405 @@
+/**
+ * VirtIO 块设备驱动
+ *
+ * 每个请求由三部分组成：请求头（设备读）、数据段、状态字节（设备写）。
+ * 请求头和状态字节放在每设备一页的 DMA 区里，按请求槽编号；数据段直接
+ * 指向调用者缓冲区，按页拆分并合并物理连续的页。协商了间接描述符时
+ * 一个请求只占环上一个描述符，同时在途的请求数只受请求槽数限制。
+ *
+ * 驱动挂在块设备请求队列（fs/bio.h）上：队列合并、排序后的请求经
+ * virtio_blk_submit_rq 入环，一轮派发结束时才通知设备，队列深度等于请求槽数。
+ * 提交与回收都在 vq.lock（关中断）下进行；完成中断和等待者的轮询都调用
+ * virtio_blk_reap 回收已用环，在锁外用 blk_request_done 完成请求。
+ */
+
+#include <drivers/common/virtio_blk.h>
+#include <drivers/common/virtio.h>
+#include <drivers/common/virtqueue.h>
+#include <drivers/timer.h>
+#include <fs/blockdev.h>
+#include <fs/bio.h>
+#include <mm/pmm.h>
+#include <mm/vmm.h>
+#include <lib/klog.h>
+#include <lib/kprintf.h>
+#include <lib/string.h>
+
+#define VIRTIO_BLK_MAX_SEGS     (VIRTQ_INDIRECT_MAX - 2)   // 每个请求的数据段数
+#define VIRTIO_BLK_TIMEOUT_MS   5000    // 在途请求无进展超过此时间即放弃设备
+
+typedef struct virtio_blk_req_hdr {
+    uint32_t type;
+    uint32_t reserved;
+    uint64_t sector;
+} __attribute__((packed)) virtio_blk_req_hdr_t;
+
+/* DMA 区中每个请求槽的头和状态 */
+typedef struct virtio_blk_dma {
+    virtio_blk_req_hdr_t hdr;
+    volatile uint8_t status;
+    uint8_t pad[15];
+} __attribute__((packed)) virtio_blk_dma_t;
+
+typedef struct virtio_blk_req {
+    blk_request_t *rq;
+    uint32_t slot;
+} virtio_blk_req_t;
+
+typedef struct virtio_blk_dev {
+    virtio_device_t *vdev;
+    virtqueue_t vq;
+    blockdev_t bdev;
+    uint64_t capacity;
+    uint32_t seg_max;
+    bool read_only;
+    bool broken;                        // 请求超时后不再使用
+
+    virtio_blk_dma_t *dma;
+    paddr_t dma_phys;
+    virtio_blk_req_t reqs[VIRTIO_BLK_MAX_REQS];
+    uint64_t slot_free;                 // 空闲请求槽位图（vq.lock 保护）
+    uint32_t inflight;
+    uint64_t last_progress;             // 上次提交（空闲时）或回收的时间
+
+    virtio_blk_stats_t stats;
+} virtio_blk_dev_t;
+
+static virtio_blk_dev_t virtio_blk_devs[VIRTIO_BLK_MAX_DEVICES];
+static uint32_t virtio_blk_count = 0;
+
+/* ============================================================================
+ * 完成回收
+ * ============================================================================ */
+
+static void virtio_blk_reap(virtio_blk_dev_t *dev) {
+    blk_request_t *done[VIRTIO_BLK_MAX_REQS];
+    int status[VIRTIO_BLK_MAX_REQS];
+    uint32_t reaped = 0;
+    bool irq_state;
+    spinlock_lock_irqsave(&dev->vq.lock, &irq_state);
+
+    virtio_blk_req_t *req;
+    while ((req = (virtio_blk_req_t *)virtqueue_get_used(&dev->vq, NULL)) != NULL) {
+        uint8_t st = dev->dma[req->slot].status;
+        if (st != VIRTIO_BLK_S_OK) {
+            dev->stats.errors++;
+        }
+        if (req->rq != NULL) {
+            done[reaped] = req->rq;
+            status[reaped] = st == VIRTIO_BLK_S_OK ? 0 : -1;
+            reaped++;
+            req->rq = NULL;
+        }
+        dev->slot_free |= 1ULL << req->slot;
+        dev->inflight--;
+        dev->last_progress = timer_get_uptime_ms();
+    }
+
+    spinlock_unlock_irqrestore(&dev->vq.lock, irq_state);
+
+    // 完成会调用 end_io、唤醒等待者和 kblockd，必须在锁外调用
+    for (uint32_t i = 0; i < reaped; i++) {
+        if (status[i] != 0) {
+            LOG_ERROR_MSG("virtio-blk: %s %s sectors %u-%u failed\n", dev->bdev.name,
+                          done[i]->write ? "write" : "read", done[i]->sector,
+                          done[i]->sector + done[i]->count - 1);
+        }
+        blk_request_done(done[i], status[i]);
+    }
+}
+
+static void virtio_blk_irq(virtio_device_t *vdev) {
+    virtio_blk_dev_t *dev = (virtio_blk_dev_t *)vdev->priv;
+    dev->stats.irqs++;
+    virtio_blk_reap(dev);
+}
+
+/*
+ * 超时后放弃所有在途请求：以失败完成，设备不再使用
+ * 先复位设备收回描述符，否则调用者释放或复用缓冲区后设备仍可能写入
+ */
+static void virtio_blk_abandon(virtio_blk_dev_t *dev) {
+    blk_request_t *pending[VIRTIO_BLK_MAX_REQS];
+    uint32_t n = 0;
+
+    dev->vdev->ops->set_status(dev->vdev, 0);
+    for (uint32_t spin = 0; spin < 100000 && dev->vdev->ops->get_status(dev->vdev) != 0; spin++) {
+        cpu_relax();
+    }
+
+    bool irq_state;
+    spinlock_lock_irqsave(&dev->vq.lock, &irq_state);
+    for (uint32_t i = 0; i < VIRTIO_BLK_MAX_REQS; i++) {
+        if (dev->reqs[i].rq != NULL) {
+            pending[n++] = dev->reqs[i].rq;
+            dev->reqs[i].rq = NULL;
+        }
+    }
+    dev->broken = true;
+    spinlock_unlock_irqrestore(&dev->vq.lock, irq_state);
+
+    LOG_ERROR_MSG("virtio-blk: %s request timeout, device reset and disabled\n", dev->bdev.name);
+    for (uint32_t i = 0; i < n; i++) {
+        blk_request_done(pending[i], -1);
+    }
+}
+
+/* 等待者的轮询：中断丢失时回收完成，设备长时间没有进展时放弃 */
+static void virtio_blk_poll(void *dev_ptr) {
+    virtio_blk_dev_t *dev = (virtio_blk_dev_t *)dev_ptr;
+    virtio_blk_reap(dev);
+    if (dev->inflight != 0 && !dev->broken &&
+        timer_get_uptime_ms() - dev->last_progress >= VIRTIO_BLK_TIMEOUT_MS) {
+        virtio_blk_abandon(dev);
+    }
+}
+
+/* ============================================================================
+ * 提交
+ * ============================================================================ */
+
+static void virtio_blk_kick(virtio_blk_dev_t *dev) {
+    bool irq_state;
+    spinlock_lock_irqsave(&dev->vq.lock, &irq_state);
+    bool need = virtqueue_kick_prepare(&dev->vq);
+    dev->stats.kicks = dev->vq.kicks;
+    dev->stats.kicks_suppressed = dev->vq.kicks_suppressed;
+    spinlock_unlock_irqrestore(&dev->vq.lock, irq_state);
+
+    if (need) {
+        virtqueue_notify(&dev->vq);
+    }
+}
+
+/* 把缓冲区按页拆成物理段，返回覆盖的整扇区数（0 表示地址无法转换） */
+static uint32_t virtio_blk_map(virtio_blk_dev_t *dev, uint8_t *buffer, uint32_t max_sectors,
+                               virtq_sg_t *sg, uint32_t *nseg) {
+    uintptr_t virt = (uintptr_t)buffer;
+    uint32_t bytes = max_sectors * VIRTIO_BLK_SECTOR_SIZE;
+    if (bytes > VIRTIO_BLK_REQ_MAX_BYTES) {
+        bytes = VIRTIO_BLK_REQ_MAX_BYTES;
+    }
+
+    uint32_t n = 0;
+    uint32_t total = 0;
+    while (total < bytes) {
+        uint32_t chunk = PAGE_SIZE - (uint32_t)(virt & (PAGE_SIZE - 1));
+        if (chunk > bytes - total) {
+            chunk = bytes - total;
+        }
+        uintptr_t phys = vmm_virt_to_phys(virt);
+        if (phys == 0) {
+            break;
+        }
+        if (n > 0 && sg[n - 1].addr + sg[n - 1].len == phys) {
+            sg[n - 1].len += chunk;         // 物理连续，并入上一段
+        } else if (n < dev->seg_max) {
+            sg[n].addr = phys;
+            sg[n].len = chunk;
+            n++;
+        } else {
+            break;
+        }
+        total += chunk;
+        virt += chunk;
+    }
+
+    // 段数用完时可能停在扇区中间，截掉不足一个扇区的尾部
+    uint32_t tail = total % VIRTIO_BLK_SECTOR_SIZE;
+    while (tail > 0 && n > 0) {
+        uint32_t cut = tail < sg[n - 1].len ? tail : sg[n - 1].len;
+        sg[n - 1].len -= cut;
+        tail -= cut;
+        total -= cut;
+        if (sg[n - 1].len == 0) {
+            n--;
+        }
+    }
+
+    *nseg = n;
+    return total / VIRTIO_BLK_SECTOR_SIZE;
+}
+
+/**
+ * 请求队列的派发回调：一个 blk 请求对应一个 virtio 请求
+ * 队列的 max_sectors 保证缓冲区在段数限制内能完整映射
+ * @return 0 已提交，1 没有空闲槽位或描述符，-1 失败
+ */
+static int virtio_blk_submit_rq(void *dev_ptr, blk_request_t *rq) {
+    virtio_blk_dev_t *dev = (virtio_blk_dev_t *)dev_ptr;
+    if (dev->broken || (rq->write && dev->read_only)) {
+        return -1;
+    }
+
+    virtq_sg_t sg[VIRTIO_BLK_MAX_SEGS + 2];
+    uint32_t nseg = 0;
+    uint32_t sectors = virtio_blk_map(dev, rq->buffer, rq->count, &sg[1], &nseg);
+    if (sectors != rq->count) {
+        LOG_ERROR_MSG("virtio-blk: buffer %p not usable for DMA\n", rq->buffer);
+        return -1;
+    }
+
+    bool irq_state;
+    spinlock_lock_irqsave(&dev->vq.lock, &irq_state);
+
+    if (dev->slot_free == 0) {
+        spinlock_unlock_irqrestore(&dev->vq.lock, irq_state);
+        virtio_blk_kick(dev);
+        return 1;
+    }
+    uint32_t slot = (uint32_t)__builtin_ctzll(dev->slot_free);
+
+    virtio_blk_dma_t *dma = &dev->dma[slot];
+    dma->hdr.type = rq->write ? VIRTIO_BLK_T_OUT : VIRTIO_BLK_T_IN;
+    dma->hdr.reserved = 0;
+    dma->hdr.sector = rq->sector;
+    dma->status = 0xFF;
+
+    paddr_t dma_phys = dev->dma_phys + slot * sizeof(virtio_blk_dma_t);
+    sg[0].addr = dma_phys;
+    sg[0].len = sizeof(virtio_blk_req_hdr_t);
+    sg[nseg + 1].addr = dma_phys + offsetof(virtio_blk_dma_t, status);
+    sg[nseg + 1].len = 1;
+
+    virtio_blk_req_t *req = &dev->reqs[slot];
+    req->rq = rq;
+    req->slot = slot;
+
+    uint16_t out = (uint16_t)(rq->write ? 1 + nseg : 1);
+    uint16_t in = (uint16_t)(rq->write ? 1 : nseg + 1);
+    if (virtqueue_add(&dev->vq, sg, out, in, req) != 0) {
+        req->rq = NULL;
+        spinlock_unlock_irqrestore(&dev->vq.lock, irq_state);
+        virtio_blk_kick(dev);
+        return 1;
+    }
+
+    dev->slot_free &= ~(1ULL << slot);
+    if (dev->inflight++ == 0) {
+        dev->last_progress = timer_get_uptime_ms();
+    }
+    dev->stats.requests++;
+    if (dev->inflight > dev->stats.max_inflight) {
+        dev->stats.max_inflight = dev->inflight;
+    }
+
+    spinlock_unlock_irqrestore(&dev->vq.lock, irq_state);
+
+    // 一轮派发的请求全部入环后只通知设备一次
+    if (rq->last) {
+        virtio_blk_kick(dev);
+    }
+    return 0;
+}
+
+/* ============================================================================
+ * 探测与注册
+ * ============================================================================ */
+
+static int virtio_blk_probe(virtio_device_t *vdev) {
+    if (virtio_blk_count >= VIRTIO_BLK_MAX_DEVICES) {
+        return -1;
+    }
+    virtio_blk_dev_t *dev = &virtio_blk_devs[virtio_blk_count];
+    memset(dev, 0, sizeof(*dev));
+    dev->vdev = vdev;
+
+    virtio_reset(vdev);
+    uint64_t wanted = VIRTIO_FEATURE(VIRTIO_BLK_F_SEG_MAX) |
+                      VIRTIO_FEATURE(VIRTIO_BLK_F_RO) |
+                      VIRTIO_FEATURE(VIRTIO_BLK_F_BLK_SIZE) |
+                      VIRTIO_FEATURE(VIRTIO_F_INDIRECT_DESC) |
+                      VIRTIO_FEATURE(VIRTIO_F_EVENT_IDX);
+    if (virtio_negotiate(vdev, wanted) != 0) {
+        virtio_fail(vdev);
+        return -1;
+    }
+
+    dev->capacity = virtio_config_read64(vdev, VIRTIO_BLK_CFG_CAPACITY);
+    dev->read_only = virtio_has_feature(vdev, VIRTIO_BLK_F_RO);
+    dev->seg_max = VIRTIO_BLK_MAX_SEGS;
+    if (virtio_has_feature(vdev, VIRTIO_BLK_F_SEG_MAX)) {
+        uint32_t seg_max = virtio_config_read32(vdev, VIRTIO_BLK_CFG_SEG_MAX);
+        if (seg_max != 0 && seg_max < dev->seg_max) {
+            dev->seg_max = seg_max;
+        }
+    }
+
+    dev->dma_phys = pmm_alloc_frame();
+    if (dev->dma_phys == PADDR_INVALID) {
+        virtio_fail(vdev);
+        return -1;
+    }
+    dev->dma = (virtio_blk_dma_t *)PHYS_TO_VIRT(dev->dma_phys);
+    memset(dev->dma, 0, PAGE_SIZE);
+
+    if (virtqueue_init(&dev->vq, vdev, 0) != 0) {
+        pmm_free_frame(dev->dma_phys);
+        virtio_fail(vdev);
+        return -1;
+    }
+
+    // 请求槽不多于环大小；没有间接描述符时由 virtqueue_add 限制描述符
+    uint32_t slots = dev->vq.num < VIRTIO_BLK_MAX_REQS ? dev->vq.num : VIRTIO_BLK_MAX_REQS;
+    dev->slot_free = slots >= 64 ? ~0ULL : ((1ULL << slots) - 1);
+
+    vdev->priv = dev;
+    vdev->irq_handler = virtio_blk_irq;
+    bool have_irq = vdev->ops->enable_irq(vdev) == 0;
+    virtio_driver_ok(vdev);
+
+    blockdev_t *bdev = &dev->bdev;
+    ksnprintf(bdev->name, sizeof(bdev->name), "vd%c", 'a' + virtio_blk_count);
+    bdev->private_data = dev;
+    bdev->block_size = VIRTIO_BLK_SECTOR_SIZE;
+    // blockdev 以 32 位扇区号寻址，更大的设备只使用前 2TB
+    bdev->total_sectors = dev->capacity > 0xFFFFFFFFULL ? 0xFFFFFFFFU : (uint32_t)dev->capacity;
+    bdev->read = NULL;
+    bdev->write = NULL;
+    bdev->get_size = NULL;
+    bdev->get_block_size = NULL;
+    bdev->submit = virtio_blk_submit_rq;
+    bdev->poll = virtio_blk_poll;
+
+    // 每个请求槽一个在途请求；最坏情况下缓冲区每页一段，据此限制请求大小
+    uint32_t max_sectors = (dev->seg_max - 1) * (PAGE_SIZE / VIRTIO_BLK_SECTOR_SIZE);
+    if (blk_queue_init(bdev, slots) != 0 || blockdev_register(bdev) != 0) {
+        LOG_WARN_MSG("virtio-blk: failed to register %s\n", bdev->name);
+        blk_queue_destroy(bdev);
+        vdev->ops->set_status(vdev, 0);
+        virtqueue_destroy(&dev->vq);
+        pmm_free_frame(dev->dma_phys);
+        return -1;
+    }
+    if (max_sectors < bdev->queue->max_sectors) {
+        bdev->queue->max_sectors = max_sectors;
+    }
+
+    LOG_INFO_MSG("virtio-blk: %s at %s, %llu sectors (approx %llu MB)%s, queue %u, "
+                 "%u slots, seg_max %u%s%s, irq %u%s\n",
+                 bdev->name, vdev->name, (unsigned long long)dev->capacity,
+                 (unsigned long long)(dev->capacity / 2048),
+                 dev->read_only ? " read-only" : "", dev->vq.num, slots, dev->seg_max,
+                 dev->vq.use_indirect ? ", indirect" : "",
+                 dev->vq.use_event_idx ? ", event-idx" : "",
+                 vdev->irq, have_irq ? "" : " (polling)");
+    virtio_blk_count++;
+    return 0;
+}
+
+int virtio_blk_init(void) {
+    return virtio_scan(VIRTIO_DEV_BLK, virtio_blk_probe);
+}
+
+int virtio_blk_get_stats(const char *name, virtio_blk_stats_t *stats) {
+    if (name == NULL || stats == NULL) {
+        return -1;
+    }
+    for (uint32_t i = 0; i < virtio_blk_count; i++) {
+        if (strcmp(virtio_blk_devs[i].bdev.name, name) == 0) {
+            *stats = virtio_blk_devs[i].stats;
+            return 0;
+        }
+    }
+    return -1;
+}
@@ -0,0 +1,664 @@
+/**
+ * VirtIO 网卡驱动
+ *
+ * 队列 0 接收、队列 1 发送。接收缓冲区来自驱动自己的 netbuf 池，每个
+ * 缓冲区一个可写描述符，设备把包头和帧一起写入 data 区；收到的包换上
+ * 新的池缓冲区后直接上交协议栈。包跨多个缓冲区（MRG_RXBUF）时复制
+ * 合并，原缓冲区重新挂回接收环。
+ *
+ * 发送的包头放在每设备一页的包头区中（每个发送槽 16 字节），数据段
+ * 指向 netbuf 的线性区和页分片；间接描述符下一个包只占一个环描述符。
+ * 发送队列关闭完成中断，已发送的 netbuf 在下一次发送或接收中断时回收。
+ *
+ * 接收在中断里处理；另有 10ms 的定时轮询兜底，legacy INTx 线被其他
+ * 驱动接管时网卡仍能收包。
+ */
+
+#include <drivers/common/virtio_net.h>
+#include <drivers/common/virtio.h>
+#include <drivers/common/virtqueue.h>
+#include <drivers/timer.h>
+#include <net/netdev.h>
+#include <net/netbuf.h>
+#include <net/ethernet.h>
+#include <mm/pmm.h>
+#include <lib/klog.h>
+#include <lib/kprintf.h>
+#include <lib/string.h>
+
+#define VIRTIO_NET_RX_BUDGET        64      // 每轮上交的包数
+#define VIRTIO_NET_LINEAR_SEGS      4       // 线性区最多拆成的物理段
+#define VIRTIO_NET_TX_SEGS          (1 + VIRTIO_NET_LINEAR_SEGS + NETBUF_MAX_FRAGS)
+#define VIRTIO_NET_TX_SPIN          10000   // 发送环满时回收重试次数
+#define VIRTIO_NET_HDR_STRIDE       16
+#define VIRTIO_NET_MAX_FRAME        1518
+#define VIRTIO_NET_MAX_GSO          65535
+#define VIRTIO_NET_POLL_MS          10
+
+typedef struct virtio_net_tx_slot {
+    netbuf_t *buf;
+    uint16_t index;
+} virtio_net_tx_slot_t;
+
+typedef struct virtio_net_dev {
+    virtio_device_t *vdev;
+    netdev_t netdev;
+    virtqueue_t rxq;
+    virtqueue_t txq;
+    uint32_t hdr_len;                   // 10（legacy）或 12（含 num_buffers）
+    bool mrg_rxbuf;
+
+    netbuf_pool_t rx_pool;
+
+    uint8_t *tx_hdrs;                   // 包头区，按发送槽编号
+    paddr_t tx_hdrs_phys;
+    virtio_net_tx_slot_t tx_slots[VIRTQ_MAX_SIZE];
+    uint16_t tx_free[VIRTQ_MAX_SIZE];   // 空闲发送槽栈（txq.lock 保护）
+    uint16_t tx_free_count;
+
+    virtio_net_stats_t stats;
+} virtio_net_dev_t;
+
+static virtio_net_dev_t virtio_net_devs[VIRTIO_NET_MAX_DEVICES];
+static uint32_t virtio_net_count = 0;
+
+/* ============================================================================
+ * 接收
+ * ============================================================================ */
+
+/* 把缓冲区挂到接收环上（持有 rxq.lock） */
+static int virtio_net_rx_post(virtio_net_dev_t *dev, netbuf_t *buf) {
+    virtq_sg_t sg;
+    sg.addr = netbuf_dma_addr(buf, buf->data);
+    sg.len = netbuf_tailroom(buf);
+    if (sg.addr == 0 || virtqueue_add(&dev->rxq, &sg, 0, 1, buf) != 0) {
+        return -1;
+    }
+    return 0;
+}
+
+/* 内容已取走的环上缓冲区重新挂回接收环 */
+static void virtio_net_rx_recycle(virtio_net_dev_t *dev, netbuf_t *buf) {
+    netbuf_reset(buf);
+    if (virtio_net_rx_post(dev, buf) != 0) {
+        netbuf_free(buf);
+    }
+}
+
+static void virtio_net_rx_refill(virtio_net_dev_t *dev) {
+    while (dev->rxq.num_free > 0) {
+        netbuf_t *buf = netbuf_pool_alloc(&dev->rx_pool);
+        if (buf == NULL) {
+            break;
+        }
+        if (virtio_net_rx_post(dev, buf) != 0) {
+            netbuf_free(buf);
+            break;
+        }
+    }
+}
+
+/**
+ * 根据包头标记校验和状态
+ *
+ * DATA_VALID：设备已验证。NEEDS_CSUM：来自同一宿主的包只带伪首部和，
+ * 内容本身可信，软件补全后同样视为已验证。
+ */
+static void virtio_net_rx_csum(virtio_net_dev_t *dev, const virtio_net_hdr_t *hdr,
+                               netbuf_t *pkt) {
+    if (hdr->flags & VIRTIO_NET_HDR_F_DATA_VALID) {
+        pkt->csum_flags |= NETBUF_CSUM_L4_VALID;
+        dev->stats.rx_csum_valid++;
+    } else if (hdr->flags & VIRTIO_NET_HDR_F_NEEDS_CSUM) {
+        pkt->csum_flags |= NETBUF_CSUM_PARTIAL;
+        pkt->csum_start = (uint16_t)(pkt->data - pkt->head + hdr->csum_start);
+        pkt->csum_offset = hdr->csum_offset;
+        if (netbuf_checksum_help(pkt) == 0) {
+            pkt->csum_flags |= NETBUF_CSUM_L4_VALID;
+            dev->stats.rx_csum_valid++;
+        } else {
+            pkt->csum_flags &= ~NETBUF_CSUM_PARTIAL;
+        }
+    }
+}
+
+/* 取出同一个包的后续缓冲区，复制合并到新缓冲区（持有 rxq.lock） */
+static netbuf_t *virtio_net_rx_merge(virtio_net_dev_t *dev, netbuf_t *first,
+                                     uint32_t first_len, uint16_t num_buffers) {
+    netbuf_t *pkt = netbuf_alloc(ETH_MAX_FRAME_LEN);
+    bool ok = pkt != NULL && first_len <= netbuf_tailroom(pkt);
+    if (ok) {
+        memcpy(netbuf_put(pkt, first_len), first->data + dev->hdr_len, first_len);
+    }
+    virtio_net_rx_recycle(dev, first);
+
+    // 设备一次发布整个包的全部缓冲区
+    for (uint16_t i = 1; i < num_buffers; i++) {
+        uint32_t len;
+        netbuf_t *buf = (netbuf_t *)virtqueue_get_used(&dev->rxq, &len);
+        if (buf == NULL) {
+            ok = false;
+            break;
+        }
+        if (ok && len <= netbuf_tailroom(pkt)) {
+            memcpy(netbuf_put(pkt, len), buf->data, len);
+        } else {
+            ok = false;
+        }
+        virtio_net_rx_recycle(dev, buf);
+    }
+
+    if (!ok) {
+        netbuf_free(pkt);
+        return NULL;
+    }
+    dev->stats.rx_merged++;
+    return pkt;
+}
+
+/* 处理一个已用缓冲区，返回要上交的包（持有 rxq.lock） */
+static netbuf_t *virtio_net_rx_one(virtio_net_dev_t *dev, netbuf_t *buf, uint32_t len) {
+    if (len < dev->hdr_len + ETH_HEADER_LEN || len > netbuf_tailroom(buf)) {
+        dev->stats.rx_dropped++;
+        virtio_net_rx_recycle(dev, buf);
+        return NULL;
+    }
+
+    virtio_net_hdr_t hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    memcpy(&hdr, buf->data, dev->hdr_len);
+    uint16_t num_buffers = dev->mrg_rxbuf ? hdr.num_buffers : 1;
+    uint32_t frame_len = len - dev->hdr_len;
+
+    netbuf_t *pkt;
+    if (num_buffers > 1) {
+        pkt = virtio_net_rx_merge(dev, buf, frame_len, num_buffers);
+    } else {
+        netbuf_t *fresh = netbuf_pool_alloc(&dev->rx_pool);
+        if (fresh != NULL) {
+            // 零拷贝：上交环上的缓冲区，换上新缓冲区
+            pkt = buf;
+            netbuf_put(pkt, len);
+            netbuf_pull(pkt, dev->hdr_len);
+            if (virtio_net_rx_post(dev, fresh) != 0) {
+                netbuf_free(fresh);
+            }
+            dev->stats.rx_zero_copy++;
+        } else {
+            // 池耗尽：复制出来，保留环上的缓冲区
+            pkt = netbuf_alloc(frame_len);
+            if (pkt != NULL) {
+                memcpy(netbuf_put(pkt, frame_len), buf->data + dev->hdr_len, frame_len);
+                dev->stats.rx_copied++;
+            }
+            virtio_net_rx_recycle(dev, buf);
+        }
+    }
+
+    if (pkt == NULL) {
+        dev->stats.rx_dropped++;
+        return NULL;
+    }
+    virtio_net_rx_csum(dev, &hdr, pkt);
+    pkt->dev = &dev->netdev;
+    dev->stats.rx_packets++;
+    return pkt;
+}
+
+/**
+ * 收取已用环上的包并上交协议栈
+ *
+ * 锁内只摘下包并补充接收环，上交在锁外进行（协议栈可能立即回复发送）。
+ * @return 上交的包数
+ */
+static uint32_t virtio_net_rx(virtio_net_dev_t *dev) {
+    netbuf_t *list = NULL;
+    netbuf_t **tail = &list;
+    uint32_t count = 0;
+
+    bool irq_state;
+    spinlock_lock_irqsave(&dev->rxq.lock, &irq_state);
+
+    netbuf_t *buf;
+    uint32_t len;
+    while (count < VIRTIO_NET_RX_BUDGET &&
+           (buf = (netbuf_t *)virtqueue_get_used(&dev->rxq, &len)) != NULL) {
+        netbuf_t *pkt = virtio_net_rx_one(dev, buf, len);
+        if (pkt != NULL) {
+            pkt->next = NULL;
+            *tail = pkt;
+            tail = &pkt->next;
+            count++;
+        }
+    }
+
+    virtio_net_rx_refill(dev);
+    bool kick = virtqueue_kick_prepare(&dev->rxq);
+    dev->stats.rx_kicks = dev->rxq.kicks;
+    spinlock_unlock_irqrestore(&dev->rxq.lock, irq_state);
+
+    if (kick) {
+        virtqueue_notify(&dev->rxq);
+    }
+
+    while (list != NULL) {
+        netbuf_t *next = list->next;
+        list->next = NULL;
+        netdev_receive(&dev->netdev, list);
+        list = next;
+    }
+    return count;
+}
+
+/* ============================================================================
+ * 发送
+ * ============================================================================ */
+
+/* 回收设备已发送的包（持有 txq.lock） */
+static void virtio_net_tx_reclaim(virtio_net_dev_t *dev) {
+    virtio_net_tx_slot_t *slot;
+    while ((slot = (virtio_net_tx_slot_t *)virtqueue_get_used(&dev->txq, NULL)) != NULL) {
+        netbuf_free(slot->buf);
+        slot->buf = NULL;
+        dev->tx_free[dev->tx_free_count++] = slot->index;
+    }
+}
+
+/* 线性区按页拆成物理段，物理连续的相邻页合并 */
+static int virtio_net_map_linear(netbuf_t *buf, virtq_sg_t *sg, uint16_t *nseg) {
+    uint8_t *ptr = buf->data;
+    uint32_t left = buf->len;
+    uint16_t n = 0;
+
+    while (left > 0) {
+        uint32_t chunk = PAGE_SIZE - (uint32_t)((uintptr_t)ptr & (PAGE_SIZE - 1));
+        if (chunk > left) {
+            chunk = left;
+        }
+        paddr_t phys = netbuf_dma_addr(buf, ptr);
+        if (phys == 0) {
+            return -1;
+        }
+        if (n > 0 && sg[n - 1].addr + sg[n - 1].len == phys) {
+            sg[n - 1].len += chunk;
+        } else if (n < VIRTIO_NET_LINEAR_SEGS) {
+            sg[n].addr = phys;
+            sg[n].len = chunk;
+            n++;
+        } else {
+            return -1;
+        }
+        ptr += chunk;
+        left -= chunk;
+    }
+    *nseg = n;
+    return 0;
+}
+
+/* 按 netbuf 的卸载请求填写包头 */
+static int virtio_net_tx_hdr(virtio_net_dev_t *dev, netbuf_t *buf, virtio_net_hdr_t *hdr) {
+    memset(hdr, 0, sizeof(*hdr));
+
+    if (buf->csum_flags & NETBUF_CSUM_PARTIAL) {
+        uint8_t *start = buf->head + buf->csum_start;
+        if (start < buf->data || start + buf->csum_offset + 2 > buf->tail) {
+            return -1;
+        }
+        hdr->flags = VIRTIO_NET_HDR_F_NEEDS_CSUM;
+        hdr->csum_start = (uint16_t)(start - buf->data);
+        hdr->csum_offset = buf->csum_offset;
+        dev->stats.tx_csum_offload++;
+    }
+
+    if (buf->gso_size != 0) {
+        // TSO 要求校验和同时卸载，且协议头都在线性区
+        uint8_t *tcp = (uint8_t *)buf->transport_header;
+        if (!(hdr->flags & VIRTIO_NET_HDR_F_NEEDS_CSUM) || tcp == NULL ||
+            tcp < buf->data || tcp + 20 > buf->tail) {
+            return -1;
+        }
+        uint16_t type = (uint16_t)((buf->data[12] << 8) | buf->data[13]);
+        hdr->gso_type = type == ETH_TYPE_IPV6 ? VIRTIO_NET_HDR_GSO_TCPV6 : VIRTIO_NET_HDR_GSO_TCPV4;
+        hdr->hdr_len = (uint16_t)(tcp - buf->data + (tcp[12] >> 4) * 4);
+        hdr->gso_size = buf->gso_size;
+        dev->stats.tx_tso++;
+    }
+    return 0;
+}
+
+/**
+ * 发送数据包
+ *
+ * 成功时 buf 归驱动所有，设备用完后由 virtio_net_tx_reclaim() 释放。
+ */
+static int virtio_net_transmit(netdev_t *netdev, netbuf_t *buf) {
+    virtio_net_dev_t *dev = (virtio_net_dev_t *)netdev->priv;
+
+    if (buf == NULL || buf->len == 0) {
+        return -1;
+    }
+    uint32_t limit = buf->gso_size ? VIRTIO_NET_MAX_GSO : VIRTIO_NET_MAX_FRAME;
+    if (netbuf_total_len(buf) > limit) {
+        return -1;
+    }
+
+    virtq_sg_t sg[VIRTIO_NET_TX_SEGS];
+    uint16_t nseg = 0;
+    if (virtio_net_map_linear(buf, &sg[1], &nseg) != 0) {
+        return -1;
+    }
+    nseg++;     // 包头
+    for (uint8_t i = 0; i < buf->nr_frags; i++) {
+        sg[nseg].addr = buf->frags[i].page + buf->frags[i].offset;
+        sg[nseg].len = buf->frags[i].len;
+        nseg++;
+    }
+
+    virtio_net_hdr_t hdr;
+    if (virtio_net_tx_hdr(dev, buf, &hdr) != 0) {
+        return -1;
+    }
+
+    bool irq_state;
+    spinlock_lock_irqsave(&dev->txq.lock, &irq_state);
+
+    uint16_t needed = dev->txq.use_indirect ? 1 : nseg;
+    virtio_net_tx_reclaim(dev);
+    for (int spin = 0; spin < VIRTIO_NET_TX_SPIN &&
+         (dev->tx_free_count == 0 || dev->txq.num_free < needed); spin++) {
+        virtio_net_tx_reclaim(dev);
+    }
+    if (dev->tx_free_count == 0 || dev->txq.num_free < needed) {
+        dev->stats.tx_ring_full++;
+        spinlock_unlock_irqrestore(&dev->txq.lock, irq_state);
+        LOG_WARN_MSG("virtio-net: %s TX ring full\n", netdev->name);
+        return -1;
+    }
+
+    uint16_t index = dev->tx_free[--dev->tx_free_count];
+    memcpy(dev->tx_hdrs + index * VIRTIO_NET_HDR_STRIDE, &hdr, dev->hdr_len);
+    sg[0].addr = dev->tx_hdrs_phys + index * VIRTIO_NET_HDR_STRIDE;
+    sg[0].len = dev->hdr_len;
+
+    virtio_net_tx_slot_t *slot = &dev->tx_slots[index];
+    slot->buf = buf;
+    if (virtqueue_add(&dev->txq, sg, nseg, 0, slot) != 0) {
+        slot->buf = NULL;
+        dev->tx_free[dev->tx_free_count++] = index;
+        spinlock_unlock_irqrestore(&dev->txq.lock, irq_state);
+        return -1;
+    }
+    dev->stats.tx_packets++;
+
+    bool kick = virtqueue_kick_prepare(&dev->txq);
+    dev->stats.tx_kicks = dev->txq.kicks;
+    dev->stats.tx_kicks_suppressed = dev->txq.kicks_suppressed;
+    spinlock_unlock_irqrestore(&dev->txq.lock, irq_state);
+
+    if (kick) {
+        virtqueue_notify(&dev->txq);
+    }
+    return 0;
+}
+
+/* ============================================================================
+ * 中断与轮询
+ * ============================================================================ */
+
+static void virtio_net_service(virtio_net_dev_t *dev) {
+    // 预算用完后已用环上可能还有包
+    while (virtio_net_rx(dev) == VIRTIO_NET_RX_BUDGET) {
+    }
+
+    bool irq_state;
+    spinlock_lock_irqsave(&dev->txq.lock, &irq_state);
+    virtio_net_tx_reclaim(dev);
+    spinlock_unlock_irqrestore(&dev->txq.lock, irq_state);
+}
+
+static void virtio_net_irq(virtio_device_t *vdev) {
+    virtio_net_dev_t *dev = (virtio_net_dev_t *)vdev->priv;
+    dev->stats.irqs++;
+    virtio_net_service(dev);
+}
+
+static void virtio_net_poll(void *data) {
+    virtio_net_dev_t *dev = (virtio_net_dev_t *)data;
+    if (virtqueue_has_used(&dev->rxq) || virtqueue_has_used(&dev->txq)) {
+        virtio_net_service(dev);
+    }
+}
+
+/* ============================================================================
+ * netdev 操作
+ * ============================================================================ */
+
+static bool virtio_net_link_up(virtio_net_dev_t *dev) {
+    if (!virtio_has_feature(dev->vdev, VIRTIO_NET_F_STATUS)) {
+        return true;
+    }
+    uint8_t status = dev->vdev->ops->read_config8(dev->vdev, VIRTIO_NET_CFG_STATUS);
+    return (status & VIRTIO_NET_S_LINK_UP) != 0;
+}
+
+static int virtio_net_open(netdev_t *netdev) {
+    virtio_net_dev_t *dev = (virtio_net_dev_t *)netdev->priv;
+    if (!virtio_net_link_up(dev)) {
+        LOG_WARN_MSG("virtio-net: %s link is down\n", netdev->name);
+    }
+    return 0;
+}
+
+static int virtio_net_close(netdev_t *netdev) {
+    (void)netdev;
+    return 0;
+}
+
+static int virtio_net_set_mac(netdev_t *netdev, uint8_t *mac) {
+    virtio_net_dev_t *dev = (virtio_net_dev_t *)netdev->priv;
+
+    // 只有 legacy 设备的配置空间 MAC 可写
+    if (!dev->vdev->legacy) {
+        return -1;
+    }
+    for (uint32_t i = 0; i < MAC_ADDR_LEN; i++) {
+        dev->vdev->ops->write_config8(dev->vdev, VIRTIO_NET_CFG_MAC + i, mac[i]);
+    }
+    memcpy(netdev->mac, mac, MAC_ADDR_LEN);
+    return 0;
+}
+
+static void virtio_net_print_stats(netdev_t *netdev) {
+    virtio_net_dev_t *dev = (virtio_net_dev_t *)netdev->priv;
+    virtio_net_stats_t *s = &dev->stats;
+
+    kprintf("        Link %s  transport %s  IRQs %u\n",
+            virtio_net_link_up(dev) ? "up" : "down", dev->vdev->name, s->irqs);
+    kprintf("        RX zero-copy %llu  copied %llu  merged %llu  csum ok %llu  dropped %llu\n",
+            s->rx_zero_copy, s->rx_copied, s->rx_merged, s->rx_csum_valid, s->rx_dropped);
+    kprintf("        RX pool free %u/%u (min %u)  kicks %u\n",
+            atomic_read(&dev->rx_pool.free_count), atomic_read(&dev->rx_pool.count),
+            dev->rx_pool.min_free, s->rx_kicks);
+    kprintf("        TX csum offload %llu  TSO %llu  ring full %llu  kicks %u (%u suppressed)\n",
+            s->tx_csum_offload, s->tx_tso, s->tx_ring_full, s->tx_kicks,
+            s->tx_kicks_suppressed);
+}
+
+static netdev_ops_t virtio_net_ops = {
+    .open = virtio_net_open,
+    .close = virtio_net_close,
+    .transmit = virtio_net_transmit,
+    .set_mac = virtio_net_set_mac,
+    .print_stats = virtio_net_print_stats,
+};
+
+/* ============================================================================
+ * 探测与注册
+ * ============================================================================ */
+
+static int virtio_net_setup_queues(virtio_net_dev_t *dev) {
+    virtio_device_t *vdev = dev->vdev;
+
+    if (virtqueue_init(&dev->rxq, vdev, VIRTIO_NET_RXQ) != 0) {
+        return -1;
+    }
+    if (virtqueue_init(&dev->txq, vdev, VIRTIO_NET_TXQ) != 0) {
+        virtqueue_destroy(&dev->rxq);
+        return -1;
+    }
+    virtqueue_disable_cb(&dev->txq);
+
+    dev->tx_hdrs_phys = pmm_alloc_frame();
+    if (dev->tx_hdrs_phys == PADDR_INVALID) {
+        goto fail;
+    }
+    dev->tx_hdrs = (uint8_t *)PHYS_TO_VIRT(dev->tx_hdrs_phys);
+    memset(dev->tx_hdrs, 0, PAGE_SIZE);
+    for (uint16_t i = 0; i < dev->txq.num; i++) {
+        dev->tx_slots[i].index = i;
+        dev->tx_free[i] = (uint16_t)(dev->txq.num - 1 - i);
+    }
+    dev->tx_free_count = dev->txq.num;
+
+    // 与 e1000 相同：先填充 1.5 倍环大小，协议栈持有较多缓冲区时补充到 4 倍
+    uint32_t ring = dev->rxq.num;
+    if (netbuf_pool_init(&dev->rx_pool, NETBUF_MAX_SIZE, ring + ring / 2, ring * 4) < 0 ||
+        (uint32_t)atomic_read(&dev->rx_pool.count) <= ring) {
+        pmm_free_frame(dev->tx_hdrs_phys);
+        goto fail;
+    }
+    virtio_net_rx_refill(dev);
+    return 0;
+
+fail:
+    virtqueue_destroy(&dev->txq);
+    virtqueue_destroy(&dev->rxq);
+    return -1;
+}
+
+static int virtio_net_probe(virtio_device_t *vdev) {
+    if (virtio_net_count >= VIRTIO_NET_MAX_DEVICES) {
+        return -1;
+    }
+    virtio_net_dev_t *dev = &virtio_net_devs[virtio_net_count];
+    memset(dev, 0, sizeof(*dev));
+    dev->vdev = vdev;
+
+    virtio_reset(vdev);
+    uint64_t wanted = VIRTIO_FEATURE(VIRTIO_NET_F_CSUM) |
+                      VIRTIO_FEATURE(VIRTIO_NET_F_GUEST_CSUM) |
+                      VIRTIO_FEATURE(VIRTIO_NET_F_MAC) |
+                      VIRTIO_FEATURE(VIRTIO_NET_F_HOST_TSO4) |
+                      VIRTIO_FEATURE(VIRTIO_NET_F_HOST_TSO6) |
+                      VIRTIO_FEATURE(VIRTIO_NET_F_MRG_RXBUF) |
+                      VIRTIO_FEATURE(VIRTIO_NET_F_STATUS) |
+                      VIRTIO_FEATURE(VIRTIO_F_INDIRECT_DESC) |
+                      VIRTIO_FEATURE(VIRTIO_F_EVENT_IDX);
+    uint64_t offered = vdev->ops->get_features(vdev);
+    if (!(offered & VIRTIO_FEATURE(VIRTIO_NET_F_CSUM))) {
+        // TSO 依赖发送校验和卸载
+        wanted &= ~(VIRTIO_FEATURE(VIRTIO_NET_F_HOST_TSO4) | VIRTIO_FEATURE(VIRTIO_NET_F_HOST_TSO6));
+    }
+    if (virtio_negotiate(vdev, wanted) != 0) {
+        virtio_fail(vdev);
+        return -1;
+    }
+
+    dev->mrg_rxbuf = virtio_has_feature(vdev, VIRTIO_NET_F_MRG_RXBUF);
+    dev->hdr_len = (dev->mrg_rxbuf || !vdev->legacy) ? sizeof(virtio_net_hdr_t)
+                                                     : VIRTIO_NET_HDR_LEGACY_LEN;
+
+    if (virtio_net_setup_queues(dev) != 0) {
+        LOG_ERROR_MSG("virtio-net: %s queue setup failed\n", vdev->name);
+        virtio_fail(vdev);
+        return -1;
+    }
+
+    netdev_t *netdev = &dev->netdev;
+    if (virtio_has_feature(vdev, VIRTIO_NET_F_MAC)) {
+        for (uint32_t i = 0; i < MAC_ADDR_LEN; i++) {
+            netdev->mac[i] = vdev->ops->read_config8(vdev, VIRTIO_NET_CFG_MAC + i);
+        }
+    } else {
+        // 本地管理地址，末字节区分设备
+        static const uint8_t base_mac[MAC_ADDR_LEN] = { 0x52, 0x54, 0x00, 0x56, 0x4E, 0x00 };
+        memcpy(netdev->mac, base_mac, MAC_ADDR_LEN);
+        netdev->mac[5] = (uint8_t)virtio_net_count;
+    }
+
+    // 接在已注册的网卡之后编号
+    for (int i = 0; i < MAX_NETDEV; i++) {
+        ksnprintf(netdev->name, NETDEV_NAME_LEN, "eth%d", i);
+        if (netdev_get_by_name(netdev->name) == NULL) {
+            break;
+        }
+    }
+    netdev->mtu = ETH_MTU;
+    netdev->features = NETDEV_F_SG;
+    if (virtio_has_feature(vdev, VIRTIO_NET_F_CSUM)) {
+        netdev->features |= NETDEV_F_HW_CSUM;
+    }
+    if (virtio_has_feature(vdev, VIRTIO_NET_F_HOST_TSO4) ||
+        virtio_has_feature(vdev, VIRTIO_NET_F_HOST_TSO6)) {
+        netdev->features |= NETDEV_F_TSO;
+    }
+    netdev->state = NETDEV_DOWN;
+    netdev->ops = &virtio_net_ops;
+    netdev->priv = dev;
+    mutex_init(&netdev->lock);
+
+    vdev->priv = dev;
+    vdev->irq_handler = virtio_net_irq;
+    bool have_irq = vdev->ops->enable_irq(vdev) == 0;
+    virtio_driver_ok(vdev);
+
+    // 挂满接收环后通知设备
+    bool irq_state;
+    spinlock_lock_irqsave(&dev->rxq.lock, &irq_state);
+    bool kick = virtqueue_kick_prepare(&dev->rxq);
+    spinlock_unlock_irqrestore(&dev->rxq.lock, irq_state);
+    if (kick) {
+        virtqueue_notify(&dev->rxq);
+    }
+
+    if (netdev_register(netdev) < 0) {
+        LOG_ERROR_MSG("virtio-net: failed to register %s\n", netdev->name);
+        vdev->ops->set_status(vdev, 0);
+        virtqueue_destroy(&dev->txq);
+        virtqueue_destroy(&dev->rxq);
+        pmm_free_frame(dev->tx_hdrs_phys);
+        return -1;
+    }
+    timer_register_callback(virtio_net_poll, dev, VIRTIO_NET_POLL_MS, true);
+
+    LOG_INFO_MSG("virtio-net: %s at %s, MAC %02x:%02x:%02x:%02x:%02x:%02x, irq %u%s\n",
+                 netdev->name, vdev->name, netdev->mac[0], netdev->mac[1], netdev->mac[2],
+                 netdev->mac[3], netdev->mac[4], netdev->mac[5], vdev->irq,
+                 have_irq ? "" : " (polling)");
+    LOG_INFO_MSG("virtio-net: %s queues RX %u TX %u, hdr %u%s%s%s%s%s\n",
+                 netdev->name, dev->rxq.num, dev->txq.num, dev->hdr_len,
+                 dev->mrg_rxbuf ? ", mrg-rxbuf" : "",
+                 (netdev->features & NETDEV_F_HW_CSUM) ? ", csum" : "",
+                 (netdev->features & NETDEV_F_TSO) ? ", tso" : "",
+                 dev->txq.use_indirect ? ", indirect" : "",
+                 dev->txq.use_event_idx ? ", event-idx" : "");
+    virtio_net_count++;
+    return 0;
+}
+
+int virtio_net_init(void) {
+    return virtio_scan(VIRTIO_DEV_NET, virtio_net_probe);
+}
+
+int virtio_net_get_stats(const char *name, virtio_net_stats_t *stats) {
+    if (name == NULL || stats == NULL) {
+        return -1;
+    }
+    for (uint32_t i = 0; i < virtio_net_count; i++) {
+        if (strcmp(virtio_net_devs[i].netdev.name, name) == 0) {
+            *stats = virtio_net_devs[i].stats;
+            return 0;
+        }
+    }
+    return -1;
+}
@@ -0,0 +1,277 @@
+/**
+ * VirtIO 分离式虚拟队列
+ *
+ * 描述符的空闲链借用 desc[i].next 串起来；直接提交时按空闲链顺序取出
+ * 一串描述符，链尾的 next 仍指向空闲链后继（没有 NEXT 标志，设备不看），
+ * 回收时整串接回空闲链头。间接提交只取一个头描述符，段表写入该头描述符
+ * 专属的间接表。
+ */
+
+#include <drivers/common/virtqueue.h>
+#include <mm/pmm.h>
+#include <mm/heap.h>
+#include <lib/klog.h>
+#include <lib/string.h>
+
+/* 与设备共享内存的发布顺序（设备是另一个执行者，用 SMP 屏障即可） */
+#define virtq_mb()  __atomic_thread_fence(__ATOMIC_SEQ_CST)
+
+static uint32_t virtq_pages(size_t bytes) {
+    return (uint32_t)((bytes + PAGE_SIZE - 1) / PAGE_SIZE);
+}
+
+int virtqueue_init(virtqueue_t *vq, virtio_device_t *vdev, uint16_t index) {
+    if (vq == NULL || vdev == NULL || vdev->ops == NULL) {
+        return -1;
+    }
+    memset(vq, 0, sizeof(*vq));
+    vq->vdev = vdev;
+    vq->index = index;
+
+    uint16_t num = vdev->ops->queue_size(vdev, index);
+    if (num == 0 || num > VIRTQ_MAX_SIZE || (num & (num - 1)) != 0) {
+        LOG_ERROR_MSG("virtqueue: %s queue %u has unsupported size %u\n",
+                      vdev->name, index, num);
+        return -1;
+    }
+    vq->num = num;
+
+    // legacy 布局：描述符表 + 可用环（含 used_event），已用环对齐到 4KB
+    size_t avail_off = (size_t)num * sizeof(struct virtq_desc);
+    size_t used_off = (avail_off + 4 + 2 * (size_t)num + 2 + VIRTQ_ALIGN - 1) &
+                      ~(size_t)(VIRTQ_ALIGN - 1);
+    size_t total = used_off + 4 + 8 * (size_t)num + 2;
+
+    vq->ring_pages = virtq_pages(total);
+    vq->ring_phys = pmm_alloc_frames(vq->ring_pages);
+    if (vq->ring_phys == PADDR_INVALID) {
+        LOG_ERROR_MSG("virtqueue: out of memory for %s queue %u\n", vdev->name, index);
+        return -1;
+    }
+    uint8_t *mem = (uint8_t *)PHYS_TO_VIRT(vq->ring_phys);
+    memset(mem, 0, vq->ring_pages * PAGE_SIZE);
+    vq->desc = (volatile struct virtq_desc *)mem;
+    vq->avail = (volatile struct virtq_avail *)(mem + avail_off);
+    vq->used = (volatile struct virtq_used *)(mem + used_off);
+    vq->avail_phys = vq->ring_phys + avail_off;
+    vq->used_phys = vq->ring_phys + used_off;
+
+    vq->use_event_idx = virtio_has_feature(vdev, VIRTIO_F_EVENT_IDX);
+    vq->use_indirect = virtio_has_feature(vdev, VIRTIO_F_INDIRECT_DESC);
+    if (vq->use_indirect) {
+        vq->indirect_pages = virtq_pages((size_t)num * VIRTQ_INDIRECT_MAX *
+                                         sizeof(struct virtq_desc));
+        vq->indirect_phys = pmm_alloc_frames(vq->indirect_pages);
+        if (vq->indirect_phys == PADDR_INVALID) {
+            // 没有间接表也能工作，只是每个请求占用多个描述符
+            LOG_WARN_MSG("virtqueue: %s queue %u without indirect tables\n",
+                         vdev->name, index);
+            vq->use_indirect = false;
+            vq->indirect_pages = 0;
+        } else {
+            vq->indirect = (struct virtq_desc *)PHYS_TO_VIRT(vq->indirect_phys);
+        }
+    }
+
+    vq->tokens = (void **)kcalloc(num, sizeof(void *));
+    if (vq->tokens == NULL) {
+        virtqueue_destroy(vq);
+        return -1;
+    }
+
+    for (uint16_t i = 0; i < num; i++) {
+        vq->desc[i].next = (uint16_t)(i + 1);
+    }
+    vq->free_head = 0;
+    vq->num_free = num;
+    vq->cb_enabled = true;
+    spinlock_init(&vq->lock);
+
+    if (vdev->ops->queue_setup(vdev, vq) != 0) {
+        LOG_ERROR_MSG("virtqueue: %s rejected queue %u\n", vdev->name, index);
+        virtqueue_destroy(vq);
+        return -1;
+    }
+    return 0;
+}
+
+void virtqueue_destroy(virtqueue_t *vq) {
+    if (vq == NULL) {
+        return;
+    }
+    if (vq->tokens != NULL) {
+        kfree(vq->tokens);
+        vq->tokens = NULL;
+    }
+    if (vq->indirect_pages != 0) {
+        pmm_free_frames(vq->indirect_phys, vq->indirect_pages);
+        vq->indirect_pages = 0;
+        vq->indirect = NULL;
+    }
+    if (vq->ring_pages != 0) {
+        pmm_free_frames(vq->ring_phys, vq->ring_pages);
+        vq->ring_pages = 0;
+    }
+    vq->desc = NULL;
+    vq->avail = NULL;
+    vq->used = NULL;
+}
+
+int virtqueue_add(virtqueue_t *vq, const virtq_sg_t *sg, uint16_t out, uint16_t in,
+                  void *token) {
+    uint16_t total = (uint16_t)(out + in);
+    if (vq == NULL || sg == NULL || token == NULL || total == 0) {
+        return -1;
+    }
+
+    bool indirect = vq->use_indirect && total > 1 && total <= VIRTQ_INDIRECT_MAX;
+    uint16_t needed = indirect ? 1 : total;
+    if (vq->num_free < needed) {
+        return -1;
+    }
+
+    uint16_t head = vq->free_head;
+    if (indirect) {
+        struct virtq_desc *table = vq->indirect + (size_t)head * VIRTQ_INDIRECT_MAX;
+        for (uint16_t i = 0; i < total; i++) {
+            table[i].addr = sg[i].addr;
+            table[i].len = sg[i].len;
+            table[i].flags = (uint16_t)((i >= out ? VIRTQ_DESC_F_WRITE : 0) |
+                                        (i + 1 < total ? VIRTQ_DESC_F_NEXT : 0));
+            table[i].next = (uint16_t)(i + 1);
+        }
+        vq->desc[head].addr = vq->indirect_phys +
+                              (uint64_t)head * VIRTQ_INDIRECT_MAX * sizeof(struct virtq_desc);
+        vq->desc[head].len = total * sizeof(struct virtq_desc);
+        vq->desc[head].flags = VIRTQ_DESC_F_INDIRECT;
+        vq->free_head = vq->desc[head].next;
+    } else {
+        uint16_t idx = head;
+        for (uint16_t i = 0; i < total; i++) {
+            vq->desc[idx].addr = sg[i].addr;
+            vq->desc[idx].len = sg[i].len;
+            vq->desc[idx].flags = (uint16_t)((i >= out ? VIRTQ_DESC_F_WRITE : 0) |
+                                             (i + 1 < total ? VIRTQ_DESC_F_NEXT : 0));
+            idx = vq->desc[idx].next;
+        }
+        vq->free_head = idx;
+    }
+    vq->num_free = (uint16_t)(vq->num_free - needed);
+    vq->tokens[head] = token;
+
+    // 先写环项，kick_prepare 里屏障之后才发布 idx
+    vq->avail->ring[vq->avail_idx & (vq->num - 1)] = head;
+    vq->avail_idx++;
+    return 0;
+}
+
+bool virtqueue_kick_prepare(virtqueue_t *vq) {
+    if (vq == NULL) {
+        return false;
+    }
+
+    virtq_mb();     // 描述符与环项先于 idx 可见
+    vq->avail->idx = vq->avail_idx;
+    virtq_mb();     // idx 发布后再读设备的通知请求
+
+    uint16_t old_idx = vq->kicked_idx;
+    uint16_t new_idx = vq->avail_idx;
+    vq->kicked_idx = new_idx;
+    if (old_idx == new_idx) {
+        return false;
+    }
+
+    bool need;
+    if (vq->use_event_idx) {
+        need = virtq_need_event(*virtq_avail_event(vq), new_idx, old_idx);
+    } else {
+        need = !(vq->used->flags & VIRTQ_USED_F_NO_NOTIFY);
+    }
+    if (need) {
+        vq->kicks++;
+    } else {
+        vq->kicks_suppressed++;
+    }
+    return need;
+}
+
+void virtqueue_notify(virtqueue_t *vq) {
+    if (vq != NULL && vq->vdev != NULL) {
+        vq->vdev->ops->notify(vq->vdev, vq->index);
+    }
+}
+
+bool virtqueue_has_used(virtqueue_t *vq) {
+    if (vq == NULL || vq->used == NULL) {
+        return false;
+    }
+    return vq->last_used != vq->used->idx;
+}
+
+void *virtqueue_get_used(virtqueue_t *vq, uint32_t *len) {
+    if (!virtqueue_has_used(vq)) {
+        return NULL;
+    }
+    virtq_mb();     // 先看到 idx，再读对应的环项
+
+    volatile struct virtq_used_elem *elem = &vq->used->ring[vq->last_used & (vq->num - 1)];
+    uint32_t id = elem->id;
+    uint32_t written = elem->len;
+    vq->last_used++;
+
+    if (id >= vq->num || vq->tokens[id] == NULL) {
+        LOG_ERROR_MSG("virtqueue: %s queue %u returned bad id %u\n",
+                      vq->vdev->name, vq->index, id);
+        return NULL;
+    }
+    void *token = vq->tokens[id];
+    vq->tokens[id] = NULL;
+
+    // 整串接回空闲链头
+    uint16_t count = 1;
+    uint16_t tail = (uint16_t)id;
+    if (!(vq->desc[tail].flags & VIRTQ_DESC_F_INDIRECT)) {
+        while (vq->desc[tail].flags & VIRTQ_DESC_F_NEXT) {
+            tail = vq->desc[tail].next;
+            count++;
+        }
+    }
+    vq->desc[tail].next = vq->free_head;
+    vq->free_head = (uint16_t)id;
+    vq->num_free = (uint16_t)(vq->num_free + count);
+
+    // 事件索引：请设备在越过刚回收的位置时（即下一次完成）再发中断
+    if (vq->use_event_idx && vq->cb_enabled) {
+        *virtq_used_event(vq) = vq->last_used;
+        virtq_mb();
+    }
+
+    if (len != NULL) {
+        *len = written;
+    }
+    return token;
+}
+
+void virtqueue_enable_cb(virtqueue_t *vq) {
+    if (vq == NULL) {
+        return;
+    }
+    vq->cb_enabled = true;
+    if (vq->use_event_idx) {
+        *virtq_used_event(vq) = vq->last_used;
+    } else {
+        vq->avail->flags = (uint16_t)(vq->avail->flags & ~VIRTQ_AVAIL_F_NO_INTERRUPT);
+    }
+    virtq_mb();
+}
+
+void virtqueue_disable_cb(virtqueue_t *vq) {
+    if (vq == NULL) {
+        return;
+    }
+    vq->cb_enabled = false;
+    // 事件索引模式下不再推进 used_event，设备越过旧值之前不会再发中断
+    if (!vq->use_event_idx) {
+        vq->avail->flags = (uint16_t)(vq->avail->flags | VIRTQ_AVAIL_F_NO_INTERRUPT);
+    }
+}
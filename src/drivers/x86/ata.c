@@ -1,16 +1,30 @@
 /**
- * ATA 驱动（PIO 模式）
+ * ATA 驱动（总线主控 DMA，PIO 回退）
+ * 
+ * 控制器是 PIIX/ICH 类 IDE 时使用总线主控 DMA：按 PRD 表（物理区域描述符）
+ * 一条命令传输最多 256 个扇区，调用者在通道的等待队列上睡眠，由 IRQ 14/15
+ * 唤醒。没有总线主控、设备不支持 DMA 或 DMA 出错时回退到 PIO。
+ * 
+ * PIO 同样一条命令传输最多 256 个扇区：支持时用 READ/WRITE MULTIPLE，
+ * 每个 DRQ 块用 rep insw/outsw 传输。超出 LBA28 范围的请求使用 48 位命令。
  * 
  * 同步机制：每个 ATA 通道使用一个 mutex 保护
- * - PIO 操作耗时较长，使用 mutex 比 spinlock 更合适
+ * - 一个通道同一时刻只能执行一条命令，DMA 等待期间会睡眠，使用 mutex
  * - 防止并发磁盘操作导致 I/O 指令冲突和数据损坏
  */
 
 #include <drivers/ata.h>
+#include <drivers/pci.h>
 #include <fs/blockdev.h>
+#include <fs/bio.h>
 #include <kernel/io.h>
 #include <kernel/irq.h>
 #include <kernel/sync/mutex.h>
+#include <kernel/sync/spinlock.h>
+#include <kernel/sync/waitqueue.h>
+#include <mm/pmm.h>
+#include <mm/vmm.h>
+#include <drivers/timer.h>
 #include <lib/klog.h>
 #include <lib/string.h>
 
@@ -37,13 +51,53 @@
 #define ATA_SR_RDY 0x40
 #define ATA_SR_BSY 0x80
 
-#define ATA_CMD_READ_SECTORS  0x20
-#define ATA_CMD_WRITE_SECTORS 0x30
-#define ATA_CMD_IDENTIFY      0xEC
+#define ATA_CTRL_SRST 0x04              // 设备控制寄存器：软复位通道上的设备
+
+#define ATA_CMD_READ_SECTORS        0x20
+#define ATA_CMD_READ_SECTORS_EXT    0x24
+#define ATA_CMD_READ_DMA_EXT        0x25
+#define ATA_CMD_READ_MULTIPLE_EXT   0x29
+#define ATA_CMD_WRITE_SECTORS       0x30
+#define ATA_CMD_WRITE_SECTORS_EXT   0x34
+#define ATA_CMD_WRITE_DMA_EXT       0x35
+#define ATA_CMD_WRITE_MULTIPLE_EXT  0x39
+#define ATA_CMD_READ_MULTIPLE       0xC4
+#define ATA_CMD_WRITE_MULTIPLE      0xC5
+#define ATA_CMD_SET_MULTIPLE        0xC6
+#define ATA_CMD_READ_DMA            0xC8
+#define ATA_CMD_WRITE_DMA           0xCA
+#define ATA_CMD_IDENTIFY            0xEC
+#define ATA_CMD_SET_FEATURES        0xEF
+
+#define ATA_FEATURE_XFER_MODE 0x03      // SET FEATURES 子命令：设置传输模式
+#define ATA_XFER_MWDMA        0x20
+#define ATA_XFER_UDMA         0x40
 
 #define ATA_SECTOR_SIZE 512
 #define ATA_MAX_DEVICES 4
 
+#define ATA_LBA28_LIMIT       0x10000000    // LBA28 可寻址的扇区数
+#define ATA_MAX_SECTORS       256           // 一条命令传输的扇区数（LBA28 计数字段的上限）
+
+/* 总线主控 IDE 寄存器（BAR4，每通道 8 字节） */
+#define ATA_BM_CMD            0x00
+#define ATA_BM_STATUS         0x02
+#define ATA_BM_PRDT           0x04
+
+#define ATA_BM_CMD_START      0x01
+#define ATA_BM_CMD_READ       0x08      // 设备到内存（磁盘读）
+
+#define ATA_BM_SR_ACTIVE      0x01
+#define ATA_BM_SR_ERR         0x02
+#define ATA_BM_SR_IRQ         0x04      // 写 1 清除
+
+#define ATA_PRD_EOT           0x8000
+#define ATA_PRD_MAX_BYTES     0x10000   // 单个 PRD 不能跨 64KB 边界
+
+#define ATA_DMA_BUF_PAGES     ((ATA_MAX_SECTORS * ATA_SECTOR_SIZE) / PAGE_SIZE)
+#define ATA_DMA_TIMEOUT_MS    5000
+#define ATA_RESET_TIMEOUT_MS  5000
+
 typedef struct ata_device {
     uint16_t io_base;
     uint16_t ctrl_base;
@@ -51,10 +105,40 @@ typedef struct ata_device {
     bool present;
     uint32_t total_sectors;
     uint8_t channel;        // 0 = primary, 1 = secondary
+    bool dma;               // 设备支持 DMA 且已设置传输模式
+    bool lba48;             // 支持 48 位 LBA
+    uint8_t multiple;       // READ/WRITE MULTIPLE 每个 DRQ 块的扇区数，0 表示不支持
 } ata_device_t;
 
-/* 每个 ATA 通道一个 mutex（主通道和次通道各一个） */
-static mutex_t ata_channel_mutex[2];
+/* 物理区域描述符 */
+typedef struct ata_prd {
+    uint32_t phys;
+    uint16_t bytes;         // 0 表示 64KB
+    uint16_t flags;
+} __attribute__((packed)) ata_prd_t;
+
+#define ATA_PRD_ENTRIES     (PAGE_SIZE / sizeof(ata_prd_t))
+
+/* 每个 ATA 通道的状态（主通道和次通道各一个） */
+typedef struct ata_channel {
+    mutex_t lock;                   // 同一通道同一时刻只执行一条命令
+    uint16_t io_base;
+    uint16_t bm_base;               // 总线主控寄存器，0 表示不支持 DMA
+    ata_prd_t *prdt;                // PRD 表（一个物理页）
+    paddr_t prdt_phys;
+    uint8_t *bounce;                // 调用者缓冲区不能直接 DMA 时的中转缓冲区
+    paddr_t bounce_phys;
+    wait_queue_t irq_wait;          // 等待 DMA 完成中断
+    volatile bool irq_done;
+    volatile uint8_t irq_bm_status; // 中断时的总线主控状态
+} ata_channel_t;
+
+static ata_channel_t ata_channels[2] = {
+    {.io_base = ATA_PRIMARY_IO_BASE},
+    {.io_base = ATA_SECONDARY_IO_BASE},
+};
+
+static bool ata_dma_allowed = true;
 
 static ata_device_t ata_devices[ATA_MAX_DEVICES] = {
     {.io_base = ATA_PRIMARY_IO_BASE,    .ctrl_base = ATA_PRIMARY_CTRL_BASE,    .drive = 0, .present = false, .total_sectors = 0, .channel = 0}, // ata0: primary master
@@ -101,6 +185,86 @@ static void ata_select_drive(ata_device_t *dev, uint32_t lba) {
     ata_io_wait(dev);
 }
 
+/*
+ * 写任务文件并发出读写命令，count 为 1..ATA_MAX_SECTORS
+ * 请求超出 LBA28 范围时使用 48 位命令：各寄存器先写高字节再写低字节
+ */
+static int ata_issue(ata_device_t *dev, uint32_t lba, uint32_t count,
+                     uint8_t cmd, uint8_t cmd_ext) {
+    bool ext = (uint64_t)lba + count > ATA_LBA28_LIMIT;
+    if (ext && !dev->lba48) {
+        return -1;
+    }
+
+    if (ext) {
+        outb(dev->io_base + ATA_REG_HDDEVSEL, (uint8_t)(0x40 | (dev->drive << 4)));
+        ata_io_wait(dev);
+    } else {
+        ata_select_drive(dev, lba);
+    }
+    if (ata_wait_status(dev, ATA_SR_BSY, 0, true) != 0) {
+        return -1;
+    }
+
+    outb(dev->io_base + ATA_REG_FEATURES, 0);
+    if (ext) {
+        outb(dev->io_base + ATA_REG_SECCOUNT0, (uint8_t)((count >> 8) & 0xFF));
+        outb(dev->io_base + ATA_REG_LBA0, (uint8_t)((lba >> 24) & 0xFF));
+        outb(dev->io_base + ATA_REG_LBA1, 0);   // blockdev 扇区号只有 32 位
+        outb(dev->io_base + ATA_REG_LBA2, 0);
+    }
+    outb(dev->io_base + ATA_REG_SECCOUNT0, (uint8_t)(count & 0xFF));   // LBA28 下 0 表示 256
+    outb(dev->io_base + ATA_REG_LBA0, (uint8_t)(lba & 0xFF));
+    outb(dev->io_base + ATA_REG_LBA1, (uint8_t)((lba >> 8) & 0xFF));
+    outb(dev->io_base + ATA_REG_LBA2, (uint8_t)((lba >> 16) & 0xFF));
+    outb(dev->io_base + ATA_REG_COMMAND, ext ? cmd_ext : cmd);
+    return 0;
+}
+
+/* 按 IDENTIFY 字 47 开启 READ/WRITE MULTIPLE，返回每块扇区数，0 表示不支持 */
+static uint8_t ata_set_multiple_mode(ata_device_t *dev, const uint16_t *identify) {
+    uint8_t max = identify[47] & 0xFF;
+    if (max == 0) {
+        return 0;
+    }
+
+    ata_select_drive(dev, 0);
+    outb(dev->io_base + ATA_REG_SECCOUNT0, max);
+    outb(dev->io_base + ATA_REG_COMMAND, ATA_CMD_SET_MULTIPLE);
+    ata_io_wait(dev);
+    if (ata_wait_status(dev, ATA_SR_BSY, 0, false) != 0) {
+        return 0;
+    }
+    return max;
+}
+
+/* 按 IDENTIFY 数据选择最高的 UDMA（否则多字 DMA）模式 */
+static int ata_set_dma_mode(ata_device_t *dev, const uint16_t *identify) {
+    uint8_t mode = 0;
+    if ((identify[53] & (1 << 2)) && (identify[88] & 0x7F)) {
+        uint16_t udma = identify[88] & 0x7F;
+        mode = ATA_XFER_UDMA;
+        while (udma >>= 1) {
+            mode++;
+        }
+    } else if (identify[63] & 0x07) {
+        uint16_t mwdma = identify[63] & 0x07;
+        mode = ATA_XFER_MWDMA;
+        while (mwdma >>= 1) {
+            mode++;
+        }
+    } else {
+        return -1;
+    }
+
+    ata_select_drive(dev, 0);
+    outb(dev->io_base + ATA_REG_FEATURES, ATA_FEATURE_XFER_MODE);
+    outb(dev->io_base + ATA_REG_SECCOUNT0, mode);
+    outb(dev->io_base + ATA_REG_COMMAND, ATA_CMD_SET_FEATURES);
+    ata_io_wait(dev);
+    return ata_wait_status(dev, ATA_SR_BSY, 0, false);
+}
+
 static int ata_identify(ata_device_t *dev) {
     ata_select_drive(dev, 0);
 
@@ -137,89 +301,345 @@ static int ata_identify(ata_device_t *dev) {
     }
 
     uint32_t total_sectors = ((uint32_t)identify_buffer[61] << 16) | identify_buffer[60];
+    dev->lba48 = (identify_buffer[83] & (1 << 10)) != 0;
+    if (dev->lba48) {
+        uint64_t total48 = ((uint64_t)identify_buffer[103] << 48) |
+                           ((uint64_t)identify_buffer[102] << 32) |
+                           ((uint64_t)identify_buffer[101] << 16) | identify_buffer[100];
+        // blockdev 扇区号是 32 位，超出部分（2TB 以上）不可见
+        total_sectors = total48 > 0xFFFFFFFFULL ? 0xFFFFFFFFU : (uint32_t)total48;
+    }
     if (total_sectors == 0) {
         return -1;
     }
 
     dev->total_sectors = total_sectors;
     dev->present = true;
+    dev->multiple = ata_set_multiple_mode(dev, identify_buffer);
+    dev->dma = (identify_buffer[49] & (1 << 8)) != 0 && ata_set_dma_mode(dev, identify_buffer) == 0;
     return 0;
 }
 
-static int ata_pio_read_sector(ata_device_t *dev, uint32_t lba, uint8_t *buffer) {
-    ata_select_drive(dev, lba);
-
-    outb(dev->io_base + ATA_REG_FEATURES, 0);
-    outb(dev->io_base + ATA_REG_SECCOUNT0, 1);
-    outb(dev->io_base + ATA_REG_LBA0, (uint8_t)(lba & 0xFF));
-    outb(dev->io_base + ATA_REG_LBA1, (uint8_t)((lba >> 8) & 0xFF));
-    outb(dev->io_base + ATA_REG_LBA2, (uint8_t)((lba >> 16) & 0xFF));
-    outb(dev->io_base + ATA_REG_COMMAND, ATA_CMD_READ_SECTORS);
+/*
+ * PIO 传输 count（<= ATA_MAX_SECTORS）个扇区，调用者持有通道锁
+ * 设备支持时用 READ/WRITE MULTIPLE，每个 DRQ 块传输多个扇区，块内用 rep insw/outsw
+ */
+static int ata_pio_transfer(ata_device_t *dev, uint32_t lba, uint32_t count,
+                            uint8_t *buffer, bool write) {
+    uint32_t block = dev->multiple ? dev->multiple : 1;
+    uint8_t cmd, cmd_ext;
+    if (dev->multiple) {
+        cmd = write ? ATA_CMD_WRITE_MULTIPLE : ATA_CMD_READ_MULTIPLE;
+        cmd_ext = write ? ATA_CMD_WRITE_MULTIPLE_EXT : ATA_CMD_READ_MULTIPLE_EXT;
+    } else {
+        cmd = write ? ATA_CMD_WRITE_SECTORS : ATA_CMD_READ_SECTORS;
+        cmd_ext = write ? ATA_CMD_WRITE_SECTORS_EXT : ATA_CMD_READ_SECTORS_EXT;
+    }
 
-    if (ata_poll_ready(dev) != 0) {
+    if (ata_issue(dev, lba, count, cmd, cmd_ext) != 0) {
         return -1;
     }
 
-    for (uint32_t i = 0; i < ATA_SECTOR_SIZE / 2; i++) {
-        uint16_t data = inw(dev->io_base + ATA_REG_DATA);
-        ((uint16_t *)buffer)[i] = data;
+    for (uint32_t done = 0; done < count; ) {
+        uint32_t n = count - done;
+        if (n > block) {
+            n = block;
+        }
+        ata_io_wait(dev);
+        if (ata_poll_ready(dev) != 0) {
+            return -1;
+        }
+        if (write) {
+            outsw(dev->io_base + ATA_REG_DATA, buffer + done * ATA_SECTOR_SIZE,
+                  n * ATA_SECTOR_SIZE / 2);
+        } else {
+            insw(dev->io_base + ATA_REG_DATA, buffer + done * ATA_SECTOR_SIZE,
+                 n * ATA_SECTOR_SIZE / 2);
+        }
+        done += n;
     }
 
     ata_io_wait(dev);
+    return ata_wait_status(dev, ATA_SR_BSY, 0, false);
+}
+
+/* 为一段物理连续的区域填写 PRD，不跨 64KB 边界；返回用掉的表项数，0 表示表满 */
+static uint32_t ata_prd_fill(ata_prd_t *prd, uint32_t n, uint32_t phys, uint32_t bytes) {
+    uint32_t used = 0;
+    while (bytes > 0) {
+        if (n + used >= ATA_PRD_ENTRIES) {
+            return 0;
+        }
+        uint32_t chunk = ATA_PRD_MAX_BYTES - (phys & (ATA_PRD_MAX_BYTES - 1));
+        if (chunk > bytes) {
+            chunk = bytes;
+        }
+        prd[n + used].phys = phys;
+        prd[n + used].bytes = (uint16_t)(chunk & 0xFFFF);
+        prd[n + used].flags = 0;
+        phys += chunk;
+        bytes -= chunk;
+        used++;
+    }
+    return used;
+}
+
+/* 直接以调用者缓冲区建立 PRD 表；缓冲区不满足 DMA 要求时返回 -1 */
+static int ata_prd_build_direct(ata_channel_t *ch, uint8_t *buffer, uint32_t bytes) {
+    uintptr_t virt = (uintptr_t)buffer;
+    if (virt & 1) {
+        return -1;
+    }
+
+    uint32_t n = 0;
+    while (bytes > 0) {
+        uint32_t chunk = PAGE_SIZE - (virt & (PAGE_SIZE - 1));
+        if (chunk > bytes) {
+            chunk = bytes;
+        }
+        uintptr_t phys = vmm_virt_to_phys(virt);
+        if (phys == 0 || (uint64_t)phys + chunk > 0x100000000ULL) {
+            return -1;
+        }
+
+        // 与上一项物理连续且不跨 64KB 边界时合并
+        ata_prd_t *last = n ? &ch->prdt[n - 1] : NULL;
+        uint32_t last_bytes = last ? (last->bytes ? last->bytes : ATA_PRD_MAX_BYTES) : 0;
+        if (last && last->phys + last_bytes == phys &&
+            ((last->phys ^ (uint32_t)(phys + chunk - 1)) & ~(ATA_PRD_MAX_BYTES - 1)) == 0) {
+            last->bytes = (uint16_t)((last_bytes + chunk) & 0xFFFF);
+        } else {
+            uint32_t used = ata_prd_fill(ch->prdt, n, (uint32_t)phys, chunk);
+            if (used == 0) {
+                return -1;
+            }
+            n += used;
+        }
+        virt += chunk;
+        bytes -= chunk;
+    }
+
+    ch->prdt[n - 1].flags = ATA_PRD_EOT;
     return 0;
 }
 
-static int ata_pio_write_sector(ata_device_t *dev, uint32_t lba, const uint8_t *buffer) {
-    ata_select_drive(dev, lba);
+static void ata_prd_build_bounce(ata_channel_t *ch, uint32_t bytes) {
+    uint32_t n = ata_prd_fill(ch->prdt, 0, (uint32_t)ch->bounce_phys, bytes);
+    ch->prdt[n - 1].flags = ATA_PRD_EOT;
+}
 
-    outb(dev->io_base + ATA_REG_FEATURES, 0);
-    outb(dev->io_base + ATA_REG_SECCOUNT0, 1);
-    outb(dev->io_base + ATA_REG_LBA0, (uint8_t)(lba & 0xFF));
-    outb(dev->io_base + ATA_REG_LBA1, (uint8_t)((lba >> 8) & 0xFF));
-    outb(dev->io_base + ATA_REG_LBA2, (uint8_t)((lba >> 16) & 0xFF));
-    outb(dev->io_base + ATA_REG_COMMAND, ATA_CMD_WRITE_SECTORS);
+static bool ata_dma_complete(void *arg) {
+    ata_channel_t *ch = (ata_channel_t *)arg;
+    // 中断还没到（或中断被屏蔽）时也直接查看总线主控状态
+    return ch->irq_done || (inb(ch->bm_base + ATA_BM_STATUS) & ATA_BM_SR_IRQ);
+}
 
-    if (ata_poll_ready(dev) != 0) {
-        return -1;
+/* 用一条 READ/WRITE DMA (EXT) 命令传输 count（<= ATA_MAX_SECTORS）个扇区，调用者持有通道锁 */
+static int ata_dma_transfer(ata_device_t *dev, uint32_t lba, uint32_t count,
+                            uint8_t *buffer, bool write) {
+    ata_channel_t *ch = &ata_channels[dev->channel];
+    uint32_t bytes = count * ATA_SECTOR_SIZE;
+
+    bool bounce = ata_prd_build_direct(ch, buffer, bytes) != 0;
+    if (bounce) {
+        ata_prd_build_bounce(ch, bytes);
+        if (write) {
+            memcpy(ch->bounce, buffer, bytes);
+        }
     }
 
-    for (uint32_t i = 0; i < ATA_SECTOR_SIZE / 2; i++) {
-        outw(dev->io_base + ATA_REG_DATA, ((const uint16_t *)buffer)[i]);
+    uint8_t dir = write ? 0 : ATA_BM_CMD_READ;
+    outb(ch->bm_base + ATA_BM_CMD, dir);
+    outl(ch->bm_base + ATA_BM_PRDT, (uint32_t)ch->prdt_phys);
+    outb(ch->bm_base + ATA_BM_STATUS,
+         inb(ch->bm_base + ATA_BM_STATUS) | ATA_BM_SR_ERR | ATA_BM_SR_IRQ);
+    ch->irq_done = false;
+    ch->irq_bm_status = 0;
+
+    if (ata_issue(dev, lba, count,
+                  write ? ATA_CMD_WRITE_DMA : ATA_CMD_READ_DMA,
+                  write ? ATA_CMD_WRITE_DMA_EXT : ATA_CMD_READ_DMA_EXT) != 0) {
+        return -1;
     }
+    outb(ch->bm_base + ATA_BM_CMD, dir | ATA_BM_CMD_START);
 
-    ata_io_wait(dev);
+    int wait = wait_queue_wait(&ch->irq_wait, ata_dma_complete, ch, ATA_DMA_TIMEOUT_MS);
 
-    if (ata_wait_status(dev, ATA_SR_BSY, 0, false) != 0) {
+    outb(ch->bm_base + ATA_BM_CMD, dir);
+    uint8_t bm_status = inb(ch->bm_base + ATA_BM_STATUS) | ch->irq_bm_status;
+    uint8_t status = inb(dev->io_base + ATA_REG_STATUS);
+    outb(ch->bm_base + ATA_BM_STATUS, bm_status | ATA_BM_SR_ERR | ATA_BM_SR_IRQ);
+
+    if (wait != 0 || (bm_status & ATA_BM_SR_ERR) || (status & (ATA_SR_ERR | ATA_SR_DF))) {
+        LOG_WARN_MSG("ata: DMA %s lba %u count %u failed (%s, bm=0x%x, status=0x%x)\n",
+                     write ? "write" : "read", lba, count,
+                     wait != 0 ? "timeout" : "error", bm_status, status);
         return -1;
     }
+
+    if (bounce && !write) {
+        memcpy(buffer, ch->bounce, bytes);
+    }
     return 0;
 }
 
+static inline bool ata_use_dma(ata_device_t *dev) {
+    return ata_dma_allowed && dev->dma && ata_channels[dev->channel].bm_base != 0;
+}
+
+/* DMA 失败后该设备改用 PIO，避免每次请求都等待超时 */
+static void ata_dma_disable(ata_device_t *dev) {
+    LOG_WARN_MSG("ata: falling back to PIO for %s %s\n",
+                 dev->channel ? "secondary" : "primary", dev->drive ? "slave" : "master");
+    dev->dma = false;
+}
+
+/*
+ * DMA 超时或出错后软复位通道：设备可能仍在执行 DMA 命令，随时会写中转缓冲区
+ * 或调用者的缓冲区。复位并等到 BSY 清除后才能返回错误或改用 PIO 重试。
+ * 复位作用于通道上的两个设备，调用者持有通道锁。
+ */
+static int ata_channel_reset(ata_device_t *dev) {
+    outb(dev->ctrl_base, ATA_CTRL_SRST);
+    // SRST 至少保持 5us，每次 ata_io_wait 约 400ns
+    for (uint32_t i = 0; i < 16; i++) {
+        ata_io_wait(dev);
+    }
+    outb(dev->ctrl_base, 0);
+    ata_io_wait(dev);
+
+    uint64_t start = timer_get_uptime_ms();
+    while (inb(dev->ctrl_base) & ATA_SR_BSY) {
+        if (timer_get_uptime_ms() - start > ATA_RESET_TIMEOUT_MS) {
+            LOG_ERROR_MSG("ata: %s channel stays busy after reset\n",
+                          dev->channel ? "secondary" : "primary");
+            return -1;
+        }
+        cpu_relax();
+    }
+
+    ata_select_drive(dev, 0);
+    return ata_wait_status(dev, ATA_SR_BSY, 0, true);
+}
+
+static void ata_channel_irq(ata_channel_t *ch) {
+    // 读状态寄存器应答设备中断
+    (void)inb(ch->io_base + ATA_REG_STATUS);
+    if (ch->bm_base == 0) {
+        return;
+    }
+
+    uint8_t bm_status = inb(ch->bm_base + ATA_BM_STATUS);
+    if (!(bm_status & ATA_BM_SR_IRQ)) {
+        return;
+    }
+    outb(ch->bm_base + ATA_BM_STATUS, bm_status);
+    ch->irq_bm_status = bm_status;
+    ch->irq_done = true;
+    wait_queue_wake(&ch->irq_wait, 0);
+}
+
+static void ata_primary_irq_handler(registers_t *regs) {
+    (void)regs;
+    ata_channel_irq(&ata_channels[0]);
+}
+
+static void ata_secondary_irq_handler(registers_t *regs) {
+    (void)regs;
+    ata_channel_irq(&ata_channels[1]);
+}
+
+/* 查找 PCI IDE 控制器，为两个通道准备总线主控 DMA */
+static void ata_dma_init(void) {
+    pci_device_t *pci = pci_find_class(PCI_CLASS_STORAGE, PCI_SUBCLASS_IDE);
+    if (pci == NULL || !(pci->prog_if & PCI_IDE_PROG_IF_BUS_MASTER)) {
+        LOG_INFO_MSG("ata: no bus-master IDE controller, using PIO\n");
+        return;
+    }
+
+    uint32_t bm_base = pci_get_bar_address(pci, 4);
+    if (bm_base == 0 || pci->bar_type[4] != PCI_BAR_TYPE_IO) {
+        LOG_WARN_MSG("ata: IDE controller has no bus-master I/O BAR, using PIO\n");
+        return;
+    }
+    pci_enable_io_space(pci);
+    pci_enable_bus_master(pci);
+
+    for (uint32_t i = 0; i < 2; i++) {
+        ata_channel_t *ch = &ata_channels[i];
+        paddr_t prdt = pmm_alloc_frame();
+        paddr_t bounce = pmm_alloc_frames(ATA_DMA_BUF_PAGES);
+        if (prdt == PADDR_INVALID || bounce == PADDR_INVALID ||
+            (uint64_t)bounce + ATA_DMA_BUF_PAGES * PAGE_SIZE > 0x100000000ULL) {
+            LOG_WARN_MSG("ata: no memory for channel %u DMA buffers, using PIO\n", i);
+            if (prdt != PADDR_INVALID) {
+                pmm_free_frame(prdt);
+            }
+            if (bounce != PADDR_INVALID) {
+                pmm_free_frames(bounce, ATA_DMA_BUF_PAGES);
+            }
+            continue;
+        }
+
+        ch->prdt = (ata_prd_t *)PHYS_TO_VIRT(prdt);
+        ch->prdt_phys = prdt;
+        ch->bounce = (uint8_t *)PHYS_TO_VIRT(bounce);
+        ch->bounce_phys = bounce;
+        ch->bm_base = (uint16_t)(bm_base + i * 8);
+    }
+
+    LOG_INFO_MSG("ata: bus-master DMA at I/O 0x%x (PCI %02x:%02x.%x)\n",
+                 bm_base, pci->bus, pci->slot, pci->func);
+}
+
+void ata_set_dma_enabled(bool enabled) {
+    ata_dma_allowed = enabled;
+}
+
 static int ata_blockdev_read(void *dev_ptr, uint32_t sector, uint32_t count, uint8_t *buffer) {
     ata_device_t *dev = (ata_device_t *)dev_ptr;
     if (!dev || !dev->present || !buffer || count == 0) {
         return -1;
     }
 
-    if (sector + count > dev->total_sectors) {
+    if ((uint64_t)sector + count > dev->total_sectors) {
         LOG_ERROR_MSG("ata: Read beyond device size (lba %u, count %u, total %u)\n",
                       sector, count, dev->total_sectors);
         return -1;
     }
 
     /* 获取通道锁 */
-    mutex_lock(&ata_channel_mutex[dev->channel]);
+    mutex_lock(&ata_channels[dev->channel].lock);
 
     int result = 0;
-    for (uint32_t i = 0; i < count; i++) {
-        if (ata_pio_read_sector(dev, sector + i, buffer + i * ATA_SECTOR_SIZE) != 0) {
-            LOG_ERROR_MSG("ata: Read sector %u failed\n", sector + i);
+    uint32_t done = 0;
+    while (done < count && ata_use_dma(dev)) {
+        uint32_t n = count - done;
+        if (n > ATA_MAX_SECTORS) {
+            n = ATA_MAX_SECTORS;
+        }
+        if (ata_dma_transfer(dev, sector + done, n, buffer + done * ATA_SECTOR_SIZE, false) != 0) {
+            // 设备停下之后才能返回或改用 PIO
+            ata_dma_disable(dev);
+            result = ata_channel_reset(dev);
+            break;
+        }
+        done += n;
+    }
+    while (result == 0 && done < count) {
+        uint32_t n = count - done;
+        if (n > ATA_MAX_SECTORS) {
+            n = ATA_MAX_SECTORS;
+        }
+        if (ata_pio_transfer(dev, sector + done, n, buffer + done * ATA_SECTOR_SIZE, false) != 0) {
+            LOG_ERROR_MSG("ata: Read sectors %u-%u failed\n", sector + done, sector + done + n - 1);
             result = -1;
             break;
         }
+        done += n;
     }
 
-    mutex_unlock(&ata_channel_mutex[dev->channel]);
+    mutex_unlock(&ata_channels[dev->channel].lock);
     return result;
 }
 
@@ -229,34 +649,60 @@ static int ata_blockdev_write(void *dev_ptr, uint32_t sector, uint32_t count, co
         return -1;
     }
 
-    if (sector + count > dev->total_sectors) {
+    if ((uint64_t)sector + count > dev->total_sectors) {
         LOG_ERROR_MSG("ata: Write beyond device size (lba %u, count %u, total %u)\n",
                       sector, count, dev->total_sectors);
         return -1;
     }
 
     /* 获取通道锁 */
-    mutex_lock(&ata_channel_mutex[dev->channel]);
+    mutex_lock(&ata_channels[dev->channel].lock);
 
     int result = 0;
-    for (uint32_t i = 0; i < count; i++) {
-        if (ata_pio_write_sector(dev, sector + i, buffer + i * ATA_SECTOR_SIZE) != 0) {
-            LOG_ERROR_MSG("ata: Write sector %u failed\n", sector + i);
+    uint32_t done = 0;
+    while (done < count && ata_use_dma(dev)) {
+        uint32_t n = count - done;
+        if (n > ATA_MAX_SECTORS) {
+            n = ATA_MAX_SECTORS;
+        }
+        // 控制器只读这段内存，去掉 const 只是为了共用传输函数
+        if (ata_dma_transfer(dev, sector + done, n,
+                             (uint8_t *)(uintptr_t)(buffer + done * ATA_SECTOR_SIZE), true) != 0) {
+            ata_dma_disable(dev);
+            result = ata_channel_reset(dev);
+            break;
+        }
+        done += n;
+    }
+    while (result == 0 && done < count) {
+        uint32_t n = count - done;
+        if (n > ATA_MAX_SECTORS) {
+            n = ATA_MAX_SECTORS;
+        }
+        if (ata_pio_transfer(dev, sector + done, n,
+                             (uint8_t *)(uintptr_t)(buffer + done * ATA_SECTOR_SIZE), true) != 0) {
+            LOG_ERROR_MSG("ata: Write sectors %u-%u failed\n", sector + done, sector + done + n - 1);
             result = -1;
             break;
         }
+        done += n;
     }
 
-    mutex_unlock(&ata_channel_mutex[dev->channel]);
+    mutex_unlock(&ata_channels[dev->channel].lock);
     return result;
 }
 
 void ata_init(void) {
-    /* 初始化通道 mutex */
-    mutex_init(&ata_channel_mutex[0]);  // 主通道
-    mutex_init(&ata_channel_mutex[1]);  // 次通道
-    
+    /* 初始化通道 mutex 和完成等待队列 */
+    for (uint32_t i = 0; i < 2; i++) {
+        mutex_init_named(&ata_channels[i].lock, "ata_channel");
+        wait_queue_init(&ata_channels[i].irq_wait);
+    }
+
     irq_disable_line(14);
+    irq_disable_line(15);
+
+    ata_dma_init();
     
     const char *device_names[] = {"ata0", "ata1", "ata2", "ata3"};
     const char *device_desc[] = {
@@ -278,17 +724,34 @@ void ata_init(void) {
             ata_blockdevs[i].get_size = NULL;
             ata_blockdevs[i].get_block_size = NULL;
 
+            // 一个通道同一时刻只执行一条命令，同步派发
+            if (blk_queue_init(&ata_blockdevs[i], 1) != 0) {
+                LOG_WARN_MSG("ata: %s without request queue\n", device_names[i]);
+            }
+
             if (blockdev_register(&ata_blockdevs[i]) == 0) {
-                LOG_INFO_MSG("ata: %s detected, %u sectors (approx %u MB)\n",
+                LOG_INFO_MSG("ata: %s detected, %u sectors (approx %u MB), %s, %s, multiple %u\n",
                              device_desc[i],
                              ata_devices[i].total_sectors,
-                             (ata_devices[i].total_sectors / 2048));
+                             (ata_devices[i].total_sectors / 2048),
+                             ata_use_dma(&ata_devices[i]) ? "DMA" : "PIO",
+                             ata_devices[i].lba48 ? "LBA48" : "LBA28",
+                             ata_devices[i].multiple);
             } else {
                 LOG_WARN_MSG("ata: Failed to register %s as %s\n",
                              device_desc[i], device_names[i]);
+                blk_queue_destroy(&ata_blockdevs[i]);
             }
         }
     }
+
+    /* 清除 nIEN，由 IRQ 14/15 报告命令完成 */
+    irq_register_handler(14, ata_primary_irq_handler);
+    irq_register_handler(15, ata_secondary_irq_handler);
+    outb(ATA_PRIMARY_CTRL_BASE, 0);
+    outb(ATA_SECONDARY_CTRL_BASE, 0);
+    irq_enable_line(14);
+    irq_enable_line(15);
 }
 
 
@@ -10,15 +10,22 @@
  * - MMIO 寄存器访问
  * - DMA 描述符环管理
  * - 中断驱动的数据包收发
+ * - 零拷贝收发：RX 环直接挂载 netbuf 池缓冲区，TX 直接对 netbuf DMA
+ * - 环大小可由启动参数配置，按包速率自适应调整中断节流（ITR/RDTR/RADV）
+ * - 校验和卸载：RX 由硬件验证 IP/TCP/UDP，TX 通过上下文描述符由硬件计算
  * - netdev 接口集成
  */
 
 #include <drivers/e1000.h>
 #include <drivers/pci.h>
+#include <net/ethernet.h>
 #include <kernel/io.h>
 #include <kernel/irq.h>
-#include <kernel/sync/mutex.h>
+#include <kernel/sync/spinlock.h>
+#include <drivers/timer.h>
+#include <boot/boot_info.h>
 #include <mm/heap.h>
+#include <mm/pmm.h>
 #include <mm/vmm.h>
 #include <lib/klog.h>
 #include <lib/kprintf.h>
@@ -31,8 +38,9 @@
 static e1000_device_t e1000_devices[E1000_MAX_DEVICES];
 static int e1000_device_count = 0;
 
-/* 设备访问锁 */
-static mutex_t e1000_mutex;
+/* 环大小（启动参数 e1000.rx_ring= / e1000.tx_ring=） */
+static uint32_t e1000_rx_ring_size = E1000_DEFAULT_RX_DESC;
+static uint32_t e1000_tx_ring_size = E1000_DEFAULT_TX_DESC;
 
 /* ============================================================================
  * 寄存器访问函数
@@ -114,45 +122,132 @@ static void e1000_read_mac_address(e1000_device_t *dev) {
     }
 }
 
+/* ============================================================================
+ * 启动参数
+ * ============================================================================ */
+
+uint32_t e1000_clamp_ring_size(uint32_t n) {
+    if (n < E1000_MIN_DESC) {
+        n = E1000_MIN_DESC;
+    }
+    if (n > E1000_MAX_DESC) {
+        n = E1000_MAX_DESC;
+    }
+    return n & ~7u;
+}
+
+/**
+ * @brief 在命令行中查找 "key=数字"，找到时写入 *value
+ */
+static bool e1000_cmdline_uint(const char *cmdline, const char *key, uint32_t *value) {
+    size_t key_len = strlen(key);
+    const char *p = cmdline;
+    
+    while (*p) {
+        while (*p == ' ') {
+            p++;
+        }
+        if (strncmp(p, key, key_len) == 0 && p[key_len] == '=') {
+            const char *digits = p + key_len + 1;
+            uint32_t n = 0;
+            if (*digits < '0' || *digits > '9') {
+                return false;
+            }
+            while (*digits >= '0' && *digits <= '9') {
+                n = n * 10 + (uint32_t)(*digits - '0');
+                digits++;
+            }
+            *value = n;
+            return true;
+        }
+        while (*p && *p != ' ') {
+            p++;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief 解析环大小启动参数
+ */
+static void e1000_parse_cmdline(void) {
+    boot_info_t *info = boot_info_get();
+    if (!info || !info->cmdline) {
+        return;
+    }
+    
+    uint32_t n;
+    if (e1000_cmdline_uint(info->cmdline, "e1000.rx_ring", &n)) {
+        e1000_rx_ring_size = e1000_clamp_ring_size(n);
+    }
+    if (e1000_cmdline_uint(info->cmdline, "e1000.tx_ring", &n)) {
+        e1000_tx_ring_size = e1000_clamp_ring_size(n);
+    }
+}
+
 /* ============================================================================
  * 描述符环初始化
  * ============================================================================ */
 
+/**
+ * @brief 分配物理连续的描述符数组（大环超过一页，不能用堆内存）
+ * @param size 字节数
+ * @param phys 输出物理地址
+ * @return 虚拟地址，失败返回 NULL
+ */
+static void *e1000_alloc_ring(uint32_t size, uint32_t *phys) {
+    size_t pages = (size + PAGE_SIZE - 1) / PAGE_SIZE;
+    paddr_t frame = pmm_alloc_frames(pages);
+    if (frame == PADDR_INVALID) {
+        return NULL;
+    }
+    
+    void *virt = (void *)PHYS_TO_VIRT((uintptr_t)frame);
+    memset(virt, 0, pages * PAGE_SIZE);
+    *phys = (uint32_t)frame;
+    return virt;
+}
+
 /**
  * @brief 初始化接收描述符环
  */
 static int e1000_init_rx_ring(e1000_device_t *dev) {
-    /* 分配描述符数组（16 字节对齐） */
-    uint32_t desc_size = sizeof(e1000_rx_desc_t) * E1000_NUM_RX_DESC;
-    dev->rx_descs = (e1000_rx_desc_t *)kmalloc_aligned(desc_size, 16);
+    /* 分配描述符数组（页对齐，物理连续） */
+    dev->num_rx_desc = e1000_rx_ring_size;
+    uint32_t desc_size = sizeof(e1000_rx_desc_t) * dev->num_rx_desc;
+    dev->rx_descs = (e1000_rx_desc_t *)e1000_alloc_ring(desc_size, &dev->rx_descs_phys);
     if (!dev->rx_descs) {
-        LOG_ERROR_MSG("e1000: Failed to allocate RX descriptors\n");
+        LOG_ERROR_MSG("e1000: Failed to allocate %u RX descriptors\n", dev->num_rx_desc);
         return -1;
     }
-    memset(dev->rx_descs, 0, desc_size);
     
-    /* 获取物理地址 - 必须通过页表查询，因为堆内存不是恒等映射 */
-    dev->rx_descs_phys = vmm_virt_to_phys((uint32_t)dev->rx_descs);
-    if (!dev->rx_descs_phys) {
-        LOG_ERROR_MSG("e1000: Failed to get physical address for RX descriptors\n");
+    dev->rx_bufs = (netbuf_t **)kmalloc(sizeof(netbuf_t *) * dev->num_rx_desc);
+    if (!dev->rx_bufs) {
+        LOG_ERROR_MSG("e1000: Failed to allocate RX buffer table\n");
         return -1;
     }
     
-    /* 为每个描述符分配接收缓冲区 */
-    for (int i = 0; i < E1000_NUM_RX_DESC; i++) {
-        dev->rx_buffers[i] = (uint8_t *)kmalloc_aligned(E1000_RX_BUFFER_SIZE, 16);
-        if (!dev->rx_buffers[i]) {
-            LOG_ERROR_MSG("e1000: Failed to allocate RX buffer %d\n", i);
-            return -1;
-        }
-        
-        /* 设置描述符 - 必须通过页表查询获取真正的物理地址 */
-        uint32_t buf_phys = vmm_virt_to_phys((uint32_t)dev->rx_buffers[i]);
-        if (!buf_phys) {
-            LOG_ERROR_MSG("e1000: Failed to get physical address for RX buffer %d\n", i);
+    /*
+     * 初始化接收缓冲区池（缓冲区物理连续且不跨页，可直接 DMA）：
+     * 先填充 1.5 倍环大小，协议栈持有较多缓冲区时再补充到 4 倍
+     */
+    uint32_t pool_initial = dev->num_rx_desc + dev->num_rx_desc / 2;
+    if (netbuf_pool_init(&dev->rx_pool, NETBUF_MAX_SIZE,
+                         pool_initial, dev->num_rx_desc * 4) < 0 ||
+        atomic_read(&dev->rx_pool.count) <= dev->num_rx_desc) {
+        LOG_ERROR_MSG("e1000: Failed to allocate RX buffer pool\n");
+        return -1;
+    }
+    
+    /* 每个描述符挂载一个池缓冲区，硬件直接写入 data 区 */
+    for (uint32_t i = 0; i < dev->num_rx_desc; i++) {
+        netbuf_t *buf = netbuf_pool_alloc(&dev->rx_pool);
+        if (!buf) {
+            LOG_ERROR_MSG("e1000: Failed to get RX buffer %u\n", i);
             return -1;
         }
-        dev->rx_descs[i].buffer_addr = buf_phys;
+        dev->rx_bufs[i] = buf;
+        dev->rx_descs[i].buffer_addr = netbuf_dma_addr(buf, buf->data);
         dev->rx_descs[i].status = 0;
     }
     
@@ -163,10 +258,10 @@ static int e1000_init_rx_ring(e1000_device_t *dev) {
     e1000_write_reg(dev, E1000_REG_RDBAH, 0);  // 32 位系统
     e1000_write_reg(dev, E1000_REG_RDLEN, desc_size);
     e1000_write_reg(dev, E1000_REG_RDH, 0);
-    e1000_write_reg(dev, E1000_REG_RDT, E1000_NUM_RX_DESC - 1);
+    e1000_write_reg(dev, E1000_REG_RDT, dev->num_rx_desc - 1);
     
-    LOG_DEBUG_MSG("e1000: RX ring: descs_virt=0x%x descs_phys=0x%x\n", 
-                  (uint32_t)dev->rx_descs, dev->rx_descs_phys);
+    LOG_DEBUG_MSG("e1000: RX ring: %u descs, descs_virt=0x%x descs_phys=0x%x\n", 
+                  dev->num_rx_desc, (uint32_t)dev->rx_descs, dev->rx_descs_phys);
     
     return 0;
 }
@@ -175,42 +270,32 @@ static int e1000_init_rx_ring(e1000_device_t *dev) {
  * @brief 初始化发送描述符环
  */
 static int e1000_init_tx_ring(e1000_device_t *dev) {
-    /* 分配描述符数组（16 字节对齐） */
-    uint32_t desc_size = sizeof(e1000_tx_desc_t) * E1000_NUM_TX_DESC;
-    dev->tx_descs = (e1000_tx_desc_t *)kmalloc_aligned(desc_size, 16);
+    /* 分配描述符数组（页对齐，物理连续） */
+    dev->num_tx_desc = e1000_tx_ring_size;
+    uint32_t desc_size = sizeof(e1000_tx_desc_t) * dev->num_tx_desc;
+    dev->tx_descs = (e1000_tx_desc_t *)e1000_alloc_ring(desc_size, &dev->tx_descs_phys);
     if (!dev->tx_descs) {
-        LOG_ERROR_MSG("e1000: Failed to allocate TX descriptors\n");
+        LOG_ERROR_MSG("e1000: Failed to allocate %u TX descriptors\n", dev->num_tx_desc);
         return -1;
     }
-    memset(dev->tx_descs, 0, desc_size);
     
-    /* 获取物理地址 - 必须通过页表查询，因为堆内存不是恒等映射 */
-    dev->tx_descs_phys = vmm_virt_to_phys((uint32_t)dev->tx_descs);
-    if (!dev->tx_descs_phys) {
-        LOG_ERROR_MSG("e1000: Failed to get physical address for TX descriptors\n");
+    dev->tx_bufs = (netbuf_t **)kmalloc(sizeof(netbuf_t *) * dev->num_tx_desc);
+    if (!dev->tx_bufs) {
+        LOG_ERROR_MSG("e1000: Failed to allocate TX buffer table\n");
         return -1;
     }
     
-    /* 为每个描述符分配发送缓冲区 */
-    for (int i = 0; i < E1000_NUM_TX_DESC; i++) {
-        dev->tx_buffers[i] = (uint8_t *)kmalloc_aligned(E1000_RX_BUFFER_SIZE, 16);
-        if (!dev->tx_buffers[i]) {
-            LOG_ERROR_MSG("e1000: Failed to allocate TX buffer %d\n", i);
-            return -1;
-        }
-        
-        /* 设置描述符 - 必须通过页表查询获取真正的物理地址 */
-        uint32_t buf_phys = vmm_virt_to_phys((uint32_t)dev->tx_buffers[i]);
-        if (!buf_phys) {
-            LOG_ERROR_MSG("e1000: Failed to get physical address for TX buffer %d\n", i);
-            return -1;
-        }
-        dev->tx_descs[i].buffer_addr = buf_phys;
-        dev->tx_descs[i].status = E1000_TXD_STAT_DD;  // 标记为完成（可用）
+    /* 发送缓冲区由协议栈的 netbuf 直接提供，这里只清空描述符 */
+    for (uint32_t i = 0; i < dev->num_tx_desc; i++) {
+        dev->tx_bufs[i] = NULL;
+        dev->tx_descs[i].buffer_addr = 0;
+        dev->tx_descs[i].status = 0;
         dev->tx_descs[i].cmd = 0;
     }
     
     dev->tx_cur = 0;
+    dev->tx_dirty = 0;
+    spinlock_init(&dev->tx_lock);
     
     /* 配置发送描述符寄存器 */
     e1000_write_reg(dev, E1000_REG_TDBAL, dev->tx_descs_phys);
@@ -219,8 +304,8 @@ static int e1000_init_tx_ring(e1000_device_t *dev) {
     e1000_write_reg(dev, E1000_REG_TDH, 0);
     e1000_write_reg(dev, E1000_REG_TDT, 0);
     
-    LOG_DEBUG_MSG("e1000: TX ring: descs_virt=0x%x descs_phys=0x%x\n", 
-                  (uint32_t)dev->tx_descs, dev->tx_descs_phys);
+    LOG_DEBUG_MSG("e1000: TX ring: %u descs, descs_virt=0x%x descs_phys=0x%x\n", 
+                  dev->num_tx_desc, (uint32_t)dev->tx_descs, dev->tx_descs_phys);
     
     return 0;
 }
@@ -271,6 +356,9 @@ static void e1000_init_rx(e1000_device_t *dev) {
            E1000_RCTL_SECRC;        // 剥离 CRC
     
     e1000_write_reg(dev, E1000_REG_RCTL, rctl);
+    
+    /* 由硬件验证 IP 头和 TCP/UDP 校验和，结果在描述符状态中报告 */
+    e1000_write_reg(dev, E1000_REG_RXCSUM, E1000_RXCSUM_IPOFL | E1000_RXCSUM_TUOFL);
 }
 
 /**
@@ -295,6 +383,61 @@ static void e1000_init_tx(e1000_device_t *dev) {
     e1000_write_reg(dev, E1000_REG_TIPG, tipg);
 }
 
+/**
+ * @brief 设置中断节流档位
+ * 
+ * 低速率时不节流以获得最低延迟；速率升高后限制中断频率，
+ * 并用 RDTR/RADV 推迟 RX 中断，使一次中断处理多个数据包。
+ */
+static void e1000_set_itr(e1000_device_t *dev, e1000_itr_profile_t profile) {
+    uint32_t itr, rdtr, radv;
+    
+    switch (profile) {
+        case E1000_ITR_LOW_LATENCY:
+            itr = E1000_ITR_VAL(20000);
+            rdtr = 8;       // 约 8us 内没有新包就中断
+            radv = 32;      // 最多推迟约 32us
+            break;
+        case E1000_ITR_BULK:
+            itr = E1000_ITR_VAL(4000);
+            rdtr = 32;
+            radv = 128;
+            break;
+        case E1000_ITR_LOWEST_LATENCY:
+        default:
+            itr = 0;
+            rdtr = 0;       // RDTR 为 0 时 RADV 无效
+            radv = 0;
+            break;
+    }
+    
+    e1000_write_reg(dev, E1000_REG_ITR, itr);
+    e1000_write_reg(dev, E1000_REG_RADV, radv);
+    e1000_write_reg(dev, E1000_REG_RDTR, rdtr | E1000_RDTR_FPD);
+    dev->itr_profile = profile;
+}
+
+e1000_itr_profile_t e1000_itr_select(uint32_t pps) {
+    if (pps < E1000_ITR_LOW_PPS) {
+        return E1000_ITR_LOWEST_LATENCY;
+    }
+    if (pps < E1000_ITR_BULK_PPS) {
+        return E1000_ITR_LOW_LATENCY;
+    }
+    return E1000_ITR_BULK;
+}
+
+/**
+ * @brief 根据最近窗口的包速率切换节流档位
+ */
+static void e1000_adapt_itr(e1000_device_t *dev) {
+    e1000_itr_profile_t profile = e1000_itr_select(dev->rx_pps + dev->tx_pps);
+    
+    if (profile != dev->itr_profile) {
+        e1000_set_itr(dev, profile);
+    }
+}
+
 /**
  * @brief 启用中断
  */
@@ -377,52 +520,210 @@ static int e1000_netdev_close(netdev_t *netdev) {
     return 0;
 }
 
+/**
+ * @brief 判断 TX 描述符是否为数据包的最后一个描述符
+ * 
+ * 上下文描述符的 TUCMD 与数据描述符的 cmd 同位置，其 bit 0（TCP）与 EOP 重叠，
+ * 需要按 DTYP 区分。
+ */
+static inline bool e1000_tx_desc_is_eop(const e1000_tx_desc_t *desc) {
+    if ((desc->cmd & E1000_TXD_CMD_DEXT) && (desc->cso & 0xF0) != E1000_TXD_DTYP_DATA) {
+        return false;  // 上下文描述符
+    }
+    return (desc->cmd & E1000_TXD_CMD_EOP) != 0;
+}
+
+/**
+ * @brief 回收已发送完成的 TX 描述符（调用者持有 tx_lock）
+ * 
+ * 以数据包为单位回收：只有 EOP 描述符设置了 RS 并会写回 DD，
+ * 其 DD 置位后，从 tx_dirty 到 EOP 的所有描述符（含上下文描述符）一起回收，
+ * 并释放挂在 EOP 描述符上的 netbuf。
+ */
+static void e1000_tx_reclaim(e1000_device_t *dev) {
+    while (dev->tx_dirty != dev->tx_cur) {
+        /* 找到当前数据包的 EOP 描述符 */
+        uint32_t eop = dev->tx_dirty;
+        while (!e1000_tx_desc_is_eop(&dev->tx_descs[eop])) {
+            eop = (eop + 1) % dev->num_tx_desc;
+            if (eop == dev->tx_cur) {
+                return;
+            }
+        }
+        
+        if (!(dev->tx_descs[eop].status & E1000_TXD_STAT_DD)) {
+            break;
+        }
+        
+        uint32_t i = dev->tx_dirty;
+        while (1) {
+            if (dev->tx_bufs[i]) {
+                netbuf_free(dev->tx_bufs[i]);
+                dev->tx_bufs[i] = NULL;
+            }
+            dev->tx_descs[i].cmd = 0;
+            dev->tx_descs[i].cso = 0;
+            if (i == eop) {
+                break;
+            }
+            i = (i + 1) % dev->num_tx_desc;
+        }
+        dev->tx_dirty = (eop + 1) % dev->num_tx_desc;
+    }
+}
+
+/**
+ * @brief 获取 TX 环空闲描述符数量（调用者持有 tx_lock）
+ */
+static inline uint32_t e1000_tx_free_descs(e1000_device_t *dev) {
+    return (dev->tx_dirty + dev->num_tx_desc - dev->tx_cur - 1) % dev->num_tx_desc;
+}
+
 /**
  * @brief 发送数据包
+ * 
+ * 描述符直接指向 buf->data 的物理地址，不再复制到驱动缓冲区；
+ * 每个页分片各占一个描述符（scatter-gather）。
+ * 带 NETBUF_CSUM_PARTIAL 的包使用扩展描述符，由硬件计算 TCP/UDP 校验和；
+ * 上下文参数与上一次相同时不重复下发上下文描述符。
+ * 成功时 buf 归驱动所有，在硬件写回 DD 后由 e1000_tx_reclaim() 释放。
  */
 static int e1000_netdev_transmit(netdev_t *netdev, netbuf_t *buf) {
     e1000_device_t *dev = (e1000_device_t *)netdev->priv;
     
-    if (!buf || buf->len == 0 || buf->len > 1518) {
+    if (!buf || buf->len == 0 || netbuf_total_len(buf) > 1518) {
         return -1;
     }
     
-    mutex_lock(&e1000_mutex);
+    /* 计算 DMA 分段：线性区跨页且物理不连续时拆成两个描述符 */
+    paddr_t seg_addr[E1000_TX_MAX_SEGS];
+    uint16_t seg_len[E1000_TX_MAX_SEGS];
+    uint32_t nsegs = 1;
     
-    uint32_t cur = dev->tx_cur;
-    e1000_tx_desc_t *desc = &dev->tx_descs[cur];
+    seg_addr[0] = netbuf_dma_addr(buf, buf->data);
+    seg_len[0] = (uint16_t)buf->len;
+    if (!seg_addr[0]) {
+        return -1;
+    }
     
-    /* 等待描述符可用（带超时） */
+    uintptr_t start = (uintptr_t)buf->data;
+    uintptr_t first_page_end = PAGE_ALIGN_DOWN(start) + PAGE_SIZE;
+    if (!buf->block && start + buf->len > first_page_end) {
+        uint32_t first_len = (uint32_t)(first_page_end - start);
+        paddr_t second = netbuf_dma_addr(buf, buf->data + first_len);
+        if (!second) {
+            return -1;
+        }
+        if (second != seg_addr[0] + first_len) {
+            seg_len[0] = (uint16_t)first_len;
+            seg_addr[1] = second;
+            seg_len[1] = (uint16_t)(buf->len - first_len);
+            nsegs = 2;
+        }
+    }
+    
+    /* 分片本身不跨页，直接对应一个描述符 */
+    for (uint8_t i = 0; i < buf->nr_frags; i++) {
+        seg_addr[nsegs] = buf->frags[i].page + buf->frags[i].offset;
+        seg_len[nsegs] = buf->frags[i].len;
+        nsegs++;
+    }
+    
+    /* 校验和卸载参数（偏移相对于以太网帧起点） */
+    bool csum = (buf->csum_flags & NETBUF_CSUM_PARTIAL) != 0;
+    uint32_t tucss = 0, tucso = 0, ctx_key = 0;
+    if (csum) {
+        tucss = (uint32_t)(buf->head + buf->csum_start - buf->data);
+        tucso = tucss + buf->csum_offset;
+        if (buf->head + buf->csum_start < buf->data || tucso + 2 > buf->len || tucso > 0xFF) {
+            return -1;
+        }
+        ctx_key = (1u << 31) | (tucss << 8) | tucso;
+    }
+    
+    bool irq_state;
+    spinlock_lock_irqsave(&dev->tx_lock, &irq_state);
+    
+    /* 需要的描述符数：数据段 + 可能的上下文描述符 */
+    uint32_t needed = nsegs + ((csum && ctx_key != dev->tx_ctx_key) ? 1 : 0);
+    
+    /* 回收已完成的描述符，必要时等待（带超时） */
     int timeout = 10000;
-    while (!(desc->status & E1000_TXD_STAT_DD) && timeout-- > 0) {
-        /* 忙等待 */
+    e1000_tx_reclaim(dev);
+    while (e1000_tx_free_descs(dev) < needed && timeout-- > 0) {
+        e1000_tx_reclaim(dev);
     }
     
-    if (timeout <= 0) {
-        LOG_WARN_MSG("e1000: TX descriptor not available (timeout)\n");
-        mutex_unlock(&e1000_mutex);
+    if (e1000_tx_free_descs(dev) < needed) {
+        dev->tx_ring_full++;
+        spinlock_unlock_irqrestore(&dev->tx_lock, irq_state);
+        LOG_WARN_MSG("e1000: TX ring full (timeout)\n");
         return -1;
     }
     
-    /* 复制数据到发送缓冲区 */
-    memcpy(dev->tx_buffers[cur], buf->data, buf->len);
+    uint32_t cur = dev->tx_cur;
     
-    /* 设置描述符 */
-    desc->length = buf->len;
-    desc->status = 0;
-    desc->cmd = E1000_TXD_CMD_EOP |   // 数据包结束
-                E1000_TXD_CMD_IFCS |  // 插入 FCS
-                E1000_TXD_CMD_RS;     // 报告状态
+    /* 校验和参数变化时先下发上下文描述符 */
+    if (needed > nsegs) {
+        e1000_tx_context_desc_t *ctx = (e1000_tx_context_desc_t *)&dev->tx_descs[cur];
+        uint32_t ipcss = ETH_HEADER_LEN;
+        
+        ctx->ipcss = (uint8_t)ipcss;
+        ctx->ipcso = (uint8_t)(ipcss + 10);
+        ctx->ipcse = (uint16_t)(tucss - 1);
+        ctx->tucss = (uint8_t)tucss;
+        ctx->tucso = (uint8_t)tucso;
+        ctx->tucse = 0;
+        ctx->paylen = 0;
+        ctx->dtyp = 0;
+        ctx->tucmd = E1000_TXD_CMD_DEXT | E1000_TXD_TUCMD_IP;
+        ctx->status = 0;
+        ctx->hdr_len = 0;
+        ctx->mss = 0;
+        
+        dev->tx_bufs[cur] = NULL;
+        dev->tx_ctx_key = ctx_key;
+        cur = (cur + 1) % dev->num_tx_desc;
+    }
+    
+    /* 填充描述符 */
+    for (uint32_t i = 0; i < nsegs; i++) {
+        e1000_tx_desc_t *desc = &dev->tx_descs[cur];
+        bool last = (i == nsegs - 1);
+        
+        desc->buffer_addr = seg_addr[i];
+        desc->length = seg_len[i];
+        desc->special = 0;
+        desc->status = 0;
+        desc->cmd = E1000_TXD_CMD_IFCS |                          // 插入 FCS
+                    (last ? (E1000_TXD_CMD_EOP | E1000_TXD_CMD_RS) : 0); // 包结束并报告状态
+        if (csum) {
+            /* 扩展数据描述符，POPTS 只在包的第一个描述符中生效 */
+            desc->cso = E1000_TXD_DTYP_DATA;
+            desc->css = (i == 0) ? E1000_TXD_POPTS_TXSM : 0;
+            desc->cmd |= E1000_TXD_CMD_DEXT;
+        } else {
+            desc->cso = 0;
+            desc->css = 0;
+        }
+        
+        /* 缓冲区挂在最后一个描述符上，整包发送完成后释放 */
+        dev->tx_bufs[cur] = last ? buf : NULL;
+        cur = (cur + 1) % dev->num_tx_desc;
+    }
     
     /* 更新尾指针，触发发送 */
-    dev->tx_cur = (cur + 1) % E1000_NUM_TX_DESC;
+    dev->tx_cur = cur;
     e1000_write_reg(dev, E1000_REG_TDT, dev->tx_cur);
     
     /* 更新统计 */
     dev->tx_packets++;
-    dev->tx_bytes += buf->len;
+    dev->tx_bytes += netbuf_total_len(buf);
+    if (csum) {
+        dev->tx_csum_offload++;
+    }
     
-    mutex_unlock(&e1000_mutex);
+    spinlock_unlock_irqrestore(&dev->tx_lock, irq_state);
     
     return 0;
 }
@@ -447,22 +748,110 @@ static int e1000_netdev_set_mac(netdev_t *netdev, uint8_t *mac) {
     return 0;
 }
 
+/**
+ * @brief 更新收发速率统计（调用者持有 rate_lock）
+ * 
+ * 每经过 E1000_RATE_INTERVAL_MS 计算一次窗口内的 pps 和吞吐量，
+ * 用于比较不同收发路径（如复制/零拷贝）的性能。
+ */
+static void e1000_update_rates(e1000_device_t *dev) {
+    uint64_t now = timer_get_uptime_ms();
+    uint64_t elapsed = now - dev->rate_start_ms;
+    
+    if (elapsed < E1000_RATE_INTERVAL_MS) {
+        return;
+    }
+    
+    dev->rx_pps = (uint32_t)((dev->rx_packets - dev->rate_rx_packets) * 1000 / elapsed);
+    dev->tx_pps = (uint32_t)((dev->tx_packets - dev->rate_tx_packets) * 1000 / elapsed);
+    dev->rx_kbps = (uint32_t)((dev->rx_bytes - dev->rate_rx_bytes) * 8 / elapsed);
+    dev->tx_kbps = (uint32_t)((dev->tx_bytes - dev->rate_tx_bytes) * 8 / elapsed);
+    dev->irq_rate = (uint32_t)((dev->interrupts - dev->rate_interrupts) * 1000 / elapsed);
+    
+    dev->rate_start_ms = now;
+    dev->rate_rx_packets = dev->rx_packets;
+    dev->rate_tx_packets = dev->tx_packets;
+    dev->rate_rx_bytes = dev->rx_bytes;
+    dev->rate_tx_bytes = dev->tx_bytes;
+    dev->rate_interrupts = dev->interrupts;
+    
+    e1000_adapt_itr(dev);
+}
+
+/**
+ * @brief 打印驱动私有统计（ifconfig 调用）
+ */
+static void e1000_netdev_print_stats(netdev_t *netdev) {
+    e1000_device_t *dev = (e1000_device_t *)netdev->priv;
+    
+    // 中断处理程序也会更新速率和节流档位：在锁内刷新并取快照
+    bool irq_state;
+    spinlock_lock_irqsave(&dev->rate_lock, &irq_state);
+    e1000_update_rates(dev);
+    uint32_t rx_pps = dev->rx_pps;
+    uint32_t tx_pps = dev->tx_pps;
+    uint32_t rx_kbps = dev->rx_kbps;
+    uint32_t tx_kbps = dev->tx_kbps;
+    uint32_t irq_rate = dev->irq_rate;
+    e1000_itr_profile_t itr_profile = dev->itr_profile;
+    spinlock_unlock_irqrestore(&dev->rate_lock, irq_state);
+    
+    kprintf("        RX rate %u pps  %u Kbit/s  TX rate %u pps  %u Kbit/s\n",
+            rx_pps, rx_kbps, tx_pps, tx_kbps);
+    kprintf("        RX zero-copy %llu  copied %llu  pool free %u/%u (min %u)\n",
+            dev->rx_zero_copy, dev->rx_copied,
+            atomic_read(&dev->rx_pool.free_count), atomic_read(&dev->rx_pool.count),
+            dev->rx_pool.min_free);
+    kprintf("        TX ring full %llu  csum offload %llu  RX csum ok %llu\n",
+            dev->tx_ring_full, dev->tx_csum_offload, dev->rx_csum_ok);
+    kprintf("        Rings RX %u TX %u  IRQ rate %u/s  ITR profile %s\n",
+            dev->num_rx_desc, dev->num_tx_desc, irq_rate,
+            itr_profile == E1000_ITR_BULK ? "bulk" :
+            itr_profile == E1000_ITR_LOW_LATENCY ? "low-latency" : "lowest-latency");
+}
+
 /* netdev 操作函数表 */
 static netdev_ops_t e1000_netdev_ops = {
     .open = e1000_netdev_open,
     .close = e1000_netdev_close,
     .transmit = e1000_netdev_transmit,
     .set_mac = e1000_netdev_set_mac,
+    .print_stats = e1000_netdev_print_stats,
 };
 
 /* ============================================================================
  * 中断处理
  * ============================================================================ */
 
+/**
+ * @brief 根据描述符状态标记硬件已验证的校验和
+ * 
+ * 校验和错误的包不做标记，交由协议栈用软件重新验证后丢弃。
+ */
+static inline void e1000_rx_csum(e1000_device_t *dev, const e1000_rx_desc_t *desc, netbuf_t *buf) {
+    if (desc->status & E1000_RXD_STAT_IXSM) {
+        return;
+    }
+    if ((desc->status & E1000_RXD_STAT_IPCS) && !(desc->errors & E1000_RXD_ERR_IPE)) {
+        buf->csum_flags |= NETBUF_CSUM_IP_VALID;
+    }
+    if ((desc->status & E1000_RXD_STAT_TCPCS) && !(desc->errors & E1000_RXD_ERR_TCPE)) {
+        buf->csum_flags |= NETBUF_CSUM_L4_VALID;
+        dev->rx_csum_ok++;
+    }
+}
+
 /**
  * @brief 处理接收到的数据包
+ * 
+ * 已填充的池缓冲区直接上交协议栈，描述符换上池中的新缓冲区；
+ * 池耗尽时回退为复制，原缓冲区留在环上继续使用。
+ * 归还的描述符累积 E1000_RX_TAIL_BATCH 个才写一次 RDT（MMIO 写开销大）。
  */
 void e1000_receive(e1000_device_t *dev) {
+    uint32_t pending = 0;
+    uint32_t last = 0;
+    
     while (1) {
         uint32_t cur = dev->rx_cur;
         e1000_rx_desc_t *desc = &dev->rx_descs[cur];
@@ -472,17 +861,34 @@ void e1000_receive(e1000_device_t *dev) {
             break;
         }
         
-        /* 检查是否是完整的数据包 */
+        /* 检查是否是完整的数据包（未开启 LPE，帧最长 1522 字节，不会越过 data 区） */
         if (desc->status & E1000_RXD_STAT_EOP) {
             uint16_t len = desc->length;
+            netbuf_t *ring_buf = dev->rx_bufs[cur];
             
-            if (len > 0 && len <= E1000_RX_BUFFER_SIZE) {
-                /* 分配网络缓冲区 */
-                netbuf_t *buf = netbuf_alloc(len);
+            if (len > 0 && len <= netbuf_tailroom(ring_buf)) {
+                netbuf_t *buf = NULL;
+                netbuf_t *fresh = netbuf_pool_alloc(&dev->rx_pool);
+                
+                if (fresh) {
+                    /* 零拷贝：上交环上的缓冲区，换上新缓冲区 */
+                    buf = ring_buf;
+                    netbuf_put(buf, len);
+                    dev->rx_bufs[cur] = fresh;
+                    desc->buffer_addr = netbuf_dma_addr(fresh, fresh->data);
+                    dev->rx_zero_copy++;
+                } else {
+                    /* 池耗尽：复制出来，保留环上的缓冲区 */
+                    buf = netbuf_alloc(len);
+                    if (buf) {
+                        memcpy(netbuf_put(buf, len), ring_buf->data, len);
+                        dev->rx_copied++;
+                    }
+                }
+                
                 if (buf) {
-                    /* 复制数据 */
-                    memcpy(netbuf_put(buf, len), dev->rx_buffers[cur], len);
                     buf->dev = &dev->netdev;
+                    e1000_rx_csum(dev, desc, buf);
                     
                     /* 更新统计 */
                     dev->rx_packets++;
@@ -494,13 +900,19 @@ void e1000_receive(e1000_device_t *dev) {
             }
         }
         
-        /* 重置描述符 */
+        /* 重置描述符，归还给硬件 */
         desc->status = 0;
+        last = cur;
+        dev->rx_cur = (cur + 1) % dev->num_rx_desc;
         
-        /* 更新 RDT */
-        uint32_t old_cur = dev->rx_cur;
-        dev->rx_cur = (cur + 1) % E1000_NUM_RX_DESC;
-        e1000_write_reg(dev, E1000_REG_RDT, old_cur);
+        if (++pending >= E1000_RX_TAIL_BATCH) {
+            e1000_write_reg(dev, E1000_REG_RDT, last);
+            pending = 0;
+        }
+    }
+    
+    if (pending) {
+        e1000_write_reg(dev, E1000_REG_RDT, last);
     }
 }
 
@@ -518,6 +930,7 @@ static void e1000_irq_handler(registers_t *regs) {
         if (icr == 0) {
             continue;
         }
+        dev->interrupts++;
         
         /* 处理接收中断 */
         if (icr & (E1000_ICR_RXT0 | E1000_ICR_RXDMT0 | E1000_ICR_RXO)) {
@@ -534,10 +947,16 @@ static void e1000_irq_handler(registers_t *regs) {
                         dev->full_duplex ? "full" : "half");
         }
         
-        /* 处理发送完成 */
+        /* 处理发送完成：回收描述符并释放已发送的 netbuf */
         if (icr & E1000_ICR_TXDW) {
-            /* 发送完成，可以回收描述符 */
+            spinlock_lock(&dev->tx_lock);
+            e1000_tx_reclaim(dev);
+            spinlock_unlock(&dev->tx_lock);
         }
+        
+        spinlock_lock(&dev->rate_lock);
+        e1000_update_rates(dev);
+        spinlock_unlock(&dev->rate_lock);
     }
 }
 
@@ -608,6 +1027,8 @@ static int e1000_init_device(pci_device_t *pci_dev) {
     /* 初始化接收和发送 */
     e1000_init_rx(dev);
     e1000_init_tx(dev);
+    spinlock_init(&dev->rate_lock);
+    e1000_set_itr(dev, E1000_ITR_LOWEST_LATENCY);
     
     /* 设置链路启用 */
     uint32_t ctrl = e1000_read_reg(dev, E1000_REG_CTRL);
@@ -635,6 +1056,7 @@ static int e1000_init_device(pci_device_t *pci_dev) {
     strcpy(dev->netdev.name, name);
     memcpy(dev->netdev.mac, dev->mac_addr, 6);
     dev->netdev.mtu = 1500;
+    dev->netdev.features = NETDEV_F_SG | NETDEV_F_HW_CSUM;
     dev->netdev.state = NETDEV_DOWN;
     dev->netdev.ops = &e1000_netdev_ops;
     dev->netdev.priv = dev;
@@ -681,8 +1103,8 @@ static const uint16_t e1000_device_ids[] = {
  * @brief 初始化 E1000 驱动
  */
 int e1000_init(void) {
-    mutex_init(&e1000_mutex);
     e1000_device_count = 0;
+    e1000_parse_cmdline();
     
     /* 扫描 PCI 总线查找 E1000 设备 */
     for (int i = 0; e1000_device_ids[i] != 0; i++) {
@@ -713,14 +1135,24 @@ e1000_device_t *e1000_get_device(int index) {
 }
 
 int e1000_send(e1000_device_t *dev, void *data, uint32_t len) {
-    netbuf_t buf;
-    buf.data = (uint8_t *)data;
-    buf.len = len;
-    buf.head = buf.data;
-    buf.tail = buf.data + len;
-    buf.end = buf.data + len;
-    buf.total_size = len;
-    return e1000_netdev_transmit(&dev->netdev, &buf);
+    /* 发送路径直接对 netbuf DMA，调用者的数据需要先放入 netbuf */
+    netbuf_t *buf = netbuf_alloc(len);
+    if (!buf) {
+        return -1;
+    }
+    
+    uint8_t *ptr = netbuf_put(buf, len);
+    if (!ptr) {
+        netbuf_free(buf);
+        return -1;
+    }
+    memcpy(ptr, data, len);
+    
+    int ret = e1000_netdev_transmit(&dev->netdev, buf);
+    if (ret < 0) {
+        netbuf_free(buf);
+    }
+    return ret;
 }
 
 void e1000_get_mac(e1000_device_t *dev, uint8_t *mac) {
@@ -754,5 +1186,6 @@ void e1000_print_info(e1000_device_t *dev) {
     kprintf("  Duplex: %s\n", dev->full_duplex ? "full" : "half");
     kprintf("  RX: %llu packets, %llu bytes\n", dev->rx_packets, dev->rx_bytes);
     kprintf("  TX: %llu packets, %llu bytes\n", dev->tx_packets, dev->tx_bytes);
+    e1000_netdev_print_stats(&dev->netdev);
 }
 
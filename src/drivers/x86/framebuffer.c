@@ -36,8 +36,50 @@ static color_t term_bg = {0, 0, 0, 255};        // 黑色
 /** 双缓冲支持 */
 static uint8_t *back_buffer_mem = NULL;   // 后备缓冲区（在普通内存中）
 static bool double_buffering = false;      // 是否启用双缓冲
-static int dirty_line_start = -1;          // 脏区域起始行
-static int dirty_line_end = -1;            // 脏区域结束行
+static uint32_t scroll_offset = 0;         // 环形后备缓冲区：屏幕第 0 行所在的物理行
+
+/**
+ * 脏矩形（屏幕坐标，右、下边界不含）
+ *
+ * 新矩形与已有矩形相交或相邻时合并；表满时全部合并为外接矩形
+ */
+#define FB_MAX_DIRTY_RECTS 8
+
+typedef struct {
+    int x0, y0, x1, y1;
+} fb_rect_t;
+
+static fb_rect_t dirty_rects[FB_MAX_DIRTY_RECTS];
+static int dirty_count = 0;
+
+/**
+ * 字形行缓存
+ *
+ * 每个 (前景, 背景) 像素对预先渲染 256 种 8 像素行模式，绘制字符时字形的每一行
+ * 查表后按机器字整行复制。行模式与字体无关，换字体不需要失效。
+ */
+#define FB_GLYPH_CACHE_SLOTS 4
+#define FB_GLYPH_ROW_BYTES   32             // 8 像素 × 最多 4 字节
+
+#ifdef ARCH_X86_64
+typedef uint64_t fb_word_t;
+#else
+typedef uint32_t fb_word_t;
+#endif
+
+typedef struct {
+    uint32_t fg;
+    uint32_t bg;
+    bool valid;
+    uint32_t last_used;
+    uint8_t rows[256][FB_GLYPH_ROW_BYTES] __attribute__((aligned(8)));
+} fb_glyph_cache_t;
+
+static fb_glyph_cache_t glyph_cache[FB_GLYPH_CACHE_SLOTS];
+static fb_glyph_cache_t *glyph_cache_last = NULL;
+static uint32_t glyph_cache_clock = 0;
+
+static fb_console_stats_t fb_stats;
 
 /* VGA 16 色调色板 → RGB 颜色 */
 static const color_t vga_palette[16] = {
@@ -79,8 +121,7 @@ static bool ansi_bold = false;
 
 /* 前置声明 */
 static void fb_handle_sgr(void);
-static inline uint8_t *fb_get_draw_buffer(void);
-static inline void fb_mark_dirty(int y_start, int y_end);
+static void fb_mark_dirty(int x0, int y0, int x1, int y1);
 
 /* ============================================================================
  * 内部辅助函数
@@ -142,27 +183,54 @@ static inline color_t pixel_to_color(uint32_t pixel) {
 }
 
 /**
- * @brief 快速设置像素（内联，无边界检查）
+ * @brief 获取屏幕第 y 行在绘图缓冲区中的地址
+ * 
+ * 双缓冲时后备缓冲区是环形的，屏幕第 0 行位于物理行 scroll_offset；
+ * 否则直接返回帧缓冲中的行
+ */
+static inline uint8_t *fb_row(int y) {
+    if (double_buffering) {
+        uint32_t py = (uint32_t)y + scroll_offset;
+        if (py >= fb_info.height) {
+            py -= fb_info.height;
+        }
+        return back_buffer_mem + py * fb_info.pitch;
+    }
+    return (uint8_t *)fb_info.buffer + (uint32_t)y * fb_info.pitch;
+}
+
+/**
+ * @brief 快速设置像素（内联，无边界检查，不标记脏区域）
  * 
  * 如果启用了双缓冲，写入后备缓冲区；否则直接写入帧缓冲
  */
 static inline void fb_put_pixel_fast(int x, int y, uint32_t pixel) {
-    uint8_t *draw_buf = fb_get_draw_buffer();
-    uint32_t offset = y * fb_info.pitch + x * (fb_info.bpp / 8);
+    uint8_t *line = fb_row(y) + x * (fb_info.bpp / 8);
     
     if (fb_info.bpp == 32) {
-        *((uint32_t *)(draw_buf + offset)) = pixel;
+        *((uint32_t *)line) = pixel;
     } else if (fb_info.bpp == 24) {
-        draw_buf[offset] = pixel & 0xFF;
-        draw_buf[offset + 1] = (pixel >> 8) & 0xFF;
-        draw_buf[offset + 2] = (pixel >> 16) & 0xFF;
+        line[0] = pixel & 0xFF;
+        line[1] = (pixel >> 8) & 0xFF;
+        line[2] = (pixel >> 16) & 0xFF;
     } else if (fb_info.bpp == 16) {
-        *((uint16_t *)(draw_buf + offset)) = (uint16_t)pixel;
+        *((uint16_t *)line) = (uint16_t)pixel;
     }
-    
-    // 标记脏行
-    if (double_buffering) {
-        fb_mark_dirty(y, y + 1);
+}
+
+/**
+ * @brief 用同一像素填充第 y 行的 [x, x + width)（无边界检查）
+ */
+static void fb_fill_span(int x, int y, int width, uint32_t pixel) {
+    if (fb_info.bpp == 32) {
+        uint32_t *p = (uint32_t *)fb_row(y) + x;
+        for (int i = 0; i < width; i++) {
+            p[i] = pixel;
+        }
+    } else {
+        for (int i = 0; i < width; i++) {
+            fb_put_pixel_fast(x + i, y, pixel);
+        }
     }
 }
 
@@ -287,55 +355,130 @@ void fb_enable_double_buffer(void) {
     // 将当前帧缓冲内容复制到后备缓冲区
     memcpy(back_buffer_mem, fb_info.buffer, fb_size);
     
+    scroll_offset = 0;
+    dirty_count = 0;
     double_buffering = true;
-    dirty_line_start = -1;
-    dirty_line_end = -1;
     
     LOG_INFO_MSG("fb: Double buffering enabled (%u KB back buffer)\n", fb_size / 1024);
 }
 
 /**
- * @brief 标记脏区域
+ * @brief 标记脏矩形 [x0, x1) × [y0, y1)
+ * 
+ * 与已有矩形相交或相邻时合并，表满时全部合并为外接矩形
  */
-static inline void fb_mark_dirty(int y_start, int y_end) {
+static void fb_mark_dirty(int x0, int y0, int x1, int y1) {
     if (!double_buffering) return;
     
-    if (dirty_line_start < 0 || y_start < dirty_line_start) {
-        dirty_line_start = y_start;
+    if (x0 < 0) x0 = 0;
+    if (y0 < 0) y0 = 0;
+    if (x1 > (int)fb_info.width) x1 = fb_info.width;
+    if (y1 > (int)fb_info.height) y1 = fb_info.height;
+    if (x0 >= x1 || y0 >= y1) return;
+    
+    for (int i = 0; i < dirty_count; i++) {
+        fb_rect_t *r = &dirty_rects[i];
+        if (x0 <= r->x1 && r->x0 <= x1 && y0 <= r->y1 && r->y0 <= y1) {
+            if (x0 < r->x0) r->x0 = x0;
+            if (y0 < r->y0) r->y0 = y0;
+            if (x1 > r->x1) r->x1 = x1;
+            if (y1 > r->y1) r->y1 = y1;
+            return;
+        }
+    }
+    
+    if (dirty_count < FB_MAX_DIRTY_RECTS) {
+        dirty_rects[dirty_count].x0 = x0;
+        dirty_rects[dirty_count].y0 = y0;
+        dirty_rects[dirty_count].x1 = x1;
+        dirty_rects[dirty_count].y1 = y1;
+        dirty_count++;
+        return;
     }
-    if (dirty_line_end < 0 || y_end > dirty_line_end) {
-        dirty_line_end = y_end;
+    
+    // 表满：合并为一个外接矩形
+    fb_rect_t *bound = &dirty_rects[0];
+    for (int i = 1; i < dirty_count; i++) {
+        if (dirty_rects[i].x0 < bound->x0) bound->x0 = dirty_rects[i].x0;
+        if (dirty_rects[i].y0 < bound->y0) bound->y0 = dirty_rects[i].y0;
+        if (dirty_rects[i].x1 > bound->x1) bound->x1 = dirty_rects[i].x1;
+        if (dirty_rects[i].y1 > bound->y1) bound->y1 = dirty_rects[i].y1;
+    }
+    dirty_count = 1;
+    fb_mark_dirty(x0, y0, x1, y1);
+}
+
+/**
+ * @brief 标记整个屏幕为脏
+ */
+static inline void fb_mark_all_dirty(void) {
+    if (!double_buffering) return;
+    
+    dirty_rects[0].x0 = 0;
+    dirty_rects[0].y0 = 0;
+    dirty_rects[0].x1 = fb_info.width;
+    dirty_rects[0].y1 = fb_info.height;
+    dirty_count = 1;
+}
+
+/**
+ * @brief 把屏幕行 [y0, y1) 整行复制到显存
+ * 
+ * 环形后备缓冲区中这些行最多分成两段连续内存
+ */
+static void fb_flush_rows(int y0, int y1) {
+    while (y0 < y1) {
+        uint32_t py = (uint32_t)y0 + scroll_offset;
+        if (py >= fb_info.height) {
+            py -= fb_info.height;
+        }
+        uint32_t n = (uint32_t)(y1 - y0);
+        if (n > fb_info.height - py) {
+            n = fb_info.height - py;
+        }
+        memcpy((uint8_t *)fb_info.buffer + (uint32_t)y0 * fb_info.pitch,
+               back_buffer_mem + py * fb_info.pitch, n * fb_info.pitch);
+        fb_stats.flush_bytes += (uint64_t)n * fb_info.pitch;
+        y0 += n;
     }
 }
 
 /**
  * @brief 刷新后备缓冲区到显存
  * 
- * 只刷新脏区域以提升性能
+ * 只复制脏矩形；整行宽的矩形按连续内存复制
  */
 void fb_flush(void) {
     if (!double_buffering || !back_buffer_mem) {
         return;
     }
     
-    if (dirty_line_start < 0 || dirty_line_end < 0) {
+    if (dirty_count == 0) {
         return;  // 没有脏区域
     }
     
-    // 限制脏区域范围
-    if (dirty_line_start < 0) dirty_line_start = 0;
-    if (dirty_line_end > (int)fb_info.height) dirty_line_end = fb_info.height;
-    
-    // 计算脏区域的起始偏移和大小
-    uint32_t offset = dirty_line_start * fb_info.pitch;
-    uint32_t size = (dirty_line_end - dirty_line_start) * fb_info.pitch;
+    uint32_t bytes_per_pixel = fb_info.bpp / 8;
     
-    // 复制脏区域到显存
-    memcpy((uint8_t *)fb_info.buffer + offset, back_buffer_mem + offset, size);
+    for (int i = 0; i < dirty_count; i++) {
+        fb_rect_t *r = &dirty_rects[i];
+        
+        if (r->x0 == 0 && r->x1 == (int)fb_info.width) {
+            fb_flush_rows(r->y0, r->y1);
+            continue;
+        }
+        
+        uint32_t offset = r->x0 * bytes_per_pixel;
+        uint32_t size = (r->x1 - r->x0) * bytes_per_pixel;
+        for (int y = r->y0; y < r->y1; y++) {
+            memcpy((uint8_t *)fb_info.buffer + (uint32_t)y * fb_info.pitch + offset,
+                   fb_row(y) + offset, size);
+        }
+        fb_stats.flush_bytes += (uint64_t)size * (r->y1 - r->y0);
+    }
     
     // 清除脏标记
-    dirty_line_start = -1;
-    dirty_line_end = -1;
+    dirty_count = 0;
+    fb_stats.flushes++;
 }
 
 /**
@@ -346,20 +489,16 @@ void fb_flush_all(void) {
         return;
     }
     
-    uint32_t fb_size = fb_info.pitch * fb_info.height;
-    memcpy(fb_info.buffer, back_buffer_mem, fb_size);
+    fb_flush_rows(0, fb_info.height);
     
-    dirty_line_start = -1;
-    dirty_line_end = -1;
+    dirty_count = 0;
+    fb_stats.flushes++;
 }
 
-/**
- * @brief 获取当前绘图缓冲区
- * 
- * 如果启用了双缓冲，返回后备缓冲区；否则返回帧缓冲
- */
-static inline uint8_t *fb_get_draw_buffer(void) {
-    return double_buffering && back_buffer_mem ? back_buffer_mem : (uint8_t *)fb_info.buffer;
+void fb_get_stats(fb_console_stats_t *stats) {
+    if (stats) {
+        *stats = fb_stats;
+    }
 }
 
 /* ============================================================================
@@ -370,28 +509,17 @@ void fb_clear(color_t color) {
     if (!fb_initialized) return;
     
     uint32_t pixel = color_to_pixel(color);
-    uint8_t *draw_buf = fb_get_draw_buffer();
     
-    if (fb_info.bpp == 32) {
-        // 32bpp：使用 32 位填充，效率最高
-        uint32_t *fb = (uint32_t *)draw_buf;
-        uint32_t count = fb_info.pitch * fb_info.height / 4;
-        
-        for (uint32_t i = 0; i < count; i++) {
-            fb[i] = pixel;
-        }
-    } else {
-        // 其他格式：逐像素填充
-        for (uint32_t y = 0; y < fb_info.height; y++) {
-            for (uint32_t x = 0; x < fb_info.width; x++) {
-                fb_put_pixel_fast(x, y, pixel);
-            }
-        }
+    // 清屏时环形缓冲区回到起点
+    scroll_offset = 0;
+    
+    for (uint32_t y = 0; y < fb_info.height; y++) {
+        fb_fill_span(0, y, fb_info.width, pixel);
     }
     
     // 标记整个屏幕为脏
     if (double_buffering) {
-        fb_mark_dirty(0, fb_info.height);
+        fb_mark_all_dirty();
         fb_flush();  // 清屏后立即刷新
     }
 }
@@ -401,6 +529,7 @@ void fb_put_pixel(int x, int y, color_t color) {
     if (x < 0 || x >= (int)fb_info.width || y < 0 || y >= (int)fb_info.height) return;
     
     fb_put_pixel_fast(x, y, color_to_pixel(color));
+    fb_mark_dirty(x, y, x + 1, y + 1);
 }
 
 color_t fb_get_pixel(int x, int y) {
@@ -409,16 +538,15 @@ color_t fb_get_pixel(int x, int y) {
     if (!fb_initialized) return c;
     if (x < 0 || x >= (int)fb_info.width || y < 0 || y >= (int)fb_info.height) return c;
     
-    uint8_t *draw_buf = fb_get_draw_buffer();
-    uint32_t offset = y * fb_info.pitch + x * (fb_info.bpp / 8);
+    const uint8_t *line = fb_row(y) + x * (fb_info.bpp / 8);
     uint32_t pixel = 0;
     
     if (fb_info.bpp == 32) {
-        pixel = *((uint32_t *)(draw_buf + offset));
+        pixel = *((const uint32_t *)line);
     } else if (fb_info.bpp == 24) {
-        pixel = draw_buf[offset] | (draw_buf[offset + 1] << 8) | (draw_buf[offset + 2] << 16);
+        pixel = line[0] | (line[1] << 8) | (line[2] << 16);
     } else if (fb_info.bpp == 16) {
-        pixel = *((uint16_t *)(draw_buf + offset));
+        pixel = *((const uint16_t *)line);
     }
     
     return pixel_to_color(pixel);
@@ -433,23 +561,8 @@ void fb_draw_hline(int x, int y, int length, color_t color) {
     if (x + length > (int)fb_info.width) { length = fb_info.width - x; }
     if (length <= 0) return;
     
-    uint32_t pixel = color_to_pixel(color);
-    uint8_t *draw_buf = fb_get_draw_buffer();
-    
-    if (fb_info.bpp == 32) {
-        uint32_t *line = (uint32_t *)(draw_buf + y * fb_info.pitch);
-        for (int i = 0; i < length; i++) {
-            line[x + i] = pixel;
-        }
-    } else {
-        for (int i = 0; i < length; i++) {
-            fb_put_pixel_fast(x + i, y, pixel);
-        }
-    }
-    
-    if (double_buffering) {
-        fb_mark_dirty(y, y + 1);
-    }
+    fb_fill_span(x, y, length, color_to_pixel(color));
+    fb_mark_dirty(x, y, x + length, y + 1);
 }
 
 void fb_draw_vline(int x, int y, int length, color_t color) {
@@ -466,6 +579,7 @@ void fb_draw_vline(int x, int y, int length, color_t color) {
     for (int i = 0; i < length; i++) {
         fb_put_pixel_fast(x, y + i, pixel);
     }
+    fb_mark_dirty(x, y, x + 1, y + length);
 }
 
 void fb_draw_line(int x1, int y1, int x2, int y2, color_t color) {
@@ -515,27 +629,12 @@ void fb_fill_rect(int x, int y, int width, int height, color_t color) {
     if (width <= 0 || height <= 0) return;
     
     uint32_t pixel = color_to_pixel(color);
-    uint32_t bytes_per_pixel = fb_info.bpp / 8;
-    uint8_t *draw_buf = fb_get_draw_buffer();
     
     for (int row = 0; row < height; row++) {
-        uint8_t *line = draw_buf + (y + row) * fb_info.pitch + x * bytes_per_pixel;
-        
-        if (fb_info.bpp == 32) {
-            uint32_t *p = (uint32_t *)line;
-            for (int col = 0; col < width; col++) {
-                p[col] = pixel;
-            }
-        } else {
-            for (int col = 0; col < width; col++) {
-                fb_put_pixel_fast(x + col, y + row, pixel);
-            }
-        }
+        fb_fill_span(x, y + row, width, pixel);
     }
     
-    if (double_buffering) {
-        fb_mark_dirty(y, y + height);
-    }
+    fb_mark_dirty(x, y, x + width, y + height);
 }
 
 /* ============================================================================
@@ -600,24 +699,93 @@ void fb_set_font(const uint8_t *font_data, int char_width, int char_height) {
     }
 }
 
+/**
+ * @brief 取 (fg, bg) 像素对的行模式表，未命中时淘汰最久未用的槽位并重新渲染
+ */
+static const fb_glyph_cache_t *fb_glyph_cache_get(uint32_t fg, uint32_t bg) {
+    fb_glyph_cache_t *gc = glyph_cache_last;
+    
+    glyph_cache_clock++;
+    if (gc && gc->fg == fg && gc->bg == bg) {
+        gc->last_used = glyph_cache_clock;
+        fb_stats.glyph_hits++;
+        return gc;
+    }
+    
+    fb_glyph_cache_t *victim = &glyph_cache[0];
+    for (int i = 0; i < FB_GLYPH_CACHE_SLOTS; i++) {
+        gc = &glyph_cache[i];
+        if (gc->valid && gc->fg == fg && gc->bg == bg) {
+            gc->last_used = glyph_cache_clock;
+            glyph_cache_last = gc;
+            fb_stats.glyph_hits++;
+            return gc;
+        }
+        if (victim->valid && (!gc->valid || gc->last_used < victim->last_used)) {
+            victim = gc;
+        }
+    }
+    
+    // 渲染 256 种行模式
+    uint32_t bytes_per_pixel = fb_info.bpp / 8;
+    for (int bits = 0; bits < 256; bits++) {
+        uint8_t *p = victim->rows[bits];
+        for (int col = 0; col < 8; col++) {
+            uint32_t pixel = (bits & (0x80 >> col)) ? fg : bg;
+            for (uint32_t b = 0; b < bytes_per_pixel; b++) {
+                p[b] = (pixel >> (b * 8)) & 0xFF;
+            }
+            p += bytes_per_pixel;
+        }
+    }
+    victim->fg = fg;
+    victim->bg = bg;
+    victim->valid = true;
+    victim->last_used = glyph_cache_clock;
+    glyph_cache_last = victim;
+    fb_stats.glyph_misses++;
+    return victim;
+}
+
 void fb_draw_char(int x, int y, char c, color_t fg, color_t bg) {
     if (!fb_initialized || !current_font) return;
     
     const uint8_t *glyph = current_font + (unsigned char)c * font_height;
+    uint32_t fg_pixel = color_to_pixel(fg);
+    uint32_t bg_pixel = color_to_pixel(bg);
+    
+    // 快速路径：8 像素宽且完整落在屏幕内，按行查表后整行复制
+    if (font_width == 8 && fb_info.bpp >= 16 &&
+        x >= 0 && y >= 0 &&
+        x + 8 <= (int)fb_info.width && y + font_height <= (int)fb_info.height) {
+        const fb_glyph_cache_t *gc = fb_glyph_cache_get(fg_pixel, bg_pixel);
+        uint32_t words = 8 * (fb_info.bpp / 8) / sizeof(fb_word_t);
+        uint32_t x_offset = x * (fb_info.bpp / 8);
+        
+        for (int row = 0; row < font_height; row++) {
+            fb_word_t *dst = (fb_word_t *)(fb_row(y + row) + x_offset);
+            const fb_word_t *src = (const fb_word_t *)gc->rows[glyph[row]];
+            for (uint32_t i = 0; i < words; i++) {
+                dst[i] = src[i];
+            }
+        }
+        fb_mark_dirty(x, y, x + 8, y + font_height);
+        return;
+    }
     
     for (int row = 0; row < font_height; row++) {
         uint8_t bits = glyph[row];
         for (int col = 0; col < font_width; col++) {
-            color_t color = (bits & (0x80 >> col)) ? fg : bg;
             int px = x + col;
             int py = y + row;
             
             if (px >= 0 && px < (int)fb_info.width &&
                 py >= 0 && py < (int)fb_info.height) {
-                fb_put_pixel_fast(px, py, color_to_pixel(color));
+                fb_put_pixel_fast(px, py, (bits & (0x80 >> col)) ? fg_pixel : bg_pixel);
             }
         }
     }
+    fb_mark_dirty(x, y, x + font_width, y + font_height);
 }
 
 void fb_draw_char_transparent(int x, int y, char c, color_t fg) {
@@ -640,6 +808,7 @@ void fb_draw_char_transparent(int x, int y, char c, color_t fg) {
             }
         }
     }
+    fb_mark_dirty(x, y, x + font_width, y + font_height);
 }
 
 void fb_draw_string(int x, int y, const char *str, color_t fg, color_t bg) {
@@ -735,32 +904,25 @@ void fb_terminal_scroll(int lines) {
     int remaining_height = fb_info.height - scroll_height;
     
     if (remaining_height > 0) {
-        // 使用 memmove 进行高效滚动（处理重叠区域）
-        // 在双缓冲模式下，这在普通内存中进行，速度很快
-        uint8_t *draw_buf = fb_get_draw_buffer();
-        memmove(draw_buf, draw_buf + scroll_height * fb_info.pitch, 
-                remaining_height * fb_info.pitch);
+        if (double_buffering) {
+            // 环形后备缓冲区：移动第 0 行的位置即完成滚动，不搬运像素
+            scroll_offset = (scroll_offset + scroll_height) % fb_info.height;
+        } else {
+            // 直接写显存时只能整体搬移（处理重叠区域）
+            uint8_t *fb = (uint8_t *)fb_info.buffer;
+            memmove(fb, fb + scroll_height * fb_info.pitch,
+                    remaining_height * fb_info.pitch);
+        }
         
-        // 清空底部区域（需要手动填充，因为 fb_fill_rect 会标记脏区域）
+        // 清空底部区域（旋转上来的是最上面滚出的旧内容）
         uint32_t pixel = color_to_pixel(term_bg);
-        if (fb_info.bpp == 32) {
-            uint32_t *p = (uint32_t *)(draw_buf + remaining_height * fb_info.pitch);
-            uint32_t count = (scroll_height * fb_info.pitch) / 4;
-            for (uint32_t i = 0; i < count; i++) {
-                p[i] = pixel;
-            }
-        } else {
-            for (int y = remaining_height; y < (int)fb_info.height; y++) {
-                for (int x = 0; x < (int)fb_info.width; x++) {
-                    fb_put_pixel_fast(x, y, pixel);
-                }
-            }
+        for (int y = remaining_height; y < (int)fb_info.height; y++) {
+            fb_fill_span(0, y, fb_info.width, pixel);
         }
         
         // 标记整个屏幕为脏（因为所有内容都移动了）
-        if (double_buffering) {
-            fb_mark_dirty(0, fb_info.height);
-        }
+        fb_mark_all_dirty();
+        fb_stats.scrolls++;
     } else {
         fb_clear(term_bg);
     }
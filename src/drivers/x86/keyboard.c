@@ -12,6 +12,8 @@
 #include <kernel/isr.h>
 #include <kernel/task.h>
 #include <kernel/sync/spinlock.h>
+#include <kernel/sync/waitqueue.h>
+#include <fs/poll.h>
 #include <lib/klog.h>
 #include <lib/string.h>
 
@@ -23,6 +25,9 @@ static char keyboard_buffer[KEYBOARD_BUFFER_SIZE];
 static volatile size_t buffer_read_pos = 0;
 static volatile size_t buffer_write_pos = 0;
 
+/* 等待输入的 select/epoll 等待队列 */
+static wait_queue_t keyboard_wait;
+
 /* 修饰键状态 */
 static keyboard_modifiers_t modifiers = {
     .shift = false,
@@ -171,14 +176,12 @@ static bool buffer_get(char *c) {
 }
 
 /**
- * 键盘中断处理函数
+ * 处理一个扫描码
  * 
  * 注意：此函数在中断上下文中执行，使用 spinlock_lock 而非 spinlock_lock_irqsave
  * 因为中断已经禁用了
  */
-static void keyboard_callback(registers_t *regs) {
-    (void)regs;  // 未使用参数
-    
+static void keyboard_handle_scancode(void) {
     /* 获取锁（中断上下文，中断已禁用） */
     spinlock_lock(&keyboard_lock);
     
@@ -332,6 +335,22 @@ static void keyboard_callback(registers_t *regs) {
     spinlock_unlock(&keyboard_lock);
 }
 
+/**
+ * 键盘中断处理函数
+ */
+static void keyboard_callback(registers_t *regs) {
+    (void)regs;  // 未使用参数
+    
+    size_t old_write_pos = buffer_write_pos;
+    
+    keyboard_handle_scancode();
+    
+    /* 缓冲区有新字符时通知等待输入的任务 */
+    if (buffer_write_pos != old_write_pos) {
+        wait_queue_wake(&keyboard_wait, POLLIN);
+    }
+}
+
 /**
  * 初始化键盘驱动
  */
@@ -340,6 +359,7 @@ void keyboard_init(void) {
     
     /* 初始化锁 */
     spinlock_init(&keyboard_lock);
+    wait_queue_init(&keyboard_wait);
     
     /* 清空缓冲区 */
     buffer_read_pos = 0;
@@ -384,6 +404,13 @@ bool keyboard_has_key(void) {
     return has_key;
 }
 
+/**
+ * 获取键盘输入等待队列（有新字符时以 POLLIN 唤醒）
+ */
+wait_queue_t *keyboard_get_wait_queue(void) {
+    return &keyboard_wait;
+}
+
 /**
  * 读取一个按键（阻塞）
  */
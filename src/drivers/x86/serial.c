@@ -1,24 +1,59 @@
 /**
  * 串口驱动
- * 
+ *
  * 同步机制：使用 spinlock + IRQ save 保护串口输出
  * - 防止多核/中断并发输出导致字符交错
  * - 确保日志输出的完整性
+ *
+ * 发送缓冲：
+ * - serial_enable_tx_irq() 之前逐字节轮询 LSR 输出（早期启动没有中断）
+ * - 之后字符写入发送环，FIFO 空时（THRE）一次填入最多 16 字节；
+ *   环非空时打开 THRE 中断，由中断继续排空，调用者不再等待线路
+ * - 环满时丢弃新字符并计数，不阻塞调用者
+ * - panic 模式下不再取锁，先把环中积压的内容同步写出，之后逐字节轮询
  */
 
 #include <drivers/serial.h>
 #include <kernel/io.h>
+#include <kernel/irq.h>
+#include <kernel/isr.h>
 #include <kernel/sync/spinlock.h>
+#include <lib/kprintf.h>
 
 /* COM1 串口基址 */
 #define COM1 0x3F8
+#define COM1_IRQ 4
+
+/* 寄存器偏移 */
+#define UART_THR        0       // 发送保持寄存器
+#define UART_IER        1       // 中断使能
+#define UART_IIR        2       // 中断标识
+#define UART_LSR        5       // 线路状态
+
+#define UART_IER_THRI   0x02    // 发送保持寄存器空中断
+#define UART_IIR_NO_INT 0x01
+#define UART_IIR_ID     0x06
+#define UART_IIR_THRI   0x02
+#define UART_LSR_THRE   0x20    // 发送 FIFO 空
+#define UART_LSR_TEMT   0x40    // 发送 FIFO 与移位寄存器都空
+
+#define UART_TX_FIFO    16      // 16550A 发送 FIFO 深度
 
 /* 串口输出锁 */
 static spinlock_t serial_lock;
 
+/* 发送环：head/tail 自由增长，按掩码取下标 */
+static char tx_ring[SERIAL_TX_RING_SIZE];
+static uint32_t tx_head;
+static uint32_t tx_tail;
+static uint8_t tx_ier;                  // IER 当前值
+static bool tx_irq_enabled;
+static volatile bool serial_panicking;
+static serial_stats_t serial_stats;
+
 void serial_init(void) {
     spinlock_init(&serial_lock);
-    
+
     outb(COM1 + 1, 0x00);  // 禁用中断
     outb(COM1 + 3, 0x80);  // 启用 DLAB（Divisor Latch Access Bit）
     outb(COM1 + 0, 0x03);  // 波特率 38400（低字节）
@@ -29,32 +64,169 @@ void serial_init(void) {
 }
 
 /**
- * 内部函数：输出单个字符（不加锁）
+ * 内部函数：轮询输出单个字符（不加锁）
  */
 static void serial_putchar_nolock(char c) {
     /* 等待传输缓冲区为空 */
-    while ((inb(COM1 + 5) & 0x20) == 0);
-    outb(COM1, c);
+    while ((inb(COM1 + UART_LSR) & UART_LSR_THRE) == 0);
+    outb(COM1 + UART_THR, c);
+    serial_stats.tx_bytes++;
+}
+
+static void serial_set_ier(uint8_t ier) {
+    if (ier != tx_ier) {
+        tx_ier = ier;
+        outb(COM1 + UART_IER, ier);
+    }
+}
+
+/**
+ * FIFO 空时从发送环填入一批字符，并按环是否为空开关 THRE 中断（持有 serial_lock）
+ */
+static void serial_tx_fill(void) {
+    if (tx_head != tx_tail && (inb(COM1 + UART_LSR) & UART_LSR_THRE)) {
+        for (int i = 0; i < UART_TX_FIFO && tx_head != tx_tail; i++) {
+            outb(COM1 + UART_THR, tx_ring[tx_tail++ & (SERIAL_TX_RING_SIZE - 1)]);
+            serial_stats.tx_bytes++;
+        }
+    }
+    serial_set_ier(tx_head != tx_tail ? UART_IER_THRI : 0);
+}
+
+/**
+ * 输出一个字符（持有 serial_lock）
+ */
+static void serial_emit(char c) {
+    if (!tx_irq_enabled) {
+        serial_putchar_nolock(c);
+        return;
+    }
+    uint32_t used = tx_head - tx_tail;
+    if (used >= SERIAL_TX_RING_SIZE) {
+        /* 中断可能被调用者关着，先看 FIFO 能否腾出空间 */
+        serial_tx_fill();
+        used = tx_head - tx_tail;
+    }
+    if (used >= SERIAL_TX_RING_SIZE) {
+        serial_stats.tx_dropped++;
+        return;
+    }
+    tx_ring[tx_head++ & (SERIAL_TX_RING_SIZE - 1)] = c;
+    if (used + 1 > serial_stats.ring_high) {
+        serial_stats.ring_high = used + 1;
+    }
 }
 
 void serial_putchar(char c) {
+    if (serial_panicking) {
+        serial_putchar_nolock(c);
+        return;
+    }
     bool irq_state;
     spinlock_lock_irqsave(&serial_lock, &irq_state);
-    serial_putchar_nolock(c);
+    serial_emit(c);
+    if (tx_irq_enabled) {
+        serial_tx_fill();
+    }
     spinlock_unlock_irqrestore(&serial_lock, irq_state);
 }
 
 void serial_print(const char *msg) {
+    if (serial_panicking) {
+        while (*msg) {
+            if (*msg == '\n') {
+                serial_putchar_nolock('\r');
+            }
+            serial_putchar_nolock(*msg++);
+        }
+        return;
+    }
+
     bool irq_state;
     spinlock_lock_irqsave(&serial_lock, &irq_state);
-    
+
     while (*msg) {
         /* 自动处理换行符，添加回车符 */
         if (*msg == '\n') {
-            serial_putchar_nolock('\r');
+            serial_emit('\r');
         }
-        serial_putchar_nolock(*msg++);
+        serial_emit(*msg++);
+    }
+    if (tx_irq_enabled) {
+        serial_tx_fill();
+    }
+
+    spinlock_unlock_irqrestore(&serial_lock, irq_state);
+}
+
+/**
+ * COM1 中断：读 IIR 确认中断，继续排空发送环
+ */
+static void serial_irq_handler(registers_t *regs) {
+    (void)regs;
+    spinlock_lock(&serial_lock);
+    uint8_t iir = inb(COM1 + UART_IIR);
+    if (!(iir & UART_IIR_NO_INT) && (iir & UART_IIR_ID) == UART_IIR_THRI) {
+        serial_stats.tx_irqs++;
     }
-    
+    serial_tx_fill();
+    spinlock_unlock(&serial_lock);
+}
+
+void serial_enable_tx_irq(void) {
+    irq_register_handler(COM1_IRQ, serial_irq_handler);
+    irq_enable_line(COM1_IRQ);
+
+    bool irq_state;
+    spinlock_lock_irqsave(&serial_lock, &irq_state);
+    tx_irq_enabled = true;
     spinlock_unlock_irqrestore(&serial_lock, irq_state);
 }
+
+void serial_flush(void) {
+    while (!serial_panicking) {
+        bool irq_state;
+        spinlock_lock_irqsave(&serial_lock, &irq_state);
+        serial_tx_fill();
+        bool empty = (tx_head == tx_tail);
+        spinlock_unlock_irqrestore(&serial_lock, irq_state);
+        if (empty) {
+            break;
+        }
+        cpu_relax();
+    }
+    while ((inb(COM1 + UART_LSR) & UART_LSR_TEMT) == 0) {
+        cpu_relax();
+    }
+}
+
+void serial_panic_mode(void) {
+    /* 调用者已关中断；持锁者可能永远不会释放，直接接管串口 */
+    serial_panicking = true;
+    outb(COM1 + UART_IER, 0);
+    tx_ier = 0;
+    while (tx_head != tx_tail) {
+        serial_putchar_nolock(tx_ring[tx_tail++ & (SERIAL_TX_RING_SIZE - 1)]);
+    }
+}
+
+void serial_get_stats(serial_stats_t *stats) {
+    if (stats) {
+        *stats = serial_stats;
+    }
+}
+
+int serial_stats_dump(char *buf, size_t size) {
+    serial_stats_t s = serial_stats;
+    return ksnprintf(buf, size,
+                     "mode:       %s\n"
+                     "ring_size:  %u\n"
+                     "ring_used:  %u\n"
+                     "ring_high:  %u\n"
+                     "tx_bytes:   %llu\n"
+                     "tx_dropped: %u\n"
+                     "tx_irqs:    %u\n",
+                     serial_panicking ? "panic" : (tx_irq_enabled ? "irq" : "polled"),
+                     (uint32_t)SERIAL_TX_RING_SIZE, tx_head - tx_tail, s.ring_high,
+                     (unsigned long long)s.tx_bytes, s.tx_dropped, s.tx_irqs);
+}
@@ -10,6 +10,8 @@
 #include <drivers/timer.h>
 #include <kernel/io.h>
 #include <kernel/irq.h>
+#include <kernel/interrupt.h>
+#include <kernel/task.h>
 #include <mm/heap.h>
 #include <mm/vmm.h>
 #include <lib/klog.h>
@@ -19,6 +21,12 @@
 /* 最大支持的 UHCI 控制器数量 */
 #define UHCI_MAX_CONTROLLERS    4
 
+/* 传输等待 */
+#define UHCI_CTRL_TIMEOUT_MS    5000
+#define UHCI_BULK_TIMEOUT_MS    10000   // 每轮
+#define UHCI_WAIT_SLICE_MS      10      // 睡眠等待的分片
+#define UHCI_POLL_DELAY_US      100     // 不能睡眠时的轮询间隔
+
 /* 全局控制器数组 */
 static uhci_controller_t uhci_controllers[UHCI_MAX_CONTROLLERS];
 static int uhci_controller_count = 0;
@@ -107,11 +115,16 @@ static int uhci_init_qh_pool(uhci_controller_t *hc) {
  * @brief 分配 TD
  */
 static uhci_td_t *uhci_alloc_td(uhci_controller_t *hc) {
-    if (!hc->free_tds) {
+    bool irq_state;
+    spinlock_lock_irqsave(&hc->pool_lock, &irq_state);
+    uhci_td_t *td = hc->free_tds;
+    if (td) {
+        hc->free_tds = td->next;
+    }
+    spinlock_unlock_irqrestore(&hc->pool_lock, irq_state);
+    if (!td) {
         return NULL;
     }
-    uhci_td_t *td = hc->free_tds;
-    hc->free_tds = td->next;
     
     memset(td, 0, sizeof(uhci_td_t));
     td->phys_addr = hc->td_pool_phys + ((uint32_t)td - (uint32_t)hc->td_pool);
@@ -125,19 +138,27 @@ static uhci_td_t *uhci_alloc_td(uhci_controller_t *hc) {
  */
 static void uhci_free_td(uhci_controller_t *hc, uhci_td_t *td) {
     if (!td) return;
+    bool irq_state;
+    spinlock_lock_irqsave(&hc->pool_lock, &irq_state);
     td->next = hc->free_tds;
     hc->free_tds = td;
+    spinlock_unlock_irqrestore(&hc->pool_lock, irq_state);
 }
 
 /**
  * @brief 分配 QH
  */
 static uhci_qh_t *uhci_alloc_qh(uhci_controller_t *hc) {
-    if (!hc->free_qhs) {
+    bool irq_state;
+    spinlock_lock_irqsave(&hc->pool_lock, &irq_state);
+    uhci_qh_t *qh = hc->free_qhs;
+    if (qh) {
+        hc->free_qhs = qh->next;
+    }
+    spinlock_unlock_irqrestore(&hc->pool_lock, irq_state);
+    if (!qh) {
         return NULL;
     }
-    uhci_qh_t *qh = hc->free_qhs;
-    hc->free_qhs = qh->next;
     
     memset(qh, 0, sizeof(uhci_qh_t));
     qh->phys_addr = hc->qh_pool_phys + ((uint32_t)qh - (uint32_t)hc->qh_pool);
@@ -152,8 +173,11 @@ static uhci_qh_t *uhci_alloc_qh(uhci_controller_t *hc) {
  */
 static void uhci_free_qh(uhci_controller_t *hc, uhci_qh_t *qh) {
     if (!qh) return;
+    bool irq_state;
+    spinlock_lock_irqsave(&hc->pool_lock, &irq_state);
     qh->next = hc->free_qhs;
     hc->free_qhs = qh;
+    spinlock_unlock_irqrestore(&hc->pool_lock, irq_state);
 }
 
 /* ============================================================================
@@ -443,13 +467,6 @@ static uhci_td_t *uhci_create_status_td(uhci_controller_t *hc, usb_urb_t *urb, u
  * URB 提交
  * ============================================================================ */
 
-/**
- * @brief 检查 TD 是否完成
- */
-static bool uhci_td_is_complete(uhci_td_t *td) {
-    return !(td->ctrl_status & UHCI_TD_ACTIVE);
-}
-
 /**
  * @brief 获取 TD 状态
  */
@@ -481,6 +498,132 @@ static uint32_t uhci_td_get_actlen(uhci_td_t *td) {
     return (actlen + 1) & 0x7FF;
 }
 
+/**
+ * @brief 获取 TD 最大长度
+ */
+static uint32_t uhci_td_get_maxlen(uhci_td_t *td) {
+    return ((td->token >> 21) + 1) & 0x7FF;
+}
+
+/**
+ * @brief 缓冲区 offset 处的物理地址
+ *
+ * 逐个 TD 转换，不要求整个缓冲区物理连续
+ */
+static uint32_t uhci_buffer_phys(const void *buffer, uint32_t offset) {
+    return (uint32_t)vmm_virt_to_phys((uintptr_t)buffer + offset);
+}
+
+/**
+ * @brief 释放 TD 链
+ */
+static void uhci_free_td_chain(uhci_controller_t *hc, uhci_td_t *first_td) {
+    for (uhci_td_t *td = first_td; td; ) {
+        uhci_td_t *next = td->next;
+        uhci_free_td(hc, td);
+        td = next;
+    }
+}
+
+/* 一轮传输（挂在一个 QH 下的 TD 链）的完成状态 */
+typedef struct uhci_xfer {
+    uhci_qh_t *qh;
+    uhci_td_t *cursor;              // 第一个尚未确认完成的 TD
+    uhci_td_t *setup_td;            // 控制传输的 SETUP/STATUS 阶段不计入长度
+    uhci_td_t *status_td;
+    uhci_td_t *last_data;           // 最后一个完成的数据 TD
+    uint32_t actual;
+    int status;
+    bool done;
+} uhci_xfer_t;
+
+/**
+ * @brief 推进传输状态，结束时返回 true
+ *
+ * 从 cursor 往后确认已完成的 TD，每个 TD 只检查一次。出错即结束；
+ * IN 方向的短包使控制器停在该 QH 上：批量传输就此结束，控制传输
+ * 把 QH 指向 STATUS TD 继续状态阶段。作为等待条件时在关中断下调用。
+ */
+static bool uhci_xfer_progress(void *arg) {
+    uhci_xfer_t *x = (uhci_xfer_t *)arg;
+
+    while (!x->done) {
+        uhci_td_t *td = x->cursor;
+        if (td->ctrl_status & UHCI_TD_ACTIVE) {
+            return false;
+        }
+
+        int status = uhci_td_get_status(td);
+        if (status != URB_STATUS_COMPLETE) {
+            x->status = status;
+            x->done = true;
+            break;
+        }
+
+        if (td != x->setup_td && td != x->status_td) {
+            uint32_t len = uhci_td_get_actlen(td);
+            x->actual += len;
+            x->last_data = td;
+            if (len < uhci_td_get_maxlen(td) && td->next) {
+                if (x->status_td) {
+                    x->cursor = x->status_td;
+                    x->qh->element = x->status_td->phys_addr;
+                    continue;
+                }
+                x->status = URB_STATUS_COMPLETE;
+                x->done = true;
+                break;
+            }
+        }
+
+        if (!td->next) {
+            x->status = URB_STATUS_COMPLETE;
+            x->done = true;
+            break;
+        }
+        x->cursor = td->next;
+    }
+    return true;
+}
+
+/**
+ * @brief 当前上下文能否睡眠
+ *
+ * 热插拔检测在定时器/控制器中断里枚举设备，此时只能轮询
+ */
+static bool uhci_can_sleep(void) {
+    bool irq_on = interrupts_disable();
+    interrupts_restore(irq_on);
+    return irq_on && task_get_current() != NULL;
+}
+
+/**
+ * @brief 等待一轮传输结束
+ *
+ * 可睡眠时挂在控制器的等待队列上，由 IOC/短包/错误中断唤醒；按
+ * UHCI_WAIT_SLICE_MS 分片等待，中断丢失时也能发现完成。否则按
+ * 固定间隔轮询（中断上下文里时钟不前进，不能依赖 uptime）。
+ */
+static void uhci_xfer_wait(uhci_controller_t *hc, uhci_xfer_t *x,
+                           uint32_t timeout_ms, bool can_sleep) {
+    if (can_sleep && hc->irq_registered) {
+        uint64_t deadline = timer_get_uptime_ms() + timeout_ms;
+        while (wait_queue_wait(&hc->xfer_wait, uhci_xfer_progress, x, UHCI_WAIT_SLICE_MS) != 0) {
+            if (timer_get_uptime_ms() >= deadline) {
+                break;
+            }
+        }
+    } else {
+        hc->xfer_polled++;
+        uint32_t polls = timeout_ms * (1000 / UHCI_POLL_DELAY_US);
+        while (!uhci_xfer_progress(x) && polls > 0) {
+            timer_udelay(UHCI_POLL_DELAY_US);
+            polls--;
+        }
+    }
+    hc->xfer_count++;
+}
+
 /**
  * @brief 提交控制传输
  */
@@ -491,13 +634,7 @@ static int uhci_submit_control(uhci_controller_t *hc, usb_urb_t *urb) {
         return -1;
     }
     memcpy(setup_buf, &urb->setup, 8);
-    uint32_t setup_phys = vmm_virt_to_phys((uint32_t)setup_buf);
-    
-    /* 数据缓冲区物理地址 */
-    uint32_t data_phys = 0;
-    if (urb->buffer && urb->buffer_length > 0) {
-        data_phys = vmm_virt_to_phys((uint32_t)urb->buffer);
-    }
+    uint32_t setup_phys = uhci_buffer_phys(setup_buf, 0);
     
     /* 确定数据方向 */
     bool is_in = (urb->setup.bmRequestType & USB_REQTYPE_DIR_MASK) == USB_REQTYPE_DEV_TO_HOST;
@@ -522,14 +659,9 @@ static int uhci_submit_control(uhci_controller_t *hc, usb_urb_t *urb) {
         
         uhci_td_t *data_td = uhci_create_data_td(hc, urb,
                                                   is_in ? UHCI_TD_PID_IN : UHCI_TD_PID_OUT,
-                                                  data_phys + offset, len, toggle);
+                                                  uhci_buffer_phys(urb->buffer, offset), len, toggle);
         if (!data_td) {
-            /* 清理 */
-            for (uhci_td_t *td = first_td; td; ) {
-                uhci_td_t *next = td->next;
-                uhci_free_td(hc, td);
-                td = next;
-            }
+            uhci_free_td_chain(hc, first_td);
             kfree_aligned(setup_buf);
             return -1;
         }
@@ -546,11 +678,7 @@ static int uhci_submit_control(uhci_controller_t *hc, usb_urb_t *urb) {
     uhci_td_t *status_td = uhci_create_status_td(hc, urb, 
                                                   is_in ? UHCI_TD_PID_OUT : UHCI_TD_PID_IN);
     if (!status_td) {
-        for (uhci_td_t *td = first_td; td; ) {
-            uhci_td_t *next = td->next;
-            uhci_free_td(hc, td);
-            td = next;
-        }
+        uhci_free_td_chain(hc, first_td);
         kfree_aligned(setup_buf);
         return -1;
     }
@@ -562,11 +690,7 @@ static int uhci_submit_control(uhci_controller_t *hc, usb_urb_t *urb) {
     /* 分配 QH */
     uhci_qh_t *qh = uhci_alloc_qh(hc);
     if (!qh) {
-        for (uhci_td_t *td = first_td; td; ) {
-            uhci_td_t *next = td->next;
-            uhci_free_td(hc, td);
-            td = next;
-        }
+        uhci_free_td_chain(hc, first_td);
         kfree_aligned(setup_buf);
         return -1;
     }
@@ -575,49 +699,29 @@ static int uhci_submit_control(uhci_controller_t *hc, usb_urb_t *urb) {
     qh->last_td = last_td;
     qh->element = first_td->phys_addr;
     
+    bool can_sleep = uhci_can_sleep();
+    if (can_sleep) {
+        mutex_lock(&hc->ctrl_lock);
+    }
+    
     /* 插入到控制 QH 链表 */
     qh->head = hc->qh_ctrl->head;
     hc->qh_ctrl->element = qh->phys_addr | UHCI_LP_QH;
     hc->active_ctrl_qh = qh;
     
-    /* 等待完成（轮询） */
-    int timeout = 5000;  // 5 秒超时
-    while (timeout > 0) {
-        /* 检查所有 TD */
-        bool all_done = true;
-        int status = URB_STATUS_COMPLETE;
-        uint32_t total_len = 0;
-        
-        for (uhci_td_t *td = first_td; td; td = td->next) {
-            if (!uhci_td_is_complete(td)) {
-                all_done = false;
-                break;
-            }
-            
-            int td_status = uhci_td_get_status(td);
-            if (td_status != URB_STATUS_COMPLETE) {
-                status = td_status;
-                all_done = true;
-                break;
-            }
-            
-            /* 累加数据传输长度（跳过 SETUP 和 STATUS） */
-            if (td != first_td && td != last_td) {
-                total_len += uhci_td_get_actlen(td);
-            }
-        }
-        
-        if (all_done) {
-            urb->actual_length = total_len;
-            urb->status = status;
-            break;
-        }
-        
-        timer_wait(1);
-        timeout--;
-    }
-    
-    if (timeout == 0) {
+    /* 等待完成 */
+    uhci_xfer_t xfer = {
+        .qh = qh,
+        .cursor = first_td,
+        .setup_td = setup_td,
+        .status_td = status_td,
+    };
+    uhci_xfer_wait(hc, &xfer, UHCI_CTRL_TIMEOUT_MS, can_sleep);
+    
+    if (xfer.done) {
+        urb->actual_length = xfer.actual;
+        urb->status = xfer.status;
+    } else {
         urb->status = URB_STATUS_TIMEOUT;
         LOG_WARN_MSG("uhci: Control transfer timeout\n");
     }
@@ -625,13 +729,16 @@ static int uhci_submit_control(uhci_controller_t *hc, usb_urb_t *urb) {
     /* 从 QH 链表移除 */
     hc->qh_ctrl->element = UHCI_LP_TERM;
     hc->active_ctrl_qh = NULL;
+    if (!xfer.done) {
+        timer_udelay(1000);  // 控制器可能仍在当前帧内处理这些 TD
+    }
     
-    /* 释放资源 */
-    for (uhci_td_t *td = first_td; td; ) {
-        uhci_td_t *next = td->next;
-        uhci_free_td(hc, td);
-        td = next;
+    if (can_sleep) {
+        mutex_unlock(&hc->ctrl_lock);
     }
+    
+    /* 释放资源 */
+    uhci_free_td_chain(hc, first_td);
     uhci_free_qh(hc, qh);
     kfree_aligned(setup_buf);
     
@@ -639,37 +746,34 @@ static int uhci_submit_control(uhci_controller_t *hc, usb_urb_t *urb) {
 }
 
 /**
- * @brief 提交批量传输
+ * @brief 执行一轮批量传输
+ *
+ * 从 urb 的 offset 处开始，把最多 UHCI_BULK_MAX_TDS 个包的 TD 一次挂入
+ * 批量 QH。TD 之间深度优先链接，控制器在一帧内连续执行，只有最后一个
+ * TD 请求完成中断。
+ * @param short_packet 输出：是否以短包结束
+ * @return URB_STATUS_*
  */
-static int uhci_submit_bulk(uhci_controller_t *hc, usb_urb_t *urb) {
-    if (!urb->endpoint || urb->endpoint->type != USB_TRANSFER_BULK) {
-        return -1;
-    }
-    
+static int uhci_bulk_round(uhci_controller_t *hc, usb_urb_t *urb, uint32_t offset,
+                           bool can_sleep, bool *short_packet) {
     bool is_in = (urb->endpoint->address & USB_DIR_MASK) == USB_DIR_IN;
     uint8_t pid = is_in ? UHCI_TD_PID_IN : UHCI_TD_PID_OUT;
     uint16_t max_pkt = urb->endpoint->max_packet_size;
     
-    /* 数据缓冲区物理地址 */
-    uint32_t data_phys = vmm_virt_to_phys((uint32_t)urb->buffer);
-    
-    /* 创建 TDs */
+    /* 创建 TDs（TD 池不够时先传输已分配的部分） */
     uhci_td_t *first_td = NULL;
     uhci_td_t *last_td = NULL;
     uint8_t toggle = urb->endpoint->toggle;
-    uint32_t offset = 0;
+    uint32_t start = offset;
+    uint32_t count = 0;
     
-    while (offset < urb->buffer_length) {
+    do {
         uint16_t len = (urb->buffer_length - offset > max_pkt) ? max_pkt : (urb->buffer_length - offset);
         
-        uhci_td_t *td = uhci_create_data_td(hc, urb, pid, data_phys + offset, len, toggle);
+        uhci_td_t *td = uhci_create_data_td(hc, urb, pid, uhci_buffer_phys(urb->buffer, offset),
+                                            len, toggle);
         if (!td) {
-            for (uhci_td_t *t = first_td; t; ) {
-                uhci_td_t *next = t->next;
-                uhci_free_td(hc, t);
-                t = next;
-            }
-            return -1;
+            break;
         }
         
         if (!first_td) {
@@ -683,22 +787,21 @@ static int uhci_submit_bulk(uhci_controller_t *hc, usb_urb_t *urb) {
         
         toggle ^= 1;
         offset += len;
+        count++;
+    } while (offset < urb->buffer_length && count < UHCI_BULK_MAX_TDS);
+    
+    if (!first_td) {
+        return URB_STATUS_ERROR;
     }
     
     /* 最后一个 TD 设置 IOC */
-    if (last_td) {
-        last_td->ctrl_status |= UHCI_TD_IOC;
-    }
+    last_td->ctrl_status |= UHCI_TD_IOC;
     
     /* 分配 QH */
     uhci_qh_t *qh = uhci_alloc_qh(hc);
     if (!qh) {
-        for (uhci_td_t *td = first_td; td; ) {
-            uhci_td_t *next = td->next;
-            uhci_free_td(hc, td);
-            td = next;
-        }
-        return -1;
+        uhci_free_td_chain(hc, first_td);
+        return URB_STATUS_ERROR;
     }
     
     qh->first_td = first_td;
@@ -711,57 +814,67 @@ static int uhci_submit_bulk(uhci_controller_t *hc, usb_urb_t *urb) {
     hc->active_bulk_qh = qh;
     
     /* 等待完成 */
-    int timeout = 10000;  // 10 秒超时
-    while (timeout > 0) {
-        bool all_done = true;
-        int status = URB_STATUS_COMPLETE;
-        uint32_t total_len = 0;
-        
-        for (uhci_td_t *td = first_td; td; td = td->next) {
-            if (!uhci_td_is_complete(td)) {
-                all_done = false;
-                break;
-            }
-            
-            int td_status = uhci_td_get_status(td);
-            if (td_status != URB_STATUS_COMPLETE) {
-                status = td_status;
-                all_done = true;
-                break;
-            }
-            
-            total_len += uhci_td_get_actlen(td);
-        }
-        
-        if (all_done) {
-            urb->actual_length = total_len;
-            urb->status = status;
-            break;
-        }
-        
-        timer_wait(1);
-        timeout--;
-    }
-    
-    if (timeout == 0) {
-        urb->status = URB_STATUS_TIMEOUT;
+    uhci_xfer_t xfer = {
+        .qh = qh,
+        .cursor = first_td,
+    };
+    uhci_xfer_wait(hc, &xfer, UHCI_BULK_TIMEOUT_MS, can_sleep);
+    
+    int status = xfer.done ? xfer.status : URB_STATUS_TIMEOUT;
+    if (!xfer.done) {
         LOG_WARN_MSG("uhci: Bulk transfer timeout\n");
     }
+    urb->actual_length += xfer.actual;
+    *short_packet = xfer.done && xfer.actual < offset - start;
     
-    /* 更新端点 toggle */
-    urb->endpoint->toggle = toggle;
+    /* 更新端点 toggle：接在最后一个完成的包之后 */
+    if (xfer.last_data) {
+        urb->endpoint->toggle = ((xfer.last_data->token >> 19) & 1) ^ 1;
+    }
     
     /* 移除并释放 */
     hc->qh_bulk->element = UHCI_LP_TERM;
     hc->active_bulk_qh = NULL;
-    
-    for (uhci_td_t *td = first_td; td; ) {
-        uhci_td_t *next = td->next;
-        uhci_free_td(hc, td);
-        td = next;
+    if (!xfer.done) {
+        timer_udelay(1000);  // 控制器可能仍在当前帧内处理这些 TD
     }
+    
+    uhci_free_td_chain(hc, first_td);
     uhci_free_qh(hc, qh);
     
+    return status;
+}
+
+/**
+ * @brief 提交批量传输
+ *
+ * 超过 UHCI_BULK_MAX_TDS 个包的传输分轮执行，遇到短包或错误提前结束
+ */
+static int uhci_submit_bulk(uhci_controller_t *hc, usb_urb_t *urb) {
+    if (!urb->endpoint || urb->endpoint->type != USB_TRANSFER_BULK) {
+        return -1;
+    }
+    
+    bool can_sleep = uhci_can_sleep();
+    if (can_sleep) {
+        mutex_lock(&hc->bulk_lock);
+    }
+    
+    urb->actual_length = 0;
+    int status;
+    do {
+        bool short_packet = false;
+        status = uhci_bulk_round(hc, urb, urb->actual_length, can_sleep, &short_packet);
+        if (status != URB_STATUS_COMPLETE || short_packet) {
+            break;
+        }
+    } while (urb->actual_length < urb->buffer_length);
+    urb->status = status;
+    
+    if (can_sleep) {
+        mutex_unlock(&hc->bulk_lock);
+    }
+    
     return (urb->status == URB_STATUS_COMPLETE) ? 0 : urb->status;
 }
 
@@ -799,12 +912,14 @@ static void uhci_irq_handler(registers_t *regs) {
         /* 清除中断状态（写 1 清除） */
         uhci_write16(hc, UHCI_REG_USBSTS, status);
         
-        if (status & UHCI_STS_USBINT) {
-            LOG_DEBUG_MSG("uhci: Transfer complete interrupt\n");
+        /* IOC、短包或传输错误：唤醒等待传输的任务 */
+        if (status & (UHCI_STS_USBINT | UHCI_STS_ERROR)) {
+            hc->irq_count++;
+            wait_queue_wake(&hc->xfer_wait, 0);
         }
         
         if (status & UHCI_STS_ERROR) {
-            LOG_WARN_MSG("uhci: USB error interrupt\n");
+            LOG_DEBUG_MSG("uhci: USB error interrupt\n");
         }
         
         if (status & UHCI_STS_RD) {
@@ -898,6 +1013,11 @@ static int uhci_init_controller(pci_device_t *pci_dev) {
     }
     hc->io_base = (uint16_t)bar4;
     
+    spinlock_init(&hc->pool_lock);
+    mutex_init_named(&hc->ctrl_lock, "uhci_ctrl");
+    mutex_init_named(&hc->bulk_lock, "uhci_bulk");
+    wait_queue_init(&hc->xfer_wait);
+    
     /* 启用 PCI 总线主控和 I/O 空间 */
     pci_enable_bus_master(pci_dev);
     pci_enable_io_space(pci_dev);
@@ -921,6 +1041,7 @@ static int uhci_init_controller(pci_device_t *pci_dev) {
     if (hc->irq != 0 && hc->irq != 0xFF) {
         irq_register_handler(hc->irq, uhci_irq_handler);
         irq_enable_line(hc->irq);
+        hc->irq_registered = true;
     }
     
     /* 启动控制器 */
@@ -1013,6 +1134,13 @@ void uhci_print_info(uhci_controller_t *hc) {
     kprintf("  Port 1: 0x%04x\n", uhci_get_port_status(hc, 1));
 }
 
+void uhci_get_stats(uhci_controller_t *hc, uint32_t *irqs, uint32_t *xfers, uint32_t *polled) {
+    if (!hc) return;
+    if (irqs) *irqs = hc->irq_count;
+    if (xfers) *xfers = hc->xfer_count;
+    if (polled) *polled = hc->xfer_polled;
+}
+
 int uhci_get_controller_count(void) {
     return uhci_controller_count;
 }
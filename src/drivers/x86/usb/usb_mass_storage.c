@@ -9,6 +9,7 @@
 #include <drivers/usb/usb_mass_storage.h>
 #include <drivers/usb/usb.h>
 #include <drivers/timer.h>
+#include <fs/bio.h>
 #include <mm/heap.h>
 #include <mm/vmm.h>
 #include <lib/klog.h>
@@ -274,61 +275,60 @@ static int msc_write_10(usb_msc_device_t *msc, uint32_t lba, uint16_t count, con
  * ============================================================================ */
 
 /**
- * @brief 块设备读取回调
+ * @brief 分段执行 READ(10)/WRITE(10)
+ *
+ * 每条命令传输尽可能多的块（不超过 max_blocks），整段数据阶段作为一个
+ * 批量 URB 提交。多块命令失败时把上限减半后重试，适应只接受较小传输的设备。
  */
-static int msc_blockdev_read(void *dev, uint32_t sector, uint32_t count, uint8_t *buffer) {
-    usb_msc_device_t *msc = (usb_msc_device_t *)dev;
-    if (!msc || !msc->ready || !buffer) {
-        return -1;
-    }
-    
-    /* 分块读取（每次最多 128 扇区，64KB） */
-    uint32_t max_sectors = 128;
-    uint32_t offset = 0;
-    
+static int msc_blockdev_rw(usb_msc_device_t *msc, uint32_t sector, uint32_t count,
+                           uint8_t *buffer, bool write) {
     while (count > 0) {
-        uint16_t chunk = (count > max_sectors) ? max_sectors : count;
+        uint32_t chunk = (count > msc->max_blocks) ? msc->max_blocks : count;
         
-        int ret = msc_read_10(msc, sector + offset, chunk, buffer + offset * msc->block_size);
+        int ret = write ? msc_write_10(msc, sector, (uint16_t)chunk, buffer)
+                        : msc_read_10(msc, sector, (uint16_t)chunk, buffer);
+        msc->rw_commands++;
         if (ret < 0) {
-            LOG_ERROR_MSG("msc: Read failed at sector %u\n", sector + offset);
+            if (chunk > USB_MSC_MIN_BLOCKS) {
+                msc->max_blocks = chunk / 2;
+                LOG_WARN_MSG("msc: %s of %u blocks failed, limiting to %u blocks\n",
+                             write ? "Write" : "Read", chunk, msc->max_blocks);
+                continue;
+            }
+            LOG_ERROR_MSG("msc: %s failed at sector %u\n", write ? "Write" : "Read", sector);
             return ret;
         }
         
-        offset += chunk;
+        sector += chunk;
         count -= chunk;
+        buffer += chunk * msc->block_size;
     }
     
     return 0;
 }
 
 /**
- * @brief 块设备写入回调
+ * @brief 块设备读取回调
  */
-static int msc_blockdev_write(void *dev, uint32_t sector, uint32_t count, const uint8_t *buffer) {
+static int msc_blockdev_read(void *dev, uint32_t sector, uint32_t count, uint8_t *buffer) {
     usb_msc_device_t *msc = (usb_msc_device_t *)dev;
     if (!msc || !msc->ready || !buffer) {
         return -1;
     }
     
-    /* 分块写入 */
-    uint32_t max_sectors = 128;
-    uint32_t offset = 0;
-    
-    while (count > 0) {
-        uint16_t chunk = (count > max_sectors) ? max_sectors : count;
-        
-        int ret = msc_write_10(msc, sector + offset, chunk, buffer + offset * msc->block_size);
-        if (ret < 0) {
-            LOG_ERROR_MSG("msc: Write failed at sector %u\n", sector + offset);
-            return ret;
-        }
-        
-        offset += chunk;
-        count -= chunk;
+    return msc_blockdev_rw(msc, sector, count, buffer, false);
+}
+
+/**
+ * @brief 块设备写入回调
+ */
+static int msc_blockdev_write(void *dev, uint32_t sector, uint32_t count, const uint8_t *buffer) {
+    usb_msc_device_t *msc = (usb_msc_device_t *)dev;
+    if (!msc || !msc->ready || !buffer) {
+        return -1;
     }
     
-    return 0;
+    return msc_blockdev_rw(msc, sector, count, (uint8_t *)buffer, true);
 }
 
 /**
@@ -457,6 +457,7 @@ int usb_msc_probe(usb_device_t *dev, usb_interface_t *iface) {
                 msc->block_count, msc->block_size,
                 (msc->block_count * msc->block_size) / (1024 * 1024));
     
+    msc->max_blocks = USB_MSC_MAX_BLOCKS;
     msc->ready = true;
     
     /* 设置块设备名称 */
@@ -473,9 +474,15 @@ int usb_msc_probe(usb_device_t *dev, usb_interface_t *iface) {
     msc->blockdev.get_size = msc_blockdev_get_size;
     msc->blockdev.get_block_size = msc_blockdev_get_block_size;
     
+    /* 请求队列：BOT 协议一次一条命令，同步派发 */
+    if (blk_queue_init(&msc->blockdev, 1) != 0) {
+        LOG_WARN_MSG("msc: %s without request queue\n", msc->blockdev.name);
+    }
+    
     /* 注册块设备 */
     if (blockdev_register(&msc->blockdev) < 0) {
         LOG_ERROR_MSG("msc: Failed to register block device\n");
+        blk_queue_destroy(&msc->blockdev);
         kfree(msc);
         return -1;
     }
@@ -512,6 +519,7 @@ void usb_msc_disconnect(usb_device_t *dev, usb_interface_t *iface) {
     
     /* 注销块设备 */
     blockdev_unregister(&msc->blockdev);
+    blk_queue_destroy(&msc->blockdev);
     
     /* 释放 */
     kfree(msc);
@@ -0,0 +1,165 @@
+/**
+ * VirtIO PCI 传输层（legacy I/O 端口接口）
+ *
+ * QEMU 默认的 virtio-*-pci 是过渡设备（设备 ID 0x1000-0x103F），BAR0 是
+ * legacy 寄存器的 I/O 端口窗口。走 I/O 端口在 i686 和 x86_64 上都不需要
+ * 映射 MMIO；legacy 接口的特性只有低 32 位，但间接描述符和事件索引都在
+ * 其中。队列大小由设备决定，队列内存以页号登记，已用环按 4KB 对齐。
+ *
+ * 中断：INTx 电平中断，同一条中断线上可能有多个 virtio 设备，处理程序
+ * 依次读各设备的 ISR（读即清零），有挂起中断的才交给驱动。
+ */
+
+#include <drivers/common/virtio.h>
+#include <drivers/common/virtqueue.h>
+#include <drivers/pci.h>
+#include <kernel/io.h>
+#include <kernel/irq.h>
+#include <lib/klog.h>
+#include <lib/kprintf.h>
+#include <lib/string.h>
+
+#define VIRTIO_PCI_MAX_DEVICES  8
+
+static virtio_device_t virtio_pci_devices[VIRTIO_PCI_MAX_DEVICES];
+static uint32_t virtio_pci_device_count = 0;
+
+static uint16_t virtio_pci_port(virtio_device_t *vdev, uint32_t reg) {
+    return (uint16_t)(vdev->base + reg);
+}
+
+static uint8_t virtio_pci_get_status(virtio_device_t *vdev) {
+    return inb(virtio_pci_port(vdev, VIRTIO_PCI_STATUS));
+}
+
+static void virtio_pci_set_status(virtio_device_t *vdev, uint8_t status) {
+    outb(virtio_pci_port(vdev, VIRTIO_PCI_STATUS), status);
+}
+
+static uint64_t virtio_pci_get_features(virtio_device_t *vdev) {
+    return inl(virtio_pci_port(vdev, VIRTIO_PCI_HOST_FEATURES));
+}
+
+static void virtio_pci_set_features(virtio_device_t *vdev, uint64_t features) {
+    outl(virtio_pci_port(vdev, VIRTIO_PCI_GUEST_FEATURES), (uint32_t)features);
+}
+
+static uint8_t virtio_pci_read_config8(virtio_device_t *vdev, uint32_t offset) {
+    return inb(virtio_pci_port(vdev, VIRTIO_PCI_CONFIG + offset));
+}
+
+static void virtio_pci_write_config8(virtio_device_t *vdev, uint32_t offset, uint8_t value) {
+    outb(virtio_pci_port(vdev, VIRTIO_PCI_CONFIG + offset), value);
+}
+
+static uint16_t virtio_pci_queue_size(virtio_device_t *vdev, uint16_t index) {
+    outw(virtio_pci_port(vdev, VIRTIO_PCI_QUEUE_SEL), index);
+    return inw(virtio_pci_port(vdev, VIRTIO_PCI_QUEUE_NUM));
+}
+
+static int virtio_pci_queue_setup(virtio_device_t *vdev, virtqueue_t *vq) {
+    uint64_t pfn = (uint64_t)vq->ring_phys >> PAGE_SHIFT;
+    if (pfn > 0xFFFFFFFFULL) {
+        return -1;
+    }
+    outw(virtio_pci_port(vdev, VIRTIO_PCI_QUEUE_SEL), vq->index);
+    outl(virtio_pci_port(vdev, VIRTIO_PCI_QUEUE_PFN), (uint32_t)pfn);
+    return 0;
+}
+
+static void virtio_pci_notify(virtio_device_t *vdev, uint16_t index) {
+    outw(virtio_pci_port(vdev, VIRTIO_PCI_QUEUE_NOTIFY), index);
+}
+
+static uint32_t virtio_pci_ack_interrupt(virtio_device_t *vdev) {
+    return inb(virtio_pci_port(vdev, VIRTIO_PCI_ISR));
+}
+
+static void virtio_pci_irq_handler(registers_t *regs) {
+    (void)regs;
+    for (uint32_t i = 0; i < virtio_pci_device_count; i++) {
+        virtio_device_t *vdev = &virtio_pci_devices[i];
+        if (vdev->irq_handler == NULL) {
+            continue;
+        }
+        if (virtio_pci_ack_interrupt(vdev) != 0) {
+            vdev->irq_handler(vdev);
+        }
+    }
+}
+
+static int virtio_pci_enable_irq(virtio_device_t *vdev) {
+    if (vdev->irq == 0 || vdev->irq >= 16) {
+        return -1;
+    }
+    irq_register_handler((uint8_t)vdev->irq, virtio_pci_irq_handler);
+    irq_enable_line((uint8_t)vdev->irq);
+    return 0;
+}
+
+static const virtio_transport_ops_t virtio_pci_ops = {
+    .get_status     = virtio_pci_get_status,
+    .set_status     = virtio_pci_set_status,
+    .get_features   = virtio_pci_get_features,
+    .set_features   = virtio_pci_set_features,
+    .read_config8   = virtio_pci_read_config8,
+    .write_config8  = virtio_pci_write_config8,
+    .queue_size     = virtio_pci_queue_size,
+    .queue_setup    = virtio_pci_queue_setup,
+    .notify         = virtio_pci_notify,
+    .ack_interrupt  = virtio_pci_ack_interrupt,
+    .enable_irq     = virtio_pci_enable_irq,
+};
+
+int virtio_scan(uint32_t device_id, virtio_probe_t probe) {
+    if (probe == NULL) {
+        return 0;
+    }
+
+    int claimed = 0;
+    int count = pci_get_device_count();
+    for (int i = 0; i < count; i++) {
+        pci_device_t *pci = pci_get_device(i);
+        if (pci == NULL || pci->vendor_id != VIRTIO_PCI_VENDOR_ID ||
+            pci->device_id < VIRTIO_PCI_DEVICE_MIN || pci->device_id > VIRTIO_PCI_DEVICE_MAX) {
+            continue;
+        }
+        // 过渡设备的子系统 ID 就是 virtio 设备类型
+        uint16_t type = pci_read_config16(pci->bus, pci->slot, pci->func, PCI_SUBSYS_ID);
+        if (type != device_id) {
+            continue;
+        }
+        if (pci->bar_type[0] != PCI_BAR_TYPE_IO) {
+            LOG_WARN_MSG("virtio-pci: %02x:%02x.%x has no legacy I/O BAR, skipped\n",
+                         pci->bus, pci->slot, pci->func);
+            continue;
+        }
+        if (virtio_pci_device_count >= VIRTIO_PCI_MAX_DEVICES) {
+            LOG_WARN_MSG("virtio-pci: too many devices\n");
+            break;
+        }
+
+        virtio_device_t *vdev = &virtio_pci_devices[virtio_pci_device_count];
+        memset(vdev, 0, sizeof(*vdev));
+        ksnprintf(vdev->name, sizeof(vdev->name), "pci%02x:%02x.%x",
+                  pci->bus, pci->slot, pci->func);
+        vdev->ops = &virtio_pci_ops;
+        vdev->device_id = device_id;
+        vdev->legacy = true;
+        vdev->base = pci_get_bar_address(pci, 0);
+        vdev->irq = pci->interrupt_line;
+
+        pci_enable_io_space(pci);
+        pci_enable_bus_master(pci);
+
+        // 先占位：驱动在 probe 里就可能打开中断
+        virtio_pci_device_count++;
+        if (probe(vdev) == 0) {
+            claimed++;
+        } else {
+            virtio_pci_set_status(vdev, 0);
+            virtio_pci_device_count--;
+        }
+    }
+    return claimed;
+}
@@ -0,0 +1,639 @@
+// ============================================================================
+// bio.c - 块 I/O 请求层实现
+// ============================================================================
+//
+// 队列锁（关中断）保护排序队列、空闲请求链和计数；调用驱动、拷贝中转缓冲区
+// 和调用 end_io 都在锁外进行。dispatching 标志保证同一时刻只有一个派发循环。
+//
+// 派发只在任务上下文中进行：完成路径可能在中断里，也可能在等待者的条件
+// 回调里（关中断），不能分配中转缓冲区或调用同步驱动。blk_request_done
+// 只把队列挂到 kblockd 的待派发链上并唤醒它。
+// ============================================================================
+
+#include <fs/bio.h>
+#include <kernel/task.h>
+#include <mm/heap.h>
+#include <lib/klog.h>
+#include <lib/string.h>
+
+#define BLK_POLL_MS         10      // 等待时间片：中断缺失时按此间隔轮询驱动
+#define BLK_SYNC_BATCH      16      // 同步读写一轮提交的 bio 数
+
+/* ============================================================================
+ * 辅助函数
+ * ============================================================================ */
+
+/* 沿 remap 找到实际持有队列的设备 */
+static blockdev_t *blk_queue_dev(blockdev_t *dev) {
+    while (dev != NULL && dev->queue == NULL && dev->remap != NULL) {
+        uint32_t sector = 0;
+        dev = dev->remap(dev->private_data, &sector);
+    }
+    return dev;
+}
+
+static void blk_bio_complete(bio_t *bio, int status) {
+    bio->status = status;
+    bio->next = NULL;
+    __sync_synchronize();
+    // 有 end_io 时 bio 归调用者处理，之后不再访问
+    if (bio->end_io != NULL) {
+        bio->end_io(bio);
+    } else {
+        bio->done = true;
+    }
+}
+
+static void blk_poll(blk_queue_t *q) {
+    blockdev_t *dev = q->dev;
+    if (dev->poll != NULL) {
+        dev->poll(dev->private_data);
+    }
+}
+
+/* 按起始扇区插入排序队列（持有 q->lock） */
+static void blk_insert_sorted(blk_queue_t *q, blk_request_t *rq) {
+    blk_request_t **pp = &q->queue;
+    while (*pp != NULL && (*pp)->sector <= rq->sector) {
+        pp = &(*pp)->next;
+    }
+    rq->next = *pp;
+    *pp = rq;
+}
+
+static void blk_unlink(blk_queue_t *q, blk_request_t *rq) {
+    blk_request_t **pp = &q->queue;
+    while (*pp != NULL && *pp != rq) {
+        pp = &(*pp)->next;
+    }
+    if (*pp != NULL) {
+        *pp = rq->next;
+    }
+    rq->next = NULL;
+}
+
+/* 单向电梯：取 head_pos 之后的第一个请求，没有则回到最低扇区（持有 q->lock） */
+static blk_request_t *blk_elevator_next(blk_queue_t *q) {
+    blk_request_t *rq = q->queue;
+    while (rq != NULL && rq->sector < q->head_pos) {
+        rq = rq->next;
+    }
+    if (rq == NULL) {
+        rq = q->queue;
+    }
+    if (rq != NULL) {
+        blk_unlink(q, rq);
+        q->head_pos = rq->sector + rq->count;
+    }
+    return rq;
+}
+
+/**
+ * 尝试把 bio 并入已排队的请求（持有 q->lock）
+ * @return 合并成功返回 true
+ */
+static bool blk_try_merge(blk_queue_t *q, bio_t *bio) {
+    uint32_t bytes = bio->count * q->block_size;
+
+    for (blk_request_t *rq = q->queue; rq != NULL; rq = rq->next) {
+        // buffer 非空说明已经交给过驱动（被退回），不能再改动
+        if (rq->write != bio->write || rq->buffer != NULL ||
+            rq->count + bio->count > q->max_sectors) {
+            continue;
+        }
+
+        if (rq->sector + rq->count == bio->sector) {
+            bio_t *tail = rq->bios_tail;
+            if (tail->buffer + tail->count * q->block_size != bio->buffer) {
+                rq->bounce = true;          // 缓冲区不相接，派发时经中转缓冲区
+            }
+            tail->next = bio;
+            rq->bios_tail = bio;
+            rq->count += bio->count;
+            rq->nr_bios++;
+            q->stats.back_merges++;
+            return true;
+        }
+
+        if (bio->sector + bio->count == rq->sector) {
+            if (bio->buffer + bytes != rq->bios->buffer) {
+                rq->bounce = true;
+            }
+            bio->next = rq->bios;
+            rq->bios = bio;
+            rq->sector = bio->sector;
+            rq->count += bio->count;
+            rq->nr_bios++;
+            // 起始扇区变小，重新排序
+            blk_unlink(q, rq);
+            blk_insert_sorted(q, rq);
+            q->stats.front_merges++;
+            return true;
+        }
+    }
+    return false;
+}
+
+/* ============================================================================
+ * 完成与派发
+ * ============================================================================ */
+
+static void blk_complete(blk_queue_t *q, blk_request_t *rq, int status) {
+    if (rq->bounce && rq->buffer != NULL) {
+        if (!rq->write && status == 0) {
+            uint8_t *src = rq->buffer;
+            for (bio_t *bio = rq->bios; bio != NULL; bio = bio->next) {
+                uint32_t len = bio->count * q->block_size;
+                memcpy(bio->buffer, src, len);
+                src += len;
+            }
+        }
+        kfree(rq->buffer);
+    }
+
+    bio_t *bio = rq->bios;
+    while (bio != NULL) {
+        bio_t *next = bio->next;
+        blk_bio_complete(bio, status);
+        bio = next;
+    }
+
+    bool irq_state;
+    spinlock_lock_irqsave(&q->lock, &irq_state);
+    q->inflight--;
+    if (status != 0) {
+        q->stats.errors++;
+    }
+    rq->bios = NULL;
+    rq->bios_tail = NULL;
+    rq->buffer = NULL;
+    rq->next = q->free;
+    q->free = rq;
+    spinlock_unlock_irqrestore(&q->lock, irq_state);
+
+    wait_queue_wake(&q->wait, 0);
+}
+
+/**
+ * 把请求交给驱动
+ * @return 0 已交出（同步驱动已完成），1 驱动忙，-1 失败（由调用者完成请求）
+ */
+static int blk_issue(blk_queue_t *q, blk_request_t *rq) {
+    blockdev_t *dev = q->dev;
+
+    if (rq->buffer == NULL) {
+        if (!rq->bounce) {
+            rq->buffer = rq->bios->buffer;
+        } else {
+            rq->buffer = (uint8_t *)kmalloc(rq->count * q->block_size);
+            if (rq->buffer == NULL) {
+                LOG_ERROR_MSG("bio: %s no memory for %u-block bounce buffer\n",
+                              dev->name, rq->count);
+                return -1;
+            }
+            if (rq->write) {
+                uint8_t *dst = rq->buffer;
+                for (bio_t *bio = rq->bios; bio != NULL; bio = bio->next) {
+                    uint32_t len = bio->count * q->block_size;
+                    memcpy(dst, bio->buffer, len);
+                    dst += len;
+                }
+            }
+        }
+    }
+
+    if (dev->submit != NULL) {
+        return dev->submit(dev->private_data, rq);
+    }
+
+    int ret;
+    if (rq->write) {
+        ret = dev->write != NULL ? dev->write(dev->private_data, rq->sector, rq->count, rq->buffer) : -1;
+    } else {
+        ret = dev->read != NULL ? dev->read(dev->private_data, rq->sector, rq->count, rq->buffer) : -1;
+    }
+    blk_complete(q, rq, ret == 0 ? 0 : -1);
+    return 0;
+}
+
+/* force：等待者需要自己的请求被派发，忽略 plug */
+static void blk_dispatch(blk_queue_t *q, bool force) {
+    bool irq_state;
+    spinlock_lock_irqsave(&q->lock, &irq_state);
+    if (q->dispatching) {
+        spinlock_unlock_irqrestore(&q->lock, irq_state);
+        return;
+    }
+    q->dispatching = true;
+
+    while ((force || q->plugged == 0) && q->inflight < q->depth) {
+        blk_request_t *rq = blk_elevator_next(q);
+        if (rq == NULL) {
+            break;
+        }
+        q->inflight++;
+        rq->last = q->queue == NULL || q->inflight >= q->depth || (!force && q->plugged != 0);
+        if (q->inflight > q->stats.max_inflight) {
+            q->stats.max_inflight = q->inflight;
+        }
+        q->stats.requests++;
+        q->stats.sectors += rq->count;
+        if (rq->bounce) {
+            q->stats.bounced++;
+        }
+        spinlock_unlock_irqrestore(&q->lock, irq_state);
+
+        int ret = blk_issue(q, rq);
+        if (ret < 0) {
+            blk_complete(q, rq, -1);
+        }
+
+        spinlock_lock_irqsave(&q->lock, &irq_state);
+        if (ret > 0) {
+            // 驱动暂时接不下，放回队列等下一次完成时再派发
+            q->inflight--;
+            q->stats.requests--;
+            q->stats.sectors -= rq->count;
+            if (rq->bounce) {
+                q->stats.bounced--;
+            }
+            blk_insert_sorted(q, rq);
+            q->head_pos = rq->sector;
+            break;
+        }
+    }
+
+    q->dispatching = false;
+    spinlock_unlock_irqrestore(&q->lock, irq_state);
+}
+
+/* ============================================================================
+ * kblockd：替完成路径派发
+ * ============================================================================ */
+
+static spinlock_t blk_kick_lock;
+static blk_queue_t *blk_kick_list;          // 待派发的队列（blk_kick_lock 保护）
+static blk_queue_t *blk_kick_current;       // kblockd 正在派发的队列
+static wait_queue_t blk_kick_wait;
+static volatile bool blk_kthread_running;
+
+/* 可在中断上下文调用 */
+static void blk_kick(blk_queue_t *q) {
+    if (!blk_kthread_running || __atomic_load_n(&q->queue, __ATOMIC_RELAXED) == NULL) {
+        return;
+    }
+    bool irq_state;
+    spinlock_lock_irqsave(&blk_kick_lock, &irq_state);
+    if (!q->kicked) {
+        q->kicked = true;
+        q->kick_next = blk_kick_list;
+        blk_kick_list = q;
+    }
+    spinlock_unlock_irqrestore(&blk_kick_lock, irq_state);
+    wait_queue_wake(&blk_kick_wait, 0);
+}
+
+static bool blk_kick_pending(void *arg) {
+    (void)arg;
+    return __atomic_load_n(&blk_kick_list, __ATOMIC_ACQUIRE) != NULL;
+}
+
+static void blk_kthread(void) {
+    for (;;) {
+        wait_queue_wait(&blk_kick_wait, blk_kick_pending, NULL, WAIT_FOREVER);
+
+        for (;;) {
+            bool irq_state;
+            spinlock_lock_irqsave(&blk_kick_lock, &irq_state);
+            blk_queue_t *q = blk_kick_list;
+            if (q != NULL) {
+                blk_kick_list = q->kick_next;
+                q->kick_next = NULL;
+                q->kicked = false;
+            }
+            blk_kick_current = q;
+            spinlock_unlock_irqrestore(&blk_kick_lock, irq_state);
+
+            if (q == NULL) {
+                break;
+            }
+            blk_dispatch(q, false);
+        }
+    }
+}
+
+void blk_start_thread(void) {
+    if (blk_kthread_running) {
+        return;
+    }
+    spinlock_init(&blk_kick_lock);
+    wait_queue_init(&blk_kick_wait);
+    if (task_create_kernel_thread(blk_kthread, "kblockd") == 0) {
+        LOG_WARN_MSG("bio: failed to start kblockd, completions leave dispatch to submitters\n");
+        return;
+    }
+    blk_kthread_running = true;
+}
+
+/* 把队列从待派发链上摘下，并等 kblockd 结束对它的派发（销毁队列前调用） */
+static void blk_unkick(blk_queue_t *q) {
+    if (!blk_kthread_running) {
+        return;
+    }
+    for (;;) {
+        bool irq_state;
+        spinlock_lock_irqsave(&blk_kick_lock, &irq_state);
+        if (q->kicked) {
+            blk_queue_t **pp = &blk_kick_list;
+            while (*pp != NULL && *pp != q) {
+                pp = &(*pp)->kick_next;
+            }
+            if (*pp != NULL) {
+                *pp = q->kick_next;
+            }
+            q->kicked = false;
+        }
+        bool busy = blk_kick_current == q;
+        spinlock_unlock_irqrestore(&blk_kick_lock, irq_state);
+        if (!busy) {
+            return;
+        }
+        task_yield();
+    }
+}
+
+void blk_request_done(blk_request_t *rq, int status) {
+    if (rq == NULL) {
+        return;
+    }
+    blk_queue_t *q = rq->q;
+    blk_complete(q, rq, status);
+    // 可能在中断或等待者的条件回调中：不在这里派发
+    blk_kick(q);
+}
+
+void blk_run_queue(blockdev_t *dev) {
+    dev = blk_queue_dev(dev);
+    if (dev != NULL && dev->queue != NULL) {
+        blk_dispatch(dev->queue, false);
+    }
+}
+
+/* ============================================================================
+ * 提交与等待
+ * ============================================================================ */
+
+static bool blk_bio_done(void *arg) {
+    bio_t *bio = (bio_t *)arg;
+    blk_poll(bio->dev->queue);
+    return bio->done;
+}
+
+static bool blk_has_free(void *arg) {
+    blk_queue_t *q = (blk_queue_t *)arg;
+    blk_poll(q);
+    return q->free != NULL;
+}
+
+int bio_submit(bio_t *bio) {
+    if (bio == NULL || bio->dev == NULL || bio->buffer == NULL || bio->count == 0) {
+        return -1;
+    }
+    bio->status = 0;
+    bio->done = false;
+    bio->next = NULL;
+
+    blockdev_t *dev = bio->dev;
+    for (;;) {
+        if ((uint64_t)bio->sector + bio->count > dev->total_sectors) {
+            LOG_ERROR_MSG("bio: %s access beyond device (sector %u, count %u, total %u)\n",
+                          dev->name, bio->sector, bio->count, dev->total_sectors);
+            return -1;
+        }
+        if (dev->queue != NULL || dev->remap == NULL) {
+            break;
+        }
+        dev = dev->remap(dev->private_data, &bio->sector);
+        if (dev == NULL) {
+            return -1;
+        }
+    }
+    bio->dev = dev;
+
+    blk_queue_t *q = dev->queue;
+    if (q == NULL) {
+        int ret;
+        if (bio->write) {
+            ret = dev->write != NULL ? dev->write(dev->private_data, bio->sector, bio->count, bio->buffer) : -1;
+        } else {
+            ret = dev->read != NULL ? dev->read(dev->private_data, bio->sector, bio->count, bio->buffer) : -1;
+        }
+        blk_bio_complete(bio, ret == 0 ? 0 : -1);
+        return 0;
+    }
+    if (bio->count > q->max_sectors) {
+        return -1;
+    }
+
+    bool irq_state;
+    spinlock_lock_irqsave(&q->lock, &irq_state);
+    q->stats.bios++;
+    while (!blk_try_merge(q, bio)) {
+        blk_request_t *rq = q->free;
+        if (rq == NULL) {
+            // 请求结构用完：先把队列派发出去，等有请求完成
+            spinlock_unlock_irqrestore(&q->lock, irq_state);
+            blk_dispatch(q, true);
+            wait_queue_wait(&q->wait, blk_has_free, q, BLK_POLL_MS);
+            spinlock_lock_irqsave(&q->lock, &irq_state);
+            continue;
+        }
+        q->free = rq->next;
+
+        rq->q = q;
+        rq->sector = bio->sector;
+        rq->count = bio->count;
+        rq->write = bio->write;
+        rq->buffer = NULL;
+        rq->bounce = false;
+        rq->bios = bio;
+        rq->bios_tail = bio;
+        rq->nr_bios = 1;
+        rq->driver_data = NULL;
+        blk_insert_sorted(q, rq);
+        break;
+    }
+    bool plugged = q->plugged != 0;
+    spinlock_unlock_irqrestore(&q->lock, irq_state);
+
+    if (!plugged) {
+        blk_dispatch(q, false);
+    }
+    return 0;
+}
+
+int bio_wait(bio_t *bio) {
+    if (bio == NULL) {
+        return -1;
+    }
+    blk_queue_t *q = bio->dev != NULL ? bio->dev->queue : NULL;
+    while (!bio->done && q != NULL) {
+        // 请求可能还被 plug 压着，自己派发；同步驱动时可能由其他任务代为完成
+        blk_dispatch(q, true);
+        wait_queue_wait(&q->wait, blk_bio_done, bio, BLK_POLL_MS);
+    }
+    return bio->status;
+}
+
+int blk_rw_sync(blockdev_t *dev, uint32_t sector, uint32_t count, uint8_t *buffer, bool write) {
+    if (dev == NULL || buffer == NULL) {
+        return -1;
+    }
+    uint32_t max = blk_queue_max_sectors(dev);
+    uint32_t block_size = blockdev_get_block_size(dev);
+    bio_t bios[BLK_SYNC_BATCH];
+    int result = 0;
+
+    while (count > 0 && result == 0) {
+        uint32_t n = 0;
+        blk_start_plug(dev);
+        while (n < BLK_SYNC_BATCH && count > 0) {
+            uint32_t chunk = count < max ? count : max;
+            bio_t *bio = &bios[n];
+            memset(bio, 0, sizeof(*bio));
+            bio->dev = dev;
+            bio->sector = sector;
+            bio->count = chunk;
+            bio->buffer = buffer;
+            bio->write = write;
+            if (bio_submit(bio) != 0) {
+                result = -1;
+                break;
+            }
+            n++;
+            sector += chunk;
+            count -= chunk;
+            buffer += (size_t)chunk * block_size;
+        }
+        blk_finish_plug(dev);
+
+        for (uint32_t i = 0; i < n; i++) {
+            if (bio_wait(&bios[i]) != 0) {
+                result = -1;
+            }
+        }
+    }
+    return result;
+}
+
+/* ============================================================================
+ * 蓄积（plug）
+ * ============================================================================ */
+
+void blk_start_plug(blockdev_t *dev) {
+    dev = blk_queue_dev(dev);
+    if (dev == NULL || dev->queue == NULL) {
+        return;
+    }
+    blk_queue_t *q = dev->queue;
+    bool irq_state;
+    spinlock_lock_irqsave(&q->lock, &irq_state);
+    q->plugged++;
+    spinlock_unlock_irqrestore(&q->lock, irq_state);
+}
+
+void blk_finish_plug(blockdev_t *dev) {
+    dev = blk_queue_dev(dev);
+    if (dev == NULL || dev->queue == NULL) {
+        return;
+    }
+    blk_queue_t *q = dev->queue;
+    bool irq_state;
+    spinlock_lock_irqsave(&q->lock, &irq_state);
+    if (q->plugged > 0) {
+        q->plugged--;
+    }
+    bool run = q->plugged == 0;
+    spinlock_unlock_irqrestore(&q->lock, irq_state);
+
+    if (run) {
+        blk_dispatch(q, false);
+    }
+}
+
+/* ============================================================================
+ * 队列管理
+ * ============================================================================ */
+
+int blk_queue_init(blockdev_t *dev, uint32_t depth) {
+    if (dev == NULL || dev->queue != NULL) {
+        return -1;
+    }
+    blk_queue_t *q = (blk_queue_t *)kmalloc(sizeof(blk_queue_t));
+    if (q == NULL) {
+        LOG_ERROR_MSG("bio: %s no memory for request queue\n", dev->name);
+        return -1;
+    }
+    memset(q, 0, sizeof(*q));
+
+    q->dev = dev;
+    spinlock_init(&q->lock);
+    wait_queue_init(&q->wait);
+    q->block_size = dev->block_size != 0 ? dev->block_size : 512;
+    q->max_sectors = BLK_MAX_REQUEST_BYTES / q->block_size;
+    if (q->max_sectors == 0) {
+        q->max_sectors = 1;
+    }
+    if (dev->submit == NULL || depth == 0) {
+        depth = 1;
+    }
+    q->depth = depth < BLK_QUEUE_MAX_REQUESTS ? depth : BLK_QUEUE_MAX_REQUESTS;
+
+    for (uint32_t i = 0; i < BLK_QUEUE_MAX_REQUESTS; i++) {
+        q->reqs[i].q = q;
+        q->reqs[i].next = q->free;
+        q->free = &q->reqs[i];
+    }
+
+    dev->queue = q;
+    return 0;
+}
+
+void blk_queue_destroy(blockdev_t *dev) {
+    if (dev == NULL || dev->queue == NULL) {
+        return;
+    }
+    blk_queue_t *q = dev->queue;
+    if (q->queue != NULL || q->inflight != 0) {
+        LOG_WARN_MSG("bio: %s queue destroyed with requests pending\n", dev->name);
+    }
+    dev->queue = NULL;
+    blk_unkick(q);
+    wait_queue_detach_all(&q->wait, 0);
+    kfree(q);
+}
+
+uint32_t blk_queue_max_sectors(blockdev_t *dev) {
+    blockdev_t *qdev = blk_queue_dev(dev);
+    if (qdev != NULL && qdev->queue != NULL) {
+        return qdev->queue->max_sectors;
+    }
+    uint32_t block_size = blockdev_get_block_size(dev);
+    if (block_size == 0 || block_size > BLK_MAX_REQUEST_BYTES) {
+        return 1;
+    }
+    return BLK_MAX_REQUEST_BYTES / block_size;
+}
+
+int blk_queue_get_stats(blockdev_t *dev, blk_queue_stats_t *stats) {
+    dev = blk_queue_dev(dev);
+    if (dev == NULL || dev->queue == NULL || stats == NULL) {
+        return -1;
+    }
+    blk_queue_t *q = dev->queue;
+    bool irq_state;
+    spinlock_lock_irqsave(&q->lock, &irq_state);
+    *stats = q->stats;
+    spinlock_unlock_irqrestore(&q->lock, irq_state);
+    return 0;
+}
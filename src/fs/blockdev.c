@@ -3,6 +3,7 @@
 // ============================================================================
 
 #include <fs/blockdev.h>
+#include <fs/bio.h>
 #include <lib/klog.h>
 #include <lib/string.h>
 #include <kernel/sync/mutex.h>
@@ -46,7 +47,7 @@ static blockdev_t *blockdev_find_by_name_internal(const char *name) {
 }
 
 int blockdev_read(blockdev_t *dev, uint32_t sector, uint32_t count, uint8_t *buffer) {
-    if (!dev || !dev->read || !buffer) {
+    if (!dev || (!dev->read && !dev->queue) || !buffer) {
         return -1;
     }
     
@@ -56,11 +57,15 @@ int blockdev_read(blockdev_t *dev, uint32_t sector, uint32_t count, uint8_t *buf
         return -1;
     }
     
+    // 有请求队列的设备经队列排序合并后派发
+    if (dev->queue) {
+        return blk_rw_sync(dev, sector, count, buffer, false);
+    }
     return dev->read(dev->private_data, sector, count, buffer);
 }
 
 int blockdev_write(blockdev_t *dev, uint32_t sector, uint32_t count, const uint8_t *buffer) {
-    if (!dev || !dev->write || !buffer) {
+    if (!dev || (!dev->write && !dev->queue) || !buffer) {
         return -1;
     }
     
@@ -70,6 +75,9 @@ int blockdev_write(blockdev_t *dev, uint32_t sector, uint32_t count, const uint8
         return -1;
     }
     
+    if (dev->queue) {
+        return blk_rw_sync(dev, sector, count, (uint8_t *)(uintptr_t)buffer, true);
+    }
     return dev->write(dev->private_data, sector, count, buffer);
 }
 
@@ -0,0 +1,301 @@
+/**
+ * 目录项缓存实现
+ *
+ * 条目来自固定大小的静态池，按 (父节点指针, 名字) 散列；所有条目同时
+ * 挂在一条 LRU 链表上，命中时移到表头，池用完时淘汰表尾。
+ * 名字比较遵循父目录的 FS_NODE_FLAG_ICASE（FAT32 不区分大小写）。
+ */
+
+#include <fs/dcache.h>
+#include <kernel/sync/mutex.h>
+#include <lib/string.h>
+#include <lib/kprintf.h>
+#include <lib/klog.h>
+
+#define DCACHE_NAME_MAX     128
+
+/* 条目持有的引用（静态节点不做引用计数，也不能在释放后访问） */
+#define DENTRY_PIN_NODE     0x01
+#define DENTRY_PIN_PARENT   0x02
+
+typedef struct dentry {
+    fs_node_t *parent;
+    fs_node_t *node;                // NULL 表示负项
+    uint32_t hash;
+    uint32_t pins;
+    struct dentry *hash_next;
+    struct dentry **hash_pprev;
+    struct dentry *lru_prev;
+    struct dentry *lru_next;
+    char name[DCACHE_NAME_MAX];
+} dentry_t;
+
+static dentry_t dcache_pool[DCACHE_MAX_ENTRIES];
+static dentry_t *dcache_free_list = NULL;
+static dentry_t *dcache_hash[DCACHE_HASH_SIZE];
+static dentry_t dcache_lru;         // 哨兵：lru_next 最近使用，lru_prev 最久未用
+static dcache_stats_t dcache_stats;
+static mutex_t dcache_mutex;
+
+static inline bool dcache_icase(const fs_node_t *parent) {
+    return (parent->flags & FS_NODE_FLAG_ICASE) != 0;
+}
+
+static uint32_t dcache_hash_name(const fs_node_t *parent, const char *name) {
+    bool icase = dcache_icase(parent);
+    uint32_t h = 2166136261U;       // FNV-1a
+    for (const char *p = name; *p; p++) {
+        h ^= (uint8_t)(icase ? tolower(*p) : *p);
+        h *= 16777619U;
+    }
+    return h ^ ((uint32_t)(uintptr_t)parent * 2654435761U);
+}
+
+static bool dcache_name_eq(const fs_node_t *parent, const char *a, const char *b) {
+    return dcache_icase(parent) ? strcasecmp(a, b) == 0 : strcmp(a, b) == 0;
+}
+
+/* 同一目录的不同节点对象（例如经 ".." 得到）：同一文件系统、同一 inode */
+static bool dcache_same_dir(const fs_node_t *a, const fs_node_t *b) {
+    return a == b || (a->inode == b->inode && a->ops == b->ops);
+}
+
+static void dcache_lru_unlink(dentry_t *d) {
+    d->lru_prev->lru_next = d->lru_next;
+    d->lru_next->lru_prev = d->lru_prev;
+}
+
+static void dcache_lru_push(dentry_t *d) {
+    d->lru_prev = &dcache_lru;
+    d->lru_next = dcache_lru.lru_next;
+    dcache_lru.lru_next->lru_prev = d;
+    dcache_lru.lru_next = d;
+}
+
+static dentry_t *dcache_find(fs_node_t *parent, const char *name, uint32_t hash) {
+    for (dentry_t *d = dcache_hash[hash & (DCACHE_HASH_SIZE - 1)]; d; d = d->hash_next) {
+        if (d->hash == hash && d->parent == parent && dcache_name_eq(parent, d->name, name)) {
+            return d;
+        }
+    }
+    return NULL;
+}
+
+static void dcache_pin(dentry_t *d) {
+    d->pins = 0;
+    if (d->node && (d->node->flags & FS_NODE_FLAG_ALLOCATED)) {
+        vfs_ref_node(d->node);
+        d->pins |= DENTRY_PIN_NODE;
+    }
+    if (d->parent->flags & FS_NODE_FLAG_ALLOCATED) {
+        vfs_ref_node(d->parent);
+        d->pins |= DENTRY_PIN_PARENT;
+    }
+}
+
+static void dcache_unpin(dentry_t *d) {
+    if (d->pins & DENTRY_PIN_NODE) {
+        vfs_release_node(d->node);
+    }
+    if (d->pins & DENTRY_PIN_PARENT) {
+        vfs_release_node(d->parent);
+    }
+    d->pins = 0;
+}
+
+/* 从散列表和 LRU 中摘除并放回空闲池（持有 dcache_mutex） */
+static void dcache_remove(dentry_t *d) {
+    *d->hash_pprev = d->hash_next;
+    if (d->hash_next) {
+        d->hash_next->hash_pprev = d->hash_pprev;
+    }
+    dcache_lru_unlink(d);
+
+    if (!d->node) {
+        dcache_stats.negative--;
+    }
+    dcache_stats.entries--;
+    dcache_unpin(d);
+
+    d->parent = NULL;
+    d->node = NULL;
+    d->hash_next = dcache_free_list;
+    dcache_free_list = d;
+}
+
+void dcache_init(void) {
+    mutex_init_named(&dcache_mutex, "dcache");
+    memset(dcache_hash, 0, sizeof(dcache_hash));
+    memset(&dcache_stats, 0, sizeof(dcache_stats));
+    dcache_lru.lru_next = &dcache_lru;
+    dcache_lru.lru_prev = &dcache_lru;
+
+    dcache_free_list = NULL;
+    for (int i = DCACHE_MAX_ENTRIES - 1; i >= 0; i--) {
+        dcache_pool[i].parent = NULL;
+        dcache_pool[i].node = NULL;
+        dcache_pool[i].hash_next = dcache_free_list;
+        dcache_free_list = &dcache_pool[i];
+    }
+
+    LOG_INFO_MSG("dcache: %u entries, %u hash buckets\n", DCACHE_MAX_ENTRIES, DCACHE_HASH_SIZE);
+}
+
+bool dcache_lookup(fs_node_t *parent, const char *name, fs_node_t **node) {
+    if (!parent || !name || !node || !(parent->flags & FS_NODE_FLAG_DCACHE)) {
+        return false;
+    }
+
+    uint32_t hash = dcache_hash_name(parent, name);
+
+    mutex_lock(&dcache_mutex);
+    dcache_stats.lookups++;
+
+    dentry_t *d = dcache_find(parent, name, hash);
+    if (!d) {
+        mutex_unlock(&dcache_mutex);
+        return false;
+    }
+
+    dcache_lru_unlink(d);
+    dcache_lru_push(d);
+
+    if (d->node) {
+        vfs_ref_node(d->node);
+        dcache_stats.hits++;
+    } else {
+        dcache_stats.negative_hits++;
+    }
+    *node = d->node;
+
+    mutex_unlock(&dcache_mutex);
+    return true;
+}
+
+void dcache_add(fs_node_t *parent, const char *name, fs_node_t *node) {
+    if (!parent || !name || !(parent->flags & FS_NODE_FLAG_DCACHE)) {
+        return;
+    }
+    if (strlen(name) >= DCACHE_NAME_MAX) {
+        return;
+    }
+
+    uint32_t hash = dcache_hash_name(parent, name);
+
+    mutex_lock(&dcache_mutex);
+
+    // 并发查找可能已经加入了同一条目：以最新结果为准
+    dentry_t *d = dcache_find(parent, name, hash);
+    if (d) {
+        dcache_remove(d);
+    }
+
+    d = dcache_free_list;
+    if (d) {
+        dcache_free_list = d->hash_next;
+    } else {
+        // 池已满，淘汰最久未用的条目
+        dcache_remove(dcache_lru.lru_prev);
+        dcache_stats.evictions++;
+        d = dcache_free_list;
+        dcache_free_list = d->hash_next;
+    }
+
+    d->parent = parent;
+    d->node = node;
+    d->hash = hash;
+    strcpy(d->name, name);
+    dcache_pin(d);
+
+    dentry_t **bucket = &dcache_hash[hash & (DCACHE_HASH_SIZE - 1)];
+    d->hash_next = *bucket;
+    d->hash_pprev = bucket;
+    if (*bucket) {
+        (*bucket)->hash_pprev = &d->hash_next;
+    }
+    *bucket = d;
+    dcache_lru_push(d);
+
+    dcache_stats.entries++;
+    if (!node) {
+        dcache_stats.negative++;
+    }
+
+    mutex_unlock(&dcache_mutex);
+}
+
+void dcache_invalidate(fs_node_t *parent, const char *name) {
+    if (!parent || !name) {
+        return;
+    }
+
+    mutex_lock(&dcache_mutex);
+    dentry_t *d = dcache_lru.lru_next;
+    while (d != &dcache_lru) {
+        dentry_t *next = d->lru_next;
+        if (dcache_same_dir(d->parent, parent) && dcache_name_eq(parent, d->name, name)) {
+            dcache_remove(d);
+            dcache_stats.invalidations++;
+        }
+        d = next;
+    }
+    mutex_unlock(&dcache_mutex);
+}
+
+void dcache_invalidate_dir(fs_node_t *dir) {
+    if (!dir) {
+        return;
+    }
+
+    mutex_lock(&dcache_mutex);
+    dentry_t *d = dcache_lru.lru_next;
+    while (d != &dcache_lru) {
+        dentry_t *next = d->lru_next;
+        if (dcache_same_dir(d->parent, dir)) {
+            dcache_remove(d);
+            dcache_stats.invalidations++;
+        }
+        d = next;
+    }
+    mutex_unlock(&dcache_mutex);
+}
+
+void dcache_flush(void) {
+    mutex_lock(&dcache_mutex);
+    while (dcache_lru.lru_next != &dcache_lru) {
+        dcache_remove(dcache_lru.lru_next);
+        dcache_stats.invalidations++;
+    }
+    mutex_unlock(&dcache_mutex);
+}
+
+void dcache_get_stats(dcache_stats_t *stats) {
+    if (!stats) {
+        return;
+    }
+    mutex_lock(&dcache_mutex);
+    *stats = dcache_stats;
+    mutex_unlock(&dcache_mutex);
+}
+
+int dcache_dump(char *buf, size_t size) {
+    dcache_stats_t s;
+    dcache_get_stats(&s);
+
+    uint32_t hit = s.hits + s.negative_hits;
+    uint32_t rate = s.lookups ? (uint32_t)((uint64_t)hit * 100 / s.lookups) : 0;
+
+    return ksnprintf(buf, size,
+                     "entries:        %u / %u\n"
+                     "negative:       %u\n"
+                     "lookups:        %u\n"
+                     "hits:           %u\n"
+                     "negative_hits:  %u\n"
+                     "misses:         %u\n"
+                     "hit_rate:       %u%%\n"
+                     "evictions:      %u\n"
+                     "invalidations:  %u\n",
+                     s.entries, DCACHE_MAX_ENTRIES, s.negative, s.lookups,
+                     s.hits, s.negative_hits, s.lookups - hit, rate,
+                     s.evictions, s.invalidations);
+}
@@ -4,6 +4,7 @@
 
 #include <fs/devfs.h>
 #include <fs/vfs.h>
+#include <fs/poll.h>
 #include <lib/string.h>
 #include <lib/klog.h>
 #include <lib/kprintf.h>
@@ -11,6 +12,7 @@
 #include <drivers/serial.h>
 #if defined(ARCH_I686) || defined(ARCH_X86_64)
 #include <drivers/rtc.h>
+#include <drivers/keyboard.h>
 #endif
 #include <drivers/framebuffer.h>
 #include <kernel/io.h>
@@ -46,6 +48,7 @@ static uint32_t devconsole_read(fs_node_t *node, uint32_t offset,
                                 uint32_t size, uint8_t *buffer);
 static uint32_t devconsole_write(fs_node_t *node, uint32_t offset,
                                  uint32_t size, uint8_t *buffer);
+static uint32_t devconsole_poll(fs_node_t *node, poll_table_t *pt);
 static uint32_t devrtc_read(fs_node_t *node, uint32_t offset,
                             uint32_t size, uint8_t *buffer);
 static struct dirent *devfs_readdir(fs_node_t *node, uint32_t index);
@@ -188,6 +191,31 @@ static uint32_t devconsole_read(fs_node_t *node, uint32_t offset,
     return bytes_read;
 }
 
+/**
+ * /dev/console 就绪查询：输出总是可写，有缓冲输入时可读
+ * 
+ * x86 上登记键盘等待队列，按键到达时唤醒 select/epoll；
+ * ARM64 串口输入没有中断通知，只报告当前状态。
+ */
+static uint32_t devconsole_poll(fs_node_t *node, poll_table_t *pt) {
+    (void)node;
+    
+    uint32_t mask = POLLOUT;
+#if defined(ARCH_ARM64)
+    (void)pt;
+    extern bool serial_has_char(void);
+    if (serial_has_char()) {
+        mask |= POLLIN;
+    }
+#else
+    poll_wait(pt, keyboard_get_wait_queue());
+    if (keyboard_has_key()) {
+        mask |= POLLIN;
+    }
+#endif
+    return mask;
+}
+
 static uint32_t devconsole_write(fs_node_t *node, uint32_t offset,
                                  uint32_t size, uint8_t *buffer) {
     (void)node; (void)offset;
@@ -360,6 +388,37 @@ static fs_node_t *devfs_finddir(fs_node_t *node, const char *name) {
     return NULL;
 }
 
+/* 设备与根目录的操作表 */
+static const fs_node_ops_t devnull_ops = {
+    .read = devnull_read,
+    .write = devnull_write,
+};
+
+static const fs_node_ops_t devzero_ops = {
+    .read = devzero_read,
+    .write = devzero_write,
+};
+
+static const fs_node_ops_t devserial_ops = {
+    .read = devserial_read,
+    .write = devserial_write,
+};
+
+static const fs_node_ops_t devconsole_ops = {
+    .read = devconsole_read,
+    .write = devconsole_write,
+    .poll = devconsole_poll,
+};
+
+static const fs_node_ops_t devrtc_ops = {
+    .read = devrtc_read,    // 只读设备
+};
+
+static const fs_node_ops_t devfs_root_ops = {
+    .readdir = devfs_readdir,
+    .finddir = devfs_finddir,
+};
+
 /**
  * 初始化 devfs
  */
@@ -379,15 +438,7 @@ fs_node_t *devfs_init(void) {
     devfs_devices[0].gid = 0;
     devfs_devices[0].flags = 0;
     devfs_devices[0].ref_count = 0;  // 初始化引用计数
-    devfs_devices[0].read = devnull_read;
-    devfs_devices[0].write = devnull_write;
-    devfs_devices[0].open = NULL;
-    devfs_devices[0].close = NULL;
-    devfs_devices[0].readdir = NULL;
-    devfs_devices[0].finddir = NULL;
-    devfs_devices[0].create = NULL;
-    devfs_devices[0].mkdir = NULL;
-    devfs_devices[0].unlink = NULL;
+    devfs_devices[0].ops = &devnull_ops;
     devfs_devices[0].ptr = NULL;
     devfs_devices[0].impl = &devfs_device_private[0];  // 设置私有数据
     
@@ -401,15 +452,7 @@ fs_node_t *devfs_init(void) {
     devfs_devices[1].gid = 0;
     devfs_devices[1].flags = 0;
     devfs_devices[1].ref_count = 0;  // 初始化引用计数
-    devfs_devices[1].read = devzero_read;
-    devfs_devices[1].write = devzero_write;
-    devfs_devices[1].open = NULL;
-    devfs_devices[1].close = NULL;
-    devfs_devices[1].readdir = NULL;
-    devfs_devices[1].finddir = NULL;
-    devfs_devices[1].create = NULL;
-    devfs_devices[1].mkdir = NULL;
-    devfs_devices[1].unlink = NULL;
+    devfs_devices[1].ops = &devzero_ops;
     devfs_devices[1].ptr = NULL;
     devfs_devices[1].impl = &devfs_device_private[1];  // 设置私有数据
     
@@ -423,15 +466,7 @@ fs_node_t *devfs_init(void) {
     devfs_devices[2].gid = 0;
     devfs_devices[2].flags = 0;
     devfs_devices[2].ref_count = 0;  // 初始化引用计数
-    devfs_devices[2].read = devserial_read;
-    devfs_devices[2].write = devserial_write;
-    devfs_devices[2].open = NULL;
-    devfs_devices[2].close = NULL;
-    devfs_devices[2].readdir = NULL;
-    devfs_devices[2].finddir = NULL;
-    devfs_devices[2].create = NULL;
-    devfs_devices[2].mkdir = NULL;
-    devfs_devices[2].unlink = NULL;
+    devfs_devices[2].ops = &devserial_ops;
     devfs_devices[2].ptr = NULL;
     devfs_devices[2].impl = &devfs_device_private[2];  // 设置私有数据
     
@@ -445,15 +480,7 @@ fs_node_t *devfs_init(void) {
     devfs_devices[3].gid = 0;
     devfs_devices[3].flags = 0;
     devfs_devices[3].ref_count = 0;  // 初始化引用计数
-    devfs_devices[3].read = devconsole_read;
-    devfs_devices[3].write = devconsole_write;
-    devfs_devices[3].open = NULL;
-    devfs_devices[3].close = NULL;
-    devfs_devices[3].readdir = NULL;
-    devfs_devices[3].finddir = NULL;
-    devfs_devices[3].create = NULL;
-    devfs_devices[3].mkdir = NULL;
-    devfs_devices[3].unlink = NULL;
+    devfs_devices[3].ops = &devconsole_ops;
     devfs_devices[3].ptr = NULL;
     devfs_devices[3].impl = &devfs_device_private[3];  // 设置私有数据
     
@@ -467,15 +494,7 @@ fs_node_t *devfs_init(void) {
     devfs_devices[4].gid = 0;
     devfs_devices[4].flags = 0;
     devfs_devices[4].ref_count = 0;  // 初始化引用计数
-    devfs_devices[4].read = devrtc_read;
-    devfs_devices[4].write = NULL;  // 只读设备
-    devfs_devices[4].open = NULL;
-    devfs_devices[4].close = NULL;
-    devfs_devices[4].readdir = NULL;
-    devfs_devices[4].finddir = NULL;
-    devfs_devices[4].create = NULL;
-    devfs_devices[4].mkdir = NULL;
-    devfs_devices[4].unlink = NULL;
+    devfs_devices[4].ops = &devrtc_ops;
     devfs_devices[4].ptr = NULL;
     devfs_devices[4].impl = &devfs_device_private[4];  // 设置私有数据
     
@@ -506,15 +525,7 @@ fs_node_t *devfs_init(void) {
     devfs_root->gid = 0;
     devfs_root->flags = 0;
     devfs_root->ref_count = 0;  // 初始化引用计数
-    devfs_root->read = NULL;
-    devfs_root->write = NULL;
-    devfs_root->open = NULL;
-    devfs_root->close = NULL;
-    devfs_root->readdir = devfs_readdir;
-    devfs_root->finddir = devfs_finddir;
-    devfs_root->create = NULL;  // 不支持创建设备
-    devfs_root->mkdir = NULL;   // 不支持创建目录
-    devfs_root->unlink = NULL;  // 不支持删除设备
+    devfs_root->ops = &devfs_root_ops;  // 只读目录，不支持创建/删除
     devfs_root->ptr = NULL;
     devfs_root->impl = devfs_root_private;  // 设置私有数据
     
@@ -0,0 +1,556 @@
+/**
+ * epoll 实现
+ *
+ * 每个 epoll 实例包含：
+ * - 兴趣列表：按 (fd, 是否 socket) 散列的 epitem
+ * - 就绪链表：被回调唤醒的 epitem，epoll_wait 只遍历这里
+ * - 等待队列：阻塞在 epoll_wait 上的任务
+ *
+ * epitem 在目标对象的等待队列上挂回调等待项（通过对象的 poll 操作登记）。
+ * 回调可能在中断上下文执行（网卡收包），因此就绪链表由自旋锁保护；
+ * 兴趣列表只在进程上下文修改，由互斥锁保护。
+ */
+
+#include <fs/eventpoll.h>
+#include <fs/vfs.h>
+#include <kernel/task.h>
+#include <kernel/fd_table.h>
+#include <kernel/syscalls/fs.h>
+#include <kernel/sync/mutex.h>
+#include <kernel/sync/spinlock.h>
+#include <kernel/sync/waitqueue.h>
+#include <drivers/timer.h>
+#include <mm/heap.h>
+#include <lib/string.h>
+#include <lib/klog.h>
+
+#if !defined(ARCH_ARM64)
+#include <net/socket.h>
+#endif
+
+#define EP_HASH_SIZE        64
+#define EP_MAX_WAITS        2       ///< 每个对象最多登记的等待队列数
+
+/* 总是报告的事件（不需要用户关注） */
+#define EP_ALWAYS_EVENTS    (EPOLLERR | EPOLLHUP)
+
+struct eventpoll;
+
+typedef struct epitem {
+    struct eventpoll *ep;
+    int fd;
+    bool is_socket;
+    fs_node_t *node;                        // 文件目标（持有引用），socket 为 NULL
+    uint32_t events;                        // 关注的事件（含 EPOLLET/EPOLLONESHOT）
+    uint64_t data;
+    wait_queue_entry_t waits[EP_MAX_WAITS];
+    uint32_t nwait;
+    bool ready;                             // 是否在就绪链表上
+    bool dead;                              // 目标对象已释放
+    struct epitem *hash_next;
+    struct epitem *ready_next;
+} epitem_t;
+
+typedef struct eventpoll {
+    mutex_t mtx;                            // 保护兴趣列表
+    spinlock_t lock;                        // 保护就绪链表
+    epitem_t *hash[EP_HASH_SIZE];
+    epitem_t *ready_head;
+    epitem_t *ready_tail;
+    wait_queue_t wq;                        // epoll_wait 等待者
+    wait_queue_t poll_wq;                   // 嵌套 epoll / select 等待者
+    uint32_t nitems;
+} eventpoll_t;
+
+typedef struct ep_pqueue {
+    poll_table_t pt;                        // 必须为第一个成员
+    epitem_t *item;
+} ep_pqueue_t;
+
+static uint32_t ep_inode_counter = 0x20000;
+
+static inline uint32_t ep_hash(int fd, bool is_socket) {
+    return ((uint32_t)fd * 2U + (is_socket ? 1U : 0U)) % EP_HASH_SIZE;
+}
+
+static epitem_t *ep_find(eventpoll_t *ep, int fd, bool is_socket) {
+    epitem_t *item = ep->hash[ep_hash(fd, is_socket)];
+    while (item) {
+        if (item->fd == fd && item->is_socket == is_socket) {
+            return item;
+        }
+        item = item->hash_next;
+    }
+    return NULL;
+}
+
+/* 加入就绪链表（调用者持有 ep->lock） */
+static void ep_ready_add(eventpoll_t *ep, epitem_t *item) {
+    if (item->ready) {
+        return;
+    }
+    item->ready = true;
+    item->ready_next = NULL;
+    if (ep->ready_tail) {
+        ep->ready_tail->ready_next = item;
+    } else {
+        ep->ready_head = item;
+    }
+    ep->ready_tail = item;
+}
+
+/* 从就绪链表摘除（调用者持有 ep->lock） */
+static void ep_ready_remove(eventpoll_t *ep, epitem_t *item) {
+    if (!item->ready) {
+        return;
+    }
+
+    epitem_t **pp = &ep->ready_head;
+    epitem_t *prev = NULL;
+    while (*pp && *pp != item) {
+        prev = *pp;
+        pp = &(*pp)->ready_next;
+    }
+    if (*pp == item) {
+        *pp = item->ready_next;
+        if (ep->ready_tail == item) {
+            ep->ready_tail = prev;
+        }
+    }
+    item->ready = false;
+    item->ready_next = NULL;
+}
+
+/**
+ * 目标对象的唤醒回调
+ * 在对象的等待队列锁内执行（可能处于中断上下文）
+ */
+static void ep_poll_callback(wait_queue_entry_t *entry, uint32_t key) {
+    epitem_t *item = (epitem_t *)entry->data;
+    eventpoll_t *ep = item->ep;
+
+    if (key & POLLFREE) {
+        // 对象即将释放，等待项已被摘除
+        item->dead = true;
+    } else if (key && !(key & (item->events | EP_ALWAYS_EVENTS))) {
+        return;
+    }
+
+    // 没有关注任何事件（EPOLLONESHOT 已触发）
+    if (!item->dead && !(item->events & ~(EPOLLET | EPOLLONESHOT))) {
+        return;
+    }
+
+    bool irq_state;
+    spinlock_lock_irqsave(&ep->lock, &irq_state);
+    ep_ready_add(ep, item);
+    spinlock_unlock_irqrestore(&ep->lock, irq_state);
+
+    wait_queue_wake(&ep->wq, key);
+    wait_queue_wake(&ep->poll_wq, POLLIN);
+}
+
+static void ep_queue_proc(poll_table_t *pt, wait_queue_t *wq) {
+    epitem_t *item = ((ep_pqueue_t *)pt)->item;
+    if (item->nwait >= EP_MAX_WAITS) {
+        return;
+    }
+
+    wait_queue_entry_t *entry = &item->waits[item->nwait++];
+    wait_queue_entry_init_func(entry, ep_poll_callback, item);
+    wait_queue_add(wq, entry);
+}
+
+/* 查询目标就绪状态；pt 非 NULL 时同时登记等待项 */
+static uint32_t ep_item_poll(epitem_t *item, poll_table_t *pt) {
+#if !defined(ARCH_ARM64)
+    if (item->is_socket) {
+        return socket_poll(item->fd, pt);
+    }
+#endif
+    return vfs_poll(item->node, pt);
+}
+
+/* 登记等待项并返回当前就绪事件 */
+static uint32_t ep_item_register(epitem_t *item) {
+    ep_pqueue_t epq;
+    epq.pt.qproc = ep_queue_proc;
+    epq.item = item;
+    return ep_item_poll(item, &epq.pt);
+}
+
+static void ep_item_unregister(epitem_t *item) {
+    for (uint32_t i = 0; i < item->nwait; i++) {
+        wait_queue_remove(&item->waits[i]);
+    }
+    item->nwait = 0;
+}
+
+/* 从兴趣列表删除并释放条目（调用者持有 ep->mtx） */
+static void ep_item_free(eventpoll_t *ep, epitem_t *item) {
+    // 先摘除等待项，此后回调不会再引用 item
+    ep_item_unregister(item);
+
+    bool irq_state;
+    spinlock_lock_irqsave(&ep->lock, &irq_state);
+    ep_ready_remove(ep, item);
+    spinlock_unlock_irqrestore(&ep->lock, irq_state);
+
+    epitem_t **pp = &ep->hash[ep_hash(item->fd, item->is_socket)];
+    while (*pp && *pp != item) {
+        pp = &(*pp)->hash_next;
+    }
+    if (*pp == item) {
+        *pp = item->hash_next;
+    }
+    ep->nitems--;
+
+    if (item->node) {
+        vfs_release_node(item->node);
+    }
+    kfree(item);
+}
+
+static bool ep_has_ready(void *arg) {
+    return ((eventpoll_t *)arg)->ready_head != NULL;
+}
+
+/* ============================================================================
+ * epoll 文件节点
+ * ============================================================================ */
+
+static uint32_t ep_node_poll(fs_node_t *node, poll_table_t *pt) {
+    eventpoll_t *ep = (eventpoll_t *)node->impl;
+    if (!ep) {
+        return POLLNVAL;
+    }
+
+    poll_wait(pt, &ep->poll_wq);
+    return ep->ready_head ? POLLIN : 0;
+}
+
+static void ep_node_close(fs_node_t *node) {
+    eventpoll_t *ep = (eventpoll_t *)node->impl;
+    if (!ep) {
+        return;
+    }
+
+    // fork/dup 共享同一节点，最后一个描述符关闭时才销毁
+    if (node->ref_count > 1) {
+        return;
+    }
+
+    mutex_lock(&ep->mtx);
+    for (int i = 0; i < EP_HASH_SIZE; i++) {
+        while (ep->hash[i]) {
+            ep_item_free(ep, ep->hash[i]);
+        }
+    }
+    mutex_unlock(&ep->mtx);
+
+    wait_queue_detach_all(&ep->wq, POLLFREE);
+    wait_queue_detach_all(&ep->poll_wq, POLLFREE);
+
+    node->impl = NULL;
+    kfree(ep);
+}
+
+static const fs_node_ops_t ep_node_ops = {
+    .close = ep_node_close,
+    .poll = ep_node_poll,
+};
+
+/* 取 epfd 对应的 epoll 实例 */
+static eventpoll_t *ep_get(int epfd, fs_node_t **node_out) {
+    task_t *current = task_get_current();
+    if (!current || !current->fd_table) {
+        return NULL;
+    }
+
+    fd_entry_t *entry = fd_table_get(current->fd_table, epfd);
+    if (!entry || !entry->node || entry->node->ops != &ep_node_ops) {
+        return NULL;
+    }
+
+    if (node_out) {
+        *node_out = entry->node;
+    }
+    return (eventpoll_t *)entry->node->impl;
+}
+
+/* ============================================================================
+ * 系统调用
+ * ============================================================================ */
+
+int sys_epoll_create(int size) {
+    if (size <= 0) {
+        return -1;
+    }
+
+    task_t *current = task_get_current();
+    if (!current || !current->fd_table) {
+        LOG_ERROR_MSG("epoll_create: no current task or fd_table\n");
+        return -1;
+    }
+
+    eventpoll_t *ep = kmalloc(sizeof(eventpoll_t));
+    if (!ep) {
+        LOG_ERROR_MSG("epoll_create: failed to allocate eventpoll\n");
+        return -1;
+    }
+    memset(ep, 0, sizeof(eventpoll_t));
+    mutex_init(&ep->mtx);
+    spinlock_init(&ep->lock);
+    wait_queue_init(&ep->wq);
+    wait_queue_init(&ep->poll_wq);
+
+    fs_node_t *node = kmalloc(sizeof(fs_node_t));
+    if (!node) {
+        LOG_ERROR_MSG("epoll_create: failed to allocate node\n");
+        kfree(ep);
+        return -1;
+    }
+    memset(node, 0, sizeof(fs_node_t));
+    strcpy(node->name, "[eventpoll]");
+    node->inode = ep_inode_counter++;
+    node->type = FS_CHARDEVICE;
+    node->permissions = 0600;
+    node->impl = ep;
+    node->flags = FS_NODE_FLAG_ALLOCATED;
+    node->ref_count = 1;
+    node->ops = &ep_node_ops;
+
+    int32_t fd = fd_table_alloc(current->fd_table, node, O_RDONLY);
+    if (fd < 0) {
+        LOG_ERROR_MSG("epoll_create: failed to allocate fd\n");
+        vfs_release_node(node);
+        return -1;
+    }
+
+    // 释放创建时的初始引用（fd_table_alloc 已增加引用）
+    vfs_release_node(node);
+
+    LOG_DEBUG_MSG("epoll_create: epfd=%d\n", fd);
+    return fd;
+}
+
+int sys_epoll_ctl(int epfd, int op, int fd, struct epoll_event *event) {
+    fs_node_t *ep_node = NULL;
+    eventpoll_t *ep = ep_get(epfd, &ep_node);
+    if (!ep) {
+        return -1;
+    }
+
+    bool is_socket = (op & EPOLL_CTL_SOCK) != 0;
+    op &= ~EPOLL_CTL_SOCK;
+
+    if (op != EPOLL_CTL_DEL && !event) {
+        return -1;
+    }
+
+    fs_node_t *node = NULL;
+    if (is_socket) {
+#if defined(ARCH_ARM64)
+        return -1;
+#else
+        if (socket_poll(fd, NULL) & POLLNVAL) {
+            return -1;
+        }
+#endif
+    } else {
+        task_t *current = task_get_current();
+        fd_entry_t *entry = fd_table_get(current->fd_table, fd);
+        if (!entry || !entry->node) {
+            return -1;
+        }
+        node = entry->node;
+        // 不允许监视自身
+        if (node == ep_node) {
+            return -1;
+        }
+    }
+
+    int ret = 0;
+    mutex_lock(&ep->mtx);
+
+    epitem_t *item = ep_find(ep, fd, is_socket);
+    switch (op) {
+    case EPOLL_CTL_ADD: {
+        if (item) {
+            ret = -1;
+            break;
+        }
+
+        item = kmalloc(sizeof(epitem_t));
+        if (!item) {
+            ret = -1;
+            break;
+        }
+        memset(item, 0, sizeof(epitem_t));
+        item->ep = ep;
+        item->fd = fd;
+        item->is_socket = is_socket;
+        item->node = node;
+        item->events = event->events;
+        item->data = event->data.u64;
+        if (node) {
+            vfs_ref_node(node);
+        }
+
+        uint32_t h = ep_hash(fd, is_socket);
+        item->hash_next = ep->hash[h];
+        ep->hash[h] = item;
+        ep->nitems++;
+
+        // 登记等待项后检查一次：已经就绪的事件不会再有唤醒
+        uint32_t revents = ep_item_register(item);
+        if (revents & (item->events | EP_ALWAYS_EVENTS)) {
+            bool irq_state;
+            spinlock_lock_irqsave(&ep->lock, &irq_state);
+            ep_ready_add(ep, item);
+            spinlock_unlock_irqrestore(&ep->lock, irq_state);
+            wait_queue_wake(&ep->wq, revents);
+            wait_queue_wake(&ep->poll_wq, POLLIN);
+        }
+        break;
+    }
+
+    case EPOLL_CTL_MOD: {
+        if (!item) {
+            ret = -1;
+            break;
+        }
+
+        item->events = event->events;
+        item->data = event->data.u64;
+
+        uint32_t revents = ep_item_poll(item, NULL);
+        if (revents & (item->events | EP_ALWAYS_EVENTS)) {
+            bool irq_state;
+            spinlock_lock_irqsave(&ep->lock, &irq_state);
+            ep_ready_add(ep, item);
+            spinlock_unlock_irqrestore(&ep->lock, irq_state);
+            wait_queue_wake(&ep->wq, revents);
+        }
+        break;
+    }
+
+    case EPOLL_CTL_DEL:
+        if (!item) {
+            ret = -1;
+            break;
+        }
+        ep_item_free(ep, item);
+        break;
+
+    default:
+        ret = -1;
+        break;
+    }
+
+    mutex_unlock(&ep->mtx);
+    return ret;
+}
+
+/* 收集就绪事件（调用者持有 ep->mtx） */
+static int ep_harvest(eventpoll_t *ep, struct epoll_event *events, int maxevents) {
+    bool irq_state;
+    spinlock_lock_irqsave(&ep->lock, &irq_state);
+    epitem_t *list = ep->ready_head;
+    ep->ready_head = NULL;
+    ep->ready_tail = NULL;
+    spinlock_unlock_irqrestore(&ep->lock, irq_state);
+
+    int count = 0;
+    while (list) {
+        epitem_t *item = list;
+        list = item->ready_next;
+        item->ready_next = NULL;
+        item->ready = false;
+
+        if (count >= maxevents) {
+            // 放不下的条目放回就绪链表，下次再报告
+            spinlock_lock_irqsave(&ep->lock, &irq_state);
+            ep_ready_add(ep, item);
+            spinlock_unlock_irqrestore(&ep->lock, irq_state);
+            continue;
+        }
+
+        if (item->dead) {
+            // 目标已关闭：报告一次挂断后自动移出兴趣列表
+            events[count].events = EPOLLHUP | EPOLLERR;
+            events[count].data.u64 = item->data;
+            count++;
+            ep_item_free(ep, item);
+            continue;
+        }
+
+        // 目标创建时尚未有等待队列（如未连接的 socket），补登记
+        uint32_t revents = (item->nwait == 0) ? ep_item_register(item)
+                                               : ep_item_poll(item, NULL);
+        revents &= item->events | EP_ALWAYS_EVENTS;
+        if (!revents) {
+            continue;
+        }
+
+        events[count].events = revents;
+        events[count].data.u64 = item->data;
+        count++;
+
+        if (item->events & EPOLLONESHOT) {
+            item->events &= EPOLLET | EPOLLONESHOT;
+        } else if (!(item->events & EPOLLET)) {
+            // 水平触发：仍然就绪的条目留在就绪链表上
+            spinlock_lock_irqsave(&ep->lock, &irq_state);
+            ep_ready_add(ep, item);
+            spinlock_unlock_irqrestore(&ep->lock, irq_state);
+        }
+    }
+
+    return count;
+}
+
+int sys_epoll_wait(int epfd, struct epoll_event *events, int maxevents, int timeout) {
+    if (!events || maxevents <= 0) {
+        return -1;
+    }
+    if (maxevents > EPOLL_MAX_EVENTS) {
+        maxevents = EPOLL_MAX_EVENTS;
+    }
+
+    eventpoll_t *ep = ep_get(epfd, NULL);
+    if (!ep) {
+        return -1;
+    }
+
+    uint64_t deadline = 0;
+    if (timeout > 0) {
+        deadline = timer_get_uptime_ms() + (uint32_t)timeout;
+    }
+
+    int count = 0;
+    for (;;) {
+        mutex_lock(&ep->mtx);
+        count = ep_harvest(ep, events, maxevents);
+        mutex_unlock(&ep->mtx);
+
+        if (count > 0 || timeout == 0) {
+            break;
+        }
+
+        // 被唤醒的条目复查时可能已不再就绪，继续等待剩余时间
+        uint32_t wait_ms = WAIT_FOREVER;
+        if (deadline) {
+            uint64_t now = timer_get_uptime_ms();
+            if (now >= deadline) {
+                break;
+            }
+            wait_ms = (uint32_t)(deadline - now);
+        }
+        if (wait_queue_wait(&ep->wq, ep_has_ready, ep, wait_ms) != 0) {
+            break;
+        }
+    }
+
+    return count;
+}
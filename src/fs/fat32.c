@@ -1,13 +1,27 @@
 // ============================================================================
 // fat32.c - FAT32 文件系统实现
 // ============================================================================
+//
+// 加锁规则（按获取顺序）：
+//   1. 节点的 rwsem：文件读取持读锁，写入/截断持写锁；目录查找和迭代
+//      持读锁，目录项的增删改持写锁
+//   2. fs->fs_lock：所有对目录簇的读-改-写（新建、删除、重命名、写入后
+//      更新目录项中的大小和起始簇），只在这一小段内持有
+//   3. fs->alloc_lock：FAT 扇区的读-改-写和空闲簇扫描
+//   4. fs->fat_cache_lock、预读缓存锁：叶子锁，持有期间不做阻塞 I/O 以外的加锁
+// 读取路径不持有文件系统级别的锁：文件的簇链只在持有其写锁时改变，
+// 读者沿簇链读取 FAT 表项和数据簇时不会看到中间状态。
+// 持有 fs_lock 或 alloc_lock 时不得再获取 rwsem。
 
 #include <fs/fat32.h>
 #include <fs/vfs.h>
+#include <fs/bio.h>
 #include <lib/string.h>
 #include <lib/klog.h>
+#include <lib/kprintf.h>
 #include <mm/heap.h>
 #include <kernel/sync/mutex.h>
+#include <kernel/sync/rwsem.h>
 
 // FAT32 引导扇区（BPB - BIOS Parameter Block）
 typedef struct fat32_bpb {
@@ -71,10 +85,13 @@ typedef struct fat32_fs {
     uint32_t total_clusters;      // 数据区簇数量
     uint8_t *fat_cache;          // FAT 表缓存（可选）
     uint32_t fat_cache_sector;    // 缓存的 FAT 扇区号
+    mutex_t fat_cache_lock;       // 保护 fat_cache
+    struct fat32_ra_cache *ra;    // 预读缓存（可选）
     uint32_t last_allocated_cluster;  // 上次分配的簇号（用于加速下次分配）
     uint32_t next_free_cluster;   // FSInfo 中的下一个空闲簇号
     uint32_t fsinfo_sector;       // FSInfo 扇区号
-    mutex_t fs_lock;              // 文件系统级别锁，保护 FAT 表和簇分配
+    mutex_t fs_lock;              // 命名空间锁，保护目录项的增删改（目录簇的读-改-写）
+    mutex_t alloc_lock;           // 保护 FAT 表写入和空闲簇分配
 } fat32_fs_t;
 
 // FAT32 文件节点私有数据
@@ -86,7 +103,11 @@ typedef struct fat32_file {
     uint32_t dirent_cluster;      // 目录项所在簇
     uint32_t dirent_offset;       // 目录项偏移（字节）
     uint32_t parent_cluster;      // 父目录簇号
+    rw_semaphore_t rwsem;         // 文件：保护数据和簇链；目录：保护目录内容
     struct dirent readdir_cache;  // readdir 结果缓冲区（避免静态变量）
+    uint32_t ra_next;             // 顺序读时预期的下一个簇索引（预读缓存锁保护）
+    uint32_t ra_end;              // 已发起预读的簇索引上界（不含）
+    uint32_t ra_window;           // 预读窗口（簇），0 表示尚未检测到顺序读
 } fat32_file_t;
 
 // 目录查找结果
@@ -127,10 +148,34 @@ typedef struct fat32_fsinfo {
 // 前向声明
 static uint32_t fat32_cluster_to_sector(fat32_fs_t *fs, uint32_t cluster);
 static int fat32_read_cluster(fat32_fs_t *fs, uint32_t cluster, uint8_t *buffer);
+static int fat32_write_sectors(fat32_fs_t *fs, uint32_t sector, uint32_t count, const uint8_t *buffer);
+static void fat32_ra_invalidate(fat32_fs_t *fs, uint32_t first_cluster, uint32_t count);
 static int fat32_dir_create(fs_node_t *node, const char *name);
 static int fat32_dir_mkdir(fs_node_t *node, const char *name, uint32_t permissions);
 static int fat32_dir_unlink(fs_node_t *node, const char *name);
 static int fat32_dir_rename(fs_node_t *node, const char *old_name, const char *new_name);
+static uint32_t fat32_file_read(fs_node_t *node, uint32_t offset, uint32_t size, uint8_t *buffer);
+static uint32_t fat32_file_write(fs_node_t *node, uint32_t offset, uint32_t size, uint8_t *buffer);
+static int fat32_file_truncate(fs_node_t *node, uint32_t new_size);
+static struct dirent *fat32_dir_readdir(fs_node_t *node, uint32_t index);
+static fs_node_t *fat32_dir_finddir(fs_node_t *node, const char *name);
+static int fat32_dir_iterate(fs_node_t *node, dir_cursor_t *cursor, filldir_t fill, void *ctx);
+
+static const fs_node_ops_t fat32_file_ops = {
+    .read = fat32_file_read,
+    .write = fat32_file_write,
+    .truncate = fat32_file_truncate,
+};
+
+static const fs_node_ops_t fat32_dir_ops = {
+    .readdir = fat32_dir_readdir,
+    .finddir = fat32_dir_finddir,
+    .create = fat32_dir_create,
+    .mkdir = fat32_dir_mkdir,
+    .unlink = fat32_dir_unlink,
+    .rename = fat32_dir_rename,
+    .iterate = fat32_dir_iterate,
+};
 
 // ============================================================================
 // 内部辅助函数
@@ -159,6 +204,24 @@ static uint32_t fat32_read_fat_entry(fat32_fs_t *fs, uint32_t cluster) {
         return 0xFFFFFFFF;
     }
     
+    // 顺着簇链读取时相邻表项几乎总在同一扇区，先查单扇区缓存
+    if (fs->fat_cache) {
+        uint32_t entry = 0xFFFFFFFF;
+        mutex_lock(&fs->fat_cache_lock);
+        if (fs->fat_cache_sector != fat_sector) {
+            if (blockdev_read(fs->dev, fat_sector, 1, fs->fat_cache) != 0) {
+                fs->fat_cache_sector = 0xFFFFFFFF;
+                mutex_unlock(&fs->fat_cache_lock);
+                LOG_ERROR_MSG("fat32: Failed to read FAT sector %u\n", fat_sector);
+                return 0xFFFFFFFF;
+            }
+            fs->fat_cache_sector = fat_sector;
+        }
+        entry = *(uint32_t *)(fs->fat_cache + fat_index) & 0x0FFFFFFF;
+        mutex_unlock(&fs->fat_cache_lock);
+        return entry;
+    }
+
     // 读取 FAT 扇区
     uint8_t *sector_buffer = (uint8_t *)kmalloc(fs->bpb.bytes_per_sector);
     if (!sector_buffer) {
@@ -203,6 +266,9 @@ static int fat32_write_fat_entry(fat32_fs_t *fs, uint32_t cluster, uint32_t valu
         return -1;
     }
 
+    // 同一扇区中的其它表项可能属于别的文件，读-改-写必须互斥
+    mutex_lock(&fs->alloc_lock);
+
     // 更新所有 FAT 表副本
     for (uint32_t fat_index = 0; fat_index < fs->bpb.fat_count; fat_index++) {
         uint32_t sector = fs->fat_start_sector +
@@ -211,6 +277,7 @@ static int fat32_write_fat_entry(fat32_fs_t *fs, uint32_t cluster, uint32_t valu
 
         if (blockdev_read(fs->dev, sector, 1, sector_buffer) != 0) {
             LOG_ERROR_MSG("fat32: Failed to read FAT sector %u for write\n", sector);
+            mutex_unlock(&fs->alloc_lock);
             kfree(sector_buffer);
             return -1;
         }
@@ -222,11 +289,22 @@ static int fat32_write_fat_entry(fat32_fs_t *fs, uint32_t cluster, uint32_t valu
 
         if (blockdev_write(fs->dev, sector, 1, sector_buffer) != 0) {
             LOG_ERROR_MSG("fat32: Failed to write FAT sector %u\n", sector);
+            mutex_unlock(&fs->alloc_lock);
             kfree(sector_buffer);
             return -1;
         }
+
+        // 缓存的是第一份 FAT：写入后同步更新
+        if (fat_index == 0 && fs->fat_cache) {
+            mutex_lock(&fs->fat_cache_lock);
+            if (fs->fat_cache_sector == sector) {
+                memcpy(fs->fat_cache, sector_buffer, fs->bpb.bytes_per_sector);
+            }
+            mutex_unlock(&fs->fat_cache_lock);
+        }
     }
 
+    mutex_unlock(&fs->alloc_lock);
     kfree(sector_buffer);
     return 0;
 }
@@ -237,6 +315,7 @@ static int fat32_write_fat_entry(fat32_fs_t *fs, uint32_t cluster, uint32_t valu
 static void fat32_free_cluster(fat32_fs_t *fs, uint32_t cluster) {
     if (cluster >= 2) {
         fat32_write_fat_entry(fs, cluster, FAT32_CLUSTER_FREE);
+        fat32_ra_invalidate(fs, cluster, 1);
     }
 }
 
@@ -285,7 +364,7 @@ static int fat32_zero_cluster(fat32_fs_t *fs, uint32_t cluster) {
     }
     memset(buffer, 0, fs->bytes_per_cluster);
 
-    int ret = blockdev_write(fs->dev,
+    int ret = fat32_write_sectors(fs,
                              fat32_cluster_to_sector(fs, cluster),
                              fs->bpb.sectors_per_cluster,
                              buffer);
@@ -294,77 +373,74 @@ static int fat32_zero_cluster(fat32_fs_t *fs, uint32_t cluster) {
 }
 
 /**
- * 分配新的簇 - 使用 FSInfo 优化
+ * 在 [first, last] 中找到第一个空闲簇并标记为链尾（持有 alloc_lock）
+ * @return 簇号，0 表示没有空闲簇，0xFFFFFFFF 表示读写 FAT 失败
  */
-static uint32_t fat32_allocate_cluster(fat32_fs_t *fs) {
-    if (!fs) {
-        return 0;
-    }
-    
-    uint32_t max_cluster = fs->total_clusters + 1;
-    uint32_t start_cluster = 2;
-
-    // 优先使用 FSInfo 中的下一个空闲簇号
-    if (fs->next_free_cluster >= 2 && fs->next_free_cluster < max_cluster) {
-        start_cluster = fs->next_free_cluster;
-    }
-
-    // 第一次扫描：从 FSInfo 指示的位置开始
-    for (uint32_t cluster = start_cluster; cluster <= max_cluster; cluster++) {
+static uint32_t fat32_claim_free_cluster(fat32_fs_t *fs, uint32_t first, uint32_t last) {
+    for (uint32_t cluster = first; cluster <= last; cluster++) {
         uint32_t entry = fat32_read_fat_entry(fs, cluster);
         
         if (entry == 0xFFFFFFFF) {
             LOG_ERROR_MSG("fat32: Failed to read FAT entry for cluster %u\n", cluster);
-            return 0;
+            return 0xFFFFFFFF;
         }
         if (entry == FAT32_CLUSTER_FREE) {
-            // 分配这个簇
             if (fat32_write_fat_entry(fs, cluster, FAT32_CLUSTER_EOF_MAX) != 0) {
                 LOG_ERROR_MSG("fat32: Failed to write FAT entry for cluster %u\n", cluster);
-                return 0;
-            }
-            if (fat32_zero_cluster(fs, cluster) != 0) {
-                // 回滚 FAT 表项
-                LOG_ERROR_MSG("fat32: Failed to zero cluster %u, rolling back\n", cluster);
-                fat32_write_fat_entry(fs, cluster, FAT32_CLUSTER_FREE);
-                return 0;
+                return 0xFFFFFFFF;
             }
             // 更新 FSInfo 中的下一个空闲簇号
             fs->next_free_cluster = cluster + 1;
             return cluster;
         }
     }
+    return 0;
+}
 
-    // 第二次扫描：如果第一次没找到，从簇 2 开始重新扫描
-    if (start_cluster > 2) {
-        for (uint32_t cluster = 2; cluster < start_cluster; cluster++) {
-            uint32_t entry = fat32_read_fat_entry(fs, cluster);
-            
-            if (entry == 0xFFFFFFFF) {
-                LOG_ERROR_MSG("fat32: Failed to read FAT entry for cluster %u\n", cluster);
-                return 0;
-            }
-            if (entry == FAT32_CLUSTER_FREE) {
-                // 分配这个簇
-                if (fat32_write_fat_entry(fs, cluster, FAT32_CLUSTER_EOF_MAX) != 0) {
-                    LOG_ERROR_MSG("fat32: Failed to write FAT entry for cluster %u\n", cluster);
-                    return 0;
-                }
-                if (fat32_zero_cluster(fs, cluster) != 0) {
-                    // 回滚 FAT 表项
-                    LOG_ERROR_MSG("fat32: Failed to zero cluster %u, rolling back\n", cluster);
-                    fat32_write_fat_entry(fs, cluster, FAT32_CLUSTER_FREE);
-                    return 0;
-                }
-                // 更新 FSInfo 中的下一个空闲簇号
-                fs->next_free_cluster = cluster + 1;
-                return cluster;
-            }
-        }
+/**
+ * 分配新的簇 - 使用 FSInfo 优化
+ *
+ * 只有扫描和标记 FAT 表项在 alloc_lock 内进行；簇已标记为链尾后
+ * 不会再被别人分配，清零簇的磁盘写入在锁外完成。
+ */
+static uint32_t fat32_allocate_cluster(fat32_fs_t *fs) {
+    if (!fs) {
+        return 0;
     }
-
-    LOG_ERROR_MSG("fat32: No free clusters available\n");
-    return 0;
+    
+    uint32_t max_cluster = fs->total_clusters + 1;
+    
+    mutex_lock(&fs->alloc_lock);
+    
+    uint32_t start_cluster = 2;
+    // 优先使用 FSInfo 中的下一个空闲簇号
+    if (fs->next_free_cluster >= 2 && fs->next_free_cluster < max_cluster) {
+        start_cluster = fs->next_free_cluster;
+    }
+    
+    // 第一次扫描：从 FSInfo 指示的位置开始；没找到再从簇 2 开始扫描
+    uint32_t cluster = fat32_claim_free_cluster(fs, start_cluster, max_cluster);
+    if (cluster == 0 && start_cluster > 2) {
+        cluster = fat32_claim_free_cluster(fs, 2, start_cluster - 1);
+    }
+    
+    mutex_unlock(&fs->alloc_lock);
+    
+    if (cluster == 0xFFFFFFFF) {
+        return 0;
+    }
+    if (cluster == 0) {
+        LOG_ERROR_MSG("fat32: No free clusters available\n");
+        return 0;
+    }
+    
+    if (fat32_zero_cluster(fs, cluster) != 0) {
+        // 回滚 FAT 表项
+        LOG_ERROR_MSG("fat32: Failed to zero cluster %u, rolling back\n", cluster);
+        fat32_write_fat_entry(fs, cluster, FAT32_CLUSTER_FREE);
+        return 0;
+    }
+    return cluster;
 }
 
 /**
@@ -569,7 +645,7 @@ static int fat32_write_dir_entry(fat32_fs_t *fs, uint32_t dir_cluster, uint32_t
 
     memcpy(buffer + offset, entry, sizeof(fat32_dirent_t));
 
-    int ret = blockdev_write(fs->dev,
+    int ret = fat32_write_sectors(fs,
                              fat32_cluster_to_sector(fs, dir_cluster),
                              fs->bpb.sectors_per_cluster,
                              buffer);
@@ -623,7 +699,7 @@ static int fat32_initialize_directory_cluster(fat32_fs_t *fs, uint32_t self_clus
 
     memcpy(buffer + sizeof(fat32_dirent_t), &dotdot, sizeof(fat32_dirent_t));
 
-    int ret = blockdev_write(fs->dev,
+    int ret = fat32_write_sectors(fs,
                              fat32_cluster_to_sector(fs, self_cluster),
                              fs->bpb.sectors_per_cluster,
                              buffer);
@@ -711,7 +787,7 @@ static int fat32_mark_entry_deleted(fat32_fs_t *fs, uint32_t dir_cluster, uint32
     buffer[offset] = 0xE5;
     memset(buffer + offset + 1, 0, sizeof(fat32_dirent_t) - 1);
 
-    int ret = blockdev_write(fs->dev,
+    int ret = fat32_write_sectors(fs,
                              fat32_cluster_to_sector(fs, dir_cluster),
                              fs->bpb.sectors_per_cluster,
                              buffer);
@@ -837,7 +913,7 @@ static int fat32_zero_range(fat32_file_t *file, uint32_t start, uint32_t end) {
 
         memset(cluster_buffer + (position - cluster_start), 0, zero_end - position);
 
-        if (blockdev_write(fs->dev,
+        if (fat32_write_sectors(fs,
                            fat32_cluster_to_sector(fs, cluster),
                            fs->bpb.sectors_per_cluster,
                            cluster_buffer) != 0) {
@@ -854,6 +930,8 @@ static int fat32_zero_range(fat32_file_t *file, uint32_t start, uint32_t end) {
 
 /**
  * 更新目录项中的元数据
+ *
+ * 目录簇中的其它目录项可能同时被修改，读-改-写在 fs_lock 内进行
  */
 static int fat32_update_dirent_metadata(fat32_file_t *file) {
     if (!file || !file->fs) {
@@ -872,7 +950,10 @@ static int fat32_update_dirent_metadata(fat32_file_t *file) {
         return -1;
     }
 
+    mutex_lock(&fs->fs_lock);
+
     if (fat32_read_cluster(fs, file->dirent_cluster, buffer) != 0) {
+        mutex_unlock(&fs->fs_lock);
         kfree(buffer);
         return -1;
     }
@@ -884,11 +965,12 @@ static int fat32_update_dirent_metadata(fat32_file_t *file) {
     entry->file_size = file->size;
     entry->attributes |= FAT32_ATTR_ARCHIVE;
 
-    int ret = blockdev_write(fs->dev,
+    int ret = fat32_write_sectors(fs,
                              fat32_cluster_to_sector(fs, file->dirent_cluster),
                              fs->bpb.sectors_per_cluster,
                              buffer);
 
+    mutex_unlock(&fs->fs_lock);
     kfree(buffer);
     return ret;
 }
@@ -962,27 +1044,27 @@ static int fat32_file_truncate(fs_node_t *node, uint32_t new_size) {
         return -1;
     }
     
-    mutex_lock(&fs->fs_lock);
+    rwsem_write_lock(&file->rwsem);
     
     uint32_t cluster_size = fs->bytes_per_cluster;
     uint32_t old_size = file->size;
     
     if (new_size == old_size) {
         // 大小不变
-        mutex_unlock(&fs->fs_lock);
+        rwsem_write_unlock(&file->rwsem);
         return 0;
     }
     
     if (new_size > old_size) {
         // 扩展文件
         if (fat32_ensure_file_size(file, new_size) != 0) {
-            mutex_unlock(&fs->fs_lock);
+            rwsem_write_unlock(&file->rwsem);
             return -1;
         }
         
         // 将新扩展的区域填充为 0
         if (fat32_zero_range(file, old_size, new_size) != 0) {
-            mutex_unlock(&fs->fs_lock);
+            rwsem_write_unlock(&file->rwsem);
             return -1;
         }
     } else {
@@ -1011,7 +1093,7 @@ static int fat32_file_truncate(fs_node_t *node, uint32_t new_size) {
     // 更新目录项
     fat32_update_dirent_metadata(file);
     
-    mutex_unlock(&fs->fs_lock);
+    rwsem_write_unlock(&file->rwsem);
     
     LOG_DEBUG_MSG("fat32: Truncated file from %u to %u bytes\n", old_size, new_size);
     
@@ -1032,6 +1114,363 @@ static int fat32_read_cluster(fat32_fs_t *fs, uint32_t cluster, uint8_t *buffer)
     return blockdev_read(fs->dev, sector, fs->bpb.sectors_per_cluster, buffer);
 }
 
+// ============================================================================
+// 预读
+// ============================================================================
+//
+// 每个文件系统一个小的簇缓存，只存放预读的簇：顺序读时在读者前方发起
+// 异步 bio，读者命中时直接拷贝，仍在途时等待该 bio；未命中的簇照旧同步读取，
+// 不进入缓存。写入或释放簇时作废对应的缓存项，在途的读完成后丢弃。
+//
+// 每个打开的文件节点记录预期的下一个簇索引和窗口：接着上次读的位置继续读
+// 视为顺序读，窗口从 FAT32_RA_MIN_WINDOW 开始，读到预读数据时翻倍；
+// 非顺序访问使窗口减半，低于下限时停止预读。已预读的范围剩余不到半个窗口
+// 时才发起下一批，一批 bio 在 plug 下提交，相邻簇在块设备队列中合并。
+
+#define FAT32_RA_CACHE_BYTES    (256 * 1024)    // 每个文件系统的预读缓存容量
+#define FAT32_RA_MAX_SLOTS      64
+#define FAT32_RA_MIN_WINDOW     4               // 簇
+#define FAT32_RA_MAX_WINDOW     32
+
+enum {
+    FAT32_RA_FREE,
+    FAT32_RA_PENDING,           // bio 在途（或已完成未回收）
+    FAT32_RA_VALID,
+};
+
+typedef struct fat32_ra_slot {
+    uint32_t cluster;
+    uint8_t state;
+    bool stale;                 // 在途期间簇被写入或释放，完成后丢弃
+    bool used;                  // 已被读者使用
+    uint32_t refs;              // 正在等待在途 bio 的读者
+    uint32_t lru;
+    uint8_t *data;
+    bio_t bio;
+} fat32_ra_slot_t;
+
+typedef struct fat32_ra_cache {
+    mutex_t lock;               // 保护槽位和所有文件节点的 ra_* 字段
+    uint32_t nslots;
+    uint32_t clock;
+    fat32_ra_slot_t slots[FAT32_RA_MAX_SLOTS];
+} fat32_ra_cache_t;
+
+static fat32_ra_stats_t fat32_ra_stats;
+
+static void fat32_ra_init(fat32_fs_t *fs) {
+    fat32_ra_cache_t *ra = (fat32_ra_cache_t *)kmalloc(sizeof(fat32_ra_cache_t));
+    if (!ra) {
+        return;
+    }
+    memset(ra, 0, sizeof(*ra));
+    mutex_init_named(&ra->lock, "fat32_ra");
+
+    uint32_t slots = FAT32_RA_CACHE_BYTES / fs->bytes_per_cluster;
+    if (slots > FAT32_RA_MAX_SLOTS) {
+        slots = FAT32_RA_MAX_SLOTS;
+    }
+    for (uint32_t i = 0; i < slots; i++) {
+        ra->slots[i].data = (uint8_t *)kmalloc(fs->bytes_per_cluster);
+        if (!ra->slots[i].data) {
+            break;
+        }
+        ra->nslots++;
+    }
+    if (ra->nslots < FAT32_RA_MIN_WINDOW) {
+        for (uint32_t i = 0; i < ra->nslots; i++) {
+            kfree(ra->slots[i].data);
+        }
+        kfree(ra);
+        return;
+    }
+    fs->ra = ra;
+}
+
+static void fat32_ra_destroy(fat32_fs_t *fs) {
+    fat32_ra_cache_t *ra = fs->ra;
+    if (!ra) {
+        return;
+    }
+    for (uint32_t i = 0; i < ra->nslots; i++) {
+        if (ra->slots[i].state == FAT32_RA_PENDING) {
+            bio_wait(&ra->slots[i].bio);
+        }
+        kfree(ra->slots[i].data);
+    }
+    fs->ra = NULL;
+    kfree(ra);
+}
+
+/* 回收已完成的在途槽位（持有 ra->lock） */
+static void fat32_ra_reap(fat32_ra_slot_t *slot) {
+    if (slot->state != FAT32_RA_PENDING || !slot->bio.done) {
+        return;
+    }
+    if (slot->bio.status == 0 && !slot->stale) {
+        slot->state = FAT32_RA_VALID;
+    } else {
+        if (slot->stale) {
+            fat32_ra_stats.wasted++;
+        }
+        slot->state = FAT32_RA_FREE;
+    }
+}
+
+static fat32_ra_slot_t *fat32_ra_find(fat32_ra_cache_t *ra, uint32_t cluster) {
+    for (uint32_t i = 0; i < ra->nslots; i++) {
+        fat32_ra_slot_t *slot = &ra->slots[i];
+        fat32_ra_reap(slot);
+        if (slot->state != FAT32_RA_FREE && !slot->stale && slot->cluster == cluster) {
+            return slot;
+        }
+    }
+    return NULL;
+}
+
+/*
+ * 取一个可用槽位：优先空闲，其次最久未用的有效槽位（持有 ra->lock）
+ * 还有读者在等待的槽位即使已回收为空闲也不能复用：读者醒来后要检查它
+ */
+static fat32_ra_slot_t *fat32_ra_evict(fat32_ra_cache_t *ra) {
+    fat32_ra_slot_t *victim = NULL;
+    for (uint32_t i = 0; i < ra->nslots; i++) {
+        fat32_ra_slot_t *slot = &ra->slots[i];
+        fat32_ra_reap(slot);
+        if (slot->refs != 0) {
+            continue;
+        }
+        if (slot->state == FAT32_RA_FREE) {
+            return slot;
+        }
+        if (slot->state == FAT32_RA_VALID &&
+            (victim == NULL || (int32_t)(slot->lru - victim->lru) < 0)) {
+            victim = slot;
+        }
+    }
+    if (victim && !victim->used) {
+        fat32_ra_stats.wasted++;
+    }
+    return victim;
+}
+
+/**
+ * 从预读缓存读取簇的一部分
+ * @return true 命中并已拷贝，false 未命中（调用者同步读取）
+ */
+static bool fat32_ra_read(fat32_fs_t *fs, uint32_t cluster, uint8_t *dst,
+                          uint32_t offset, uint32_t len) {
+    fat32_ra_cache_t *ra = fs->ra;
+    if (!ra) {
+        return false;
+    }
+
+    mutex_lock(&ra->lock);
+    fat32_ra_slot_t *slot = fat32_ra_find(ra, cluster);
+    if (!slot) {
+        mutex_unlock(&ra->lock);
+        return false;
+    }
+    if (slot->state == FAT32_RA_PENDING) {
+        slot->refs++;
+        mutex_unlock(&ra->lock);
+        bio_wait(&slot->bio);
+        mutex_lock(&ra->lock);
+        slot->refs--;
+        fat32_ra_reap(slot);
+        if (slot->state != FAT32_RA_VALID || slot->stale || slot->cluster != cluster) {
+            mutex_unlock(&ra->lock);
+            return false;
+        }
+        fat32_ra_stats.waits++;
+    }
+
+    memcpy(dst, slot->data + offset, len);
+    if (!slot->used) {
+        slot->used = true;
+        fat32_ra_stats.hits++;
+    }
+    slot->lru = ++ra->clock;
+    mutex_unlock(&ra->lock);
+    return true;
+}
+
+/* 作废 [first_cluster, first_cluster + count) 的缓存项 */
+static void fat32_ra_invalidate(fat32_fs_t *fs, uint32_t first_cluster, uint32_t count) {
+    fat32_ra_cache_t *ra = fs->ra;
+    if (!ra) {
+        return;
+    }
+    mutex_lock(&ra->lock);
+    for (uint32_t i = 0; i < ra->nslots; i++) {
+        fat32_ra_slot_t *slot = &ra->slots[i];
+        if (slot->state == FAT32_RA_FREE || slot->stale ||
+            slot->cluster < first_cluster || slot->cluster - first_cluster >= count) {
+            continue;
+        }
+        if (slot->state == FAT32_RA_PENDING) {
+            slot->stale = true;
+        } else {
+            if (!slot->used) {
+                fat32_ra_stats.wasted++;
+            }
+            slot->state = FAT32_RA_FREE;
+        }
+    }
+    mutex_unlock(&ra->lock);
+}
+
+/* 数据区写入都经过这里，先作废被覆盖簇的预读数据 */
+static int fat32_write_sectors(fat32_fs_t *fs, uint32_t sector, uint32_t count, const uint8_t *buffer) {
+    if (fs->ra && sector + count > fs->data_start_sector) {
+        uint32_t start = sector > fs->data_start_sector ? sector : fs->data_start_sector;
+        uint32_t first = (start - fs->data_start_sector) / fs->bpb.sectors_per_cluster + 2;
+        uint32_t last = (sector + count - 1 - fs->data_start_sector) / fs->bpb.sectors_per_cluster + 2;
+        fat32_ra_invalidate(fs, first, last - first + 1);
+    }
+    return blockdev_write(fs->dev, sector, count, buffer);
+}
+
+/* 从 cluster 开始沿簇链发起最多 count 个簇的预读，返回实际走过的簇数 */
+static uint32_t fat32_ra_issue(fat32_fs_t *fs, uint32_t cluster, uint32_t count) {
+    fat32_ra_cache_t *ra = fs->ra;
+    uint32_t n = 0;
+
+    blk_start_plug(fs->dev);
+    while (n < count && cluster >= 2 && cluster < FAT32_CLUSTER_EOF_MIN) {
+        mutex_lock(&ra->lock);
+        fat32_ra_slot_t *slot = NULL;
+        if (!fat32_ra_find(ra, cluster)) {
+            slot = fat32_ra_evict(ra);
+            if (!slot) {
+                mutex_unlock(&ra->lock);
+                break;          // 全部槽位都在途
+            }
+            slot->cluster = cluster;
+            slot->state = FAT32_RA_PENDING;
+            slot->stale = false;
+            slot->used = false;
+            slot->lru = ++ra->clock;
+            memset(&slot->bio, 0, sizeof(slot->bio));
+            slot->bio.dev = fs->dev;
+            slot->bio.sector = fat32_cluster_to_sector(fs, cluster);
+            slot->bio.count = fs->bpb.sectors_per_cluster;
+            slot->bio.buffer = slot->data;
+            fat32_ra_stats.issued++;
+        }
+        mutex_unlock(&ra->lock);
+
+        if (slot && bio_submit(&slot->bio) != 0) {
+            mutex_lock(&ra->lock);
+            slot->state = FAT32_RA_FREE;
+            mutex_unlock(&ra->lock);
+            break;
+        }
+
+        n++;
+        uint32_t next = fat32_read_fat_entry(fs, cluster);
+        if (next == 0xFFFFFFFF) {
+            break;
+        }
+        cluster = next;
+    }
+    blk_finish_plug(fs->dev);
+    return n;
+}
+
+/**
+ * 一次读取结束后更新文件的顺序读状态，需要时发起下一批预读
+ * @param first     本次读取的第一个簇索引
+ * @param last      本次读取的最后一个簇索引
+ * @param next      簇索引 last + 1 对应的簇号
+ * @param hits      本次读取中命中预读的簇数
+ */
+static void fat32_readahead(fat32_file_t *file, uint32_t first, uint32_t last,
+                            uint32_t next, uint32_t hits) {
+    fat32_fs_t *fs = file->fs;
+    fat32_ra_cache_t *ra = fs->ra;
+    if (!ra) {
+        return;
+    }
+
+    uint32_t file_clusters = (file->size + fs->bytes_per_cluster - 1) / fs->bytes_per_cluster;
+    uint32_t start = 0;
+    uint32_t count = 0;
+
+    mutex_lock(&ra->lock);
+    bool sequential = first == file->ra_next || first + 1 == file->ra_next;
+    if (!sequential) {
+        if (file->ra_window) {
+            file->ra_window /= 2;
+            if (file->ra_window < FAT32_RA_MIN_WINDOW) {
+                file->ra_window = 0;
+            }
+            fat32_ra_stats.shrinks++;
+        }
+        file->ra_end = 0;
+    } else if (file->ra_window == 0) {
+        file->ra_window = FAT32_RA_MIN_WINDOW;
+    } else if (hits && file->ra_window < FAT32_RA_MAX_WINDOW) {
+        file->ra_window *= 2;
+        fat32_ra_stats.grows++;
+    }
+    file->ra_next = last + 1;
+
+    // 前方已预读的部分不足半个窗口时补到一个窗口
+    if (file->ra_window && file->ra_end < last + 1 + file->ra_window / 2) {
+        start = file->ra_end > last + 1 ? file->ra_end : last + 1;
+        uint32_t end = last + 1 + file->ra_window;
+        if (end > file_clusters) {
+            end = file_clusters;
+        }
+        if (start < end) {
+            count = end - start;
+            file->ra_end = end;
+        }
+    }
+    mutex_unlock(&ra->lock);
+
+    if (count == 0) {
+        return;
+    }
+
+    // next 对应 last + 1，前进到 start
+    uint32_t cluster = next;
+    for (uint32_t i = last + 1; i < start && cluster >= 2 && cluster < FAT32_CLUSTER_EOF_MIN; i++) {
+        cluster = fat32_read_fat_entry(fs, cluster);
+    }
+    uint32_t issued = fat32_ra_issue(fs, cluster, count);
+    if (issued < count) {
+        mutex_lock(&ra->lock);
+        file->ra_end = start + issued;
+        mutex_unlock(&ra->lock);
+    }
+}
+
+void fat32_readahead_get_stats(fat32_ra_stats_t *stats) {
+    if (stats) {
+        *stats = fat32_ra_stats;
+    }
+}
+
+int fat32_readahead_dump(char *buf, size_t size) {
+    fat32_ra_stats_t s = fat32_ra_stats;
+    uint32_t used = s.hits + s.misses;
+    uint32_t rate = used ? (uint32_t)((uint64_t)s.hits * 100 / used) : 0;
+
+    return ksnprintf(buf, size,
+                     "issued:         %u\n"
+                     "hits:           %u\n"
+                     "waits:          %u\n"
+                     "misses:         %u\n"
+                     "hit_rate:       %u%%\n"
+                     "wasted:         %u\n"
+                     "window_grows:   %u\n"
+                     "window_shrinks: %u\n",
+                     s.issued, s.hits, s.waits, s.misses, rate, s.wasted,
+                     s.grows, s.shrinks);
+}
+
 /**
  * 将 8.3 格式文件名转换为普通文件名
  */
@@ -1062,6 +1501,17 @@ static void fat32_format_filename(const char *fat_name, char *name) {
     }
 }
 
+/**
+ * 由目录项位置得到 inode 编号
+ *
+ * 不用起始簇号：空文件没有簇（全部为 0），写入后簇号才确定。
+ * 目录项位置在文件存在期间不变，在整个卷内唯一。
+ */
+static inline uint32_t fat32_dirent_ino(fat32_fs_t *fs, uint32_t dirent_cluster, uint32_t dirent_offset) {
+    return dirent_cluster * (fs->bytes_per_cluster / sizeof(fat32_dirent_t)) +
+           dirent_offset / sizeof(fat32_dirent_t);
+}
+
 /**
  * 检查目录项是否为有效文件
  */
@@ -1237,10 +1687,12 @@ static int fat32_dir_create(fs_node_t *node, const char *name) {
         return -1;
     }
     
-    // 获取文件系统锁
+    // 目录写锁排除同一目录上的查找和迭代，fs_lock 保护目录簇
+    rwsem_write_lock(&dir->rwsem);
     mutex_lock(&dir->fs->fs_lock);
     int ret = fat32_dir_create_entry(dir, name, false);
     mutex_unlock(&dir->fs->fs_lock);
+    rwsem_write_unlock(&dir->rwsem);
     return ret;
 }
 
@@ -1254,10 +1706,12 @@ static int fat32_dir_mkdir(fs_node_t *node, const char *name, uint32_t permissio
         return -1;
     }
     
-    // 获取文件系统锁
+    // 目录写锁排除同一目录上的查找和迭代，fs_lock 保护目录簇
+    rwsem_write_lock(&dir->rwsem);
     mutex_lock(&dir->fs->fs_lock);
     int ret = fat32_dir_create_entry(dir, name, true);
     mutex_unlock(&dir->fs->fs_lock);
+    rwsem_write_unlock(&dir->rwsem);
     return ret;
 }
 
@@ -1317,10 +1771,12 @@ static int fat32_dir_unlink(fs_node_t *node, const char *name) {
         return -1;
     }
     
-    // 获取文件系统锁
+    // 目录写锁排除同一目录上的查找和迭代，fs_lock 保护目录簇
+    rwsem_write_lock(&dir->rwsem);
     mutex_lock(&dir->fs->fs_lock);
     int ret = fat32_dir_remove_entry(node, name);
     mutex_unlock(&dir->fs->fs_lock);
+    rwsem_write_unlock(&dir->rwsem);
     return ret;
 }
 
@@ -1355,13 +1811,14 @@ static int fat32_dir_rename(fs_node_t *node, const char *old_name, const char *n
     
     fat32_fs_t *fs = dir->fs;
     
-    // 获取文件系统锁
+    rwsem_write_lock(&dir->rwsem);
     mutex_lock(&fs->fs_lock);
     
     // 查找旧文件
     fat32_dir_lookup_t *lookup = fat32_find_file_in_dir(fs, dir->start_cluster, old_name);
     if (!lookup) {
         mutex_unlock(&fs->fs_lock);
+        rwsem_write_unlock(&dir->rwsem);
         LOG_ERROR_MSG("fat32_dir_rename: '%s' not found\n", old_name);
         return -1;
     }
@@ -1372,6 +1829,7 @@ static int fat32_dir_rename(fs_node_t *node, const char *old_name, const char *n
         kfree(existing);
         kfree(lookup);
         mutex_unlock(&fs->fs_lock);
+        rwsem_write_unlock(&dir->rwsem);
         LOG_ERROR_MSG("fat32_dir_rename: '%s' already exists\n", new_name);
         return -1;
     }
@@ -1381,6 +1839,7 @@ static int fat32_dir_rename(fs_node_t *node, const char *old_name, const char *n
     if (fat32_make_short_name(new_name, short_name) != 0) {
         kfree(lookup);
         mutex_unlock(&fs->fs_lock);
+        rwsem_write_unlock(&dir->rwsem);
         LOG_ERROR_MSG("fat32_dir_rename: invalid new name '%s'\n", new_name);
         return -1;
     }
@@ -1393,6 +1852,7 @@ static int fat32_dir_rename(fs_node_t *node, const char *old_name, const char *n
     
     kfree(lookup);
     mutex_unlock(&fs->fs_lock);
+    rwsem_write_unlock(&dir->rwsem);
     
     if (ret == 0) {
         LOG_DEBUG_MSG("fat32_dir_rename: '%s' -> '%s' success\n", old_name, new_name);
@@ -1416,23 +1876,20 @@ static uint32_t fat32_file_read(fs_node_t *node, uint32_t offset, uint32_t size,
         return 0;
     }
 
-    if (file->start_cluster < 2 || file->size == 0) {
-        return 0;
-    }
+    fat32_fs_t *fs = file->fs;
+    
+    // 只持有本文件的读锁：其它文件的读写和同一文件的其它读者不受影响
+    rwsem_read_lock(&file->rwsem);
     
-    // 检查边界
-    if (offset >= file->size) {
+    // 检查边界（大小和簇链只在写锁下改变）
+    if (file->start_cluster < 2 || offset >= file->size) {
+        rwsem_read_unlock(&file->rwsem);
         return 0;
     }
     if (offset + size > file->size) {
         size = file->size - offset;
     }
     
-    fat32_fs_t *fs = file->fs;
-    
-    // 获取文件系统锁
-    mutex_lock(&fs->fs_lock);
-    
     uint32_t bytes_read = 0;
     uint32_t current_cluster = file->start_cluster;
     uint32_t cluster_offset = offset % fs->bytes_per_cluster;
@@ -1441,7 +1898,7 @@ static uint32_t fat32_file_read(fs_node_t *node, uint32_t offset, uint32_t size,
     // 读取数据
     uint8_t *cluster_buffer = (uint8_t *)kmalloc(fs->bytes_per_cluster);
     if (!cluster_buffer) {
-        mutex_unlock(&fs->fs_lock);
+        rwsem_read_unlock(&file->rwsem);
         return 0;
     }
     
@@ -1450,7 +1907,7 @@ static uint32_t fat32_file_read(fs_node_t *node, uint32_t offset, uint32_t size,
         uint32_t next = fat32_read_fat_entry(fs, current_cluster);
         if (next == 0xFFFFFFFF || next >= FAT32_CLUSTER_EOF_MIN) {
             kfree(cluster_buffer);
-            mutex_unlock(&fs->fs_lock);
+            rwsem_read_unlock(&file->rwsem);
             return bytes_read;
         }
         current_cluster = next;
@@ -1458,22 +1915,30 @@ static uint32_t fat32_file_read(fs_node_t *node, uint32_t offset, uint32_t size,
     
     uint32_t chain_length = 0;
     const uint32_t MAX_CHAIN_LENGTH = fs->total_clusters;
+    uint32_t first_index = current_cluster_index;
+    uint32_t ra_hits = 0;
     
     while (bytes_read < size && current_cluster >= 2 && current_cluster < FAT32_CLUSTER_EOF_MIN && chain_length < MAX_CHAIN_LENGTH) {
-        // 读取当前簇
-        if (fat32_read_cluster(fs, current_cluster, cluster_buffer) != 0) {
-            break;
-        }
-        
         // 计算本次读取的字节数
         uint32_t to_read = fs->bytes_per_cluster - cluster_offset;
         if (to_read > size - bytes_read) {
             to_read = size - bytes_read;
         }
         
-        // 复制数据
-        memcpy(buffer + bytes_read, cluster_buffer + cluster_offset, to_read);
+        // 先查预读缓存，未命中时同步读取当前簇
+        if (fat32_ra_read(fs, current_cluster, buffer + bytes_read, cluster_offset, to_read)) {
+            ra_hits++;
+        } else {
+            if (file->ra_window) {
+                fat32_ra_stats.misses++;
+            }
+            if (fat32_read_cluster(fs, current_cluster, cluster_buffer) != 0) {
+                break;
+            }
+            memcpy(buffer + bytes_read, cluster_buffer + cluster_offset, to_read);
+        }
         bytes_read += to_read;
+        current_cluster_index++;
         cluster_offset = 0;  // 后续簇从开头读取
         
         // 读取下一个簇
@@ -1489,8 +1954,13 @@ static uint32_t fat32_file_read(fs_node_t *node, uint32_t offset, uint32_t size,
         LOG_WARN_MSG("fat32: File cluster chain too long during read\n");
     }
     
+    // 簇链只在写锁下改变，持读锁沿链发起预读是安全的
+    if (current_cluster_index > first_index) {
+        fat32_readahead(file, first_index, current_cluster_index - 1, current_cluster, ra_hits);
+    }
+    
     kfree(cluster_buffer);
-    mutex_unlock(&fs->fs_lock);
+    rwsem_read_unlock(&file->rwsem);
     return bytes_read;
 }
 
@@ -1505,8 +1975,9 @@ static uint32_t fat32_file_write(fs_node_t *node, uint32_t offset, uint32_t size
 
     fat32_fs_t *fs = file->fs;
     
-    // 获取文件系统锁
-    mutex_lock(&fs->fs_lock);
+    // 本文件的写锁：簇链扩展和数据写入期间排除本文件的读者，
+    // 分配簇和更新目录项时才短暂获取 alloc_lock / fs_lock
+    rwsem_write_lock(&file->rwsem);
     
     uint32_t cluster_size = fs->bytes_per_cluster;
     uint32_t original_size = file->size;
@@ -1515,7 +1986,7 @@ static uint32_t fat32_file_write(fs_node_t *node, uint32_t offset, uint32_t size
     if (end_pos64 > 0xFFFFFFFFULL) {
         size = (uint32_t)(0xFFFFFFFFULL - offset);
         if (size == 0) {
-            mutex_unlock(&fs->fs_lock);
+            rwsem_write_unlock(&file->rwsem);
             return 0;
         }
         end_pos64 = (uint64_t)offset + (uint64_t)size;
@@ -1525,32 +1996,32 @@ static uint32_t fat32_file_write(fs_node_t *node, uint32_t offset, uint32_t size
 
     if (requested_end > original_size) {
         if (fat32_ensure_file_size(file, requested_end) != 0) {
-            mutex_unlock(&fs->fs_lock);
+            rwsem_write_unlock(&file->rwsem);
             return 0;
         }
     } else if (file->start_cluster < 2 && requested_end > 0) {
         if (fat32_ensure_file_size(file, requested_end) != 0) {
-            mutex_unlock(&fs->fs_lock);
+            rwsem_write_unlock(&file->rwsem);
             return 0;
         }
     }
 
     if (file->start_cluster < 2 && requested_end > 0) {
-        mutex_unlock(&fs->fs_lock);
+        rwsem_write_unlock(&file->rwsem);
         return 0;
     }
 
     if (offset > original_size) {
         if (fat32_zero_range(file, original_size, offset) != 0) {
             // 尝试保持文件大小一致
-            mutex_unlock(&fs->fs_lock);
+            rwsem_write_unlock(&file->rwsem);
             return 0;
         }
     }
 
     uint8_t *cluster_buffer = (uint8_t *)kmalloc(cluster_size);
     if (!cluster_buffer) {
-        mutex_unlock(&fs->fs_lock);
+        rwsem_write_unlock(&file->rwsem);
         return 0;
     }
 
@@ -1577,7 +2048,7 @@ static uint32_t fat32_file_write(fs_node_t *node, uint32_t offset, uint32_t size
 
         memcpy(cluster_buffer + cluster_offset, buffer + bytes_written, to_write);
 
-        if (blockdev_write(fs->dev,
+        if (fat32_write_sectors(fs,
                            fat32_cluster_to_sector(fs, cluster),
                            fs->bpb.sectors_per_cluster,
                            cluster_buffer) != 0) {
@@ -1598,15 +2069,11 @@ static uint32_t fat32_file_write(fs_node_t *node, uint32_t offset, uint32_t size
         file->size = original_size;
     }
 
-    if (file->start_cluster >= 2) {
-        node->inode = file->start_cluster;
-    }
-
     node->size = file->size;
 
     fat32_update_dirent_metadata(file);
 
-    mutex_unlock(&fs->fs_lock);
+    rwsem_write_unlock(&file->rwsem);
     return bytes_written;
 }
 
@@ -1621,12 +2088,12 @@ static struct dirent *fat32_dir_readdir(fs_node_t *node, uint32_t index) {
     
     fat32_fs_t *fs = file->fs;
     
-    // 获取文件系统锁
-    mutex_lock(&fs->fs_lock);
+    // readdir_cache 属于节点，持写锁防止并发的 readdir 覆盖结果
+    rwsem_write_lock(&file->rwsem);
     
     uint8_t *cluster_buffer = (uint8_t *)kmalloc(fs->bytes_per_cluster);
     if (!cluster_buffer) {
-        mutex_unlock(&fs->fs_lock);
+        rwsem_write_unlock(&file->rwsem);
         return NULL;
     }
     
@@ -1659,8 +2126,7 @@ static struct dirent *fat32_dir_readdir(fs_node_t *node, uint32_t index) {
                 strncpy(result->d_name, formatted_name, sizeof(result->d_name) - 1);
                 result->d_name[sizeof(result->d_name) - 1] = '\0';
                 
-                uint32_t cluster = ((uint32_t)fat_dirent->cluster_high << 16) | fat_dirent->cluster_low;
-                result->d_ino = cluster;  // 使用簇号作为 inode
+                result->d_ino = fat32_dirent_ino(fs, current_cluster, i * sizeof(fat32_dirent_t));
                 result->d_reclen = sizeof(struct dirent);
                 result->d_off = index + 1;
                 
@@ -1671,7 +2137,7 @@ static struct dirent *fat32_dir_readdir(fs_node_t *node, uint32_t index) {
                 }
                 
                 kfree(cluster_buffer);
-                mutex_unlock(&fs->fs_lock);
+                rwsem_write_unlock(&file->rwsem);
                 return result;
             }
             
@@ -1688,12 +2154,101 @@ static struct dirent *fat32_dir_readdir(fs_node_t *node, uint32_t index) {
     }
     
     kfree(cluster_buffer);
-    mutex_unlock(&fs->fs_lock);
+    rwsem_write_unlock(&file->rwsem);
     return NULL;
 }
 
+/**
+ * FAT32 目录迭代
+ *
+ * 游标记录下一个目录项所在的簇和簇内偏移，每次调用从那里继续，
+ * 目录的每个簇只读一次（readdir 按索引查找时每一项都要从第一个簇扫起）。
+ * 游标位置在目录被修改后仍然有效：删除的项被跳过，新项出现在空槽中。
+ */
+static int fat32_dir_iterate(fs_node_t *node, dir_cursor_t *cursor, filldir_t fill, void *ctx) {
+    fat32_file_t *file = (fat32_file_t *)node->impl;
+    if (!file || !file->is_dir) {
+        return -1;
+    }
+    
+    fat32_fs_t *fs = file->fs;
+    
+    rwsem_read_lock(&file->rwsem);
+    
+    uint8_t *cluster_buffer = (uint8_t *)kmalloc(fs->bytes_per_cluster);
+    if (!cluster_buffer) {
+        rwsem_read_unlock(&file->rwsem);
+        return -1;
+    }
+    
+    // 游标 pos 为 0 且已读过目录项表示已到末尾
+    uint32_t cluster = cursor->index ? (uint32_t)cursor->pos : file->start_cluster;
+    uint32_t offset = cursor->index ? cursor->cookie : 0;
+    uint32_t chain_length = 0;
+    bool stopped = false;
+    int ret = 0;
+    
+    while (cluster >= 2 && cluster < FAT32_CLUSTER_EOF_MIN && chain_length < fs->total_clusters) {
+        if (fat32_read_cluster(fs, cluster, cluster_buffer) != 0) {
+            ret = -1;
+            break;
+        }
+        
+        for (; offset < fs->bytes_per_cluster; offset += sizeof(fat32_dirent_t)) {
+            fat32_dirent_t *fat_dirent = (fat32_dirent_t *)(cluster_buffer + offset);
+            if (!fat32_is_valid_dirent(fat_dirent)) {
+                continue;
+            }
+            
+            char formatted_name[13];
+            fat32_format_filename(fat_dirent->name, formatted_name);
+            uint8_t type = (fat_dirent->attributes & FAT32_ATTR_DIRECTORY) ? DT_DIR : DT_REG;
+            
+            if (fill(ctx, formatted_name, fat32_dirent_ino(fs, cluster, offset), type) != 0) {
+                stopped = true;
+                break;
+            }
+            cursor->index++;
+        }
+        if (stopped) {
+            break;
+        }
+        
+        // 下一个簇
+        offset = 0;
+        uint32_t next = fat32_read_fat_entry(fs, cluster);
+        cluster = (next == 0xFFFFFFFF || next >= FAT32_CLUSTER_EOF_MIN) ? 0 : next;
+        chain_length++;
+    }
+    
+    cursor->pos = cluster;
+    cursor->cookie = offset;
+    
+    kfree(cluster_buffer);
+    rwsem_read_unlock(&file->rwsem);
+    return ret;
+}
+
+/**
+ * 检查 inode 缓存中的节点是否仍对应这个目录项
+ * （目录项被删除后槽位可能被新文件复用，编号相同但文件不同）
+ */
+static bool fat32_cached_node_matches(fs_node_t *node, fat32_dir_lookup_t *lookup, const char *name) {
+    fat32_file_t *file = (fat32_file_t *)node->impl;
+    uint32_t cluster = ((uint32_t)lookup->entry.cluster_high << 16) | lookup->entry.cluster_low;
+    
+    return file &&
+           file->dirent_cluster == lookup->cluster &&
+           file->dirent_offset == lookup->offset &&
+           (file->start_cluster == cluster || cluster == 0) &&
+           strcasecmp(node->name, name) == 0;
+}
+
 /**
  * FAT32 目录查找
+ *
+ * 同一文件的多次查找返回同一个节点（经 inode 缓存），
+ * 文件的簇链和大小在所有打开者之间保持一致。
  */
 static fs_node_t *fat32_dir_finddir(fs_node_t *node, const char *name) {
     fat32_file_t *file = (fat32_file_t *)node->impl;
@@ -1703,21 +2258,34 @@ static fs_node_t *fat32_dir_finddir(fs_node_t *node, const char *name) {
     
     fat32_fs_t *fs = file->fs;
     
-    // 获取文件系统锁
-    mutex_lock(&fs->fs_lock);
+    // 目录读锁：同一目录上的查找可以并发，inode 缓存自行处理重复加入
+    rwsem_read_lock(&file->rwsem);
     
     // 查找目录项
     fat32_dir_lookup_t *lookup = fat32_find_file_in_dir(fs, file->start_cluster, name);
     if (!lookup) {
-        mutex_unlock(&fs->fs_lock);
+        rwsem_read_unlock(&file->rwsem);
         return NULL;
     }
     
+    uint32_t ino = fat32_dirent_ino(fs, lookup->cluster, lookup->offset);
+    fs_node_t *cached = vfs_icache_get(fs, ino);
+    if (cached) {
+        if (fat32_cached_node_matches(cached, lookup, name)) {
+            kfree(lookup);
+            rwsem_read_unlock(&file->rwsem);
+            return cached;
+        }
+        // 过期节点：仍被旧的打开者持有，新查找不再共享它
+        vfs_icache_remove(cached);
+        vfs_release_node(cached);
+    }
+    
     // 创建文件节点
     fs_node_t *new_node = (fs_node_t *)kmalloc(sizeof(fs_node_t));
     if (!new_node) {
         kfree(lookup);
-        mutex_unlock(&fs->fs_lock);
+        rwsem_read_unlock(&file->rwsem);
         return NULL;
     }
     
@@ -1725,7 +2293,7 @@ static fs_node_t *fat32_dir_finddir(fs_node_t *node, const char *name) {
     if (!new_file) {
         kfree(new_node);
         kfree(lookup);
-        mutex_unlock(&fs->fs_lock);
+        rwsem_read_unlock(&file->rwsem);
         return NULL;
     }
     
@@ -1735,7 +2303,8 @@ static fs_node_t *fat32_dir_finddir(fs_node_t *node, const char *name) {
     strncpy(new_node->name, name, sizeof(new_node->name) - 1);
     
     uint32_t cluster = ((uint32_t)lookup->entry.cluster_high << 16) | lookup->entry.cluster_low;
-    new_node->inode = cluster;
+    new_node->inode = ino;
+    new_node->sb = fs;
     new_node->size = lookup->entry.file_size;
     new_node->permissions = FS_PERM_READ | FS_PERM_WRITE;
     new_node->flags = FS_NODE_FLAG_ALLOCATED;  // 标记为动态分配的节点
@@ -1743,19 +2312,13 @@ static fs_node_t *fat32_dir_finddir(fs_node_t *node, const char *name) {
     
     if (lookup->entry.attributes & FAT32_ATTR_DIRECTORY) {
         new_node->type = FS_DIRECTORY;
-        new_node->readdir = fat32_dir_readdir;
-        new_node->finddir = fat32_dir_finddir;
-        new_node->create = fat32_dir_create;
-        new_node->mkdir = fat32_dir_mkdir;
-        new_node->unlink = fat32_dir_unlink;
-        new_node->rename = fat32_dir_rename;
+        new_node->ops = &fat32_dir_ops;
         new_node->permissions = FS_PERM_READ | FS_PERM_WRITE | FS_PERM_EXEC;
+        new_node->flags |= FS_NODE_FLAG_DCACHE | FS_NODE_FLAG_ICASE;
         new_file->is_dir = true;
     } else {
         new_node->type = FS_FILE;
-        new_node->read = fat32_file_read;
-        new_node->write = fat32_file_write;
-        new_node->truncate = fat32_file_truncate;
+        new_node->ops = &fat32_file_ops;
         new_file->is_dir = false;
     }
     
@@ -1765,11 +2328,12 @@ static fs_node_t *fat32_dir_finddir(fs_node_t *node, const char *name) {
     new_file->dirent_cluster = lookup->cluster;
     new_file->dirent_offset = lookup->offset;
     new_file->parent_cluster = file->start_cluster;
+    rwsem_init_named(&new_file->rwsem, "fat32_file");
     new_node->impl = new_file;
     
     kfree(lookup);
-    mutex_unlock(&fs->fs_lock);
-    return new_node;
+    rwsem_read_unlock(&file->rwsem);
+    return vfs_icache_add(new_node);
 }
 
 // ============================================================================
@@ -1825,7 +2389,9 @@ fs_node_t *fat32_init(blockdev_t *dev) {
     }
     
     memset(fs, 0, sizeof(fat32_fs_t));
-    mutex_init(&fs->fs_lock);  // 初始化文件系统锁
+    mutex_init_named(&fs->fs_lock, "fat32_dir");  // 初始化文件系统锁
+    mutex_init_named(&fs->alloc_lock, "fat32_alloc");
+    mutex_init_named(&fs->fat_cache_lock, "fat32_fat_cache");
     fs->dev = blockdev_retain(dev);  // 保留设备引用，防止被销毁
     
     if (blockdev_read(dev, 0, 1, (uint8_t *)&fs->bpb) != 0) {
@@ -1915,6 +2481,11 @@ fs_node_t *fat32_init(blockdev_t *dev) {
         return NULL;
     }
     
+    // FAT 扇区缓存和预读缓存都是可选的，分配失败时退回直接读取
+    fs->fat_cache = (uint8_t *)kmalloc(fs->bpb.bytes_per_sector);
+    fs->fat_cache_sector = 0xFFFFFFFF;
+    fat32_ra_init(fs);
+
     memset(root, 0, sizeof(fs_node_t));
     memset(root_file, 0, sizeof(fat32_file_t));
     strcpy(root->name, "/");
@@ -1923,12 +2494,8 @@ fs_node_t *fat32_init(blockdev_t *dev) {
     root->size = 0;
     root->permissions = FS_PERM_READ | FS_PERM_WRITE | FS_PERM_EXEC;
     root->ref_count = 0;  // 初始化引用计数
-    root->readdir = fat32_dir_readdir;
-    root->finddir = fat32_dir_finddir;
-    root->create = fat32_dir_create;
-    root->mkdir = fat32_dir_mkdir;
-    root->unlink = fat32_dir_unlink;
-    root->rename = fat32_dir_rename;
+    root->flags = FS_NODE_FLAG_DCACHE | FS_NODE_FLAG_ICASE;  // 目录内容只经 VFS 修改，名字不区分大小写
+    root->ops = &fat32_dir_ops;
     
     root_file->fs = fs;
     root_file->start_cluster = fs->root_cluster;
@@ -1937,6 +2504,7 @@ fs_node_t *fat32_init(blockdev_t *dev) {
     root_file->dirent_cluster = 0;
     root_file->dirent_offset = 0;
     root_file->parent_cluster = 0;
+    rwsem_init_named(&root_file->rwsem, "fat32_file");
     root->impl = root_file;
     
     LOG_INFO_MSG("fat32: Root directory created\n");
@@ -1964,6 +2532,9 @@ void fat32_deinit(fs_node_t *root) {
     
     LOG_INFO_MSG("fat32: Unmounting filesystem...\n");
     
+    // 等待在途的预读后释放预读缓存
+    fat32_ra_destroy(fs);
+
     // 释放设备引用
     if (fs->dev) {
         blockdev_release(fs->dev);
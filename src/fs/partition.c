@@ -65,6 +65,19 @@ static int partition_blockdev_write(void *dev, uint32_t sector, uint32_t count,
     return blockdev_write(part->parent_dev, (uint32_t)parent_sector, count, buffer);
 }
 
+// 分区块设备的 bio 转发：分区没有自己的队列，bio 进入父设备队列参与合并
+static blockdev_t *partition_blockdev_remap(void *dev, uint32_t *sector) {
+    partition_blockdev_data_t *data = (partition_blockdev_data_t *)dev;
+    partition_t *part = data->partition;
+
+    uint64_t parent_sector = part->start_lba + *sector;
+    if (parent_sector > UINT32_MAX) {
+        return NULL;
+    }
+    *sector = (uint32_t)parent_sector;
+    return part->parent_dev;
+}
+
 // 分区块设备的大小查询函数
 static uint32_t partition_blockdev_get_size(void *dev) {
     partition_blockdev_data_t *data = (partition_blockdev_data_t *)dev;
@@ -326,6 +339,7 @@ blockdev_t *partition_create_blockdev(partition_t *part) {
     dev->write = partition_blockdev_write;
     dev->get_size = partition_blockdev_get_size;
     dev->get_block_size = partition_blockdev_get_block_size;
+    dev->remap = partition_blockdev_remap;
     
     if (blockdev_register(dev) != 0) {
         kfree(data);
@@ -9,7 +9,9 @@
  */
 
 #include <fs/pipe.h>
+#include <fs/poll.h>
 #include <mm/heap.h>
+#include <mm/pmm.h>
 #include <lib/string.h>
 #include <lib/klog.h>
 
@@ -17,10 +19,119 @@
 static uint32_t pipe_read(fs_node_t *node, uint32_t offset, uint32_t size, uint8_t *buffer);
 static uint32_t pipe_write(fs_node_t *node, uint32_t offset, uint32_t size, uint8_t *buffer);
 static void pipe_close(fs_node_t *node);
+static uint32_t pipe_poll(fs_node_t *node, poll_table_t *pt);
+
+/* 读端只能读，写端只能写 */
+static const fs_node_ops_t pipe_read_ops = {
+    .read = pipe_read,
+    .close = pipe_close,
+    .poll = pipe_poll,
+};
+
+static const fs_node_ops_t pipe_write_ops = {
+    .write = pipe_write,
+    .close = pipe_close,
+    .poll = pipe_poll,
+};
 
 /* 全局 inode 计数器 */
 static uint32_t pipe_inode_counter = 0x10000;  // 从高位开始，避免与其他文件系统冲突
 
+/**
+ * 分配管道缓冲区（连续物理页，经直接映射访问）
+ * @param size 缓冲区大小（页大小的整数倍）
+ */
+static uint8_t *pipe_buffer_alloc(uint32_t size, paddr_t *phys_out) {
+    paddr_t phys = pmm_alloc_frames_zone(size / PAGE_SIZE, ZONE_NORMAL);
+    if (phys == PADDR_INVALID) {
+        return NULL;
+    }
+    *phys_out = phys;
+    return (uint8_t *)PHYS_TO_VIRT((uintptr_t)phys);
+}
+
+static void pipe_buffer_free(pipe_t *pipe) {
+    if (pipe->buffer) {
+        pmm_free_frames(pipe->buffer_phys, pipe->size / PAGE_SIZE);
+        pipe->buffer = NULL;
+    }
+}
+
+/**
+ * 从环形缓冲区取出数据（调用者持有 pipe->lock）
+ * 回绕时最多拆成两次 memcpy
+ */
+static void pipe_copy_out(pipe_t *pipe, uint8_t *dst, uint32_t len) {
+    uint32_t first = pipe->size - pipe->read_pos;
+    if (first > len) {
+        first = len;
+    }
+    memcpy(dst, pipe->buffer + pipe->read_pos, first);
+    if (len > first) {
+        memcpy(dst + first, pipe->buffer, len - first);
+    }
+    pipe->read_pos = (pipe->read_pos + len) & (pipe->size - 1);
+    pipe->count -= len;
+}
+
+/* 读者等待条件：有数据或写端全部关闭 */
+static bool pipe_readable(void *arg) {
+    pipe_t *pipe = (pipe_t *)arg;
+    return pipe->count > 0 || pipe->write_closed;
+}
+
+/* 写者等待条件：有空间或读端全部关闭 */
+static bool pipe_writable(void *arg) {
+    pipe_t *pipe = (pipe_t *)arg;
+    return pipe->count < pipe->size || pipe->read_closed;
+}
+
+/**
+ * 等待数据可读（进入和返回时都持有 pipe->lock）
+ * @return true 有数据，false 写端已关闭且没有数据（EOF）
+ */
+static bool pipe_wait_data(pipe_t *pipe) {
+    while (pipe->count == 0) {
+        if (pipe->write_closed) {
+            return false;
+        }
+        // 释放锁后睡眠，等待队列在关中断下复查条件，不会丢失唤醒
+        mutex_unlock(&pipe->lock);
+        wait_queue_wait(&pipe->read_wait, pipe_readable, pipe, WAIT_FOREVER);
+        mutex_lock(&pipe->lock);
+    }
+    return true;
+}
+
+/**
+ * 等待空间可写（进入和返回时都持有 pipe->lock）
+ * @return true 有空间，false 读端已关闭
+ */
+static bool pipe_wait_space(pipe_t *pipe) {
+    while (pipe->count == pipe->size && !pipe->read_closed) {
+        mutex_unlock(&pipe->lock);
+        wait_queue_wait(&pipe->write_wait, pipe_writable, pipe, WAIT_FOREVER);
+        mutex_lock(&pipe->lock);
+    }
+    return !pipe->read_closed;
+}
+
+/* 复制到调用者缓冲区（ctx 为游标） */
+static uint32_t pipe_actor_copy_to(void *ctx, uint8_t *data, uint32_t len) {
+    uint8_t **cursor = (uint8_t **)ctx;
+    memcpy(*cursor, data, len);
+    *cursor += len;
+    return len;
+}
+
+/* 从调用者缓冲区复制（ctx 为游标） */
+static uint32_t pipe_actor_copy_from(void *ctx, uint8_t *data, uint32_t len) {
+    uint8_t **cursor = (uint8_t **)ctx;
+    memcpy(data, *cursor, len);
+    *cursor += len;
+    return len;
+}
+
 /**
  * 初始化管道子系统
  */
@@ -73,7 +184,13 @@ int pipe_create(fs_node_t **read_node, fs_node_t **write_node) {
     }
     
     // 初始化管道
-    memset(pipe->buffer, 0, PIPE_BUFFER_SIZE);
+    pipe->size = PIPE_DEFAULT_SIZE;
+    pipe->buffer = pipe_buffer_alloc(pipe->size, &pipe->buffer_phys);
+    if (!pipe->buffer) {
+        LOG_ERROR_MSG("pipe_create: failed to allocate pipe buffer\n");
+        kfree(pipe);
+        return -1;
+    }
     pipe->read_pos = 0;
     pipe->write_pos = 0;
     pipe->count = 0;
@@ -83,9 +200,10 @@ int pipe_create(fs_node_t **read_node, fs_node_t **write_node) {
     pipe->write_closed = false;
     
     // 初始化同步原语
-    mutex_init(&pipe->lock);
-    semaphore_init(&pipe->read_sem, 0);              // 初始无数据可读
-    semaphore_init(&pipe->write_sem, PIPE_BUFFER_SIZE);  // 初始全部空间可写
+    mutex_init_named(&pipe->lock, "pipe");
+    wait_queue_init(&pipe->read_wait);
+    wait_queue_init(&pipe->write_wait);
+    wait_queue_init(&pipe->poll_wait);
     
     // 分配 inode 号
     uint32_t inode = pipe_inode_counter++;
@@ -94,6 +212,7 @@ int pipe_create(fs_node_t **read_node, fs_node_t **write_node) {
     fs_node_t *rnode = kmalloc(sizeof(fs_node_t));
     if (!rnode) {
         LOG_ERROR_MSG("pipe_create: failed to allocate read node\n");
+        pipe_buffer_free(pipe);
         kfree(pipe);
         return -1;
     }
@@ -111,17 +230,7 @@ int pipe_create(fs_node_t **read_node, fs_node_t **write_node) {
     rnode->flags = FS_NODE_FLAG_ALLOCATED;
     rnode->ref_count = 1;
     
-    // 设置读端操作函数
-    rnode->read = pipe_read;
-    rnode->write = NULL;            // 读端不能写
-    rnode->open = NULL;
-    rnode->close = pipe_close;
-    rnode->readdir = NULL;
-    rnode->finddir = NULL;
-    rnode->create = NULL;
-    rnode->mkdir = NULL;
-    rnode->unlink = NULL;
-    rnode->truncate = NULL;
+    rnode->ops = &pipe_read_ops;
     rnode->ptr = NULL;
     
     // 创建写端节点
@@ -129,6 +238,7 @@ int pipe_create(fs_node_t **read_node, fs_node_t **write_node) {
     if (!wnode) {
         LOG_ERROR_MSG("pipe_create: failed to allocate write node\n");
         kfree(rnode);
+        pipe_buffer_free(pipe);
         kfree(pipe);
         return -1;
     }
@@ -146,17 +256,7 @@ int pipe_create(fs_node_t **read_node, fs_node_t **write_node) {
     wnode->flags = FS_NODE_FLAG_ALLOCATED;
     wnode->ref_count = 1;
     
-    // 设置写端操作函数
-    wnode->read = NULL;             // 写端不能读
-    wnode->write = pipe_write;
-    wnode->open = NULL;
-    wnode->close = pipe_close;
-    wnode->readdir = NULL;
-    wnode->finddir = NULL;
-    wnode->create = NULL;
-    wnode->mkdir = NULL;
-    wnode->unlink = NULL;
-    wnode->truncate = NULL;
+    wnode->ops = &pipe_write_ops;
     wnode->ptr = NULL;
     
     *read_node = rnode;
@@ -170,7 +270,8 @@ int pipe_create(fs_node_t **read_node, fs_node_t **write_node) {
 /**
  * 管道读取
  * 
- * 阻塞直到有数据可读，或者写端关闭
+ * 阻塞直到有数据可读，或者写端关闭。
+ * 一次取走尽可能多的数据，只在取走后唤醒一次写者。
  */
 static uint32_t pipe_read(fs_node_t *node, uint32_t offset, uint32_t size, uint8_t *buffer) {
     (void)offset;  // 管道不支持 offset
@@ -179,67 +280,8 @@ static uint32_t pipe_read(fs_node_t *node, uint32_t offset, uint32_t size, uint8
         return 0;
     }
     
-    pipe_t *pipe = (pipe_t *)node->impl;
-    if (!pipe) {
-        LOG_ERROR_MSG("pipe_read: pipe is NULL\n");
-        return 0;
-    }
-    
-    uint32_t bytes_read = 0;
-    
-    while (bytes_read < size) {
-        // 等待数据可用
-        mutex_lock(&pipe->lock);
-        
-        while (pipe->count == 0) {
-            // 如果写端已关闭且没有数据，返回 EOF
-            if (pipe->write_closed) {
-                mutex_unlock(&pipe->lock);
-                LOG_DEBUG_MSG("pipe_read: EOF (write_closed), read %u bytes\n", bytes_read);
-                return bytes_read;
-            }
-            
-            // 释放锁，等待数据
-            mutex_unlock(&pipe->lock);
-            
-            // 等待读信号量（有数据可读）
-            semaphore_wait(&pipe->read_sem);
-            
-            // 重新获取锁
-            mutex_lock(&pipe->lock);
-            
-            // 再次检查写端是否关闭（可能在等待期间被关闭）
-            if (pipe->count == 0 && pipe->write_closed) {
-                mutex_unlock(&pipe->lock);
-                return bytes_read;
-            }
-        }
-        
-        // 计算本次可读取的数据量
-        uint32_t to_read = size - bytes_read;
-        if (to_read > pipe->count) {
-            to_read = pipe->count;
-        }
-        
-        // 读取数据（处理环形缓冲区回绕）
-        for (uint32_t i = 0; i < to_read; i++) {
-            buffer[bytes_read + i] = pipe->buffer[pipe->read_pos];
-            pipe->read_pos = (pipe->read_pos + 1) % PIPE_BUFFER_SIZE;
-            pipe->count--;
-            
-            // 通知写端有空间可用
-            semaphore_signal(&pipe->write_sem);
-        }
-        
-        bytes_read += to_read;
-        
-        mutex_unlock(&pipe->lock);
-        
-        // 如果已读取到数据，可以返回（不必填满整个缓冲区）
-        if (bytes_read > 0) {
-            break;
-        }
-    }
+    uint8_t *cursor = buffer;
+    uint32_t bytes_read = pipe_splice_out(node, size, pipe_actor_copy_to, &cursor);
     
     LOG_DEBUG_MSG("pipe_read: read %u bytes\n", bytes_read);
     return bytes_read;
@@ -248,7 +290,8 @@ static uint32_t pipe_read(fs_node_t *node, uint32_t offset, uint32_t size, uint8
 /**
  * 管道写入
  * 
- * 阻塞直到有空间可写，或者读端关闭
+ * 阻塞直到全部写入，或者读端关闭。
+ * 每次填满可用空间后唤醒一次读者。
  */
 static uint32_t pipe_write(fs_node_t *node, uint32_t offset, uint32_t size, uint8_t *buffer) {
     (void)offset;  // 管道不支持 offset
@@ -263,70 +306,196 @@ static uint32_t pipe_write(fs_node_t *node, uint32_t offset, uint32_t size, uint
         return 0;
     }
     
-    uint32_t bytes_written = 0;
-    
     // 检查读端是否已关闭
-    mutex_lock(&pipe->lock);
     if (pipe->read_closed) {
-        mutex_unlock(&pipe->lock);
         LOG_WARN_MSG("pipe_write: broken pipe (read_closed)\n");
         // 实际应该发送 SIGPIPE 信号
         return 0;
     }
-    mutex_unlock(&pipe->lock);
     
+    uint8_t *cursor = buffer;
+    uint32_t bytes_written = 0;
     while (bytes_written < size) {
-        // 等待空间可用
-        mutex_lock(&pipe->lock);
-        
-        while (pipe->count == PIPE_BUFFER_SIZE) {
-            // 如果读端已关闭，返回错误
-            if (pipe->read_closed) {
-                mutex_unlock(&pipe->lock);
-                LOG_WARN_MSG("pipe_write: broken pipe during write\n");
-                return bytes_written;
-            }
-            
-            // 释放锁，等待空间
-            mutex_unlock(&pipe->lock);
-            
-            // 等待写信号量（有空间可写）
-            semaphore_wait(&pipe->write_sem);
-            
-            // 重新获取锁
-            mutex_lock(&pipe->lock);
-            
-            // 再次检查读端是否关闭
-            if (pipe->read_closed) {
-                mutex_unlock(&pipe->lock);
-                return bytes_written;
-            }
+        uint32_t n = pipe_splice_in(node, size - bytes_written, pipe_actor_copy_from, &cursor);
+        if (n == 0) {
+            LOG_WARN_MSG("pipe_write: broken pipe during write\n");
+            break;
         }
-        
-        // 计算本次可写入的数据量
-        uint32_t to_write = size - bytes_written;
-        uint32_t space_available = PIPE_BUFFER_SIZE - pipe->count;
-        if (to_write > space_available) {
-            to_write = space_available;
+        bytes_written += n;
+    }
+    
+    LOG_DEBUG_MSG("pipe_write: wrote %u bytes\n", bytes_written);
+    return bytes_written;
+}
+
+/**
+ * 从管道取出数据交给 actor
+ * 
+ * 数据在环形缓冲区中原地交给 actor，回绕时最多调用两次。
+ */
+uint32_t pipe_splice_out(fs_node_t *node, uint32_t len, pipe_actor_t actor, void *ctx) {
+    if (!node || node->type != FS_PIPE || !actor || len == 0) {
+        return 0;
+    }
+    
+    pipe_t *pipe = (pipe_t *)node->impl;
+    if (!pipe) {
+        LOG_ERROR_MSG("pipe_splice_out: pipe is NULL\n");
+        return 0;
+    }
+    
+    mutex_lock(&pipe->lock);
+    
+    if (!pipe_wait_data(pipe)) {
+        mutex_unlock(&pipe->lock);
+        LOG_DEBUG_MSG("pipe_splice_out: EOF (write_closed)\n");
+        return 0;
+    }
+    
+    // 有多少取多少，不等待凑满 len
+    uint32_t avail = (len < pipe->count) ? len : pipe->count;
+    uint32_t total = 0;
+    while (total < avail) {
+        uint32_t seg = pipe->size - pipe->read_pos;
+        if (seg > avail - total) {
+            seg = avail - total;
         }
         
-        // 写入数据（处理环形缓冲区回绕）
-        for (uint32_t i = 0; i < to_write; i++) {
-            pipe->buffer[pipe->write_pos] = buffer[bytes_written + i];
-            pipe->write_pos = (pipe->write_pos + 1) % PIPE_BUFFER_SIZE;
-            pipe->count++;
-            
-            // 通知读端有数据可读
-            semaphore_signal(&pipe->read_sem);
+        uint32_t n = actor(ctx, pipe->buffer + pipe->read_pos, seg);
+        pipe->read_pos = (pipe->read_pos + n) & (pipe->size - 1);
+        pipe->count -= n;
+        total += n;
+        if (n < seg) {
+            break;
+        }
+    }
+    
+    mutex_unlock(&pipe->lock);
+    
+    // 通知写端有空间可用
+    if (total > 0) {
+        wait_queue_wake(&pipe->write_wait, POLLOUT);
+        wait_queue_wake(&pipe->poll_wait, POLLOUT);
+    }
+    
+    return total;
+}
+
+/**
+ * 让 actor 直接向管道的空闲空间填充数据
+ */
+uint32_t pipe_splice_in(fs_node_t *node, uint32_t len, pipe_actor_t actor, void *ctx) {
+    if (!node || node->type != FS_PIPE || !actor || len == 0) {
+        return 0;
+    }
+    
+    pipe_t *pipe = (pipe_t *)node->impl;
+    if (!pipe) {
+        LOG_ERROR_MSG("pipe_splice_in: pipe is NULL\n");
+        return 0;
+    }
+    
+    mutex_lock(&pipe->lock);
+    
+    if (!pipe_wait_space(pipe)) {
+        mutex_unlock(&pipe->lock);
+        return 0;
+    }
+    
+    uint32_t space = pipe->size - pipe->count;
+    if (space > len) {
+        space = len;
+    }
+    
+    uint32_t total = 0;
+    while (total < space) {
+        uint32_t seg = pipe->size - pipe->write_pos;
+        if (seg > space - total) {
+            seg = space - total;
         }
         
-        bytes_written += to_write;
-        
+        uint32_t n = actor(ctx, pipe->buffer + pipe->write_pos, seg);
+        pipe->write_pos = (pipe->write_pos + n) & (pipe->size - 1);
+        pipe->count += n;
+        total += n;
+        if (n < seg) {
+            break;
+        }
+    }
+    
+    mutex_unlock(&pipe->lock);
+    
+    // 通知读端有数据可读
+    if (total > 0) {
+        wait_queue_wake(&pipe->read_wait, POLLIN);
+        wait_queue_wake(&pipe->poll_wait, POLLIN);
+    }
+    
+    return total;
+}
+
+/**
+ * 调整管道缓冲区大小
+ */
+int pipe_set_size(fs_node_t *node, uint32_t size) {
+    if (!node || node->type != FS_PIPE || !node->impl) {
+        return -1;
+    }
+    if (size == 0 || size > PIPE_MAX_SIZE) {
+        return -1;
+    }
+    
+    // 向上取整到 2 的幂（环形下标用掩码回绕）
+    uint32_t new_size = PIPE_MIN_SIZE;
+    while (new_size < size) {
+        new_size <<= 1;
+    }
+    
+    pipe_t *pipe = (pipe_t *)node->impl;
+    
+    paddr_t new_phys;
+    uint8_t *new_buffer = pipe_buffer_alloc(new_size, &new_phys);
+    if (!new_buffer) {
+        LOG_WARN_MSG("pipe_set_size: out of memory for %u bytes\n", new_size);
+        return -1;
+    }
+    
+    mutex_lock(&pipe->lock);
+    
+    if (new_size == pipe->size || pipe->count > new_size) {
+        bool same = (new_size == pipe->size);
         mutex_unlock(&pipe->lock);
+        pmm_free_frames(new_phys, new_size / PAGE_SIZE);
+        return same ? (int)new_size : -1;
     }
     
-    LOG_DEBUG_MSG("pipe_write: wrote %u bytes\n", bytes_written);
-    return bytes_written;
+    // 把现有数据搬到新缓冲区开头
+    uint32_t count = pipe->count;
+    pipe_copy_out(pipe, new_buffer, count);
+    pipe_buffer_free(pipe);
+    
+    pipe->buffer = new_buffer;
+    pipe->buffer_phys = new_phys;
+    pipe->size = new_size;
+    pipe->read_pos = 0;
+    pipe->write_pos = count & (new_size - 1);
+    pipe->count = count;
+    
+    mutex_unlock(&pipe->lock);
+    
+    // 扩容后可能有了空间
+    wait_queue_wake(&pipe->write_wait, POLLOUT);
+    wait_queue_wake(&pipe->poll_wait, POLLOUT);
+    
+    LOG_DEBUG_MSG("pipe_set_size: inode %u resized to %u bytes\n", node->inode, new_size);
+    return (int)new_size;
+}
+
+int pipe_get_size(fs_node_t *node) {
+    if (!node || node->type != FS_PIPE || !node->impl) {
+        return -1;
+    }
+    return (int)((pipe_t *)node->impl)->size;
 }
 
 /**
@@ -358,11 +527,6 @@ static void pipe_close(fs_node_t *node) {
         
         if (pipe->writers == 0) {
             pipe->write_closed = true;
-            // 唤醒所有等待读取的进程，让它们看到 EOF
-            // 发送多个信号确保所有等待的读者被唤醒
-            for (int i = 0; i < 10; i++) {
-                semaphore_signal(&pipe->read_sem);
-            }
         }
     } else {
         // 关闭读端
@@ -371,10 +535,6 @@ static void pipe_close(fs_node_t *node) {
         
         if (pipe->readers == 0) {
             pipe->read_closed = true;
-            // 唤醒所有等待写入的进程，让它们看到错误
-            for (int i = 0; i < 10; i++) {
-                semaphore_signal(&pipe->write_sem);
-            }
         }
     }
     
@@ -383,12 +543,60 @@ static void pipe_close(fs_node_t *node) {
     
     mutex_unlock(&pipe->lock);
     
+    // 唤醒所有等待者：读者看到 EOF，写者看到错误
+    if (is_write_end) {
+        wait_queue_wake(&pipe->read_wait, POLLHUP);
+    } else {
+        wait_queue_wake(&pipe->write_wait, POLLERR);
+    }
+    wait_queue_wake(&pipe->poll_wait, is_write_end ? POLLHUP : POLLERR);
+    
     // 如果两端都关闭，释放管道资源
     if (should_free) {
         LOG_DEBUG_MSG("pipe_close: freeing pipe\n");
+        wait_queue_detach_all(&pipe->poll_wait, POLLFREE);
         // 清除节点对管道的引用（仅在释放时）
         node->impl = NULL;
+        pipe_buffer_free(pipe);
         kfree(pipe);
     }
 }
 
+
+/**
+ * 查询管道就绪状态
+ * 
+ * 读端：有数据可读时 POLLIN，写端全部关闭后 POLLHUP
+ * 写端：有空闲空间时 POLLOUT，读端全部关闭后 POLLERR
+ */
+static uint32_t pipe_poll(fs_node_t *node, poll_table_t *pt) {
+    if (!node) {
+        return POLLNVAL;
+    }
+    
+    pipe_t *pipe = (pipe_t *)node->impl;
+    if (!pipe) {
+        return POLLHUP;
+    }
+    
+    poll_wait(pt, &pipe->poll_wait);
+    
+    uint32_t mask = 0;
+    if (node->impl_data == 1) {
+        if (pipe->count < pipe->size) {
+            mask |= POLLOUT;
+        }
+        if (pipe->read_closed) {
+            mask |= POLLERR;
+        }
+    } else {
+        if (pipe->count > 0) {
+            mask |= POLLIN;
+        }
+        if (pipe->write_closed) {
+            mask |= POLLHUP;
+        }
+    }
+    
+    return mask;
+}
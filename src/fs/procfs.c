@@ -4,8 +4,13 @@
 
 #include <fs/procfs.h>
 #include <fs/vfs.h>
+#include <fs/dcache.h>
+#include <fs/fat32.h>
 #include <kernel/task.h>
+#include <kernel/sync/lockstat.h>
+#include <kernel/sync/mutex.h>
 #include <drivers/pci.h>
+#include <drivers/serial.h>
 #include <drivers/usb/usb.h>
 #include <net/tcp.h>
 #include <net/udp.h>
@@ -20,6 +25,7 @@
 /* 前向声明 */
 static struct dirent *procfs_root_readdir(fs_node_t *node, uint32_t index);
 static fs_node_t *procfs_root_finddir(fs_node_t *node, const char *name);
+static int procfs_root_iterate(fs_node_t *node, dir_cursor_t *cursor, filldir_t fill, void *ctx);
 static struct dirent *procfs_pid_readdir(fs_node_t *node, uint32_t index);
 static fs_node_t *procfs_pid_finddir(fs_node_t *node, const char *name);
 static uint32_t procfs_status_read(fs_node_t *node, uint32_t offset, uint32_t size, uint8_t *buffer);
@@ -33,6 +39,33 @@ static fs_node_t *procfs_net_finddir(fs_node_t *node, const char *name);
 static uint32_t procfs_net_tcp_read(fs_node_t *node, uint32_t offset, uint32_t size, uint8_t *buffer);
 static uint32_t procfs_net_udp_read(fs_node_t *node, uint32_t offset, uint32_t size, uint8_t *buffer);
 static uint32_t procfs_net_route_read(fs_node_t *node, uint32_t offset, uint32_t size, uint8_t *buffer);
+static uint32_t procfs_stat_read(fs_node_t *node, uint32_t offset, uint32_t size, uint8_t *buffer);
+
+/* 操作表：procfs 只读，目录不支持创建/删除 */
+static const fs_node_ops_t procfs_root_ops = {
+    .readdir = procfs_root_readdir,
+    .finddir = procfs_root_finddir,
+    .iterate = procfs_root_iterate,
+};
+
+static const fs_node_ops_t procfs_pid_dir_ops = {
+    .readdir = procfs_pid_readdir,
+    .finddir = procfs_pid_finddir,
+};
+
+static const fs_node_ops_t procfs_net_dir_ops = {
+    .readdir = procfs_net_readdir,
+    .finddir = procfs_net_finddir,
+};
+
+static const fs_node_ops_t procfs_status_ops = { .read = procfs_status_read };
+static const fs_node_ops_t procfs_meminfo_ops = { .read = procfs_meminfo_read };
+static const fs_node_ops_t procfs_pci_ops = { .read = procfs_pci_read };
+static const fs_node_ops_t procfs_usb_ops = { .read = procfs_usb_read };
+static const fs_node_ops_t procfs_net_tcp_ops = { .read = procfs_net_tcp_read };
+static const fs_node_ops_t procfs_net_udp_ops = { .read = procfs_net_udp_read };
+static const fs_node_ops_t procfs_net_route_ops = { .read = procfs_net_route_read };
+static const fs_node_ops_t procfs_stat_ops = { .read = procfs_stat_read };
 
 /* ProcFS 私有数据结构 - 包含 readdir 缓冲区以避免静态变量 */
 typedef struct procfs_private {
@@ -53,6 +86,41 @@ static fs_node_t *procfs_net_tcp_file = NULL;
 static fs_node_t *procfs_net_udp_file = NULL;
 static fs_node_t *procfs_net_route_file = NULL;
 
+/* 统计信息文件：内容由各子系统的 dump 函数生成，位于 /proc 根目录 */
+typedef int (*procfs_dump_t)(char *buf, size_t size);
+
+typedef struct procfs_stat_file {
+    const char *name;
+    procfs_dump_t dump;
+    size_t buf_size;            // 内容上限，0 取 PROCFS_STAT_BUF_SIZE
+} procfs_stat_file_t;
+
+/*
+ * 统计信息文件的内容快照：偏移 0 处生成，后续偏移从这里读。
+ * 每次查找都创建新节点，快照挂在节点的 impl 上，因此每个打开的文件各有一份，
+ * 随节点释放
+ */
+typedef struct procfs_stat_snap {
+    uint32_t len;
+    char buf[];
+} procfs_stat_snap_t;
+
+static procfs_stat_file_t procfs_stat_files[] = {
+    { "dcache", dcache_dump, 0 },
+    { "icache", vfs_icache_dump, 0 },
+    { "lockstat", lockstat_dump, 0 },
+    { "readahead", fat32_readahead_dump, 0 },
+    { "serial", serial_stats_dump, 0 },
+    { "kmsg", klog_dump, KLOG_DUMP_BUF_SIZE },
+};
+
+#define PROCFS_STAT_FILE_COUNT  (sizeof(procfs_stat_files) / sizeof(procfs_stat_files[0]))
+
+/* 同一打开文件可能被多个任务（dup/fork）同时读，保护快照的生成与复制 */
+static mutex_t procfs_stat_lock;
+#define PROCFS_STAT_BUF_SIZE    4096
+#define PROCFS_ROOT_FIXED       6       // ., .., meminfo, pci, usb, net
+
 /* 注意：不再需要 procfs_lock，因为不再缓存节点 */
 static uint32_t procfs_meminfo_read(fs_node_t *node, uint32_t offset, uint32_t size, uint8_t *buffer) {
     (void)node;
@@ -506,6 +574,57 @@ static uint32_t procfs_net_route_read(fs_node_t *node, uint32_t offset, uint32_t
     return bytes_to_read;
 }
 
+/**
+ * 读取统计信息文件（impl_data 为 procfs_stat_files 下标，impl 为快照）
+ *
+ * 内容在偏移 0 处生成一次快照，之后的偏移都从这个打开文件的快照读取，
+ * 分块读取时不会因内容变化或其他读者而撕裂、重复或漏掉行
+ */
+static uint32_t procfs_stat_read(fs_node_t *node, uint32_t offset, uint32_t size, uint8_t *buffer) {
+    if (!buffer || size == 0 || node->impl_data >= PROCFS_STAT_FILE_COUNT) {
+        return 0;
+    }
+    
+    procfs_stat_file_t *file = &procfs_stat_files[node->impl_data];
+    size_t buf_size = file->buf_size ? file->buf_size : PROCFS_STAT_BUF_SIZE;
+    
+    mutex_lock(&procfs_stat_lock);
+    
+    procfs_stat_snap_t *snap = (procfs_stat_snap_t *)node->impl;
+    bool refresh = (offset == 0);
+    if (!snap) {
+        snap = (procfs_stat_snap_t *)kmalloc(sizeof(procfs_stat_snap_t) + buf_size);
+        if (!snap) {
+            mutex_unlock(&procfs_stat_lock);
+            return 0;
+        }
+        node->impl = snap;
+        refresh = true;
+    }
+    
+    if (refresh) {
+        int len = file->dump(snap->buf, buf_size);
+        if (len < 0) {
+            len = 0;
+        } else if ((size_t)len >= buf_size) {
+            len = (int)buf_size - 1;
+        }
+        snap->len = (uint32_t)len;
+    }
+    
+    uint32_t bytes_to_read = 0;
+    if (offset < snap->len) {
+        bytes_to_read = size;
+        if (offset + bytes_to_read > snap->len) {
+            bytes_to_read = snap->len - offset;
+        }
+        memcpy(buffer, snap->buf + offset, bytes_to_read);
+    }
+    
+    mutex_unlock(&procfs_stat_lock);
+    return bytes_to_read;
+}
+
 /**
  * 读取 /proc/net/ 目录
  */
@@ -753,15 +872,7 @@ static fs_node_t *procfs_pid_finddir(fs_node_t *node, const char *name) {
         status_file->impl_data = pid;  // 存储 PID
         status_file->impl = NULL;  // status 文件不需要私有数据
         status_file->ref_count = 1;  // 返回时引用计数为 1
-        status_file->read = procfs_status_read;
-        status_file->write = NULL;
-        status_file->open = NULL;
-        status_file->close = NULL;
-        status_file->readdir = NULL;
-        status_file->finddir = NULL;
-        status_file->create = NULL;
-        status_file->mkdir = NULL;
-        status_file->unlink = NULL;
+        status_file->ops = &procfs_status_ops;
         status_file->ptr = NULL;
         status_file->flags = FS_NODE_FLAG_ALLOCATED;  // 标记为动态分配
         
@@ -843,8 +954,18 @@ static struct dirent *procfs_root_readdir(fs_node_t *node, uint32_t index) {
         return dirent;
     }
     
+    /* 返回统计信息文件 */
+    if (index < PROCFS_ROOT_FIXED + PROCFS_STAT_FILE_COUNT) {
+        strcpy(dirent->d_name, procfs_stat_files[index - PROCFS_ROOT_FIXED].name);
+        dirent->d_ino = 0;
+        dirent->d_reclen = sizeof(struct dirent);
+        dirent->d_off = index + 1;
+        dirent->d_type = DT_REG;
+        return dirent;
+    }
+    
     /* 返回进程目录（PID 目录） */
-    uint32_t pid_index = index - 6;
+    uint32_t pid_index = index - PROCFS_ROOT_FIXED - PROCFS_STAT_FILE_COUNT;
     
     // 遍历所有任务，找到第 pid_index 个有效进程
     uint32_t found_count = 0;
@@ -869,6 +990,44 @@ static struct dirent *procfs_root_readdir(fs_node_t *node, uint32_t index) {
     return NULL;
 }
 
+/**
+ * /proc 根目录迭代
+ *
+ * 固定项和统计文件按索引给出；进程目录部分由游标记录下一个要检查的
+ * 任务槽位，不必每一项都从第一个任务数起。
+ */
+static int procfs_root_iterate(fs_node_t *node, dir_cursor_t *cursor, filldir_t fill, void *ctx) {
+    while (cursor->index < PROCFS_ROOT_FIXED + PROCFS_STAT_FILE_COUNT) {
+        struct dirent *d = procfs_root_readdir(node, cursor->index);
+        if (!d) {
+            return -1;
+        }
+        if (fill(ctx, d->d_name, d->d_ino, d->d_type) != 0) {
+            return 0;
+        }
+        cursor->index++;
+        cursor->pos = 0;
+    }
+    
+    for (uint32_t slot = (uint32_t)cursor->pos; slot < MAX_TASKS; slot++) {
+        task_t *task = task_get_by_pid(slot);
+        if (!task || task->state == TASK_UNUSED) {
+            continue;
+        }
+        
+        char pid_str[16];
+        ksnprintf(pid_str, sizeof(pid_str), "%u", task->pid);
+        if (fill(ctx, pid_str, 0, DT_DIR) != 0) {
+            cursor->pos = slot;
+            return 0;
+        }
+        cursor->index++;
+    }
+    
+    cursor->pos = MAX_TASKS;
+    return 0;
+}
+
 /**
  * 在 /proc 根目录中查找进程目录
  */
@@ -909,6 +1068,29 @@ static fs_node_t *procfs_root_finddir(fs_node_t *node, const char *name) {
         return procfs_net_dir;
     }
     
+    /* 统计信息文件：每次都创建新节点，快照随打开的文件独立（由 VFS 引用计数管理生命周期） */
+    for (uint32_t i = 0; i < PROCFS_STAT_FILE_COUNT; i++) {
+        if (strcmp(name, procfs_stat_files[i].name) != 0) {
+            continue;
+        }
+        fs_node_t *file = (fs_node_t *)kmalloc(sizeof(fs_node_t));
+        if (!file) {
+            return NULL;
+        }
+        
+        memset(file, 0, sizeof(fs_node_t));
+        strcpy(file->name, procfs_stat_files[i].name);
+        file->type = FS_FILE;
+        file->size = PROCFS_STAT_BUF_SIZE;
+        file->permissions = FS_PERM_READ;
+        file->impl_data = i;
+        file->impl = NULL;  // 首次读取时分配快照
+        file->ref_count = 1;
+        file->ops = &procfs_stat_ops;
+        file->flags = FS_NODE_FLAG_ALLOCATED;
+        return file;
+    }
+    
     /* 尝试解析为 PID */
     uint32_t pid = 0;
     const char *p = name;
@@ -944,15 +1126,7 @@ static fs_node_t *procfs_root_finddir(fs_node_t *node, const char *name) {
             pid_dir->impl_data = pid;  // 存储 PID
             pid_dir->impl = priv;  // 设置私有数据（包含 readdir 缓冲区）
             pid_dir->ref_count = 1;  // 返回时引用计数为 1
-            pid_dir->read = NULL;
-            pid_dir->write = NULL;
-            pid_dir->open = NULL;
-            pid_dir->close = NULL;
-            pid_dir->readdir = procfs_pid_readdir;
-            pid_dir->finddir = procfs_pid_finddir;
-            pid_dir->create = NULL;
-            pid_dir->mkdir = NULL;
-            pid_dir->unlink = NULL;
+            pid_dir->ops = &procfs_pid_dir_ops;
             pid_dir->ptr = NULL;
             pid_dir->flags = FS_NODE_FLAG_ALLOCATED;  // 标记为动态分配
             
@@ -996,15 +1170,7 @@ fs_node_t *procfs_init(void) {
     procfs_root->gid = 0;
     procfs_root->flags = 0;
     procfs_root->ref_count = 0;  // 初始化引用计数
-    procfs_root->read = NULL;
-    procfs_root->write = NULL;
-    procfs_root->open = NULL;
-    procfs_root->close = NULL;
-    procfs_root->readdir = procfs_root_readdir;
-    procfs_root->finddir = procfs_root_finddir;
-    procfs_root->create = NULL;  // 不支持创建文件
-    procfs_root->mkdir = NULL;   // 不支持创建目录
-    procfs_root->unlink = NULL;  // 不支持删除
+    procfs_root->ops = &procfs_root_ops;
     procfs_root->ptr = NULL;
     procfs_root->impl = procfs_root_private;  // 设置私有数据
     
@@ -1022,15 +1188,7 @@ fs_node_t *procfs_init(void) {
     procfs_meminfo_file->size = 512;
     procfs_meminfo_file->permissions = FS_PERM_READ;
     procfs_meminfo_file->ref_count = 0;  // 初始化引用计数
-    procfs_meminfo_file->read = procfs_meminfo_read;
-    procfs_meminfo_file->write = NULL;
-    procfs_meminfo_file->open = NULL;
-    procfs_meminfo_file->close = NULL;
-    procfs_meminfo_file->readdir = NULL;
-    procfs_meminfo_file->finddir = NULL;
-    procfs_meminfo_file->create = NULL;
-    procfs_meminfo_file->mkdir = NULL;
-    procfs_meminfo_file->unlink = NULL;
+    procfs_meminfo_file->ops = &procfs_meminfo_ops;
     procfs_meminfo_file->ptr = NULL;
     
     /* 创建 pci 文件节点 */
@@ -1047,15 +1205,7 @@ fs_node_t *procfs_init(void) {
     procfs_pci_file->size = 4096;
     procfs_pci_file->permissions = FS_PERM_READ;
     procfs_pci_file->ref_count = 0;
-    procfs_pci_file->read = procfs_pci_read;
-    procfs_pci_file->write = NULL;
-    procfs_pci_file->open = NULL;
-    procfs_pci_file->close = NULL;
-    procfs_pci_file->readdir = NULL;
-    procfs_pci_file->finddir = NULL;
-    procfs_pci_file->create = NULL;
-    procfs_pci_file->mkdir = NULL;
-    procfs_pci_file->unlink = NULL;
+    procfs_pci_file->ops = &procfs_pci_ops;
     procfs_pci_file->ptr = NULL;
     
     /* 创建 usb 文件节点 */
@@ -1072,15 +1222,7 @@ fs_node_t *procfs_init(void) {
     procfs_usb_file->size = 4096;
     procfs_usb_file->permissions = FS_PERM_READ;
     procfs_usb_file->ref_count = 0;
-    procfs_usb_file->read = procfs_usb_read;
-    procfs_usb_file->write = NULL;
-    procfs_usb_file->open = NULL;
-    procfs_usb_file->close = NULL;
-    procfs_usb_file->readdir = NULL;
-    procfs_usb_file->finddir = NULL;
-    procfs_usb_file->create = NULL;
-    procfs_usb_file->mkdir = NULL;
-    procfs_usb_file->unlink = NULL;
+    procfs_usb_file->ops = &procfs_usb_ops;
     procfs_usb_file->ptr = NULL;
     
     /* 创建 /proc/net/ 目录节点 */
@@ -1106,15 +1248,7 @@ fs_node_t *procfs_init(void) {
     procfs_net_dir->size = 0;
     procfs_net_dir->permissions = FS_PERM_READ | FS_PERM_EXEC;
     procfs_net_dir->ref_count = 0;
-    procfs_net_dir->read = NULL;
-    procfs_net_dir->write = NULL;
-    procfs_net_dir->open = NULL;
-    procfs_net_dir->close = NULL;
-    procfs_net_dir->readdir = procfs_net_readdir;
-    procfs_net_dir->finddir = procfs_net_finddir;
-    procfs_net_dir->create = NULL;
-    procfs_net_dir->mkdir = NULL;
-    procfs_net_dir->unlink = NULL;
+    procfs_net_dir->ops = &procfs_net_dir_ops;
     procfs_net_dir->ptr = NULL;
     procfs_net_dir->impl = procfs_net_private;
     
@@ -1132,15 +1266,7 @@ fs_node_t *procfs_init(void) {
     procfs_net_tcp_file->size = 8192;
     procfs_net_tcp_file->permissions = FS_PERM_READ;
     procfs_net_tcp_file->ref_count = 0;
-    procfs_net_tcp_file->read = procfs_net_tcp_read;
-    procfs_net_tcp_file->write = NULL;
-    procfs_net_tcp_file->open = NULL;
-    procfs_net_tcp_file->close = NULL;
-    procfs_net_tcp_file->readdir = NULL;
-    procfs_net_tcp_file->finddir = NULL;
-    procfs_net_tcp_file->create = NULL;
-    procfs_net_tcp_file->mkdir = NULL;
-    procfs_net_tcp_file->unlink = NULL;
+    procfs_net_tcp_file->ops = &procfs_net_tcp_ops;
     procfs_net_tcp_file->ptr = NULL;
     
     /* 创建 /proc/net/udp 文件节点 */
@@ -1157,15 +1283,7 @@ fs_node_t *procfs_init(void) {
     procfs_net_udp_file->size = 4096;
     procfs_net_udp_file->permissions = FS_PERM_READ;
     procfs_net_udp_file->ref_count = 0;
-    procfs_net_udp_file->read = procfs_net_udp_read;
-    procfs_net_udp_file->write = NULL;
-    procfs_net_udp_file->open = NULL;
-    procfs_net_udp_file->close = NULL;
-    procfs_net_udp_file->readdir = NULL;
-    procfs_net_udp_file->finddir = NULL;
-    procfs_net_udp_file->create = NULL;
-    procfs_net_udp_file->mkdir = NULL;
-    procfs_net_udp_file->unlink = NULL;
+    procfs_net_udp_file->ops = &procfs_net_udp_ops;
     procfs_net_udp_file->ptr = NULL;
     
     /* 创建 /proc/net/route 文件节点 */
@@ -1182,17 +1300,12 @@ fs_node_t *procfs_init(void) {
     procfs_net_route_file->size = 4096;
     procfs_net_route_file->permissions = FS_PERM_READ;
     procfs_net_route_file->ref_count = 0;
-    procfs_net_route_file->read = procfs_net_route_read;
-    procfs_net_route_file->write = NULL;
-    procfs_net_route_file->open = NULL;
-    procfs_net_route_file->close = NULL;
-    procfs_net_route_file->readdir = NULL;
-    procfs_net_route_file->finddir = NULL;
-    procfs_net_route_file->create = NULL;
-    procfs_net_route_file->mkdir = NULL;
-    procfs_net_route_file->unlink = NULL;
+    procfs_net_route_file->ops = &procfs_net_route_ops;
     procfs_net_route_file->ptr = NULL;
     
+    /* 统计信息文件节点在查找时按需创建 */
+    mutex_init(&procfs_stat_lock);
+    
     LOG_INFO_MSG("procfs: Initialized (with /proc/net/ support)\n");
     
     return procfs_root;
@@ -29,6 +29,7 @@ typedef struct ramfs_dirent {
 typedef struct ramfs_dir {
     ramfs_dirent_t *entries;  // 目录项链表
     uint32_t count;           // 目录项数量
+    uint32_t gen;             // 删除条目时递增，使目录流游标中的条目指针失效
     mutex_t lock;             // 目录锁（保护目录操作）
 } ramfs_dir_t;
 
@@ -93,6 +94,7 @@ static int ramfs_remove_entry(ramfs_dir_t *dir, const char *name) {
             *current = (*current)->next;
             kfree(to_remove);
             dir->count--;
+            dir->gen++;
             return 0;
         }
         current = &(*current)->next;
@@ -101,13 +103,38 @@ static int ramfs_remove_entry(ramfs_dir_t *dir, const char *name) {
     return -1;  // 未找到
 }
 
+/**
+ * 节点类型对应的 d_type
+ */
+static uint8_t ramfs_dtype(fs_node_t *node) {
+    switch (node->type) {
+        case FS_FILE:
+            return DT_REG;
+        case FS_DIRECTORY:
+            return DT_DIR;
+        case FS_CHARDEVICE:
+            return DT_CHR;
+        case FS_BLOCKDEVICE:
+            return DT_BLK;
+        case FS_PIPE:
+            return DT_FIFO;
+        case FS_SYMLINK:
+            return DT_LNK;
+        default:
+            return DT_UNKNOWN;
+    }
+}
+
 // ============================================================================
 // VFS 操作函数实现
 // ============================================================================
 
 // 前向声明
+static int ramfs_create_file(fs_node_t *node, const char *name);
+static int ramfs_mkdir(fs_node_t *node, const char *name, uint32_t permissions);
 static int ramfs_unlink(fs_node_t *node, const char *name);
 static int ramfs_rename(fs_node_t *node, const char *old_name, const char *new_name);
+static int ramfs_iterate(fs_node_t *node, dir_cursor_t *cursor, filldir_t fill, void *ctx);
 
 /**
  * 读取文件
@@ -264,33 +291,55 @@ static struct dirent *ramfs_readdir(fs_node_t *node, uint32_t index) {
     dent.d_reclen = sizeof(struct dirent);
     dent.d_off = index + 1;  // 下一个索引
     
-    // 根据节点类型设置 d_type
-    switch (current->node->type) {
-        case FS_FILE:
-            dent.d_type = DT_REG;
-            break;
-        case FS_DIRECTORY:
-            dent.d_type = DT_DIR;
-            break;
-        case FS_CHARDEVICE:
-            dent.d_type = DT_CHR;
-            break;
-        case FS_BLOCKDEVICE:
-            dent.d_type = DT_BLK;
-            break;
-        case FS_PIPE:
-            dent.d_type = DT_FIFO;
-            break;
-        case FS_SYMLINK:
-            dent.d_type = DT_LNK;
-            break;
-        default:
-            dent.d_type = DT_UNKNOWN;
+    dent.d_type = ramfs_dtype(current->node);
+    
+    mutex_unlock(&dir->lock);
+    return &dent;
+}
+
+/**
+ * 目录迭代
+ *
+ * 游标保存下一个条目的指针和目录的删除计数；期间没有条目被删除时直接从
+ * 该条目继续，否则按已读数量重新定位。新条目插在链表头部，不影响游标。
+ */
+static int ramfs_iterate(fs_node_t *node, dir_cursor_t *cursor, filldir_t fill, void *ctx) {
+    if (node->type != FS_DIRECTORY) {
+        return -1;
+    }
+    
+    ramfs_dir_t *dir = (ramfs_dir_t *)node->impl;
+    if (!dir) {
+        return -1;
+    }
+    
+    mutex_lock(&dir->lock);
+    
+    ramfs_dirent_t *current;
+    if (cursor->index == 0) {
+        current = dir->entries;
+    } else if (cursor->cookie == dir->gen) {
+        current = (ramfs_dirent_t *)cursor->pos;
+    } else {
+        current = dir->entries;
+        for (uint32_t i = 0; current && i < cursor->index; i++) {
+            current = current->next;
+        }
+    }
+    
+    while (current) {
+        if (fill(ctx, current->name, current->node->inode, ramfs_dtype(current->node)) != 0) {
             break;
+        }
+        cursor->index++;
+        current = current->next;
     }
     
+    cursor->pos = (uintptr_t)current;
+    cursor->cookie = dir->gen;
+    
     mutex_unlock(&dir->lock);
-    return &dent;
+    return 0;
 }
 
 /**
@@ -320,6 +369,24 @@ static fs_node_t *ramfs_finddir(fs_node_t *node, const char *name) {
     return result;
 }
 
+/* 文件、目录操作表 */
+static const fs_node_ops_t ramfs_file_ops = {
+    .read = ramfs_read,
+    .write = ramfs_write,
+    .open = ramfs_open,
+    .close = ramfs_close,
+};
+
+static const fs_node_ops_t ramfs_dir_ops = {
+    .readdir = ramfs_readdir,
+    .finddir = ramfs_finddir,
+    .create = ramfs_create_file,
+    .mkdir = ramfs_mkdir,
+    .unlink = ramfs_unlink,
+    .rename = ramfs_rename,
+    .iterate = ramfs_iterate,
+};
+
 /**
  * 创建文件（VFS 操作函数）
  */
@@ -380,11 +447,7 @@ static int ramfs_create_file(fs_node_t *node, const char *name) {
     new_node->ref_count = 0;  // 初始化引用计数
     new_node->flags = 0;  // RAMFS 节点不应该被自动释放
     
-    // 设置操作函数
-    new_node->read = ramfs_read;
-    new_node->write = ramfs_write;
-    new_node->open = ramfs_open;
-    new_node->close = ramfs_close;
+    new_node->ops = &ramfs_file_ops;
     
     // 添加到目录
     if (ramfs_add_entry(dir, name, new_node) != 0) {
@@ -438,6 +501,7 @@ static int ramfs_mkdir(fs_node_t *node, const char *name, uint32_t permissions)
     // 初始化目录数据
     new_dir->entries = NULL;
     new_dir->count = 0;
+    new_dir->gen = 0;
     mutex_init(&new_dir->lock);  // 初始化新目录的锁
     
     // 初始化目录节点
@@ -455,15 +519,9 @@ static int ramfs_mkdir(fs_node_t *node, const char *name, uint32_t permissions)
     new_node->permissions = permissions;
     new_node->impl = new_dir;
     new_node->ref_count = 0;  // 初始化引用计数
-    new_node->flags = 0;  // RAMFS 节点不应该被自动释放
+    new_node->flags = FS_NODE_FLAG_DCACHE;  // RAMFS 节点不应该被自动释放
     
-    // 设置操作函数
-    new_node->readdir = ramfs_readdir;
-    new_node->finddir = ramfs_finddir;
-    new_node->create = ramfs_create_file;
-    new_node->mkdir = ramfs_mkdir;
-    new_node->unlink = ramfs_unlink;
-    new_node->rename = ramfs_rename;
+    new_node->ops = &ramfs_dir_ops;
     
     // 添加到父目录
     if (ramfs_add_entry(parent_dir, name, new_node) != 0) {
@@ -618,6 +676,7 @@ fs_node_t *ramfs_create(const char *name) {
     // 初始化根目录数据
     root_dir->entries = NULL;
     root_dir->count = 0;
+    root_dir->gen = 0;
     mutex_init(&root_dir->lock);  // 初始化根目录的锁
     
     // 初始化根目录节点
@@ -635,15 +694,9 @@ fs_node_t *ramfs_create(const char *name) {
     root->permissions = FS_PERM_READ | FS_PERM_WRITE | FS_PERM_EXEC;
     root->impl = root_dir;
     root->ref_count = 0;  // 初始化引用计数
-    root->flags = 0;  // RAMFS 节点不应该被自动释放
-    
-    // 设置操作函数
-    root->readdir = ramfs_readdir;
-    root->finddir = ramfs_finddir;
-    root->create = ramfs_create_file;
-    root->mkdir = ramfs_mkdir;
-    root->unlink = ramfs_unlink;
-    root->rename = ramfs_rename;
+    root->flags = FS_NODE_FLAG_DCACHE;  // RAMFS 节点不应该被自动释放
+    
+    root->ops = &ramfs_dir_ops;
     
     return root;
 }
@@ -125,6 +125,26 @@ static int shmfs_unlink(fs_node_t *node, const char *name);
 static int shmfs_create_file(fs_node_t *node, const char *name);
 static struct dirent *shmfs_readdir(fs_node_t *node, uint32_t index);
 static fs_node_t *shmfs_finddir(fs_node_t *node, const char *name);
+static uint32_t shmfs_read(fs_node_t *node, uint32_t offset, uint32_t size, uint8_t *buffer);
+static uint32_t shmfs_write(fs_node_t *node, uint32_t offset, uint32_t size, uint8_t *buffer);
+static int shmfs_truncate(fs_node_t *node, uint32_t new_size);
+static void shmfs_open(fs_node_t *node, uint32_t flags);
+static void shmfs_close(fs_node_t *node);
+
+static const fs_node_ops_t shmfs_file_ops = {
+    .read = shmfs_read,
+    .write = shmfs_write,
+    .open = shmfs_open,
+    .close = shmfs_close,
+    .truncate = shmfs_truncate,
+};
+
+static const fs_node_ops_t shmfs_dir_ops = {
+    .readdir = shmfs_readdir,
+    .finddir = shmfs_finddir,
+    .create = shmfs_create_file,
+    .unlink = shmfs_unlink,
+};
 
 /**
  * 读取共享内存文件
@@ -454,12 +474,7 @@ static int shmfs_create_file(fs_node_t *node, const char *name) {
     new_node->ref_count = 0;
     new_node->flags = 0;
     
-    // 设置操作函数
-    new_node->read = shmfs_read;
-    new_node->write = shmfs_write;
-    new_node->open = shmfs_open;
-    new_node->close = shmfs_close;
-    new_node->truncate = shmfs_truncate;
+    new_node->ops = &shmfs_file_ops;
     
     // 创建目录项
     shmfs_dirent_t *new_entry = (shmfs_dirent_t *)kmalloc(sizeof(shmfs_dirent_t));
@@ -661,11 +676,7 @@ fs_node_t *shmfs_create(const char *name) {
     root->ref_count = 0;
     root->flags = 0;
     
-    // 设置操作函数
-    root->readdir = shmfs_readdir;
-    root->finddir = shmfs_finddir;
-    root->create = shmfs_create_file;
-    root->unlink = shmfs_unlink;
+    root->ops = &shmfs_dir_ops;
     
     return root;
 }
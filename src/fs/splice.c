@@ -0,0 +1,356 @@
+/**
+ * splice / sendfile / vmsplice 实现
+ *
+ * 管道一端通过 pipe_splice_out()/pipe_splice_in() 让数据在环形缓冲区中
+ * 原地交给对端（文件写入、文件读取或 TCP 发送），只复制一次。
+ * 两端都不是管道时使用按页分配的中转缓冲区，仍然不经过用户空间。
+ */
+
+#include <fs/splice.h>
+#include <fs/pipe.h>
+#include <fs/vfs.h>
+#include <kernel/task.h>
+#include <kernel/fd_table.h>
+#include <kernel/syscalls/fs.h>
+#include <mm/pmm.h>
+#include <lib/klog.h>
+
+#if !defined(ARCH_ARM64)
+#include <net/socket.h>
+#endif
+
+/* actor 上下文：对端节点及其偏移 */
+typedef struct splice_desc {
+    fs_node_t *node;
+    uint32_t *off;          // 文件偏移（管道为 NULL）
+    int sockfd;
+    bool short_io;          // 对端读到末尾或写不进去
+} splice_desc_t;
+
+static uint8_t *splice_buf_alloc(paddr_t *phys) {
+    *phys = pmm_alloc_frames_zone(SPLICE_CHUNK_SIZE / PAGE_SIZE, ZONE_NORMAL);
+    if (*phys == PADDR_INVALID) {
+        return NULL;
+    }
+    return (uint8_t *)PHYS_TO_VIRT((uintptr_t)*phys);
+}
+
+static void splice_buf_free(paddr_t phys) {
+    pmm_free_frames(phys, SPLICE_CHUNK_SIZE / PAGE_SIZE);
+}
+
+/* 管道数据写入目标节点 */
+static uint32_t splice_actor_write(void *ctx, uint8_t *data, uint32_t len) {
+    splice_desc_t *sd = (splice_desc_t *)ctx;
+    uint32_t off = sd->off ? *sd->off : 0;
+    uint32_t n = vfs_write(sd->node, off, len, data);
+    if (sd->off) {
+        *sd->off += n;
+    }
+    if (n < len) {
+        sd->short_io = true;
+    }
+    return n;
+}
+
+/* 源节点数据直接读入管道空闲空间 */
+static uint32_t splice_actor_read(void *ctx, uint8_t *data, uint32_t len) {
+    splice_desc_t *sd = (splice_desc_t *)ctx;
+    uint32_t n = vfs_read(sd->node, *sd->off, len, data);
+    *sd->off += n;
+    if (n < len) {
+        sd->short_io = true;
+    }
+    return n;
+}
+
+#if !defined(ARCH_ARM64)
+/* 管道数据直接交给 TCP */
+static uint32_t splice_actor_send(void *ctx, uint8_t *data, uint32_t len) {
+    splice_desc_t *sd = (splice_desc_t *)ctx;
+    ssize_t n = socket_sendpage(sd->sockfd, data, len);
+    if (n < 0) {
+        sd->short_io = true;
+        return 0;
+    }
+    if ((uint32_t)n < len) {
+        sd->short_io = true;
+    }
+    return (uint32_t)n;
+}
+#endif
+
+/* 文件到文件：经中转缓冲区 */
+static ssize_t splice_file_to_file(fs_node_t *in, uint32_t *in_off,
+                                   fs_node_t *out, uint32_t *out_off, uint32_t len) {
+    paddr_t phys;
+    uint8_t *buf = splice_buf_alloc(&phys);
+    if (!buf) {
+        return -1;
+    }
+
+    uint32_t total = 0;
+    while (total < len) {
+        uint32_t chunk = len - total;
+        if (chunk > SPLICE_CHUNK_SIZE) {
+            chunk = SPLICE_CHUNK_SIZE;
+        }
+
+        uint32_t r = vfs_read(in, *in_off, chunk, buf);
+        if (r == 0) {
+            break;
+        }
+        uint32_t w = vfs_write(out, *out_off, r, buf);
+        *in_off += w;
+        *out_off += w;
+        total += w;
+        if (w < r || r < chunk) {
+            break;
+        }
+    }
+
+    splice_buf_free(phys);
+    return (ssize_t)total;
+}
+
+ssize_t vfs_splice(fs_node_t *in, uint32_t *in_off, fs_node_t *out, uint32_t *out_off, uint32_t len) {
+    if (!in || !out || len == 0) {
+        return (!in || !out) ? -1 : 0;
+    }
+
+    bool in_pipe = (in->type == FS_PIPE);
+    bool out_pipe = (out->type == FS_PIPE);
+
+    if ((!in_pipe && !in_off) || (!out_pipe && !out_off)) {
+        return -1;
+    }
+
+    if (in_pipe) {
+        // 同一个管道首尾相接会在持有管道锁时再次加锁
+        if (out_pipe && in->impl == out->impl) {
+            return -1;
+        }
+        splice_desc_t sd = { .node = out, .off = out_pipe ? NULL : out_off };
+        return (ssize_t)pipe_splice_out(in, len, splice_actor_write, &sd);
+    }
+
+    if (out_pipe) {
+        splice_desc_t sd = { .node = in, .off = in_off };
+        uint32_t total = 0;
+        while (total < len && !sd.short_io) {
+            uint32_t n = pipe_splice_in(out, len - total, splice_actor_read, &sd);
+            if (n == 0) {
+                break;
+            }
+            total += n;
+        }
+        return (ssize_t)total;
+    }
+
+    return splice_file_to_file(in, in_off, out, out_off, len);
+}
+
+#if !defined(ARCH_ARM64)
+ssize_t vfs_splice_to_socket(fs_node_t *in, uint32_t *in_off, int sockfd, uint32_t len) {
+    if (!in || len == 0) {
+        return !in ? -1 : 0;
+    }
+
+    if (in->type == FS_PIPE) {
+        splice_desc_t sd = { .sockfd = sockfd };
+        uint32_t n = pipe_splice_out(in, len, splice_actor_send, &sd);
+        return (n == 0 && sd.short_io) ? -1 : (ssize_t)n;
+    }
+
+    if (!in_off) {
+        return -1;
+    }
+
+    paddr_t phys;
+    uint8_t *buf = splice_buf_alloc(&phys);
+    if (!buf) {
+        return -1;
+    }
+
+    uint32_t total = 0;
+    while (total < len) {
+        uint32_t chunk = len - total;
+        if (chunk > SPLICE_CHUNK_SIZE) {
+            chunk = SPLICE_CHUNK_SIZE;
+        }
+
+        uint32_t r = vfs_read(in, *in_off, chunk, buf);
+        if (r == 0) {
+            break;
+        }
+        ssize_t sent = socket_sendpage(sockfd, buf, r);
+        if (sent <= 0) {
+            break;
+        }
+        *in_off += (uint32_t)sent;
+        total += (uint32_t)sent;
+        if ((uint32_t)sent < r || r < chunk) {
+            break;
+        }
+    }
+
+    splice_buf_free(phys);
+    return (total == 0 && len > 0 && in->size > *in_off) ? -1 : (ssize_t)total;
+}
+#endif
+
+/* ============================================================================
+ * 系统调用
+ * ============================================================================ */
+
+/* 获取描述符表项并按访问模式检查读写权限 */
+static fd_entry_t *splice_get_entry(int fd, bool for_write) {
+    task_t *current = task_get_current();
+    if (!current || !current->fd_table) {
+        return NULL;
+    }
+
+    fd_entry_t *entry = fd_table_get(current->fd_table, fd);
+    if (!entry || !entry->node) {
+        return NULL;
+    }
+
+    // 注意：O_RDONLY = 0，所以需要用 (flags & 3) 来获取访问模式
+    uint32_t access_mode = entry->flags & 3;
+    bool can_read = (access_mode == O_RDONLY) || (access_mode == O_RDWR);
+    bool can_write = (access_mode == O_WRONLY) || (access_mode == O_RDWR);
+
+    if (for_write ? !can_write : !can_read) {
+        return NULL;
+    }
+    return entry;
+}
+
+/*
+ * 解析偏移：用户提供偏移时使用副本，否则使用描述符偏移
+ * 管道不接受显式偏移
+ */
+static int splice_resolve_off(fd_entry_t *entry, off_t *user_off, uint32_t *off) {
+    if (entry->node->type == FS_PIPE) {
+        *off = 0;
+        return user_off ? -1 : 0;
+    }
+    if (user_off) {
+        if (*user_off < 0) {
+            return -1;
+        }
+        *off = (uint32_t)*user_off;
+    } else {
+        *off = (uint32_t)entry->offset;
+    }
+    return 0;
+}
+
+static void splice_commit_off(fd_entry_t *entry, off_t *user_off, uint32_t off) {
+    if (entry->node->type == FS_PIPE) {
+        return;
+    }
+    if (user_off) {
+        *user_off = (off_t)off;
+    } else {
+        entry->offset = off;
+    }
+}
+
+ssize_t sys_splice(int fd_in, off_t *off_in, int fd_out, off_t *off_out, uint32_t len) {
+    fd_entry_t *in = splice_get_entry(fd_in, false);
+    fd_entry_t *out = splice_get_entry(fd_out, true);
+    if (!in || !out) {
+        LOG_ERROR_MSG("sys_splice: invalid fd (in=%d, out=%d)\n", fd_in, fd_out);
+        return -1;
+    }
+
+    // 与 Linux 一致：至少一端是管道，其余情况用 sendfile
+    if (in->node->type != FS_PIPE && out->node->type != FS_PIPE) {
+        return -1;
+    }
+
+    uint32_t in_pos, out_pos;
+    if (splice_resolve_off(in, off_in, &in_pos) != 0 ||
+        splice_resolve_off(out, off_out, &out_pos) != 0) {
+        return -1;
+    }
+    if (!off_out && (out->flags & O_APPEND)) {
+        out_pos = out->node->size;
+    }
+
+    ssize_t ret = vfs_splice(in->node, &in_pos, out->node, &out_pos, len);
+    if (ret > 0) {
+        splice_commit_off(in, off_in, in_pos);
+        splice_commit_off(out, off_out, out_pos);
+    }
+    return ret;
+}
+
+ssize_t sys_sendfile(int out_fd, int in_fd, off_t *offset, uint32_t count, uint32_t flags) {
+    fd_entry_t *in = splice_get_entry(in_fd, false);
+    if (!in) {
+        LOG_ERROR_MSG("sys_sendfile: invalid in_fd %d\n", in_fd);
+        return -1;
+    }
+
+    uint32_t in_pos;
+    if (splice_resolve_off(in, offset, &in_pos) != 0) {
+        return -1;
+    }
+
+    ssize_t ret;
+    if (flags & SENDFILE_F_SOCK) {
+#if defined(ARCH_ARM64)
+        (void)out_fd;
+        return -1;
+#else
+        ret = vfs_splice_to_socket(in->node, &in_pos, out_fd, count);
+#endif
+    } else {
+        fd_entry_t *out = splice_get_entry(out_fd, true);
+        if (!out) {
+            LOG_ERROR_MSG("sys_sendfile: invalid out_fd %d\n", out_fd);
+            return -1;
+        }
+
+        uint32_t out_pos = (out->flags & O_APPEND) ? out->node->size : (uint32_t)out->offset;
+        ret = vfs_splice(in->node, &in_pos, out->node, &out_pos, count);
+        if (ret > 0) {
+            splice_commit_off(out, NULL, out_pos);
+        }
+    }
+
+    if (ret > 0) {
+        splice_commit_off(in, offset, in_pos);
+    }
+    return ret;
+}
+
+ssize_t sys_vmsplice(int fd, const struct iovec *iov, uint32_t nr_segs) {
+    if (!iov || nr_segs == 0 || nr_segs > UIO_MAXIOV) {
+        return -1;
+    }
+
+    fd_entry_t *entry = splice_get_entry(fd, true);
+    if (!entry || entry->node->type != FS_PIPE) {
+        LOG_ERROR_MSG("sys_vmsplice: fd %d is not a pipe\n", fd);
+        return -1;
+    }
+
+    // 直接从用户内存复制进管道环形缓冲区（不经过 sys_write 的分块中转）
+    uint32_t total = 0;
+    for (uint32_t i = 0; i < nr_segs; i++) {
+        if (!iov[i].iov_base || iov[i].iov_len == 0) {
+            continue;
+        }
+        uint32_t len = (uint32_t)iov[i].iov_len;
+        uint32_t n = vfs_write(entry->node, 0, len, (uint8_t *)iov[i].iov_base);
+        total += n;
+        if (n < len) {
+            break;
+        }
+    }
+
+    return total > 0 ? (ssize_t)total : -1;
+}
@@ -3,60 +3,83 @@
 // ============================================================================
 
 #include <fs/vfs.h>
+#include <fs/poll.h>
+#include <fs/dcache.h>
 #include <lib/string.h>
 #include <lib/klog.h>
 #include <mm/heap.h>
 #include <kernel/sync/mutex.h>
+#include <lib/kprintf.h>
 
 static fs_node_t *fs_root = NULL;
 
-/* 挂载表 - 记录所有挂载点 */
+/*
+ * 挂载树 - 按路径分量组织的前缀树，根节点对应 "/"
+ *
+ * 路径解析时与路径分量同步下行，经过挂载点时切换到挂载的文件系统根，
+ * 最深的挂载点自然优先。节点初始化完成后以 release 语义挂入父节点的
+ * 子链表，读者用 acquire 语义读取，无需加锁。卸载只把节点的 root 置空，
+ * 树节点本身从不释放，并发的无锁读者始终可以安全访问；再次挂载时复用。
+ */
 #define MAX_MOUNTS 32
-#define MAX_MOUNT_PATH 256
+#define MAX_MOUNT_NAME 128
 
-typedef struct {
-    char path[MAX_MOUNT_PATH];   /* 挂载点路径（如 "/dev"） */
-    fs_node_t *root;             /* 挂载的文件系统根节点 */
-} vfs_mount_entry_t;
+typedef struct vfs_mount_node {
+    char name[MAX_MOUNT_NAME];          /* 路径分量 */
+    fs_node_t *root;                    /* 挂载在此处的文件系统根，NULL 表示中间分量 */
+    struct vfs_mount_node *parent;
+    struct vfs_mount_node *children;    /* 子分量链表头（发布点） */
+    struct vfs_mount_node *sibling;     /* 发布前设置，之后不变 */
+} vfs_mount_node_t;
 
-static vfs_mount_entry_t mount_table[MAX_MOUNTS];
+static vfs_mount_node_t mount_tree;
 static uint32_t mount_count = 0;
 
-/* VFS 挂载表互斥锁 - 保护 mount_table 和 mount_count */
+/* VFS 挂载互斥锁 - 串行化 vfs_mount（路径解析不获取） */
 static mutex_t vfs_mount_mutex;
 
-/* VFS 引用计数互斥锁 - 保护所有节点的引用计数操作 */
+/* VFS 引用计数互斥锁 - 保护所有节点的引用计数操作和 inode 缓存 */
 static mutex_t vfs_refcount_mutex;
 
+/* inode 缓存：按 (文件系统实例, inode 编号) 散列的共享节点 */
+#define ICACHE_HASH_SIZE 256
+
+static fs_node_t *icache_hash[ICACHE_HASH_SIZE];
+static uint32_t icache_count = 0;
+static uint32_t icache_hits = 0;
+static uint32_t icache_misses = 0;
+
+/* 取节点的操作函数（节点没有操作表时为 NULL） */
+#define VFS_OP(node, op)    ((node)->ops ? (node)->ops->op : NULL)
+
 void vfs_init(void) {
     LOG_INFO_MSG("VFS: Initializing virtual file system...\n");
     fs_root = NULL;
+    memset(&mount_tree, 0, sizeof(mount_tree));
     mount_count = 0;
-    mutex_init(&vfs_mount_mutex);
-    mutex_init(&vfs_refcount_mutex);
+    mutex_init_named(&vfs_mount_mutex, "vfs_mount");
+    mutex_init_named(&vfs_refcount_mutex, "vfs_refcount");
+    memset(icache_hash, 0, sizeof(icache_hash));
+    icache_count = 0;
     LOG_INFO_MSG("VFS: Mount table and refcount mutexes initialized\n");
+    dcache_init();
 }
 
-/* 查询挂载表，根据路径获取挂载的根节点 */
-static fs_node_t *vfs_get_mounted_root_by_path(const char *path) {
-    if (!path) {
-        return NULL;
-    }
-    
-    mutex_lock(&vfs_mount_mutex);
-    
-    for (uint32_t i = 0; i < mount_count; i++) {
-        if (strcmp(mount_table[i].path, path) == 0) {
-            fs_node_t *result = mount_table[i].root;
-            mutex_unlock(&vfs_mount_mutex);
-            return result;
+/* 在挂载树中查找子分量（无锁读） */
+static vfs_mount_node_t *vfs_mount_child(vfs_mount_node_t *m, const char *name) {
+    vfs_mount_node_t *c = __atomic_load_n(&m->children, __ATOMIC_ACQUIRE);
+    for (; c; c = c->sibling) {
+        if (strcmp(c->name, name) == 0) {
+            return c;
         }
     }
-    
-    mutex_unlock(&vfs_mount_mutex);
     return NULL;
 }
 
+static inline fs_node_t *vfs_mount_root(vfs_mount_node_t *m) {
+    return __atomic_load_n(&m->root, __ATOMIC_ACQUIRE);
+}
+
 fs_node_t *vfs_get_root(void) {
     return fs_root;
 }
@@ -67,25 +90,25 @@ void vfs_set_root(fs_node_t *root) {
 }
 
 uint32_t vfs_read(fs_node_t *node, uint32_t offset, uint32_t size, uint8_t *buffer) {
-    if (!node || !node->read) {
+    if (!node || !VFS_OP(node, read)) {
         return 0;
     }
-    return node->read(node, offset, size, buffer);
+    return node->ops->read(node, offset, size, buffer);
 }
 
 uint32_t vfs_write(fs_node_t *node, uint32_t offset, uint32_t size, uint8_t *buffer) {
-    if (!node || !node->write) {
+    if (!node || !VFS_OP(node, write)) {
         return 0;
     }
-    return node->write(node, offset, size, buffer);
+    return node->ops->write(node, offset, size, buffer);
 }
 
 void vfs_open(fs_node_t *node, uint32_t flags) {
     if (!node) {
         return;
     }
-    if (node->open) {
-        node->open(node, flags);
+    if (VFS_OP(node, open)) {
+        node->ops->open(node, flags);
     }
 }
 
@@ -93,9 +116,120 @@ void vfs_close(fs_node_t *node) {
     if (!node) {
         return;
     }
-    if (node->close) {
-        node->close(node);
+    if (VFS_OP(node, close)) {
+        node->ops->close(node);
+    }
+}
+
+uint32_t vfs_poll(fs_node_t *node, poll_table_t *pt) {
+    if (!node) {
+        return POLLNVAL;
+    }
+    if (VFS_OP(node, poll)) {
+        return node->ops->poll(node, pt);
+    }
+    // 普通文件和不支持 poll 的设备：读写不会因等待数据而阻塞
+    return POLLIN | POLLOUT;
+}
+
+static inline uint32_t vfs_icache_bucket(void *sb, uint32_t inode) {
+    return ((uint32_t)((uintptr_t)sb >> 4) ^ (inode * 2654435761U)) & (ICACHE_HASH_SIZE - 1);
+}
+
+/* 从 inode 缓存散列链上摘除（持有 vfs_refcount_mutex） */
+static void vfs_icache_unhash(fs_node_t *node) {
+    fs_node_t **pp = &icache_hash[vfs_icache_bucket(node->sb, node->inode)];
+    while (*pp) {
+        if (*pp == node) {
+            *pp = node->icache_next;
+            break;
+        }
+        pp = &(*pp)->icache_next;
+    }
+    node->icache_next = NULL;
+    node->flags &= ~FS_NODE_FLAG_ICACHED;
+    icache_count--;
+}
+
+/* 查找缓存节点（持有 vfs_refcount_mutex） */
+static fs_node_t *vfs_icache_find(void *sb, uint32_t inode) {
+    for (fs_node_t *n = icache_hash[vfs_icache_bucket(sb, inode)]; n; n = n->icache_next) {
+        if (n->sb == sb && n->inode == inode && n->ref_count > 0) {
+            return n;
+        }
+    }
+    return NULL;
+}
+
+fs_node_t *vfs_icache_get(void *sb, uint32_t inode) {
+    if (!sb) {
+        return NULL;
+    }
+    
+    mutex_lock(&vfs_refcount_mutex);
+    fs_node_t *node = vfs_icache_find(sb, inode);
+    if (node) {
+        node->ref_count++;
+        icache_hits++;
+    } else {
+        icache_misses++;
+    }
+    mutex_unlock(&vfs_refcount_mutex);
+    return node;
+}
+
+fs_node_t *vfs_icache_add(fs_node_t *node) {
+    if (!node || !node->sb || !(node->flags & FS_NODE_FLAG_ALLOCATED)) {
+        return node;
+    }
+    
+    mutex_lock(&vfs_refcount_mutex);
+    fs_node_t *existing = vfs_icache_find(node->sb, node->inode);
+    if (existing) {
+        // 并发查找已经加入了同一 inode，使用已有节点
+        existing->ref_count++;
+        mutex_unlock(&vfs_refcount_mutex);
+        vfs_release_node(node);
+        return existing;
+    }
+    
+    uint32_t b = vfs_icache_bucket(node->sb, node->inode);
+    node->icache_next = icache_hash[b];
+    icache_hash[b] = node;
+    node->flags |= FS_NODE_FLAG_ICACHED;
+    icache_count++;
+    mutex_unlock(&vfs_refcount_mutex);
+    return node;
+}
+
+void vfs_icache_remove(fs_node_t *node) {
+    if (!node || !(node->flags & FS_NODE_FLAG_ALLOCATED)) {
+        return;
+    }
+    
+    mutex_lock(&vfs_refcount_mutex);
+    if (node->flags & FS_NODE_FLAG_ICACHED) {
+        vfs_icache_unhash(node);
     }
+    mutex_unlock(&vfs_refcount_mutex);
+}
+
+int vfs_icache_dump(char *buf, size_t size) {
+    mutex_lock(&vfs_refcount_mutex);
+    uint32_t count = icache_count;
+    uint32_t hits = icache_hits;
+    uint32_t misses = icache_misses;
+    mutex_unlock(&vfs_refcount_mutex);
+    
+    uint32_t lookups = hits + misses;
+    return ksnprintf(buf, size,
+                     "inodes:    %u\n"
+                     "lookups:   %u\n"
+                     "hits:      %u\n"
+                     "misses:    %u\n"
+                     "hit_rate:  %u%%\n",
+                     count, lookups, hits, misses,
+                     lookups ? (uint32_t)((uint64_t)hits * 100 / lookups) : 0);
 }
 
 void vfs_ref_node(fs_node_t *node) {
@@ -141,6 +275,10 @@ void vfs_release_node(fs_node_t *node) {
     // 当引用计数为 0 时释放动态分配的节点
     if (node->ref_count == 0) {
         LOG_DEBUG_MSG("vfs_release_node: freeing node %s\n", node->name);
+        // 先移出 inode 缓存，解锁后不会再被查到
+        if (node->flags & FS_NODE_FLAG_ICACHED) {
+            vfs_icache_unhash(node);
+        }
         // 释放之前先解锁，因为释放操作可能需要较长时间
         mutex_unlock(&vfs_refcount_mutex);
         
@@ -163,10 +301,33 @@ struct dirent *vfs_readdir(fs_node_t *node, uint32_t index) {
     }
     
     /* 正常读取（挂载点切换在 vfs_path_to_node 中处理） */
-    if (!node->readdir) {
+    if (!VFS_OP(node, readdir)) {
         return NULL;
     }
-    return node->readdir(node, index);
+    return node->ops->readdir(node, index);
+}
+
+int vfs_iterate_dir(fs_node_t *node, dir_cursor_t *cursor, filldir_t fill, void *ctx) {
+    if (!node || !cursor || !fill || node->type != FS_DIRECTORY) {
+        return -1;
+    }
+    
+    if (VFS_OP(node, iterate)) {
+        return node->ops->iterate(node, cursor, fill, ctx);
+    }
+    if (!VFS_OP(node, readdir)) {
+        return -1;
+    }
+    
+    // 回退：按索引读取（readdir 本身可能需要从头扫描）
+    struct dirent *d;
+    while ((d = node->ops->readdir(node, cursor->index)) != NULL) {
+        if (fill(ctx, d->d_name, d->d_ino, d->d_type) != 0) {
+            break;
+        }
+        cursor->index++;
+    }
+    return 0;
 }
 
 fs_node_t *vfs_finddir(fs_node_t *node, const char *name) {
@@ -182,8 +343,8 @@ fs_node_t *vfs_finddir(fs_node_t *node, const char *name) {
     /* 处理特殊目录条目 '..' - 让文件系统处理，如果文件系统不支持则回退 */
     if (strcmp(name, "..") == 0) {
         /* 首先尝试让文件系统处理 */
-        if (node->finddir) {
-            fs_node_t *parent = node->finddir(node, "..");
+        if (VFS_OP(node, finddir)) {
+            fs_node_t *parent = node->ops->finddir(node, "..");
             if (parent) {
                 return parent;
             }
@@ -198,134 +359,74 @@ fs_node_t *vfs_finddir(fs_node_t *node, const char *name) {
     }
     
     /* 正常查找（挂载点切换在 vfs_path_to_node 中处理） */
-    if (!node->finddir) {
+    if (!VFS_OP(node, finddir)) {
         return NULL;
     }
-    return node->finddir(node, name);
+    return node->ops->finddir(node, name);
 }
 
-// 路径解析：将路径字符串转换为文件节点
-fs_node_t *vfs_path_to_node(const char *path) {
-    if (!path || !fs_root) {
-        return NULL;
+/* 查找路径分量：先查目录项缓存，未命中时调用 finddir 并缓存结果（包括失败） */
+static fs_node_t *vfs_lookup_child(fs_node_t *dir, const char *name) {
+    fs_node_t *child;
+    if (dcache_lookup(dir, name, &child)) {
+        return child;
     }
     
-    // 处理根目录
-    if (strcmp(path, "/") == 0) {
-        return fs_root;
+    child = vfs_finddir(dir, name);
+    if (dir->type == FS_DIRECTORY) {
+        dcache_add(dir, name, child);
     }
+    return child;
+}
+
+static fs_node_t *vfs_walk(const char *path);
+
+/* 挂载树节点对应的目录（".." 回到挂载点之上时使用） */
+static fs_node_t *vfs_mount_node_dir(vfs_mount_node_t *m) {
+    const char *names[MAX_MOUNTS];
+    uint32_t depth = 0;
     
-    /* 检查是否是挂载点或其子路径 */
-    fs_node_t *mounted = vfs_get_mounted_root_by_path(path);
-    if (mounted != NULL) {
-        return mounted;
+    for (; m->parent && depth < MAX_MOUNTS; m = m->parent) {
+        names[depth++] = m->name;
     }
     
-    /* 检查是否是挂载点的子路径（如 /dev/zero） */
-    mutex_lock(&vfs_mount_mutex);
-    for (uint32_t i = 0; i < mount_count; i++) {
-        const char *mount_path = mount_table[i].path;
-        uint32_t mount_len = strlen(mount_path);
-        
-        /* 检查路径是否以挂载点开头，且后面是 / */
-        if (strncmp(path, mount_path, mount_len) == 0 && 
-            (path[mount_len] == '/' || path[mount_len] == '\0')) {
-            
-            /* 如果正好是挂载点，返回根 */
-            if (path[mount_len] == '\0') {
-                mutex_unlock(&vfs_mount_mutex);
-                return mount_table[i].root;
-            }
-            
-            /* 否则，在挂载的根中继续解析剩余路径 */
-            const char *remaining = path + mount_len + 1;  /* 跳过 '/' */
-            
-            fs_node_t *current = mount_table[i].root;
-            char token[128];
-            uint32_t j = 0;
-            
-            while (*remaining) {
-                /* 提取路径组件 */
-                j = 0;
-                while (*remaining && *remaining != '/' && j < 127) {
-                    token[j++] = *remaining++;
-                }
-                
-                if (*remaining && *remaining != '/') {
-                    LOG_ERROR_MSG("VFS: Path component too long\n");
-                    vfs_release_node(current);  // 释放中间节点
-                    mutex_unlock(&vfs_mount_mutex);
-                    return NULL;
-                }
-                
-                token[j] = '\0';
-                
-                /* 跳过连续的 '/' */
-                while (*remaining == '/') {
-                    remaining++;
-                }
-                
-                if (token[0] == '\0') {
-                    continue;
-                }
-                
-                /* 处理 '.' - 跳过，保持在当前目录 */
-                if (strcmp(token, ".") == 0) {
-                    continue;
-                }
-                
-                /* 处理 '..' - 转到父目录 */
-                if (strcmp(token, "..") == 0) {
-                    fs_node_t *parent = vfs_finddir(current, "..");
-                    if (!parent) {
-                        vfs_release_node(current);  // 释放中间节点
-                        mutex_unlock(&vfs_mount_mutex);
-                        return NULL;
-                    }
-                    // 释放旧的 current（如果它是动态分配的且不是根）
-                    if (current != mount_table[i].root) {
-                        vfs_release_node(current);
-                    }
-                    current = parent;
-                    continue;
-                }
-                
-                /* 查找下一个节点 */
-                fs_node_t *next = vfs_finddir(current, token);
-                if (!next) {
-                    // 释放中间节点
-                    if (current != mount_table[i].root) {
-                        vfs_release_node(current);
-                    }
-                    mutex_unlock(&vfs_mount_mutex);
-                    return NULL;
-                }
-                
-                // 释放旧的 current（如果它是动态分配的且不是根）
-                if (current != mount_table[i].root) {
-                    vfs_release_node(current);
-                }
-                current = next;
-            }
-            
-            mutex_unlock(&vfs_mount_mutex);
-            // 如果返回的节点是动态分配的，已经在 finddir 中设置了 ref_count=1
-            return current;
+    char path[256];
+    uint32_t len = 0;
+    path[len++] = '/';
+    while (depth > 0) {
+        const char *n = names[--depth];
+        uint32_t nlen = strlen(n);
+        if (len + nlen + 2 > sizeof(path)) {
+            return NULL;
         }
+        memcpy(path + len, n, nlen);
+        len += nlen;
+        path[len++] = '/';
     }
-    mutex_unlock(&vfs_mount_mutex);
-    
-    /* 正常路径解析（不在任何挂载点下） */
-    // 跳过开头的 '/'
-    if (path[0] == '/') {
-        path++;
-    }
-    
+    path[len] = '\0';
+    return vfs_walk(path);
+}
+
+/*
+ * 逐分量解析路径，同时在挂载树中下行：
+ * mnt 为已匹配的最深挂载树节点，extra 为其后不在挂载树中的分量数
+ */
+static fs_node_t *vfs_walk(const char *path) {
     fs_node_t *current = fs_root;
+    vfs_mount_node_t *mnt = &mount_tree;
+    uint32_t extra = 0;
     char token[128];
     uint32_t i = 0;
     
     while (*path) {
+        // 跳过连续的 '/'
+        while (*path == '/') {
+            path++;
+        }
+        if (*path == '\0') {
+            break;
+        }
+        
         // 提取路径的一部分
         i = 0;
         while (*path && *path != '/' && i < 127) {
@@ -344,41 +445,39 @@ fs_node_t *vfs_path_to_node(const char *path) {
         
         token[i] = '\0';
         
-        // 跳过连续的 '/'
-        while (*path == '/') {
-            path++;
-        }
-        
-        // 如果是空字符串，跳过
-        if (token[0] == '\0') {
-            continue;
-        }
-        
         /* 处理 '.' - 跳过，保持在当前目录 */
         if (strcmp(token, ".") == 0) {
             continue;
         }
         
-        /* 处理 '..' - 转到父目录 */
+        fs_node_t *next;
+        
         if (strcmp(token, "..") == 0) {
-            fs_node_t *parent = vfs_finddir(current, "..");
-            if (!parent) {
-                // 释放中间节点
-                if (current != fs_root) {
-                    vfs_release_node(current);
-                }
-                return NULL;
+            /* 处理 '..' - 转到父目录 */
+            if (extra > 0) {
+                extra--;
+                next = vfs_finddir(current, "..");
+            } else if (mnt->parent) {
+                // 当前目录在挂载树上（可能是挂载根），父目录按挂载树路径重新解析
+                mnt = mnt->parent;
+                next = vfs_mount_node_dir(mnt);
+            } else {
+                next = fs_root;     // 根目录的父目录是自身
             }
-            // 释放旧的 current（如果它是动态分配的且不是根）
-            if (current != fs_root) {
-                vfs_release_node(current);
+        } else {
+            vfs_mount_node_t *child = extra == 0 ? vfs_mount_child(mnt, token) : NULL;
+            fs_node_t *mounted = child ? vfs_mount_root(child) : NULL;
+            
+            if (child) {
+                mnt = child;
+            } else {
+                extra++;
             }
-            current = parent;
-            continue;
+            
+            /* 挂载点：直接进入挂载的文件系统根，不查找被遮盖的目录 */
+            next = mounted ? mounted : vfs_lookup_child(current, token);
         }
         
-        /* 查找下一个节点 */
-        fs_node_t *next = vfs_finddir(current, token);
         if (!next) {
             // 释放中间节点
             if (current != fs_root) {
@@ -398,6 +497,21 @@ fs_node_t *vfs_path_to_node(const char *path) {
     return current;
 }
 
+// 路径解析：将路径字符串转换为文件节点
+// 不获取任何全局锁：挂载树无锁读取，分量查找只锁目录项缓存和各文件系统自身
+fs_node_t *vfs_path_to_node(const char *path) {
+    if (!path || !fs_root) {
+        return NULL;
+    }
+    
+    // 处理根目录
+    if (strcmp(path, "/") == 0) {
+        return fs_root;
+    }
+    
+    return vfs_walk(path);
+}
+
 // 创建文件
 int vfs_create(const char *path) {
     if (!path || !fs_root) {
@@ -442,12 +556,13 @@ int vfs_create(const char *path) {
     }
     
     // 调用父目录的 create 操作
-    if (!parent->create) {
+    if (!VFS_OP(parent, create)) {
         vfs_release_node(parent);  // 释放节点
         return -1;
     }
     
-    int result = parent->create(parent, file_name);
+    int result = parent->ops->create(parent, file_name);
+    dcache_invalidate(parent, file_name);  // 清除负项
     vfs_release_node(parent);  // 释放节点
     return result;
 }
@@ -496,12 +611,13 @@ int vfs_mkdir(const char *path, uint32_t permissions) {
     }
     
     // 调用父目录的 mkdir 操作
-    if (!parent->mkdir) {
+    if (!VFS_OP(parent, mkdir)) {
         vfs_release_node(parent);  // 释放节点
         return -1;
     }
     
-    int result = parent->mkdir(parent, dir_name, permissions);
+    int result = parent->ops->mkdir(parent, dir_name, permissions);
+    dcache_invalidate(parent, dir_name);  // 清除负项
     vfs_release_node(parent);  // 释放节点
     return result;
 }
@@ -555,12 +671,24 @@ int vfs_unlink(const char *path) {
     }
     
     // 调用父目录的 unlink 操作
-    if (!parent->unlink) {
+    if (!VFS_OP(parent, unlink)) {
         vfs_release_node(parent);  // 释放节点
         return -1;
     }
     
-    int result = parent->unlink(parent, file_name);
+    // 文件系统可能在 unlink 中释放目标节点，先摘除缓存中对它的引用；
+    // 目标是目录时，以它为父目录的条目也要摘除（其地址可能被复用）
+    fs_node_t *target = vfs_lookup_child(parent, file_name);
+    if (target && target->type == FS_DIRECTORY) {
+        dcache_invalidate_dir(target);
+    }
+    dcache_invalidate(parent, file_name);
+    // 被删除文件的 inode 编号可能被新文件复用，已打开的节点不再共享
+    vfs_icache_remove(target);
+    vfs_release_node(target);
+    
+    int result = parent->ops->unlink(parent, file_name);
+    dcache_invalidate(parent, file_name);
     vfs_release_node(parent);  // 释放节点
     return result;
 }
@@ -578,8 +706,8 @@ int vfs_truncate(fs_node_t *node, uint32_t new_size) {
     }
     
     // 如果文件系统支持 truncate 操作，调用它
-    if (node->truncate) {
-        return node->truncate(node, new_size);
+    if (VFS_OP(node, truncate)) {
+        return node->ops->truncate(node, new_size);
     }
     
     // 否则，只更新大小（对于简单的内存文件系统）
@@ -676,14 +804,26 @@ int vfs_rename(const char *oldpath, const char *newpath) {
     }
     
     // 检查文件系统是否支持重命名操作
-    if (!parent->rename) {
+    if (!VFS_OP(parent, rename)) {
         LOG_ERROR_MSG("vfs_rename: filesystem does not support rename operation\n");
         vfs_release_node(parent);
         return -1;
     }
     
-    // 调用文件系统的重命名操作
-    int result = parent->rename(parent, old_name, new_name);
+    // 改名后目录项位置可能改变，已打开的节点不再由 inode 缓存共享
+    fs_node_t *old_node = vfs_lookup_child(parent, old_name);
+    vfs_icache_remove(old_node);
+    vfs_release_node(old_node);
+    fs_node_t *new_node = vfs_lookup_child(parent, new_name);
+    vfs_icache_remove(new_node);
+    vfs_release_node(new_node);
+    
+    // 调用文件系统的重命名操作（前后都使两个名字的缓存失效）
+    dcache_invalidate(parent, old_name);
+    dcache_invalidate(parent, new_name);
+    int result = parent->ops->rename(parent, old_name, new_name);
+    dcache_invalidate(parent, old_name);
+    dcache_invalidate(parent, new_name);
     
     vfs_release_node(parent);
     
@@ -696,6 +836,111 @@ int vfs_rename(const char *oldpath, const char *newpath) {
     return result;
 }
 
+/*
+ * 取出下一个路径分量，返回分量之后的位置；路径已结束时 name 为空串。
+ * 分量过长（与 vfs_walk 的限制一致）或为 "."/".." 时返回 NULL：挂载树按名字
+ * 匹配，挂载路径必须是规范路径
+ */
+static const char *vfs_mount_component(const char *path, char *name) {
+    while (*path == '/') {
+        path++;
+    }
+    
+    uint32_t len = 0;
+    while (*path && *path != '/') {
+        if (len >= MAX_MOUNT_NAME - 1) {
+            return NULL;
+        }
+        name[len++] = *path++;
+    }
+    name[len] = '\0';
+    
+    if (strcmp(name, ".") == 0 || strcmp(name, "..") == 0) {
+        return NULL;
+    }
+    return path;
+}
+
+/* 检查挂载路径的每个分量 */
+static bool vfs_mount_path_valid(const char *path) {
+    char name[MAX_MOUNT_NAME];
+    do {
+        path = vfs_mount_component(path, name);
+    } while (path && name[0] != '\0');
+    return path != NULL;
+}
+
+/*
+ * 沿路径分量在挂载树中下行（持有 vfs_mount_mutex），不新建节点
+ * 返回已存在的最深节点，*rest 指向第一个不在树中的分量，全部存在时指向结尾
+ */
+static vfs_mount_node_t *vfs_mount_lookup(const char *path, const char **rest) {
+    vfs_mount_node_t *m = &mount_tree;
+    char name[MAX_MOUNT_NAME];
+    
+    for (;;) {
+        const char *next = vfs_mount_component(path, name);
+        if (!next || name[0] == '\0') {
+            *rest = next ? next : path;
+            return m;
+        }
+        vfs_mount_node_t *child = vfs_mount_child(m, name);
+        if (!child) {
+            *rest = path;
+            return m;
+        }
+        m = child;
+        path = next;
+    }
+}
+
+/*
+ * 为 path 中的分量在 parent 之下新建一条节点链，但不挂入 parent（不发布）
+ * 返回链首，*leaf 为最后一个节点；内存不足时释放已建的节点并返回 NULL
+ */
+static vfs_mount_node_t *vfs_mount_build(vfs_mount_node_t *parent, const char *path,
+                                         vfs_mount_node_t **leaf) {
+    vfs_mount_node_t *top = NULL;
+    vfs_mount_node_t *m = parent;
+    char name[MAX_MOUNT_NAME];
+    
+    for (;;) {
+        path = vfs_mount_component(path, name);
+        if (!path) {
+            goto fail;
+        }
+        if (name[0] == '\0') {
+            break;
+        }
+        
+        vfs_mount_node_t *child = (vfs_mount_node_t *)kmalloc(sizeof(vfs_mount_node_t));
+        if (!child) {
+            goto fail;
+        }
+        memset(child, 0, sizeof(vfs_mount_node_t));
+        strcpy(child->name, name);
+        child->parent = m;
+        if (top) {
+            m->children = child;
+        } else {
+            top = child;
+        }
+        m = child;
+    }
+    
+    *leaf = m;
+    return top;
+    
+fail:
+    // 未发布的链只沿 children 单线相连
+    while (top) {
+        vfs_mount_node_t *next = top->children;
+        kfree(top);
+        top = next;
+    }
+    return NULL;
+}
+
 // 挂载文件系统到指定路径
 int vfs_mount(const char *path, fs_node_t *root) {
     if (!path || !root || !fs_root) {
@@ -703,6 +948,11 @@ int vfs_mount(const char *path, fs_node_t *root) {
         return -1;
     }
     
+    if (!vfs_mount_path_valid(path)) {
+        LOG_ERROR_MSG("VFS: Invalid mount path '%s' (component too long or not canonical)\n", path);
+        return -1;
+    }
+    
     /* 查找挂载点 */
     fs_node_t *mount_point = vfs_path_to_node(path);
     if (!mount_point) {
@@ -719,41 +969,82 @@ int vfs_mount(const char *path, fs_node_t *root) {
     // 验证完成，释放挂载点节点（我们只需要验证路径，不需要保留节点）
     vfs_release_node(mount_point);
     
-    /* 获取挂载表锁，保护后续的检查和修改操作 */
+    /* 串行化挂载操作；路径解析不获取此锁 */
     mutex_lock(&vfs_mount_mutex);
     
-    /* 检查是否已经挂载了文件系统 */
-    bool already_mounted = false;
-    for (uint32_t i = 0; i < mount_count; i++) {
-        if (strcmp(mount_table[i].path, path) == 0) {
-            already_mounted = true;
-            break;
+    if (mount_count >= MAX_MOUNTS) {
+        mutex_unlock(&vfs_mount_mutex);
+        LOG_ERROR_MSG("VFS: Mount table is full (max %u mounts)\n", MAX_MOUNTS);
+        return -1;
+    }
+    
+    // 所有检查都在新建节点之前完成，失败不会在树中留下中间分量
+    const char *rest;
+    vfs_mount_node_t *m = vfs_mount_lookup(path, &rest);
+    
+    if (*rest == '\0') {
+        if (m == &mount_tree) {
+            mutex_unlock(&vfs_mount_mutex);
+            LOG_ERROR_MSG("VFS: Cannot mount on '/', use vfs_set_root\n");
+            return -1;
         }
+        if (m->root) {
+            mutex_unlock(&vfs_mount_mutex);
+            LOG_ERROR_MSG("VFS: Mount point '%s' is already mounted\n", path);
+            return -1;
+        }
+        __atomic_store_n(&m->root, root, __ATOMIC_RELEASE);
+    } else {
+        vfs_mount_node_t *leaf;
+        vfs_mount_node_t *top = vfs_mount_build(m, rest, &leaf);
+        if (!top) {
+            mutex_unlock(&vfs_mount_mutex);
+            LOG_ERROR_MSG("VFS: Failed to allocate mount node\n");
+            return -1;
+        }
+        // 整条链（含挂载的根）初始化完成后一次发布
+        leaf->root = root;
+        top->sibling = m->children;
+        __atomic_store_n(&m->children, top, __ATOMIC_RELEASE);
     }
+    mount_count++;
     
-    if (already_mounted) {
-        mutex_unlock(&vfs_mount_mutex);
-        LOG_ERROR_MSG("VFS: Mount point '%s' is already mounted\n", path);
+    mutex_unlock(&vfs_mount_mutex);
+    
+    // 挂载点遮盖了原目录，清空目录项缓存
+    dcache_flush();
+    
+    LOG_INFO_MSG("VFS: Filesystem mounted at '%s' (root=%p, total_mounts=%u)\n", 
+                 path, root, mount_count);
+    
+    return 0;
+}
+
+// 卸载指定路径上的文件系统
+int vfs_umount(const char *path) {
+    if (!path) {
         return -1;
     }
     
-    /* 检查挂载表是否满 */
-    if (mount_count >= MAX_MOUNTS) {
+    mutex_lock(&vfs_mount_mutex);
+    
+    const char *rest;
+    vfs_mount_node_t *m = vfs_mount_lookup(path, &rest);
+    if (*rest != '\0' || m == &mount_tree || !m->root) {
         mutex_unlock(&vfs_mount_mutex);
-        LOG_ERROR_MSG("VFS: Mount table is full (max %u mounts)\n", MAX_MOUNTS);
+        LOG_ERROR_MSG("VFS: '%s' is not a mount point\n", path);
         return -1;
     }
     
-    /* 添加到挂载表 */
-    strncpy(mount_table[mount_count].path, path, MAX_MOUNT_PATH - 1);
-    mount_table[mount_count].path[MAX_MOUNT_PATH - 1] = '\0';
-    mount_table[mount_count].root = root;
-    mount_count++;
+    // 只清除挂载的根，树节点保留：并发的无锁读者可能正在访问它
+    __atomic_store_n(&m->root, NULL, __ATOMIC_RELEASE);
+    mount_count--;
     
     mutex_unlock(&vfs_mount_mutex);
     
-    LOG_INFO_MSG("VFS: Filesystem mounted at '%s' (root=%p, total_mounts=%u)\n", 
-                 path, root, mount_count);
+    // 缓存中可能有经过挂载点得到的条目
+    dcache_flush();
     
+    LOG_INFO_MSG("VFS: Filesystem unmounted from '%s'\n", path);
     return 0;
 }
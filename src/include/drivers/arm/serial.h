@@ -14,6 +14,19 @@
 
 #include <types.h>
 
+/** TX ring size (power of two) */
+#define SERIAL_TX_RING_SIZE     4096
+
+/**
+ * @brief Transmit statistics
+ */
+typedef struct serial_stats {
+    uint64_t tx_bytes;          /**< Bytes written to the UART */
+    uint32_t tx_dropped;        /**< Bytes dropped because the TX ring was full */
+    uint32_t tx_irqs;           /**< TX interrupts */
+    uint32_t ring_high;         /**< TX ring high-water mark */
+} serial_stats_t;
+
 /* ============================================================================
  * Initialization
  * ========================================================================== */
@@ -98,12 +111,37 @@ bool serial_has_char(void);
 int serial_getchar_nonblock(void);
 
 /**
- * @brief Flush the transmit FIFO
+ * @brief Flush the TX ring and the transmit FIFO
  * 
  * Waits until all pending transmissions are complete.
  */
 void serial_flush(void);
 
+/* ============================================================================
+ * Interrupt-Driven Transmit
+ * ========================================================================== */
+
+/**
+ * @brief Switch to interrupt-driven transmit
+ * 
+ * Call after the interrupt controller is up; output before that is polled.
+ */
+void serial_enable_tx_irq(void);
+
+/**
+ * @brief Enter panic mode
+ * 
+ * Drains the TX ring synchronously; afterwards output is polled without
+ * taking the lock. Interrupts must already be disabled.
+ */
+void serial_panic_mode(void);
+
+/**
+ * @brief Get transmit statistics
+ * @param stats Output
+ */
+void serial_get_stats(serial_stats_t *stats);
+
 /* ============================================================================
  * Hex/Decimal Output Helpers
  * ========================================================================== */
@@ -10,54 +10,8 @@
 #define _DRIVERS_ARM_VIRTIO_GPU_H_
 
 #include <types.h>
-
-/* ============================================================================
- * VirtIO MMIO Register Offsets
- * ========================================================================== */
-
-#define VIRTIO_MMIO_MAGIC_VALUE         0x000
-#define VIRTIO_MMIO_VERSION             0x004
-#define VIRTIO_MMIO_DEVICE_ID           0x008
-#define VIRTIO_MMIO_VENDOR_ID           0x00c
-#define VIRTIO_MMIO_DEVICE_FEATURES     0x010
-#define VIRTIO_MMIO_DEVICE_FEATURES_SEL 0x014
-#define VIRTIO_MMIO_DRIVER_FEATURES     0x020
-#define VIRTIO_MMIO_DRIVER_FEATURES_SEL 0x024
-#define VIRTIO_MMIO_QUEUE_SEL           0x030
-#define VIRTIO_MMIO_QUEUE_NUM_MAX       0x034
-#define VIRTIO_MMIO_QUEUE_NUM           0x038
-#define VIRTIO_MMIO_QUEUE_READY         0x044
-#define VIRTIO_MMIO_QUEUE_NOTIFY        0x050
-#define VIRTIO_MMIO_INTERRUPT_STATUS    0x060
-#define VIRTIO_MMIO_INTERRUPT_ACK       0x064
-#define VIRTIO_MMIO_STATUS              0x070
-#define VIRTIO_MMIO_QUEUE_DESC_LOW      0x080
-#define VIRTIO_MMIO_QUEUE_DESC_HIGH     0x084
-#define VIRTIO_MMIO_QUEUE_AVAIL_LOW     0x090
-#define VIRTIO_MMIO_QUEUE_AVAIL_HIGH    0x094
-#define VIRTIO_MMIO_QUEUE_USED_LOW      0x0a0
-#define VIRTIO_MMIO_QUEUE_USED_HIGH     0x0a4
-
-/* Legacy (v1) specific registers */
-#define VIRTIO_MMIO_GUEST_PAGE_SIZE     0x028
-#define VIRTIO_MMIO_QUEUE_PFN           0x040
-#define VIRTIO_MMIO_QUEUE_ALIGN         0x03c
-
-/* VirtIO Magic Value */
-#define VIRTIO_MMIO_MAGIC               0x74726976  /* "virt" */
-
-/* VirtIO Device IDs */
-#define VIRTIO_DEV_NET                  1
-#define VIRTIO_DEV_BLK                  2
-#define VIRTIO_DEV_CONSOLE              3
-#define VIRTIO_DEV_GPU                  16
-
-/* VirtIO Status Bits */
-#define VIRTIO_STATUS_ACKNOWLEDGE       1
-#define VIRTIO_STATUS_DRIVER            2
-#define VIRTIO_STATUS_DRIVER_OK         4
-#define VIRTIO_STATUS_FEATURES_OK       8
-#define VIRTIO_STATUS_FAILED            128
+#include <drivers/common/virtio.h>
+#include <drivers/common/virtqueue.h>
 
 /* ============================================================================
  * VirtIO GPU Command Types
@@ -167,37 +121,6 @@ struct virtio_gpu_resource_flush {
     uint32_t padding;
 } __attribute__((packed));
 
-/* ============================================================================
- * VirtIO Queue Structures
- * ========================================================================== */
-
-#define VIRTQ_DESC_F_NEXT       1
-#define VIRTQ_DESC_F_WRITE      2
-
-struct virtq_desc {
-    uint64_t addr;
-    uint32_t len;
-    uint16_t flags;
-    uint16_t next;
-} __attribute__((packed));
-
-struct virtq_avail {
-    uint16_t flags;
-    uint16_t idx;
-    uint16_t ring[];
-} __attribute__((packed));
-
-struct virtq_used_elem {
-    uint32_t id;
-    uint32_t len;
-} __attribute__((packed));
-
-struct virtq_used {
-    uint16_t flags;
-    uint16_t idx;
-    struct virtq_used_elem ring[];
-} __attribute__((packed));
-
 /* ============================================================================
  * Public API
  * ========================================================================== */
@@ -16,6 +16,7 @@
 #include <types.h>
 
 static inline void ata_init(void) {}
+static inline void ata_set_dma_enabled(bool enabled) { (void)enabled; }
 
 #endif
 
@@ -0,0 +1,167 @@
+/**
+ * @file virtio.h
+ * @brief VirtIO 设备公共定义与传输层抽象
+ *
+ * 同一个驱动（virtio-blk 等）可以运行在两种传输层之上：
+ *   - x86: 过渡（transitional）PCI 设备的 legacy I/O 端口接口（BAR0）
+ *   - arm64: virtio-mmio（v1 legacy 与 v2 modern），由设备树发现
+ *
+ * 传输层通过 virtio_transport_ops_t 提供状态、特性协商、配置空间、
+ * 队列建立、通知和中断应答；虚拟队列本身见 virtqueue.h。
+ */
+
+#ifndef _DRIVERS_COMMON_VIRTIO_H_
+#define _DRIVERS_COMMON_VIRTIO_H_
+
+#include <types.h>
+
+/* ============================================================================
+ * VirtIO MMIO 寄存器偏移
+ * ========================================================================== */
+
+#define VIRTIO_MMIO_MAGIC_VALUE         0x000
+#define VIRTIO_MMIO_VERSION             0x004
+#define VIRTIO_MMIO_DEVICE_ID           0x008
+#define VIRTIO_MMIO_VENDOR_ID           0x00c
+#define VIRTIO_MMIO_DEVICE_FEATURES     0x010
+#define VIRTIO_MMIO_DEVICE_FEATURES_SEL 0x014
+#define VIRTIO_MMIO_DRIVER_FEATURES     0x020
+#define VIRTIO_MMIO_DRIVER_FEATURES_SEL 0x024
+#define VIRTIO_MMIO_QUEUE_SEL           0x030
+#define VIRTIO_MMIO_QUEUE_NUM_MAX       0x034
+#define VIRTIO_MMIO_QUEUE_NUM           0x038
+#define VIRTIO_MMIO_QUEUE_READY         0x044
+#define VIRTIO_MMIO_QUEUE_NOTIFY        0x050
+#define VIRTIO_MMIO_INTERRUPT_STATUS    0x060
+#define VIRTIO_MMIO_INTERRUPT_ACK       0x064
+#define VIRTIO_MMIO_STATUS              0x070
+#define VIRTIO_MMIO_QUEUE_DESC_LOW      0x080
+#define VIRTIO_MMIO_QUEUE_DESC_HIGH     0x084
+#define VIRTIO_MMIO_QUEUE_AVAIL_LOW     0x090
+#define VIRTIO_MMIO_QUEUE_AVAIL_HIGH    0x094
+#define VIRTIO_MMIO_QUEUE_USED_LOW      0x0a0
+#define VIRTIO_MMIO_QUEUE_USED_HIGH     0x0a4
+#define VIRTIO_MMIO_CONFIG              0x100
+
+/* Legacy (v1) specific registers */
+#define VIRTIO_MMIO_GUEST_PAGE_SIZE     0x028
+#define VIRTIO_MMIO_QUEUE_PFN           0x040
+#define VIRTIO_MMIO_QUEUE_ALIGN         0x03c
+
+/* VirtIO Magic Value */
+#define VIRTIO_MMIO_MAGIC               0x74726976  /* "virt" */
+
+/* ============================================================================
+ * VirtIO legacy PCI 寄存器（BAR0 I/O 端口，未启用 MSI-X）
+ * ========================================================================== */
+
+#define VIRTIO_PCI_VENDOR_ID            0x1AF4
+#define VIRTIO_PCI_DEVICE_MIN           0x1000  /* 过渡设备 ID 范围 */
+#define VIRTIO_PCI_DEVICE_MAX           0x103F
+
+#define VIRTIO_PCI_HOST_FEATURES        0x00    /* 32 位，只读 */
+#define VIRTIO_PCI_GUEST_FEATURES       0x04    /* 32 位 */
+#define VIRTIO_PCI_QUEUE_PFN            0x08    /* 32 位，队列物理页号 */
+#define VIRTIO_PCI_QUEUE_NUM            0x0C    /* 16 位，只读 */
+#define VIRTIO_PCI_QUEUE_SEL            0x0E    /* 16 位 */
+#define VIRTIO_PCI_QUEUE_NOTIFY         0x10    /* 16 位 */
+#define VIRTIO_PCI_STATUS               0x12    /* 8 位 */
+#define VIRTIO_PCI_ISR                  0x13    /* 8 位，读清零 */
+#define VIRTIO_PCI_CONFIG               0x14    /* 设备配置空间 */
+
+/* ============================================================================
+ * 设备类型、状态与特性位
+ * ========================================================================== */
+
+/* VirtIO Device IDs */
+#define VIRTIO_DEV_NET                  1
+#define VIRTIO_DEV_BLK                  2
+#define VIRTIO_DEV_CONSOLE              3
+#define VIRTIO_DEV_GPU                  16
+
+/* VirtIO Status Bits */
+#define VIRTIO_STATUS_ACKNOWLEDGE       1
+#define VIRTIO_STATUS_DRIVER            2
+#define VIRTIO_STATUS_DRIVER_OK         4
+#define VIRTIO_STATUS_FEATURES_OK       8
+#define VIRTIO_STATUS_FAILED            128
+
+/* 与设备类型无关的特性位 */
+#define VIRTIO_F_INDIRECT_DESC          28      /* 间接描述符表 */
+#define VIRTIO_F_EVENT_IDX              29      /* used_event / avail_event 通知抑制 */
+#define VIRTIO_F_VERSION_1              32      /* modern 设备必须协商 */
+
+#define VIRTIO_FEATURE(bit)             (1ULL << (bit))
+
+/* ISR 状态位 */
+#define VIRTIO_ISR_QUEUE                0x1
+#define VIRTIO_ISR_CONFIG               0x2
+
+/* ============================================================================
+ * 传输层抽象
+ * ========================================================================== */
+
+struct virtio_device;
+struct virtqueue;
+
+typedef struct virtio_transport_ops {
+    uint8_t  (*get_status)(struct virtio_device *vdev);
+    void     (*set_status)(struct virtio_device *vdev, uint8_t status);
+    uint64_t (*get_features)(struct virtio_device *vdev);
+    void     (*set_features)(struct virtio_device *vdev, uint64_t features);
+    uint8_t  (*read_config8)(struct virtio_device *vdev, uint32_t offset);
+    void     (*write_config8)(struct virtio_device *vdev, uint32_t offset, uint8_t value);
+    /* 返回要使用的队列大小（legacy PCI 不能修改大小），0 表示队列不存在 */
+    uint16_t (*queue_size)(struct virtio_device *vdev, uint16_t index);
+    int      (*queue_setup)(struct virtio_device *vdev, struct virtqueue *vq);
+    void     (*notify)(struct virtio_device *vdev, uint16_t index);
+    /* 读取并应答中断状态，返回 VIRTIO_ISR_* */
+    uint32_t (*ack_interrupt)(struct virtio_device *vdev);
+    /* 安装 vdev->irq_handler 并打开中断线 */
+    int      (*enable_irq)(struct virtio_device *vdev);
+} virtio_transport_ops_t;
+
+typedef struct virtio_device {
+    char name[16];                      // 传输层名称，如 "pci0:4.0"、"mmio@a003e00"
+    const virtio_transport_ops_t *ops;
+    uint32_t device_id;                 // VIRTIO_DEV_*
+    uint64_t features;                  // 协商后的特性
+    bool legacy;                        // legacy 接口：特性只有低 32 位
+    uintptr_t base;                     // I/O 端口基址或 MMIO 虚拟地址
+    uint32_t irq;
+    void (*irq_handler)(struct virtio_device *vdev);  // 由驱动设置
+    void *priv;                         // 驱动私有数据
+} virtio_device_t;
+
+/* 探测回调：返回 0 表示驱动接管了该设备 */
+typedef int (*virtio_probe_t)(virtio_device_t *vdev);
+
+/**
+ * 枚举本架构传输层上类型为 device_id 的设备，逐个调用 probe
+ * （x86 实现在 drivers/x86/virtio_pci.c，arm64 在 drivers/arm/virtio_mmio.c）
+ * @return 被驱动接管的设备数
+ */
+int virtio_scan(uint32_t device_id, virtio_probe_t probe);
+
+/* 复位设备并设置 ACKNOWLEDGE | DRIVER */
+void virtio_reset(virtio_device_t *vdev);
+
+/**
+ * 协商特性：取设备特性与 wanted 的交集（modern 设备总是加上 VERSION_1），
+ * 需要时设置 FEATURES_OK 并确认
+ * @return 0 成功，-1 设备不接受
+ */
+int virtio_negotiate(virtio_device_t *vdev, uint64_t wanted);
+
+static inline bool virtio_has_feature(const virtio_device_t *vdev, uint32_t bit) {
+    return (vdev->features & VIRTIO_FEATURE(bit)) != 0;
+}
+
+void virtio_driver_ok(virtio_device_t *vdev);
+void virtio_fail(virtio_device_t *vdev);
+
+/* 按小端读取设备配置空间 */
+uint32_t virtio_config_read32(virtio_device_t *vdev, uint32_t offset);
+uint64_t virtio_config_read64(virtio_device_t *vdev, uint32_t offset);
+
+#endif /* _DRIVERS_COMMON_VIRTIO_H_ */
@@ -0,0 +1,64 @@
+/**
+ * @file virtio_blk.h
+ * @brief VirtIO 块设备驱动
+ *
+ * 每个 virtio-blk 设备注册为 blockdev（vda、vdb ...），扇区固定 512 字节。
+ * 读写经块设备请求队列合并排序后异步提交，一轮派发的请求全部入环后只
+ * 通知设备一次，多个请求同时在设备上执行。完成由中断回收，中断缺失时
+ * 等待者按时间片轮询回收。
+ */
+
+#ifndef _DRIVERS_COMMON_VIRTIO_BLK_H_
+#define _DRIVERS_COMMON_VIRTIO_BLK_H_
+
+#include <types.h>
+
+/* 设备特性位 */
+#define VIRTIO_BLK_F_SIZE_MAX       1
+#define VIRTIO_BLK_F_SEG_MAX        2
+#define VIRTIO_BLK_F_RO             5
+#define VIRTIO_BLK_F_BLK_SIZE       6
+#define VIRTIO_BLK_F_FLUSH          9
+
+/* 配置空间偏移 */
+#define VIRTIO_BLK_CFG_CAPACITY     0       // 64 位，以 512 字节扇区计
+#define VIRTIO_BLK_CFG_SIZE_MAX     8       // 32 位，单段最大字节数
+#define VIRTIO_BLK_CFG_SEG_MAX      12      // 32 位，单请求最大段数
+#define VIRTIO_BLK_CFG_BLK_SIZE     20      // 32 位
+
+/* 请求类型与状态 */
+#define VIRTIO_BLK_T_IN             0
+#define VIRTIO_BLK_T_OUT            1
+#define VIRTIO_BLK_T_FLUSH          4
+
+#define VIRTIO_BLK_S_OK             0
+#define VIRTIO_BLK_S_IOERR          1
+#define VIRTIO_BLK_S_UNSUPP         2
+
+#define VIRTIO_BLK_SECTOR_SIZE      512
+#define VIRTIO_BLK_MAX_DEVICES      4
+#define VIRTIO_BLK_MAX_REQS         64          // 每个设备同时在途的请求数上限
+#define VIRTIO_BLK_REQ_MAX_BYTES    (64 * 1024) // 单个请求的最大数据量
+
+typedef struct virtio_blk_stats {
+    uint32_t requests;          // 提交的请求数
+    uint32_t max_inflight;      // 同时在途请求数的峰值
+    uint32_t kicks;             // 实际通知设备的次数
+    uint32_t kicks_suppressed;  // 被事件索引/NO_NOTIFY 省去的通知
+    uint32_t irqs;              // 完成中断次数
+    uint32_t errors;
+} virtio_blk_stats_t;
+
+/**
+ * 枚举 virtio-blk 设备并注册为块设备
+ * @return 注册的设备数
+ */
+int virtio_blk_init(void);
+
+/**
+ * 读取设备统计（name 为块设备名，如 "vda"）
+ * @return 0 成功，-1 设备不存在
+ */
+int virtio_blk_get_stats(const char *name, virtio_blk_stats_t *stats);
+
+#endif /* _DRIVERS_COMMON_VIRTIO_BLK_H_ */
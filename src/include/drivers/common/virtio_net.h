@@ -0,0 +1,87 @@
+/**
+ * @file virtio_net.h
+ * @brief VirtIO 网卡驱动
+ *
+ * 每个 virtio-net 设备注册为 netdev（ethN，接在已有网卡之后编号）。
+ * 接收队列预先挂满池缓冲区，设备直接写入，单缓冲区的包零拷贝上交；
+ * 协商 MRG_RXBUF 后一个包可以跨多个缓冲区，由驱动合并。发送时数据段
+ * 直接指向 netbuf，包头单独一段；发送完成不发中断，在下一次发送时回收。
+ *
+ * 卸载：CSUM 对应 NETDEV_F_HW_CSUM，HOST_TSO4/6 对应 NETDEV_F_TSO，
+ * GUEST_CSUM 让设备标记已验证的接收包。
+ */
+
+#ifndef _DRIVERS_COMMON_VIRTIO_NET_H_
+#define _DRIVERS_COMMON_VIRTIO_NET_H_
+
+#include <types.h>
+
+/* 设备特性位 */
+#define VIRTIO_NET_F_CSUM           0       // 设备可完成发送校验和
+#define VIRTIO_NET_F_GUEST_CSUM     1       // 驱动接受部分校验和 / 已验证标记
+#define VIRTIO_NET_F_MAC            5
+#define VIRTIO_NET_F_GUEST_TSO4     7
+#define VIRTIO_NET_F_HOST_TSO4      11
+#define VIRTIO_NET_F_HOST_TSO6      12
+#define VIRTIO_NET_F_MRG_RXBUF      15
+#define VIRTIO_NET_F_STATUS         16
+
+/* 配置空间 */
+#define VIRTIO_NET_CFG_MAC          0
+#define VIRTIO_NET_CFG_STATUS       6
+#define VIRTIO_NET_S_LINK_UP        1
+
+/* 包头 */
+#define VIRTIO_NET_HDR_F_NEEDS_CSUM 1
+#define VIRTIO_NET_HDR_F_DATA_VALID 2
+
+#define VIRTIO_NET_HDR_GSO_NONE     0
+#define VIRTIO_NET_HDR_GSO_TCPV4    1
+#define VIRTIO_NET_HDR_GSO_TCPV6    4
+
+typedef struct virtio_net_hdr {
+    uint8_t flags;
+    uint8_t gso_type;
+    uint16_t hdr_len;           // 以太网 + IP + TCP 头长度（GSO）
+    uint16_t gso_size;
+    uint16_t csum_start;        // 相对帧起点
+    uint16_t csum_offset;       // 相对 csum_start
+    uint16_t num_buffers;       // 仅 MRG_RXBUF 或 VERSION_1
+} __attribute__((packed)) virtio_net_hdr_t;
+
+#define VIRTIO_NET_HDR_LEGACY_LEN   10      // 不含 num_buffers
+
+#define VIRTIO_NET_MAX_DEVICES      2
+#define VIRTIO_NET_RXQ              0
+#define VIRTIO_NET_TXQ              1
+
+typedef struct virtio_net_stats {
+    uint64_t rx_packets;
+    uint64_t rx_zero_copy;      // 环上缓冲区直接上交
+    uint64_t rx_copied;         // 池耗尽时复制
+    uint64_t rx_merged;         // 跨多个缓冲区的包
+    uint64_t rx_csum_valid;     // 设备已验证校验和
+    uint64_t rx_dropped;
+    uint64_t tx_packets;
+    uint64_t tx_csum_offload;
+    uint64_t tx_tso;
+    uint64_t tx_ring_full;
+    uint32_t irqs;
+    uint32_t rx_kicks;
+    uint32_t tx_kicks;
+    uint32_t tx_kicks_suppressed;
+} virtio_net_stats_t;
+
+/**
+ * 枚举 virtio-net 设备并注册为网络设备
+ * @return 注册的设备数
+ */
+int virtio_net_init(void);
+
+/**
+ * 读取设备统计（name 为网络设备名）
+ * @return 0 成功，-1 设备不存在
+ */
+int virtio_net_get_stats(const char *name, virtio_net_stats_t *stats);
+
+#endif /* _DRIVERS_COMMON_VIRTIO_NET_H_ */
@@ -0,0 +1,168 @@
+/**
+ * @file virtqueue.h
+ * @brief VirtIO 分离式虚拟队列（split virtqueue）
+ *
+ * 队列内存按 legacy 布局一次分配：描述符表和可用环在前，已用环从下一个
+ * 4KB 边界开始，因此同一份内存可以交给 legacy PCI（队列页号）、
+ * virtio-mmio v1（页号 + 对齐）和 v2（三个独立地址）。
+ *
+ * - 间接描述符：协商 VIRTIO_F_INDIRECT_DESC 后，多段请求只占用环上的
+ *   一个描述符，段表放在该描述符专属的间接表中，队列深度等于环大小
+ * - 通知抑制：协商 VIRTIO_F_EVENT_IDX 后按 avail_event / used_event
+ *   判断是否需要通知设备、设备是否需要发中断；否则退回 NO_NOTIFY /
+ *   NO_INTERRUPT 标志
+ *
+ * 并发：add / kick_prepare / get_used / enable_cb 由调用者持有 vq->lock
+ * （中断处理程序也会回收，须用 irqsave）；notify 可以在锁外调用。
+ *
+ * QEMU 的 virtio 设备与 CPU 缓存一致，队列和数据缓冲区都不做缓存维护，
+ * 只用内存屏障保证发布顺序。
+ */
+
+#ifndef _DRIVERS_COMMON_VIRTQUEUE_H_
+#define _DRIVERS_COMMON_VIRTQUEUE_H_
+
+#include <types.h>
+#include <drivers/common/virtio.h>
+#include <kernel/sync/spinlock.h>
+#include <mm/mm_types.h>
+
+#define VIRTQ_DESC_F_NEXT       1
+#define VIRTQ_DESC_F_WRITE      2
+#define VIRTQ_DESC_F_INDIRECT   4
+
+#define VIRTQ_AVAIL_F_NO_INTERRUPT  1
+#define VIRTQ_USED_F_NO_NOTIFY      1
+
+#define VIRTQ_ALIGN             4096    // 已用环对齐（legacy 要求）
+#define VIRTQ_MAX_SIZE          256     // 支持的最大环大小
+#define VIRTQ_INDIRECT_MAX      32      // 每个间接表的描述符数（512 字节）
+
+struct virtq_desc {
+    uint64_t addr;
+    uint32_t len;
+    uint16_t flags;
+    uint16_t next;
+} __attribute__((packed));
+
+struct virtq_avail {
+    uint16_t flags;
+    uint16_t idx;
+    uint16_t ring[];
+    /* 其后：uint16_t used_event（EVENT_IDX） */
+} __attribute__((packed));
+
+struct virtq_used_elem {
+    uint32_t id;
+    uint32_t len;
+} __attribute__((packed));
+
+struct virtq_used {
+    uint16_t flags;
+    uint16_t idx;
+    struct virtq_used_elem ring[];
+    /* 其后：uint16_t avail_event（EVENT_IDX） */
+} __attribute__((packed));
+
+/* 一段缓冲区（物理地址） */
+typedef struct virtq_sg {
+    uint64_t addr;
+    uint32_t len;
+} virtq_sg_t;
+
+typedef struct virtqueue {
+    virtio_device_t *vdev;
+    uint16_t index;
+    uint16_t num;                       // 环大小（2 的幂）
+
+    volatile struct virtq_desc *desc;
+    volatile struct virtq_avail *avail;
+    volatile struct virtq_used *used;
+    paddr_t ring_phys;                  // 描述符表物理地址（整个队列内存的起点）
+    paddr_t avail_phys;
+    paddr_t used_phys;
+    uint32_t ring_pages;
+
+    struct virtq_desc *indirect;        // num 个间接表，第 i 个属于头描述符 i
+    paddr_t indirect_phys;
+    uint32_t indirect_pages;
+
+    bool use_indirect;
+    bool use_event_idx;
+    bool cb_enabled;                    // 是否希望设备在完成时发中断
+
+    uint16_t free_head;                 // 空闲描述符链
+    uint16_t num_free;
+    uint16_t avail_idx;                 // 已发布的可用环索引（影子）
+    uint16_t kicked_idx;                // 上次通知设备时的可用环索引
+    uint16_t last_used;                 // 已回收到的已用环索引
+    void **tokens;                      // 按头描述符记录调用者的令牌
+
+    spinlock_t lock;
+
+    /* 统计 */
+    uint32_t kicks;                     // 实际通知次数
+    uint32_t kicks_suppressed;          // 因通知抑制省去的次数
+} virtqueue_t;
+
+/**
+ * 建立第 index 个队列：分配队列内存、按协商的特性启用间接描述符与
+ * 事件索引，并交给传输层登记
+ * @return 0 成功，-1 失败
+ */
+int virtqueue_init(virtqueue_t *vq, virtio_device_t *vdev, uint16_t index);
+
+/* 释放队列内存（设备须已复位） */
+void virtqueue_destroy(virtqueue_t *vq);
+
+/**
+ * 提交一个请求：sg[0..out) 由设备读，sg[out..out+in) 由设备写
+ * @param token 请求完成时由 virtqueue_get_used 返回，不能为 NULL
+ * @return 0 成功，-1 描述符不足（等待回收后重试）
+ */
+int virtqueue_add(virtqueue_t *vq, const virtq_sg_t *sg, uint16_t out, uint16_t in,
+                  void *token);
+
+/**
+ * 发布新的可用项并判断设备是否需要通知
+ * @return true 需要调用 virtqueue_notify
+ */
+bool virtqueue_kick_prepare(virtqueue_t *vq);
+
+/* 通知设备（写通知寄存器，可在锁外调用） */
+void virtqueue_notify(virtqueue_t *vq);
+
+/**
+ * 回收一个已完成的请求
+ * @param len 输出设备写入的字节数（可为 NULL）
+ * @return 提交时的令牌，没有已完成的请求时返回 NULL
+ */
+void *virtqueue_get_used(virtqueue_t *vq, uint32_t *len);
+
+/* 是否有尚未回收的已完成请求 */
+bool virtqueue_has_used(virtqueue_t *vq);
+
+/* 请求设备在下一次完成时发中断 */
+void virtqueue_enable_cb(virtqueue_t *vq);
+
+/* 请求设备暂不发中断（轮询回收期间） */
+void virtqueue_disable_cb(virtqueue_t *vq);
+
+/**
+ * 事件索引判定：已发布到 new_idx（上次 old_idx），对方请求在越过
+ * event_idx 时通知，返回是否需要通知
+ */
+static inline bool virtq_need_event(uint16_t event_idx, uint16_t new_idx, uint16_t old_idx) {
+    return (uint16_t)(new_idx - event_idx - 1) < (uint16_t)(new_idx - old_idx);
+}
+
+/* 队列内存中 used_event / avail_event 的位置 */
+static inline volatile uint16_t *virtq_used_event(virtqueue_t *vq) {
+    return (volatile uint16_t *)((volatile uint8_t *)vq->avail + 4 + 2 * vq->num);
+}
+
+static inline volatile uint16_t *virtq_avail_event(virtqueue_t *vq) {
+    return (volatile uint16_t *)((volatile uint8_t *)vq->used + 4 + 8 * vq->num);
+}
+
+#endif /* _DRIVERS_COMMON_VIRTQUEUE_H_ */
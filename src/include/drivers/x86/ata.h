@@ -1,8 +1,10 @@
 #ifndef _DRIVERS_X86_ATA_H_
 #define _DRIVERS_X86_ATA_H_
 
+#include <types.h>
+
 /**
- * ATA 驱动（PIO 模式）
+ * ATA 驱动（总线主控 DMA，PIO 回退）
  *
  * 提供对标准 IDE/ATA 硬盘的读写支持，并将其注册为 blockdev 设备。
  * 支持最多 4 个设备：
@@ -17,6 +19,11 @@
  */
 void ata_init(void);
 
+/**
+ * 允许或禁止使用 DMA（禁止后所有传输走 PIO，用于对比测试和排查问题）
+ */
+void ata_set_dma_enabled(bool enabled);
+
 #endif /* _DRIVERS_X86_ATA_H_ */
 
 
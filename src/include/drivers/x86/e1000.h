@@ -57,6 +57,8 @@
 #define E1000_REG_RDH       0x2810      ///< RX 描述符头
 #define E1000_REG_RDT       0x2818      ///< RX 描述符尾
 #define E1000_REG_RDTR      0x2820      ///< RX 延迟定时器
+#define E1000_REG_RADV      0x282C      ///< RX 绝对延迟定时器
+#define E1000_REG_RXCSUM    0x5000      ///< RX 校验和控制
 
 /* 发送寄存器 */
 #define E1000_REG_TCTL      0x0400      ///< 发送控制
@@ -145,6 +147,10 @@
 #define E1000_RCTL_BSEX     (1 << 25)   ///< 缓冲区大小扩展
 #define E1000_RCTL_SECRC    (1 << 26)   ///< 剥离以太网 CRC
 
+/* RXCSUM 寄存器位 */
+#define E1000_RXCSUM_IPOFL  (1 << 8)    ///< IP 头校验和卸载
+#define E1000_RXCSUM_TUOFL  (1 << 9)    ///< TCP/UDP 校验和卸载
+
 /* ============================================================================
  * 发送控制寄存器位
  * ============================================================================ */
@@ -161,6 +167,25 @@
 #define E1000_TIPG_IPGR1    8           ///< IPG 接收时间 1
 #define E1000_TIPG_IPGR2    6           ///< IPG 接收时间 2
 
+/* ============================================================================
+ * 中断节流（ITR 单位 256ns，RDTR/RADV 单位 1.024us）
+ * ============================================================================ */
+
+#define E1000_RDTR_FPD      (1u << 31)  ///< 立即刷新挂起的 RX 描述符
+
+/**
+ * @brief 中断节流档位（根据收发包速率自适应选择）
+ */
+typedef enum {
+    E1000_ITR_LOWEST_LATENCY = 0,   ///< 低速率：不节流，每包中断
+    E1000_ITR_LOW_LATENCY,          ///< 中速率：约 20000 次/秒
+    E1000_ITR_BULK,                 ///< 高速率：约 4000 次/秒，批量收包
+} e1000_itr_profile_t;
+
+#define E1000_ITR_LOW_PPS       2000    ///< 低于此速率使用 LOWEST_LATENCY
+#define E1000_ITR_BULK_PPS      20000   ///< 高于此速率使用 BULK
+#define E1000_ITR_VAL(ints)     (1000000000u / ((ints) * 256u)) ///< 每秒中断数换算为 ITR 值
+
 /* ============================================================================
  * 描述符定义
  * ============================================================================ */
@@ -186,6 +211,15 @@ typedef struct e1000_rx_desc {
 #define E1000_RXD_STAT_IPCS (1 << 6)    ///< IP 校验和已计算
 #define E1000_RXD_STAT_PIF  (1 << 7)    ///< 传递完整帧
 
+/* 接收描述符错误位 */
+#define E1000_RXD_ERR_CE    (1 << 0)    ///< CRC 错误
+#define E1000_RXD_ERR_SE    (1 << 1)    ///< 符号错误
+#define E1000_RXD_ERR_SEQ   (1 << 2)    ///< 序列错误
+#define E1000_RXD_ERR_CXE   (1 << 4)    ///< 载波扩展错误
+#define E1000_RXD_ERR_TCPE  (1 << 5)    ///< TCP/UDP 校验和错误
+#define E1000_RXD_ERR_IPE   (1 << 6)    ///< IP 校验和错误
+#define E1000_RXD_ERR_RXE   (1 << 7)    ///< RX 数据错误
+
 /**
  * @brief 发送描述符（Legacy 格式）
  */
@@ -208,6 +242,36 @@ typedef struct e1000_tx_desc {
 #define E1000_TXD_CMD_VLE   (1 << 6)    ///< VLAN 包启用
 #define E1000_TXD_CMD_IDE   (1 << 7)    ///< 中断延迟启用
 
+/*
+ * 扩展数据描述符（DEXT=1, DTYP=0001）与 Legacy 格式布局相同，
+ * 只是 cso 字段的高 4 位为 DTYP、css 字段变为 POPTS
+ */
+#define E1000_TXD_DTYP_DATA     0x10    ///< cso 字段：扩展数据描述符类型
+#define E1000_TXD_POPTS_IXSM    0x01    ///< css 字段：插入 IP 校验和
+#define E1000_TXD_POPTS_TXSM    0x02    ///< css 字段：插入 TCP/UDP 校验和
+
+/**
+ * @brief 发送上下文描述符（DEXT=1, DTYP=0000）
+ * 
+ * 为后续数据描述符设置校验和卸载参数，硬件缓存直到下一个上下文描述符。
+ */
+typedef struct e1000_tx_context_desc {
+    uint8_t  ipcss;             ///< IP 校验和起点
+    uint8_t  ipcso;             ///< IP 校验和字段偏移
+    uint16_t ipcse;             ///< IP 校验和终点（含）
+    uint8_t  tucss;             ///< TCP/UDP 校验和起点
+    uint8_t  tucso;             ///< TCP/UDP 校验和字段偏移
+    uint16_t tucse;             ///< TCP/UDP 校验和终点（0 表示到包尾）
+    uint16_t paylen;            ///< 载荷长度（仅 TSO）
+    uint8_t  dtyp;              ///< 低 4 位为 PAYLEN 高位，高 4 位为 DTYP（0000）
+    uint8_t  tucmd;             ///< 命令（与数据描述符 cmd 位置相同）
+    uint8_t  status;            ///< 状态
+    uint8_t  hdr_len;           ///< 头部长度（仅 TSO）
+    uint16_t mss;               ///< 最大段长（仅 TSO）
+} __attribute__((packed)) e1000_tx_context_desc_t;
+
+#define E1000_TXD_TUCMD_IP  (1 << 1)    ///< 上下文：IPv4 数据包
+
 /* 发送描述符状态位 */
 #define E1000_TXD_STAT_DD   (1 << 0)    ///< 描述符完成
 #define E1000_TXD_STAT_EC   (1 << 1)    ///< 过多冲突
@@ -218,9 +282,15 @@ typedef struct e1000_tx_desc {
  * 驱动配置
  * ============================================================================ */
 
-#define E1000_NUM_RX_DESC   32          ///< 接收描述符数量（必须是 8 的倍数）
-#define E1000_NUM_TX_DESC   32          ///< 发送描述符数量（必须是 8 的倍数）
+/* 描述符数量可通过启动参数 e1000.rx_ring=N / e1000.tx_ring=N 调整（8 的倍数） */
+#define E1000_DEFAULT_RX_DESC   256     ///< 默认接收描述符数量
+#define E1000_DEFAULT_TX_DESC   256     ///< 默认发送描述符数量
+#define E1000_MIN_DESC      8           ///< 描述符数量下限（RDLEN/TDLEN 须为 128 字节的倍数）
+#define E1000_MAX_DESC      4096        ///< 描述符数量上限
 #define E1000_RX_BUFFER_SIZE 2048       ///< 接收缓冲区大小
+#define E1000_RX_TAIL_BATCH 16          ///< 收包时每归还这么多描述符才写一次 RDT
+#define E1000_TX_MAX_SEGS   (2 + NETBUF_MAX_FRAGS) ///< 单个数据包最多占用的 TX 描述符数（线性区跨页拆分 + 分片）
+#define E1000_RATE_INTERVAL_MS 1000     ///< 速率统计采样间隔
 
 /* ============================================================================
  * 设备结构
@@ -242,16 +312,22 @@ typedef struct e1000_device {
     uint8_t mac_addr[6];
     
     /* 接收描述符环 */
-    e1000_rx_desc_t *rx_descs;          ///< 描述符数组（物理地址对齐）
+    e1000_rx_desc_t *rx_descs;          ///< 描述符数组（物理连续页帧）
     uint32_t rx_descs_phys;              ///< 描述符数组物理地址
-    uint8_t *rx_buffers[E1000_NUM_RX_DESC]; ///< 接收缓冲区数组
+    uint32_t num_rx_desc;                ///< 接收描述符数量
+    netbuf_t **rx_bufs;                  ///< 挂在描述符上的池缓冲区（收包后直接上交协议栈）
     uint32_t rx_cur;                     ///< 当前接收描述符索引
+    netbuf_pool_t rx_pool;               ///< 接收缓冲区池（DMA 安全，用于补充 RX 环）
     
     /* 发送描述符环 */
-    e1000_tx_desc_t *tx_descs;          ///< 描述符数组（物理地址对齐）
+    e1000_tx_desc_t *tx_descs;          ///< 描述符数组（物理连续页帧）
     uint32_t tx_descs_phys;              ///< 描述符数组物理地址
-    uint8_t *tx_buffers[E1000_NUM_TX_DESC]; ///< 发送缓冲区数组
-    uint32_t tx_cur;                     ///< 当前发送描述符索引
+    uint32_t num_tx_desc;                ///< 发送描述符数量
+    netbuf_t **tx_bufs;                  ///< 正在 DMA 的缓冲区（挂在 EOP 描述符上，DD 后释放）
+    uint32_t tx_cur;                     ///< 下一个空闲发送描述符索引
+    uint32_t tx_dirty;                   ///< 最早的未回收发送描述符索引
+    spinlock_t tx_lock;                  ///< 发送环锁（中断中也会回收描述符）
+    uint32_t tx_ctx_key;                 ///< 当前硬件缓存的校验和上下文（0 表示无）
     
     /* 网络设备接口 */
     netdev_t netdev;
@@ -263,6 +339,29 @@ typedef struct e1000_device {
     uint64_t tx_bytes;
     uint64_t rx_errors;
     uint64_t tx_errors;
+    uint64_t rx_zero_copy;               ///< 直接上交池缓冲区的包数
+    uint64_t rx_copied;                  ///< 池耗尽时回退为复制的包数
+    uint64_t tx_ring_full;               ///< 发送环满导致失败的次数
+    uint64_t rx_csum_ok;                 ///< 硬件已验证校验和的接收包数
+    uint64_t tx_csum_offload;            ///< 由硬件计算校验和的发送包数
+    
+    /* 速率统计（每 E1000_RATE_INTERVAL_MS 采样一次） */
+    spinlock_t rate_lock;                ///< 保护速率统计、节流档位和 ITR 寄存器写入（中断中也会更新）
+    uint64_t rate_start_ms;              ///< 当前采样窗口起始时间
+    uint64_t rate_rx_packets;            ///< 窗口起始时的接收包数
+    uint64_t rate_tx_packets;            ///< 窗口起始时的发送包数
+    uint64_t rate_rx_bytes;              ///< 窗口起始时的接收字节数
+    uint64_t rate_tx_bytes;              ///< 窗口起始时的发送字节数
+    uint32_t rx_pps;                     ///< 最近窗口的接收包速率
+    uint32_t tx_pps;                     ///< 最近窗口的发送包速率
+    uint32_t rx_kbps;                    ///< 最近窗口的接收吞吐（Kbit/s）
+    uint32_t tx_kbps;                    ///< 最近窗口的发送吞吐（Kbit/s）
+    
+    /* 中断节流 */
+    e1000_itr_profile_t itr_profile;     ///< 当前节流档位
+    uint64_t interrupts;                 ///< 中断次数
+    uint64_t rate_interrupts;            ///< 窗口起始时的中断次数
+    uint32_t irq_rate;                   ///< 最近窗口的中断速率（次/秒）
     
     /* 链路状态 */
     bool link_up;
@@ -331,5 +430,19 @@ bool e1000_link_up(e1000_device_t *dev);
  */
 void e1000_print_info(e1000_device_t *dev);
 
+/**
+ * @brief 把描述符数量限制到 [E1000_MIN_DESC, E1000_MAX_DESC] 并向下对齐到 8
+ * @param n 请求的描述符数量
+ * @return 可用的描述符数量
+ */
+uint32_t e1000_clamp_ring_size(uint32_t n);
+
+/**
+ * @brief 根据包速率选择中断节流档位
+ * @param pps 最近窗口的收发包速率之和
+ * @return 节流档位
+ */
+e1000_itr_profile_t e1000_itr_select(uint32_t pps);
+
 #endif // _DRIVERS_X86_E1000_H_
 
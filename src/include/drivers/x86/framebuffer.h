@@ -361,14 +361,14 @@ void fb_terminal_set_vga_color(uint8_t fg, uint8_t bg);
  * @brief 启用双缓冲
  * 
  * 双缓冲在普通内存中维护后备缓冲区，所有绘制操作在后备缓冲区进行。
- * 这样滚屏等需要读取像素的操作会更快。
+ * 后备缓冲区按行环形使用，终端滚屏只移动起始行，不搬运像素。
  */
 void fb_enable_double_buffer(void);
 
 /**
  * @brief 刷新后备缓冲区到显存
  * 
- * 只刷新脏区域以提升性能
+ * 只复制自上次刷新以来的脏矩形
  */
 void fb_flush(void);
 
@@ -389,6 +389,22 @@ bool fb_set_double_buffer(bool enable);
  */
 void fb_swap_buffers(void);
 
+/**
+ * @brief 控制台渲染统计
+ */
+typedef struct fb_console_stats {
+    uint32_t glyph_hits;        ///< 字形行缓存命中（按字符计）
+    uint32_t glyph_misses;      ///< 颜色对未命中，重新渲染行模式表
+    uint32_t scrolls;           ///< 终端滚屏次数
+    uint32_t flushes;           ///< 刷新到显存的次数
+    uint64_t flush_bytes;       ///< 复制到显存的字节数
+} fb_console_stats_t;
+
+/**
+ * @brief 读取控制台渲染统计
+ */
+void fb_get_stats(fb_console_stats_t *stats);
+
 /* ============================================================================
  * 调试和工具函数
  * ============================================================================ */
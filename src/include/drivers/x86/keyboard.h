@@ -131,6 +131,14 @@ char keyboard_getchar(void);
  */
 bool keyboard_try_getchar(char *c);
 
+struct wait_queue;
+
+/**
+ * 获取键盘输入等待队列
+ * @return 等待队列（有新字符进入缓冲区时以 POLLIN 唤醒）
+ */
+struct wait_queue *keyboard_get_wait_queue(void);
+
 /**
  * 读取一行文本（阻塞）
  * 读取直到遇到换行符
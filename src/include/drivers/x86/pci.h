@@ -86,6 +86,10 @@
 #define PCI_CLASS_STORAGE       0x01    ///< 存储控制器
 #define PCI_CLASS_BRIDGE        0x06    ///< 桥接设备
 
+/* 存储控制器子类 */
+#define PCI_SUBCLASS_IDE            0x01    ///< IDE 控制器
+#define PCI_IDE_PROG_IF_BUS_MASTER  0x80    ///< 支持总线主控 DMA
+
 /* 桥接设备子类 */
 #define PCI_SUBCLASS_HOST_BRIDGE    0x00    ///< Host Bridge
 #define PCI_SUBCLASS_ISA_BRIDGE     0x01    ///< ISA Bridge
@@ -6,8 +6,21 @@
  * 
  * 提供串口通信功能，用于内核调试和日志输出
  * 使用 COM1 (0x3F8) 作为默认串口
+ *
+ * 启用发送中断后输出先进入发送环，由 THRE 中断写入 UART；环满时丢弃并计数
  */
 
+#include <types.h>
+
+#define SERIAL_TX_RING_SIZE     4096    // 发送环大小（2 的幂）
+
+typedef struct serial_stats {
+    uint64_t tx_bytes;          // 写入 UART 的字节
+    uint32_t tx_dropped;        // 发送环满丢弃的字节
+    uint32_t tx_irqs;           // THRE 中断次数
+    uint32_t ring_high;         // 发送环最高占用
+} serial_stats_t;
+
 /**
  * 初始化串口
  * 配置波特率为 38400，8位数据位，无校验，1停止位
@@ -26,4 +39,29 @@ void serial_putchar(char c);
  */
 void serial_print(const char *msg);
 
+/**
+ * 切换到中断驱动发送（IRQ 4），在中断控制器初始化之后调用；
+ * 此前的输出逐字节轮询
+ */
+void serial_enable_tx_irq(void);
+
+/**
+ * 等待发送环和 UART 发送 FIFO 全部写出
+ */
+void serial_flush(void);
+
+/**
+ * 进入 panic 模式：同步写出发送环中的积压内容，此后不取锁、逐字节轮询输出
+ * 调用前须已关中断
+ */
+void serial_panic_mode(void);
+
+void serial_get_stats(serial_stats_t *stats);
+
+/**
+ * 生成 /proc/serial 内容
+ * @return 写入的字节数
+ */
+int serial_stats_dump(char *buf, size_t size);
+
 #endif /* _DRIVERS_X86_SERIAL_H_ */
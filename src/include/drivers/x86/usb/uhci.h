@@ -10,6 +10,9 @@
 
 #include <types.h>
 #include <drivers/usb/usb.h>
+#include <kernel/sync/spinlock.h>
+#include <kernel/sync/mutex.h>
+#include <kernel/sync/waitqueue.h>
 
 /* ============================================================================
  * UHCI PCI 标识
@@ -122,7 +125,8 @@
  * ============================================================================ */
 
 #define UHCI_FRAME_LIST_SIZE    1024
-#define UHCI_TD_POOL_SIZE       256
+#define UHCI_TD_POOL_SIZE       1024
+#define UHCI_BULK_MAX_TDS       512     // 一轮批量传输最多挂入的 TD 数
 #define UHCI_QH_POOL_SIZE       32
 #define UHCI_NUM_PORTS          2
 
@@ -190,6 +194,18 @@ typedef struct uhci_controller {
     /* 挂起的 URB */
     usb_urb_t *pending_urbs;        // 挂起的 URB 链表
     
+    /* 传输同步 */
+    spinlock_t pool_lock;           // 保护 TD/QH 空闲链表
+    mutex_t ctrl_lock;              // 控制传输槽（只在可睡眠上下文中获取）
+    mutex_t bulk_lock;              // 批量传输槽（只在可睡眠上下文中获取）
+    wait_queue_t xfer_wait;         // 等待 IOC/短包/错误中断
+    bool irq_registered;
+    
+    /* 统计 */
+    uint32_t irq_count;             // 传输相关中断
+    uint32_t xfer_count;            // 完成的传输轮次
+    uint32_t xfer_polled;           // 无法睡眠、轮询等待的轮次
+    
     /* USB 核心主机控制器 */
     usb_host_controller_t usb_hc;
     
@@ -223,6 +239,15 @@ uhci_controller_t *uhci_get_controller(int index);
  */
 int uhci_submit_urb(uhci_controller_t *hc, usb_urb_t *urb);
 
+/**
+ * @brief 读取传输统计
+ * @param hc 控制器
+ * @param irqs 传输中断数（可为 NULL）
+ * @param xfers 传输轮次（可为 NULL）
+ * @param polled 其中轮询等待的轮次（可为 NULL）
+ */
+void uhci_get_stats(uhci_controller_t *hc, uint32_t *irqs, uint32_t *xfers, uint32_t *polled);
+
 /**
  * @brief 复位端口
  * @param hc 控制器
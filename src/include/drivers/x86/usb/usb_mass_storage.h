@@ -55,6 +55,11 @@
 /* 块大小 */
 #define USB_MSC_BLOCK_SIZE          512
 
+/* READ(10)/WRITE(10) 单条命令的块数上限（16 位长度字段） */
+#define USB_MSC_MAX_BLOCKS          0xFFFF
+/* 多块命令失败后逐次减半，不低于此值 */
+#define USB_MSC_MIN_BLOCKS          8
+
 /* 最大支持的 MSC 设备数 */
 #define USB_MSC_MAX_DEVICES         8
 
@@ -127,6 +132,8 @@ typedef struct usb_msc_device {
     uint32_t block_size;            // 块大小
     uint32_t block_count;           // 块数量
     bool ready;                     // 设备就绪
+    uint32_t max_blocks;            // 单条读写命令的块数上限
+    uint32_t rw_commands;           // 已执行的 READ(10)/WRITE(10) 命令数
     
     /* CBW 标签 */
     uint32_t tag;                   // 命令标签计数
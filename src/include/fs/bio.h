@@ -0,0 +1,178 @@
+#ifndef _FS_BIO_H_
+#define _FS_BIO_H_
+
+#include <types.h>
+#include <fs/blockdev.h>
+#include <kernel/sync/spinlock.h>
+#include <kernel/sync/waitqueue.h>
+
+/**
+ * 块 I/O 请求层
+ *
+ * bio 描述一次连续扇区的读写，提交后异步完成并调用 end_io。每个设备有一个
+ * 请求队列：未派发的请求按扇区排序，新 bio 与队列中首尾相接、方向相同的
+ * 请求合并；派发按单向电梯（C-LOOK）顺序进行。
+ *
+ * 驱动有两种接入方式：
+ * - 只提供 read/write：由提交者的上下文逐个派发，同一时刻只有一个派发者，
+ *   其他提交者的请求由它一并处理（队列深度 1）
+ * - 另外提供 submit：请求交给驱动后立即返回，驱动完成时调用 blk_request_done，
+ *   同时在途的请求数不超过队列深度
+ *
+ * blk_start_plug / blk_finish_plug 之间提交的 bio 只入队不派发，给合并留出
+ * 机会；等待 bio 完成的任务会先把队列派发出去，所以 plug 期间等待不会死锁。
+ *
+ * 派发（分配中转缓冲区、调用驱动，同步驱动还会就地读写）只在任务上下文中
+ * 进行：提交者、等待者或 kblockd 线程。驱动完成请求（可能在中断里或等待者
+ * 的条件检查里）时只唤醒 kblockd 接着派发队列中剩下的请求。
+ * 没有队列的设备（分区）通过 remap 把 bio 转到下层设备。
+ */
+
+#define BLK_MAX_REQUEST_BYTES   (64 * 1024)     // 合并后单个请求的最大数据量
+#define BLK_QUEUE_MAX_REQUESTS  64              // 每个队列的请求结构数
+
+typedef struct bio bio_t;
+typedef void (*bio_end_io_t)(bio_t *bio);
+
+/**
+ * 块 I/O 描述
+ *
+ * 调用者填写 dev/sector/count/buffer/write/end_io/private 后提交；完成时 status
+ * 为 0 或 -1，end_io 在完成者的上下文中调用（可能是中断上下文）。提交经过
+ * remap 时 dev/sector 被改写为下层设备的。未完成的 bio 之间不保证执行顺序。
+ */
+struct bio {
+    blockdev_t *dev;
+    uint32_t sector;
+    uint32_t count;                     // 块数（以设备块大小计）
+    uint8_t *buffer;                    // 内核地址，驱动可能直接 DMA
+    bool write;
+    volatile int status;
+    bio_end_io_t end_io;                // 可为 NULL
+    void *private;
+    volatile bool done;
+    struct bio *next;                   // 请求内的 bio 链（层内部使用）
+};
+
+struct blk_queue;
+
+/**
+ * 请求：一个或多个扇区相邻的 bio 合并而成
+ *
+ * buffer 是驱动看到的线性缓冲区：bio 缓冲区首尾相接时就是调用者的内存，
+ * 否则为派发时分配的中转缓冲区。
+ */
+typedef struct blk_request {
+    struct blk_queue *q;
+    uint32_t sector;
+    uint32_t count;
+    bool write;
+    uint8_t *buffer;
+    bool bounce;                        // buffer 为中转缓冲区
+    bio_t *bios;
+    bio_t *bios_tail;
+    uint32_t nr_bios;
+    bool last;                          // 本轮派发的最后一个请求，驱动可在此时通知设备
+    void *driver_data;                  // 驱动私有
+    struct blk_request *next;
+} blk_request_t;
+
+typedef struct blk_queue_stats {
+    uint64_t bios;                      // 提交的 bio
+    uint64_t requests;                  // 派发给驱动的请求
+    uint64_t back_merges;               // bio 接在请求尾部
+    uint64_t front_merges;              // bio 接在请求头部
+    uint64_t bounced;                   // 使用中转缓冲区的请求
+    uint64_t sectors;
+    uint32_t max_inflight;
+    uint32_t errors;
+} blk_queue_stats_t;
+
+typedef struct blk_queue {
+    blockdev_t *dev;
+    spinlock_t lock;
+    uint32_t block_size;
+    uint32_t max_sectors;               // 单个请求的块数上限
+    uint32_t depth;                     // 同时交给驱动的请求数上限
+    uint32_t inflight;
+    uint32_t plugged;                   // plug 嵌套计数
+    bool dispatching;                   // 已有派发者
+    bool kicked;                        // 已在 kblockd 的待派发链上
+    struct blk_queue *kick_next;
+    uint32_t head_pos;                  // 电梯位置：上一个请求的结束扇区
+
+    blk_request_t *queue;               // 未派发的请求，按扇区升序
+    blk_request_t *free;
+    blk_request_t reqs[BLK_QUEUE_MAX_REQUESTS];
+
+    wait_queue_t wait;                  // bio 完成 / 请求结构释放
+    blk_queue_stats_t stats;
+} blk_queue_t;
+
+/**
+ * 为设备创建请求队列（在 blockdev_register 之前调用）
+ * dev->submit 为 NULL 时按同步方式派发，depth 取 1；
+ * 驱动有更严格的单请求限制时可随后调低 queue->max_sectors
+ * @return 0 成功，-1 失败
+ */
+int blk_queue_init(blockdev_t *dev, uint32_t depth);
+
+/**
+ * 释放设备的请求队列（设备注销之后调用，队列必须已空）
+ */
+void blk_queue_destroy(blockdev_t *dev);
+
+/**
+ * 提交 bio（可能睡眠：请求结构用完时等待）
+ * bio 的块数不得超过 blk_queue_max_sectors()
+ * @return 0 已提交（end_io 一定会被调用，可能在返回前），-1 参数错误（不调用 end_io）
+ */
+int bio_submit(bio_t *bio);
+
+/**
+ * 等待 bio 完成（只用于 end_io 为 NULL 的 bio）
+ * @return bio 的完成状态
+ */
+int bio_wait(bio_t *bio);
+
+/**
+ * 同步读写：按请求上限拆成多个 bio 一并提交后等待（blockdev_read/write 使用）
+ * @return 0 成功，-1 失败
+ */
+int blk_rw_sync(blockdev_t *dev, uint32_t sector, uint32_t count, uint8_t *buffer, bool write);
+
+/**
+ * 蓄积请求：嵌套计数，最外层 finish 时派发积累的请求
+ */
+void blk_start_plug(blockdev_t *dev);
+void blk_finish_plug(blockdev_t *dev);
+
+/**
+ * 启动 kblockd 派发线程（在 task_init 之后调用）；未启动时剩余请求由下一个
+ * 提交者或等待者派发
+ */
+void blk_start_thread(void);
+
+/**
+ * 驱动完成一个通过 submit 接收的请求（可在中断上下文调用，不得持有驱动锁）
+ * 不在调用者上下文中派发，队列中剩下的请求交给 kblockd
+ */
+void blk_request_done(blk_request_t *rq, int status);
+
+/**
+ * 派发队列中可派发的请求（驱动有空闲能力时可调用，只能在任务上下文中调用）
+ */
+void blk_run_queue(blockdev_t *dev);
+
+/**
+ * 单个 bio 的块数上限（设备经 remap 转发时取下层设备的）
+ */
+uint32_t blk_queue_max_sectors(blockdev_t *dev);
+
+/**
+ * 读取队列统计
+ * @return 0 成功，-1 设备没有队列
+ */
+int blk_queue_get_stats(blockdev_t *dev, blk_queue_stats_t *stats);
+
+#endif // _FS_BIO_H_
@@ -21,6 +21,14 @@ typedef int (*blockdev_write_t)(void *dev, uint32_t sector, uint32_t count, cons
 typedef uint32_t (*blockdev_get_size_t)(void *dev);  // 返回扇区数
 typedef uint32_t (*blockdev_get_block_size_t)(void *dev);  // 返回块大小（字节）
 
+// 请求队列接口（可选，见 fs/bio.h）
+struct blockdev;
+struct blk_queue;
+struct blk_request;
+typedef int (*blockdev_submit_t)(void *dev, struct blk_request *rq);  // 0 接受，1 忙，-1 失败
+typedef void (*blockdev_poll_t)(void *dev);                           // 等待者轮询完成
+typedef struct blockdev *(*blockdev_remap_t)(void *dev, uint32_t *sector);  // 转到下层设备
+
 /**
  * 块设备结构
  */
@@ -37,6 +45,12 @@ typedef struct blockdev {
     blockdev_write_t write;
     blockdev_get_size_t get_size;
     blockdev_get_block_size_t get_block_size;
+
+    // 请求队列
+    struct blk_queue *queue;            // blk_queue_init 创建，NULL 表示直接调用 read/write
+    blockdev_submit_t submit;           // 异步派发（可选）
+    blockdev_poll_t poll;               // 中断缺失时由等待者回收完成（可选）
+    blockdev_remap_t remap;             // 堆叠设备把 bio 转给下层（可选）
 } blockdev_t;
 
 /**
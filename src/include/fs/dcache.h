@@ -0,0 +1,93 @@
+/**
+ * @file dcache.h
+ * @brief 目录项缓存（dentry cache）
+ *
+ * 缓存 (父目录节点, 名字) -> 子节点 的查找结果，路径解析时每个路径
+ * 分量只需一次内存查找，不必调用文件系统的 finddir（FAT32 每次都要
+ * 读目录簇并分配新节点）。
+ *
+ * - 只缓存设置了 FS_NODE_FLAG_DCACHE 的目录：这些目录的内容只通过
+ *   VFS 的 create/mkdir/unlink/rename 改变，VFS 在这些操作时使缓存失效
+ * - 查找失败同样缓存（负项），重复查找不存在的路径不再访问磁盘
+ * - 条目数固定，满时按 LRU 淘汰
+ * - 正项持有子节点和父节点各一个引用，父节点在条目存在期间不会被
+ *   释放，其地址不会被复用为其它目录
+ */
+
+#ifndef _FS_DCACHE_H_
+#define _FS_DCACHE_H_
+
+#include <types.h>
+#include <fs/vfs.h>
+
+#define DCACHE_HASH_SIZE    256     ///< 散列桶数（2 的幂）
+#define DCACHE_MAX_ENTRIES  512     ///< 最多缓存的条目数
+
+typedef struct dcache_stats {
+    uint32_t entries;           ///< 当前条目数
+    uint32_t negative;          ///< 其中负项数
+    uint32_t lookups;           ///< 查找次数
+    uint32_t hits;              ///< 正项命中
+    uint32_t negative_hits;     ///< 负项命中
+    uint32_t evictions;         ///< LRU 淘汰次数
+    uint32_t invalidations;     ///< 失效的条目数
+} dcache_stats_t;
+
+/**
+ * @brief 初始化目录项缓存（由 vfs_init 调用）
+ */
+void dcache_init(void);
+
+/**
+ * @brief 查找缓存
+ * @param parent 父目录节点
+ * @param name 分量名
+ * @param node 输出：子节点（带一个引用，调用者负责 vfs_release_node），负项为 NULL
+ * @return true 命中（包括负项），false 未缓存
+ */
+bool dcache_lookup(fs_node_t *parent, const char *name, fs_node_t **node);
+
+/**
+ * @brief 加入缓存
+ * @param parent 父目录节点（未设置 FS_NODE_FLAG_DCACHE 时忽略）
+ * @param name 分量名
+ * @param node 子节点，NULL 表示负项；缓存自行持有引用
+ */
+void dcache_add(fs_node_t *parent, const char *name, fs_node_t *node);
+
+/**
+ * @brief 使目录中某个名字的缓存失效
+ * @param parent 父目录节点
+ * @param name 分量名
+ *
+ * 同一目录可能有多个节点对象（例如经 ".." 得到），因此同一文件系统中
+ * inode 相同的父目录下的同名条目也一并失效。
+ */
+void dcache_invalidate(fs_node_t *parent, const char *name);
+
+/**
+ * @brief 使某个目录下的全部条目失效（目录即将被删除时调用）
+ * @param dir 目录节点
+ */
+void dcache_invalidate_dir(fs_node_t *dir);
+
+/**
+ * @brief 清空缓存（挂载表变化时调用）
+ */
+void dcache_flush(void);
+
+/**
+ * @brief 获取统计信息
+ * @param stats 输出
+ */
+void dcache_get_stats(dcache_stats_t *stats);
+
+/**
+ * @brief 输出统计信息（/proc/dcache）
+ * @param buf 输出缓冲区
+ * @param size 缓冲区大小
+ * @return 写入的字节数
+ */
+int dcache_dump(char *buf, size_t size);
+
+#endif // _FS_DCACHE_H_
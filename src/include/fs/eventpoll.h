@@ -0,0 +1,77 @@
+/**
+ * @file eventpoll.h
+ * @brief epoll 风格的就绪事件通知
+ *
+ * epoll 实例以文件描述符的形式存在，内部维护兴趣列表（按描述符散列）和
+ * 就绪链表。每个被监视的对象上挂一个回调等待项：对象发出事件时回调把
+ * 条目放入就绪链表并唤醒 epoll_wait，因此 epoll_wait 的开销只与就绪条目数
+ * 相关，与监视的描述符总数无关。
+ *
+ * 描述符空间：文件（管道、控制台等）使用进程的 fd 表，socket 使用独立的
+ * socket 描述符表。监视 socket 时在 op 中加上 EPOLL_CTL_SOCK。
+ */
+
+#ifndef _FS_EVENTPOLL_H_
+#define _FS_EVENTPOLL_H_
+
+#include <types.h>
+#include <fs/poll.h>
+
+/* 事件（与 POLL* 取值一致） */
+#define EPOLLIN         POLLIN
+#define EPOLLPRI        POLLPRI
+#define EPOLLOUT        POLLOUT
+#define EPOLLERR        POLLERR
+#define EPOLLHUP        POLLHUP
+#define EPOLLRDHUP      POLLRDHUP
+#define EPOLLONESHOT    (1U << 30)  ///< 报告一次后停止监视，直到 EPOLL_CTL_MOD
+#define EPOLLET         (1U << 31)  ///< 边沿触发
+
+/* epoll_ctl 操作 */
+#define EPOLL_CTL_ADD   1
+#define EPOLL_CTL_DEL   2
+#define EPOLL_CTL_MOD   3
+#define EPOLL_CTL_SOCK  0x100       ///< CastorOS 扩展：fd 为 socket 描述符
+
+#define EPOLL_MAX_EVENTS    1024    ///< 单次 epoll_wait 最多返回的事件数
+
+typedef union epoll_data {
+    void *ptr;
+    int fd;
+    uint32_t u32;
+    uint64_t u64;
+} epoll_data_t;
+
+struct epoll_event {
+    uint32_t events;        ///< 关注的事件 / 发生的事件
+    epoll_data_t data;      ///< 用户数据（原样返回）
+} __attribute__((packed));
+
+/**
+ * @brief 创建 epoll 实例
+ * @param size 兼容参数（必须大于 0，不限制监视数量）
+ * @return epoll 文件描述符，失败返回 -1
+ */
+int sys_epoll_create(int size);
+
+/**
+ * @brief 修改 epoll 兴趣列表
+ * @param epfd epoll 文件描述符
+ * @param op EPOLL_CTL_ADD/DEL/MOD，可或上 EPOLL_CTL_SOCK
+ * @param fd 目标描述符
+ * @param event 关注的事件和用户数据（DEL 时可为 NULL）
+ * @return 0 成功，-1 失败
+ */
+int sys_epoll_ctl(int epfd, int op, int fd, struct epoll_event *event);
+
+/**
+ * @brief 等待就绪事件
+ * @param epfd epoll 文件描述符
+ * @param events 输出数组
+ * @param maxevents 数组长度
+ * @param timeout 超时（毫秒），-1 无限等待，0 立即返回
+ * @return 就绪事件数，0 超时，-1 错误
+ */
+int sys_epoll_wait(int epfd, struct epoll_event *events, int maxevents, int timeout);
+
+#endif // _FS_EVENTPOLL_H_
@@ -34,5 +34,26 @@ bool fat32_probe(blockdev_t *dev);
  */
 void fat32_deinit(fs_node_t *root);
 
+/**
+ * 预读统计（所有已挂载的 FAT32 文件系统合计，以簇为单位）
+ */
+typedef struct fat32_ra_stats {
+    uint32_t issued;            // 发起的预读
+    uint32_t hits;              // 被读取使用的预读簇
+    uint32_t waits;             // 命中时预读仍在途，需要等待
+    uint32_t misses;            // 顺序读中未被预读覆盖、同步读取的簇
+    uint32_t wasted;            // 未被使用就被淘汰或作废的预读簇
+    uint32_t grows;             // 窗口扩大
+    uint32_t shrinks;           // 窗口缩小（非顺序访问）
+} fat32_ra_stats_t;
+
+void fat32_readahead_get_stats(fat32_ra_stats_t *stats);
+
+/**
+ * 生成 /proc/readahead 内容
+ * @return 写入的字节数
+ */
+int fat32_readahead_dump(char *buf, size_t size);
+
 #endif // _FS_FAT32_H_
 
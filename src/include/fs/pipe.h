@@ -13,17 +13,26 @@
 
 #include <types.h>
 #include <fs/vfs.h>
+#include <mm/mm_types.h>
 #include <kernel/sync/mutex.h>
-#include <kernel/sync/semaphore.h>
+#include <kernel/sync/waitqueue.h>
 
-/* 管道缓冲区大小 */
-#define PIPE_BUFFER_SIZE 4096
+/* 管道缓冲区大小（按页分配，必须是 2 的幂） */
+#define PIPE_MIN_SIZE       4096                // 最小 1 页
+#define PIPE_DEFAULT_SIZE   (64 * 1024)         // 默认 64 KB
+#define PIPE_MAX_SIZE       (1024 * 1024)       // 最大 1 MB
+
+/* fcntl 命令（与 Linux 取值一致） */
+#define F_SETPIPE_SZ        1031                // 设置管道缓冲区大小
+#define F_GETPIPE_SZ        1032                // 获取管道缓冲区大小
 
 /**
  * 管道结构
  */
 typedef struct pipe {
-    uint8_t buffer[PIPE_BUFFER_SIZE];   // 环形缓冲区
+    uint8_t *buffer;                     // 环形缓冲区（连续物理页）
+    paddr_t buffer_phys;                 // 缓冲区物理地址
+    uint32_t size;                       // 缓冲区大小（2 的幂）
     uint32_t read_pos;                   // 读位置
     uint32_t write_pos;                  // 写位置
     uint32_t count;                      // 缓冲区中的数据量
@@ -32,13 +41,23 @@ typedef struct pipe {
     uint32_t writers;                    // 写端引用计数
     
     mutex_t lock;                        // 保护缓冲区
-    semaphore_t read_sem;                // 读信号量（数据可用）
-    semaphore_t write_sem;               // 写信号量（空间可用）
+    wait_queue_t read_wait;              // 等待数据的读者
+    wait_queue_t write_wait;             // 等待空间的写者
+    wait_queue_t poll_wait;              // select/epoll 等待队列
     
     bool read_closed;                    // 读端是否关闭
     bool write_closed;                   // 写端是否关闭
 } pipe_t;
 
+/**
+ * 管道数据搬运回调
+ * @param ctx 调用者上下文
+ * @param data 环形缓冲区中的一段连续区域
+ * @param len 区域长度
+ * @return 实际处理的字节数（小于 len 表示停止）
+ */
+typedef uint32_t (*pipe_actor_t)(void *ctx, uint8_t *data, uint32_t len);
+
 /**
  * 创建管道
  * @param read_node 输出读端节点
@@ -59,5 +78,40 @@ void pipe_init(void);
  */
 void pipe_on_dup(fs_node_t *node);
 
+/**
+ * 从管道取出数据交给 actor（splice 的管道读端）
+ * 阻塞直到有数据或写端关闭；数据在环形缓冲区中原地交给 actor，
+ * 回绕时最多调用两次。取走多少由 actor 的返回值决定。
+ * @param node 管道节点
+ * @param len 最多取出的字节数
+ * @return 取出的字节数，0 表示 EOF
+ */
+uint32_t pipe_splice_out(fs_node_t *node, uint32_t len, pipe_actor_t actor, void *ctx);
+
+/**
+ * 让 actor 直接填充管道的空闲空间（splice 的管道写端）
+ * 阻塞直到有空间或读端关闭
+ * @param node 管道节点
+ * @param len 最多放入的字节数
+ * @return 放入的字节数，0 表示读端已关闭或 actor 没有数据
+ */
+uint32_t pipe_splice_in(fs_node_t *node, uint32_t len, pipe_actor_t actor, void *ctx);
+
+/**
+ * 调整管道缓冲区大小
+ * 大小向上取整到 2 的幂页数，缓冲区中已有的数据会被保留
+ * @param node 管道节点（读端或写端）
+ * @param size 请求的大小（字节，不超过 PIPE_MAX_SIZE）
+ * @return 实际大小，失败返回 -1（参数无效、现有数据放不下或内存不足）
+ */
+int pipe_set_size(fs_node_t *node, uint32_t size);
+
+/**
+ * 获取管道缓冲区大小
+ * @param node 管道节点
+ * @return 缓冲区大小，非管道返回 -1
+ */
+int pipe_get_size(fs_node_t *node);
+
 #endif // _FS_PIPE_H_
 
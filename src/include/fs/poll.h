@@ -0,0 +1,55 @@
+/**
+ * @file poll.h
+ * @brief 就绪事件查询（select/epoll 的公共基础）
+ *
+ * 可等待对象实现 poll 操作：返回当前就绪事件掩码，并通过 poll_wait()
+ * 把自己的等待队列交给调用者登记。调用者决定登记什么样的等待项：
+ * select 挂任务等待项后阻塞，epoll 挂回调等待项收集就绪事件。
+ * 只查询状态时传入 pt = NULL。
+ */
+
+#ifndef _FS_POLL_H_
+#define _FS_POLL_H_
+
+#include <types.h>
+#include <fs/vfs.h>
+#include <kernel/sync/waitqueue.h>
+
+/* 事件掩码（与 Linux 取值一致） */
+#define POLLIN          0x0001      ///< 有数据可读
+#define POLLPRI         0x0002      ///< 有紧急数据
+#define POLLOUT         0x0004      ///< 可以写入
+#define POLLERR         0x0008      ///< 错误
+#define POLLHUP         0x0010      ///< 对端挂断
+#define POLLNVAL        0x0020      ///< 描述符无效
+#define POLLRDHUP       0x2000      ///< 对端关闭写方向
+#define POLLFREE        0x4000      ///< 内部使用：等待队列所在对象即将释放
+
+/**
+ * @brief poll 登记表
+ */
+typedef struct poll_table {
+    /// 登记回调：把调用者的等待项挂到 wq 上
+    void (*qproc)(struct poll_table *pt, wait_queue_t *wq);
+} poll_table_t;
+
+/**
+ * @brief 在 poll 操作中登记等待队列
+ * @param pt 登记表（NULL 表示只查询不登记）
+ * @param wq 对象的等待队列
+ */
+static inline void poll_wait(poll_table_t *pt, wait_queue_t *wq) {
+    if (pt && pt->qproc && wq) {
+        pt->qproc(pt, wq);
+    }
+}
+
+/**
+ * @brief 查询文件节点的就绪事件
+ * @param node 文件节点
+ * @param pt 登记表（可为 NULL）
+ * @return 就绪事件掩码；节点不支持 poll 时视为总是可读写
+ */
+uint32_t vfs_poll(fs_node_t *node, poll_table_t *pt);
+
+#endif // _FS_POLL_H_
@@ -0,0 +1,92 @@
+/**
+ * @file splice.h
+ * @brief 内核内数据搬运：splice / sendfile / vmsplice
+ *
+ * 在文件、管道和 socket 之间直接搬运数据，不经过用户空间缓冲区：
+ * - 一端是管道时，数据在管道环形缓冲区中原地读出或写入，不再额外复制
+ * - 文件到文件/socket 时经过一个按页分配的内核中转缓冲区
+ *
+ * 描述符空间：socket 使用独立的 socket 描述符表，sendfile 通过
+ * SENDFILE_F_SOCK 标志指明 out_fd 是 socket 描述符。
+ */
+
+#ifndef _FS_SPLICE_H_
+#define _FS_SPLICE_H_
+
+#include <types.h>
+#include <fs/vfs.h>
+
+/* splice 标志（仅为兼容保留，内核忽略） */
+#define SPLICE_F_MOVE       0x01
+#define SPLICE_F_NONBLOCK   0x02
+#define SPLICE_F_MORE       0x04
+#define SPLICE_F_GIFT       0x08
+
+/* sendfile 标志（CastorOS 扩展） */
+#define SENDFILE_F_SOCK     0x01    ///< out_fd 为 socket 描述符
+
+#define SPLICE_CHUNK_SIZE   (64 * 1024)     ///< 文件到文件/socket 的中转缓冲区大小
+#define UIO_MAXIOV          1024            ///< vmsplice 最多的分段数
+
+struct iovec {
+    void *iov_base;
+    size_t iov_len;
+};
+
+/**
+ * @brief 在两个节点之间搬运数据
+ * @param in 源节点（文件或管道读端）
+ * @param in_off 源偏移（文件时必须提供，完成后前移；管道忽略）
+ * @param out 目标节点（文件或管道写端）
+ * @param out_off 目标偏移（文件时必须提供，完成后前移；管道忽略）
+ * @param len 最多搬运的字节数
+ * @return 搬运的字节数，0 表示源已到末尾，-1 错误
+ *
+ * 源为管道时与 read 语义一致：有多少取多少，只在管道为空时阻塞。
+ */
+ssize_t vfs_splice(fs_node_t *in, uint32_t *in_off, fs_node_t *out, uint32_t *out_off, uint32_t len);
+
+#if !defined(ARCH_ARM64)
+/**
+ * @brief 把文件或管道中的数据发送到 TCP socket
+ * @param in 源节点（文件或管道读端）
+ * @param in_off 源偏移（文件时必须提供，完成后前移）
+ * @param sockfd 已连接的 TCP socket 描述符
+ * @param len 最多发送的字节数
+ * @return 发送的字节数，-1 错误
+ */
+ssize_t vfs_splice_to_socket(fs_node_t *in, uint32_t *in_off, int sockfd, uint32_t len);
+#endif
+
+/**
+ * @brief splice 系统调用（一端必须是管道）
+ * @param fd_in 源文件描述符
+ * @param off_in 源偏移（NULL 使用并更新文件偏移；管道必须为 NULL）
+ * @param fd_out 目标文件描述符
+ * @param off_out 目标偏移（同上）
+ * @param len 最多搬运的字节数
+ * @return 搬运的字节数，-1 错误
+ */
+ssize_t sys_splice(int fd_in, off_t *off_in, int fd_out, off_t *off_out, uint32_t len);
+
+/**
+ * @brief sendfile 系统调用
+ * @param out_fd 目标文件描述符（flags 含 SENDFILE_F_SOCK 时为 socket 描述符）
+ * @param in_fd 源文件描述符（文件或管道）
+ * @param offset 源偏移（NULL 使用并更新文件偏移）
+ * @param count 最多发送的字节数
+ * @param flags SENDFILE_F_*
+ * @return 发送的字节数，-1 错误
+ */
+ssize_t sys_sendfile(int out_fd, int in_fd, off_t *offset, uint32_t count, uint32_t flags);
+
+/**
+ * @brief vmsplice 系统调用：把用户内存直接写入管道
+ * @param fd 管道写端
+ * @param iov 分段数组
+ * @param nr_segs 分段数
+ * @return 写入的字节数，-1 错误
+ */
+ssize_t sys_vmsplice(int fd, const struct iovec *iov, uint32_t nr_segs);
+
+#endif // _FS_SPLICE_H_
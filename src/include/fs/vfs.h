@@ -26,9 +26,13 @@ typedef enum {
 
 // 文件节点标志（用于 flags 字段）
 #define FS_NODE_FLAG_ALLOCATED      0x80000000  // 节点是动态分配的，需要释放
+#define FS_NODE_FLAG_DCACHE         0x40000000  // 目录的查找结果可以进入目录项缓存
+#define FS_NODE_FLAG_ICASE          0x20000000  // 目录中的名字不区分大小写
+#define FS_NODE_FLAG_ICACHED        0x10000000  // 节点在 inode 缓存中（由 VFS 维护）
 
 /* 前向声明 */
 struct fs_node;
+struct poll_table;
 
 /* 文件操作函数类型 */
 typedef uint32_t (*read_type_t)(struct fs_node *node, uint32_t offset, uint32_t size, uint8_t *buffer);
@@ -42,6 +46,46 @@ typedef int (*mkdir_type_t)(struct fs_node *node, const char *name, uint32_t per
 typedef int (*unlink_type_t)(struct fs_node *node, const char *name);
 typedef int (*truncate_type_t)(struct fs_node *node, uint32_t new_size);
 typedef int (*rename_type_t)(struct fs_node *node, const char *old_name, const char *new_name);
+typedef uint32_t (*poll_type_t)(struct fs_node *node, struct poll_table *pt);
+
+/**
+ * 目录流游标（保存在文件描述符表项中）
+ * index 为已返回的目录项数；pos、cookie 由文件系统解释
+ * （FAT32：目录项所在簇与簇内偏移；ramfs：下一个条目与目录修改计数）。
+ * 全 0 表示从目录开头读起。
+ */
+typedef struct dir_cursor {
+    uint32_t index;
+    uintptr_t pos;
+    uint32_t cookie;
+} dir_cursor_t;
+
+/**
+ * 目录项填充回调
+ * @return 0 继续；非 0 表示缓冲区已满，该项未被接收，游标停在该项
+ */
+typedef int (*filldir_t)(void *ctx, const char *name, uint32_t ino, uint8_t type);
+typedef int (*iterate_type_t)(struct fs_node *node, dir_cursor_t *cursor, filldir_t fill, void *ctx);
+
+/**
+ * 文件操作表
+ * 同一文件系统中同类节点共享一张表（通常为 static const），节点只保存表指针
+ */
+typedef struct fs_node_ops {
+    read_type_t read;
+    write_type_t write;
+    open_type_t open;
+    close_type_t close;
+    readdir_type_t readdir;
+    finddir_type_t finddir;
+    create_type_t create;
+    mkdir_type_t mkdir;
+    unlink_type_t unlink;
+    truncate_type_t truncate;
+    rename_type_t rename;        // 重命名操作
+    poll_type_t poll;            // 就绪状态查询（NULL 表示总是可读写）
+    iterate_type_t iterate;      // 从游标处连续读取目录项（NULL 时按 readdir 索引读取）
+} fs_node_ops_t;
 
 /**
  * 文件节点（inode）
@@ -60,18 +104,10 @@ typedef struct fs_node {
     uint32_t impl_data;          // 文件系统私有整数值（如 procfs 的 PID），不会被 kfree
     uint32_t ref_count;          // 引用计数（用于资源管理）
     
-    // 文件操作函数
-    read_type_t read;
-    write_type_t write;
-    open_type_t open;
-    close_type_t close;
-    readdir_type_t readdir;
-    finddir_type_t finddir;
-    create_type_t create;
-    mkdir_type_t mkdir;
-    unlink_type_t unlink;
-    truncate_type_t truncate;
-    rename_type_t rename;        // 重命名操作
+    const fs_node_ops_t *ops;    // 操作表（NULL 表示不支持任何操作）
+    
+    void *sb;                    // 所属文件系统实例（inode 缓存的键）
+    struct fs_node *icache_next; // inode 缓存散列链
     
     struct fs_node *ptr;         // 用于符号链接和挂载点
 } fs_node_t;
@@ -139,6 +175,38 @@ void vfs_ref_node(fs_node_t *node);
  */
 void vfs_release_node(fs_node_t *node);
 
+/**
+ * 在 inode 缓存中查找节点
+ * @param sb 文件系统实例
+ * @param inode inode 编号
+ * @return 共享节点（已增加引用计数，调用者需要调用 vfs_release_node），未缓存返回 NULL
+ */
+fs_node_t *vfs_icache_get(void *sb, uint32_t inode);
+
+/**
+ * 把新建的节点加入 inode 缓存
+ * @param node 动态分配的节点（ref_count=1，sb 和 inode 已设置）
+ * @return 应使用的节点：通常就是 node；若同一 inode 已被并发加入，
+ *         释放 node 并返回已缓存的节点（已增加引用计数）
+ *
+ * 引用计数降为 0 时节点自动移出缓存并释放。
+ */
+fs_node_t *vfs_icache_add(fs_node_t *node);
+
+/**
+ * 把节点移出 inode 缓存（文件被删除，inode 编号可能被复用时调用）
+ * @param node 文件节点
+ */
+void vfs_icache_remove(fs_node_t *node);
+
+/**
+ * 输出 inode 缓存统计信息（/proc/icache）
+ * @param buf 输出缓冲区
+ * @param size 缓冲区大小
+ * @return 写入的字节数
+ */
+int vfs_icache_dump(char *buf, size_t size);
+
 /**
  * 读取目录项
  * @param node 目录节点
@@ -147,6 +215,19 @@ void vfs_release_node(fs_node_t *node);
  */
 struct dirent *vfs_readdir(fs_node_t *node, uint32_t index);
 
+/**
+ * 从游标处连续读取目录项
+ * @param node 目录节点
+ * @param cursor 目录流游标，返回时指向第一个未被接收的目录项
+ * @param fill 填充回调，返回非 0 时停止
+ * @param ctx 回调上下文
+ * @return 0 成功（包括已到末尾），-1 失败
+ *
+ * 文件系统提供 iterate 时每次调用从上次停下的位置继续，不必从头扫描；
+ * 否则按游标中的索引逐项调用 readdir。
+ */
+int vfs_iterate_dir(fs_node_t *node, dir_cursor_t *cursor, filldir_t fill, void *ctx);
+
 /**
  * 在目录中查找文件
  * @param node 目录节点
@@ -200,6 +281,15 @@ int vfs_truncate(fs_node_t *node, uint32_t new_size);
  */
 int vfs_mount(const char *path, fs_node_t *root);
 
+/**
+ * 卸载指定路径上的文件系统
+ * @param path 挂载点路径
+ * @return 0 成功，-1 不是挂载点
+ *
+ * 不检查挂载的文件系统中是否还有打开的文件，调用者负责。
+ */
+int vfs_umount(const char *path);
+
 /**
  * 重命名文件或目录
  * @param oldpath 原路径
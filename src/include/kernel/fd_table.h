@@ -19,6 +19,7 @@ typedef struct {
     fs_node_t *node;        // 指向 VFS 节点
     uint32_t offset;        // 当前文件偏移量
     int32_t flags;          // 打开标志（O_RDONLY, O_WRONLY, O_RDWR 等）
+    dir_cursor_t dir_pos;   // 目录流位置（getdents64 使用）
     bool in_use;            // 是否在使用
 } fd_entry_t;
 
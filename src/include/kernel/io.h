@@ -72,6 +72,32 @@ static inline void outl(uint16_t port, uint32_t val) {
     __asm__ volatile("outl %0, %1" : : "a"(val), "Nd"(port));
 }
 
+/**
+ * 从指定端口连续读取 count 个字（rep insw）
+ * @param port 端口号
+ * @param buf 目标缓冲区
+ * @param count 字数
+ */
+static inline void insw(uint16_t port, void *buf, size_t count) {
+    __asm__ volatile("cld; rep insw"
+                     : "+D"(buf), "+c"(count)
+                     : "d"(port)
+                     : "memory");
+}
+
+/**
+ * 向指定端口连续输出 count 个字（rep outsw）
+ * @param port 端口号
+ * @param buf 源缓冲区
+ * @param count 字数
+ */
+static inline void outsw(uint16_t port, const void *buf, size_t count) {
+    __asm__ volatile("cld; rep outsw"
+                     : "+S"(buf), "+c"(count)
+                     : "d"(port)
+                     : "memory");
+}
+
 #endif /* ARCH_I686 || ARCH_X86_64 */
 
 #endif /* _KERNEL_IO_H_ */
@@ -0,0 +1,64 @@
+#ifndef _KERNEL_SYNC_ATOMIC_H_
+#define _KERNEL_SYNC_ATOMIC_H_
+
+#include <types.h>
+
+/*
+ * 原子操作（基于 GCC __atomic 内建函数，i686/x86_64/arm64 均内联展开）
+ * i686 上的 64 位比较交换使用 cmpxchg8b。
+ */
+
+typedef struct {
+    volatile uint32_t value;
+} atomic_t;
+
+#define ATOMIC_INIT(v) { (v) }
+
+static inline uint32_t atomic_read(const atomic_t *a) {
+    return __atomic_load_n(&a->value, __ATOMIC_ACQUIRE);
+}
+
+static inline void atomic_set(atomic_t *a, uint32_t v) {
+    __atomic_store_n(&a->value, v, __ATOMIC_RELEASE);
+}
+
+static inline uint32_t atomic_add_return(atomic_t *a, uint32_t v) {
+    return __atomic_add_fetch(&a->value, v, __ATOMIC_ACQ_REL);
+}
+
+static inline uint32_t atomic_sub_return(atomic_t *a, uint32_t v) {
+    return __atomic_sub_fetch(&a->value, v, __ATOMIC_ACQ_REL);
+}
+
+static inline uint32_t atomic_inc_return(atomic_t *a) {
+    return atomic_add_return(a, 1);
+}
+
+static inline uint32_t atomic_dec_return(atomic_t *a) {
+    return atomic_sub_return(a, 1);
+}
+
+static inline uint32_t atomic_fetch_add(atomic_t *a, uint32_t v) {
+    return __atomic_fetch_add(&a->value, v, __ATOMIC_ACQ_REL);
+}
+
+static inline uint32_t atomic_xchg32(atomic_t *a, uint32_t v) {
+    return __atomic_exchange_n(&a->value, v, __ATOMIC_ACQ_REL);
+}
+
+/* 比较交换：成功返回 true；失败时 *expected 更新为当前值 */
+static inline bool atomic_cmpxchg(atomic_t *a, uint32_t *expected, uint32_t desired) {
+    return __atomic_compare_exchange_n(&a->value, expected, desired, false,
+                                       __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+}
+
+static inline uint64_t atomic_load64(const volatile uint64_t *p) {
+    return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+}
+
+static inline bool atomic_cmpxchg64(volatile uint64_t *p, uint64_t *expected, uint64_t desired) {
+    return __atomic_compare_exchange_n(p, expected, desired, false,
+                                       __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+}
+
+#endif // _KERNEL_SYNC_ATOMIC_H_
@@ -0,0 +1,58 @@
+#ifndef _KERNEL_SYNC_FUTEX_H_
+#define _KERNEL_SYNC_FUTEX_H_
+
+#include <types.h>
+
+/*
+ * 快速用户态互斥（futex）
+ *
+ * 用户态在无竞争时只用原子指令操作一个 32 位字，只有需要睡眠或唤醒时
+ * 才进入内核。等待者按该字的物理地址散列到等待队列桶中，因此 fork 后
+ * 共享的页、shmfs 映射等跨进程共享内存上的 futex 也能互相唤醒。
+ * 桶是静态的等待队列，全零即已初始化，无需初始化函数。
+ */
+
+#define FUTEX_WAIT          0
+#define FUTEX_WAKE          1
+#define FUTEX_REQUEUE       3
+#define FUTEX_PRIVATE_FLAG  128     // 兼容 Linux：接受但忽略，一律按物理地址散列
+#define FUTEX_CMD_MASK      (~FUTEX_PRIVATE_FLAG)
+
+#define FUTEX_HASH_SIZE     64
+
+/* 返回负的错误码（与 socket 调用一致） */
+#ifndef EAGAIN
+#define EAGAIN      11
+#endif
+#ifndef EFAULT
+#define EFAULT      14
+#endif
+#ifndef EINVAL
+#define EINVAL      22
+#endif
+#ifndef ETIMEDOUT
+#define ETIMEDOUT   110
+#endif
+
+/**
+ * 若 *uaddr == val 则睡眠，直到被 futex_wake 唤醒或超时
+ * @param timeout_ms 超时（WAIT_FOREVER 表示不超时）
+ * @return 0 被唤醒；-EAGAIN 值已改变；-ETIMEDOUT 超时；-EFAULT 地址无效
+ */
+int futex_wait(volatile uint32_t *uaddr, uint32_t val, uint32_t timeout_ms);
+
+/**
+ * 唤醒最多 nr 个等待在 uaddr 上的任务
+ * @return 唤醒的任务数；-EFAULT 地址无效
+ */
+int futex_wake(volatile uint32_t *uaddr, int nr);
+
+/**
+ * 唤醒最多 nr_wake 个等待在 uaddr 上的任务，其余最多 nr_requeue 个
+ * 不唤醒，转到 uaddr2 上等待（条件变量广播时避免惊群）
+ * @return 唤醒与迁移的任务总数；-EFAULT 地址无效
+ */
+int futex_requeue(volatile uint32_t *uaddr, int nr_wake,
+                  volatile uint32_t *uaddr2, int nr_requeue);
+
+#endif // _KERNEL_SYNC_FUTEX_H_
@@ -0,0 +1,70 @@
+#ifndef _KERNEL_SYNC_LOCKSTAT_H_
+#define _KERNEL_SYNC_LOCKSTAT_H_
+
+#include <types.h>
+#include <kernel/sync/atomic.h>
+
+/*
+ * 锁竞争统计
+ *
+ * 统计按锁类（名字）聚合：同名的多个锁实例（例如每个 FAT32 文件的
+ * 读写信号量）共享一个类。未命名的锁不统计，开销只有一次空指针判断。
+ * 结果通过 /proc/lockstat 导出。
+ */
+
+#define LOCKSTAT_MAX_CLASSES    48
+#define LOCKSTAT_NAME_MAX       24
+
+typedef enum {
+    LOCK_CLASS_MUTEX = 0,
+    LOCK_CLASS_RWLOCK,
+    LOCK_CLASS_RWSEM,
+} lock_class_type_t;
+
+typedef struct lock_class {
+    char name[LOCKSTAT_NAME_MAX];
+    lock_class_type_t type;
+    atomic_t acquisitions;      // 成功获取次数
+    atomic_t contended;         // 需要等待的获取次数
+    atomic_t spin_acquired;     // 自旋期间即获得（未睡眠）的次数
+    atomic_t wait_ms;           // 累计等待时间
+    atomic_t max_wait_ms;       // 单次最长等待时间
+} lock_class_t;
+
+/**
+ * 查找或注册锁类
+ * @param name 锁类名（超长截断）
+ * @return 锁类；池已满时返回 NULL（该锁不统计）
+ */
+lock_class_t *lockstat_class(const char *name, lock_class_type_t type);
+
+static inline void lockstat_acquired(lock_class_t *cls) {
+    if (cls) {
+        atomic_inc_return(&cls->acquisitions);
+    }
+}
+
+/**
+ * 记录一次竞争的开始
+ * @return 开始时刻（ms），传给 lockstat_wait_end
+ */
+uint64_t lockstat_wait_begin(lock_class_t *cls);
+
+/**
+ * 记录一次竞争的结束
+ * @param slept 等待期间是否睡眠过（否则计入 spin_acquired）
+ */
+void lockstat_wait_end(lock_class_t *cls, uint64_t start_ms, bool slept);
+
+/**
+ * 清零所有锁类的计数（保留已注册的类）
+ */
+void lockstat_reset(void);
+
+/**
+ * 输出统计信息到缓冲区（/proc/lockstat）
+ * @return 写入的字节数
+ */
+int lockstat_dump(char *buf, size_t size);
+
+#endif // _KERNEL_SYNC_LOCKSTAT_H_
@@ -3,15 +3,28 @@
 
 #include <types.h>
 #include <kernel/sync/spinlock.h>
+#include <kernel/sync/lockstat.h>
 
+struct task;
+
+/*
+ * 互斥锁（可睡眠、可递归）
+ *
+ * 自适应：获取失败时若持有者正在另一 CPU 上运行，先短暂自旋等待其释放，
+ * 持有者不在运行（被阻塞或等待调度）时才睡眠，省去短临界区的
+ * 睡眠/唤醒开销。
+ */
 typedef struct {
     spinlock_t lock;
     bool locked;
     uint32_t owner_pid;
     uint32_t recursion;
+    struct task *owner;         // 持有者（自旋判断用）
+    lock_class_t *cls;          // 竞争统计（NULL 不统计）
 } mutex_t;
 
 void mutex_init(mutex_t *mutex);
+void mutex_init_named(mutex_t *mutex, const char *name);
 void mutex_lock(mutex_t *mutex);
 bool mutex_try_lock(mutex_t *mutex);
 void mutex_unlock(mutex_t *mutex);
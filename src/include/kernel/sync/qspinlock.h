@@ -0,0 +1,35 @@
+#ifndef _KERNEL_SYNC_QSPINLOCK_H_
+#define _KERNEL_SYNC_QSPINLOCK_H_
+
+#include <types.h>
+#include <kernel/interrupt.h>
+
+/*
+ * 排队自旋锁（MCS 队列锁）
+ *
+ * 用于竞争激烈的全局锁（pmm_lock、heap_lock、task_lock）。无竞争时一次
+ * 比较交换即获得；有竞争时等待者把自己的节点挂到队尾，只在自己的节点上
+ * 自旋，锁的缓存行不会在等待者之间来回传递，并按排队顺序获得锁。
+ *
+ * 节点在等待者的栈上，只在等待期间使用，拿到锁后即离队，因此释放时
+ * 无需节点，接口与 spinlock_t 相同。每次等待各用各的节点，等待中被中断
+ * 或被抢占后再获取其他 qspinlock 都是安全的。
+ */
+
+struct qspin_node;
+
+typedef struct {
+    volatile uint32_t locked;           // 持有标志
+    struct qspin_node *volatile tail;   // 等待队列队尾，NULL 表示无人等待
+} qspinlock_t;
+
+void qspin_init(qspinlock_t *lock);
+void qspin_lock(qspinlock_t *lock);
+bool qspin_try_lock(qspinlock_t *lock);
+void qspin_unlock(qspinlock_t *lock);
+bool qspin_is_locked(const qspinlock_t *lock);
+
+void qspin_lock_irqsave(qspinlock_t *lock, bool *irq_state);
+void qspin_unlock_irqrestore(qspinlock_t *lock, bool irq_state);
+
+#endif // _KERNEL_SYNC_QSPINLOCK_H_
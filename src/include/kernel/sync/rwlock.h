@@ -0,0 +1,41 @@
+#ifndef _KERNEL_SYNC_RWLOCK_H_
+#define _KERNEL_SYNC_RWLOCK_H_
+
+#include <types.h>
+#include <kernel/sync/atomic.h>
+#include <kernel/sync/lockstat.h>
+
+/*
+ * 读写自旋锁
+ *
+ * 用于读多写少、临界区很短且可能在中断上下文访问的数据（路由表、
+ * 网络设备表、ARP 缓存）。多个读者可同时持有，写者独占。
+ * 写者优先：写者登记等待后新的读者自旋，读者源源不断时写者不会饿死；
+ * 因此同一 CPU 上不能递归加读锁。
+ * 与 spinlock_t 一样，可能被中断处理程序获取的锁必须使用 irqsave 版本。
+ */
+
+#define RWLOCK_WRITER   0xFFFFFFFFU
+
+typedef struct {
+    atomic_t state;             // 0 空闲，RWLOCK_WRITER 写者持有，其他为读者数
+    atomic_t writers_waiting;   // 等待写锁的 CPU 数
+    lock_class_t *cls;          // 竞争统计（NULL 不统计）
+} rwlock_t;
+
+void rwlock_init(rwlock_t *lock);
+void rwlock_init_named(rwlock_t *lock, const char *name);
+
+void rwlock_read_lock(rwlock_t *lock);
+bool rwlock_try_read_lock(rwlock_t *lock);
+void rwlock_read_unlock(rwlock_t *lock);
+void rwlock_write_lock(rwlock_t *lock);
+bool rwlock_try_write_lock(rwlock_t *lock);
+void rwlock_write_unlock(rwlock_t *lock);
+
+void rwlock_read_lock_irqsave(rwlock_t *lock, bool *irq_state);
+void rwlock_read_unlock_irqrestore(rwlock_t *lock, bool irq_state);
+void rwlock_write_lock_irqsave(rwlock_t *lock, bool *irq_state);
+void rwlock_write_unlock_irqrestore(rwlock_t *lock, bool irq_state);
+
+#endif // _KERNEL_SYNC_RWLOCK_H_
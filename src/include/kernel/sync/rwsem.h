@@ -0,0 +1,33 @@
+#ifndef _KERNEL_SYNC_RWSEM_H_
+#define _KERNEL_SYNC_RWSEM_H_
+
+#include <types.h>
+#include <kernel/sync/spinlock.h>
+#include <kernel/sync/lockstat.h>
+
+/*
+ * 读写信号量（可睡眠）
+ *
+ * 多个读者可同时持有，写者独占。写者优先：有写者在等待时新的读者
+ * 也要等待，读者源源不断时写者不会饿死。
+ * 不支持递归：持有读锁时再次加读锁，若中间有写者排队会死锁。
+ */
+typedef struct {
+    spinlock_t lock;
+    uint32_t readers;           // 持有读锁的任务数
+    uint32_t writers_waiting;   // 等待写锁的任务数
+    bool writer;                // 写锁已被持有
+    uint32_t owner_pid;         // 写锁持有者
+    lock_class_t *cls;          // 竞争统计（NULL 不统计）
+} rw_semaphore_t;
+
+void rwsem_init(rw_semaphore_t *sem);
+void rwsem_init_named(rw_semaphore_t *sem, const char *name);
+void rwsem_read_lock(rw_semaphore_t *sem);
+bool rwsem_try_read_lock(rw_semaphore_t *sem);
+void rwsem_read_unlock(rw_semaphore_t *sem);
+void rwsem_write_lock(rw_semaphore_t *sem);
+bool rwsem_try_write_lock(rw_semaphore_t *sem);
+void rwsem_write_unlock(rw_semaphore_t *sem);
+
+#endif // _KERNEL_SYNC_RWSEM_H_
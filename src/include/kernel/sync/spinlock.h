@@ -4,10 +4,33 @@
 #include <types.h>
 #include <kernel/interrupt.h>
 
-typedef struct {
+/*
+ * 排队（ticket）自旋锁
+ *
+ * 获取者原子地取号（next++），等到叫号（owner）等于自己的号码；释放者
+ * 只把 owner 加一（release 存储，无需原子读-改-写）。按到达顺序获得锁，
+ * 不会出现 test-and-set 锁的饥饿。全零即未锁定，静态变量无需初始化。
+ * 所支持的架构都是小端，owner 即 value 的低 16 位。
+ */
+typedef union {
     volatile uint32_t value;
+    struct {
+        volatile uint16_t owner;    // 当前叫号
+        volatile uint16_t next;     // 下一个号码
+    } tickets;
 } spinlock_t;
 
+#define SPINLOCK_TICKET_SHIFT   16
+
+/* 自旋等待提示：降低忙等功耗，并让出流水线给超线程兄弟 */
+static inline void cpu_relax(void) {
+#if defined(ARCH_ARM64)
+    __asm__ volatile("yield" ::: "memory");
+#else
+    __asm__ volatile("pause" ::: "memory");
+#endif
+}
+
 void spinlock_init(spinlock_t *lock);
 void spinlock_lock(spinlock_t *lock);
 bool spinlock_try_lock(spinlock_t *lock);
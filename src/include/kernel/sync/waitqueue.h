@@ -0,0 +1,76 @@
+#ifndef _KERNEL_SYNC_WAITQUEUE_H_
+#define _KERNEL_SYNC_WAITQUEUE_H_
+
+#include <types.h>
+#include <kernel/sync/spinlock.h>
+
+/*
+ * 等待队列
+ *
+ * 每个可等待的对象（socket、管道、控制台等）内嵌一个 wait_queue_t，
+ * 等待者把 wait_queue_entry_t 挂到队列上后阻塞，事件发生时对象调用
+ * wait_queue_wake() 只唤醒挂在该队列上的等待者。
+ * 等待项可以是任务（直接唤醒），也可以是回调（epoll 用于收集就绪事件）。
+ * 唤醒可以在中断上下文中进行，回调在持有队列锁时执行，不得阻塞。
+ */
+
+#define WAIT_FOREVER    0xFFFFFFFFU
+
+struct task;
+struct wait_queue;
+struct wait_queue_entry;
+
+typedef void (*wait_queue_func_t)(struct wait_queue_entry *entry, uint32_t key);
+
+// 按条件唤醒/迁移时的匹配函数；可在返回 true 前更新等待项所属对象的私有数据
+typedef bool (*wait_queue_match_t)(struct wait_queue_entry *entry, void *arg);
+
+typedef struct wait_queue_entry {
+    struct task *task;                  // 所属任务（不属于任何任务的回调项为 NULL）
+    wait_queue_func_t func;             // 唤醒回调（NULL 表示直接唤醒 task）
+    void *data;                         // 回调私有数据
+    struct wait_queue *queue;           // 所在队列（未挂入时为 NULL）
+    struct wait_queue_entry *next;
+    struct wait_queue_entry *prev;
+    struct wait_queue_entry *task_next; // 同一任务的等待项链表
+} wait_queue_entry_t;
+
+typedef struct wait_queue {
+    spinlock_t lock;
+    wait_queue_entry_t *head;
+    wait_queue_entry_t *tail;
+} wait_queue_t;
+
+void wait_queue_init(wait_queue_t *wq);
+// 任务等待项：等待者以该等待项为等待对象阻塞（task_block_until(entry, ...)），唤醒时按它匹配
+void wait_queue_entry_init(wait_queue_entry_t *entry, struct task *task);
+void wait_queue_entry_init_func(wait_queue_entry_t *entry, wait_queue_func_t func, void *data);
+
+void wait_queue_add(wait_queue_t *wq, wait_queue_entry_t *entry);
+void wait_queue_remove(wait_queue_entry_t *entry);
+
+// 唤醒全部 / 第一个等待项；key 为事件掩码（POLLIN 等），0 表示不区分
+void wait_queue_wake(wait_queue_t *wq, uint32_t key);
+void wait_queue_wake_one(wait_queue_t *wq, uint32_t key);
+
+// 唤醒并摘除满足 match 的等待项，最多 nr 个；返回唤醒数
+int wait_queue_wake_match(wait_queue_t *wq, wait_queue_match_t match, void *arg, int nr);
+
+// 把满足 match 的等待项（最多 nr 个）移到 to 的队尾，不唤醒；返回迁移数
+int wait_queue_move_match(wait_queue_t *from, wait_queue_t *to,
+                          wait_queue_match_t match, void *arg, int nr);
+
+// 唤醒并摘除全部等待项（队列所在对象即将释放时调用）
+void wait_queue_detach_all(wait_queue_t *wq, uint32_t key);
+
+// 摘除任务挂在所有队列上的等待项（任务被强制终止时调用）
+void wait_queue_detach_task(struct task *task);
+
+// 睡眠直到 cond(arg) 成立；返回 0 成立，-1 超时
+int wait_queue_wait(wait_queue_t *wq, bool (*cond)(void *arg), void *arg, uint32_t timeout_ms);
+
+static inline bool wait_queue_active(const wait_queue_t *wq) {
+    return wq->head != NULL;
+}
+
+#endif // _KERNEL_SYNC_WAITQUEUE_H_
@@ -34,6 +34,7 @@ enum {
     SYS_GETPPID         = 0x0005,
     SYS_SCHED_YIELD     = 0x0006,
     SYS_CLONE           = 0x0007,
+    SYS_FUTEX           = 0x0008,  // 快速用户态互斥（WAIT/WAKE/REQUEUE）
 
     // -------------------- 文件与文件系统 (0x01xx) --------------------
     SYS_OPEN            = 0x0100,
@@ -55,6 +56,13 @@ enum {
     SYS_DUP             = 0x0110,  // 复制文件描述符
     SYS_DUP2            = 0x0111,  // 复制文件描述符到指定编号
     SYS_IOCTL           = 0x0112,  // 设备控制
+    SYS_EPOLL_CREATE    = 0x0113,  // 创建 epoll 实例
+    SYS_EPOLL_CTL       = 0x0114,  // 修改 epoll 兴趣列表
+    SYS_EPOLL_WAIT      = 0x0115,  // 等待 epoll 事件
+    SYS_SPLICE          = 0x0116,  // 管道与文件间搬运数据
+    SYS_SENDFILE        = 0x0117,  // 文件发送到文件/socket
+    SYS_VMSPLICE        = 0x0118,  // 用户内存写入管道
+    SYS_GETDENTS64      = 0x0119,  // 批量读取目录项
 
     // -------------------- 内存管理 (0x02xx) --------------------
     SYS_BRK             = 0x0200,
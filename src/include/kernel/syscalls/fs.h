@@ -130,6 +130,21 @@ uint32_t sys_unlink(const char *path);
  */
 uint32_t sys_getdents(int32_t fd, uint32_t index, void *dirent);
 
+/**
+ * sys_getdents64 - 批量读取目录项
+ * @fd: 目录文件描述符
+ * @buf: 用户空间缓冲区，依次填入 struct dirent64 记录
+ * @count: 缓冲区大小
+ * 
+ * 从描述符的目录流位置继续读取，尽量填满缓冲区；lseek(fd, 0, SEEK_SET) 回到开头。
+ * 
+ * 返回值：
+ *   > 0: 写入的字节数
+ *   0: 已到目录末尾
+ *   (uint32_t)-1: 错误（包括缓冲区放不下一项）
+ */
+uint32_t sys_getdents64(int32_t fd, void *buf, uint32_t count);
+
 /**
  * sys_chdir - 切换当前工作目录
  * @path: 目录路径
@@ -215,6 +230,18 @@ uint32_t sys_dup(int32_t oldfd);
  */
 uint32_t sys_dup2(int32_t oldfd, int32_t newfd);
 
+/**
+ * sys_pipe_fcntl - 管道缓冲区控制（F_SETPIPE_SZ / F_GETPIPE_SZ）
+ * @fd: 管道文件描述符（读端或写端）
+ * @cmd: F_SETPIPE_SZ 或 F_GETPIPE_SZ
+ * @arg: F_SETPIPE_SZ 的目标大小（字节）
+ * 
+ * 返回值：
+ *   > 0: 调整后的缓冲区大小
+ *   (uint32_t)-1: 错误
+ */
+uint32_t sys_pipe_fcntl(int32_t fd, int32_t cmd, int32_t arg);
+
 /**
  * sys_rename - 重命名文件或目录
  * @oldpath: 原路径
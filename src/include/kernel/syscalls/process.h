@@ -55,6 +55,17 @@ uint32_t sys_yield(void);
  */
 uint32_t sys_nanosleep(const struct timespec *req, struct timespec *rem);
 
+/**
+ * sys_futex - 快速用户态互斥
+ * @param uaddr  futex 字地址（4 字节对齐）
+ * @param op     FUTEX_WAIT / FUTEX_WAKE / FUTEX_REQUEUE（可或上 FUTEX_PRIVATE_FLAG）
+ * @param val    WAIT：期望值；WAKE/REQUEUE：唤醒数
+ * @param arg4   WAIT：超时 timespec 指针（NULL 不超时）；REQUEUE：最多迁移数
+ * @param uaddr2 REQUEUE 的目标 futex 字
+ * @return WAIT 成功返回 0，WAKE/REQUEUE 返回任务数；失败返回负的错误码
+ */
+uint32_t sys_futex(uint32_t *uaddr, uint32_t op, uint32_t val, uintptr_t arg4, uint32_t *uaddr2);
+
 /**
  * sys_kill - 向进程发送信号
  * @param pid    目标进程 PID
@@ -196,6 +196,8 @@ typedef struct task {
     uint32_t time_slice;             ///< 时间片（毫秒）
     uint64_t runtime_ms;             ///< 累计运行时间（毫秒）
     uint64_t sleep_until_ms;         ///< 睡眠截止时间（0 表示不睡眠）
+    void *wait_channel;              ///< 阻塞时等待的对象（NULL 表示未指定）
+    struct wait_queue_entry *wait_entries; ///< 挂在各等待队列上的等待项（被杀死时摘除）
     
     /* CPU 上下文 */
     cpu_context_t context;           ///< CPU 寄存器状态
@@ -308,10 +310,31 @@ void task_block(void *wait_object);
 /**
  * @brief 唤醒等待在指定对象上的一个任务
  * 
- * @param wait_object 等待对象指针（用于调试）
+ * @param wait_object 等待对象指针（NULL 时不唤醒任何任务）
  */
 void task_wakeup(void *wait_object);
 
+/**
+ * @brief 阻塞当前任务直到被唤醒或超时
+ * 
+ * 调用者通常已关中断并把自己挂到等待队列上，返回后应重新检查等待条件。
+ * 
+ * @param wait_object 等待对象（task_wakeup 按此匹配）
+ * @param deadline_ms 超时时刻（timer_get_uptime_ms 时间基准，0 表示不超时）
+ */
+void task_block_until(void *wait_object, uint64_t deadline_ms);
+
+/**
+ * @brief 唤醒阻塞在指定对象上的任务
+ * 
+ * 只有任务正阻塞在 wait_object 上时才唤醒，不会打断睡眠或其他等待。
+ * 
+ * @param task 任务
+ * @param wait_object 任务阻塞时的等待对象
+ * @return 任务被唤醒返回 true
+ */
+bool task_wake(task_t *task, void *wait_object);
+
 /**
  * @brief 从中断上下文调度
  * 
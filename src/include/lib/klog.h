@@ -1,6 +1,8 @@
 #ifndef _LIB_KLOG_H_
 #define _LIB_KLOG_H_
 
+#include <types.h>
+
 /**
  * 内核日志系统
  * 
@@ -8,8 +10,26 @@
  * - 根据日志等级过滤
  * - ANSI 彩色输出（VGA 和串口终端）
  * - 可配置输出目标（VGA、串口或两者）
+ *
+ * klog() 只把格式化后的消息连同时间戳、等级、CPU 写入日志环（无锁：原子取
+ * 序号占槽，写完后发布），任何上下文（包括中断）都可调用。控制台输出由 drain
+ * 完成：klogd 线程启动前、panic 时、WARN 及以上等级以及积压超过环的 3/4 时
+ * 由调用者当场输出，其余时候交给 klogd。kprintf 等直接输出前会先输出积压的日志，保持先后顺序。
+ * 环满时最旧的记录被覆盖，控制台没来得及输出的计入 lost。
  */
 
+#define KLOG_RING_SIZE          256     // 日志环记录数（2 的幂）
+#define KLOG_MSG_MAX            160     // 单条消息最大长度（含结尾 '\0'），超长截断
+#define KLOG_LEVEL_COUNT        4
+#define KLOG_DRAIN_INTERVAL_MS  20      // klogd 检查积压的周期
+
+/* 默认只限制 DEBUG：每个窗口最多输出的条数 */
+#define KLOG_RATELIMIT_INTERVAL_MS  1000
+#define KLOG_RATELIMIT_DEBUG_BURST  100
+
+/* /proc/kmsg 的最大内容：每条记录另有 "<6>[nnnnn.nnn] " 前缀 */
+#define KLOG_DUMP_BUF_SIZE      (KLOG_RING_SIZE * (KLOG_MSG_MAX + 24))
+
 /* 日志等级 */
 typedef enum {
     LOG_DEBUG = 0,  // 调试信息（灰色）
@@ -18,6 +38,14 @@ typedef enum {
     LOG_ERROR = 3,  // 错误信息（红色）
 } log_level_t;
 
+typedef struct klog_stats {
+    uint32_t records;                       // 写入日志环的记录
+    uint32_t lost;                          // 未输出到控制台就被覆盖的记录
+    uint32_t truncated;                     // 超长被截断的消息
+    uint32_t suppressed[KLOG_LEVEL_COUNT];  // 被限速丢弃的消息（按等级）
+    uint32_t direct_drains;                 // klogd 运行后调用者因积压当场输出的次数
+} klog_stats_t;
+
 /* 日志输出目标 */
 typedef enum {
     LOG_TARGET_SERIAL = 0x01,  // 仅串口
@@ -58,6 +86,38 @@ log_target_t klog_get_target(void);
  */
 void klog(log_level_t level, const char *fmt, ...) __attribute__((format(printf, 2, 3)));
 
+/**
+ * 设置某个等级的限速：每 interval_ms 最多 burst 条，burst 为 0 表示不限
+ * 窗口结束后的第一条消息前会补一条被抑制条数的说明
+ */
+void klog_set_ratelimit(log_level_t level, uint32_t burst, uint32_t interval_ms);
+
+/**
+ * 把日志环中尚未输出的记录写到控制台
+ * 已有其他输出者时直接返回（由它负责输出）
+ */
+void klog_flush(void);
+
+/**
+ * 启动 klogd 线程，此后控制台输出改为延迟进行（在 task_init 之后调用）
+ */
+void klog_start_thread(void);
+
+/**
+ * 进入 panic 模式：强制取得输出权并同步输出积压的记录，此后每条日志都当场输出
+ * 调用前须已关中断
+ */
+void klog_panic_mode(void);
+
+void klog_get_stats(klog_stats_t *stats);
+
+/**
+ * 生成 /proc/kmsg 内容：环中现存的记录，每行 "<级别>[秒.毫秒] 消息"
+ * 级别按 syslog 编号（7 调试，6 信息，4 警告，3 错误）
+ * @return 写入的字节数
+ */
+int klog_dump(char *buf, size_t size);
+
 /**
  * 便捷宏：输出调试信息
  */
@@ -134,6 +134,12 @@ void kputchar_vga(char c);
  */
 int ksnprintf(char *str, size_t size, const char *fmt, ...) __attribute__((format(printf, 3, 4)));
 
+/**
+ * 格式化输出到字符串缓冲区（va_list 版本）
+ * @return 写入的字符数（不包括 \0）
+ */
+int vksnprintf(char *str, size_t size, const char *fmt, va_list args);
+
 /* ============================================================================
  * 控制台颜色和清屏（自动适配 VGA 文本模式和帧缓冲图形模式）
  * ============================================================================ */
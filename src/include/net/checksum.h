@@ -10,6 +10,8 @@
 
 #include <types.h>
 
+struct netbuf;
+
 /**
  * @brief 计算 Internet 校验和
  * @param data 数据指针
@@ -42,5 +44,31 @@ uint16_t checksum_finish(uint32_t sum);
  */
 bool checksum_verify(void *data, int len);
 
+/**
+ * @brief 计算 TCP/UDP 伪首部的部分和
+ * @param src_ip 源 IP（网络字节序）
+ * @param dst_ip 目的 IP（网络字节序）
+ * @param protocol 协议号
+ * @param len 传输层长度（主机字节序）
+ * @return 折叠后的 16 位和（未取反）
+ */
+uint16_t checksum_pseudo(uint32_t src_ip, uint32_t dst_ip, uint8_t protocol, uint16_t len);
+
+/**
+ * @brief 将传输层校验和标记为延迟计算
+ * @param buf 缓冲区
+ * @param l4 传输层头部（位于 buf 线性区内）
+ * @param csum_offset 校验和字段相对 l4 的偏移
+ * @param src_ip 源 IP（网络字节序）
+ * @param dst_ip 目的 IP（网络字节序）
+ * @param protocol 协议号
+ * @param len 传输层长度（主机字节序）
+ * 
+ * 字段中先写入伪首部和，由支持 NETDEV_F_HW_CSUM 的网卡完成计算；
+ * 其他设备在 netdev_transmit() 中由 netbuf_checksum_help() 软件补全。
+ */
+void checksum_l4_partial(struct netbuf *buf, void *l4, uint16_t csum_offset,
+                         uint32_t src_ip, uint32_t dst_ip, uint8_t protocol, uint16_t len);
+
 #endif // _NET_CHECKSUM_H_
 
@@ -12,18 +12,56 @@
  * +------------------+
  * |   tailroom       |  <- 预留空间
  * +------------------+
+ * 
+ * 内存管理:
+ * - 数据块来自按尺寸分级的预分配池（256/512/2048），无锁空闲栈，
+ *   空闲数低于水位线时自动补充；池耗尽时回退到 kmalloc。
+ * - 数据块带引用计数，netbuf_share() 只增加引用，O(1) 共享数据。
+ * - 可挂载最多 NETBUF_MAX_FRAGS 个页分片，载荷无需线性化即可发送。
  */
 
 #ifndef _NET_NETBUF_H_
 #define _NET_NETBUF_H_
 
 #include <types.h>
+#include <mm/mm_types.h>
+#include <kernel/sync/atomic.h>
+#include <kernel/sync/spinlock.h>
 
 #define NETBUF_MAX_SIZE     2048    // 最大缓冲区大小
 #define NETBUF_HEADROOM     128     // 预留头部空间（用于协议头）
+#define NETBUF_MAX_FRAGS    4       // 每个缓冲区最多挂载的页分片数
+#define NETBUF_NUM_CLASSES  3       // 预分配池尺寸级别数
+#define NETBUF_DESC_COUNT   1024    // 静态预分配的 netbuf 描述符数量
+
+/* 校验和状态（netbuf_t.csum_flags） */
+#define NETBUF_CSUM_IP_VALID    (1 << 0)    // RX：网卡已验证 IP 头校验和
+#define NETBUF_CSUM_L4_VALID    (1 << 1)    // RX：网卡已验证 TCP/UDP 校验和
+#define NETBUF_CSUM_PARTIAL     (1 << 2)    // TX：传输层校验和待完成（字段中为伪首部和）
 
 // 前向声明
 struct netdev;
+struct netbuf_pool;
+
+/**
+ * @brief 池数据块（可被多个 netbuf 共享）
+ */
+typedef struct netbuf_block {
+    uint8_t *virt;              ///< 数据块虚拟地址
+    paddr_t phys;               ///< 数据块物理地址（块不跨页，可直接 DMA）
+    atomic_t refcount;          ///< 引用计数（共享该块的 netbuf 数）
+    uint32_t next_free;         ///< 空闲栈中下一块的序号 + 1（0 表示栈底）
+    struct netbuf_pool *pool;   ///< 所属池
+} netbuf_block_t;
+
+/**
+ * @brief 页分片（scatter-gather）
+ */
+typedef struct netbuf_frag {
+    paddr_t page;               ///< 物理页（持有一个 PMM 引用）
+    uint16_t offset;            ///< 页内偏移
+    uint16_t len;               ///< 分片长度（不跨页）
+} netbuf_frag_t;
 
 /**
  * @brief 网络缓冲区结构
@@ -34,7 +72,7 @@ typedef struct netbuf {
     uint8_t *tail;          ///< 数据结束地址
     uint8_t *end;           ///< 缓冲区结束地址
     
-    uint32_t len;           ///< 数据长度
+    uint32_t len;           ///< 线性数据长度（不含分片）
     uint32_t total_size;    ///< 缓冲区总大小
     
     // 协议相关指针（用于快速访问各层头部）
@@ -50,8 +88,50 @@ typedef struct netbuf {
     uint16_t src_port;      ///< 源端口（主机字节序）
     
     struct netbuf *next;    ///< 链表指针（用于队列）
+    
+    // 校验和卸载
+    uint8_t csum_flags;     ///< NETBUF_CSUM_* 标志
+    uint16_t csum_start;    ///< PARTIAL：校验范围起点（相对 head 的偏移）
+    uint16_t csum_offset;   ///< PARTIAL：校验和字段相对起点的偏移
+    uint16_t gso_size;      ///< TX：TCP 分段大小（非 0 时由网卡按此分段，需 NETDEV_F_TSO）
+    
+    // 内存管理
+    netbuf_block_t *block;  ///< 共享数据块（NULL 表示 head 由 kmalloc 独占分配）
+    
+    // 分片（位于线性数据之后）
+    uint8_t nr_frags;                       ///< 分片数量
+    uint32_t frag_len;                      ///< 分片数据总长度
+    netbuf_frag_t frags[NETBUF_MAX_FRAGS];  ///< 分片数组
 } netbuf_t;
 
+/**
+ * @brief 预分配网络缓冲区池（单一尺寸级别）
+ * 
+ * 数据块从物理页帧中切分（每页 PAGE_SIZE / buf_size 个），不跨越页边界，
+ * 因此可以直接作为网卡 DMA 的目标地址。空闲块组成无锁栈（带版本号防 ABA），
+ * 分配/释放可在中断上下文中进行；空闲数低于 low_water 时补充 refill_batch 个块，
+ * 直到达到 capacity。
+ */
+typedef struct netbuf_pool {
+    uint32_t buf_size;          ///< 每块大小（含 headroom）
+    uint32_t capacity;          ///< 最大块数
+    netbuf_block_t *blocks;     ///< 块数组（capacity 个）
+    volatile uint64_t free_head;///< 空闲栈顶：高 32 位版本号，低 32 位块序号 + 1
+    atomic_t count;             ///< 已填充的块数
+    atomic_t free_count;        ///< 当前空闲块数
+    uint32_t min_free;          ///< 历史最低空闲数
+    uint32_t low_water;         ///< 补充水位线
+    uint32_t refill_batch;      ///< 每次补充的块数
+    uint64_t allocs;            ///< 成功分配次数
+    uint64_t alloc_failures;    ///< 池耗尽导致的分配失败次数
+    spinlock_t grow_lock;       ///< 补充锁（只在慢路径上 try_lock）
+} netbuf_pool_t;
+
+/**
+ * @brief 初始化网络缓冲区子系统（预分配各尺寸级别的池）
+ */
+void netbuf_init(void);
+
 /**
  * @brief 分配网络缓冲区
  * @param size 数据区大小
@@ -90,9 +170,12 @@ uint8_t *netbuf_pull(netbuf_t *buf, uint32_t len);
 uint8_t *netbuf_put(netbuf_t *buf, uint32_t len);
 
 /**
- * @brief 复制缓冲区
+ * @brief 克隆缓冲区（等同 netbuf_share()）
  * @param buf 源缓冲区
- * @return 新缓冲区的副本，失败返回 NULL
+ * @return 与源共享数据区的新缓冲区，失败返回 NULL
+ * 
+ * 数据块和分片都以引用方式共享，O(1) 完成；修改数据前须调用
+ * netbuf_unshare() 得到独占副本。
  */
 netbuf_t *netbuf_clone(netbuf_t *buf);
 
@@ -116,5 +199,117 @@ uint32_t netbuf_headroom(netbuf_t *buf);
  */
 uint32_t netbuf_tailroom(netbuf_t *buf);
 
-#endif // _NET_NETBUF_H_
+/**
+ * @brief 初始化预分配缓冲区池
+ * @param pool 池结构
+ * @param buf_size 每块大小（必须整除 PAGE_SIZE）
+ * @param initial 初始填充块数
+ * @param capacity 最大块数（>= initial；等于 initial 时不会补充）
+ * @return 0 成功，-1 失败
+ */
+int netbuf_pool_init(netbuf_pool_t *pool, uint32_t buf_size,
+                     uint32_t initial, uint32_t capacity);
+
+/**
+ * @brief 补充池中的空闲块
+ * @param pool 池结构
+ * @return 新增的块数
+ * 
+ * 分配路径在空闲数低于水位线时自动调用；并发调用时只有一个生效。
+ */
+uint32_t netbuf_pool_refill(netbuf_pool_t *pool);
+
+/**
+ * @brief 从池中取出一个缓冲区
+ * @param pool 池结构
+ * @return 已重置的缓冲区，池耗尽返回 NULL
+ * 
+ * 可在中断上下文中调用。返回的缓冲区由 netbuf_free() 归还。
+ */
+netbuf_t *netbuf_pool_alloc(netbuf_pool_t *pool);
 
+/**
+ * @brief 销毁缓冲区池，归还所有页帧
+ * @param pool 池结构
+ * @return 0 成功，-1 仍有缓冲区未归还
+ */
+int netbuf_pool_destroy(netbuf_pool_t *pool);
+
+/**
+ * @brief 获取缓冲区中某地址的物理地址（用于 DMA）
+ * @param buf 缓冲区
+ * @param ptr 缓冲区内的地址（通常为 buf->data）
+ * @return 物理地址，失败返回 0
+ * 
+ * 池缓冲区直接由数据块物理地址计算；堆缓冲区通过页表查询。
+ */
+paddr_t netbuf_dma_addr(netbuf_t *buf, const uint8_t *ptr);
+
+/**
+ * @brief 共享缓冲区（O(1) 克隆）
+ * @param buf 源缓冲区
+ * @return 与源共享数据块的新缓冲区，失败返回 NULL
+ * 
+ * 新缓冲区有独立的 data/tail/len，但数据区与源共享，只应读取；
+ * 需要修改时先调用 netbuf_unshare()。堆缓冲区无法共享，退化为线性数据深拷贝。
+ */
+netbuf_t *netbuf_share(netbuf_t *buf);
+
+/**
+ * @brief 判断数据区是否被多个缓冲区共享
+ */
+bool netbuf_is_shared(netbuf_t *buf);
+
+/**
+ * @brief 确保数据区独占（共享时复制一份）
+ * @param buf 缓冲区
+ * @return 0 成功，-1 失败（buf 保持不变）
+ */
+int netbuf_unshare(netbuf_t *buf);
+
+/**
+ * @brief 在缓冲区末尾挂载一个页分片
+ * @param buf 缓冲区
+ * @param page 物理页地址（页对齐）
+ * @param offset 页内偏移
+ * @param len 分片长度（offset + len 不得超过 PAGE_SIZE）
+ * @return 0 成功，-1 失败
+ * 
+ * 会对页增加一个 PMM 引用，缓冲区释放时归还；调用者保留自己的引用。
+ */
+int netbuf_add_frag(netbuf_t *buf, paddr_t page, uint32_t offset, uint32_t len);
+
+/**
+ * @brief 获取分片数据的内核虚拟地址
+ */
+static inline uint8_t *netbuf_frag_addr(const netbuf_frag_t *frag) {
+    return (uint8_t *)PHYS_TO_VIRT((uintptr_t)frag->page) + frag->offset;
+}
+
+/**
+ * @brief 获取数据包总长度（线性数据 + 分片）
+ */
+static inline uint32_t netbuf_total_len(const netbuf_t *buf) {
+    return buf->len + buf->frag_len;
+}
+
+/**
+ * @brief 把分片数据复制到线性区并释放分片
+ * @param buf 缓冲区
+ * @return 0 成功，-1 内存不足（buf 保持不变）
+ * 
+ * 用于不支持 scatter-gather 的设备或需要连续数据的协议处理。
+ * tailroom 不足时把线性数据搬到更大的数据块。
+ */
+int netbuf_linearize(netbuf_t *buf);
+
+/**
+ * @brief 用软件完成延迟计算的传输层校验和
+ * @param buf 缓冲区（带 NETBUF_CSUM_PARTIAL 标志）
+ * @return 0 成功，-1 失败
+ * 
+ * 用于不支持校验和卸载的设备；完成后清除 PARTIAL 标志。
+ */
+int netbuf_checksum_help(netbuf_t *buf);
+
+#endif // _NET_NETBUF_H_
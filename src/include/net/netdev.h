@@ -16,6 +16,11 @@
 #define MAC_ADDR_LEN        6       ///< MAC 地址长度
 #define MAX_NETDEV          4       ///< 最大网络设备数
 
+/* 设备特性标志（netdev_t.features） */
+#define NETDEV_F_SG         (1u << 0)   ///< 支持 scatter-gather（可直接发送带分片的缓冲区）
+#define NETDEV_F_HW_CSUM    (1u << 1)   ///< 支持 TCP/UDP 发送校验和卸载（NETBUF_CSUM_PARTIAL）
+#define NETDEV_F_TSO        (1u << 2)   ///< 支持 TCP 分段卸载（netbuf_t.gso_size）
+
 /**
  * @brief 网络设备状态
  */
@@ -34,6 +39,7 @@ typedef struct netdev_ops {
     int (*close)(struct netdev *dev);                       ///< 关闭设备
     int (*transmit)(struct netdev *dev, netbuf_t *buf);     ///< 发送数据包
     int (*set_mac)(struct netdev *dev, uint8_t *mac);       ///< 设置 MAC 地址
+    void (*print_stats)(struct netdev *dev);                ///< 打印驱动私有统计（可选）
 } netdev_ops_t;
 
 /**
@@ -48,6 +54,7 @@ typedef struct netdev {
     
     netdev_state_t state;           ///< 设备状态
     uint16_t mtu;                   ///< 最大传输单元
+    uint32_t features;              ///< 设备特性（NETDEV_F_*）
     
     // 统计信息
     uint64_t rx_packets;            ///< 接收数据包数
@@ -135,6 +142,9 @@ int netdev_down(netdev_t *dev);
  * @param dev 设备结构
  * @param buf 网络缓冲区
  * @return 0 成功，-1 失败
+ * 
+ * 成功时 buf 的所有权转移给驱动（驱动可能直接对其 DMA，发送完成后释放）；
+ * 失败时由调用者负责释放。
  */
 int netdev_transmit(netdev_t *dev, netbuf_t *buf);
 
@@ -177,6 +177,17 @@ int sys_connect(int sockfd, const struct sockaddr *addr, socklen_t addrlen);
  */
 ssize_t sys_send(int sockfd, const void *buf, size_t len, int flags);
 
+/**
+ * @brief 从内核缓冲区发送流数据（sendfile/splice 使用）
+ * @param sockfd 已连接的 TCP socket 描述符
+ * @param data 内核缓冲区
+ * @param len 数据长度
+ * @return 发送的字节数，-1 失败
+ * 
+ * 按 MSS 切分后直接交给 tcp_write，避免发送缓冲区积压。
+ */
+ssize_t socket_sendpage(int sockfd, const uint8_t *data, uint32_t len);
+
 /**
  * @brief 发送数据到指定地址
  */
@@ -247,6 +258,8 @@ int sys_fcntl(int sockfd, int cmd, int arg);
 
 /**
  * @brief 多路复用 I/O
+ *
+ * 描述符先按 socket 查找，不是 socket 时按进程 fd 表中的文件查询（管道、控制台等）
  * @param nfds 最大文件描述符 + 1
  * @param readfds 读集合（输入/输出）
  * @param writefds 写集合（输入/输出）
@@ -257,5 +270,15 @@ int sys_fcntl(int sockfd, int cmd, int arg);
 int sys_select(int nfds, fd_set *readfds, fd_set *writefds,
                fd_set *exceptfds, struct timeval *timeout);
 
+struct poll_table;
+
+/**
+ * @brief 查询 socket 就绪事件
+ * @param sockfd socket 描述符
+ * @param pt 登记表（NULL 表示只查询，不挂等待项）
+ * @return POLLIN/POLLOUT/POLLERR/POLLHUP 等事件掩码，无效描述符返回 POLLNVAL
+ */
+uint32_t socket_poll(int sockfd, struct poll_table *pt);
+
 #endif // _NET_SOCKET_H_
 
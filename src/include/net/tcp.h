@@ -25,6 +25,7 @@
 #include <net/netbuf.h>
 #include <net/netdev.h>
 #include <kernel/sync/mutex.h>
+#include <kernel/sync/waitqueue.h>
 
 #define TCP_HEADER_MIN_LEN  20      ///< TCP 最小头部长度
 
@@ -113,7 +114,7 @@ typedef struct tcp_pseudo_header {
 typedef struct tcp_segment {
     uint32_t seq;               ///< 段序列号
     uint32_t len;               ///< 段长度（包括 SYN/FIN 标志）
-    uint8_t *data;              ///< 数据副本
+    paddr_t page;               ///< 数据副本所在物理页（无数据时为 0），发送时作为分片挂载
     uint32_t data_len;          ///< 实际数据长度
     uint8_t flags;              ///< TCP 标志
     uint32_t send_time;         ///< 发送时间（毫秒）
@@ -211,6 +212,7 @@ typedef struct tcp_pcb {
     
     // 同步
     mutex_t lock;
+    wait_queue_t wait;          ///< 就绪事件等待队列（select/epoll）
     
     // 链表指针
     struct tcp_pcb *next;
@@ -18,6 +18,7 @@
 #include <types.h>
 #include <net/netbuf.h>
 #include <net/netdev.h>
+#include <kernel/sync/waitqueue.h>
 
 #define UDP_HEADER_LEN  8   ///< UDP 头部长度
 
@@ -60,6 +61,8 @@ typedef struct udp_pcb {
                          uint32_t src_ip, uint16_t src_port);
     void *callback_arg;         ///< 回调参数
     
+    wait_queue_t wait;          ///< 可读事件等待队列（select/epoll）
+    
     struct udp_pcb *next;       ///< 链表指针
 } udp_pcb_t;
 
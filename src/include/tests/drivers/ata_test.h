@@ -0,0 +1,10 @@
+// ============================================================================
+// ata_test.h - ATA 驱动测试头文件
+// ============================================================================
+
+#ifndef _TESTS_DRIVERS_ATA_TEST_H_
+#define _TESTS_DRIVERS_ATA_TEST_H_
+
+void run_ata_tests(void);
+
+#endif // _TESTS_DRIVERS_ATA_TEST_H_
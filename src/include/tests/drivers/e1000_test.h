@@ -0,0 +1,10 @@
+// ============================================================================
+// e1000_test.h - E1000 驱动测试头文件
+// ============================================================================
+
+#ifndef _TESTS_DRIVERS_E1000_TEST_H_
+#define _TESTS_DRIVERS_E1000_TEST_H_
+
+void run_e1000_tests(void);
+
+#endif // _TESTS_DRIVERS_E1000_TEST_H_
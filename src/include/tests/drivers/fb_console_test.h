@@ -0,0 +1,10 @@
+// ============================================================================
+// fb_console_test.h - 帧缓冲控制台测试头文件
+// ============================================================================
+
+#ifndef _TESTS_DRIVERS_FB_CONSOLE_TEST_H_
+#define _TESTS_DRIVERS_FB_CONSOLE_TEST_H_
+
+void run_fb_console_tests(void);
+
+#endif // _TESTS_DRIVERS_FB_CONSOLE_TEST_H_
@@ -0,0 +1,10 @@
+// ============================================================================
+// usb_msc_test.h - USB 大容量存储驱动测试头文件
+// ============================================================================
+
+#ifndef _TESTS_DRIVERS_USB_MSC_TEST_H_
+#define _TESTS_DRIVERS_USB_MSC_TEST_H_
+
+void run_usb_msc_tests(void);
+
+#endif // _TESTS_DRIVERS_USB_MSC_TEST_H_
@@ -0,0 +1,10 @@
+// ============================================================================
+// virtio_blk_test.h - virtqueue / virtio-blk 测试头文件
+// ============================================================================
+
+#ifndef _TESTS_DRIVERS_VIRTIO_BLK_TEST_H_
+#define _TESTS_DRIVERS_VIRTIO_BLK_TEST_H_
+
+void run_virtio_blk_tests(void);
+
+#endif // _TESTS_DRIVERS_VIRTIO_BLK_TEST_H_
@@ -0,0 +1,10 @@
+// ============================================================================
+// virtio_net_test.h - virtio-net 驱动测试头文件
+// ============================================================================
+
+#ifndef _TESTS_DRIVERS_VIRTIO_NET_TEST_H_
+#define _TESTS_DRIVERS_VIRTIO_NET_TEST_H_
+
+void run_virtio_net_tests(void);
+
+#endif // _TESTS_DRIVERS_VIRTIO_NET_TEST_H_
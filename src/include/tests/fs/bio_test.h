@@ -0,0 +1,10 @@
+// ============================================================================
+// bio_test.h - 块 I/O 请求层测试头文件
+// ============================================================================
+
+#ifndef _TESTS_FS_BIO_TEST_H_
+#define _TESTS_FS_BIO_TEST_H_
+
+void run_bio_tests(void);
+
+#endif // _TESTS_FS_BIO_TEST_H_
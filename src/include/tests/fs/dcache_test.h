@@ -0,0 +1,10 @@
+// ============================================================================
+// dcache_test.h - 目录项缓存测试头文件
+// ============================================================================
+
+#ifndef _TESTS_FS_DCACHE_TEST_H_
+#define _TESTS_FS_DCACHE_TEST_H_
+
+void run_dcache_tests(void);
+
+#endif // _TESTS_FS_DCACHE_TEST_H_
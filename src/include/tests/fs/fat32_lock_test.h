@@ -0,0 +1,10 @@
+// ============================================================================
+// fat32_lock_test.h - FAT32 细粒度锁测试头文件
+// ============================================================================
+
+#ifndef _TESTS_FS_FAT32_LOCK_TEST_H_
+#define _TESTS_FS_FAT32_LOCK_TEST_H_
+
+void run_fat32_lock_tests(void);
+
+#endif // _TESTS_FS_FAT32_LOCK_TEST_H_
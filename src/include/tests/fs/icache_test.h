@@ -0,0 +1,10 @@
+// ============================================================================
+// icache_test.h - inode 缓存测试头文件
+// ============================================================================
+
+#ifndef _TESTS_FS_ICACHE_TEST_H_
+#define _TESTS_FS_ICACHE_TEST_H_
+
+void run_icache_tests(void);
+
+#endif // _TESTS_FS_ICACHE_TEST_H_
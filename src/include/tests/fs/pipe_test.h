@@ -0,0 +1,10 @@
+// ============================================================================
+// pipe_test.h - 管道测试头文件
+// ============================================================================
+
+#ifndef _TESTS_FS_PIPE_TEST_H_
+#define _TESTS_FS_PIPE_TEST_H_
+
+void run_pipe_tests(void);
+
+#endif // _TESTS_FS_PIPE_TEST_H_
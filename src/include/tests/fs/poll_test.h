@@ -0,0 +1,10 @@
+// ============================================================================
+// poll_test.h - epoll / select 测试头文件
+// ============================================================================
+
+#ifndef _TESTS_FS_POLL_TEST_H_
+#define _TESTS_FS_POLL_TEST_H_
+
+void run_poll_tests(void);
+
+#endif // _TESTS_FS_POLL_TEST_H_
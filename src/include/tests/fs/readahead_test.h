@@ -0,0 +1,10 @@
+// ============================================================================
+// readahead_test.h - FAT32 预读测试头文件
+// ============================================================================
+
+#ifndef _TESTS_FS_READAHEAD_TEST_H_
+#define _TESTS_FS_READAHEAD_TEST_H_
+
+void run_readahead_tests(void);
+
+#endif // _TESTS_FS_READAHEAD_TEST_H_
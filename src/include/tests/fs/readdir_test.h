@@ -0,0 +1,10 @@
+// ============================================================================
+// readdir_test.h - 目录流游标测试头文件
+// ============================================================================
+
+#ifndef _TESTS_FS_READDIR_TEST_H_
+#define _TESTS_FS_READDIR_TEST_H_
+
+void run_readdir_tests(void);
+
+#endif // _TESTS_FS_READDIR_TEST_H_
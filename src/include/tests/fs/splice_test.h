@@ -0,0 +1,10 @@
+// ============================================================================
+// splice_test.h - splice 测试头文件
+// ============================================================================
+
+#ifndef _TESTS_FS_SPLICE_TEST_H_
+#define _TESTS_FS_SPLICE_TEST_H_
+
+void run_splice_tests(void);
+
+#endif // _TESTS_FS_SPLICE_TEST_H_
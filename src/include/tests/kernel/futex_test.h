@@ -0,0 +1,10 @@
+// ============================================================================
+// futex_test.h - futex 测试头文件
+// ============================================================================
+
+#ifndef _TESTS_KERNEL_FUTEX_TEST_H_
+#define _TESTS_KERNEL_FUTEX_TEST_H_
+
+void run_futex_tests(void);
+
+#endif // _TESTS_KERNEL_FUTEX_TEST_H_
@@ -0,0 +1,10 @@
+// ============================================================================
+// lock_torture_test.h - 自旋锁压力测试头文件
+// ============================================================================
+
+#ifndef _TESTS_KERNEL_LOCK_TORTURE_TEST_H_
+#define _TESTS_KERNEL_LOCK_TORTURE_TEST_H_
+
+void run_lock_torture_tests(void);
+
+#endif // _TESTS_KERNEL_LOCK_TORTURE_TEST_H_
@@ -0,0 +1,10 @@
+// ============================================================================
+// waitqueue_test.h - 等待队列测试头文件
+// ============================================================================
+
+#ifndef _TESTS_KERNEL_WAITQUEUE_TEST_H_
+#define _TESTS_KERNEL_WAITQUEUE_TEST_H_
+
+void run_waitqueue_tests(void);
+
+#endif // _TESTS_KERNEL_WAITQUEUE_TEST_H_
@@ -139,6 +139,14 @@ void _assert_ne_str(const char* expected, const char* actual,
         unittest_end_suite(); \
     } while (0)
 
+// 基准测试规模：默认只跑冒烟规模，保证 make test 在超时内跑完；
+// make bench（定义 KTEST_BENCH）才按完整规模运行
+#ifdef KTEST_BENCH
+#define KTEST_BENCH_SIZE(full, smoke) (full)
+#else
+#define KTEST_BENCH_SIZE(full, smoke) (smoke)
+#endif
+
 // ============================================================================
 // 断言宏
 // ============================================================================
@@ -57,6 +57,11 @@ typedef unsigned char bool;
 #define NULL ((void *)0)
 #endif
 
+// 结构体成员偏移
+#ifndef offsetof
+#define offsetof(type, member) __builtin_offsetof(type, member)
+#endif
+
 #define PAGE_SIZE           4096
 #define PAGE_SHIFT          12
 
@@ -102,6 +107,15 @@ struct dirent {
     char     d_name[256];    // 文件名（以 null 结尾，最大 255 字符）
 };
 
+// getdents64 返回的变长目录项记录（布局与 Linux linux_dirent64 一致）
+struct dirent64 {
+    uint64_t d_ino;         // inode 编号
+    int64_t  d_off;         // 下一项在目录流中的位置
+    uint16_t d_reclen;      // 此记录的长度（8 字节对齐）
+    uint8_t  d_type;        // 文件类型（DT_* 常量）
+    char     d_name[];      // 文件名（以 null 结尾）
+};
+
 // 进程状态（用于 proc_info，与内核 task_state_t 对应）
 #define PROC_STATE_UNUSED    0   // 未使用
 #define PROC_STATE_READY     1   // 就绪
@@ -24,6 +24,7 @@ void fd_table_init(fd_table_t *table) {
         table->entries[i].node = NULL;
         table->entries[i].offset = 0;
         table->entries[i].flags = 0;
+        memset(&table->entries[i].dir_pos, 0, sizeof(dir_cursor_t));
         table->entries[i].in_use = false;
     }
 }
@@ -42,6 +43,7 @@ int32_t fd_table_alloc(fd_table_t *table, fs_node_t *node, int32_t flags) {
             table->entries[i].node = node;
             table->entries[i].offset = 0;
             table->entries[i].flags = flags;
+            memset(&table->entries[i].dir_pos, 0, sizeof(dir_cursor_t));
             table->entries[i].in_use = true;
             
             // 增加节点引用计数
@@ -101,7 +103,7 @@ int32_t fd_table_free(fd_table_t *table, int32_t fd) {
     // 在解锁后关闭文件和释放节点
     // 避免在持有锁的情况下调用可能阻塞的 VFS 操作
     if (node) {
-        if (node->close) {
+        if (node->ops && node->ops->close) {
             vfs_close(node);
         }
         // 释放动态分配的节点
@@ -137,6 +139,7 @@ int32_t fd_table_copy(fd_table_t *src, fd_table_t *dst) {
             dst->entries[i].node = src->entries[i].node;
             dst->entries[i].offset = src->entries[i].offset;
             dst->entries[i].flags = src->entries[i].flags;
+            dst->entries[i].dir_pos = src->entries[i].dir_pos;
             dst->entries[i].in_use = true;
             
             // 关键修复：增加引用计数，因为现在有两个fd指向同一个节点
@@ -13,6 +13,9 @@
 // ============================================================================
 
 #include <drivers/serial.h>
+#include <drivers/common/virtio_blk.h>
+#include <drivers/common/virtio_net.h>
+#include <net/netdev.h>
 
 /* x86-specific drivers (not available on ARM64) */
 #if defined(ARCH_I686) || defined(ARCH_X86_64)
@@ -29,7 +32,6 @@
 #include <drivers/usb/uhci.h>
 #include <drivers/usb/usb_mass_storage.h>
 #include <kernel/multiboot.h>
-#include <net/netdev.h>
 #endif
 
 #include <kernel/version.h>
@@ -47,6 +49,7 @@
 
 #include <kernel/task.h>
 #include <kernel/syscall.h>
+#include <fs/bio.h>
 
 /* fs_bootstrap is x86-specific (has FAT32, partition, blockdev dependencies) */
 #if defined(ARCH_I686) || defined(ARCH_X86_64)
@@ -227,6 +230,20 @@ void kernel_main(void *dtb_addr) {
     extern void fb_terminal_init(void);
     fb_terminal_init();
     LOG_INFO_MSG("  [4.2] Framebuffer console initialized\n");
+
+    // 4.3 Initialize virtio-blk devices (virtio-mmio slots from the DTB)
+    int vblk_count = virtio_blk_init();
+    LOG_INFO_MSG("  [4.3] virtio-blk: %d device(s)\n", vblk_count);
+
+    // 4.4 Initialize networking (virtio-net is the only NIC on virt)
+    netdev_init();
+    int vnet_count = virtio_net_init();
+    LOG_INFO_MSG("  [4.4] virtio-net: %d device(s)\n", vnet_count);
+    netdev_t *eth0 = netdev_get_by_name("eth0");
+    if (eth0) {
+        netdev_up(eth0);
+        LOG_INFO_MSG("  Network: eth0 enabled\n");
+    }
     
     // Note: ARM64 doesn't have VGA, keyboard, ATA, PCI, ACPI, E1000, USB
     // These are x86-specific devices
@@ -241,6 +258,10 @@ void kernel_main(void *dtb_addr) {
     // 5.1 Initialize task management
     task_init();
     LOG_INFO_MSG("  [5.1] Task management initialized\n");
+    klog_start_thread();
+    LOG_INFO_MSG("  [5.1] klogd started, console logging deferred\n");
+    blk_start_thread();
+    LOG_INFO_MSG("  [5.1] kblockd started\n");
     
     // 5.2 Initialize file system (VFS + ramfs + devfs)
     vfs_init();
@@ -314,6 +335,8 @@ void kernel_main(void *dtb_addr) {
     // ========================================================================
     LOG_INFO_MSG("Enabling interrupts...\n");
     hal_interrupt_enable();
+    serial_enable_tx_irq();
+    LOG_INFO_MSG("Serial TX switched to interrupt-driven ring\n");
     kprintf("\n");
 
     // ========================================================================
@@ -506,18 +529,25 @@ void kernel_main(multiboot_info_t* mbi) {
     keyboard_init();
     LOG_INFO_MSG("  [4.2] Keyboard initialized\n");
 
-    // 4.3 初始化 ATA 驱动
-    ata_init();
-    LOG_INFO_MSG("  [4.3] ATA driver initialized\n");
+    serial_enable_tx_irq();
+    LOG_INFO_MSG("  [4.2] Serial TX switched to interrupt-driven ring\n");
 
-    // 4.4 初始化 RTC（实时时钟）
-    rtc_init();
-    LOG_INFO_MSG("  [4.4] RTC initialized\n");
-
-    // 4.5 初始化 PCI 总线
+    // 4.3 初始化 PCI 总线
     pci_init();
     pci_scan_devices();
-    LOG_INFO_MSG("  [4.5] PCI bus scanned\n");
+    LOG_INFO_MSG("  [4.3] PCI bus scanned\n");
+
+    // 4.4 初始化 ATA 驱动（需要 PCI 扫描结果来启用总线主控 DMA）
+    ata_init();
+    LOG_INFO_MSG("  [4.4] ATA driver initialized\n");
+    int vblk_count = virtio_blk_init();
+    if (vblk_count > 0) {
+        LOG_INFO_MSG("  [4.4] virtio-blk: %d device(s)\n", vblk_count);
+    }
+
+    // 4.5 初始化 RTC（实时时钟）
+    rtc_init();
+    LOG_INFO_MSG("  [4.5] RTC initialized\n");
 
     // 4.6 初始化 ACPI 子系统
     int acpi_result = acpi_init();
@@ -543,16 +573,22 @@ void kernel_main(multiboot_info_t* mbi) {
 #endif
     if (e1000_count > 0) {
         LOG_INFO_MSG("  [4.8] E1000 driver initialized (%d device(s))\n", e1000_count);
-        
-        // 如果有网卡，启用第一个网卡
-        netdev_t *eth0 = netdev_get_by_name("eth0");
-        if (eth0) {
-            netdev_up(eth0);
-            LOG_INFO_MSG("  Network: eth0 enabled\n");
-        }
     } else {
         LOG_DEBUG_MSG("  [4.8] No E1000 network card found\n");
     }
+    
+    // virtio-net 走 legacy I/O 端口，x86_64 上同样可用
+    int vnet_count = virtio_net_init();
+    if (vnet_count > 0) {
+        LOG_INFO_MSG("  [4.8] virtio-net: %d device(s)\n", vnet_count);
+    }
+    
+    // 如果有网卡，启用第一个网卡
+    netdev_t *eth0 = netdev_get_by_name("eth0");
+    if (eth0) {
+        netdev_up(eth0);
+        LOG_INFO_MSG("  Network: eth0 enabled\n");
+    }
 
     // 4.9 初始化帧缓冲（图形模式）
 #if defined(ARCH_ARM64)
@@ -637,6 +673,10 @@ void kernel_main(multiboot_info_t* mbi) {
     // 5.1 初始化进程管理
     task_init();
     LOG_INFO_MSG("  [5.1] Task management initialized\n");
+    klog_start_thread();
+    LOG_INFO_MSG("  [5.1] klogd started, console logging deferred\n");
+    blk_start_thread();
+    LOG_INFO_MSG("  [5.1] kblockd started\n");
 
     // 5.2 初始化文件系统
     fs_init();
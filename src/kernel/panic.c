@@ -5,6 +5,7 @@
 #include <kernel/panic.h>
 #include <lib/kprintf.h>
 #include <lib/klog.h>
+#include <drivers/serial.h>
 
 /* 架构特定的禁用中断和挂起指令 */
 #if defined(ARCH_I686) || defined(ARCH_X86_64)
@@ -30,6 +31,10 @@ void kernel_panic(const char* message, const char* file, int line) {
     /* 禁用中断，防止进一步的中断干扰 */
     DISABLE_INTERRUPTS();
     
+    /* 串口改为同步输出：积压的日志先写出，之后不再依赖发送中断和串口锁 */
+    serial_panic_mode();
+    klog_panic_mode();
+    
     /* 显示 Panic 信息 */
     kprintf("\n");
     kprintf("================================================================================\n");
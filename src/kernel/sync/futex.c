@@ -0,0 +1,139 @@
+/**
+ * futex 实现
+ *
+ * 每个等待者在自己的栈上放一个 futex_q（内嵌等待项），挂到按物理地址
+ * 散列的桶上。桶就是普通的 wait_queue_t：被杀死的任务由
+ * wait_queue_detach_task 统一摘除，唤醒和迁移按键值筛选桶内的项。
+ *
+ * fork 后尚未写时复制的私有页也共享物理页，散列到同一键值只会造成
+ * 多余唤醒；futex 的使用者醒来后总会重新检查用户态的字。
+ */
+
+#include <kernel/sync/futex.h>
+#include <kernel/sync/waitqueue.h>
+#include <kernel/task.h>
+#include <kernel/interrupt.h>
+#include <drivers/timer.h>
+#include <mm/vmm.h>
+
+typedef struct futex_q {
+    wait_queue_entry_t entry;           // 必须是第一个成员
+    uintptr_t key;                      // futex 字的物理地址
+    volatile bool woken;
+} futex_q_t;
+
+typedef struct futex_match {
+    uintptr_t key;
+    uintptr_t new_key;                  // 迁移后的键值（仅 requeue 使用）
+} futex_match_t;
+
+static wait_queue_t futex_buckets[FUTEX_HASH_SIZE];
+
+/* futex 字的键值：物理地址；未映射或未对齐返回 0 */
+static uintptr_t futex_key(volatile uint32_t *uaddr) {
+    uintptr_t addr = (uintptr_t)uaddr;
+    if (addr == 0 || (addr & 3) != 0) {
+        return 0;
+    }
+    return vmm_virt_to_phys(addr);
+}
+
+static wait_queue_t *futex_bucket(uintptr_t key) {
+    uint32_t h = (uint32_t)(key >> 2) * 2654435761U;
+    return &futex_buckets[h >> 26];     // 高 6 位，对应 FUTEX_HASH_SIZE
+}
+
+static bool futex_match_wake(wait_queue_entry_t *entry, void *arg) {
+    futex_q_t *q = (futex_q_t *)entry;
+    futex_match_t *m = (futex_match_t *)arg;
+    if (q->key != m->key) {
+        return false;
+    }
+    q->woken = true;
+    return true;
+}
+
+static bool futex_match_requeue(wait_queue_entry_t *entry, void *arg) {
+    futex_q_t *q = (futex_q_t *)entry;
+    futex_match_t *m = (futex_match_t *)arg;
+    if (q->key != m->key) {
+        return false;
+    }
+    q->key = m->new_key;
+    return true;
+}
+
+int futex_wait(volatile uint32_t *uaddr, uint32_t val, uint32_t timeout_ms) {
+    uintptr_t key = futex_key(uaddr);
+    if (key == 0) {
+        return -EFAULT;
+    }
+
+    task_t *current = task_get_current();
+    if (current == NULL) {
+        return -EINVAL;
+    }
+
+    uint64_t deadline = 0;
+    if (timeout_ms != WAIT_FOREVER) {
+        deadline = timer_get_uptime_ms() + timeout_ms;
+    }
+
+    futex_q_t q;
+    wait_queue_entry_init(&q.entry, current);
+    q.key = key;
+    q.woken = false;
+
+    int ret = 0;
+    bool irq_state = interrupts_disable();
+
+    // 先挂入桶再比较：唤醒者改值后调用 futex_wake 时一定能看到这个等待者
+    wait_queue_add(futex_bucket(key), &q.entry);
+    if (*uaddr != val) {
+        ret = -EAGAIN;
+    } else {
+        while (!q.woken) {
+            if (timeout_ms == 0 || (deadline && timer_get_uptime_ms() >= deadline)) {
+                ret = -ETIMEDOUT;
+                break;
+            }
+            // 可能被 requeue 迁移到别的桶：以等待项为等待对象，唤醒时按它匹配
+            task_block_until(&q.entry, deadline);
+        }
+    }
+    wait_queue_remove(&q.entry);
+
+    interrupts_restore(irq_state);
+    return ret;
+}
+
+int futex_wake(volatile uint32_t *uaddr, int nr) {
+    uintptr_t key = futex_key(uaddr);
+    if (key == 0) {
+        return -EFAULT;
+    }
+
+    futex_match_t m = { key, 0 };
+    return wait_queue_wake_match(futex_bucket(key), futex_match_wake, &m, nr);
+}
+
+int futex_requeue(volatile uint32_t *uaddr, int nr_wake,
+                  volatile uint32_t *uaddr2, int nr_requeue) {
+    uintptr_t key = futex_key(uaddr);
+    uintptr_t key2 = futex_key(uaddr2);
+    if (key == 0 || key2 == 0) {
+        return -EFAULT;
+    }
+
+    wait_queue_t *bucket = futex_bucket(key);
+    futex_match_t m = { key, key2 };
+
+    // 关中断使唤醒与迁移之间不会插入新的等待者
+    bool irq_state = interrupts_disable();
+    int woken = wait_queue_wake_match(bucket, futex_match_wake, &m, nr_wake);
+    int moved = wait_queue_move_match(bucket, futex_bucket(key2),
+                                      futex_match_requeue, &m, nr_requeue);
+    interrupts_restore(irq_state);
+
+    return woken + moved;
+}
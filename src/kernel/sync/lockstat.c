@@ -0,0 +1,122 @@
+/**
+ * 锁竞争统计实现
+ *
+ * 锁类来自静态池，只增不删；注册在初始化路径上进行，查找是线性扫描。
+ * 计数使用原子操作，热路径不再加锁。
+ */
+
+#include <kernel/sync/lockstat.h>
+#include <kernel/sync/spinlock.h>
+#include <drivers/timer.h>
+#include <lib/string.h>
+#include <lib/kprintf.h>
+#include <lib/klog.h>
+
+static lock_class_t lockstat_classes[LOCKSTAT_MAX_CLASSES];
+static atomic_t lockstat_class_count = ATOMIC_INIT(0);
+static spinlock_t lockstat_register_lock;
+
+static const char *const lockstat_type_names[] = {
+    [LOCK_CLASS_MUTEX]  = "mutex",
+    [LOCK_CLASS_RWLOCK] = "rwlock",
+    [LOCK_CLASS_RWSEM]  = "rwsem",
+};
+
+lock_class_t *lockstat_class(const char *name, lock_class_type_t type) {
+    if (name == NULL || name[0] == '\0') {
+        return NULL;
+    }
+
+    bool irq_state;
+    spinlock_lock_irqsave(&lockstat_register_lock, &irq_state);
+
+    uint32_t count = atomic_read(&lockstat_class_count);
+    lock_class_t *cls = NULL;
+    for (uint32_t i = 0; i < count; i++) {
+        if (lockstat_classes[i].type == type &&
+            strncmp(lockstat_classes[i].name, name, LOCKSTAT_NAME_MAX - 1) == 0) {
+            cls = &lockstat_classes[i];
+            break;
+        }
+    }
+
+    if (cls == NULL && count < LOCKSTAT_MAX_CLASSES) {
+        cls = &lockstat_classes[count];
+        memset(cls, 0, sizeof(*cls));
+        strncpy(cls->name, name, LOCKSTAT_NAME_MAX - 1);
+        cls->name[LOCKSTAT_NAME_MAX - 1] = '\0';
+        cls->type = type;
+        // 发布：dump 只读取 count 之前的条目
+        atomic_set(&lockstat_class_count, count + 1);
+    }
+
+    spinlock_unlock_irqrestore(&lockstat_register_lock, irq_state);
+
+    if (cls == NULL) {
+        LOG_WARN_MSG("lockstat: class pool full, '%s' not tracked\n", name);
+    }
+    return cls;
+}
+
+uint64_t lockstat_wait_begin(lock_class_t *cls) {
+    if (cls == NULL) {
+        return 0;
+    }
+    atomic_inc_return(&cls->contended);
+    return timer_get_uptime_ms();
+}
+
+void lockstat_wait_end(lock_class_t *cls, uint64_t start_ms, bool slept) {
+    if (cls == NULL) {
+        return;
+    }
+
+    uint64_t now = timer_get_uptime_ms();
+    uint32_t waited = now > start_ms ? (uint32_t)(now - start_ms) : 0;
+
+    if (!slept) {
+        atomic_inc_return(&cls->spin_acquired);
+    }
+    if (waited == 0) {
+        return;
+    }
+
+    atomic_add_return(&cls->wait_ms, waited);
+
+    uint32_t max = atomic_read(&cls->max_wait_ms);
+    while (waited > max && !atomic_cmpxchg(&cls->max_wait_ms, &max, waited)) {
+        // max 已被更新为当前值，重试
+    }
+}
+
+void lockstat_reset(void) {
+    uint32_t count = atomic_read(&lockstat_class_count);
+    for (uint32_t i = 0; i < count; i++) {
+        lock_class_t *cls = &lockstat_classes[i];
+        atomic_set(&cls->acquisitions, 0);
+        atomic_set(&cls->contended, 0);
+        atomic_set(&cls->spin_acquired, 0);
+        atomic_set(&cls->wait_ms, 0);
+        atomic_set(&cls->max_wait_ms, 0);
+    }
+}
+
+int lockstat_dump(char *buf, size_t size) {
+    int len = ksnprintf(buf, size, "%-24s %-6s %10s %10s %8s %10s %8s\n",
+                        "class", "type", "acquired", "contended", "spun",
+                        "wait_ms", "max_ms");
+
+    uint32_t count = atomic_read(&lockstat_class_count);
+    for (uint32_t i = 0; i < count && (size_t)len < size; i++) {
+        lock_class_t *cls = &lockstat_classes[i];
+        len += ksnprintf(buf + len, size - (size_t)len,
+                         "%-24s %-6s %10u %10u %8u %10u %8u\n",
+                         cls->name, lockstat_type_names[cls->type],
+                         atomic_read(&cls->acquisitions),
+                         atomic_read(&cls->contended),
+                         atomic_read(&cls->spin_acquired),
+                         atomic_read(&cls->wait_ms),
+                         atomic_read(&cls->max_wait_ms));
+    }
+    return len;
+}
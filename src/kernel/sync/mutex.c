@@ -3,6 +3,9 @@
 #include <kernel/interrupt.h>
 #include <lib/klog.h>
 
+/* 自适应自旋的最大轮数（每轮一次 cpu_relax） */
+#define MUTEX_SPIN_LIMIT    1000
+
 static inline task_t *mutex_current_task(void) {
     return task_get_current();
 }
@@ -16,6 +19,34 @@ void mutex_init(mutex_t *mutex) {
     mutex->locked = false;
     mutex->owner_pid = 0;
     mutex->recursion = 0;
+    mutex->owner = NULL;
+    mutex->cls = NULL;
+}
+
+void mutex_init_named(mutex_t *mutex, const char *name) {
+    mutex_init(mutex);
+    if (mutex != NULL) {
+        mutex->cls = lockstat_class(name, LOCK_CLASS_MUTEX);
+    }
+}
+
+/*
+ * 持有者正在运行时自旋等待，直到锁被释放、持有者停止运行或超过上限。
+ * 单处理器上持有者不可能与当前任务同时处于 RUNNING，循环立即退出。
+ * 任务结构来自静态池，读取已退出持有者的状态是安全的。
+ */
+static void mutex_spin_on_owner(mutex_t *mutex, task_t *current) {
+    for (uint32_t i = 0; i < MUTEX_SPIN_LIMIT; i++) {
+        if (!__atomic_load_n(&mutex->locked, __ATOMIC_ACQUIRE)) {
+            return;
+        }
+        task_t *owner = __atomic_load_n(&mutex->owner, __ATOMIC_ACQUIRE);
+        if (owner == NULL || owner == current ||
+            __atomic_load_n(&owner->state, __ATOMIC_RELAXED) != TASK_RUNNING) {
+            return;
+        }
+        cpu_relax();
+    }
 }
 
 bool mutex_try_lock(mutex_t *mutex) {
@@ -32,8 +63,10 @@ bool mutex_try_lock(mutex_t *mutex) {
     if (!mutex->locked) {
         mutex->locked = true;
         mutex->owner_pid = current ? current->pid : 0;
+        mutex->owner = current;
         mutex->recursion = 1;
         acquired = true;
+        lockstat_acquired(mutex->cls);
     } else if (current != NULL && mutex->owner_pid == current->pid) {
         mutex->recursion++;
         acquired = true;
@@ -55,6 +88,10 @@ void mutex_lock(mutex_t *mutex) {
         return;
     }
 
+    bool waited = false;
+    bool slept = false;
+    uint64_t wait_start = 0;
+
     while (1) {
         bool irq_state = interrupts_disable();
 
@@ -64,9 +101,14 @@ void mutex_lock(mutex_t *mutex) {
         if (!mutex->locked) {
             mutex->locked = true;
             mutex->owner_pid = current->pid;
+            mutex->owner = current;
             mutex->recursion = 1;
             spinlock_unlock(&mutex->lock);
             interrupts_restore(irq_state);
+            if (waited) {
+                lockstat_wait_end(mutex->cls, wait_start, slept);
+            }
+            lockstat_acquired(mutex->cls);
             return;
         }
 
@@ -78,9 +120,22 @@ void mutex_lock(mutex_t *mutex) {
             return;
         }
 
+        if (!waited) {
+            waited = true;
+            wait_start = lockstat_wait_begin(mutex->cls);
+
+            // 第一次失败：持有者在运行则先自旋，释放后重新竞争
+            spinlock_unlock(&mutex->lock);
+            interrupts_restore(irq_state);
+            mutex_spin_on_owner(mutex, current);
+            continue;
+        }
+
         // 无法获取，在持有锁的情况下设置任务状态为阻塞
         // 这样可以防止 Lost Wakeup
+        current->wait_channel = mutex;
         current->state = TASK_BLOCKED;
+        slept = true;
         
         spinlock_unlock(&mutex->lock);
         
@@ -118,6 +173,7 @@ void mutex_unlock(mutex_t *mutex) {
         if (--mutex->recursion == 0) {
             mutex->locked = false;
             mutex->owner_pid = 0;
+            mutex->owner = NULL;
             should_wakeup = true;
         }
     }
@@ -0,0 +1,109 @@
+#include <kernel/sync/qspinlock.h>
+#include <kernel/sync/spinlock.h>
+
+typedef struct qspin_node {
+    struct qspin_node *volatile next;   // 队列中的后继
+    volatile uint32_t head;             // 前驱离队时置 1：成为队首
+} qspin_node_t;
+
+void qspin_init(qspinlock_t *lock) {
+    if (lock == NULL) {
+        return;
+    }
+    lock->tail = NULL;
+    __atomic_store_n(&lock->locked, 0, __ATOMIC_RELEASE);
+}
+
+bool qspin_try_lock(qspinlock_t *lock) {
+    if (lock == NULL) {
+        return false;
+    }
+
+    // 有人排队时不插队
+    if (__atomic_load_n(&lock->tail, __ATOMIC_RELAXED) != NULL) {
+        return false;
+    }
+    uint32_t expected = 0;
+    return __atomic_compare_exchange_n(&lock->locked, &expected, 1, false,
+                                       __ATOMIC_ACQUIRE, __ATOMIC_RELAXED);
+}
+
+void qspin_lock(qspinlock_t *lock) {
+    if (lock == NULL) {
+        return;
+    }
+
+    if (qspin_try_lock(lock)) {
+        return;
+    }
+
+    qspin_node_t node = { NULL, 0 };
+    qspin_node_t *self = &node;
+
+    // 换入队尾；有前驱则链接到它之后，在自己的节点上自旋
+    qspin_node_t *prev = __atomic_exchange_n(&lock->tail, self, __ATOMIC_ACQ_REL);
+    if (prev != NULL) {
+        __atomic_store_n(&prev->next, self, __ATOMIC_RELEASE);
+        while (!__atomic_load_n(&node.head, __ATOMIC_ACQUIRE)) {
+            cpu_relax();
+        }
+    }
+
+    // 队首：只有这一个等待者在锁字上自旋
+    while (1) {
+        while (__atomic_load_n(&lock->locked, __ATOMIC_RELAXED)) {
+            cpu_relax();
+        }
+        uint32_t expected = 0;
+        if (__atomic_compare_exchange_n(&lock->locked, &expected, 1, false,
+                                        __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+            break;
+        }
+    }
+
+    // 离队：自己仍是队尾则清空队列，否则把队首身份交给后继
+    qspin_node_t *expected_tail = self;
+    if (!__atomic_compare_exchange_n(&lock->tail, &expected_tail, NULL, false,
+                                     __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) {
+        qspin_node_t *next;
+        while ((next = __atomic_load_n(&node.next, __ATOMIC_ACQUIRE)) == NULL) {
+            cpu_relax();    // 后继已换入队尾，正在链接
+        }
+        __atomic_store_n(&next->head, 1, __ATOMIC_RELEASE);
+    }
+}
+
+void qspin_unlock(qspinlock_t *lock) {
+    if (lock == NULL) {
+        return;
+    }
+    __atomic_store_n(&lock->locked, 0, __ATOMIC_RELEASE);
+}
+
+bool qspin_is_locked(const qspinlock_t *lock) {
+    if (lock == NULL) {
+        return false;
+    }
+    return __atomic_load_n(&lock->locked, __ATOMIC_RELAXED) != 0;
+}
+
+void qspin_lock_irqsave(qspinlock_t *lock, bool *irq_state) {
+    if (lock == NULL) {
+        if (irq_state != NULL) {
+            *irq_state = false;
+        }
+        return;
+    }
+    bool prev = interrupts_disable();
+    if (irq_state != NULL) {
+        *irq_state = prev;
+    }
+    qspin_lock(lock);
+}
+
+void qspin_unlock_irqrestore(qspinlock_t *lock, bool irq_state) {
+    if (lock != NULL) {
+        qspin_unlock(lock);
+    }
+    interrupts_restore(irq_state);
+}
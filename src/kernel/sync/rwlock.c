@@ -0,0 +1,149 @@
+#include <kernel/sync/rwlock.h>
+#include <kernel/sync/spinlock.h>
+#include <kernel/interrupt.h>
+#include <lib/klog.h>
+
+void rwlock_init(rwlock_t *lock) {
+    if (lock == NULL) {
+        return;
+    }
+
+    atomic_set(&lock->state, 0);
+    atomic_set(&lock->writers_waiting, 0);
+    lock->cls = NULL;
+}
+
+void rwlock_init_named(rwlock_t *lock, const char *name) {
+    rwlock_init(lock);
+    if (lock != NULL) {
+        lock->cls = lockstat_class(name, LOCK_CLASS_RWLOCK);
+    }
+}
+
+/* 有写者持有或等待时不放行新读者 */
+static inline bool rwlock_read_trylock_once(rwlock_t *lock) {
+    if (atomic_read(&lock->writers_waiting) != 0) {
+        return false;
+    }
+
+    uint32_t state = atomic_read(&lock->state);
+    while (state != RWLOCK_WRITER) {
+        if (atomic_cmpxchg(&lock->state, &state, state + 1)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static inline bool rwlock_write_trylock_once(rwlock_t *lock) {
+    uint32_t expected = 0;
+    return atomic_cmpxchg(&lock->state, &expected, RWLOCK_WRITER);
+}
+
+bool rwlock_try_read_lock(rwlock_t *lock) {
+    if (lock == NULL) {
+        return false;
+    }
+
+    bool acquired = rwlock_read_trylock_once(lock);
+    if (acquired) {
+        lockstat_acquired(lock->cls);
+    }
+    return acquired;
+}
+
+void rwlock_read_lock(rwlock_t *lock) {
+    if (lock == NULL) {
+        return;
+    }
+
+    if (!rwlock_read_trylock_once(lock)) {
+        uint64_t start = lockstat_wait_begin(lock->cls);
+        do {
+            cpu_relax();
+        } while (!rwlock_read_trylock_once(lock));
+        lockstat_wait_end(lock->cls, start, false);
+    }
+    lockstat_acquired(lock->cls);
+}
+
+void rwlock_read_unlock(rwlock_t *lock) {
+    if (lock == NULL) {
+        return;
+    }
+
+    uint32_t state = atomic_read(&lock->state);
+    if (state == 0 || state == RWLOCK_WRITER) {
+        LOG_WARN_MSG("rwlock_read_unlock: not read-locked\n");
+        return;
+    }
+    atomic_dec_return(&lock->state);
+}
+
+bool rwlock_try_write_lock(rwlock_t *lock) {
+    if (lock == NULL) {
+        return false;
+    }
+
+    bool acquired = rwlock_write_trylock_once(lock);
+    if (acquired) {
+        lockstat_acquired(lock->cls);
+    }
+    return acquired;
+}
+
+void rwlock_write_lock(rwlock_t *lock) {
+    if (lock == NULL) {
+        return;
+    }
+
+    if (!rwlock_write_trylock_once(lock)) {
+        uint64_t start = lockstat_wait_begin(lock->cls);
+        // 登记为等待者后，新的读者不再进入，现有读者退出后即可获得
+        atomic_inc_return(&lock->writers_waiting);
+        do {
+            cpu_relax();
+        } while (!rwlock_write_trylock_once(lock));
+        atomic_dec_return(&lock->writers_waiting);
+        lockstat_wait_end(lock->cls, start, false);
+    }
+    lockstat_acquired(lock->cls);
+}
+
+void rwlock_write_unlock(rwlock_t *lock) {
+    if (lock == NULL) {
+        return;
+    }
+
+    if (atomic_read(&lock->state) != RWLOCK_WRITER) {
+        LOG_WARN_MSG("rwlock_write_unlock: not write-locked\n");
+        return;
+    }
+    atomic_set(&lock->state, 0);
+}
+
+void rwlock_read_lock_irqsave(rwlock_t *lock, bool *irq_state) {
+    bool prev = interrupts_disable();
+    if (irq_state != NULL) {
+        *irq_state = prev;
+    }
+    rwlock_read_lock(lock);
+}
+
+void rwlock_read_unlock_irqrestore(rwlock_t *lock, bool irq_state) {
+    rwlock_read_unlock(lock);
+    interrupts_restore(irq_state);
+}
+
+void rwlock_write_lock_irqsave(rwlock_t *lock, bool *irq_state) {
+    bool prev = interrupts_disable();
+    if (irq_state != NULL) {
+        *irq_state = prev;
+    }
+    rwlock_write_lock(lock);
+}
+
+void rwlock_write_unlock_irqrestore(rwlock_t *lock, bool irq_state) {
+    rwlock_write_unlock(lock);
+    interrupts_restore(irq_state);
+}
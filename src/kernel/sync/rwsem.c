@@ -0,0 +1,213 @@
+#include <kernel/sync/rwsem.h>
+#include <kernel/interrupt.h>
+#include <kernel/task.h>
+#include <lib/klog.h>
+
+void rwsem_init(rw_semaphore_t *sem) {
+    if (sem == NULL) {
+        return;
+    }
+
+    spinlock_init(&sem->lock);
+    sem->readers = 0;
+    sem->writers_waiting = 0;
+    sem->writer = false;
+    sem->owner_pid = 0;
+    sem->cls = NULL;
+}
+
+void rwsem_init_named(rw_semaphore_t *sem, const char *name) {
+    rwsem_init(sem);
+    if (sem != NULL) {
+        sem->cls = lockstat_class(name, LOCK_CLASS_RWSEM);
+    }
+}
+
+static inline bool rwsem_can_read(rw_semaphore_t *sem) {
+    return !sem->writer && sem->writers_waiting == 0;
+}
+
+static inline bool rwsem_can_write(rw_semaphore_t *sem) {
+    return !sem->writer && sem->readers == 0;
+}
+
+/*
+ * 与 mutex_lock 相同：在持有内部自旋锁时设置阻塞状态，防止 Lost Wakeup
+ */
+void rwsem_read_lock(rw_semaphore_t *sem) {
+    if (sem == NULL) {
+        return;
+    }
+
+    task_t *current = task_get_current();
+    if (current == NULL) {
+        // 任务系统尚未启动，不会有竞争者
+        rwsem_try_read_lock(sem);
+        return;
+    }
+
+    bool waited = false;
+    uint64_t wait_start = 0;
+
+    while (1) {
+        bool irq_state = interrupts_disable();
+        spinlock_lock(&sem->lock);
+
+        if (rwsem_can_read(sem)) {
+            sem->readers++;
+            spinlock_unlock(&sem->lock);
+            interrupts_restore(irq_state);
+            if (waited) {
+                lockstat_wait_end(sem->cls, wait_start, true);
+            }
+            lockstat_acquired(sem->cls);
+            return;
+        }
+
+        if (!waited) {
+            waited = true;
+            wait_start = lockstat_wait_begin(sem->cls);
+        }
+
+        current->wait_channel = sem;
+        current->state = TASK_BLOCKED;
+
+        spinlock_unlock(&sem->lock);
+        task_schedule();
+        interrupts_restore(irq_state);
+    }
+}
+
+bool rwsem_try_read_lock(rw_semaphore_t *sem) {
+    if (sem == NULL) {
+        return false;
+    }
+
+    bool irq_state = interrupts_disable();
+    spinlock_lock(&sem->lock);
+
+    bool acquired = rwsem_can_read(sem);
+    if (acquired) {
+        sem->readers++;
+        lockstat_acquired(sem->cls);
+    }
+
+    spinlock_unlock(&sem->lock);
+    interrupts_restore(irq_state);
+    return acquired;
+}
+
+void rwsem_read_unlock(rw_semaphore_t *sem) {
+    if (sem == NULL) {
+        return;
+    }
+
+    bool irq_state = interrupts_disable();
+    bool should_wakeup = false;
+
+    spinlock_lock(&sem->lock);
+    if (sem->readers == 0) {
+        LOG_WARN_MSG("rwsem_read_unlock: no readers\n");
+    } else if (--sem->readers == 0 && sem->writers_waiting > 0) {
+        should_wakeup = true;
+    }
+    spinlock_unlock(&sem->lock);
+
+    if (should_wakeup) {
+        task_wakeup(sem);
+    }
+    interrupts_restore(irq_state);
+}
+
+void rwsem_write_lock(rw_semaphore_t *sem) {
+    if (sem == NULL) {
+        return;
+    }
+
+    task_t *current = task_get_current();
+    if (current == NULL) {
+        rwsem_try_write_lock(sem);
+        return;
+    }
+
+    bool irq_state = interrupts_disable();
+    spinlock_lock(&sem->lock);
+    // 登记为等待者后，新的读者不再进入
+    sem->writers_waiting++;
+
+    bool waited = !rwsem_can_write(sem);
+    uint64_t wait_start = waited ? lockstat_wait_begin(sem->cls) : 0;
+
+    while (!rwsem_can_write(sem)) {
+        current->wait_channel = sem;
+        current->state = TASK_BLOCKED;
+
+        spinlock_unlock(&sem->lock);
+        task_schedule();
+        spinlock_lock(&sem->lock);
+    }
+
+    sem->writers_waiting--;
+    sem->writer = true;
+    sem->owner_pid = current->pid;
+
+    spinlock_unlock(&sem->lock);
+    interrupts_restore(irq_state);
+
+    if (waited) {
+        lockstat_wait_end(sem->cls, wait_start, true);
+    }
+    lockstat_acquired(sem->cls);
+}
+
+bool rwsem_try_write_lock(rw_semaphore_t *sem) {
+    if (sem == NULL) {
+        return false;
+    }
+
+    task_t *current = task_get_current();
+    bool irq_state = interrupts_disable();
+    spinlock_lock(&sem->lock);
+
+    bool acquired = rwsem_can_write(sem);
+    if (acquired) {
+        sem->writer = true;
+        sem->owner_pid = current ? current->pid : 0;
+        lockstat_acquired(sem->cls);
+    }
+
+    spinlock_unlock(&sem->lock);
+    interrupts_restore(irq_state);
+    return acquired;
+}
+
+void rwsem_write_unlock(rw_semaphore_t *sem) {
+    if (sem == NULL) {
+        return;
+    }
+
+    task_t *current = task_get_current();
+    uint32_t pid = current ? current->pid : 0;
+
+    bool irq_state = interrupts_disable();
+    bool should_wakeup = false;
+
+    spinlock_lock(&sem->lock);
+    if (!sem->writer) {
+        LOG_WARN_MSG("rwsem_write_unlock: not write-locked\n");
+    } else if (sem->owner_pid != pid) {
+        LOG_WARN_MSG("rwsem_write_unlock: current task is not the owner (owner=%u)\n",
+                     sem->owner_pid);
+    } else {
+        sem->writer = false;
+        sem->owner_pid = 0;
+        should_wakeup = true;
+    }
+    spinlock_unlock(&sem->lock);
+
+    // 读者和写者都在同一等待通道上，全部唤醒后各自重新检查
+    if (should_wakeup) {
+        task_wakeup(sem);
+    }
+    interrupts_restore(irq_state);
+}
@@ -44,6 +44,7 @@ void semaphore_wait(semaphore_t *sem) {
 
         // 无法获取，在持有锁的情况下设置任务状态为阻塞
         // 这样可以防止 Lost Wakeup
+        current->wait_channel = sem;
         current->state = TASK_BLOCKED;
         
         spinlock_unlock(&sem->lock);
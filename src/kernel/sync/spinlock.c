@@ -1,56 +1,25 @@
 #include <kernel/sync/spinlock.h>
 
-#define SPINLOCK_UNLOCKED 0
-#define SPINLOCK_LOCKED   1
-
-#if defined(ARCH_ARM64)
-/* ARM64 原子交换操作 */
-static inline uint32_t atomic_xchg(volatile uint32_t *addr, uint32_t new_value) {
-    uint32_t old_value, tmp;
-    __asm__ volatile(
-        "1: ldaxr %w0, [%2]\n"      /* Load-Acquire Exclusive */
-        "   stlxr %w1, %w3, [%2]\n" /* Store-Release Exclusive */
-        "   cbnz  %w1, 1b\n"        /* Retry if store failed */
-        : "=&r"(old_value), "=&r"(tmp)
-        : "r"(addr), "r"(new_value)
-        : "memory"
-    );
-    return old_value;
-}
-
-/* ARM64 CPU 暂停提示 */
-static inline void cpu_relax(void) {
-    __asm__ volatile("yield" ::: "memory");
-}
-#else
-/* x86 原子交换操作 */
-static inline uint32_t atomic_xchg(volatile uint32_t *addr, uint32_t new_value) {
-    uint32_t old_value;
-    __asm__ volatile("xchg %0, %1"
-                     : "=r"(old_value), "+m"(*addr)
-                     : "0"(new_value)
-                     : "memory");
-    return old_value;
-}
-
-/* x86 CPU 暂停提示 */
-static inline void cpu_relax(void) {
-    __asm__ volatile("pause" ::: "memory");
-}
-#endif
-
 void spinlock_init(spinlock_t *lock) {
     if (lock == NULL) {
         return;
     }
-    lock->value = SPINLOCK_UNLOCKED;
+    __atomic_store_n(&lock->value, 0, __ATOMIC_RELEASE);
 }
 
 bool spinlock_try_lock(spinlock_t *lock) {
     if (lock == NULL) {
         return false;
     }
-    return atomic_xchg(&lock->value, SPINLOCK_LOCKED) == SPINLOCK_UNLOCKED;
+
+    // 只有无人持有也无人排队（owner == next）时才取号
+    uint32_t old = __atomic_load_n(&lock->value, __ATOMIC_RELAXED);
+    if ((old & 0xFFFF) != (old >> SPINLOCK_TICKET_SHIFT)) {
+        return false;
+    }
+    return __atomic_compare_exchange_n(&lock->value, &old,
+                                       old + (1U << SPINLOCK_TICKET_SHIFT), false,
+                                       __ATOMIC_ACQUIRE, __ATOMIC_RELAXED);
 }
 
 void spinlock_lock(spinlock_t *lock) {
@@ -58,7 +27,12 @@ void spinlock_lock(spinlock_t *lock) {
         return;
     }
 
-    while (!spinlock_try_lock(lock)) {
+    uint32_t old = __atomic_fetch_add(&lock->value, 1U << SPINLOCK_TICKET_SHIFT,
+                                      __ATOMIC_ACQUIRE);
+    uint16_t ticket = (uint16_t)(old >> SPINLOCK_TICKET_SHIFT);
+
+    // 等待期间只读 owner，不写共享缓存行
+    while (__atomic_load_n(&lock->tickets.owner, __ATOMIC_ACQUIRE) != ticket) {
         cpu_relax();
     }
 }
@@ -67,15 +41,21 @@ void spinlock_unlock(spinlock_t *lock) {
     if (lock == NULL) {
         return;
     }
-    // 使用原子交换操作确保多核可见性
-    atomic_xchg(&lock->value, SPINLOCK_UNLOCKED);
+    // 只有持有者写 owner，release 存储即可让下一个号码获得锁
+    uint16_t owner = __atomic_load_n(&lock->tickets.owner, __ATOMIC_RELAXED);
+    if (owner == __atomic_load_n(&lock->tickets.next, __ATOMIC_RELAXED)) {
+        // 未加锁时释放：忽略，否则叫号会越过取号，锁永远无法再获得
+        return;
+    }
+    __atomic_store_n(&lock->tickets.owner, (uint16_t)(owner + 1), __ATOMIC_RELEASE);
 }
 
 bool spinlock_is_locked(const spinlock_t *lock) {
     if (lock == NULL) {
         return false;
     }
-    return lock->value == SPINLOCK_LOCKED;
+    uint32_t v = __atomic_load_n(&lock->value, __ATOMIC_RELAXED);
+    return (v & 0xFFFF) != (v >> SPINLOCK_TICKET_SHIFT);
 }
 
 void spinlock_lock_irqsave(spinlock_t *lock, bool *irq_state) {
@@ -0,0 +1,325 @@
+#include <kernel/sync/waitqueue.h>
+#include <kernel/task.h>
+#include <kernel/interrupt.h>
+#include <drivers/timer.h>
+
+void wait_queue_init(wait_queue_t *wq) {
+    if (wq == NULL) {
+        return;
+    }
+
+    spinlock_init(&wq->lock);
+    wq->head = NULL;
+    wq->tail = NULL;
+}
+
+void wait_queue_entry_init(wait_queue_entry_t *entry, struct task *task) {
+    if (entry == NULL) {
+        return;
+    }
+
+    entry->task = task;
+    entry->func = NULL;
+    entry->data = NULL;
+    entry->queue = NULL;
+    entry->next = NULL;
+    entry->prev = NULL;
+    entry->task_next = NULL;
+}
+
+void wait_queue_entry_init_func(wait_queue_entry_t *entry, wait_queue_func_t func, void *data) {
+    wait_queue_entry_init(entry, NULL);
+    if (entry != NULL) {
+        entry->func = func;
+        entry->data = data;
+    }
+}
+
+/* 从队列链表中摘除（调用者持有 wq->lock） */
+static void wait_queue_unlink(wait_queue_t *wq, wait_queue_entry_t *entry) {
+    if (entry->prev) {
+        entry->prev->next = entry->next;
+    } else {
+        wq->head = entry->next;
+    }
+
+    if (entry->next) {
+        entry->next->prev = entry->prev;
+    } else {
+        wq->tail = entry->prev;
+    }
+
+    entry->next = NULL;
+    entry->prev = NULL;
+    entry->queue = NULL;
+}
+
+/* 从任务的等待项链表中摘除（调用者已关中断） */
+static void wait_queue_task_unlink(wait_queue_entry_t *entry) {
+    task_t *task = entry->task;
+    if (task == NULL) {
+        return;
+    }
+
+    wait_queue_entry_t **pp = &task->wait_entries;
+    while (*pp && *pp != entry) {
+        pp = &(*pp)->task_next;
+    }
+    if (*pp == entry) {
+        *pp = entry->task_next;
+    }
+    entry->task_next = NULL;
+}
+
+void wait_queue_add(wait_queue_t *wq, wait_queue_entry_t *entry) {
+    if (wq == NULL || entry == NULL || entry->queue != NULL) {
+        return;
+    }
+
+    bool irq_state;
+    spinlock_lock_irqsave(&wq->lock, &irq_state);
+
+    entry->queue = wq;
+    entry->next = NULL;
+    entry->prev = wq->tail;
+    if (wq->tail) {
+        wq->tail->next = entry;
+    } else {
+        wq->head = entry;
+    }
+    wq->tail = entry;
+
+    // 任务等待项同时记在任务上，任务被杀死时可以统一摘除
+    if (entry->task != NULL) {
+        entry->task_next = entry->task->wait_entries;
+        entry->task->wait_entries = entry;
+    }
+
+    spinlock_unlock_irqrestore(&wq->lock, irq_state);
+}
+
+void wait_queue_remove(wait_queue_entry_t *entry) {
+    if (entry == NULL) {
+        return;
+    }
+
+    bool irq_state = interrupts_disable();
+
+    // queue 只会在关中断时被清除，读取后再加锁确认
+    wait_queue_t *wq = entry->queue;
+    if (wq != NULL) {
+        spinlock_lock(&wq->lock);
+        if (entry->queue == wq) {
+            wait_queue_unlink(wq, entry);
+        }
+        spinlock_unlock(&wq->lock);
+    }
+    wait_queue_task_unlink(entry);
+
+    interrupts_restore(irq_state);
+}
+
+static void wait_queue_notify(wait_queue_entry_t *entry, uint32_t key) {
+    if (entry->func) {
+        entry->func(entry, key);
+    } else if (entry->task) {
+        // 等待者以自己的等待项为等待对象阻塞，见 wait_queue_wait
+        task_wake(entry->task, entry);
+    }
+}
+
+void wait_queue_wake(wait_queue_t *wq, uint32_t key) {
+    if (wq == NULL || !wait_queue_active(wq)) {
+        return;
+    }
+
+    bool irq_state;
+    spinlock_lock_irqsave(&wq->lock, &irq_state);
+
+    wait_queue_entry_t *entry = wq->head;
+    while (entry) {
+        wait_queue_entry_t *next = entry->next;
+        wait_queue_notify(entry, key);
+        entry = next;
+    }
+
+    spinlock_unlock_irqrestore(&wq->lock, irq_state);
+}
+
+void wait_queue_wake_one(wait_queue_t *wq, uint32_t key) {
+    if (wq == NULL || !wait_queue_active(wq)) {
+        return;
+    }
+
+    bool irq_state;
+    spinlock_lock_irqsave(&wq->lock, &irq_state);
+
+    if (wq->head) {
+        wait_queue_notify(wq->head, key);
+    }
+
+    spinlock_unlock_irqrestore(&wq->lock, irq_state);
+}
+
+int wait_queue_wake_match(wait_queue_t *wq, wait_queue_match_t match, void *arg, int nr) {
+    if (wq == NULL || match == NULL || nr <= 0 || !wait_queue_active(wq)) {
+        return 0;
+    }
+
+    int woken = 0;
+    bool irq_state;
+    spinlock_lock_irqsave(&wq->lock, &irq_state);
+
+    wait_queue_entry_t *entry = wq->head;
+    while (entry && woken < nr) {
+        wait_queue_entry_t *next = entry->next;
+        if (match(entry, arg)) {
+            // 摘除后再唤醒：等待者醒来时看到的是已出队的项
+            wait_queue_unlink(wq, entry);
+            wait_queue_task_unlink(entry);
+            wait_queue_notify(entry, 0);
+            woken++;
+        }
+        entry = next;
+    }
+
+    spinlock_unlock_irqrestore(&wq->lock, irq_state);
+    return woken;
+}
+
+int wait_queue_move_match(wait_queue_t *from, wait_queue_t *to,
+                          wait_queue_match_t match, void *arg, int nr) {
+    if (from == NULL || to == NULL || match == NULL || nr <= 0) {
+        return 0;
+    }
+
+    bool irq_state = interrupts_disable();
+
+    // 两把锁按地址顺序获取，避免反向迁移时死锁
+    wait_queue_t *first = from < to ? from : to;
+    wait_queue_t *second = from < to ? to : from;
+    spinlock_lock(&first->lock);
+    if (second != first) {
+        spinlock_lock(&second->lock);
+    }
+
+    int moved = 0;
+    wait_queue_entry_t *entry = from->head;
+    while (entry && moved < nr) {
+        wait_queue_entry_t *next = entry->next;
+        if (match(entry, arg)) {
+            if (from != to) {
+                // 任务上的等待项链表不变，只换所在队列
+                wait_queue_unlink(from, entry);
+                entry->queue = to;
+                entry->prev = to->tail;
+                if (to->tail) {
+                    to->tail->next = entry;
+                } else {
+                    to->head = entry;
+                }
+                to->tail = entry;
+            }
+            moved++;
+        }
+        entry = next;
+    }
+
+    if (second != first) {
+        spinlock_unlock(&second->lock);
+    }
+    spinlock_unlock(&first->lock);
+    interrupts_restore(irq_state);
+    return moved;
+}
+
+void wait_queue_detach_all(wait_queue_t *wq, uint32_t key) {
+    if (wq == NULL) {
+        return;
+    }
+
+    bool irq_state;
+    spinlock_lock_irqsave(&wq->lock, &irq_state);
+
+    while (wq->head) {
+        wait_queue_entry_t *entry = wq->head;
+        wait_queue_unlink(wq, entry);
+        wait_queue_task_unlink(entry);
+        wait_queue_notify(entry, key);
+    }
+
+    spinlock_unlock_irqrestore(&wq->lock, irq_state);
+}
+
+void wait_queue_detach_task(struct task *task) {
+    if (task == NULL) {
+        return;
+    }
+
+    bool irq_state = interrupts_disable();
+
+    while (task->wait_entries) {
+        wait_queue_entry_t *entry = task->wait_entries;
+        task->wait_entries = entry->task_next;
+        entry->task_next = NULL;
+
+        wait_queue_t *wq = entry->queue;
+        if (wq != NULL) {
+            spinlock_lock(&wq->lock);
+            wait_queue_unlink(wq, entry);
+            spinlock_unlock(&wq->lock);
+        }
+    }
+
+    interrupts_restore(irq_state);
+}
+
+int wait_queue_wait(wait_queue_t *wq, bool (*cond)(void *arg), void *arg, uint32_t timeout_ms) {
+    if (wq == NULL || cond == NULL) {
+        return -1;
+    }
+
+    if (cond(arg)) {
+        return 0;
+    }
+    if (timeout_ms == 0) {
+        return -1;
+    }
+
+    uint64_t deadline = 0;
+    if (timeout_ms != WAIT_FOREVER) {
+        deadline = timer_get_uptime_ms() + timeout_ms;
+    }
+
+    task_t *current = task_get_current();
+    if (current == NULL) {
+        // 调度器尚未运行，只能轮询
+        while (!cond(arg)) {
+            if (deadline && timer_get_uptime_ms() >= deadline) {
+                return -1;
+            }
+            task_yield();
+        }
+        return 0;
+    }
+
+    wait_queue_entry_t entry;
+    wait_queue_entry_init(&entry, current);
+
+    int ret = 0;
+    bool irq_state = interrupts_disable();
+
+    // 先挂入队列再检查条件：关中断期间不会丢失唤醒
+    wait_queue_add(wq, &entry);
+    while (!cond(arg)) {
+        if (deadline && timer_get_uptime_ms() >= deadline) {
+            ret = -1;
+            break;
+        }
+        task_block_until(&entry, deadline);
+    }
+    wait_queue_remove(&entry);
+
+    interrupts_restore(irq_state);
+    return ret;
+}
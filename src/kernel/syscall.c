@@ -20,6 +20,9 @@
 #include <kernel/syscalls/net.h>
 #include <net/socket.h>
 #endif
+#include <fs/eventpoll.h>
+#include <fs/splice.h>
+#include <fs/pipe.h>
 #include <kernel/utsname.h>
 #include <kernel/task.h>
 #include <hal/hal.h>
@@ -171,6 +174,12 @@ static syscall_arg_t sys_getdents_wrapper(syscall_arg_t *frame, syscall_arg_t fd
     return sys_getdents((int32_t)fd, (uint32_t)index, (void *)(uintptr_t)dirent);
 }
 
+static syscall_arg_t sys_getdents64_wrapper(syscall_arg_t *frame, syscall_arg_t fd, syscall_arg_t buf, 
+                                            syscall_arg_t count, syscall_arg_t p4, syscall_arg_t p5) {
+    (void)frame; (void)p4; (void)p5;
+    return sys_getdents64((int32_t)fd, (void *)(uintptr_t)buf, (uint32_t)count);
+}
+
 static syscall_arg_t sys_stat_wrapper(syscall_arg_t *frame, syscall_arg_t path, syscall_arg_t buf, 
                                       syscall_arg_t p3, syscall_arg_t p4, syscall_arg_t p5) {
     (void)frame; (void)p3; (void)p4; (void)p5;
@@ -222,6 +231,46 @@ static syscall_arg_t sys_ioctl_wrapper(syscall_arg_t *frame, syscall_arg_t fd, s
     return sys_ioctl((int32_t)fd, (uint32_t)request, (void *)(uintptr_t)argp);
 }
 
+static syscall_arg_t sys_epoll_create_wrapper(syscall_arg_t *frame, syscall_arg_t size, syscall_arg_t p2, 
+                                              syscall_arg_t p3, syscall_arg_t p4, syscall_arg_t p5) {
+    (void)frame; (void)p2; (void)p3; (void)p4; (void)p5;
+    return (syscall_arg_t)sys_epoll_create((int)size);
+}
+
+static syscall_arg_t sys_epoll_ctl_wrapper(syscall_arg_t *frame, syscall_arg_t epfd, syscall_arg_t op, 
+                                           syscall_arg_t fd, syscall_arg_t event, syscall_arg_t p5) {
+    (void)frame; (void)p5;
+    return (syscall_arg_t)sys_epoll_ctl((int)epfd, (int)op, (int)fd,
+                                        (struct epoll_event *)(uintptr_t)event);
+}
+
+static syscall_arg_t sys_epoll_wait_wrapper(syscall_arg_t *frame, syscall_arg_t epfd, syscall_arg_t events, 
+                                            syscall_arg_t maxevents, syscall_arg_t timeout, syscall_arg_t p5) {
+    (void)frame; (void)p5;
+    return (syscall_arg_t)sys_epoll_wait((int)epfd, (struct epoll_event *)(uintptr_t)events,
+                                         (int)maxevents, (int)timeout);
+}
+
+static syscall_arg_t sys_splice_wrapper(syscall_arg_t *frame, syscall_arg_t fd_in, syscall_arg_t off_in, 
+                                        syscall_arg_t fd_out, syscall_arg_t off_out, syscall_arg_t len) {
+    (void)frame;
+    return (syscall_arg_t)sys_splice((int)fd_in, (off_t *)(uintptr_t)off_in,
+                                     (int)fd_out, (off_t *)(uintptr_t)off_out, (uint32_t)len);
+}
+
+static syscall_arg_t sys_sendfile_wrapper(syscall_arg_t *frame, syscall_arg_t out_fd, syscall_arg_t in_fd, 
+                                          syscall_arg_t offset, syscall_arg_t count, syscall_arg_t flags) {
+    (void)frame;
+    return (syscall_arg_t)sys_sendfile((int)out_fd, (int)in_fd, (off_t *)(uintptr_t)offset,
+                                       (uint32_t)count, (uint32_t)flags);
+}
+
+static syscall_arg_t sys_vmsplice_wrapper(syscall_arg_t *frame, syscall_arg_t fd, syscall_arg_t iov, 
+                                          syscall_arg_t nr_segs, syscall_arg_t p4, syscall_arg_t p5) {
+    (void)frame; (void)p4; (void)p5;
+    return (syscall_arg_t)sys_vmsplice((int)fd, (const struct iovec *)(uintptr_t)iov, (uint32_t)nr_segs);
+}
+
 static syscall_arg_t sys_getpid_wrapper(syscall_arg_t *frame, syscall_arg_t p1, syscall_arg_t p2, 
                                         syscall_arg_t p3, syscall_arg_t p4, syscall_arg_t p5) {
     (void)frame; (void)p1; (void)p2; (void)p3; (void)p4; (void)p5;
@@ -249,6 +298,13 @@ static syscall_arg_t sys_nanosleep_wrapper(syscall_arg_t *frame, syscall_arg_t r
     return sys_nanosleep(req, rem);
 }
 
+static syscall_arg_t sys_futex_wrapper(syscall_arg_t *frame, syscall_arg_t uaddr, syscall_arg_t op,
+                                       syscall_arg_t val, syscall_arg_t arg4, syscall_arg_t uaddr2) {
+    (void)frame;
+    return sys_futex((uint32_t *)(uintptr_t)uaddr, (uint32_t)op, (uint32_t)val,
+                     (uintptr_t)arg4, (uint32_t *)(uintptr_t)uaddr2);
+}
+
 static syscall_arg_t sys_time_wrapper(syscall_arg_t *frame, syscall_arg_t p1, syscall_arg_t p2, 
                                       syscall_arg_t p3, syscall_arg_t p4, syscall_arg_t p5) {
     (void)frame; (void)p1; (void)p2; (void)p3; (void)p4; (void)p5;
@@ -449,8 +505,20 @@ static syscall_arg_t sys_fcntl_wrapper(syscall_arg_t *frame, syscall_arg_t sockf
                                        syscall_arg_t cmd, syscall_arg_t arg, 
                                        syscall_arg_t p4, syscall_arg_t p5) {
     (void)frame; (void)p4; (void)p5;
+    // 管道命令作用于文件描述符，其余命令作用于 socket 描述符
+    if ((int)cmd == F_SETPIPE_SZ || (int)cmd == F_GETPIPE_SZ) {
+        return sys_pipe_fcntl((int32_t)sockfd, (int32_t)cmd, (int32_t)arg);
+    }
     return (syscall_arg_t)sys_fcntl((int)sockfd, (int)cmd, (int)arg);
 }
+#else
+/* ARM64: 只支持管道命令 */
+static syscall_arg_t sys_fcntl_wrapper(syscall_arg_t *frame, syscall_arg_t fd, 
+                                       syscall_arg_t cmd, syscall_arg_t arg, 
+                                       syscall_arg_t p4, syscall_arg_t p5) {
+    (void)frame; (void)p4; (void)p5;
+    return sys_pipe_fcntl((int32_t)fd, (int32_t)cmd, (int32_t)arg);
+}
 #endif /* !ARCH_ARM64 */
 
 /* Debug counter for syscalls */
@@ -514,6 +582,7 @@ void syscall_init(void) {
     syscall_table[SYS_GETPID]      = sys_getpid_wrapper;
     syscall_table[SYS_GETPPID]     = sys_getppid_wrapper;
     syscall_table[SYS_SCHED_YIELD] = sys_yield_wrapper;
+    syscall_table[SYS_FUTEX]       = sys_futex_wrapper;
     
     /* Signal and process control */
     syscall_table[SYS_KILL]        = sys_kill_wrapper;
@@ -537,6 +606,13 @@ void syscall_init(void) {
     syscall_table[SYS_DUP]         = sys_dup_wrapper;
     syscall_table[SYS_DUP2]        = sys_dup2_wrapper;
     syscall_table[SYS_IOCTL]       = sys_ioctl_wrapper;
+    syscall_table[SYS_EPOLL_CREATE] = sys_epoll_create_wrapper;
+    syscall_table[SYS_EPOLL_CTL]   = sys_epoll_ctl_wrapper;
+    syscall_table[SYS_EPOLL_WAIT]  = sys_epoll_wait_wrapper;
+    syscall_table[SYS_SPLICE]      = sys_splice_wrapper;
+    syscall_table[SYS_SENDFILE]    = sys_sendfile_wrapper;
+    syscall_table[SYS_VMSPLICE]    = sys_vmsplice_wrapper;
+    syscall_table[SYS_GETDENTS64]  = sys_getdents64_wrapper;
     
     /* Time related */
     syscall_table[SYS_TIME]        = sys_time_wrapper;
@@ -569,8 +645,8 @@ void syscall_init(void) {
     syscall_table[SYS_GETSOCKNAME] = sys_getsockname_wrapper;
     syscall_table[SYS_GETPEERNAME] = sys_getpeername_wrapper;
     syscall_table[SYS_SELECT]      = sys_select_wrapper;
-    syscall_table[SYS_FCNTL]       = sys_fcntl_wrapper;
 #endif
+    syscall_table[SYS_FCNTL]       = sys_fcntl_wrapper;
     
     /* Initialize architecture-specific system call entry mechanism via HAL */
     hal_syscall_init(NULL);
@@ -380,6 +380,11 @@ uint32_t sys_lseek(int32_t fd, int32_t offset, int32_t whence) {
     
     entry->offset = new_offset;
     
+    // 目录回到开头时重新读取（rewinddir）
+    if (entry->node->type == FS_DIRECTORY && new_offset == 0) {
+        memset(&entry->dir_pos, 0, sizeof(dir_cursor_t));
+    }
+    
     return new_offset;
 }
 
@@ -723,6 +728,81 @@ uint32_t sys_getdents(int32_t fd, uint32_t index, void *dirent) {
     return 0;
 }
 
+typedef struct getdents64_ctx {
+    uint8_t *buf;
+    uint32_t size;
+    uint32_t used;
+    uint32_t next_off;      // 下一项的目录流位置
+    bool full;              // 有目录项因缓冲区不足未写入
+} getdents64_ctx_t;
+
+static int getdents64_fill(void *ctx, const char *name, uint32_t ino, uint8_t type) {
+    getdents64_ctx_t *gc = (getdents64_ctx_t *)ctx;
+    uint32_t namelen = strlen(name);
+    uint32_t reclen = (offsetof(struct dirent64, d_name) + namelen + 1 + 7) & ~7U;
+    
+    if (gc->used + reclen > gc->size) {
+        gc->full = true;
+        return 1;
+    }
+    
+    struct dirent64 *d = (struct dirent64 *)(gc->buf + gc->used);
+    d->d_ino = ino;
+    d->d_off = ++gc->next_off;
+    d->d_reclen = (uint16_t)reclen;
+    d->d_type = type;
+    memcpy(d->d_name, name, namelen + 1);
+    
+    gc->used += reclen;
+    return 0;
+}
+
+/**
+ * sys_getdents64 - 批量读取目录项
+ * 
+ * 目录流位置保存在描述符表项中，文件系统从上次停下的位置继续，
+ * 列出 N 项的目录只需 O(N) 次目录项访问和 O(N / 缓冲区容量) 次系统调用。
+ */
+uint32_t sys_getdents64(int32_t fd, void *buf, uint32_t count) {
+    if (!buf || count == 0) {
+        return (uint32_t)-1;
+    }
+    
+    task_t *current = task_get_current();
+    if (!current || !current->fd_table) {
+        return (uint32_t)-1;
+    }
+    
+    fd_entry_t *entry = fd_table_get(current->fd_table, fd);
+    if (!entry || !entry->node) {
+        LOG_ERROR_MSG("sys_getdents64: invalid fd %d\n", fd);
+        return (uint32_t)-1;
+    }
+    if (entry->node->type != FS_DIRECTORY) {
+        LOG_ERROR_MSG("sys_getdents64: fd %d is not a directory\n", fd);
+        return (uint32_t)-1;
+    }
+    
+    getdents64_ctx_t gc = {
+        .buf = (uint8_t *)buf,
+        .size = count,
+        .used = 0,
+        .next_off = entry->dir_pos.index,
+        .full = false,
+    };
+    
+    if (vfs_iterate_dir(entry->node, &entry->dir_pos, getdents64_fill, &gc) != 0) {
+        return (uint32_t)-1;
+    }
+    
+    // 还有目录项但一项也放不下
+    if (gc.used == 0 && gc.full) {
+        return (uint32_t)-1;
+    }
+    
+    return gc.used;
+}
+
 /* ============================================================================
  * 管道系统调用
  * ============================================================================ */
@@ -823,6 +903,7 @@ uint32_t sys_dup(int32_t oldfd) {
     fd_entry_t *new_entry = fd_table_get(current->fd_table, newfd);
     if (new_entry) {
         new_entry->offset = old_entry->offset;
+        new_entry->dir_pos = old_entry->dir_pos;
     }
     
     LOG_DEBUG_MSG("sys_dup: duplicated fd %d -> %d\n", oldfd, newfd);
@@ -881,6 +962,7 @@ uint32_t sys_dup2(int32_t oldfd, int32_t newfd) {
     current->fd_table->entries[newfd].node = old_entry->node;
     current->fd_table->entries[newfd].offset = old_entry->offset;
     current->fd_table->entries[newfd].flags = old_entry->flags;
+    current->fd_table->entries[newfd].dir_pos = old_entry->dir_pos;
     current->fd_table->entries[newfd].in_use = true;
     
     // 增加引用计数
@@ -898,6 +980,34 @@ uint32_t sys_dup2(int32_t oldfd, int32_t newfd) {
     return (uint32_t)newfd;
 }
 
+/**
+ * sys_pipe_fcntl - 管道缓冲区控制
+ */
+uint32_t sys_pipe_fcntl(int32_t fd, int32_t cmd, int32_t arg) {
+    task_t *current = task_get_current();
+    if (!current || !current->fd_table) {
+        return (uint32_t)-1;
+    }
+    
+    fd_entry_t *entry = fd_table_get(current->fd_table, fd);
+    if (!entry || !entry->node || entry->node->type != FS_PIPE) {
+        LOG_ERROR_MSG("sys_pipe_fcntl: fd %d is not a pipe\n", fd);
+        return (uint32_t)-1;
+    }
+    
+    switch (cmd) {
+        case F_SETPIPE_SZ:
+            if (arg <= 0) {
+                return (uint32_t)-1;
+            }
+            return (uint32_t)pipe_set_size(entry->node, (uint32_t)arg);
+        case F_GETPIPE_SZ:
+            return (uint32_t)pipe_get_size(entry->node);
+        default:
+            return (uint32_t)-1;
+    }
+}
+
 /* ============================================================================
  * 文件重命名系统调用
  * ============================================================================ */
@@ -4,6 +4,7 @@
  * 实现 POSIX 标准的进程管理系统调用：
  * - exit(2), fork(2), execve(2)
  * - getpid(2), yield(2), nanosleep(2)
+ * - futex(2)
  */
 
 #include <kernel/syscalls/process.h>
@@ -15,6 +16,8 @@
 #include <kernel/gdt.h>
 #endif
 #include <kernel/interrupt.h>
+#include <kernel/sync/waitqueue.h>
+#include <kernel/sync/futex.h>
 #include <kernel/user.h>
 #include <fs/vfs.h>
 #include <mm/vmm.h>
@@ -760,6 +763,54 @@ uint32_t sys_nanosleep(const struct timespec *req, struct timespec *rem) {
     return 0;
 }
 
+/* futex 字必须完整落在用户空间内 */
+static bool futex_user_addr_ok(const void *addr, uint32_t size) {
+    uintptr_t a = (uintptr_t)addr;
+    return a != 0 && a < USER_SPACE_END && size <= USER_SPACE_END - a;
+}
+
+/**
+ * sys_futex - 快速用户态互斥
+ *
+ * 用户态只在需要睡眠或唤醒时进入内核；超时按毫秒向上取整。
+ */
+uint32_t sys_futex(uint32_t *uaddr, uint32_t op, uint32_t val, uintptr_t arg4, uint32_t *uaddr2) {
+    if (!futex_user_addr_ok(uaddr, sizeof(uint32_t))) {
+        return (uint32_t)-EFAULT;
+    }
+
+    switch (op & FUTEX_CMD_MASK) {
+    case FUTEX_WAIT: {
+        uint32_t timeout_ms = WAIT_FOREVER;
+        const struct timespec *ts = (const struct timespec *)arg4;
+        if (ts) {
+            if (!futex_user_addr_ok(ts, sizeof(*ts))) {
+                return (uint32_t)-EFAULT;
+            }
+            if (ts->tv_nsec >= 1000000000u) {
+                return (uint32_t)-EINVAL;
+            }
+            uint64_t ms = (uint64_t)ts->tv_sec * 1000ull + (ts->tv_nsec + 999999u) / 1000000u;
+            timeout_ms = ms >= WAIT_FOREVER ? WAIT_FOREVER - 1 : (uint32_t)ms;
+        }
+        return (uint32_t)futex_wait(uaddr, val, timeout_ms);
+    }
+
+    case FUTEX_WAKE:
+        return (uint32_t)futex_wake(uaddr, (int)val);
+
+    case FUTEX_REQUEUE:
+        if (!futex_user_addr_ok(uaddr2, sizeof(uint32_t))) {
+            return (uint32_t)-EFAULT;
+        }
+        return (uint32_t)futex_requeue(uaddr, (int)val, uaddr2, (int)arg4);
+
+    default:
+        LOG_DEBUG_MSG("sys_futex: unsupported op %u\n", op);
+        return (uint32_t)-EINVAL;
+    }
+}
+
 /**
  * sys_kill - 向进程发送信号
  * 
@@ -857,6 +908,9 @@ uint32_t sys_kill(uint32_t pid, uint32_t signal) {
         }
     }
     
+    // 阻塞中的进程可能挂在等待队列上（等待项在其内核栈中），先摘除
+    wait_queue_detach_task(target);
+    
     // 如果目标进程在就绪队列中，需要移除它
     if (target->state == TASK_READY) {
         ready_queue_remove(target);
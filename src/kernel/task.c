@@ -5,7 +5,7 @@
 #include <kernel/task.h>
 #include <kernel/interrupt.h>
 #include <kernel/fd_table.h>
-#include <kernel/sync/spinlock.h>
+#include <kernel/sync/qspinlock.h>
 #include <hal/hal.h>
 #include <mm/heap.h>
 #include <mm/vmm.h>
@@ -55,7 +55,7 @@ static task_t *idle_task = NULL;
 static bool scheduler_initialized = false;
 
 /** @brief 任务管理全局锁 - 保护任务池、就绪队列和 PID 分配 */
-static spinlock_t task_lock;
+static qspinlock_t task_lock;
 
 /** @brief 待清理的 terminated 任务（用于延迟清理） */
 static task_t *pending_cleanup_task = NULL;
@@ -83,7 +83,7 @@ void ready_queue_add(task_t *task) {
     }
     
     bool irq_state;
-    spinlock_lock_irqsave(&task_lock, &irq_state);
+    qspin_lock_irqsave(&task_lock, &irq_state);
     
     task->next = NULL;
     task->prev = ready_queue_tail;
@@ -96,7 +96,7 @@ void ready_queue_add(task_t *task) {
     
     ready_queue_tail = task;
     
-    spinlock_unlock_irqrestore(&task_lock, irq_state);
+    qspin_unlock_irqrestore(&task_lock, irq_state);
 }
 
 /**
@@ -108,7 +108,7 @@ void ready_queue_remove(task_t *task) {
     }
     
     bool irq_state;
-    spinlock_lock_irqsave(&task_lock, &irq_state);
+    qspin_lock_irqsave(&task_lock, &irq_state);
     
     if (task->prev) {
         task->prev->next = task->next;
@@ -125,7 +125,7 @@ void ready_queue_remove(task_t *task) {
     task->next = NULL;
     task->prev = NULL;
     
-    spinlock_unlock_irqrestore(&task_lock, irq_state);
+    qspin_unlock_irqrestore(&task_lock, irq_state);
 }
 
 /**
@@ -135,7 +135,7 @@ void ready_queue_remove(task_t *task) {
  */
 static task_t* ready_queue_pop(void) {
     bool irq_state;
-    spinlock_lock_irqsave(&task_lock, &irq_state);
+    qspin_lock_irqsave(&task_lock, &irq_state);
     
     task_t *task = ready_queue_head;
     if (task) {
@@ -150,7 +150,7 @@ static task_t* ready_queue_pop(void) {
         task->prev = NULL;
     }
     
-    spinlock_unlock_irqrestore(&task_lock, irq_state);
+    qspin_unlock_irqrestore(&task_lock, irq_state);
     return task;
 }
 
@@ -163,7 +163,7 @@ static task_t* ready_queue_pop(void) {
  */
 task_t* task_alloc(void) {
     bool irq_state;
-    spinlock_lock_irqsave(&task_lock, &irq_state);
+    qspin_lock_irqsave(&task_lock, &irq_state);
     
     for (uint32_t i = 0; i < MAX_TASKS; i++) {
         if (task_pool[i].state == TASK_UNUSED) {
@@ -174,12 +174,12 @@ task_t* task_alloc(void) {
             task_pool[i].time_slice = DEFAULT_TIME_SLICE;
             active_task_count++;
             
-            spinlock_unlock_irqrestore(&task_lock, irq_state);
+            qspin_unlock_irqrestore(&task_lock, irq_state);
             return &task_pool[i];
         }
     }
     
-    spinlock_unlock_irqrestore(&task_lock, irq_state);
+    qspin_unlock_irqrestore(&task_lock, irq_state);
     LOG_ERROR_MSG("task_alloc: No free PCB available (max: %d)\n", MAX_TASKS);
     return NULL;
 }
@@ -223,13 +223,13 @@ void task_free(task_t *task) {
     
     // 在锁内清空 PCB
     bool irq_state;
-    spinlock_lock_irqsave(&task_lock, &irq_state);
+    qspin_lock_irqsave(&task_lock, &irq_state);
     
     memset(task, 0, sizeof(task_t));
     task->state = TASK_UNUSED;
     active_task_count--;
     
-    spinlock_unlock_irqrestore(&task_lock, irq_state);
+    qspin_unlock_irqrestore(&task_lock, irq_state);
 }
 
 /**
@@ -237,16 +237,16 @@ void task_free(task_t *task) {
  */
 task_t* task_get_by_pid(uint32_t pid) {
     bool irq_state;
-    spinlock_lock_irqsave(&task_lock, &irq_state);
+    qspin_lock_irqsave(&task_lock, &irq_state);
     
     for (uint32_t i = 0; i < MAX_TASKS; i++) {
         if (task_pool[i].state != TASK_UNUSED && task_pool[i].pid == pid) {
-            spinlock_unlock_irqrestore(&task_lock, irq_state);
+            qspin_unlock_irqrestore(&task_lock, irq_state);
             return &task_pool[i];
         }
     }
     
-    spinlock_unlock_irqrestore(&task_lock, irq_state);
+    qspin_unlock_irqrestore(&task_lock, irq_state);
     return NULL;
 }
 
@@ -262,9 +262,9 @@ task_t* task_get_current(void) {
  */
 uint32_t task_get_count(void) {
     bool irq_state;
-    spinlock_lock_irqsave(&task_lock, &irq_state);
+    qspin_lock_irqsave(&task_lock, &irq_state);
     uint32_t count = active_task_count;
-    spinlock_unlock_irqrestore(&task_lock, irq_state);
+    qspin_unlock_irqrestore(&task_lock, irq_state);
     return count;
 }
 
@@ -952,11 +952,11 @@ void task_schedule(void) {
         
         // 先在锁内清空 PCB
         bool irq_state_cleanup;
-        spinlock_lock_irqsave(&task_lock, &irq_state_cleanup);
+        qspin_lock_irqsave(&task_lock, &irq_state_cleanup);
         memset(task_to_cleanup, 0, sizeof(task_t));
         task_to_cleanup->state = TASK_UNUSED;
         active_task_count--;
-        spinlock_unlock_irqrestore(&task_lock, irq_state_cleanup);
+        qspin_unlock_irqrestore(&task_lock, irq_state_cleanup);
         
         // 然后在锁外释放资源（避免死锁）
         if (kernel_stack_base) {
@@ -1137,7 +1137,7 @@ void task_timer_tick(void) {
     uint32_t wake_count = 0;
     
     bool irq_state;
-    spinlock_lock_irqsave(&task_lock, &irq_state);
+    qspin_lock_irqsave(&task_lock, &irq_state);
     
     for (uint32_t i = 0; i < MAX_TASKS; i++) {
         task_t *task = &task_pool[i];
@@ -1145,13 +1145,14 @@ void task_timer_tick(void) {
         if (task->state == TASK_BLOCKED && task->sleep_until_ms > 0) {
             if (current_time_ms >= task->sleep_until_ms) {
                 task->sleep_until_ms = 0;
+                task->wait_channel = NULL;
                 task->state = TASK_READY;
                 tasks_to_wake[wake_count++] = task;
             }
         }
     }
     
-    spinlock_unlock_irqrestore(&task_lock, irq_state);
+    qspin_unlock_irqrestore(&task_lock, irq_state);
     
     // 在锁外将任务添加到就绪队列
     for (uint32_t i = 0; i < wake_count; i++) {
@@ -1202,7 +1203,7 @@ void task_exit(uint32_t exit_code) {
     uint32_t zombie_count = 0;
     
     bool irq_state_child;
-    spinlock_lock_irqsave(&task_lock, &irq_state_child);
+    qspin_lock_irqsave(&task_lock, &irq_state_child);
     
     for (uint32_t i = 0; i < MAX_TASKS; i++) {
         task_t *task = &task_pool[i];
@@ -1229,7 +1230,7 @@ void task_exit(uint32_t exit_code) {
         }
     }
     
-    spinlock_unlock_irqrestore(&task_lock, irq_state_child);
+    qspin_unlock_irqrestore(&task_lock, irq_state_child);
     
     // 在锁外清理僵尸子进程
     for (uint32_t i = 0; i < zombie_count; i++) {
@@ -1281,6 +1282,7 @@ void task_sleep(uint32_t ms) {
     // 计算唤醒时间
     uint64_t wake_time = timer_get_uptime_ms() + ms;
     current_task->sleep_until_ms = wake_time;
+    current_task->wait_channel = NULL;
     current_task->state = TASK_BLOCKED;
     
     // 切换到其他任务
@@ -1295,14 +1297,13 @@ void task_sleep(uint32_t ms) {
  * @param wait_object 等待对象指针（用于调试）
  */
 void task_block(void *wait_object) {
-    (void)wait_object;  // 暂不使用
-    
     if (!current_task) {
         return;
     }
     
     bool prev_state = interrupts_disable();
     
+    current_task->wait_channel = wait_object;
     current_task->state = TASK_BLOCKED;
     
     LOG_DEBUG_MSG("Task %u (%s) blocked on %p\n", 
@@ -1317,30 +1318,39 @@ void task_block(void *wait_object) {
 /**
  * @brief 唤醒等待在指定对象上的一个任务
  * 
- * @param wait_object 等待对象指针（用于调试）
+ * 只唤醒 wait_channel 与 wait_object 匹配的任务，睡眠中的任务不受影响。
+ * 
+ * @param wait_object 等待对象指针
  */
 void task_wakeup(void *wait_object) {
-    (void)wait_object;  // 暂不使用
-    
     task_t *task_to_wake = NULL;
     
+    if (!wait_object) {
+        return;
+    }
+    
     bool irq_state;
-    spinlock_lock_irqsave(&task_lock, &irq_state);
+    qspin_lock_irqsave(&task_lock, &irq_state);
     
-    // 简化实现：唤醒第一个阻塞的任务
-    // 完整实现应该维护每个等待对象的等待队列
     for (uint32_t i = 0; i < MAX_TASKS; i++) {
         task_t *task = &task_pool[i];
         
-        if (task->state == TASK_BLOCKED && task->sleep_until_ms == 0) {
-            task->state = TASK_READY;
+        if (task->state != TASK_BLOCKED || task->sleep_until_ms != 0) {
+            continue;
+        }
+        if (task->wait_channel == wait_object) {
             task_to_wake = task;
-            LOG_DEBUG_MSG("Task %u (%s) woken up\n", task->pid, task->name);
             break;  // 只唤醒一个任务
         }
     }
     
-    spinlock_unlock_irqrestore(&task_lock, irq_state);
+    if (task_to_wake) {
+        task_to_wake->state = TASK_READY;
+        task_to_wake->wait_channel = NULL;
+        LOG_DEBUG_MSG("Task %u (%s) woken up\n", task_to_wake->pid, task_to_wake->name);
+    }
+    
+    qspin_unlock_irqrestore(&task_lock, irq_state);
     
     // 在锁外添加到就绪队列
     if (task_to_wake) {
@@ -1348,6 +1358,57 @@ void task_wakeup(void *wait_object) {
     }
 }
 
+/**
+ * @brief 阻塞当前任务直到被唤醒或超时
+ */
+void task_block_until(void *wait_object, uint64_t deadline_ms) {
+    if (!current_task) {
+        return;
+    }
+    
+    bool prev_state = interrupts_disable();
+    
+    current_task->wait_channel = wait_object;
+    current_task->sleep_until_ms = deadline_ms;
+    current_task->state = TASK_BLOCKED;
+    
+    task_schedule();
+    
+    // 被等待队列提前唤醒时 sleep_until_ms 已清零；这里再清一次防止残留
+    current_task->sleep_until_ms = 0;
+    current_task->wait_channel = NULL;
+    
+    interrupts_restore(prev_state);
+}
+
+/**
+ * @brief 唤醒阻塞在指定对象上的任务
+ */
+bool task_wake(task_t *task, void *wait_object) {
+    if (!task || !wait_object) {
+        return false;
+    }
+    
+    bool woken = false;
+    
+    bool irq_state;
+    qspin_lock_irqsave(&task_lock, &irq_state);
+    
+    if (task->state == TASK_BLOCKED && task->wait_channel == wait_object) {
+        task->state = TASK_READY;
+        task->sleep_until_ms = 0;
+        task->wait_channel = NULL;
+        woken = true;
+    }
+    
+    qspin_unlock_irqrestore(&task_lock, irq_state);
+    
+    if (woken) {
+        ready_queue_add(task);
+    }
+    return woken;
+}
+
 /**
  * @brief 从中断上下文调度
  * 
@@ -1379,7 +1440,7 @@ void task_init(void) {
     LOG_INFO_MSG("Initializing task management...\n");
     
     // 初始化任务管理锁
-    spinlock_init(&task_lock);
+    qspin_init(&task_lock);
     
     // 清空任务池
     memset(task_pool, 0, sizeof(task_pool));
@@ -1423,7 +1484,7 @@ void task_print_all(void) {
     kprintf("---  --------  --------  -----------  ----\n");
     
     bool irq_state;
-    spinlock_lock_irqsave(&task_lock, &irq_state);
+    qspin_lock_irqsave(&task_lock, &irq_state);
     
     for (uint32_t i = 0; i < MAX_TASKS; i++) {
         task_t *task = &task_pool[i];
@@ -1448,6 +1509,6 @@ void task_print_all(void) {
     
     kprintf("\nActive tasks: %u / %u\n", active_task_count, MAX_TASKS);
     
-    spinlock_unlock_irqrestore(&task_lock, irq_state);
+    qspin_unlock_irqrestore(&task_lock, irq_state);
 }
 
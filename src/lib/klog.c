@@ -1,9 +1,19 @@
 // ============================================================================
 // klog.c - 内核日志系统
 // ============================================================================
+//
+// 日志环：klog_head 为下一个要分配的序号，写者原子取号后独占槽位
+// seq % KLOG_RING_SIZE。槽的 tag 为 seq + 1 表示该记录已发布，写入期间为 0；
+// 读者读完记录后重新检查 tag，变化说明读的过程中槽被复用，这条记录作废。
+// 控制台输出位置 klog_console_seq 只由持有 klog_draining 的 drain 者修改。
+// ============================================================================
 
 #include <lib/klog.h>
 #include <lib/kprintf.h>
+#include <lib/string.h>
+#include <drivers/timer.h>
+#include <kernel/task.h>
+#include <hal/hal.h>
 #include <stdarg.h>
 
 /* 当前日志等级阈值（默认 INFO，过滤 DEBUG） */
@@ -20,6 +30,46 @@ static log_target_t current_log_target = LOG_TARGET_BOTH;
 #define ANSI_RED     "\033[31m"    // 红色 - ERROR
 #define ANSI_BOLD    "\033[1m"     // 粗体
 
+typedef struct klog_record {
+    volatile uint32_t tag;          // 序号 + 1；0 表示空槽或正在写入
+    uint32_t ts_ms;
+    uint8_t level;
+    uint8_t cpu;
+    uint16_t len;
+    char text[KLOG_MSG_MAX];
+} klog_record_t;
+
+typedef struct klog_ratelimit {
+    uint32_t burst;                 // 0 表示不限
+    uint32_t interval_ms;
+    uint32_t window_start;
+    uint32_t printed;               // 当前窗口已放行的条数
+    uint32_t missed;                // 当前窗口被抑制的条数
+} klog_ratelimit_t;
+
+#define KLOG_READ_OK        0
+#define KLOG_READ_PENDING   1       // 已取号但尚未发布
+#define KLOG_READ_LOST      2       // 槽已被更新的记录复用
+
+static klog_record_t klog_ring[KLOG_RING_SIZE];
+static uint32_t klog_head;
+static uint32_t klog_console_seq;
+static uint32_t klog_draining;
+static volatile bool klog_deferred;     // klogd 已启动
+static volatile bool klog_panicking;
+static klog_stats_t klog_stats;
+
+static klog_ratelimit_t klog_ratelimits[KLOG_LEVEL_COUNT] = {
+    [LOG_DEBUG] = { KLOG_RATELIMIT_DEBUG_BURST, KLOG_RATELIMIT_INTERVAL_MS, 0, 0, 0 },
+};
+
+static const char *const klog_level_names[KLOG_LEVEL_COUNT] = {
+    "debug", "info", "warn", "error",
+};
+
+/* syslog 等级编号，/proc/kmsg 的行首使用 */
+static const uint8_t klog_syslog_levels[KLOG_LEVEL_COUNT] = { 7, 6, 4, 3 };
+
 void klog_set_level(log_level_t level) {
     current_log_level = level;
 }
@@ -36,6 +86,25 @@ log_target_t klog_get_target(void) {
     return current_log_target;
 }
 
+void klog_set_ratelimit(log_level_t level, uint32_t burst, uint32_t interval_ms) {
+    if ((uint32_t)level >= KLOG_LEVEL_COUNT) {
+        return;
+    }
+    // 重新配置即开始新窗口，之前未报告的抑制条数只留在统计里
+    klog_ratelimit_t *rl = &klog_ratelimits[level];
+    rl->interval_ms = interval_ms ? interval_ms : KLOG_RATELIMIT_INTERVAL_MS;
+    __atomic_store_n(&rl->window_start, (uint32_t)timer_get_uptime_ms(), __ATOMIC_RELAXED);
+    __atomic_store_n(&rl->missed, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&rl->printed, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&rl->burst, burst, __ATOMIC_RELAXED);
+}
+
+void klog_get_stats(klog_stats_t *stats) {
+    if (stats) {
+        *stats = klog_stats;
+    }
+}
+
 /**
  * 根据当前目标设置输出字符串
  */
@@ -49,34 +118,13 @@ static void log_output(const char *str) {
 }
 
 /**
- * 根据当前目标进行格式化输出
+ * 输出一条记录：颜色码 + 前缀 + 消息 + 重置颜色
  */
-static void log_vprintf(const char *fmt, va_list args) {
-    if (current_log_target & LOG_TARGET_SERIAL) {
-        va_list args_copy;
-        va_copy(args_copy, args);
-        vkprintf_serial(fmt, args_copy);
-        va_end(args_copy);
-    }
-    if (current_log_target & LOG_TARGET_VGA) {
-        va_list args_copy;
-        va_copy(args_copy, args);
-        vkprintf_vga(fmt, args_copy);
-        va_end(args_copy);
-    }
-}
-
-void klog(log_level_t level, const char *fmt, ...) {
-    // 过滤低等级日志
-    if (level < current_log_level) {
-        return;
-    }
-    
-    // 根据等级选择颜色和前缀
+static void klog_console_write(const klog_record_t *rec) {
     const char *color_code;
     const char *prefix;
-    
-    switch (level) {
+
+    switch (rec->level) {
         case LOG_DEBUG:
             color_code = ANSI_GRAY;
             prefix = "[DEBUG] ";
@@ -98,17 +146,252 @@ void klog(log_level_t level, const char *fmt, ...) {
             prefix = "[????]  ";
             break;
     }
-    
-    // 输出：颜色码 + 前缀
+
     log_output(color_code);
     log_output(prefix);
-    
-    // 格式化输出消息内容
+    log_output(rec->text);
+    log_output(ANSI_RESET);
+}
+
+// ============================================================================
+// 日志环
+// ============================================================================
+
+static void klog_vstore(log_level_t level, uint32_t now, const char *fmt, va_list args) {
+    uint32_t seq = __atomic_fetch_add(&klog_head, 1, __ATOMIC_RELAXED);
+    klog_record_t *rec = &klog_ring[seq & (KLOG_RING_SIZE - 1)];
+
+    // 先撤销旧记录的发布，再写内容
+    __atomic_store_n(&rec->tag, 0, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    rec->ts_ms = now;
+    rec->level = (uint8_t)level;
+    rec->cpu = (uint8_t)hal_cpu_id();
+    // 多留一个字节：vksnprintf 只返回写入的长度，写满 KLOG_MSG_MAX 才说明有截断
+    char text[KLOG_MSG_MAX + 1];
+    int len = vksnprintf(text, sizeof(text), fmt, args);
+    if (len > KLOG_MSG_MAX - 1) {
+        len = KLOG_MSG_MAX - 1;
+        text[len - 1] = '\n';
+        __atomic_fetch_add(&klog_stats.truncated, 1, __ATOMIC_RELAXED);
+    }
+    memcpy(rec->text, text, (size_t)len);
+    rec->text[len] = '\0';
+    rec->len = (uint16_t)len;
+
+    __atomic_store_n(&rec->tag, seq + 1, __ATOMIC_RELEASE);
+    __atomic_fetch_add(&klog_stats.records, 1, __ATOMIC_RELAXED);
+}
+
+static void klog_store(log_level_t level, uint32_t now, const char *fmt, ...) {
     va_list args;
     va_start(args, fmt);
-    log_vprintf(fmt, args);
+    klog_vstore(level, now, fmt, args);
     va_end(args);
-    
-    // 重置颜色
-    log_output(ANSI_RESET);
+}
+
+/**
+ * 复制序号为 seq 的记录
+ */
+static int klog_read(uint32_t seq, klog_record_t *out) {
+    const klog_record_t *rec = &klog_ring[seq & (KLOG_RING_SIZE - 1)];
+    uint32_t tag = __atomic_load_n(&rec->tag, __ATOMIC_ACQUIRE);
+    if (tag != seq + 1) {
+        // 槽已分给 seq + KLOG_RING_SIZE 或更新的记录，否则是还没发布
+        uint32_t head = __atomic_load_n(&klog_head, __ATOMIC_RELAXED);
+        return (head - seq > KLOG_RING_SIZE) ? KLOG_READ_LOST : KLOG_READ_PENDING;
+    }
+
+    out->ts_ms = rec->ts_ms;
+    out->level = rec->level;
+    out->cpu = rec->cpu;
+    out->len = rec->len;
+    memcpy(out->text, rec->text, KLOG_MSG_MAX);
+    out->text[KLOG_MSG_MAX - 1] = '\0';
+
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    if (__atomic_load_n(&rec->tag, __ATOMIC_RELAXED) != tag) {
+        return KLOG_READ_LOST;
+    }
+    return KLOG_READ_OK;
+}
+
+static uint32_t klog_backlog(void) {
+    return __atomic_load_n(&klog_head, __ATOMIC_ACQUIRE) -
+           __atomic_load_n(&klog_console_seq, __ATOMIC_RELAXED);
+}
+
+/**
+ * 输出到遇到未发布的记录或追上写者为止（持有 klog_draining）
+ */
+static void klog_drain_locked(void) {
+    for (;;) {
+        uint32_t seq = klog_console_seq;
+        uint32_t head = __atomic_load_n(&klog_head, __ATOMIC_ACQUIRE);
+        if (seq == head) {
+            break;
+        }
+        if (head - seq > KLOG_RING_SIZE) {
+            // 落后超过一圈，最旧的记录已被覆盖
+            __atomic_fetch_add(&klog_stats.lost, head - seq - KLOG_RING_SIZE, __ATOMIC_RELAXED);
+            __atomic_store_n(&klog_console_seq, head - KLOG_RING_SIZE, __ATOMIC_RELAXED);
+            continue;
+        }
+
+        klog_record_t rec;
+        int r = klog_read(seq, &rec);
+        if (r == KLOG_READ_PENDING) {
+            break;
+        }
+        if (r == KLOG_READ_OK) {
+            klog_console_write(&rec);
+        } else {
+            __atomic_fetch_add(&klog_stats.lost, 1, __ATOMIC_RELAXED);
+        }
+        __atomic_store_n(&klog_console_seq, seq + 1, __ATOMIC_RELAXED);
+    }
+}
+
+void klog_flush(void) {
+    while (klog_backlog() != 0) {
+        if (__atomic_exchange_n(&klog_draining, 1, __ATOMIC_ACQUIRE) != 0) {
+            return;
+        }
+        uint32_t before = klog_console_seq;
+        klog_drain_locked();
+        bool progressed = (klog_console_seq != before);
+        __atomic_store_n(&klog_draining, 0, __ATOMIC_RELEASE);
+
+        // 卡在未发布的记录上：它的写者发布后会负责输出
+        if (!progressed) {
+            return;
+        }
+        // 释放后再检查一次，持有期间别人写入的记录不会被遗漏
+    }
+}
+
+static void klog_drain_thread(void) {
+    for (;;) {
+        klog_flush();
+        task_sleep(KLOG_DRAIN_INTERVAL_MS);
+    }
+}
+
+void klog_start_thread(void) {
+    if (klog_deferred) {
+        return;
+    }
+    if (task_create_kernel_thread(klog_drain_thread, "klogd") == 0) {
+        LOG_WARN_MSG("klog: failed to start klogd, console output stays synchronous\n");
+        return;
+    }
+    klog_deferred = true;
+}
+
+void klog_panic_mode(void) {
+    klog_panicking = true;
+    // 持有输出权的上下文已不会再运行
+    __atomic_store_n(&klog_draining, 0, __ATOMIC_RELEASE);
+    klog_flush();
+}
+
+// ============================================================================
+// 限速
+// ============================================================================
+
+/**
+ * @param missed 新窗口开始时返回上一窗口被抑制的条数
+ * @return 是否放行
+ */
+static bool klog_ratelimit_pass(log_level_t level, uint32_t now, uint32_t *missed) {
+    klog_ratelimit_t *rl = &klog_ratelimits[level];
+    *missed = 0;
+
+    uint32_t burst = __atomic_load_n(&rl->burst, __ATOMIC_RELAXED);
+    if (burst == 0) {
+        return true;
+    }
+
+    uint32_t start = __atomic_load_n(&rl->window_start, __ATOMIC_RELAXED);
+    if (now - start >= rl->interval_ms &&
+        __atomic_compare_exchange_n(&rl->window_start, &start, now, false,
+                                    __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+        *missed = __atomic_exchange_n(&rl->missed, 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&rl->printed, 0, __ATOMIC_RELAXED);
+    }
+
+    if (__atomic_fetch_add(&rl->printed, 1, __ATOMIC_RELAXED) < burst) {
+        return true;
+    }
+    __atomic_fetch_add(&rl->missed, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&klog_stats.suppressed[level], 1, __ATOMIC_RELAXED);
+    return false;
+}
+
+void klog(log_level_t level, const char *fmt, ...) {
+    // 过滤低等级日志
+    if (level < current_log_level) {
+        return;
+    }
+
+    uint32_t now = (uint32_t)timer_get_uptime_ms();
+    if ((uint32_t)level < KLOG_LEVEL_COUNT) {
+        uint32_t missed;
+        if (!klog_ratelimit_pass(level, now, &missed)) {
+            return;
+        }
+        if (missed != 0) {
+            klog_store(level, now, "klog: %u %s messages suppressed\n",
+                       missed, klog_level_names[level]);
+        }
+    }
+
+    va_list args;
+    va_start(args, fmt);
+    klog_vstore(level, now, fmt, args);
+    va_end(args);
+
+    // WARN 及以上当场输出：klogd 只在有人让出 CPU 时才运行，不能让告警等下去
+    if (!klog_deferred || klog_panicking || level >= LOG_WARN) {
+        klog_flush();
+    } else if (klog_backlog() >= KLOG_RING_SIZE * 3 / 4) {
+        // klogd 跟不上（或一直没被调度），调用者当场输出，避免覆盖未输出的记录
+        __atomic_fetch_add(&klog_stats.direct_drains, 1, __ATOMIC_RELAXED);
+        klog_flush();
+    }
+}
+
+// ============================================================================
+// /proc/kmsg
+// ============================================================================
+
+int klog_dump(char *buf, size_t size) {
+    if (!buf || size == 0) {
+        return 0;
+    }
+
+    uint32_t head = __atomic_load_n(&klog_head, __ATOMIC_ACQUIRE);
+    uint32_t seq = (head > KLOG_RING_SIZE) ? head - KLOG_RING_SIZE : 0;
+    size_t pos = 0;
+    buf[0] = '\0';
+
+    for (; seq != head && pos + 1 < size; seq++) {
+        klog_record_t rec;
+        if (klog_read(seq, &rec) != KLOG_READ_OK) {
+            continue;
+        }
+        uint32_t lvl = (rec.level < KLOG_LEVEL_COUNT) ? klog_syslog_levels[rec.level] : 6;
+        int n = ksnprintf(buf + pos, size - pos, "<%u>[%5u.%03u] %s", lvl,
+                          rec.ts_ms / 1000, rec.ts_ms % 1000, rec.text);
+        if (n <= 0) {
+            break;
+        }
+        pos += (size_t)n;
+        if (pos > 0 && buf[pos - 1] != '\n' && pos + 1 < size) {
+            buf[pos++] = '\n';
+            buf[pos] = '\0';
+        }
+    }
+    return (int)pos;
 }
@@ -4,6 +4,7 @@
 
 #include <lib/kprintf.h>
 #include <lib/string.h>
+#include <lib/klog.h>
 #include <drivers/vga.h>
 #include <drivers/serial.h>
 #include <drivers/framebuffer.h>
@@ -57,11 +58,15 @@ static void output_string(const char *msg, output_target_t target) {
  * 公共 API - 同时输出到 serial 和 VGA（向后兼容）
  * ============================================================================ */
 
+/* 先输出日志环中积压的记录，保持与日志的先后顺序 */
+
 void kputchar(char c) {
+    klog_flush();
     output_char(c, OUTPUT_BOTH);
 }
 
 void kprint(const char *msg) {
+    klog_flush();
     output_string(msg, OUTPUT_BOTH);
 }
 
@@ -392,6 +397,7 @@ static void vkprintf_internal(const char *fmt, va_list args, output_target_t tar
  * ============================================================================ */
 
 void vkprintf(const char *fmt, va_list args) {
+    klog_flush();
     vkprintf_internal(fmt, args, OUTPUT_BOTH);
 }
 
@@ -696,6 +702,10 @@ int ksnprintf(char *str, size_t size, const char *fmt, ...) {
     return result;
 }
 
+int vksnprintf(char *str, size_t size, const char *fmt, va_list args) {
+    return vsnprintf_internal(str, size, fmt, args);
+}
+
 /* ============================================================================
  * 控制台颜色和清屏（自动适配 VGA 文本模式和帧缓冲图形模式）
  * ============================================================================ */
@@ -13,7 +13,7 @@
 #include <lib/kprintf.h>
 #include <lib/string.h>
 #include <kernel/panic.h>
-#include <kernel/sync/spinlock.h>
+#include <kernel/sync/qspinlock.h>
 #include <hal/hal.h>
 
 static uintptr_t heap_start;        ///< 堆起始地址
@@ -21,7 +21,7 @@ static uintptr_t heap_end;          ///< 堆当前结束地址
 static uintptr_t heap_max;          ///< 堆最大地址
 static heap_block_t *first_block = NULL;  ///< 第一个内存块指针
 static heap_block_t *last_block = NULL;   ///< 最后一个内存块指针
-static spinlock_t heap_lock;       ///< 堆自旋锁，保护堆的内部状态
+static qspinlock_t heap_lock;       ///< 堆自旋锁，保护堆的内部状态
 
 /**
  * @brief 扩展堆空间
@@ -216,7 +216,7 @@ void heap_init(uintptr_t start, uint32_t size) {
     LOG_INFO_MSG("heap_init: start=0x%llx, max=0x%llx, size=%u\n", (unsigned long long)heap_start, (unsigned long long)heap_max, size);
     
     // 初始化堆自旋锁
-    spinlock_init(&heap_lock);
+    qspin_init(&heap_lock);
     
     // 分配第一页作为初始堆空间
     if (!expand(PAGE_SIZE)) PANIC("Heap init failed");
@@ -246,12 +246,12 @@ void* kmalloc(size_t size) {
     if (!size) return NULL;
     
     bool irq_state;
-    spinlock_lock_irqsave(&heap_lock, &irq_state);
+    qspin_lock_irqsave(&heap_lock, &irq_state);
     
     // 【安全检查】验证 first_block 的有效性
     if (first_block == NULL) {
         LOG_ERROR_MSG("kmalloc: first_block is NULL!\n");
-        spinlock_unlock_irqrestore(&heap_lock, irq_state);
+        qspin_unlock_irqrestore(&heap_lock, irq_state);
         return NULL;
     }
     if ((uintptr_t)first_block < KERNEL_VIRTUAL_BASE || first_block->magic != HEAP_MAGIC) {
@@ -260,7 +260,7 @@ void* kmalloc(size_t size) {
                      (uintptr_t)first_block < KERNEL_VIRTUAL_BASE ? 0 : first_block->magic, HEAP_MAGIC);
         LOG_ERROR_MSG("kmalloc: heap_start=0x%llx, heap_end=0x%llx\n",
                      (unsigned long long)heap_start, (unsigned long long)heap_end);
-        spinlock_unlock_irqrestore(&heap_lock, irq_state);
+        qspin_unlock_irqrestore(&heap_lock, irq_state);
         return NULL;
     }
     
@@ -272,12 +272,12 @@ void* kmalloc(size_t size) {
         // 【安全检查】验证当前块的有效性
         if ((uintptr_t)b < KERNEL_VIRTUAL_BASE) {
             LOG_ERROR_MSG("kmalloc: invalid block pointer 0x%lx in heap chain!\n", (unsigned long)b);
-            spinlock_unlock_irqrestore(&heap_lock, irq_state);
+            qspin_unlock_irqrestore(&heap_lock, irq_state);
             return NULL;
         }
         if (b->magic != HEAP_MAGIC) {
             LOG_ERROR_MSG("kmalloc: block 0x%lx has invalid magic 0x%x (expected 0x%x)!\n", (unsigned long)b, b->magic, HEAP_MAGIC);
-            spinlock_unlock_irqrestore(&heap_lock, irq_state);
+            qspin_unlock_irqrestore(&heap_lock, irq_state);
             return NULL;
         }
         
@@ -285,7 +285,7 @@ void* kmalloc(size_t size) {
             b->is_free = false;
             split(b, size);
             void *ptr = (void*)((uintptr_t)b + sizeof(heap_block_t));
-            spinlock_unlock_irqrestore(&heap_lock, irq_state);
+            qspin_unlock_irqrestore(&heap_lock, irq_state);
             return ptr;
         }
     }
@@ -293,7 +293,7 @@ void* kmalloc(size_t size) {
     // 没有找到空闲块，扩展堆空间
     uintptr_t old = heap_end;
     if (!expand(size + sizeof(heap_block_t))) {
-        spinlock_unlock_irqrestore(&heap_lock, irq_state);
+        qspin_unlock_irqrestore(&heap_lock, irq_state);
         return NULL;
     }
     
@@ -312,7 +312,7 @@ void* kmalloc(size_t size) {
     last_block = new;
     
     void *ptr = (void*)((uintptr_t)new + sizeof(heap_block_t));
-    spinlock_unlock_irqrestore(&heap_lock, irq_state);
+    qspin_unlock_irqrestore(&heap_lock, irq_state);
     return ptr;
 }
 
@@ -326,20 +326,20 @@ void kfree(void* ptr) {
     if (!ptr) return;
     
     bool irq_state;
-    spinlock_lock_irqsave(&heap_lock, &irq_state);
+    qspin_lock_irqsave(&heap_lock, &irq_state);
     
     // 获取块头指针
     heap_block_t *b = (heap_block_t*)((uintptr_t)ptr - sizeof(heap_block_t));
     // 验证魔数
     if (b->magic != HEAP_MAGIC) {
         LOG_WARN_MSG("kfree: invalid magic at 0x%lx (block 0x%lx), magic=0x%x\n", (unsigned long)ptr, (unsigned long)b, b->magic);
-        spinlock_unlock_irqrestore(&heap_lock, irq_state);
+        qspin_unlock_irqrestore(&heap_lock, irq_state);
         return;
     }
     b->is_free = true;
     coalesce(b);
     
-    spinlock_unlock_irqrestore(&heap_lock, irq_state);
+    qspin_unlock_irqrestore(&heap_lock, irq_state);
 }
 
 /**
@@ -356,24 +356,24 @@ void* krealloc(void* ptr, size_t size) {
     if (!size) { kfree(ptr); return NULL; }
     
     bool irq_state;
-    spinlock_lock_irqsave(&heap_lock, &irq_state);
+    qspin_lock_irqsave(&heap_lock, &irq_state);
     
     heap_block_t *b = (heap_block_t*)((uintptr_t)ptr - sizeof(heap_block_t));
     if (b->magic != HEAP_MAGIC) {
-        spinlock_unlock_irqrestore(&heap_lock, irq_state);
+        qspin_unlock_irqrestore(&heap_lock, irq_state);
         return NULL;
     }
     
     // 如果新大小小于等于原大小，直接返回
     if (size <= b->size) {
-        spinlock_unlock_irqrestore(&heap_lock, irq_state);
+        qspin_unlock_irqrestore(&heap_lock, irq_state);
         return ptr;
     }
     
     // 保存旧大小用于复制
     size_t old_size = b->size;
     
-    spinlock_unlock_irqrestore(&heap_lock, irq_state);
+    qspin_unlock_irqrestore(&heap_lock, irq_state);
     
     // 分配新内存并复制数据（kmalloc/kfree 会自己获取锁）
     void* new_ptr = kmalloc(size);
@@ -474,7 +474,7 @@ int heap_get_info(heap_info_t *info) {
     }
     
     bool irq_state;
-    spinlock_lock_irqsave(&heap_lock, &irq_state);
+    qspin_lock_irqsave(&heap_lock, &irq_state);
     
     size_t total = heap_end - heap_start;
     size_t used = 0, free = 0;
@@ -497,7 +497,7 @@ int heap_get_info(heap_info_t *info) {
         }
     }
     
-    spinlock_unlock_irqrestore(&heap_lock, irq_state);
+    qspin_unlock_irqrestore(&heap_lock, irq_state);
     
     info->total = total;
     info->used = used + used_metadata;   // 已使用块的数据 + 元数据
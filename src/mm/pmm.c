@@ -15,7 +15,7 @@
 #include <lib/kprintf.h>
 #include <lib/string.h>
 #include <kernel/panic.h>
-#include <kernel/sync/spinlock.h>
+#include <kernel/sync/qspinlock.h>
 
 #define MAX_PROTECTED_FRAMES 65536
 
@@ -29,7 +29,7 @@ static pfn_t bitmap_size = 0;             ///< 位图大小（32位字数量）
 static pfn_t total_frames = 0;            ///< 总页帧数
 static pmm_info_t pmm_info = {0};         ///< 物理内存信息
 static pfn_t last_free_index = 0;         ///< 上次分配的空闲页帧索引（优化搜索）
-static spinlock_t pmm_lock;               ///< PMM 自旋锁
+static qspinlock_t pmm_lock;               ///< PMM 自旋锁
 static protected_frame_t protected_frames[MAX_PROTECTED_FRAMES];
 static uint32_t protected_frame_count = 0;
 static uint16_t *frame_refcount = NULL;   ///< 页帧引用计数数组（每帧2字节，最大65535引用）
@@ -151,7 +151,7 @@ void pmm_protect_frame(paddr_t frame) {
     }
     
     bool irq_state;
-    spinlock_lock_irqsave(&pmm_lock, &irq_state);
+    qspin_lock_irqsave(&pmm_lock, &irq_state);
     
     // 确保受保护的帧在位图中被标记为已使用
     pfn_t idx = PADDR_TO_PFN(frame);
@@ -176,7 +176,7 @@ void pmm_protect_frame(paddr_t frame) {
                      (unsigned long long)frame);
     }
     
-    spinlock_unlock_irqrestore(&pmm_lock, irq_state);
+    qspin_unlock_irqrestore(&pmm_lock, irq_state);
 }
 
 /**
@@ -193,13 +193,13 @@ void pmm_unprotect_frame(paddr_t frame) {
     }
     
     bool irq_state;
-    spinlock_lock_irqsave(&pmm_lock, &irq_state);
+    qspin_lock_irqsave(&pmm_lock, &irq_state);
     
     protected_frame_t *entry = find_protected_frame_unsafe(frame);
     if (!entry) {
         LOG_WARN_MSG("PMM: Attempted to unprotect unknown frame 0x%llx\n", 
                     (unsigned long long)frame);
-        spinlock_unlock_irqrestore(&pmm_lock, irq_state);
+        qspin_unlock_irqrestore(&pmm_lock, irq_state);
         return;
     }
     
@@ -215,7 +215,7 @@ void pmm_unprotect_frame(paddr_t frame) {
         *entry = protected_frames[protected_frame_count];
     }
     
-    spinlock_unlock_irqrestore(&pmm_lock, irq_state);
+    qspin_unlock_irqrestore(&pmm_lock, irq_state);
 }
 
 /**
@@ -230,9 +230,9 @@ bool pmm_is_frame_protected(paddr_t frame) {
     }
     
     bool irq_state;
-    spinlock_lock_irqsave(&pmm_lock, &irq_state);
+    qspin_lock_irqsave(&pmm_lock, &irq_state);
     bool protected_flag = (find_protected_frame_unsafe(frame) != NULL);
-    spinlock_unlock_irqrestore(&pmm_lock, irq_state);
+    qspin_unlock_irqrestore(&pmm_lock, irq_state);
     return protected_flag;
 }
 
@@ -285,7 +285,7 @@ void pmm_init(multiboot_info_t *mbi) {
     pmm_info.total_frames = total_frames;
     
     // 初始化 PMM 锁
-    spinlock_init(&pmm_lock);
+    qspin_init(&pmm_lock);
     
     // 初始化位图（默认所有页帧已使用）
     pfn_t bitmap_bytes = PAGE_ALIGN_UP((total_frames + 31) / 32 * 4);
@@ -489,7 +489,7 @@ void pmm_init_boot_info(boot_info_t *boot_info) {
     pmm_info.total_frames = total_frames;
     
     /* 初始化 PMM 锁 */
-    spinlock_init(&pmm_lock);
+    qspin_init(&pmm_lock);
     
     /* 初始化位图（默认所有页帧已使用） */
     pfn_t bitmap_bytes = PAGE_ALIGN_UP((total_frames + 31) / 32 * 4);
@@ -626,11 +626,11 @@ void pmm_init_boot_info(boot_info_t *boot_info) {
  */
 paddr_t pmm_alloc_frame(void) {
     bool irq_state;
-    spinlock_lock_irqsave(&pmm_lock, &irq_state);
+    qspin_lock_irqsave(&pmm_lock, &irq_state);
 
     pfn_t idx = find_free_frame();
     if (idx == PFN_INVALID) {
-        spinlock_unlock_irqrestore(&pmm_lock, irq_state);
+        qspin_unlock_irqrestore(&pmm_lock, irq_state);
         return PADDR_INVALID;
     }
     
@@ -638,7 +638,7 @@ paddr_t pmm_alloc_frame(void) {
     if (test_frame(idx)) {
         LOG_ERROR_MSG("PMM: CRITICAL: find_free_frame returned used frame %llu!\n", 
                      (unsigned long long)idx);
-        spinlock_unlock_irqrestore(&pmm_lock, irq_state);
+        qspin_unlock_irqrestore(&pmm_lock, irq_state);
         return PADDR_INVALID;
     }
     
@@ -659,7 +659,7 @@ paddr_t pmm_alloc_frame(void) {
                      (unsigned long long)bitmap_size, (unsigned long long)total_frames);
         pmm_info.free_frames++;
         pmm_info.used_frames--;
-        spinlock_unlock_irqrestore(&pmm_lock, irq_state);
+        qspin_unlock_irqrestore(&pmm_lock, irq_state);
         return PADDR_INVALID;
     }
     
@@ -673,7 +673,7 @@ paddr_t pmm_alloc_frame(void) {
         clear_frame(idx);
         pmm_info.free_frames++;
         pmm_info.used_frames--;
-        spinlock_unlock_irqrestore(&pmm_lock, irq_state);
+        qspin_unlock_irqrestore(&pmm_lock, irq_state);
         return PADDR_INVALID;
     }
 #elif defined(ARCH_ARM64)
@@ -687,7 +687,7 @@ paddr_t pmm_alloc_frame(void) {
         frame_refcount[idx] = 0;
         pmm_info.free_frames++;
         pmm_info.used_frames--;
-        spinlock_unlock_irqrestore(&pmm_lock, irq_state);
+        qspin_unlock_irqrestore(&pmm_lock, irq_state);
         return PADDR_INVALID;
     }
 #endif
@@ -706,14 +706,14 @@ paddr_t pmm_alloc_frame(void) {
         frame_refcount[idx] = 0;
         pmm_info.free_frames++;
         pmm_info.used_frames--;
-        spinlock_unlock_irqrestore(&pmm_lock, irq_state);
+        qspin_unlock_irqrestore(&pmm_lock, irq_state);
         return PADDR_INVALID;
     }
     
     // 清零页帧内容
     memset((void*)PHYS_TO_VIRT(addr), 0, PAGE_SIZE);
     
-    spinlock_unlock_irqrestore(&pmm_lock, irq_state);
+    qspin_unlock_irqrestore(&pmm_lock, irq_state);
     return addr;
 }
 
@@ -814,7 +814,7 @@ paddr_t pmm_alloc_frames_zone(size_t count, pmm_zone_t zone) {
     }
     
     bool irq_state;
-    spinlock_lock_irqsave(&pmm_lock, &irq_state);
+    qspin_lock_irqsave(&pmm_lock, &irq_state);
     
     /* Search for consecutive free frames within zone */
     pfn_t found_start = PFN_INVALID;
@@ -842,7 +842,7 @@ paddr_t pmm_alloc_frames_zone(size_t count, pmm_zone_t zone) {
     }
     
     if (consecutive < count || found_start == PFN_INVALID) {
-        spinlock_unlock_irqrestore(&pmm_lock, irq_state);
+        qspin_unlock_irqrestore(&pmm_lock, irq_state);
         LOG_DEBUG_MSG("PMM: Failed to allocate %zu contiguous frames in zone %d\n", 
                      count, zone);
         return PADDR_INVALID;
@@ -862,7 +862,7 @@ paddr_t pmm_alloc_frames_zone(size_t count, pmm_zone_t zone) {
     /* Clear all frames */
     memset((void*)PHYS_TO_VIRT(addr), 0, count * PAGE_SIZE);
     
-    spinlock_unlock_irqrestore(&pmm_lock, irq_state);
+    qspin_unlock_irqrestore(&pmm_lock, irq_state);
     
     LOG_DEBUG_MSG("PMM: Allocated %zu contiguous frames at 0x%llx (zone %d)\n",
                  count, (unsigned long long)addr, zone);
@@ -887,7 +887,7 @@ paddr_t pmm_alloc_frames(size_t count) {
     }
     
     bool irq_state;
-    spinlock_lock_irqsave(&pmm_lock, &irq_state);
+    qspin_lock_irqsave(&pmm_lock, &irq_state);
     
     // 搜索连续的空闲帧
     pfn_t start_pfn = PFN_INVALID;
@@ -910,7 +910,7 @@ paddr_t pmm_alloc_frames(size_t count) {
     }
     
     if (consecutive < count) {
-        spinlock_unlock_irqrestore(&pmm_lock, irq_state);
+        qspin_unlock_irqrestore(&pmm_lock, irq_state);
         return PADDR_INVALID;
     }
     
@@ -928,7 +928,7 @@ paddr_t pmm_alloc_frames(size_t count) {
     // 清零所有页帧
     memset((void*)PHYS_TO_VIRT(addr), 0, count * PAGE_SIZE);
     
-    spinlock_unlock_irqrestore(&pmm_lock, irq_state);
+    qspin_unlock_irqrestore(&pmm_lock, irq_state);
     return addr;
 }
 
@@ -951,11 +951,11 @@ void pmm_free_frame(paddr_t frame) {
     pfn_t idx = PADDR_TO_PFN(frame);
 
     bool irq_state;
-    spinlock_lock_irqsave(&pmm_lock, &irq_state);
+    qspin_lock_irqsave(&pmm_lock, &irq_state);
 
     // 检查有效性和状态
     if (idx >= total_frames) {
-        spinlock_unlock_irqrestore(&pmm_lock, irq_state);
+        qspin_unlock_irqrestore(&pmm_lock, irq_state);
         return;
     }
     
@@ -965,14 +965,14 @@ void pmm_free_frame(paddr_t frame) {
             LOG_WARN_MSG("PMM: Double free or freeing unused frame 0x%llx (idx %llu)\n", 
                         (unsigned long long)frame, (unsigned long long)idx);
         }
-        spinlock_unlock_irqrestore(&pmm_lock, irq_state);
+        qspin_unlock_irqrestore(&pmm_lock, irq_state);
         return;
     }
     
     if (find_protected_frame_unsafe(frame)) {
         LOG_ERROR_MSG("PMM: Attempt to free protected frame 0x%llx blocked\n", 
                      (unsigned long long)frame);
-        spinlock_unlock_irqrestore(&pmm_lock, irq_state);
+        qspin_unlock_irqrestore(&pmm_lock, irq_state);
         return;
     }
     
@@ -984,7 +984,7 @@ void pmm_free_frame(paddr_t frame) {
         frame_refcount[idx]--;
         if (frame_refcount[idx] > 0) {
             // 引用计数还不为 0，说明还有其他进程通过 COW 共享此帧
-            spinlock_unlock_irqrestore(&pmm_lock, irq_state);
+            qspin_unlock_irqrestore(&pmm_lock, irq_state);
             return;
         }
     }
@@ -1000,7 +1000,7 @@ void pmm_free_frame(paddr_t frame) {
         last_free_index = bitmap_idx;
     }
     
-    spinlock_unlock_irqrestore(&pmm_lock, irq_state);
+    qspin_unlock_irqrestore(&pmm_lock, irq_state);
 }
 
 /**
@@ -1123,13 +1123,13 @@ static pfn_t find_huge_page_frames(pfn_t zone_start, pfn_t zone_end) {
  */
 paddr_t pmm_alloc_huge_page(void) {
     bool irq_state;
-    spinlock_lock_irqsave(&pmm_lock, &irq_state);
+    qspin_lock_irqsave(&pmm_lock, &irq_state);
     
     /* Search for 2MB-aligned consecutive frames */
     pfn_t start_pfn = find_huge_page_frames(0, total_frames);
     
     if (start_pfn == PFN_INVALID) {
-        spinlock_unlock_irqrestore(&pmm_lock, irq_state);
+        qspin_unlock_irqrestore(&pmm_lock, irq_state);
         LOG_DEBUG_MSG("PMM: Failed to allocate 2MB huge page (no contiguous 2MB-aligned region)\n");
         return PADDR_INVALID;
     }
@@ -1149,7 +1149,7 @@ paddr_t pmm_alloc_huge_page(void) {
     /* Clear all frames */
     memset((void*)PHYS_TO_VIRT(addr), 0, HUGE_PAGE_SIZE);
     
-    spinlock_unlock_irqrestore(&pmm_lock, irq_state);
+    qspin_unlock_irqrestore(&pmm_lock, irq_state);
     
     LOG_DEBUG_MSG("PMM: Allocated 2MB huge page at 0x%llx\n", (unsigned long long)addr);
     
@@ -1180,13 +1180,13 @@ paddr_t pmm_alloc_huge_page_zone(pmm_zone_t zone) {
     }
     
     bool irq_state;
-    spinlock_lock_irqsave(&pmm_lock, &irq_state);
+    qspin_lock_irqsave(&pmm_lock, &irq_state);
     
     /* Search for 2MB-aligned consecutive frames within zone */
     pfn_t start_pfn = find_huge_page_frames(start_frame, end_frame);
     
     if (start_pfn == PFN_INVALID) {
-        spinlock_unlock_irqrestore(&pmm_lock, irq_state);
+        qspin_unlock_irqrestore(&pmm_lock, irq_state);
         LOG_DEBUG_MSG("PMM: Failed to allocate 2MB huge page in zone %d\n", zone);
         return PADDR_INVALID;
     }
@@ -1206,7 +1206,7 @@ paddr_t pmm_alloc_huge_page_zone(pmm_zone_t zone) {
     /* Clear all frames */
     memset((void*)PHYS_TO_VIRT(addr), 0, HUGE_PAGE_SIZE);
     
-    spinlock_unlock_irqrestore(&pmm_lock, irq_state);
+    qspin_unlock_irqrestore(&pmm_lock, irq_state);
     
     LOG_DEBUG_MSG("PMM: Allocated 2MB huge page at 0x%llx (zone %d)\n", 
                   (unsigned long long)addr, zone);
@@ -1240,7 +1240,7 @@ void pmm_free_huge_page(paddr_t huge_page) {
     }
     
     bool irq_state;
-    spinlock_lock_irqsave(&pmm_lock, &irq_state);
+    qspin_lock_irqsave(&pmm_lock, &irq_state);
     
     /* Free all 512 frames */
     for (pfn_t i = 0; i < frames_count; i++) {
@@ -1271,7 +1271,7 @@ void pmm_free_huge_page(paddr_t huge_page) {
         last_free_index = bitmap_idx;
     }
     
-    spinlock_unlock_irqrestore(&pmm_lock, irq_state);
+    qspin_unlock_irqrestore(&pmm_lock, irq_state);
     
     LOG_DEBUG_MSG("PMM: Freed 2MB huge page at 0x%llx\n", (unsigned long long)huge_page);
 }
@@ -1313,19 +1313,19 @@ uint32_t pmm_frame_ref_inc(paddr_t frame) {
     }
     
     bool irq_state;
-    spinlock_lock_irqsave(&pmm_lock, &irq_state);
+    qspin_lock_irqsave(&pmm_lock, &irq_state);
     
     if (frame_refcount[idx] == 0xFFFF) {
         LOG_ERROR_MSG("PMM: pmm_frame_ref_inc frame 0x%llx refcount overflow!\n", 
                      (unsigned long long)frame);
-        spinlock_unlock_irqrestore(&pmm_lock, irq_state);
+        qspin_unlock_irqrestore(&pmm_lock, irq_state);
         return 0xFFFF;
     }
     
     frame_refcount[idx]++;
     uint32_t new_count = frame_refcount[idx];
     
-    spinlock_unlock_irqrestore(&pmm_lock, irq_state);
+    qspin_unlock_irqrestore(&pmm_lock, irq_state);
     return new_count;
 }
 
@@ -1354,19 +1354,19 @@ uint32_t pmm_frame_ref_dec(paddr_t frame) {
     }
     
     bool irq_state;
-    spinlock_lock_irqsave(&pmm_lock, &irq_state);
+    qspin_lock_irqsave(&pmm_lock, &irq_state);
     
     if (frame_refcount[idx] == 0) {
         LOG_WARN_MSG("PMM: pmm_frame_ref_dec frame 0x%llx already zero!\n", 
                     (unsigned long long)frame);
-        spinlock_unlock_irqrestore(&pmm_lock, irq_state);
+        qspin_unlock_irqrestore(&pmm_lock, irq_state);
         return 0;
     }
     
     frame_refcount[idx]--;
     uint32_t new_count = frame_refcount[idx];
     
-    spinlock_unlock_irqrestore(&pmm_lock, irq_state);
+    qspin_unlock_irqrestore(&pmm_lock, irq_state);
     return new_count;
 }
 
@@ -1390,9 +1390,9 @@ uint32_t pmm_frame_get_refcount(paddr_t frame) {
     }
     
     bool irq_state;
-    spinlock_lock_irqsave(&pmm_lock, &irq_state);
+    qspin_lock_irqsave(&pmm_lock, &irq_state);
     uint32_t count = frame_refcount[idx];
-    spinlock_unlock_irqrestore(&pmm_lock, irq_state);
+    qspin_unlock_irqrestore(&pmm_lock, irq_state);
     
     return count;
 }
@@ -1409,7 +1409,7 @@ uint32_t pmm_frame_get_refcount(paddr_t frame) {
  */
 bool pmm_verify_consistency(void) {
     bool irq_state;
-    spinlock_lock_irqsave(&pmm_lock, &irq_state);
+    qspin_lock_irqsave(&pmm_lock, &irq_state);
     
     bool consistent = true;
     pfn_t counted_free = 0;
@@ -1546,7 +1546,7 @@ bool pmm_verify_consistency(void) {
     }
     kprintf("==============================================================\n\n");
     
-    spinlock_unlock_irqrestore(&pmm_lock, irq_state);
+    qspin_unlock_irqrestore(&pmm_lock, irq_state);
     return consistent;
 }
 
@@ -1555,7 +1555,7 @@ bool pmm_verify_consistency(void) {
  */
 void pmm_print_diagnostics(void) {
     bool irq_state;
-    spinlock_lock_irqsave(&pmm_lock, &irq_state);
+    qspin_lock_irqsave(&pmm_lock, &irq_state);
     
     kprintf("\n==================== PMM Diagnostics ====================\n");
     
@@ -1645,5 +1645,5 @@ void pmm_print_diagnostics(void) {
     
     kprintf("=========================================================\n\n");
     
-    spinlock_unlock_irqrestore(&pmm_lock, irq_state);
+    qspin_unlock_irqrestore(&pmm_lock, irq_state);
 }
@@ -12,11 +12,11 @@
 #include <lib/klog.h>
 #include <lib/kprintf.h>
 #include <drivers/timer.h>
-#include <kernel/sync/spinlock.h>
+#include <kernel/sync/rwlock.h>
 
 // ARP 缓存表
 static arp_entry_t arp_cache[ARP_CACHE_SIZE];
-static spinlock_t arp_cache_lock;
+static rwlock_t arp_cache_lock;   // 查找（每个发出的包）取读锁，更新取写锁
 
 // 字节序转换
 static inline uint16_t arp_ntohs(uint16_t n) {
@@ -98,7 +98,7 @@ static void arp_free_pending(arp_entry_t *entry) {
 }
 
 void arp_init(void) {
-    spinlock_init(&arp_cache_lock);
+    rwlock_init_named(&arp_cache_lock, "arp_cache");
     memset(arp_cache, 0, sizeof(arp_cache));
     
     LOG_INFO_MSG("arp: ARP protocol initialized\n");
@@ -173,25 +173,42 @@ int arp_resolve(netdev_t *dev, uint32_t ip, uint8_t *mac) {
     }
     
     bool irq_state;
-    spinlock_lock_irqsave(&arp_cache_lock, &irq_state);
+    rwlock_read_lock_irqsave(&arp_cache_lock, &irq_state);
     
-    // 查找缓存
+    // 快速路径：命中只需读锁（时间戳是单字写入，并发读者覆盖无妨）
     arp_entry_t *entry = arp_cache_find(ip);
     
     if (entry) {
         if (entry->state == ARP_STATE_RESOLVED) {
             // 已解析，复制 MAC 地址
             memcpy(mac, entry->mac_addr, 6);
-            entry->timestamp = (uint32_t)timer_get_uptime_ms();
-            spinlock_unlock_irqrestore(&arp_cache_lock, irq_state);
+            __atomic_store_n(&entry->timestamp, (uint32_t)timer_get_uptime_ms(),
+                             __ATOMIC_RELAXED);
+            rwlock_read_unlock_irqrestore(&arp_cache_lock, irq_state);
             return 0;
         } else if (entry->state == ARP_STATE_PENDING) {
             // 正在解析中
-            spinlock_unlock_irqrestore(&arp_cache_lock, irq_state);
+            rwlock_read_unlock_irqrestore(&arp_cache_lock, irq_state);
             return -1;
         }
     }
     
+    rwlock_read_unlock_irqrestore(&arp_cache_lock, irq_state);
+    rwlock_write_lock_irqsave(&arp_cache_lock, &irq_state);
+    
+    // 释放读锁期间可能已有其他路径创建了条目
+    entry = arp_cache_find(ip);
+    if (entry && (entry->state == ARP_STATE_RESOLVED ||
+                  entry->state == ARP_STATE_PENDING)) {
+        int ret = -1;
+        if (entry->state == ARP_STATE_RESOLVED) {
+            memcpy(mac, entry->mac_addr, 6);
+            ret = 0;
+        }
+        rwlock_write_unlock_irqrestore(&arp_cache_lock, irq_state);
+        return ret;
+    }
+    
     // 创建新的待解析条目
     entry = arp_cache_find_free();
     if (entry) {
@@ -208,7 +225,7 @@ int arp_resolve(netdev_t *dev, uint32_t ip, uint8_t *mac) {
         memset(entry->mac_addr, 0, 6);
     }
     
-    spinlock_unlock_irqrestore(&arp_cache_lock, irq_state);
+    rwlock_write_unlock_irqrestore(&arp_cache_lock, irq_state);
     
     // 发送 ARP 请求
     arp_request(dev, ip);
@@ -294,7 +311,7 @@ void arp_cache_update(uint32_t ip, const uint8_t *mac) {
     }
     
     bool irq_state;
-    spinlock_lock_irqsave(&arp_cache_lock, &irq_state);
+    rwlock_write_lock_irqsave(&arp_cache_lock, &irq_state);
     
     // 查找现有条目
     arp_entry_t *entry = arp_cache_find(ip);
@@ -303,7 +320,7 @@ void arp_cache_update(uint32_t ip, const uint8_t *mac) {
         // 创建新条目
         entry = arp_cache_find_free();
         if (!entry) {
-            spinlock_unlock_irqrestore(&arp_cache_lock, irq_state);
+            rwlock_write_unlock_irqrestore(&arp_cache_lock, irq_state);
             return;
         }
         entry->ip_addr = ip;
@@ -325,7 +342,7 @@ void arp_cache_update(uint32_t ip, const uint8_t *mac) {
         arp_send_pending(entry, dev);
     }
     
-    spinlock_unlock_irqrestore(&arp_cache_lock, irq_state);
+    rwlock_write_unlock_irqrestore(&arp_cache_lock, irq_state);
 }
 
 int arp_cache_lookup(uint32_t ip, uint8_t *mac) {
@@ -334,17 +351,17 @@ int arp_cache_lookup(uint32_t ip, uint8_t *mac) {
     }
     
     bool irq_state;
-    spinlock_lock_irqsave(&arp_cache_lock, &irq_state);
+    rwlock_read_lock_irqsave(&arp_cache_lock, &irq_state);
     
     arp_entry_t *entry = arp_cache_find(ip);
     
     if (entry && entry->state == ARP_STATE_RESOLVED) {
         memcpy(mac, entry->mac_addr, 6);
-        spinlock_unlock_irqrestore(&arp_cache_lock, irq_state);
+        rwlock_read_unlock_irqrestore(&arp_cache_lock, irq_state);
         return 0;
     }
     
-    spinlock_unlock_irqrestore(&arp_cache_lock, irq_state);
+    rwlock_read_unlock_irqrestore(&arp_cache_lock, irq_state);
     return -1;
 }
 
@@ -360,7 +377,7 @@ int arp_cache_add_static(uint32_t ip, const uint8_t *mac) {
 
 int arp_cache_delete(uint32_t ip) {
     bool irq_state;
-    spinlock_lock_irqsave(&arp_cache_lock, &irq_state);
+    rwlock_write_lock_irqsave(&arp_cache_lock, &irq_state);
     
     arp_entry_t *entry = arp_cache_find(ip);
     
@@ -368,11 +385,11 @@ int arp_cache_delete(uint32_t ip) {
         arp_free_pending(entry);
         memset(entry, 0, sizeof(arp_entry_t));
         entry->state = ARP_STATE_FREE;
-        spinlock_unlock_irqrestore(&arp_cache_lock, irq_state);
+        rwlock_write_unlock_irqrestore(&arp_cache_lock, irq_state);
         return 0;
     }
     
-    spinlock_unlock_irqrestore(&arp_cache_lock, irq_state);
+    rwlock_write_unlock_irqrestore(&arp_cache_lock, irq_state);
     return -1;
 }
 
@@ -380,7 +397,7 @@ void arp_cache_cleanup(void) {
     uint32_t now = (uint32_t)timer_get_uptime_ms();
     
     bool irq_state;
-    spinlock_lock_irqsave(&arp_cache_lock, &irq_state);
+    rwlock_write_lock_irqsave(&arp_cache_lock, &irq_state);
     
     for (int i = 0; i < ARP_CACHE_SIZE; i++) {
         if (arp_cache[i].state == ARP_STATE_RESOLVED) {
@@ -397,19 +414,19 @@ void arp_cache_cleanup(void) {
         }
     }
     
-    spinlock_unlock_irqrestore(&arp_cache_lock, irq_state);
+    rwlock_write_unlock_irqrestore(&arp_cache_lock, irq_state);
 }
 
 void arp_cache_clear(void) {
     bool irq_state;
-    spinlock_lock_irqsave(&arp_cache_lock, &irq_state);
+    rwlock_write_lock_irqsave(&arp_cache_lock, &irq_state);
     
     for (int i = 0; i < ARP_CACHE_SIZE; i++) {
         arp_free_pending(&arp_cache[i]);
         memset(&arp_cache[i], 0, sizeof(arp_entry_t));
     }
     
-    spinlock_unlock_irqrestore(&arp_cache_lock, irq_state);
+    rwlock_write_unlock_irqrestore(&arp_cache_lock, irq_state);
 }
 
 void arp_cache_dump(void) {
@@ -418,7 +435,7 @@ void arp_cache_dump(void) {
     kprintf("------------------------------------------------\n");
     
     bool irq_state;
-    spinlock_lock_irqsave(&arp_cache_lock, &irq_state);
+    rwlock_read_lock_irqsave(&arp_cache_lock, &irq_state);
     
     int count = 0;
     for (int i = 0; i < ARP_CACHE_SIZE; i++) {
@@ -441,7 +458,7 @@ void arp_cache_dump(void) {
         }
     }
     
-    spinlock_unlock_irqrestore(&arp_cache_lock, irq_state);
+    rwlock_read_unlock_irqrestore(&arp_cache_lock, irq_state);
     
     if (count == 0) {
         kprintf("(empty)\n");
@@ -452,7 +469,7 @@ int arp_cache_count(void) {
     int count = 0;
     
     bool irq_state;
-    spinlock_lock_irqsave(&arp_cache_lock, &irq_state);
+    rwlock_read_lock_irqsave(&arp_cache_lock, &irq_state);
     
     for (int i = 0; i < ARP_CACHE_SIZE; i++) {
         if (arp_cache[i].state != ARP_STATE_FREE) {
@@ -460,7 +477,7 @@ int arp_cache_count(void) {
         }
     }
     
-    spinlock_unlock_irqrestore(&arp_cache_lock, irq_state);
+    rwlock_read_unlock_irqrestore(&arp_cache_lock, irq_state);
     
     return count;
 }
@@ -471,10 +488,10 @@ int arp_cache_get_entry(int index, uint32_t *ip, uint8_t *mac, uint8_t *state) {
     }
     
     bool irq_state;
-    spinlock_lock_irqsave(&arp_cache_lock, &irq_state);
+    rwlock_read_lock_irqsave(&arp_cache_lock, &irq_state);
     
     if (arp_cache[index].state == ARP_STATE_FREE) {
-        spinlock_unlock_irqrestore(&arp_cache_lock, irq_state);
+        rwlock_read_unlock_irqrestore(&arp_cache_lock, irq_state);
         return -1;
     }
     
@@ -482,7 +499,7 @@ int arp_cache_get_entry(int index, uint32_t *ip, uint8_t *mac, uint8_t *state) {
     memcpy(mac, arp_cache[index].mac_addr, 6);
     *state = arp_cache[index].state;
     
-    spinlock_unlock_irqrestore(&arp_cache_lock, irq_state);
+    rwlock_read_unlock_irqrestore(&arp_cache_lock, irq_state);
     return 0;
 }
 
@@ -492,7 +509,7 @@ int arp_queue_packet(uint32_t ip, netbuf_t *buf) {
     }
     
     bool irq_state;
-    spinlock_lock_irqsave(&arp_cache_lock, &irq_state);
+    rwlock_write_lock_irqsave(&arp_cache_lock, &irq_state);
     
     arp_entry_t *entry = arp_cache_find(ip);
     
@@ -508,11 +525,11 @@ int arp_queue_packet(uint32_t ip, netbuf_t *buf) {
             }
             tail->next = buf;
         }
-        spinlock_unlock_irqrestore(&arp_cache_lock, irq_state);
+        rwlock_write_unlock_irqrestore(&arp_cache_lock, irq_state);
         return 0;
     }
     
-    spinlock_unlock_irqrestore(&arp_cache_lock, irq_state);
+    rwlock_write_unlock_irqrestore(&arp_cache_lock, irq_state);
     return -1;
 }
 
@@ -7,13 +7,41 @@
  */
 
 #include <net/checksum.h>
+#include <net/netbuf.h>
+#include <net/ip.h>
+#include <lib/string.h>
 
+/* 允许非对齐访问的 32 位载入类型（i686/x86_64/arm64 均支持非对齐载入） */
+typedef uint32_t __attribute__((__may_alias__, __aligned__(1))) csum_u32_t;
+typedef uint16_t __attribute__((__may_alias__, __aligned__(1))) csum_u16_t;
+
+/*
+ * 一次累加 32 位字到 64 位累加器，循环内无需处理进位；
+ * 32 位字 = 高 16 位 * 65536 + 低 16 位 ≡ 高 16 位 + 低 16 位 (mod 0xFFFF)，
+ * 因此结果与逐 16 位累加在反码意义下相同。
+ */
 uint32_t checksum_partial(uint32_t sum, void *data, int len) {
-    uint16_t *ptr = (uint16_t *)data;
+    const uint8_t *ptr = (const uint8_t *)data;
+    uint64_t acc = sum;
     
-    // 按16位累加
-    while (len > 1) {
-        sum += *ptr++;
+    // 主循环：每次 32 字节，8 路 32 位累加
+    while (len >= 32) {
+        const csum_u32_t *w = (const csum_u32_t *)ptr;
+        acc += (uint64_t)w[0] + w[1] + w[2] + w[3];
+        acc += (uint64_t)w[4] + w[5] + w[6] + w[7];
+        ptr += 32;
+        len -= 32;
+    }
+    
+    while (len >= 4) {
+        acc += *(const csum_u32_t *)ptr;
+        ptr += 4;
+        len -= 4;
+    }
+    
+    if (len >= 2) {
+        acc += *(const csum_u16_t *)ptr;
+        ptr += 2;
         len -= 2;
     }
     
@@ -25,12 +53,17 @@ uint32_t checksum_partial(uint32_t sum, void *data, int len) {
             uint8_t bytes[2];
             uint16_t word;
         } odd;
-        odd.bytes[0] = *(uint8_t *)ptr;
+        odd.bytes[0] = *ptr;
         odd.bytes[1] = 0;
-        sum += odd.word;
+        acc += odd.word;
+    }
+    
+    // 折叠到 16 位（循环进位保证非零和不会变成 0）
+    while (acc >> 16) {
+        acc = (acc & 0xFFFF) + (acc >> 16);
     }
     
-    return sum;
+    return (uint32_t)acc;
 }
 
 uint16_t checksum_finish(uint32_t sum) {
@@ -60,3 +93,26 @@ bool checksum_verify(void *data, int len) {
     return (sum == 0xFFFF);
 }
 
+
+uint16_t checksum_pseudo(uint32_t src_ip, uint32_t dst_ip, uint8_t protocol, uint16_t len) {
+    // 与按内存布局 {src, dst, 0, protocol, len} 逐 16 位累加等价
+    uint32_t sum = (src_ip & 0xFFFF) + (src_ip >> 16) +
+                   (dst_ip & 0xFFFF) + (dst_ip >> 16) +
+                   htons((uint16_t)protocol) + htons(len);
+    
+    while (sum >> 16) {
+        sum = (sum & 0xFFFF) + (sum >> 16);
+    }
+    return (uint16_t)sum;
+}
+
+void checksum_l4_partial(netbuf_t *buf, void *l4, uint16_t csum_offset,
+                         uint32_t src_ip, uint32_t dst_ip, uint8_t protocol, uint16_t len) {
+    // 字段中放入伪首部和（未取反），网卡从 l4 起累加到包尾并写入取反结果
+    uint16_t pseudo = checksum_pseudo(src_ip, dst_ip, protocol, len);
+    memcpy((uint8_t *)l4 + csum_offset, &pseudo, sizeof(pseudo));
+    
+    buf->csum_flags |= NETBUF_CSUM_PARTIAL;
+    buf->csum_start = (uint16_t)((uint8_t *)l4 - buf->head);
+    buf->csum_offset = csum_offset;
+}
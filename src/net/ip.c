@@ -9,7 +9,7 @@
 #include <net/netdev.h>
 #include <net/netbuf.h>
 #include <net/checksum.h>
-#include <kernel/sync/spinlock.h>
+#include <kernel/sync/rwlock.h>
 #include <mm/heap.h>
 #include <lib/string.h>
 #include <lib/klog.h>
@@ -24,7 +24,7 @@ static ip_reassembly_t reass_table[IP_REASS_MAX_ENTRIES];
 
 // 路由表
 static ip_route_t route_table[IP_ROUTE_MAX];
-static spinlock_t route_lock;  // 静态变量自动初始化为 0（未锁定状态）
+static rwlock_t route_lock;    // 读多写少：每个发出的包查一次，配置时才修改
 
 // 前向声明上层协议处理函数
 extern void icmp_input(netdev_t *dev, netbuf_t *buf, uint32_t src_ip);
@@ -251,6 +251,7 @@ void ip_init(void) {
     
     // 初始化路由表
     memset(route_table, 0, sizeof(route_table));
+    rwlock_init_named(&route_lock, "ip_route");
     
     LOG_INFO_MSG("ip: IPv4 protocol initialized\n");
 }
@@ -265,6 +266,9 @@ netdev_t *ip_route_lookup(uint32_t dst_ip, uint32_t *next_hop) {
     uint32_t best_gateway = 0;
     uint32_t best_metric = 0xFFFFFFFF;
     
+    bool irq_state;
+    rwlock_read_lock_irqsave(&route_lock, &irq_state);
+    
     // 查找最长前缀匹配的路由
     for (int i = 0; i < IP_ROUTE_MAX; i++) {
         ip_route_t *r = &route_table[i];
@@ -308,6 +312,8 @@ netdev_t *ip_route_lookup(uint32_t dst_ip, uint32_t *next_hop) {
         }
     }
     
+    rwlock_read_unlock_irqrestore(&route_lock, irq_state);
+    
     // 如果找到了路由，设置下一跳
     if (best_dev && next_hop) {
         if (best_gateway != 0) {
@@ -337,6 +343,10 @@ netdev_t *ip_route_lookup(uint32_t dst_ip, uint32_t *next_hop) {
 
 int ip_route_add(uint32_t dest, uint32_t netmask, uint32_t gateway, 
                  netdev_t *dev, uint32_t metric) {
+    int ret = -1;  // 路由表满
+    bool irq_state;
+    rwlock_write_lock_irqsave(&route_lock, &irq_state);
+    
     // 查找空闲条目或相同路由
     for (int i = 0; i < IP_ROUTE_MAX; i++) {
         ip_route_t *r = &route_table[i];
@@ -347,7 +357,8 @@ int ip_route_add(uint32_t dest, uint32_t netmask, uint32_t gateway,
             r->gateway = gateway;
             r->dev = dev;
             r->metric = metric;
-            return 0;
+            ret = 0;
+            goto out;
         }
     }
     
@@ -361,22 +372,32 @@ int ip_route_add(uint32_t dest, uint32_t netmask, uint32_t gateway,
             r->dev = dev;
             r->metric = metric;
             r->valid = true;
-            return 0;
+            ret = 0;
+            goto out;
         }
     }
     
-    return -1;  // 路由表满
+out:
+    rwlock_write_unlock_irqrestore(&route_lock, irq_state);
+    return ret;
 }
 
 int ip_route_del(uint32_t dest, uint32_t netmask) {
+    int ret = -1;  // 路由不存在
+    bool irq_state;
+    rwlock_write_lock_irqsave(&route_lock, &irq_state);
+    
     for (int i = 0; i < IP_ROUTE_MAX; i++) {
         ip_route_t *r = &route_table[i];
         if (r->valid && r->dest == dest && r->netmask == netmask) {
             r->valid = false;
-            return 0;
+            ret = 0;
+            break;
         }
     }
-    return -1;  // 路由不存在
+    
+    rwlock_write_unlock_irqrestore(&route_lock, irq_state);
+    return ret;
 }
 
 int ip_route_dump(char *buf, size_t size) {
@@ -392,7 +413,7 @@ int ip_route_dump(char *buf, size_t size) {
     } while(0)
     
     bool irq_state;
-    spinlock_lock_irqsave(&route_lock, &irq_state);
+    rwlock_read_lock_irqsave(&route_lock, &irq_state);
     
     // 表头
     OUTPUT("Kernel IP Routing Table\n");
@@ -419,7 +440,7 @@ int ip_route_dump(char *buf, size_t size) {
                r->dev ? r->dev->name : "N/A", r->metric);
     }
     
-    spinlock_unlock_irqrestore(&route_lock, irq_state);
+    rwlock_read_unlock_irqrestore(&route_lock, irq_state);
     
     #undef OUTPUT
     return len;
@@ -455,8 +476,8 @@ void ip_input(netdev_t *dev, netbuf_t *buf) {
         return;
     }
     
-    // 验证校验和
-    if (ip_checksum(ip, hdr_len) != 0) {
+    // 验证校验和（网卡已验证时跳过）
+    if (!(buf->csum_flags & NETBUF_CSUM_IP_VALID) && ip_checksum(ip, hdr_len) != 0) {
         LOG_WARN_MSG("ip: Invalid checksum\n");
         netbuf_free(buf);
         return;
@@ -563,7 +584,7 @@ int ip_output(netdev_t *dev, netbuf_t *buf, uint32_t dst_ip, uint8_t protocol) {
     
     ip->version_ihl = (IP_VERSION_4 << 4) | (IP_HEADER_MIN_LEN / 4);
     ip->tos = 0;
-    ip->total_length = htons(buf->len);
+    ip->total_length = htons(netbuf_total_len(buf));
     uint16_t id = ip_id_counter++;
     ip->identification = htons(id);
     ip->flags_fragment = htons(IP_FLAG_DF);  // Don't Fragment
@@ -1,53 +1,399 @@
 /**
  * @file netbuf.c
  * @brief 网络缓冲区管理实现
+ *
+ * netbuf 描述符来自静态数组，数据块来自按尺寸分级的预分配池，
+ * 两者的空闲链表都是带版本号的无锁栈，可在中断上下文中使用。
  */
 
 #include <net/netbuf.h>
+#include <net/checksum.h>
 #include <mm/heap.h>
+#include <mm/pmm.h>
+#include <mm/vmm.h>
+#include <lib/klog.h>
 #include <lib/string.h>
 
-netbuf_t *netbuf_alloc(uint32_t size) {
-    uint32_t total_size = NETBUF_HEADROOM + size;
-    if (total_size > NETBUF_MAX_SIZE) {
-        total_size = NETBUF_MAX_SIZE;
+/* ============================================================================
+ * 无锁索引栈
+ *
+ * 栈顶为 64 位字：高 32 位为版本号（每次修改递增，防止 ABA），
+ * 低 32 位为元素序号 + 1（0 表示空栈）。每个元素的后继序号保存在
+ * 元素内的一个 uint32_t 字段中，由 base + idx * stride 定位。
+ * ============================================================================ */
+
+#define FREELIST_INDEX(top)     ((uint32_t)((top) & 0xFFFFFFFFu))
+#define FREELIST_MAKE(gen, idx) (((uint64_t)(uint32_t)(gen) << 32) | (uint32_t)(idx))
+
+static inline volatile uint32_t *freelist_link(void *base, size_t stride, uint32_t idx) {
+    return (volatile uint32_t *)((uint8_t *)base + (size_t)idx * stride);
+}
+
+static void freelist_push(volatile uint64_t *top, void *base, size_t stride, uint32_t idx) {
+    volatile uint32_t *link = freelist_link(base, stride, idx);
+    uint64_t old = atomic_load64(top);
+    uint64_t new_top;
+    do {
+        *link = FREELIST_INDEX(old);
+        new_top = FREELIST_MAKE((old >> 32) + 1, idx + 1);
+    } while (!atomic_cmpxchg64(top, &old, new_top));
+}
+
+static bool freelist_pop(volatile uint64_t *top, void *base, size_t stride, uint32_t *idx) {
+    uint64_t old = atomic_load64(top);
+    uint64_t new_top;
+    uint32_t first;
+    do {
+        first = FREELIST_INDEX(old);
+        if (first == 0) {
+            return false;
+        }
+        /* 读到的后继可能已过期，版本号保证此时 CAS 失败并重试 */
+        new_top = FREELIST_MAKE((old >> 32) + 1, *freelist_link(base, stride, first - 1));
+    } while (!atomic_cmpxchg64(top, &old, new_top));
+
+    *idx = first - 1;
+    return true;
+}
+
+/* ============================================================================
+ * 描述符分配
+ *
+ * 静态数组按需启用（netbuf_desc_used 单调递增），释放后通过空闲栈复用；
+ * 全部用完时回退到 kmalloc。
+ * ============================================================================ */
+
+static netbuf_t netbuf_descs[NETBUF_DESC_COUNT];
+static uint32_t netbuf_desc_links[NETBUF_DESC_COUNT];
+static volatile uint64_t netbuf_desc_free = 0;
+static atomic_t netbuf_desc_used = ATOMIC_INIT(0);
+
+static inline bool netbuf_desc_is_static(const netbuf_t *buf) {
+    return buf >= &netbuf_descs[0] && buf < &netbuf_descs[NETBUF_DESC_COUNT];
+}
+
+static netbuf_t *netbuf_desc_alloc(void) {
+    uint32_t idx;
+    if (freelist_pop(&netbuf_desc_free, netbuf_desc_links, sizeof(uint32_t), &idx)) {
+        return &netbuf_descs[idx];
     }
-    
-    netbuf_t *buf = (netbuf_t *)kmalloc(sizeof(netbuf_t));
-    if (!buf) {
-        return NULL;
+
+    if (atomic_read(&netbuf_desc_used) < NETBUF_DESC_COUNT) {
+        idx = atomic_fetch_add(&netbuf_desc_used, 1);
+        if (idx < NETBUF_DESC_COUNT) {
+            return &netbuf_descs[idx];
+        }
     }
-    
-    buf->head = (uint8_t *)kmalloc(total_size);
-    if (!buf->head) {
+
+    return (netbuf_t *)kmalloc(sizeof(netbuf_t));
+}
+
+static void netbuf_desc_release(netbuf_t *buf) {
+    if (netbuf_desc_is_static(buf)) {
+        freelist_push(&netbuf_desc_free, netbuf_desc_links, sizeof(uint32_t),
+                      (uint32_t)(buf - netbuf_descs));
+    } else {
         kfree(buf);
-        return NULL;
     }
-    
-    memset(buf->head, 0, total_size);
-    
-    buf->data = buf->head + NETBUF_HEADROOM;
+}
+
+/**
+ * @brief 把描述符绑定到数据区并清空元数据
+ */
+static void netbuf_desc_bind(netbuf_t *buf, uint8_t *head, uint32_t total_size,
+                             netbuf_block_t *block) {
+    buf->head = head;
+    buf->end = head + total_size;
+    buf->total_size = total_size;
+    buf->data = head + NETBUF_HEADROOM;
     buf->tail = buf->data;
-    buf->end = buf->head + total_size;
     buf->len = 0;
-    buf->total_size = total_size;
-    
     buf->mac_header = NULL;
     buf->network_header = NULL;
     buf->transport_header = NULL;
     buf->dev = NULL;
+    buf->src_ip = 0;
+    buf->src_port = 0;
     buf->next = NULL;
-    
+    buf->csum_flags = 0;
+    buf->gso_size = 0;
+    buf->block = block;
+    buf->nr_frags = 0;
+    buf->frag_len = 0;
+}
+
+/* ============================================================================
+ * 预分配池
+ * ============================================================================ */
+
+/* 全局尺寸级别（总大小含 headroom，均整除 PAGE_SIZE） */
+static const uint32_t netbuf_class_size[NETBUF_NUM_CLASSES]     = { 256, 512, NETBUF_MAX_SIZE };
+static const uint32_t netbuf_class_initial[NETBUF_NUM_CLASSES]  = { 64,  64,  128 };
+static const uint32_t netbuf_class_capacity[NETBUF_NUM_CLASSES] = { 512, 512, 1024 };
+
+static netbuf_pool_t netbuf_classes[NETBUF_NUM_CLASSES];
+static bool netbuf_classes_ready = false;
+
+static void netbuf_pool_push(netbuf_pool_t *pool, netbuf_block_t *block) {
+    freelist_push(&pool->free_head, &pool->blocks[0].next_free, sizeof(netbuf_block_t),
+                  (uint32_t)(block - pool->blocks));
+    atomic_inc_return(&pool->free_count);
+}
+
+/**
+ * @brief 从页帧切分新块并放入空闲栈（调用者持有 grow_lock）
+ * @return 新增的块数
+ */
+static uint32_t netbuf_pool_grow(netbuf_pool_t *pool, uint32_t want) {
+    const uint32_t per_frame = PAGE_SIZE / pool->buf_size;
+    uint32_t added = 0;
+
+    while (added < want) {
+        uint32_t base = atomic_read(&pool->count);
+        if (base + per_frame > pool->capacity) {
+            break;
+        }
+
+        paddr_t frame = pmm_alloc_frame();
+        if (frame == PADDR_INVALID) {
+            break;
+        }
+
+        for (uint32_t slot = 0; slot < per_frame; slot++) {
+            netbuf_block_t *block = &pool->blocks[base + slot];
+            block->phys = frame + (paddr_t)slot * pool->buf_size;
+            block->virt = (uint8_t *)PHYS_TO_VIRT((uintptr_t)block->phys);
+            block->pool = pool;
+            atomic_set(&block->refcount, 0);
+        }
+
+        /* 块初始化完成后再发布，之后才能被其他 CPU 弹出 */
+        atomic_add_return(&pool->count, per_frame);
+        for (uint32_t slot = 0; slot < per_frame; slot++) {
+            netbuf_pool_push(pool, &pool->blocks[base + slot]);
+        }
+        added += per_frame;
+    }
+
+    return added;
+}
+
+int netbuf_pool_init(netbuf_pool_t *pool, uint32_t buf_size,
+                     uint32_t initial, uint32_t capacity) {
+    if (!pool || buf_size <= NETBUF_HEADROOM || buf_size > PAGE_SIZE ||
+        (PAGE_SIZE % buf_size) != 0 || initial == 0 || capacity < initial) {
+        return -1;
+    }
+
+    memset(pool, 0, sizeof(netbuf_pool_t));
+    spinlock_init(&pool->grow_lock);
+    pool->buf_size = buf_size;
+    pool->capacity = capacity;
+
+    pool->blocks = (netbuf_block_t *)kmalloc(sizeof(netbuf_block_t) * capacity);
+    if (!pool->blocks) {
+        LOG_ERROR_MSG("netbuf: Failed to allocate pool blocks\n");
+        return -1;
+    }
+    memset(pool->blocks, 0, sizeof(netbuf_block_t) * capacity);
+
+    const uint32_t per_frame = PAGE_SIZE / buf_size;
+    pool->refill_batch = initial / 2 > per_frame ? initial / 2 : per_frame;
+    pool->low_water = capacity > initial ? initial / 4 : 0;
+
+    netbuf_pool_grow(pool, initial);
+    if (atomic_read(&pool->count) == 0) {
+        LOG_ERROR_MSG("netbuf: Out of frames for %u-byte pool\n", buf_size);
+        kfree(pool->blocks);
+        pool->blocks = NULL;
+        return -1;
+    }
+
+    pool->min_free = atomic_read(&pool->free_count);
+
+    LOG_DEBUG_MSG("netbuf: Pool initialized with %u x %u-byte buffers (capacity %u)\n",
+                  atomic_read(&pool->count), buf_size, capacity);
+    return 0;
+}
+
+uint32_t netbuf_pool_refill(netbuf_pool_t *pool) {
+    if (!pool || !pool->blocks || atomic_read(&pool->count) >= pool->capacity) {
+        return 0;
+    }
+
+    /* 已有其他上下文在补充时直接返回，分配路径不会自旋等待 */
+    if (!spinlock_try_lock(&pool->grow_lock)) {
+        return 0;
+    }
+    uint32_t added = netbuf_pool_grow(pool, pool->refill_batch);
+    spinlock_unlock(&pool->grow_lock);
+
+    return added;
+}
+
+/**
+ * @brief 从池中取出一个数据块（引用计数置 1）
+ */
+static netbuf_block_t *netbuf_pool_get_block(netbuf_pool_t *pool) {
+    uint32_t idx;
+    if (!freelist_pop(&pool->free_head, &pool->blocks[0].next_free,
+                      sizeof(netbuf_block_t), &idx)) {
+        if (netbuf_pool_refill(pool) == 0 ||
+            !freelist_pop(&pool->free_head, &pool->blocks[0].next_free,
+                          sizeof(netbuf_block_t), &idx)) {
+            pool->alloc_failures++;
+            return NULL;
+        }
+    }
+
+    uint32_t free_now = atomic_dec_return(&pool->free_count);
+    if (free_now < pool->min_free) {
+        pool->min_free = free_now;
+    }
+    pool->allocs++;
+
+    if (free_now < pool->low_water) {
+        netbuf_pool_refill(pool);
+    }
+
+    netbuf_block_t *block = &pool->blocks[idx];
+    atomic_set(&block->refcount, 1);
+    return block;
+}
+
+/**
+ * @brief 释放一个数据块引用，最后一个引用归还到池
+ */
+static void netbuf_block_put(netbuf_block_t *block) {
+    if (atomic_dec_return(&block->refcount) == 0) {
+        netbuf_pool_push(block->pool, block);
+    }
+}
+
+netbuf_t *netbuf_pool_alloc(netbuf_pool_t *pool) {
+    if (!pool || !pool->blocks) {
+        return NULL;
+    }
+
+    netbuf_block_t *block = netbuf_pool_get_block(pool);
+    if (!block) {
+        return NULL;
+    }
+
+    netbuf_t *buf = netbuf_desc_alloc();
+    if (!buf) {
+        netbuf_block_put(block);
+        return NULL;
+    }
+
+    netbuf_desc_bind(buf, block->virt, pool->buf_size, block);
     return buf;
 }
 
-void netbuf_free(netbuf_t *buf) {
-    if (buf) {
-        if (buf->head) {
-            kfree(buf->head);
+int netbuf_pool_destroy(netbuf_pool_t *pool) {
+    if (!pool || !pool->blocks) {
+        return -1;
+    }
+
+    uint32_t count = atomic_read(&pool->count);
+    if (atomic_read(&pool->free_count) != count) {
+        LOG_ERROR_MSG("netbuf: Pool still has %u buffers in use\n",
+                      count - atomic_read(&pool->free_count));
+        return -1;
+    }
+
+    /* 每个页帧的第一块位于帧起始处 */
+    const uint32_t per_frame = PAGE_SIZE / pool->buf_size;
+    for (uint32_t i = 0; i < count; i += per_frame) {
+        pmm_free_frame(pool->blocks[i].phys);
+    }
+
+    kfree(pool->blocks);
+    pool->blocks = NULL;
+    atomic_set(&pool->count, 0);
+    atomic_set(&pool->free_count, 0);
+    pool->free_head = 0;
+    return 0;
+}
+
+void netbuf_init(void) {
+    if (netbuf_classes_ready) {
+        return;
+    }
+
+    for (int i = 0; i < NETBUF_NUM_CLASSES; i++) {
+        if (netbuf_pool_init(&netbuf_classes[i], netbuf_class_size[i],
+                             netbuf_class_initial[i], netbuf_class_capacity[i]) != 0) {
+            LOG_WARN_MSG("netbuf: %u-byte class unavailable, using heap\n",
+                         netbuf_class_size[i]);
         }
-        kfree(buf);
     }
+    netbuf_classes_ready = true;
+}
+
+/* ============================================================================
+ * 缓冲区接口
+ * ============================================================================ */
+
+netbuf_t *netbuf_alloc(uint32_t size) {
+    uint32_t total_size = NETBUF_HEADROOM + size;
+    if (size > NETBUF_MAX_SIZE || total_size > NETBUF_MAX_SIZE) {
+        total_size = NETBUF_MAX_SIZE;
+    }
+
+    if (netbuf_classes_ready) {
+        for (int i = 0; i < NETBUF_NUM_CLASSES; i++) {
+            netbuf_pool_t *pool = &netbuf_classes[i];
+            if (pool->buf_size >= total_size && pool->blocks) {
+                netbuf_t *buf = netbuf_pool_alloc(pool);
+                if (buf) {
+                    return buf;
+                }
+            }
+        }
+    }
+
+    /* 池未初始化或已耗尽：回退到堆分配 */
+    netbuf_t *buf = netbuf_desc_alloc();
+    if (!buf) {
+        return NULL;
+    }
+
+    uint8_t *head = (uint8_t *)kmalloc(total_size);
+    if (!head) {
+        netbuf_desc_release(buf);
+        return NULL;
+    }
+
+    netbuf_desc_bind(buf, head, total_size, NULL);
+    return buf;
+}
+
+/**
+ * @brief 归还所有分片持有的页引用
+ */
+static void netbuf_drop_frags(netbuf_t *buf) {
+    for (uint8_t i = 0; i < buf->nr_frags; i++) {
+        pmm_free_frame(buf->frags[i].page);
+    }
+    buf->nr_frags = 0;
+    buf->frag_len = 0;
+}
+
+void netbuf_free(netbuf_t *buf) {
+    if (!buf) {
+        return;
+    }
+
+    netbuf_drop_frags(buf);
+
+    if (buf->block) {
+        netbuf_block_put(buf->block);
+    } else if (buf->head) {
+        kfree(buf->head);
+    }
+
+    netbuf_desc_release(buf);
 }
 
 uint8_t *netbuf_push(netbuf_t *buf, uint32_t len) {
@@ -78,11 +424,10 @@ uint8_t *netbuf_put(netbuf_t *buf, uint32_t len) {
     return old_tail;
 }
 
-netbuf_t *netbuf_clone(netbuf_t *buf) {
-    if (!buf) {
-        return NULL;
-    }
-    
+/**
+ * @brief 深拷贝线性数据（堆缓冲区无法共享时使用）
+ */
+static netbuf_t *netbuf_copy(netbuf_t *buf) {
     netbuf_t *new_buf = netbuf_alloc(buf->len);
     if (!new_buf) {
         return NULL;
@@ -93,9 +438,141 @@ netbuf_t *netbuf_clone(netbuf_t *buf) {
     new_buf->len = buf->len;
     new_buf->dev = buf->dev;
     
+    // 延迟校验和的起点随线性数据一起平移
+    new_buf->csum_flags = buf->csum_flags;
+    new_buf->csum_start = (uint16_t)(buf->csum_start - (buf->data - buf->head) +
+                                     (new_buf->data - new_buf->head));
+    new_buf->csum_offset = buf->csum_offset;
+    new_buf->gso_size = buf->gso_size;
+
+    for (uint8_t i = 0; i < buf->nr_frags; i++) {
+        pmm_frame_ref_inc(buf->frags[i].page);
+        new_buf->frags[i] = buf->frags[i];
+    }
+    new_buf->nr_frags = buf->nr_frags;
+    new_buf->frag_len = buf->frag_len;
+    
+    return new_buf;
+}
+
+netbuf_t *netbuf_clone(netbuf_t *buf) {
+    return netbuf_share(buf);
+}
+
+netbuf_t *netbuf_share(netbuf_t *buf) {
+    if (!buf) {
+        return NULL;
+    }
+    if (!buf->block) {
+        return netbuf_copy(buf);
+    }
+
+    netbuf_t *new_buf = netbuf_desc_alloc();
+    if (!new_buf) {
+        return NULL;
+    }
+
+    *new_buf = *buf;
+    new_buf->next = NULL;
+    atomic_inc_return(&buf->block->refcount);
+    for (uint8_t i = 0; i < buf->nr_frags; i++) {
+        pmm_frame_ref_inc(buf->frags[i].page);
+    }
+
     return new_buf;
 }
 
+bool netbuf_is_shared(netbuf_t *buf) {
+    return buf && buf->block && atomic_read(&buf->block->refcount) > 1;
+}
+
+/**
+ * @brief 把数据区搬到一个至少 min_size 字节的新数据块
+ * 
+ * 数据相对 head 的偏移保持不变，协议头指针随之平移；旧数据块释放一个引用。
+ */
+static int netbuf_move_head(netbuf_t *buf, uint32_t min_size) {
+    /* 借用一个足够大的新缓冲区，只取走其数据区 */
+    uint32_t size = min_size > NETBUF_HEADROOM ? min_size - NETBUF_HEADROOM : 0;
+    netbuf_t *tmp = netbuf_alloc(size);
+    if (!tmp || tmp->total_size < min_size) {
+        netbuf_free(tmp);
+        return -1;
+    }
+
+    uint8_t *old_head = buf->head;
+    uint8_t *new_head = tmp->head;
+    memcpy(new_head, old_head, (uint32_t)(buf->tail - old_head));
+
+    buf->data = new_head + (buf->data - old_head);
+    buf->tail = new_head + (buf->tail - old_head);
+    if (buf->mac_header) {
+        buf->mac_header = new_head + ((uint8_t *)buf->mac_header - old_head);
+    }
+    if (buf->network_header) {
+        buf->network_header = new_head + ((uint8_t *)buf->network_header - old_head);
+    }
+    if (buf->transport_header) {
+        buf->transport_header = new_head + ((uint8_t *)buf->transport_header - old_head);
+    }
+
+    if (buf->block) {
+        netbuf_block_put(buf->block);
+    } else {
+        kfree(old_head);
+    }
+    buf->head = new_head;
+    buf->end = tmp->end;
+    buf->total_size = tmp->total_size;
+    buf->block = tmp->block;
+
+    netbuf_desc_release(tmp);
+    return 0;
+}
+
+int netbuf_unshare(netbuf_t *buf) {
+    if (!netbuf_is_shared(buf)) {
+        return 0;
+    }
+    return netbuf_move_head(buf, buf->total_size);
+}
+
+int netbuf_add_frag(netbuf_t *buf, paddr_t page, uint32_t offset, uint32_t len) {
+    if (!buf || buf->nr_frags >= NETBUF_MAX_FRAGS || len == 0 ||
+        (page & (PAGE_SIZE - 1)) != 0 || offset + len > PAGE_SIZE) {
+        return -1;
+    }
+
+    pmm_frame_ref_inc(page);
+
+    netbuf_frag_t *frag = &buf->frags[buf->nr_frags++];
+    frag->page = page;
+    frag->offset = (uint16_t)offset;
+    frag->len = (uint16_t)len;
+    buf->frag_len += len;
+    return 0;
+}
+
+int netbuf_linearize(netbuf_t *buf) {
+    if (!buf || buf->nr_frags == 0) {
+        return 0;
+    }
+    // tailroom 不足时换到更大的数据块（只挂了协议头的小缓冲区常见），否则只需独占
+    uint32_t need = (uint32_t)(buf->tail - buf->head) + buf->frag_len;
+    int ret = netbuf_tailroom(buf) < buf->frag_len ? netbuf_move_head(buf, need)
+                                                   : netbuf_unshare(buf);
+    if (ret != 0) {
+        return -1;
+    }
+
+    for (uint8_t i = 0; i < buf->nr_frags; i++) {
+        const netbuf_frag_t *frag = &buf->frags[i];
+        memcpy(netbuf_put(buf, frag->len), netbuf_frag_addr(frag), frag->len);
+    }
+    netbuf_drop_frags(buf);
+    return 0;
+}
+
 void netbuf_reset(netbuf_t *buf) {
     if (!buf) {
         return;
@@ -107,6 +584,7 @@ void netbuf_reset(netbuf_t *buf) {
     buf->mac_header = NULL;
     buf->network_header = NULL;
     buf->transport_header = NULL;
+    netbuf_drop_frags(buf);
 }
 
 uint32_t netbuf_headroom(netbuf_t *buf) {
@@ -123,3 +601,37 @@ uint32_t netbuf_tailroom(netbuf_t *buf) {
     return buf->end - buf->tail;
 }
 
+paddr_t netbuf_dma_addr(netbuf_t *buf, const uint8_t *ptr) {
+    if (!buf || !ptr || ptr < buf->head || ptr > buf->end) {
+        return 0;
+    }
+    
+    if (buf->block) {
+        return buf->block->phys + (paddr_t)(ptr - buf->head);
+    }
+    
+    return (paddr_t)vmm_virt_to_phys((uintptr_t)ptr);
+}
+
+int netbuf_checksum_help(netbuf_t *buf) {
+    if (!buf || !(buf->csum_flags & NETBUF_CSUM_PARTIAL)) {
+        return 0;
+    }
+    
+    // 分片边界可能是奇数偏移，先合并到线性区
+    if (buf->nr_frags && netbuf_linearize(buf) < 0) {
+        return -1;
+    }
+    
+    uint8_t *start = buf->head + buf->csum_start;
+    if (start < buf->data || start + buf->csum_offset + 2 > buf->tail ||
+        netbuf_unshare(buf) < 0) {
+        return -1;
+    }
+    start = buf->head + buf->csum_start;
+    
+    uint16_t *field = (uint16_t *)(start + buf->csum_offset);
+    *field = checksum_finish(checksum_partial(0, start, (int)(buf->tail - start)));
+    buf->csum_flags &= ~NETBUF_CSUM_PARTIAL;
+    return 0;
+}
@@ -8,6 +8,7 @@
 #include <lib/string.h>
 #include <lib/klog.h>
 #include <lib/kprintf.h>
+#include <kernel/sync/rwlock.h>
 
 // 已注册的网络设备
 static netdev_t *netdevs[MAX_NETDEV];
@@ -16,6 +17,9 @@ static int netdev_count = 0;
 // 默认网络设备
 static netdev_t *default_netdev = NULL;
 
+// 保护设备表（每个包的路由查找都会读，注册/注销时才写）
+static rwlock_t netdev_list_lock;
+
 // 设备编号计数器（用于自动命名）
 static int eth_dev_num = 0;
 
@@ -24,6 +28,10 @@ void netdev_init(void) {
     netdev_count = 0;
     default_netdev = NULL;
     eth_dev_num = 0;
+    rwlock_init_named(&netdev_list_lock, "netdev_list");
+    
+    // 驱动初始化 RX 环前需要缓冲区池就绪（重复调用无副作用）
+    netbuf_init();
     
     LOG_INFO_MSG("netdev: Network device subsystem initialized\n");
 }
@@ -65,7 +73,11 @@ int netdev_register(netdev_t *dev) {
         return -1;
     }
     
+    bool irq_state;
+    rwlock_write_lock_irqsave(&netdev_list_lock, &irq_state);
+    
     if (netdev_count >= MAX_NETDEV) {
+        rwlock_write_unlock_irqrestore(&netdev_list_lock, irq_state);
         LOG_ERROR_MSG("netdev: Maximum device count reached\n");
         return -1;
     }
@@ -73,6 +85,7 @@ int netdev_register(netdev_t *dev) {
     // 检查是否已注册
     for (int i = 0; i < netdev_count; i++) {
         if (netdevs[i] == dev) {
+            rwlock_write_unlock_irqrestore(&netdev_list_lock, irq_state);
             LOG_WARN_MSG("netdev: Device %s already registered\n", dev->name);
             return -1;
         }
@@ -85,6 +98,8 @@ int netdev_register(netdev_t *dev) {
         default_netdev = dev;
     }
     
+    rwlock_write_unlock_irqrestore(&netdev_list_lock, irq_state);
+    
     LOG_INFO_MSG("netdev: Registered device %s (MAC: %02x:%02x:%02x:%02x:%02x:%02x)\n",
                  dev->name,
                  dev->mac[0], dev->mac[1], dev->mac[2],
@@ -98,6 +113,9 @@ int netdev_unregister(netdev_t *dev) {
         return -1;
     }
     
+    bool irq_state;
+    rwlock_write_lock_irqsave(&netdev_list_lock, &irq_state);
+    
     int found = -1;
     for (int i = 0; i < netdev_count; i++) {
         if (netdevs[i] == dev) {
@@ -107,6 +125,7 @@ int netdev_unregister(netdev_t *dev) {
     }
     
     if (found < 0) {
+        rwlock_write_unlock_irqrestore(&netdev_list_lock, irq_state);
         LOG_WARN_MSG("netdev: Device %s not found\n", dev->name);
         return -1;
     }
@@ -127,6 +146,8 @@ int netdev_unregister(netdev_t *dev) {
         default_netdev = netdevs[0];
     }
     
+    rwlock_write_unlock_irqrestore(&netdev_list_lock, irq_state);
+    
     LOG_INFO_MSG("netdev: Unregistered device %s\n", dev->name);
     
     return 0;
@@ -137,13 +158,19 @@ netdev_t *netdev_get_by_name(const char *name) {
         return NULL;
     }
     
+    netdev_t *found = NULL;
+    bool irq_state;
+    rwlock_read_lock_irqsave(&netdev_list_lock, &irq_state);
+    
     for (int i = 0; i < netdev_count; i++) {
         if (strcmp(netdevs[i]->name, name) == 0) {
-            return netdevs[i];
+            found = netdevs[i];
+            break;
         }
     }
     
-    return NULL;
+    rwlock_read_unlock_irqrestore(&netdev_list_lock, irq_state);
+    return found;
 }
 
 netdev_t *netdev_get_default(void) {
@@ -233,13 +260,34 @@ int netdev_transmit(netdev_t *dev, netbuf_t *buf) {
         return -1;
     }
     
+    // 设备不支持 scatter-gather 时先把分片合并到线性区
+    if (buf->nr_frags && !(dev->features & NETDEV_F_SG) && netbuf_linearize(buf) < 0) {
+        dev->tx_errors++;
+        return -1;
+    }
+    
+    // 设备不支持校验和卸载时由软件补全
+    if ((buf->csum_flags & NETBUF_CSUM_PARTIAL) && !(dev->features & NETDEV_F_HW_CSUM) &&
+        netbuf_checksum_help(buf) < 0) {
+        dev->tx_errors++;
+        return -1;
+    }
+    
+    // 分段只能由网卡完成，协议栈只会向 NETDEV_F_TSO 设备交付超过 MTU 的包
+    if (buf->gso_size && !(dev->features & NETDEV_F_TSO)) {
+        dev->tx_errors++;
+        return -1;
+    }
+    
+    // 成功后 buf 归驱动所有，可能已被释放，因此提前记录长度
+    uint32_t len = netbuf_total_len(buf);
     int ret = dev->ops->transmit(dev, buf);
     
     if (ret < 0) {
         dev->tx_errors++;
     } else {
         dev->tx_packets++;
-        dev->tx_bytes += buf->len;
+        dev->tx_bytes += len;
     }
     
     return ret;
@@ -299,11 +347,15 @@ int netdev_get_all(netdev_t **devs, int max_count) {
         return 0;
     }
     
+    bool irq_state;
+    rwlock_read_lock_irqsave(&netdev_list_lock, &irq_state);
+    
     int count = (netdev_count < max_count) ? netdev_count : max_count;
     for (int i = 0; i < count; i++) {
         devs[i] = netdevs[i];
     }
     
+    rwlock_read_unlock_irqrestore(&netdev_list_lock, irq_state);
     return count;
 }
 
@@ -337,17 +389,24 @@ void netdev_print_info(netdev_t *dev) {
             dev->rx_packets, dev->rx_bytes, dev->rx_errors, dev->rx_dropped);
     kprintf("        TX packets %llu  bytes %llu  errors %llu  dropped %llu\n",
             dev->tx_packets, dev->tx_bytes, dev->tx_errors, dev->tx_dropped);
+    
+    if (dev->ops && dev->ops->print_stats) {
+        dev->ops->print_stats(dev);
+    }
 }
 
 void netdev_print_all(void) {
-    if (netdev_count == 0) {
+    // 先取快照，打印时不持有设备表锁
+    netdev_t *devs[MAX_NETDEV];
+    int count = netdev_get_all(devs, MAX_NETDEV);
+    if (count == 0) {
         kprintf("No network devices registered.\n");
         return;
     }
     
-    for (int i = 0; i < netdev_count; i++) {
-        netdev_print_info(netdevs[i]);
-        if (i < netdev_count - 1) {
+    for (int i = 0; i < count; i++) {
+        netdev_print_info(devs[i]);
+        if (i < count - 1) {
             kprintf("\n");
         }
     }
@@ -13,6 +13,13 @@
 #include <lib/klog.h>
 #include <lib/kprintf.h>
 #include <kernel/sync/spinlock.h>
+#include <kernel/sync/waitqueue.h>
+#include <kernel/task.h>
+#include <kernel/interrupt.h>
+#include <drivers/timer.h>
+#include <fs/poll.h>
+#include <fs/vfs.h>
+#include <kernel/fd_table.h>
 
 // Socket 结构
 typedef struct socket {
@@ -360,6 +367,35 @@ ssize_t sys_send(int sockfd, const void *buf, size_t len, int flags) {
     }
 }
 
+ssize_t socket_sendpage(int sockfd, const uint8_t *data, uint32_t len) {
+    socket_t *sock = socket_get(sockfd);
+    if (!sock || !data || !sock->connected || sock->type != SOCK_STREAM) {
+        return -1;
+    }
+    
+    tcp_pcb_t *pcb = sock->pcb.tcp;
+    if (!pcb) {
+        return -1;
+    }
+    
+    // 每次不超过一个 MSS：tcp_write 每次只发出一个段，多余部分会滞留在发送缓冲区
+    uint32_t total = 0;
+    while (total < len) {
+        uint32_t chunk = len - total;
+        if (chunk > pcb->mss) {
+            chunk = pcb->mss;
+        }
+        
+        int n = tcp_write(pcb, data + total, chunk);
+        if (n <= 0) {
+            break;
+        }
+        total += (uint32_t)n;
+    }
+    
+    return total > 0 ? (ssize_t)total : -1;
+}
+
 ssize_t sys_sendto(int sockfd, const void *buf, size_t len, int flags,
                    const struct sockaddr *dest_addr, socklen_t addrlen) {
     (void)flags;
@@ -643,116 +679,255 @@ int sys_fcntl(int sockfd, int cmd, int arg) {
     }
 }
 
+uint32_t socket_poll(int sockfd, poll_table_t *pt) {
+    socket_t *sock = socket_get(sockfd);
+    if (!sock) {
+        return POLLNVAL;
+    }
+    
+    uint32_t mask = 0;
+    if (sock->error != 0) {
+        mask |= POLLERR;
+    }
+    
+    if (sock->type == SOCK_STREAM) {
+        tcp_pcb_t *pcb = sock->pcb.tcp;
+        if (!pcb) {
+            return mask | POLLHUP;
+        }
+        poll_wait(pt, &pcb->wait);
+        
+        if (sock->listening) {
+            // 监听 socket：有待接受的连接
+            if (pcb->accept_queue != NULL) {
+                mask |= POLLIN;
+            }
+            return mask;
+        }
+        
+        // 已连接 socket：有数据或连接关闭
+        if (pcb->recv_len > 0) {
+            mask |= POLLIN;
+        }
+        if (pcb->state == TCP_CLOSE_WAIT) {
+            mask |= POLLIN | POLLRDHUP;
+        } else if (pcb->state == TCP_CLOSED) {
+            mask |= POLLIN | POLLHUP;
+            // 连接被重置也算异常
+            if (sock->connected) {
+                mask |= POLLERR;
+            }
+        }
+        
+        // 发送窗口有空间
+        if (pcb->state == TCP_ESTABLISHED) {
+            uint32_t in_flight = pcb->snd_nxt - pcb->snd_una;
+            uint32_t effective_window = (pcb->snd_wnd < pcb->cwnd) ? 
+                                        pcb->snd_wnd : pcb->cwnd;
+            if (in_flight < effective_window) {
+                mask |= POLLOUT;
+            }
+        }
+    } else {
+        udp_pcb_t *pcb = sock->pcb.udp;
+        if (!pcb) {
+            return mask | POLLHUP;
+        }
+        poll_wait(pt, &pcb->wait);
+        
+        if (udp_has_data(pcb)) {
+            mask |= POLLIN;
+        }
+        // UDP 总是可写
+        mask |= POLLOUT;
+    }
+    
+    return mask;
+}
+
+#define SELECT_MAX_WAITS    (2 * FD_SETSIZE)
+
+/**
+ * @brief select 等待表：每个被登记的等待队列对应一个等待项
+ *
+ * 登记了等待项的文件节点持有引用，防止等待期间关闭描述符后节点被释放
+ */
+typedef struct select_table {
+    poll_table_t pt;                    // 必须为第一个成员
+    task_t *task;                       // 调用 select 的任务
+    volatile bool triggered;            // 扫描期间是否有事件到达
+    bool overflow;                      // 等待项用完，不能安全阻塞
+    uint32_t count;                     // 已登记的等待项数
+    wait_queue_entry_t entries[SELECT_MAX_WAITS];
+    uint32_t nnodes;
+    fs_node_t *nodes[FD_SETSIZE];
+} select_table_t;
+
+static void select_wake(wait_queue_entry_t *entry, uint32_t key) {
+    (void)key;
+    select_table_t *table = (select_table_t *)entry->data;
+    table->triggered = true;
+    task_wake(table->task, table);
+}
+
+static void select_queue_proc(poll_table_t *pt, wait_queue_t *wq) {
+    select_table_t *table = (select_table_t *)pt;
+    if (table->count >= SELECT_MAX_WAITS) {
+        table->overflow = true;
+        return;
+    }
+    
+    wait_queue_entry_t *entry = &table->entries[table->count++];
+    wait_queue_entry_init_func(entry, select_wake, table);
+    entry->task = table->task;
+    wait_queue_add(wq, entry);
+}
+
+/**
+ * @brief 查询 select 中一个描述符的就绪状态
+ *
+ * socket 描述符优先；不是 socket 时按进程 fd 表中的文件查询（管道、控制台等）。
+ * pt 非 NULL 时登记等待项，文件节点的引用记入等待表。
+ */
+static uint32_t select_poll_fd(int fd, select_table_t *table, poll_table_t *pt) {
+    uint32_t mask = socket_poll(fd, pt);
+    if (!(mask & POLLNVAL)) {
+        return mask;
+    }
+
+    task_t *current = task_get_current();
+    fd_entry_t *entry = current ? fd_table_get(current->fd_table, fd) : NULL;
+    if (!entry || !entry->node) {
+        return POLLNVAL;
+    }
+    fs_node_t *node = entry->node;
+    if (pt) {
+        vfs_ref_node(node);
+        table->nodes[table->nnodes++] = node;
+    }
+    return vfs_poll(node, pt);
+}
+
 int sys_select(int nfds, fd_set *readfds, fd_set *writefds,
                fd_set *exceptfds, struct timeval *timeout) {
     fd_set read_result, write_result, except_result;
-    FD_ZERO(&read_result);
-    FD_ZERO(&write_result);
-    FD_ZERO(&except_result);
     
     // 计算超时时间（毫秒）
     uint32_t timeout_ms;
     if (timeout) {
         timeout_ms = (uint32_t)(timeout->tv_sec * 1000 + timeout->tv_usec / 1000);
     } else {
-        timeout_ms = 0xFFFFFFFF;  // 无限等待
+        timeout_ms = WAIT_FOREVER;  // 无限等待
     }
     
-    // 需要包含 timer.h
-    extern uint64_t timer_get_uptime_ms(void);
-    uint32_t start = (uint32_t)timer_get_uptime_ms();
+    uint64_t deadline = 0;
+    if (timeout_ms != 0 && timeout_ms != WAIT_FOREVER) {
+        deadline = timer_get_uptime_ms() + timeout_ms;
+    }
+    
+    // 需要等待时才建立等待表：第一轮扫描把等待项挂到各 socket 上，
+    // 之后阻塞直到任一 socket 发出事件，不再轮询
+    select_table_t *table = NULL;
+    task_t *current = task_get_current();
+    if (timeout_ms != 0 && current) {
+        table = (select_table_t *)kmalloc(sizeof(select_table_t));
+        if (!table) {
+            LOG_ERROR_MSG("select: Failed to allocate wait table\n");
+            return -1;
+        }
+        table->pt.qproc = select_queue_proc;
+        table->task = current;
+        table->triggered = false;
+        table->overflow = false;
+        table->count = 0;
+        table->nnodes = 0;
+    }
+    poll_table_t *pt = table ? &table->pt : NULL;
     
     int ready_count = 0;
     
     // 限制 nfds 范围
-    if (nfds > MAX_SOCKETS) {
-        nfds = MAX_SOCKETS;
+    if (nfds > FD_SETSIZE) {
+        nfds = FD_SETSIZE;
     }
     
     while (1) {
         ready_count = 0;
+        FD_ZERO(&read_result);
+        FD_ZERO(&write_result);
+        FD_ZERO(&except_result);
+        if (table) {
+            table->triggered = false;
+        }
         
         for (int fd = 0; fd < nfds; fd++) {
-            socket_t *sock = socket_get(fd);
-            if (!sock) continue;
+            bool want_read = readfds && FD_ISSET(fd, readfds);
+            bool want_write = writefds && FD_ISSET(fd, writefds);
+            bool want_except = exceptfds && FD_ISSET(fd, exceptfds);
+            if (!want_read && !want_write && !want_except) {
+                continue;
+            }
+            
+            uint32_t mask = select_poll_fd(fd, table, pt);
+            if (mask & POLLNVAL) {
+                continue;
+            }
             
             // 检查可读
-            if (readfds && FD_ISSET(fd, readfds)) {
-                bool readable = false;
-                
-                if (sock->type == SOCK_STREAM) {
-                    tcp_pcb_t *pcb = sock->pcb.tcp;
-                    
-                    if (sock->listening) {
-                        // 监听 socket：有待接受的连接
-                        readable = (pcb->accept_queue != NULL);
-                    } else {
-                        // 已连接 socket：有数据或连接关闭
-                        readable = (pcb->recv_len > 0) ||
-                                  (pcb->state == TCP_CLOSE_WAIT) ||
-                                  (pcb->state == TCP_CLOSED);
-                    }
-                } else {
-                    // UDP socket：有数据
-                    readable = udp_has_data(sock->pcb.udp);
-                }
-                
-                if (readable) {
-                    FD_SET(fd, &read_result);
-                    ready_count++;
-                }
+            if (want_read && (mask & (POLLIN | POLLHUP | POLLERR))) {
+                FD_SET(fd, &read_result);
+                ready_count++;
             }
             
             // 检查可写
-            if (writefds && FD_ISSET(fd, writefds)) {
-                bool writable = false;
-                
-                if (sock->type == SOCK_STREAM) {
-                    tcp_pcb_t *pcb = sock->pcb.tcp;
-                    // 发送窗口有空间
-                    if (pcb->state == TCP_ESTABLISHED) {
-                        uint32_t in_flight = pcb->snd_nxt - pcb->snd_una;
-                        uint32_t effective_window = (pcb->snd_wnd < pcb->cwnd) ? 
-                                                    pcb->snd_wnd : pcb->cwnd;
-                        writable = (in_flight < effective_window);
-                    }
-                } else {
-                    // UDP 总是可写
-                    writable = true;
-                }
-                
-                if (writable) {
-                    FD_SET(fd, &write_result);
-                    ready_count++;
-                }
+            if (want_write && (mask & (POLLOUT | POLLERR))) {
+                FD_SET(fd, &write_result);
+                ready_count++;
             }
             
             // 检查异常
-            if (exceptfds && FD_ISSET(fd, exceptfds)) {
-                bool has_error = (sock->error != 0);
-                
-                if (sock->type == SOCK_STREAM) {
-                    tcp_pcb_t *pcb = sock->pcb.tcp;
-                    // 连接被重置也算异常
-                    has_error = has_error || (pcb->state == TCP_CLOSED && sock->connected);
-                }
-                
-                if (has_error) {
-                    FD_SET(fd, &except_result);
-                    ready_count++;
-                }
+            if (want_except && (mask & POLLERR)) {
+                FD_SET(fd, &except_result);
+                ready_count++;
             }
         }
         
+        // 只在第一轮登记等待项
+        pt = NULL;
+        
         // 有就绪的描述符，返回
-        if (ready_count > 0) break;
+        if (ready_count > 0 || !table) break;
+        
+        // 部分等待队列没有登记，阻塞可能永远等不到事件
+        if (table->overflow) {
+            LOG_WARN_MSG("select: too many wait queues (max %u)\n", SELECT_MAX_WAITS);
+            ready_count = -1;
+            break;
+        }
         
         // 检查超时
-        uint32_t elapsed = (uint32_t)timer_get_uptime_ms() - start;
-        if (elapsed >= timeout_ms) break;
+        if (deadline && timer_get_uptime_ms() >= deadline) break;
         
-        // 让出 CPU（简单忙等待，实际应该使用调度器）
-        // 这里可以调用 task_yield() 但为了简单起见先忙等
+        // 扫描期间没有事件到达才阻塞，否则立即重新扫描
+        bool irq_state = interrupts_disable();
+        if (!table->triggered) {
+            task_block_until(table, deadline);
+        }
+        interrupts_restore(irq_state);
+    }
+    
+    if (table) {
+        for (uint32_t i = 0; i < table->count; i++) {
+            wait_queue_remove(&table->entries[i]);
+        }
+        for (uint32_t i = 0; i < table->nnodes; i++) {
+            vfs_release_node(table->nodes[i]);
+        }
+        kfree(table);
+    }
+    
+    if (ready_count < 0) {
+        return -1;
     }
     
     // 复制结果
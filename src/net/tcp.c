@@ -9,11 +9,13 @@
 #include <net/netbuf.h>
 #include <net/checksum.h>
 #include <mm/heap.h>
+#include <mm/pmm.h>
 #include <lib/string.h>
 #include <lib/klog.h>
 #include <lib/kprintf.h>
 #include <drivers/timer.h>
 #include <kernel/sync/spinlock.h>
+#include <fs/poll.h>
 
 // TCP PCB 链表
 static tcp_pcb_t *tcp_pcbs = NULL;          // 活动连接
@@ -34,6 +36,8 @@ static uint32_t tcp_isn = 0;
 
 // 前向声明
 static int tcp_send_segment(tcp_pcb_t *pcb, uint8_t flags, uint8_t *data, uint32_t len);
+static int tcp_output_segment(tcp_pcb_t *pcb, uint32_t seq, uint8_t flags,
+                              paddr_t page, uint32_t len);
 static void tcp_free_unacked(tcp_pcb_t *pcb);
 static void tcp_free_ooseq(tcp_pcb_t *pcb);
 
@@ -87,15 +91,21 @@ static void tcp_update_rtt(tcp_pcb_t *pcb, uint32_t measured_rtt) {
 
 /**
  * @brief 将段加入未确认队列
+ * 
+ * 接管调用者对 page 的引用（失败时也会归还）。
  */
 static int tcp_queue_unacked(tcp_pcb_t *pcb, uint32_t seq, uint8_t flags, 
-                             uint8_t *data, uint32_t data_len) {
+                             paddr_t page, uint32_t data_len) {
     tcp_segment_t *seg = (tcp_segment_t *)kmalloc(sizeof(tcp_segment_t));
-    if (!seg) return -1;
+    if (!seg) {
+        if (page) pmm_free_frame(page);
+        return -1;
+    }
     
     memset(seg, 0, sizeof(tcp_segment_t));
     seg->seq = seq;
     seg->flags = flags;
+    seg->page = page;
     seg->data_len = data_len;
     
     // 计算段长度（SYN 和 FIN 各占 1 个序列号）
@@ -103,16 +113,6 @@ static int tcp_queue_unacked(tcp_pcb_t *pcb, uint32_t seq, uint8_t flags,
     if (flags & TCP_FLAG_SYN) seg->len++;
     if (flags & TCP_FLAG_FIN) seg->len++;
     
-    // 复制数据
-    if (data_len > 0 && data) {
-        seg->data = (uint8_t *)kmalloc(data_len);
-        if (!seg->data) {
-            kfree(seg);
-            return -1;
-        }
-        memcpy(seg->data, data, data_len);
-    }
-    
     seg->send_time = (uint32_t)timer_get_uptime_ms();
     seg->retransmit_time = seg->send_time + pcb->rto;
     seg->retries = 0;
@@ -164,7 +164,7 @@ static void tcp_ack_received(tcp_pcb_t *pcb, uint32_t ack) {
             
             // 从队列移除
             pcb->unacked = seg->next;
-            if (seg->data) kfree(seg->data);
+            if (seg->page) pmm_free_frame(seg->page);
             kfree(seg);
             
             // 拥塞控制：ACK 确认时增加 cwnd
@@ -210,7 +210,7 @@ static void tcp_dup_ack(tcp_pcb_t *pcb) {
         
         // 重传丢失的段
         LOG_DEBUG_MSG("tcp: Fast retransmit seq=%u\n", seg->seq);
-        tcp_send_segment(pcb, seg->flags | TCP_FLAG_ACK, seg->data, seg->data_len);
+        tcp_output_segment(pcb, seg->seq, seg->flags | TCP_FLAG_ACK, seg->page, seg->data_len);
         
         seg->retries++;
         seg->retransmit_time = (uint32_t)timer_get_uptime_ms() + pcb->rto;
@@ -224,7 +224,7 @@ static void tcp_free_unacked(tcp_pcb_t *pcb) {
     tcp_segment_t *seg = pcb->unacked;
     while (seg) {
         tcp_segment_t *next = seg->next;
-        if (seg->data) kfree(seg->data);
+        if (seg->page) pmm_free_frame(seg->page);
         kfree(seg);
         seg = next;
     }
@@ -391,33 +391,29 @@ static tcp_pcb_t *tcp_find_pcb(uint32_t local_ip, uint16_t local_port,
 }
 
 /**
- * @brief 发送 TCP 段
+ * @brief 构造并发送一个 TCP 段
+ * 
+ * 线性区只放 TCP 头，载荷所在的页以分片方式挂载，不再复制到缓冲区；
+ * 首次发送与重传共用同一页。不修改 snd_nxt，也不加入未确认队列。
  */
-static int tcp_send_segment(tcp_pcb_t *pcb, uint8_t flags, uint8_t *data, uint32_t len) {
+static int tcp_output_segment(tcp_pcb_t *pcb, uint32_t seq, uint8_t flags,
+                              paddr_t page, uint32_t len) {
     netdev_t *dev = netdev_get_default();
     if (!dev) {
         return -1;
     }
     
-    // 计算 TCP 长度
-    uint32_t tcp_len = TCP_HEADER_MIN_LEN + len;
-    
-    // 分配缓冲区
-    netbuf_t *buf = netbuf_alloc(tcp_len);
+    netbuf_t *buf = netbuf_alloc(TCP_HEADER_MIN_LEN);
     if (!buf) {
         return -1;
     }
     
-    // 保存当前序列号（用于加入未确认队列）
-    uint32_t seq = pcb->snd_nxt;
-    
-    // 填充 TCP 段
-    uint8_t *pkt = netbuf_put(buf, tcp_len);
-    tcp_header_t *tcp = (tcp_header_t *)pkt;
+    // 填充 TCP 头
+    tcp_header_t *tcp = (tcp_header_t *)netbuf_put(buf, TCP_HEADER_MIN_LEN);
     
     tcp->src_port = htons(pcb->local_port);
     tcp->dst_port = htons(pcb->remote_port);
-    tcp->seq_num = htonl(pcb->snd_nxt);
+    tcp->seq_num = htonl(seq);
     tcp->ack_num = htonl(pcb->rcv_nxt);
     tcp->data_offset = (TCP_HEADER_MIN_LEN / 4) << 4;
     tcp->flags = flags;
@@ -425,14 +421,45 @@ static int tcp_send_segment(tcp_pcb_t *pcb, uint8_t flags, uint8_t *data, uint32
     tcp->checksum = 0;
     tcp->urgent_ptr = 0;
     
-    // 复制数据
-    if (data && len > 0) {
-        memcpy(pkt + TCP_HEADER_MIN_LEN, data, len);
+    if (page && len > 0 && netbuf_add_frag(buf, page, 0, len) < 0) {
+        netbuf_free(buf);
+        return -1;
     }
     
-    // 计算校验和
+    // 计算校验和（延迟到网卡或 netdev_transmit 完成，覆盖分片中的载荷）
+    uint32_t tcp_len = TCP_HEADER_MIN_LEN + len;
     uint32_t src_ip = (pcb->local_ip != 0) ? pcb->local_ip : dev->ip_addr;
-    tcp->checksum = tcp_checksum(src_ip, pcb->remote_ip, tcp, tcp_len);
+    checksum_l4_partial(buf, tcp, offsetof(tcp_header_t, checksum), src_ip, pcb->remote_ip,
+                        IP_PROTO_TCP, tcp_len);
+    
+    int ret = ip_output(dev, buf, pcb->remote_ip, IP_PROTO_TCP);
+    if (ret < 0) {
+        netbuf_free(buf);
+    }
+    return ret;
+}
+
+/**
+ * @brief 发送 TCP 段
+ */
+static int tcp_send_segment(tcp_pcb_t *pcb, uint8_t flags, uint8_t *data, uint32_t len) {
+    // 载荷只复制一次到独立的页：发送时作为分片挂载，同一页留作重传副本
+    paddr_t page = 0;
+    if (data && len > 0) {
+        if (len > PAGE_SIZE) {
+            return -1;
+        }
+        page = pmm_alloc_frame();
+        if (page == PADDR_INVALID) {
+            return -1;
+        }
+        memcpy((uint8_t *)PHYS_TO_VIRT((uintptr_t)page), data, len);
+    } else {
+        len = 0;
+    }
+    
+    // 保存当前序列号（用于加入未确认队列）
+    uint32_t seq = pcb->snd_nxt;
     
     // 更新发送序列号
     if (flags & TCP_FLAG_SYN) {
@@ -447,16 +474,18 @@ static int tcp_send_segment(tcp_pcb_t *pcb, uint8_t flags, uint8_t *data, uint32
     pcb->last_send_time = (uint32_t)timer_get_uptime_ms();
     
     // 发送
-    int ret = ip_output(dev, buf, pcb->remote_ip, IP_PROTO_TCP);
+    int ret = tcp_output_segment(pcb, seq, flags, page, len);
     if (ret < 0) {
-        netbuf_free(buf);
+        if (page) pmm_free_frame(page);
         return ret;
     }
     
-    // 将需要确认的段加入未确认队列（SYN、FIN 或带数据的段）
+    // 将需要确认的段加入未确认队列（SYN、FIN 或带数据的段），页引用随之转交
     bool needs_ack = (flags & TCP_FLAG_SYN) || (flags & TCP_FLAG_FIN) || (len > 0);
     if (needs_ack && pcb->state != TCP_LISTEN) {
-        tcp_queue_unacked(pcb, seq, flags, data, len);
+        tcp_queue_unacked(pcb, seq, flags, page, len);
+    } else if (page) {
+        pmm_free_frame(page);
     }
     
     return ret;
@@ -493,8 +522,8 @@ static void tcp_send_rst(uint32_t src_ip, uint32_t dst_ip,
     tcp->checksum = 0;
     tcp->urgent_ptr = 0;
     
-    // 计算校验和
-    tcp->checksum = tcp_checksum(src_ip, dst_ip, tcp, TCP_HEADER_MIN_LEN);
+    // 计算校验和（延迟到网卡或 netdev_transmit 完成）
+    checksum_l4_partial(buf, tcp, offsetof(tcp_header_t, checksum), src_ip, dst_ip, IP_PROTO_TCP, TCP_HEADER_MIN_LEN);
     
     // 发送
     int ret = ip_output(dev, buf, dst_ip, IP_PROTO_TCP);
@@ -536,17 +565,19 @@ void tcp_input(netdev_t *dev, netbuf_t *buf, uint32_t src_ip, uint32_t dst_ip) {
         return;
     }
     
-    // 验证校验和
-    uint16_t orig_checksum = tcp->checksum;
-    tcp->checksum = 0;
-    uint16_t calc_checksum = tcp_checksum(src_ip, dst_ip, tcp, buf->len);
-    
-    if (calc_checksum != orig_checksum) {
-        LOG_WARN_MSG("tcp: Invalid checksum\n");
-        netbuf_free(buf);
-        return;
+    // 验证校验和（网卡已验证时跳过）
+    if (!(buf->csum_flags & NETBUF_CSUM_L4_VALID)) {
+        uint16_t orig_checksum = tcp->checksum;
+        tcp->checksum = 0;
+        uint16_t calc_checksum = tcp_checksum(src_ip, dst_ip, tcp, buf->len);
+        
+        if (calc_checksum != orig_checksum) {
+            LOG_WARN_MSG("tcp: Invalid checksum\n");
+            netbuf_free(buf);
+            return;
+        }
+        tcp->checksum = orig_checksum;
     }
-    tcp->checksum = orig_checksum;
     
     // 解析字段
     uint16_t src_port = ntohs(tcp->src_port);
@@ -650,6 +681,7 @@ void tcp_input(netdev_t *dev, netbuf_t *buf, uint32_t src_ip, uint32_t dst_ip) {
             if (flags & TCP_FLAG_RST) {
                 if (flags & TCP_FLAG_ACK) {
                     pcb->state = TCP_CLOSED;
+                    wait_queue_wake(&pcb->wait, POLLERR | POLLHUP);
                     if (pcb->error_callback) {
                         spinlock_unlock_irqrestore(&tcp_lock, irq_state);
                         pcb->error_callback(pcb, -1, pcb->callback_arg);
@@ -671,6 +703,8 @@ void tcp_input(netdev_t *dev, netbuf_t *buf, uint32_t src_ip, uint32_t dst_ip) {
                     pcb->state = TCP_ESTABLISHED;
                     spinlock_unlock_irqrestore(&tcp_lock, irq_state);
                     
+                    wait_queue_wake(&pcb->wait, POLLOUT);
+                    
                     // 发送 ACK
                     tcp_send_segment(pcb, TCP_FLAG_ACK, NULL, 0);
                     
@@ -693,6 +727,7 @@ void tcp_input(netdev_t *dev, netbuf_t *buf, uint32_t src_ip, uint32_t dst_ip) {
         case TCP_SYN_RECEIVED: {
             if (flags & TCP_FLAG_RST) {
                 pcb->state = TCP_CLOSED;
+                wait_queue_wake(&pcb->wait, POLLERR | POLLHUP);
                 break;
             }
             if (flags & TCP_FLAG_ACK) {
@@ -719,6 +754,9 @@ void tcp_input(netdev_t *dev, netbuf_t *buf, uint32_t src_ip, uint32_t dst_ip) {
                         listen->accept_queue = pcb;
                         pcb->listen_pcb = NULL;
                         
+                        // 监听 socket 变为可读
+                        wait_queue_wake(&listen->wait, POLLIN);
+                        
                         // 调用回调
                         if (listen->accept_callback) {
                             spinlock_unlock_irqrestore(&tcp_lock, irq_state);
@@ -741,6 +779,7 @@ void tcp_input(netdev_t *dev, netbuf_t *buf, uint32_t src_ip, uint32_t dst_ip) {
                 pcb->state = TCP_CLOSED;
                 tcp_free_unacked(pcb);
                 tcp_free_ooseq(pcb);
+                wait_queue_wake(&pcb->wait, POLLERR | POLLHUP);
                 if (pcb->error_callback) {
                     spinlock_unlock_irqrestore(&tcp_lock, irq_state);
                     pcb->error_callback(pcb, -1, pcb->callback_arg);
@@ -756,6 +795,9 @@ void tcp_input(netdev_t *dev, netbuf_t *buf, uint32_t src_ip, uint32_t dst_ip) {
                     // 新的 ACK，处理确认
                     pcb->snd_una = ack;
                     tcp_ack_received(pcb, ack);
+                    
+                    // 发送窗口腾出空间
+                    wait_queue_wake(&pcb->wait, POLLOUT);
                 } else if (ack == pcb->snd_una && pcb->unacked) {
                     // 重复 ACK，可能需要快速重传
                     tcp_dup_ack(pcb);
@@ -784,6 +826,8 @@ void tcp_input(netdev_t *dev, netbuf_t *buf, uint32_t src_ip, uint32_t dst_ip) {
                         pcb->recv_callback(pcb, pcb->callback_arg);
                     }
                     
+                    wait_queue_wake(&pcb->wait, POLLIN);
+                    
                     netbuf_free(buf);
                     return;
                 } else if (TCP_SEQ_GT(seq, pcb->rcv_nxt)) {
@@ -818,6 +862,9 @@ void tcp_input(netdev_t *dev, netbuf_t *buf, uint32_t src_ip, uint32_t dst_ip) {
                 
                 spinlock_unlock_irqrestore(&tcp_lock, irq_state);
                 
+                // 对端关闭写方向：读端将读到 EOF
+                wait_queue_wake(&pcb->wait, POLLIN | POLLRDHUP);
+                
                 // 发送 ACK
                 tcp_send_segment(pcb, TCP_FLAG_ACK, NULL, 0);
                 
@@ -840,6 +887,7 @@ void tcp_input(netdev_t *dev, netbuf_t *buf, uint32_t src_ip, uint32_t dst_ip) {
             if (flags & TCP_FLAG_ACK) {
                 if (ack == pcb->snd_nxt) {
                     pcb->state = TCP_CLOSED;
+                    wait_queue_wake(&pcb->wait, POLLHUP);
                 }
             }
             break;
@@ -884,7 +932,8 @@ tcp_pcb_t *tcp_pcb_new(void) {
         return NULL;
     }
     
-    mutex_init(&pcb->lock);
+    mutex_init_named(&pcb->lock, "tcp_pcb");
+    wait_queue_init(&pcb->wait);
     
     // 添加到活动链表
     bool irq_state;
@@ -924,6 +973,9 @@ void tcp_pcb_free(tcp_pcb_t *pcb) {
     
     spinlock_unlock_irqrestore(&tcp_lock, irq_state);
     
+    // 摘除仍在等待的 select/epoll
+    wait_queue_detach_all(&pcb->wait, POLLFREE);
+    
     // 释放未确认队列
     tcp_free_unacked(pcb);
     
@@ -1163,6 +1215,7 @@ void tcp_abort(tcp_pcb_t *pcb) {
     }
     
     pcb->state = TCP_CLOSED;
+    wait_queue_wake(&pcb->wait, POLLHUP);
 }
 
 void tcp_accept_callback(tcp_pcb_t *pcb,
@@ -1351,6 +1404,7 @@ void tcp_timer(void) {
                     pcb->state = TCP_CLOSED;
                     tcp_free_unacked(pcb);
                     tcp_free_ooseq(pcb);
+                    wait_queue_wake(&pcb->wait, POLLERR | POLLHUP);
                     
                     if (pcb->error_callback) {
                         spinlock_unlock_irqrestore(&tcp_lock, irq_state);
@@ -1366,37 +1420,8 @@ void tcp_timer(void) {
                     spinlock_unlock_irqrestore(&tcp_lock, irq_state);
                     
                     // 重新发送段（不通过 tcp_send_segment 以避免再次加入队列）
-                    netdev_t *dev = netdev_get_default();
-                    if (dev) {
-                        uint32_t tcp_len = TCP_HEADER_MIN_LEN + seg->data_len;
-                        netbuf_t *buf = netbuf_alloc(tcp_len);
-                        if (buf) {
-                            uint8_t *pkt = netbuf_put(buf, tcp_len);
-                            tcp_header_t *tcp = (tcp_header_t *)pkt;
-                            
-                            tcp->src_port = htons(pcb->local_port);
-                            tcp->dst_port = htons(pcb->remote_port);
-                            tcp->seq_num = htonl(seg->seq);
-                            tcp->ack_num = htonl(pcb->rcv_nxt);
-                            tcp->data_offset = (TCP_HEADER_MIN_LEN / 4) << 4;
-                            tcp->flags = seg->flags | TCP_FLAG_ACK;
-                            tcp->window = htons(pcb->rcv_wnd);
-                            tcp->checksum = 0;
-                            tcp->urgent_ptr = 0;
-                            
-                            if (seg->data && seg->data_len > 0) {
-                                memcpy(pkt + TCP_HEADER_MIN_LEN, seg->data, seg->data_len);
-                            }
-                            
-                            uint32_t src_ip = (pcb->local_ip != 0) ? pcb->local_ip : dev->ip_addr;
-                            tcp->checksum = tcp_checksum(src_ip, pcb->remote_ip, tcp, tcp_len);
-                            
-                            int ret = ip_output(dev, buf, pcb->remote_ip, IP_PROTO_TCP);
-                            if (ret < 0) {
-                                netbuf_free(buf);
-                            }
-                        }
-                    }
+                    tcp_output_segment(pcb, seg->seq, seg->flags | TCP_FLAG_ACK,
+                                       seg->page, seg->data_len);
                     
                     spinlock_lock_irqsave(&tcp_lock, &irq_state);
                     
@@ -1427,6 +1452,7 @@ void tcp_timer(void) {
                           pcb->local_port);
             pcb->state = TCP_CLOSED;
             pcb->timer_time_wait = 0;
+            wait_queue_wake(&pcb->wait, POLLHUP);
         }
         
         pcb = next;
@@ -14,6 +14,7 @@
 #include <lib/klog.h>
 #include <lib/kprintf.h>
 #include <kernel/sync/spinlock.h>
+#include <fs/poll.h>
 
 // UDP PCB 链表
 static udp_pcb_t *udp_pcbs = NULL;
@@ -109,8 +110,8 @@ void udp_input(netdev_t *dev, netbuf_t *buf, uint32_t src_ip, uint32_t dst_ip) {
         return;
     }
     
-    // 验证校验和（如果非零）
-    if (udp->checksum != 0) {
+    // 验证校验和（如果非零且网卡未验证）
+    if (udp->checksum != 0 && !(buf->csum_flags & NETBUF_CSUM_L4_VALID)) {
         uint16_t orig_checksum = udp->checksum;
         udp->checksum = 0;
         uint16_t calc_checksum = udp_checksum(src_ip, dst_ip, udp, udp_len);
@@ -158,6 +159,8 @@ void udp_input(netdev_t *dev, netbuf_t *buf, uint32_t src_ip, uint32_t dst_ip) {
         pcb->recv_queue_len++;
         
         spinlock_unlock_irqrestore(&udp_lock, irq_state);
+        
+        wait_queue_wake(&pcb->wait, POLLIN);
         return;
     }
     
@@ -205,8 +208,8 @@ int udp_output(uint16_t src_port, uint32_t dst_ip, uint16_t dst_port,
         memcpy(pkt + UDP_HEADER_LEN, data, len);
     }
     
-    // 计算校验和
-    udp->checksum = udp_checksum(dev->ip_addr, dst_ip, udp, udp_len);
+    // 计算校验和（延迟到网卡或 netdev_transmit 完成）
+    checksum_l4_partial(buf, udp, offsetof(udp_header_t, checksum), dev->ip_addr, dst_ip, IP_PROTO_UDP, udp_len);
     
     // 发送
     int ret = ip_output(dev, buf, dst_ip, IP_PROTO_UDP);
@@ -224,6 +227,7 @@ udp_pcb_t *udp_pcb_new(void) {
     }
     
     memset(pcb, 0, sizeof(udp_pcb_t));
+    wait_queue_init(&pcb->wait);
     
     // 添加到链表
     bool irq_state;
@@ -258,6 +262,9 @@ void udp_pcb_free(udp_pcb_t *pcb) {
     
     spinlock_unlock_irqrestore(&udp_lock, irq_state);
     
+    // 摘除仍在等待的 select/epoll
+    wait_queue_detach_all(&pcb->wait, POLLFREE);
+    
     // 释放接收队列
     netbuf_t *buf = pcb->recv_queue;
     while (buf) {
@@ -364,9 +371,9 @@ int udp_sendto(udp_pcb_t *pcb, netbuf_t *buf, uint32_t dst_ip, uint16_t dst_port
     udp->length = htons(udp_len);
     udp->checksum = 0;
     
-    // 计算校验和
+    // 计算校验和（延迟到网卡或 netdev_transmit 完成）
     uint32_t src_ip = (pcb->local_ip != 0) ? pcb->local_ip : dev->ip_addr;
-    udp->checksum = udp_checksum(src_ip, dst_ip, udp, udp_len);
+    checksum_l4_partial(buf, udp, offsetof(udp_header_t, checksum), src_ip, dst_ip, IP_PROTO_UDP, udp_len);
     
     // 发送
     return ip_output(dev, buf, dst_ip, IP_PROTO_UDP);
@@ -0,0 +1,112 @@
+// ============================================================================
+// e1000_test.c - E1000 驱动测试模块
+// ============================================================================
+//
+// 只测试不依赖硬件的纯函数，没有 E1000 网卡时同样运行
+//
+// 测试覆盖:
+//   - e1000_clamp_ring_size()：限制到 [E1000_MIN_DESC, E1000_MAX_DESC] 并对齐到 8
+//   - e1000_itr_select()：按包速率在三个节流档位间切换的边界
+// ============================================================================
+
+#include <tests/ktest.h>
+#include <tests/drivers/e1000_test.h>
+#include <tests/test_module.h>
+#include <drivers/e1000.h>
+#include <lib/kprintf.h>
+
+// ============================================================================
+// 测试用例：环大小
+// ============================================================================
+
+TEST_CASE(test_e1000_ring_size_in_range) {
+    ASSERT_EQ_UINT(E1000_DEFAULT_RX_DESC, e1000_clamp_ring_size(E1000_DEFAULT_RX_DESC));
+    ASSERT_EQ_UINT(E1000_MIN_DESC, e1000_clamp_ring_size(E1000_MIN_DESC));
+    ASSERT_EQ_UINT(E1000_MAX_DESC, e1000_clamp_ring_size(E1000_MAX_DESC));
+    ASSERT_EQ_UINT(1024, e1000_clamp_ring_size(1024));
+}
+
+TEST_CASE(test_e1000_ring_size_clamped) {
+    ASSERT_EQ_UINT(E1000_MIN_DESC, e1000_clamp_ring_size(0));
+    ASSERT_EQ_UINT(E1000_MIN_DESC, e1000_clamp_ring_size(E1000_MIN_DESC - 1));
+    ASSERT_EQ_UINT(E1000_MAX_DESC, e1000_clamp_ring_size(E1000_MAX_DESC + 1));
+    ASSERT_EQ_UINT(E1000_MAX_DESC, e1000_clamp_ring_size(0xFFFFFFFFu));
+}
+
+TEST_CASE(test_e1000_ring_size_rounded) {
+    // 向下对齐到 8，RDLEN/TDLEN 保持 128 字节的倍数
+    ASSERT_EQ_UINT(96, e1000_clamp_ring_size(100));
+    ASSERT_EQ_UINT(256, e1000_clamp_ring_size(263));
+    ASSERT_EQ_UINT(E1000_MAX_DESC - 8, e1000_clamp_ring_size(E1000_MAX_DESC - 1));
+    
+    for (uint32_t n = 0; n <= E1000_MAX_DESC + 16; n += 13) {
+        uint32_t size = e1000_clamp_ring_size(n);
+        ASSERT_EQ_UINT(0, size % 8);
+        ASSERT_TRUE(size >= E1000_MIN_DESC && size <= E1000_MAX_DESC);
+    }
+}
+
+// ============================================================================
+// 测试用例：中断节流档位
+// ============================================================================
+
+TEST_CASE(test_e1000_itr_low_rate) {
+    ASSERT_EQ(E1000_ITR_LOWEST_LATENCY, e1000_itr_select(0));
+    ASSERT_EQ(E1000_ITR_LOWEST_LATENCY, e1000_itr_select(E1000_ITR_LOW_PPS - 1));
+}
+
+TEST_CASE(test_e1000_itr_mid_rate) {
+    ASSERT_EQ(E1000_ITR_LOW_LATENCY, e1000_itr_select(E1000_ITR_LOW_PPS));
+    ASSERT_EQ(E1000_ITR_LOW_LATENCY, e1000_itr_select(E1000_ITR_BULK_PPS - 1));
+}
+
+TEST_CASE(test_e1000_itr_high_rate) {
+    ASSERT_EQ(E1000_ITR_BULK, e1000_itr_select(E1000_ITR_BULK_PPS));
+    ASSERT_EQ(E1000_ITR_BULK, e1000_itr_select(0xFFFFFFFFu));
+}
+
+TEST_CASE(test_e1000_itr_values) {
+    // ITR 单位 256ns：档位的中断频率上限换算
+    ASSERT_EQ_UINT(195, E1000_ITR_VAL(20000));
+    ASSERT_EQ_UINT(976, E1000_ITR_VAL(4000));
+}
+
+// ============================================================================
+// 测试套件定义
+// ============================================================================
+
+TEST_SUITE(e1000_ring_tests) {
+    RUN_TEST(test_e1000_ring_size_in_range);
+    RUN_TEST(test_e1000_ring_size_clamped);
+    RUN_TEST(test_e1000_ring_size_rounded);
+}
+
+TEST_SUITE(e1000_itr_tests) {
+    RUN_TEST(test_e1000_itr_low_rate);
+    RUN_TEST(test_e1000_itr_mid_rate);
+    RUN_TEST(test_e1000_itr_high_rate);
+    RUN_TEST(test_e1000_itr_values);
+}
+
+// ============================================================================
+// 运行所有测试
+// ============================================================================
+
+void run_e1000_tests(void) {
+    // 初始化测试框架
+    unittest_init();
+
+    // 运行所有测试套件
+    RUN_SUITE(e1000_ring_tests);
+    RUN_SUITE(e1000_itr_tests);
+
+    // 打印测试摘要
+    unittest_print_summary();
+}
+
+// ============================================================================
+// 模块注册
+// ============================================================================
+
+TEST_MODULE_DESC(e1000, DRIVERS, run_e1000_tests,
+    "E1000 ring size clamping and adaptive ITR profile selection");
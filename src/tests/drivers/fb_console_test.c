@@ -0,0 +1,212 @@
+// ============================================================================
+// fb_console_test.c - 帧缓冲控制台测试模块
+// ============================================================================
+//
+// 没有图形帧缓冲（文本模式启动）时跳过；基准测试会冲掉当前屏幕内容
+//
+// 测试覆盖:
+//   - 字形行缓存绘制的像素与字体位图一致
+//   - 环形滚屏后内容上移一行，底部为背景色
+//   - 刷新只复制脏矩形
+//   - 连续输出的耗时、行/秒与缓存、刷新统计（默认 2000 行，make bench 为 100k 行）
+// ============================================================================
+
+#include <tests/ktest.h>
+#include <tests/drivers/fb_console_test.h>
+#include <tests/test_module.h>
+#include <drivers/framebuffer.h>
+#include <drivers/font8x16.h>
+#include <drivers/timer.h>
+#include <lib/kprintf.h>
+#include <lib/string.h>
+
+#define FB_BENCH_LINES          KTEST_BENCH_SIZE(100000, 2000)
+#define FB_BENCH_BATCH          50          // 每次 fb_terminal_write 的行数
+
+// ============================================================================
+// 测试辅助函数
+// ============================================================================
+
+static bool fb_test_ready(void) {
+    if (!fb_is_initialized()) {
+        kprintf("    no framebuffer console, skipped\n");
+        return false;
+    }
+    return true;
+}
+
+static bool fb_color_eq(color_t a, color_t b) {
+    return a.r == b.r && a.g == b.g && a.b == b.b;
+}
+
+/* 写入再读回，得到颜色在当前像素格式下的实际值 */
+static color_t fb_test_readback(int x, int y, color_t c) {
+    fb_put_pixel(x, y, c);
+    return fb_get_pixel(x, y);
+}
+
+/* 检查 (x, y) 处的字符单元是否按字体位图显示为 fg/bg */
+static bool fb_cell_matches(int x, int y, char c, color_t fg, color_t bg) {
+    const uint8_t *glyph = font8x16_data + (unsigned char)c * 16;
+    for (int row = 0; row < 16; row++) {
+        for (int col = 0; col < 8; col++) {
+            color_t want = (glyph[row] & (0x80 >> col)) ? fg : bg;
+            if (!fb_color_eq(fb_get_pixel(x + col, y + row), want)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// ============================================================================
+// 测试用例
+// ============================================================================
+
+TEST_CASE(test_fb_glyph_cache_pixels) {
+    if (!fb_test_ready()) {
+        return;
+    }
+
+    int y = (fb_get_rows() - 1) * 16;
+    color_t fg = fb_test_readback(8, y, COLOR_YELLOW);
+    color_t bg = fb_test_readback(8, y, COLOR_BLUE);
+
+    fb_console_stats_t before, after;
+    fb_get_stats(&before);
+    fb_draw_char(0, y, 'A', COLOR_YELLOW, COLOR_BLUE);
+    fb_draw_char(8, y, 'g', COLOR_YELLOW, COLOR_BLUE);
+    fb_get_stats(&after);
+    fb_flush();
+
+    ASSERT_TRUE(fb_cell_matches(0, y, 'A', fg, bg));
+    ASSERT_TRUE(fb_cell_matches(8, y, 'g', fg, bg));
+    // 同一颜色对的第二个字符一定命中
+    ASSERT_TRUE(after.glyph_hits > before.glyph_hits);
+}
+
+TEST_CASE(test_fb_scroll_ring) {
+    if (!fb_test_ready()) {
+        return;
+    }
+
+    int rows = fb_get_rows();
+    int y = (rows - 1) * 16;
+    color_t fg = fb_test_readback(0, y, COLOR_WHITE);
+    color_t bg = fb_test_readback(0, y, COLOR_RED);
+
+    fb_console_stats_t before, after;
+    fb_get_stats(&before);
+    fb_draw_char(0, y, 'X', COLOR_WHITE, COLOR_RED);
+    fb_terminal_scroll(1);
+    fb_get_stats(&after);
+    fb_flush();
+
+    ASSERT_EQ_UINT(before.scrolls + 1, after.scrolls);
+    ASSERT_TRUE(fb_cell_matches(0, y - 16, 'X', fg, bg));
+
+    // 新露出的底行整行是同一种背景色
+    color_t blank = fb_get_pixel(0, y);
+    bool uniform = true;
+    for (int row = 0; row < 16 && uniform; row++) {
+        for (int x = 0; x < fb_get_cols() * 8; x++) {
+            if (!fb_color_eq(fb_get_pixel(x, y + row), blank)) {
+                uniform = false;
+                break;
+            }
+        }
+    }
+    ASSERT_TRUE(uniform);
+}
+
+TEST_CASE(test_fb_dirty_rect_flush) {
+    if (!fb_test_ready() || !fb_set_double_buffer(true)) {
+        return;
+    }
+
+    framebuffer_info_t *info = fb_get_info();
+    fb_flush();
+
+    fb_console_stats_t before, after;
+    fb_get_stats(&before);
+    fb_draw_char(16, 16, 'Z', COLOR_GREEN, COLOR_BLACK);
+    fb_draw_char(24, 16, 'Z', COLOR_GREEN, COLOR_BLACK);
+    fb_flush();
+    fb_get_stats(&after);
+
+    // 两个相邻字符合并为一个 16x16 的矩形，只复制这部分
+    ASSERT_EQ_UINT(before.flushes + 1, after.flushes);
+    ASSERT_EQ_UINT(16 * 16 * (info->bpp / 8), (uint32_t)(after.flush_bytes - before.flush_bytes));
+}
+
+TEST_CASE(test_fb_console_bench) {
+    if (!fb_test_ready()) {
+        return;
+    }
+
+    static char batch[FB_BENCH_BATCH * 64];
+    fb_console_stats_t before, after;
+    fb_get_stats(&before);
+
+    uint64_t t0 = timer_get_uptime_ms();
+    for (uint32_t line = 0; line < FB_BENCH_LINES; line += FB_BENCH_BATCH) {
+        int len = 0;
+        for (uint32_t i = 0; i < FB_BENCH_BATCH; i++) {
+            len += ksnprintf(batch + len, sizeof(batch) - len,
+                             "fb bench %06u: the quick brown fox jumps over the lazy dog\n",
+                             line + i);
+        }
+        fb_terminal_write(batch);
+    }
+    uint32_t ms = (uint32_t)(timer_get_uptime_ms() - t0);
+    fb_get_stats(&after);
+
+    if (ms == 0) {
+        ms = 1;
+    }
+    uint32_t hits = after.glyph_hits - before.glyph_hits;
+    uint32_t misses = after.glyph_misses - before.glyph_misses;
+    kprintf("    %u lines in %u ms, %u lines/s\n",
+            (uint32_t)FB_BENCH_LINES, ms, (uint32_t)((uint64_t)FB_BENCH_LINES * 1000 / ms));
+    kprintf("    glyph cache: %u hits, %u misses; %u scrolls, %u flushes, %u KB to VRAM\n",
+            hits, misses, after.scrolls - before.scrolls, after.flushes - before.flushes,
+            (uint32_t)((after.flush_bytes - before.flush_bytes) / 1024));
+
+    // 每行都在底部换行，滚屏次数至少是行数减去一屏
+    ASSERT_TRUE(after.scrolls - before.scrolls >= (uint32_t)(FB_BENCH_LINES - fb_get_rows()));
+    // 全程只有一种颜色对
+    ASSERT_TRUE(misses <= 1);
+}
+
+// ============================================================================
+// 测试套件定义
+// ============================================================================
+
+TEST_SUITE(fb_console_tests) {
+    RUN_TEST(test_fb_glyph_cache_pixels);
+    RUN_TEST(test_fb_scroll_ring);
+    RUN_TEST(test_fb_dirty_rect_flush);
+    RUN_TEST(test_fb_console_bench);
+}
+
+// ============================================================================
+// 运行所有测试
+// ============================================================================
+
+void run_fb_console_tests(void) {
+    // 初始化测试框架
+    unittest_init();
+
+    // 运行所有测试套件
+    RUN_SUITE(fb_console_tests);
+
+    // 打印测试摘要
+    unittest_print_summary();
+}
+
+// ============================================================================
+// 模块注册
+// ============================================================================
+
+TEST_MODULE_DESC(fb_console, DRIVERS, run_fb_console_tests,
+    "Framebuffer console - glyph cache, ring scrolling and dirty rectangles");
@@ -14,12 +14,14 @@
 //   - 字符串发送 (serial_print)
 //   - 字符接收 (ARM64 only: serial_getchar, serial_has_char)
 //   - 特殊字符处理（换行符转换）
+//   - 发送环：超过 UART FIFO 的突发输出不丢字节，flush 后全部写出
 // ============================================================================
 
 #include <tests/ktest.h>
 #include <tests/drivers/serial_test.h>
 #include <lib/kprintf.h>
 #include <drivers/serial.h>
+#include <lib/string.h>
 
 // ============================================================================
 // 测试辅助函数
@@ -219,6 +221,63 @@ TEST_CASE(test_serial_print_null_ptr) {
     ASSERT_TRUE(true);
 }
 
+// ============================================================================
+// 测试用例：发送环
+// ============================================================================
+
+#define SERIAL_TEST_BURST_LINES 16
+#define SERIAL_TEST_LINE_LEN    64
+
+/**
+ * 远超 UART FIFO 的突发输出：发送环容纳得下时不丢字节，flush 后全部写入 UART
+ */
+TEST_CASE(test_serial_tx_burst) {
+    char line[SERIAL_TEST_LINE_LEN + 2];
+    memset(line, '=', SERIAL_TEST_LINE_LEN);
+    line[SERIAL_TEST_LINE_LEN] = '\n';
+    line[SERIAL_TEST_LINE_LEN + 1] = '\0';
+
+    serial_stats_t before, after;
+    serial_flush();
+    serial_get_stats(&before);
+    for (int i = 0; i < SERIAL_TEST_BURST_LINES; i++) {
+        serial_print(line);
+    }
+    serial_flush();
+    serial_get_stats(&after);
+
+    // 每行另有 '\n' 前补的 '\r'；其他输出者只会让计数更多
+    uint32_t expect = SERIAL_TEST_BURST_LINES * (SERIAL_TEST_LINE_LEN + 2);
+    ASSERT_TRUE(after.tx_bytes - before.tx_bytes >= expect);
+    ASSERT_EQ_UINT(before.tx_dropped, after.tx_dropped);
+    ASSERT_TRUE(after.ring_high <= SERIAL_TX_RING_SIZE);
+}
+
+/**
+ * flush 对空发送环立即返回，计数不倒退
+ */
+TEST_CASE(test_serial_flush_idle) {
+    serial_stats_t before, after;
+    serial_flush();
+    serial_get_stats(&before);
+    serial_flush();
+    serial_get_stats(&after);
+    ASSERT_TRUE(after.tx_bytes >= before.tx_bytes);
+    ASSERT_EQ_UINT(before.tx_dropped, after.tx_dropped);
+}
+
+#if !defined(ARCH_ARM64)
+/**
+ * /proc/serial 内容
+ */
+TEST_CASE(test_serial_stats_dump) {
+    char text[256];
+    int len = serial_stats_dump(text, sizeof(text));
+    ASSERT_TRUE(len > 0);
+    ASSERT_EQ(strncmp(text, "mode:", 5), 0);
+}
+#endif
+
 // ============================================================================
 // ARM64 特定测试：字符接收功能
 // ============================================================================
@@ -349,6 +408,14 @@ TEST_SUITE(serial_edge_case_tests) {
     RUN_TEST(test_serial_print_null_ptr);
 }
 
+TEST_SUITE(serial_tx_ring_tests) {
+    RUN_TEST(test_serial_tx_burst);
+    RUN_TEST(test_serial_flush_idle);
+#if !defined(ARCH_ARM64)
+    RUN_TEST(test_serial_stats_dump);
+#endif
+}
+
 #if defined(ARCH_ARM64)
 TEST_SUITE(serial_arm64_tests) {
     RUN_TEST(test_serial_has_char);
@@ -374,6 +441,7 @@ void run_serial_tests(void) {
     RUN_SUITE(serial_putchar_tests);
     RUN_SUITE(serial_print_tests);
     RUN_SUITE(serial_edge_case_tests);
+    RUN_SUITE(serial_tx_ring_tests);
     
 #if defined(ARCH_ARM64)
     RUN_SUITE(serial_arm64_tests);
@@ -0,0 +1,166 @@
+// ============================================================================
+// usb_msc_test.c - USB 大容量存储驱动测试模块
+// ============================================================================
+//
+// 只读访问第一个 USB 存储设备（QEMU: -device usb-storage），没有时跳过
+//
+// 测试覆盖:
+//   - 一次大块读取只发一条 READ(10)，数据与逐 8 块读取相同
+//   - 不同命令大小的读吞吐量（MB/s）与 UHCI 中断/轮询统计
+// ============================================================================
+
+#include <tests/ktest.h>
+#include <tests/drivers/usb_msc_test.h>
+#include <tests/test_module.h>
+#include <drivers/usb/usb.h>
+#include <drivers/usb/uhci.h>
+#include <drivers/usb/usb_mass_storage.h>
+#include <drivers/timer.h>
+#include <mm/heap.h>
+#include <lib/kprintf.h>
+#include <lib/string.h>
+
+#define MSC_TEST_BLOCKS         256         // 128KB，一条命令
+#define MSC_TEST_SMALL          8
+#define MSC_BENCH_BLOCKS        2048        // 1MB
+
+// ============================================================================
+// 测试辅助函数
+// ============================================================================
+
+static usb_msc_device_t *msc_test_dev(void) {
+    usb_msc_device_t *msc = usb_msc_get_devices();
+    if (msc == NULL || !msc->ready || msc->block_size != USB_MSC_BLOCK_SIZE) {
+        kprintf("    no USB mass storage device, skipped\n");
+        return NULL;
+    }
+    return msc;
+}
+
+static uhci_controller_t *msc_test_hc(usb_msc_device_t *msc) {
+    usb_host_controller_t *hc = (usb_host_controller_t *)msc->usb_dev->hc;
+    return hc ? (uhci_controller_t *)hc->private_data : NULL;
+}
+
+/* 以 chunk 块为单位读取 [0, total)，返回耗时（毫秒），失败返回 -1 */
+static int msc_bench_read(usb_msc_device_t *msc, uint8_t *buf, uint32_t total, uint32_t chunk) {
+    uint64_t t0 = timer_get_uptime_ms();
+    for (uint32_t lba = 0; lba < total; lba += chunk) {
+        if (usb_msc_read(msc, lba, chunk, buf) != 0) {
+            return -1;
+        }
+    }
+    return (int)(timer_get_uptime_ms() - t0);
+}
+
+static void msc_print_rate(uint32_t chunk, uint32_t blocks, int ms, uint32_t commands) {
+    if (ms <= 0) {
+        ms = 1;
+    }
+    uint32_t kb_per_s = (uint32_t)(((uint64_t)blocks * 512 / 1024) * 1000 / (uint32_t)ms);
+    kprintf("    %u blocks/cmd: %u KB in %d ms, %u.%02u MB/s, %u commands\n",
+            chunk, blocks / 2, ms, kb_per_s / 1024, (kb_per_s % 1024) * 100 / 1024, commands);
+}
+
+// ============================================================================
+// 测试用例
+// ============================================================================
+
+TEST_CASE(test_usb_msc_large_read) {
+    usb_msc_device_t *msc = msc_test_dev();
+    if (msc == NULL || msc->block_count < MSC_TEST_BLOCKS) {
+        return;
+    }
+
+    uint32_t bytes = MSC_TEST_BLOCKS * USB_MSC_BLOCK_SIZE;
+    uint8_t *large = (uint8_t *)kmalloc(bytes);
+    uint8_t *small = (uint8_t *)kmalloc(bytes);
+    ASSERT_NOT_NULL(large);
+    ASSERT_NOT_NULL(small);
+
+    uint32_t commands = msc->rw_commands;
+    memset(large, 0xA5, bytes);
+    int ret = usb_msc_read(msc, 0, MSC_TEST_BLOCKS, large);
+    uint32_t large_commands = msc->rw_commands - commands;
+
+    for (uint32_t lba = 0; lba < MSC_TEST_BLOCKS && ret == 0; lba += MSC_TEST_SMALL) {
+        ret = usb_msc_read(msc, lba, MSC_TEST_SMALL, small + lba * USB_MSC_BLOCK_SIZE);
+    }
+
+    ASSERT_EQ(ret, 0);
+    ASSERT_EQ(memcmp(large, small, bytes), 0);
+    if (msc->max_blocks >= MSC_TEST_BLOCKS) {
+        ASSERT_EQ_UINT(1, large_commands);
+    }
+
+    kfree(large);
+    kfree(small);
+}
+
+TEST_CASE(test_usb_msc_read_throughput) {
+    usb_msc_device_t *msc = msc_test_dev();
+    if (msc == NULL || msc->block_count < MSC_BENCH_BLOCKS) {
+        return;
+    }
+
+    uint8_t *buf = (uint8_t *)kmalloc(MSC_TEST_BLOCKS * USB_MSC_BLOCK_SIZE);
+    ASSERT_NOT_NULL(buf);
+
+    uhci_controller_t *hc = msc_test_hc(msc);
+    uint32_t irqs0 = 0, xfers0 = 0, polled0 = 0;
+    uhci_get_stats(hc, &irqs0, &xfers0, &polled0);
+
+    static const uint32_t chunks[] = { MSC_TEST_SMALL, 64, MSC_TEST_BLOCKS };
+    bool ok = true;
+    for (uint32_t i = 0; i < sizeof(chunks) / sizeof(chunks[0]) && ok; i++) {
+        uint32_t commands = msc->rw_commands;
+        int ms = msc_bench_read(msc, buf, MSC_BENCH_BLOCKS, chunks[i]);
+        ok = ms >= 0;
+        if (ok) {
+            msc_print_rate(chunks[i], MSC_BENCH_BLOCKS, ms, msc->rw_commands - commands);
+        }
+    }
+
+    uint32_t irqs = 0, xfers = 0, polled = 0;
+    uhci_get_stats(hc, &irqs, &xfers, &polled);
+    kprintf("    uhci: %u transfer rounds, %u interrupts, %u polled\n",
+            xfers - xfers0, irqs - irqs0, polled - polled0);
+    kfree(buf);
+
+    ASSERT_TRUE(ok);
+    // 任务上下文中的传输都应睡眠等待中断
+    if (hc && hc->irq_registered) {
+        ASSERT_EQ_UINT(0, polled - polled0);
+    }
+}
+
+// ============================================================================
+// 测试套件定义
+// ============================================================================
+
+TEST_SUITE(usb_msc_tests) {
+    RUN_TEST(test_usb_msc_large_read);
+    RUN_TEST(test_usb_msc_read_throughput);
+}
+
+// ============================================================================
+// 运行所有测试
+// ============================================================================
+
+void run_usb_msc_tests(void) {
+    // 初始化测试框架
+    unittest_init();
+
+    // 运行所有测试套件
+    RUN_SUITE(usb_msc_tests);
+
+    // 打印测试摘要
+    unittest_print_summary();
+}
+
+// ============================================================================
+// 模块注册
+// ============================================================================
+
+TEST_MODULE_DESC(usb_msc, DRIVERS, run_usb_msc_tests,
+    "USB mass storage - large READ(10) commands and UHCI throughput");
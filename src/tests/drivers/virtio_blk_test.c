@@ -0,0 +1,300 @@
+// ============================================================================
+// virtio_blk_test.c - virtqueue / virtio-blk 测试模块
+// ============================================================================
+//
+// virtqueue 部分用假传输层在内存里扮演设备（直接写已用环），不需要真实
+// 设备；virtio-blk 部分访问 vda，没有该设备时跳过
+//
+// 测试覆盖:
+//   - 事件索引的通知判断（含 16 位回绕）
+//   - 间接描述符：多段请求只占一个环描述符
+//   - 直接描述符链：队列占满后按乱序完成，描述符全部回收
+//   - 事件索引抑制多余的通知
+//   - vda 写入后读回一致，大请求拆成多个同时在途的请求并只通知一次
+// ============================================================================
+
+#include <tests/ktest.h>
+#include <tests/drivers/virtio_blk_test.h>
+#include <tests/test_module.h>
+#include <drivers/common/virtio.h>
+#include <drivers/common/virtqueue.h>
+#include <drivers/common/virtio_blk.h>
+#include <fs/blockdev.h>
+#include <mm/heap.h>
+#include <lib/kprintf.h>
+#include <lib/string.h>
+
+#define VQ_TEST_SIZE            16
+#define VBLK_TEST_DEVICE        "vda"
+#define VBLK_TEST_SECTORS       300         // 150KB，超过单个请求的 64KB
+
+// ============================================================================
+// 假传输层
+// ============================================================================
+
+static uint32_t fake_notifies;
+
+static uint8_t fake_get_status(virtio_device_t *vdev) { (void)vdev; return 0; }
+static void fake_set_status(virtio_device_t *vdev, uint8_t status) { (void)vdev; (void)status; }
+static uint64_t fake_get_features(virtio_device_t *vdev) { return vdev->features; }
+static void fake_set_features(virtio_device_t *vdev, uint64_t f) { (void)vdev; (void)f; }
+static uint8_t fake_read_config8(virtio_device_t *vdev, uint32_t off) { (void)vdev; (void)off; return 0; }
+static void fake_write_config8(virtio_device_t *vdev, uint32_t off, uint8_t v) { (void)vdev; (void)off; (void)v; }
+static uint16_t fake_queue_size(virtio_device_t *vdev, uint16_t index) { (void)vdev; (void)index; return VQ_TEST_SIZE; }
+static int fake_queue_setup(virtio_device_t *vdev, virtqueue_t *vq) { (void)vdev; (void)vq; return 0; }
+static void fake_notify(virtio_device_t *vdev, uint16_t index) { (void)vdev; (void)index; fake_notifies++; }
+static uint32_t fake_ack_interrupt(virtio_device_t *vdev) { (void)vdev; return 0; }
+static int fake_enable_irq(virtio_device_t *vdev) { (void)vdev; return -1; }
+
+static const virtio_transport_ops_t fake_ops = {
+    .get_status     = fake_get_status,
+    .set_status     = fake_set_status,
+    .get_features   = fake_get_features,
+    .set_features   = fake_set_features,
+    .read_config8   = fake_read_config8,
+    .write_config8  = fake_write_config8,
+    .queue_size     = fake_queue_size,
+    .queue_setup    = fake_queue_setup,
+    .notify         = fake_notify,
+    .ack_interrupt  = fake_ack_interrupt,
+    .enable_irq     = fake_enable_irq,
+};
+
+static void fake_device_init(virtio_device_t *vdev, uint64_t features) {
+    memset(vdev, 0, sizeof(*vdev));
+    strcpy(vdev->name, "fake");
+    vdev->ops = &fake_ops;
+    vdev->features = features;
+    vdev->legacy = true;
+}
+
+/* 扮演设备：把头描述符 head 放进已用环 */
+static void fake_device_complete(virtqueue_t *vq, uint16_t head, uint32_t len) {
+    uint16_t idx = vq->used->idx;
+    vq->used->ring[idx & (vq->num - 1)].id = head;
+    vq->used->ring[idx & (vq->num - 1)].len = len;
+    vq->used->idx = (uint16_t)(idx + 1);
+}
+
+/* 设备看到的最新一个可用环项 */
+static uint16_t fake_device_last_avail(virtqueue_t *vq) {
+    return vq->avail->ring[(uint16_t)(vq->avail_idx - 1) & (vq->num - 1)];
+}
+
+// ============================================================================
+// virtqueue 测试
+// ============================================================================
+
+TEST_CASE(test_virtq_need_event) {
+    ASSERT_TRUE(virtq_need_event(5, 6, 5));         // 刚好越过 event
+    ASSERT_FALSE(virtq_need_event(5, 5, 4));        // 尚未越过
+    ASSERT_TRUE(virtq_need_event(10, 20, 5));       // 一批里越过
+    ASSERT_FALSE(virtq_need_event(30, 20, 5));      // 整批都在 event 之前
+    ASSERT_TRUE(virtq_need_event(0xFFFF, 2, 0xFFFE));   // 回绕
+    ASSERT_FALSE(virtq_need_event(3, 2, 0xFFFE));
+}
+
+TEST_CASE(test_virtq_indirect_single_slot) {
+    virtio_device_t vdev;
+    virtqueue_t vq;
+    fake_device_init(&vdev, VIRTIO_FEATURE(VIRTIO_F_INDIRECT_DESC));
+    ASSERT_EQ(virtqueue_init(&vq, &vdev, 0), 0);
+    ASSERT_TRUE(vq.use_indirect);
+
+    virtq_sg_t sg[3] = { { 0x1000, 16 }, { 0x2000, 4096 }, { 0x3000, 1 } };
+    int tokens[VQ_TEST_SIZE];
+
+    // 每个三段请求只占一个描述符，整个环都能用来排队
+    for (int i = 0; i < VQ_TEST_SIZE; i++) {
+        ASSERT_EQ(virtqueue_add(&vq, sg, 1, 2, &tokens[i]), 0);
+        uint16_t head = fake_device_last_avail(&vq);
+        ASSERT_TRUE(vq.desc[head].flags & VIRTQ_DESC_F_INDIRECT);
+        ASSERT_EQ_UINT(3 * sizeof(struct virtq_desc), vq.desc[head].len);
+    }
+    ASSERT_EQ_UINT(0, vq.num_free);
+    ASSERT_NE(virtqueue_add(&vq, sg, 1, 2, &tokens[0]), 0);
+
+    // 间接表内的段与方向
+    struct virtq_desc *table = vq.indirect;
+    ASSERT_EQ_UINT(VIRTQ_DESC_F_NEXT, table[0].flags);
+    ASSERT_EQ_UINT(VIRTQ_DESC_F_NEXT | VIRTQ_DESC_F_WRITE, table[1].flags);
+    ASSERT_EQ_UINT(VIRTQ_DESC_F_WRITE, table[2].flags);
+
+    for (int i = 0; i < VQ_TEST_SIZE; i++) {
+        fake_device_complete(&vq, vq.avail->ring[i], 0);
+    }
+    int completed = 0;
+    while (virtqueue_get_used(&vq, NULL) != NULL) {
+        completed++;
+    }
+    ASSERT_EQ(completed, VQ_TEST_SIZE);
+    ASSERT_EQ_UINT(VQ_TEST_SIZE, vq.num_free);
+
+    virtqueue_destroy(&vq);
+}
+
+TEST_CASE(test_virtq_direct_chain_recycle) {
+    virtio_device_t vdev;
+    virtqueue_t vq;
+    fake_device_init(&vdev, 0);
+    ASSERT_EQ(virtqueue_init(&vq, &vdev, 0), 0);
+    ASSERT_FALSE(vq.use_indirect);
+
+    virtq_sg_t sg[3] = { { 0x1000, 16 }, { 0x2000, 512 }, { 0x3000, 1 } };
+    int tokens[VQ_TEST_SIZE / 3];
+    uint16_t heads[VQ_TEST_SIZE / 3];
+    int queued = 0;
+    while (virtqueue_add(&vq, sg, 2, 1, &tokens[queued]) == 0) {
+        heads[queued] = fake_device_last_avail(&vq);
+        queued++;
+    }
+    ASSERT_EQ(queued, VQ_TEST_SIZE / 3);
+    ASSERT_EQ_UINT(VQ_TEST_SIZE % 3, vq.num_free);
+
+    // 乱序完成：先偶数再奇数，token 必须与头描述符对应
+    for (int pass = 0; pass < 2; pass++) {
+        for (int i = pass; i < queued; i += 2) {
+            fake_device_complete(&vq, heads[i], 1);
+        }
+    }
+    for (int pass = 0; pass < 2; pass++) {
+        for (int i = pass; i < queued; i += 2) {
+            uint32_t len = 0;
+            ASSERT_EQ_PTR(&tokens[i], virtqueue_get_used(&vq, &len));
+            ASSERT_EQ_UINT(1, len);
+        }
+    }
+    ASSERT_NULL(virtqueue_get_used(&vq, NULL));
+    ASSERT_EQ_UINT(VQ_TEST_SIZE, vq.num_free);
+
+    // 回收的描述符可以再次组成同样多的链
+    for (int i = 0; i < queued; i++) {
+        ASSERT_EQ(virtqueue_add(&vq, sg, 2, 1, &tokens[i]), 0);
+    }
+    virtqueue_destroy(&vq);
+}
+
+TEST_CASE(test_virtq_event_idx_suppresses_kick) {
+    virtio_device_t vdev;
+    virtqueue_t vq;
+    fake_device_init(&vdev, VIRTIO_FEATURE(VIRTIO_F_EVENT_IDX));
+    ASSERT_EQ(virtqueue_init(&vq, &vdev, 0), 0);
+    ASSERT_TRUE(vq.use_event_idx);
+
+    virtq_sg_t sg = { 0x1000, 16 };
+    int token;
+
+    // 设备希望在 avail 越过 0 时得到通知：一批两个请求只需一次
+    *virtq_avail_event(&vq) = 0;
+    ASSERT_EQ(virtqueue_add(&vq, &sg, 1, 0, &token), 0);
+    ASSERT_EQ(virtqueue_add(&vq, &sg, 1, 0, &token), 0);
+    ASSERT_TRUE(virtqueue_kick_prepare(&vq));
+
+    // 设备还没处理到 event，后续提交不必再通知
+    ASSERT_EQ(virtqueue_add(&vq, &sg, 1, 0, &token), 0);
+    ASSERT_FALSE(virtqueue_kick_prepare(&vq));
+
+    // 没有新提交时不通知，也不计数
+    ASSERT_FALSE(virtqueue_kick_prepare(&vq));
+    ASSERT_EQ_UINT(1, vq.kicks);
+    ASSERT_EQ_UINT(1, vq.kicks_suppressed);
+
+    // 设备推进 avail_event 后恢复通知
+    *virtq_avail_event(&vq) = 3;
+    ASSERT_EQ(virtqueue_add(&vq, &sg, 1, 0, &token), 0);
+    ASSERT_TRUE(virtqueue_kick_prepare(&vq));
+
+    virtqueue_destroy(&vq);
+}
+
+// ============================================================================
+// virtio-blk 测试
+// ============================================================================
+
+TEST_CASE(test_virtio_blk_write_read) {
+    blockdev_t *dev = blockdev_get_by_name(VBLK_TEST_DEVICE);
+    if (dev == NULL || dev->total_sectors < VBLK_TEST_SECTORS * 2) {
+        kprintf("    %s not present, skipped\n", VBLK_TEST_DEVICE);
+        return;
+    }
+
+    uint32_t bytes = VBLK_TEST_SECTORS * 512;
+    uint32_t lba = dev->total_sectors - VBLK_TEST_SECTORS;    // 用设备末尾，避开分区表和文件系统
+    uint8_t *saved = (uint8_t *)kmalloc(bytes);
+    uint8_t *pattern = (uint8_t *)kmalloc(bytes);
+    uint8_t *check = (uint8_t *)kmalloc(bytes);
+    ASSERT_NOT_NULL(saved);
+    ASSERT_NOT_NULL(pattern);
+    ASSERT_NOT_NULL(check);
+
+    for (uint32_t i = 0; i < bytes; i++) {
+        pattern[i] = (uint8_t)(i * 7 + i / 512);
+    }
+
+    virtio_blk_stats_t before, after;
+    ASSERT_EQ(virtio_blk_get_stats(VBLK_TEST_DEVICE, &before), 0);
+
+    ASSERT_EQ(blockdev_read(dev, lba, VBLK_TEST_SECTORS, saved), 0);
+    ASSERT_EQ(blockdev_write(dev, lba, VBLK_TEST_SECTORS, pattern), 0);
+    memset(check, 0, bytes);
+    int ret = blockdev_read(dev, lba, VBLK_TEST_SECTORS, check);
+    int restore = blockdev_write(dev, lba, VBLK_TEST_SECTORS, saved);
+
+    ASSERT_EQ(virtio_blk_get_stats(VBLK_TEST_DEVICE, &after), 0);
+    ASSERT_EQ(ret, 0);
+    ASSERT_EQ(restore, 0);
+    ASSERT_EQ(memcmp(check, pattern, bytes), 0);
+
+    // 每次读写都拆成多个请求同时在途，且每次只通知设备一次
+    uint32_t requests = after.requests - before.requests;
+    uint32_t kicks = after.kicks - before.kicks;
+    ASSERT_TRUE(requests >= 4 * 3);
+    ASSERT_TRUE(after.max_inflight >= 3);
+    ASSERT_TRUE(kicks <= 4);
+    kprintf("    4 x %u sectors: %u requests, %u kicks (%u suppressed), %u irqs, "
+            "max in flight %u\n", VBLK_TEST_SECTORS, requests, kicks,
+            after.kicks_suppressed - before.kicks_suppressed,
+            after.irqs - before.irqs, after.max_inflight);
+
+    kfree(saved);
+    kfree(pattern);
+    kfree(check);
+}
+
+// ============================================================================
+// 测试套件定义
+// ============================================================================
+
+TEST_SUITE(virtqueue_tests) {
+    RUN_TEST(test_virtq_need_event);
+    RUN_TEST(test_virtq_indirect_single_slot);
+    RUN_TEST(test_virtq_direct_chain_recycle);
+    RUN_TEST(test_virtq_event_idx_suppresses_kick);
+}
+
+TEST_SUITE(virtio_blk_tests) {
+    RUN_TEST(test_virtio_blk_write_read);
+}
+
+// ============================================================================
+// 运行所有测试
+// ============================================================================
+
+void run_virtio_blk_tests(void) {
+    // 初始化测试框架
+    unittest_init();
+
+    // 运行所有测试套件
+    RUN_SUITE(virtqueue_tests);
+    RUN_SUITE(virtio_blk_tests);
+
+    // 打印测试摘要
+    unittest_print_summary();
+}
+
+// ============================================================================
+// 模块注册
+// ============================================================================
+
+TEST_MODULE_DESC(virtio_blk, DRIVERS, run_virtio_blk_tests,
+    "virtqueue ring management and virtio-blk read/write consistency");
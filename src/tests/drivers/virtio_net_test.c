@@ -0,0 +1,124 @@
+// ============================================================================
+// virtio_net_test.c - virtio-net 驱动测试模块
+// ============================================================================
+//
+// 没有 virtio-net 设备（或设备未启用）时跳过发送测试
+//
+// 测试覆盖:
+//   - 包头布局（legacy 10 字节 + num_buffers）
+//   - 连续发送一批帧：全部被设备接受，发送槽随后回收
+// ============================================================================
+
+#include <tests/ktest.h>
+#include <tests/drivers/virtio_net_test.h>
+#include <tests/test_module.h>
+#include <drivers/common/virtio_net.h>
+#include <net/netdev.h>
+#include <net/netbuf.h>
+#include <net/ethernet.h>
+#include <lib/kprintf.h>
+#include <lib/string.h>
+
+#define VNET_TEST_FRAMES        64
+#define VNET_TEST_ETHERTYPE     0x88B5      // 本地实验用以太类型
+
+// ============================================================================
+// 测试辅助函数
+// ============================================================================
+
+static netdev_t *vnet_test_dev(void) {
+    netdev_t *devs[MAX_NETDEV];
+    virtio_net_stats_t stats;
+    int count = netdev_get_all(devs, MAX_NETDEV);
+    for (int i = 0; i < count; i++) {
+        if (virtio_net_get_stats(devs[i]->name, &stats) == 0 && devs[i]->state == NETDEV_UP) {
+            return devs[i];
+        }
+    }
+    kprintf("    no virtio-net device up, skipped\n");
+    return NULL;
+}
+
+static netbuf_t *vnet_test_frame(netdev_t *dev, uint32_t seq) {
+    netbuf_t *buf = netbuf_alloc(ETH_MIN_FRAME_LEN);
+    if (buf == NULL) {
+        return NULL;
+    }
+    uint8_t *frame = netbuf_put(buf, ETH_MIN_FRAME_LEN);
+    memset(frame, 0xFF, ETH_ADDR_LEN);
+    memcpy(frame + ETH_ADDR_LEN, dev->mac, ETH_ADDR_LEN);
+    frame[12] = (uint8_t)(VNET_TEST_ETHERTYPE >> 8);
+    frame[13] = (uint8_t)VNET_TEST_ETHERTYPE;
+    for (uint32_t i = ETH_HEADER_LEN; i < ETH_MIN_FRAME_LEN; i++) {
+        frame[i] = (uint8_t)(seq + i);
+    }
+    return buf;
+}
+
+// ============================================================================
+// 测试用例
+// ============================================================================
+
+TEST_CASE(test_virtio_net_hdr_layout) {
+    ASSERT_EQ_UINT(12, sizeof(virtio_net_hdr_t));
+    ASSERT_EQ_UINT(VIRTIO_NET_HDR_LEGACY_LEN, offsetof(virtio_net_hdr_t, num_buffers));
+    ASSERT_EQ_UINT(6, offsetof(virtio_net_hdr_t, csum_start));
+}
+
+TEST_CASE(test_virtio_net_tx_batch) {
+    netdev_t *dev = vnet_test_dev();
+    if (dev == NULL) {
+        return;
+    }
+
+    virtio_net_stats_t before, after;
+    ASSERT_EQ(virtio_net_get_stats(dev->name, &before), 0);
+
+    // 发送队列不发完成中断，发送槽靠发送路径上的回收周转
+    for (uint32_t i = 0; i < VNET_TEST_FRAMES; i++) {
+        netbuf_t *buf = vnet_test_frame(dev, i);
+        ASSERT_NOT_NULL(buf);
+        if (netdev_transmit(dev, buf) != 0) {
+            netbuf_free(buf);
+            ASSERT_TRUE(false);
+        }
+    }
+
+    ASSERT_EQ(virtio_net_get_stats(dev->name, &after), 0);
+    ASSERT_EQ_UINT(VNET_TEST_FRAMES, (uint32_t)(after.tx_packets - before.tx_packets));
+    ASSERT_EQ_UINT(0, (uint32_t)(after.tx_ring_full - before.tx_ring_full));
+    kprintf("    %u frames: %u kicks, %u suppressed\n", VNET_TEST_FRAMES,
+            after.tx_kicks - before.tx_kicks,
+            after.tx_kicks_suppressed - before.tx_kicks_suppressed);
+}
+
+// ============================================================================
+// 测试套件定义
+// ============================================================================
+
+TEST_SUITE(virtio_net_tests) {
+    RUN_TEST(test_virtio_net_hdr_layout);
+    RUN_TEST(test_virtio_net_tx_batch);
+}
+
+// ============================================================================
+// 运行所有测试
+// ============================================================================
+
+void run_virtio_net_tests(void) {
+    // 初始化测试框架
+    unittest_init();
+
+    // 运行所有测试套件
+    RUN_SUITE(virtio_net_tests);
+
+    // 打印测试摘要
+    unittest_print_summary();
+}
+
+// ============================================================================
+// 模块注册
+// ============================================================================
+
+TEST_MODULE_DESC(virtio_net, DRIVERS, run_virtio_net_tests,
+    "virtio-net header layout and batched transmit");
@@ -29,12 +29,24 @@
 #include <tests/fs/ramfs_test.h>
 #include <tests/fs/fat32_test.h>
 #include <tests/fs/devfs_test.h>
+#include <tests/fs/pipe_test.h>
+#include <tests/fs/poll_test.h>
+#include <tests/fs/splice_test.h>
+#include <tests/fs/dcache_test.h>
+#include <tests/fs/icache_test.h>
+#include <tests/fs/readdir_test.h>
+#include <tests/fs/fat32_lock_test.h>
+#include <tests/fs/bio_test.h>
+#include <tests/fs/readahead_test.h>
 #include <tests/net/checksum_test.h>
 #include <tests/net/netbuf_test.h>
 #include <tests/net/arp_test.h>
 #include <tests/net/tcp_test.h>
 #include <tests/kernel/task_test.h>
 #include <tests/kernel/sync_test.h>
+#include <tests/kernel/lock_torture_test.h>
+#include <tests/kernel/futex_test.h>
+#include <tests/kernel/waitqueue_test.h>
 #include <tests/kernel/syscall_test.h>
 #include <tests/kernel/syscall_error_test.h>
 #include <tests/kernel/fork_exec_test.h>
@@ -42,6 +54,12 @@
 #include <tests/drivers/pci_test.h>
 #include <tests/drivers/timer_test.h>
 #include <tests/drivers/serial_test.h>
+#include <tests/drivers/ata_test.h>
+#include <tests/drivers/virtio_blk_test.h>
+#include <tests/drivers/virtio_net_test.h>
+#include <tests/drivers/e1000_test.h>
+#include <tests/drivers/usb_msc_test.h>
+#include <tests/drivers/fb_console_test.h>
 #include <tests/arch/hal_test.h>
 #include <tests/arch/arch_types_test.h>
 #include <tests/arch/interrupt_handler_test.h>
@@ -293,6 +311,9 @@ static const test_entry_t test_suite[] = {
 #ifndef ARCH_X86_64
     TEST_ENTRY("Task Manager Tests", run_task_tests),
 #endif
+    TEST_ENTRY("Lock Torture Tests", run_lock_torture_tests),
+    TEST_ENTRY("Futex Tests", run_futex_tests),
+    TEST_ENTRY("Wait Queue Tests", run_waitqueue_tests),
     TEST_ENTRY("Memory Management Type Tests", run_mm_types_tests),
     TEST_ENTRY("Page Table Abstraction Tests", run_pgtable_tests),
     TEST_ENTRY("COW Flag Correctness Tests", run_cow_flag_tests),
@@ -324,6 +345,15 @@ static const test_entry_t test_suite[] = {
     TEST_ENTRY("Ramfs Tests", run_ramfs_tests),
     TEST_ENTRY("FAT32 Tests", run_fat32_tests),
     TEST_ENTRY("Devfs Tests", run_devfs_tests),
+    TEST_ENTRY("Pipe Tests", run_pipe_tests),
+    TEST_ENTRY("Poll Tests", run_poll_tests),
+    TEST_ENTRY("Splice Tests", run_splice_tests),
+    TEST_ENTRY("Dcache Tests", run_dcache_tests),
+    TEST_ENTRY("Icache Tests", run_icache_tests),
+    TEST_ENTRY("Readdir Tests", run_readdir_tests),
+    TEST_ENTRY("FAT32 Lock Tests", run_fat32_lock_tests),
+    TEST_ENTRY("Bio Tests", run_bio_tests),
+    TEST_ENTRY("Readahead Tests", run_readahead_tests),
     
     // 网络测试 (net/)
     TEST_ENTRY("Checksum Tests", run_checksum_tests),
@@ -335,6 +365,12 @@ static const test_entry_t test_suite[] = {
     TEST_ENTRY("PCI Tests", run_pci_tests),
     TEST_ENTRY("Timer Tests", run_timer_tests),
     TEST_ENTRY("Serial Tests", run_serial_tests),
+    TEST_ENTRY("ATA Tests", run_ata_tests),
+    TEST_ENTRY("VirtIO Block Tests", run_virtio_blk_tests),
+    TEST_ENTRY("VirtIO Net Tests", run_virtio_net_tests),
+    TEST_ENTRY("E1000 Tests", run_e1000_tests),
+    TEST_ENTRY("USB Mass Storage Tests", run_usb_msc_tests),
+    TEST_ENTRY("Framebuffer Console Tests", run_fb_console_tests),
 #endif /* ARCH_I686 || ARCH_X86_64 */
 
 #ifdef ARCH_ARM64
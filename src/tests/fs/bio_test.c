@@ -0,0 +1,442 @@
+// ============================================================================
+// bio_test.c - 块 I/O 请求层测试
+// ============================================================================
+//
+// 模块名称: bio
+// 子系统: fs (文件系统)
+// 描述: 测试 bio 提交、请求队列的排序合并与 remap 转发
+//
+// 功能覆盖:
+//   - plug 期间提交的相邻 bio 合并，按扇区顺序派发
+//   - 缓冲区不相接的合并经中转缓冲区读写
+//   - 缓冲区相接的写合并为一次驱动调用
+//   - end_io 回调
+//   - 堆叠设备经 remap 进入下层队列
+//   - 驱动完成请求时不就地派发，剩余请求由 kblockd 派发
+//   - 真实磁盘上随机与顺序 4KB 读的对比（没有磁盘时跳过）
+// ============================================================================
+
+#include <tests/ktest.h>
+#include <tests/fs/bio_test.h>
+#include <tests/test_module.h>
+#include <fs/bio.h>
+#include <fs/blockdev.h>
+#include <drivers/timer.h>
+#include <kernel/task.h>
+#include <mm/heap.h>
+#include <lib/kprintf.h>
+#include <lib/string.h>
+#include <types.h>
+
+#define BIO_TEST_SECTORS        64
+#define BIO_TEST_MAX_CALLS      16
+#define BIO_BENCH_IOS           64
+#define BIO_BENCH_BLOCKS        8       // 每个 bio 4KB
+
+// ============================================================================
+// 测试辅助：内存盘，记录每次驱动调用
+// ============================================================================
+
+typedef struct bio_test_call {
+    uint32_t sector;
+    uint32_t count;
+    bool write;
+} bio_test_call_t;
+
+static uint8_t bio_test_disk[BIO_TEST_SECTORS * 512];
+static bio_test_call_t bio_test_calls[BIO_TEST_MAX_CALLS];
+static uint32_t bio_test_ncalls;
+static blockdev_t bio_test_dev;
+
+static void bio_test_log(uint32_t sector, uint32_t count, bool write) {
+    if (bio_test_ncalls < BIO_TEST_MAX_CALLS) {
+        bio_test_calls[bio_test_ncalls].sector = sector;
+        bio_test_calls[bio_test_ncalls].count = count;
+        bio_test_calls[bio_test_ncalls].write = write;
+    }
+    bio_test_ncalls++;
+}
+
+static int bio_test_read(void *dev, uint32_t sector, uint32_t count, uint8_t *buffer) {
+    (void)dev;
+    bio_test_log(sector, count, false);
+    memcpy(buffer, bio_test_disk + sector * 512, count * 512);
+    return 0;
+}
+
+static int bio_test_write(void *dev, uint32_t sector, uint32_t count, const uint8_t *buffer) {
+    (void)dev;
+    bio_test_log(sector, count, true);
+    memcpy(bio_test_disk + sector * 512, buffer, count * 512);
+    return 0;
+}
+
+static uint8_t bio_test_pattern(uint32_t sector, uint32_t offset) {
+    return (uint8_t)(sector * 7 + offset);
+}
+
+static bool bio_test_setup(void) {
+    for (uint32_t s = 0; s < BIO_TEST_SECTORS; s++) {
+        for (uint32_t i = 0; i < 512; i++) {
+            bio_test_disk[s * 512 + i] = bio_test_pattern(s, i);
+        }
+    }
+    bio_test_ncalls = 0;
+
+    memset(&bio_test_dev, 0, sizeof(bio_test_dev));
+    strcpy(bio_test_dev.name, "biotest");
+    bio_test_dev.block_size = 512;
+    bio_test_dev.total_sectors = BIO_TEST_SECTORS;
+    bio_test_dev.read = bio_test_read;
+    bio_test_dev.write = bio_test_write;
+    return blk_queue_init(&bio_test_dev, 1) == 0;
+}
+
+static void bio_test_bio(bio_t *bio, blockdev_t *dev, uint32_t sector, uint32_t count,
+                         uint8_t *buffer, bool write) {
+    memset(bio, 0, sizeof(*bio));
+    bio->dev = dev;
+    bio->sector = sector;
+    bio->count = count;
+    bio->buffer = buffer;
+    bio->write = write;
+}
+
+static bool bio_test_check(const uint8_t *buf, uint32_t sector, uint32_t count) {
+    for (uint32_t s = 0; s < count; s++) {
+        for (uint32_t i = 0; i < 512; i++) {
+            if (buf[s * 512 + i] != bio_test_pattern(sector + s, i)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// 堆叠设备：扇区偏移 16 后转给内存盘
+static blockdev_t *bio_test_remap(void *dev, uint32_t *sector) {
+    (void)dev;
+    *sector += 16;
+    return &bio_test_dev;
+}
+
+static void bio_test_end_io(bio_t *bio) {
+    uint32_t *counter = (uint32_t *)bio->private;
+    if (bio->status == 0) {
+        (*counter)++;
+    }
+}
+
+// ============================================================================
+// 测试用例 - 队列合并
+// ============================================================================
+
+TEST_CASE(test_bio_sorted_merge_bounce) {
+    ASSERT_TRUE(bio_test_setup());
+
+    // 乱序提交，缓冲区之间留出空隙
+    static uint8_t area[32 * 512];
+    uint8_t *b0 = area, *b8 = area + 9 * 512, *b16 = area + 18 * 512, *b40 = area + 23 * 512;
+    bio_t bios[4];
+    bio_test_bio(&bios[0], &bio_test_dev, 40, 8, b40, false);
+    bio_test_bio(&bios[1], &bio_test_dev, 0, 8, b0, false);
+    bio_test_bio(&bios[2], &bio_test_dev, 8, 8, b8, false);
+    bio_test_bio(&bios[3], &bio_test_dev, 16, 4, b16, false);
+
+    blk_start_plug(&bio_test_dev);
+    for (int i = 0; i < 4; i++) {
+        ASSERT_EQ(bio_submit(&bios[i]), 0);
+    }
+    ASSERT_EQ_UINT(0, bio_test_ncalls);
+    blk_finish_plug(&bio_test_dev);
+
+    for (int i = 0; i < 4; i++) {
+        ASSERT_EQ(bio_wait(&bios[i]), 0);
+    }
+
+    // 0-19 合并为一次调用，按扇区顺序先于 40-47
+    ASSERT_EQ_UINT(2, bio_test_ncalls);
+    ASSERT_EQ_UINT(0, bio_test_calls[0].sector);
+    ASSERT_EQ_UINT(20, bio_test_calls[0].count);
+    ASSERT_EQ_UINT(40, bio_test_calls[1].sector);
+    ASSERT_EQ_UINT(8, bio_test_calls[1].count);
+
+    ASSERT_TRUE(bio_test_check(b0, 0, 8));
+    ASSERT_TRUE(bio_test_check(b8, 8, 8));
+    ASSERT_TRUE(bio_test_check(b16, 16, 4));
+    ASSERT_TRUE(bio_test_check(b40, 40, 8));
+
+    blk_queue_stats_t stats;
+    ASSERT_EQ(blk_queue_get_stats(&bio_test_dev, &stats), 0);
+    ASSERT_EQ_UINT(4, (uint32_t)stats.bios);
+    ASSERT_EQ_UINT(2, (uint32_t)stats.requests);
+    ASSERT_EQ_UINT(2, (uint32_t)stats.back_merges);
+    ASSERT_EQ_UINT(1, (uint32_t)stats.bounced);
+
+    blk_queue_destroy(&bio_test_dev);
+}
+
+TEST_CASE(test_bio_contiguous_write_merge) {
+    ASSERT_TRUE(bio_test_setup());
+
+    // 倒序提交相接的写：前向合并，缓冲区相接不需要中转
+    static uint8_t data[16 * 512];
+    for (uint32_t i = 0; i < sizeof(data); i++) {
+        data[i] = (uint8_t)(0xA5 ^ i);
+    }
+    bio_t bios[4];
+    blk_start_plug(&bio_test_dev);
+    for (int i = 3; i >= 0; i--) {
+        bio_test_bio(&bios[i], &bio_test_dev, 24 + (uint32_t)i * 4, 4, data + i * 4 * 512, true);
+        ASSERT_EQ(bio_submit(&bios[i]), 0);
+    }
+    blk_finish_plug(&bio_test_dev);
+    for (int i = 0; i < 4; i++) {
+        ASSERT_EQ(bio_wait(&bios[i]), 0);
+    }
+
+    ASSERT_EQ_UINT(1, bio_test_ncalls);
+    ASSERT_TRUE(bio_test_calls[0].write);
+    ASSERT_EQ_UINT(24, bio_test_calls[0].sector);
+    ASSERT_EQ_UINT(16, bio_test_calls[0].count);
+    ASSERT_EQ(memcmp(bio_test_disk + 24 * 512, data, sizeof(data)), 0);
+
+    blk_queue_stats_t stats;
+    ASSERT_EQ(blk_queue_get_stats(&bio_test_dev, &stats), 0);
+    ASSERT_EQ_UINT(3, (uint32_t)stats.front_merges);
+    ASSERT_EQ_UINT(0, (uint32_t)stats.bounced);
+
+    blk_queue_destroy(&bio_test_dev);
+}
+
+TEST_CASE(test_bio_end_io_and_remap) {
+    ASSERT_TRUE(bio_test_setup());
+
+    blockdev_t part;
+    memset(&part, 0, sizeof(part));
+    strcpy(part.name, "biotest1");
+    part.block_size = 512;
+    part.total_sectors = 32;
+    part.remap = bio_test_remap;
+
+    static uint8_t buf[8 * 512];
+    uint32_t completed = 0;
+    bio_t bio;
+    bio_test_bio(&bio, &part, 4, 8, buf, false);
+    bio.end_io = bio_test_end_io;
+    bio.private = &completed;
+    ASSERT_EQ(bio_submit(&bio), 0);
+    blk_run_queue(&part);
+
+    ASSERT_EQ_UINT(1, completed);
+    ASSERT_EQ_PTR(&bio_test_dev, bio.dev);
+    ASSERT_EQ_UINT(20, bio.sector);
+    ASSERT_TRUE(bio_test_check(buf, 20, 8));
+
+    // 越过堆叠设备末尾的 bio 在提交时被拒绝
+    bio_test_bio(&bio, &part, 30, 4, buf, false);
+    ASSERT_EQ(bio_submit(&bio), -1);
+
+    // blockdev_read 走同一队列
+    ASSERT_EQ(blockdev_read(&bio_test_dev, 60, 4, buf), 0);
+    ASSERT_TRUE(bio_test_check(buf, 60, 4));
+
+    blk_queue_destroy(&bio_test_dev);
+}
+
+// 异步驱动：submit 只记下请求，由测试决定何时完成
+static blk_request_t *bio_test_held[2];
+static uint32_t bio_test_submits;
+
+static int bio_test_submit(void *dev, blk_request_t *rq) {
+    (void)dev;
+    if (bio_test_submits < 2) {
+        bio_test_held[bio_test_submits] = rq;
+    }
+    bio_test_submits++;
+    memcpy(rq->buffer, bio_test_disk + rq->sector * 512, rq->count * 512);
+    return 0;
+}
+
+TEST_CASE(test_bio_done_defers_dispatch) {
+    ASSERT_TRUE(bio_test_setup());
+    blk_queue_destroy(&bio_test_dev);
+    bio_test_dev.submit = bio_test_submit;
+    ASSERT_EQ(blk_queue_init(&bio_test_dev, 1), 0);
+    bio_test_submits = 0;
+
+    static uint8_t buf[2][4 * 512];
+    uint32_t completed = 0;
+    bio_t bios[2];
+    for (uint32_t i = 0; i < 2; i++) {
+        bio_test_bio(&bios[i], &bio_test_dev, i * 32, 4, buf[i], false);
+        bios[i].end_io = bio_test_end_io;
+        bios[i].private = &completed;
+        ASSERT_EQ(bio_submit(&bios[i]), 0);
+    }
+    // 深度 1：第二个请求留在队列里
+    ASSERT_EQ_UINT(1, bio_test_submits);
+
+    // 完成路径（可能在中断里）不派发，交给 kblockd
+    blk_request_done(bio_test_held[0], 0);
+    uint32_t inline_submits = bio_test_submits;
+
+    uint64_t t0 = timer_get_uptime_ms();
+    while (bio_test_submits < 2 && timer_get_uptime_ms() - t0 < 1000) {
+        task_yield();
+    }
+    uint32_t deferred_submits = bio_test_submits;
+    if (deferred_submits < 2) {
+        blk_run_queue(&bio_test_dev);
+    }
+    if (bio_test_submits >= 2) {
+        blk_request_done(bio_test_held[1], 0);
+    }
+
+    ASSERT_EQ_UINT(1, inline_submits);
+    ASSERT_EQ_UINT(2, deferred_submits);
+    ASSERT_EQ_UINT(2, completed);
+    ASSERT_TRUE(bio_test_check(buf[1], 32, 4));
+
+    blk_queue_destroy(&bio_test_dev);
+    bio_test_dev.submit = NULL;
+}
+
+// ============================================================================
+// 测试用例 - 随机与顺序读对比
+// ============================================================================
+
+static blockdev_t *bio_bench_dev(void) {
+    static const char *names[] = { "vda", "ata0", "usb0" };
+    for (uint32_t i = 0; i < sizeof(names) / sizeof(names[0]); i++) {
+        blockdev_t *dev = blockdev_get_by_name(names[i]);
+        if (dev != NULL) {
+            if (dev->queue != NULL && blockdev_get_block_size(dev) == 512 &&
+                blockdev_get_size(dev) >= 2 * 1024 * 1024 / 512) {
+                return dev;
+            }
+            blockdev_release(dev);
+        }
+    }
+    kprintf("    no queued disk, skipped\n");
+    return NULL;
+}
+
+// 一次提交全部 bio 后等待，返回耗时（毫秒），失败返回 -1
+static int bio_bench_run(blockdev_t *dev, uint8_t *buf, const uint32_t *sectors,
+                         blk_queue_stats_t *delta) {
+    static bio_t bios[BIO_BENCH_IOS];
+    blk_queue_stats_t before, after;
+    blk_queue_get_stats(dev, &before);
+
+    uint64_t start = timer_get_uptime_ms();
+    blk_start_plug(dev);
+    for (uint32_t i = 0; i < BIO_BENCH_IOS; i++) {
+        bio_test_bio(&bios[i], dev, sectors[i], BIO_BENCH_BLOCKS,
+                     buf + i * BIO_BENCH_BLOCKS * 512, false);
+        if (bio_submit(&bios[i]) != 0) {
+            blk_finish_plug(dev);
+            return -1;
+        }
+    }
+    blk_finish_plug(dev);
+
+    int result = 0;
+    for (uint32_t i = 0; i < BIO_BENCH_IOS; i++) {
+        if (bio_wait(&bios[i]) != 0) {
+            result = -1;
+        }
+    }
+    uint64_t elapsed = timer_get_uptime_ms() - start;
+
+    blk_queue_get_stats(dev, &after);
+    delta->requests = after.requests - before.requests;
+    delta->back_merges = after.back_merges - before.back_merges;
+    delta->front_merges = after.front_merges - before.front_merges;
+    return result == 0 ? (int)elapsed : -1;
+}
+
+TEST_CASE(test_bio_bench_random_vs_sequential) {
+    blockdev_t *dev = bio_bench_dev();
+    if (dev == NULL) {
+        return;
+    }
+
+    uint8_t *buf = (uint8_t *)kmalloc(BIO_BENCH_IOS * BIO_BENCH_BLOCKS * 512);
+    uint32_t *sectors = (uint32_t *)kmalloc(BIO_BENCH_IOS * sizeof(uint32_t));
+    if (buf == NULL || sectors == NULL) {
+        kfree(buf);
+        kfree(sectors);
+        blockdev_release(dev);
+        ASSERT_TRUE(false);
+        return;
+    }
+
+    // 随机：前半个磁盘内 4KB 对齐的位置，互不相邻，无法合并
+    uint32_t span = blockdev_get_size(dev) / 2 / BIO_BENCH_BLOCKS;
+    uint32_t seed = 0x2545F491;
+    for (uint32_t i = 0; i < BIO_BENCH_IOS; i++) {
+        seed = seed * 1103515245 + 12345;
+        sectors[i] = ((seed >> 8) % (span / 2)) * 2 * BIO_BENCH_BLOCKS;
+    }
+    blk_queue_stats_t rnd;
+    int rnd_ms = bio_bench_run(dev, buf, sectors, &rnd);
+
+    // 顺序：同样数量的 4KB bio 首尾相接
+    for (uint32_t i = 0; i < BIO_BENCH_IOS; i++) {
+        sectors[i] = i * BIO_BENCH_BLOCKS;
+    }
+    blk_queue_stats_t seq;
+    int seq_ms = bio_bench_run(dev, buf, sectors, &seq);
+
+    kprintf("    %s %u x 4KB reads: random %d ms (%u requests), "
+            "sequential %d ms (%u requests, %u merges)\n",
+            dev->name, BIO_BENCH_IOS, rnd_ms, (uint32_t)rnd.requests,
+            seq_ms, (uint32_t)seq.requests, (uint32_t)(seq.back_merges + seq.front_merges));
+
+    kfree(buf);
+    kfree(sectors);
+    blockdev_release(dev);
+
+    ASSERT_TRUE(rnd_ms >= 0);
+    ASSERT_TRUE(seq_ms >= 0);
+    ASSERT_TRUE(seq.requests < BIO_BENCH_IOS);
+}
+
+// ============================================================================
+// 测试套件定义
+// ============================================================================
+
+TEST_SUITE(bio_queue_tests) {
+    RUN_TEST(test_bio_sorted_merge_bounce);
+    RUN_TEST(test_bio_contiguous_write_merge);
+    RUN_TEST(test_bio_end_io_and_remap);
+    RUN_TEST(test_bio_done_defers_dispatch);
+}
+
+TEST_SUITE(bio_benchmark_tests) {
+    RUN_TEST(test_bio_bench_random_vs_sequential);
+}
+
+// ============================================================================
+// 运行所有测试
+// ============================================================================
+
+void run_bio_tests(void) {
+    // 初始化测试框架
+    unittest_init();
+
+    // 运行所有测试套件
+    RUN_SUITE(bio_queue_tests);
+    RUN_SUITE(bio_benchmark_tests);
+
+    // 打印测试摘要
+    unittest_print_summary();
+}
+
+// ============================================================================
+// 模块注册
+// ============================================================================
+
+TEST_MODULE_DESC(bio, FS, run_bio_tests,
+    "Block I/O request queue - sorted merging, plugging, random vs sequential reads");
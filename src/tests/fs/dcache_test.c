@@ -0,0 +1,239 @@
+// ============================================================================
+// dcache_test.c - 目录项缓存单元测试
+// ============================================================================
+//
+// 模块名称: dcache
+// 子系统: fs (文件系统)
+// 描述: 测试路径解析使用的目录项缓存
+//
+// 功能覆盖:
+//   - 正项命中：重复解析返回同一节点
+//   - 负项：不存在的路径被缓存，create/mkdir 后失效
+//   - unlink/rename 使缓存失效，删除目录时清除其下的条目
+//   - LRU 淘汰
+//   - 深层路径重复解析的耗时（有缓存 / 每次清空缓存）
+// ============================================================================
+
+#include <tests/ktest.h>
+#include <tests/fs/dcache_test.h>
+#include <tests/test_module.h>
+#include <fs/dcache.h>
+#include <fs/vfs.h>
+#include <drivers/timer.h>
+#include <lib/kprintf.h>
+#include <lib/string.h>
+#include <types.h>
+
+// ============================================================================
+// 测试辅助函数
+// ============================================================================
+
+static bool dcache_test_exists(const char *path) {
+    fs_node_t *node = vfs_path_to_node(path);
+    if (!node) {
+        return false;
+    }
+    vfs_release_node(node);
+    return true;
+}
+
+// ============================================================================
+// 正项与负项
+// ============================================================================
+
+TEST_CASE(test_dcache_positive_hit) {
+    vfs_unlink("/DCHIT.TMP");
+    ASSERT_EQ(vfs_create("/DCHIT.TMP"), 0);
+    
+    fs_node_t *a = vfs_path_to_node("/DCHIT.TMP");
+    ASSERT_NOT_NULL(a);
+    
+    dcache_stats_t before, after;
+    dcache_get_stats(&before);
+    fs_node_t *b = vfs_path_to_node("/DCHIT.TMP");
+    dcache_get_stats(&after);
+    
+    // 第二次解析由缓存给出，且是同一个节点对象
+    ASSERT_NOT_NULL(b);
+    ASSERT_TRUE(a == b);
+    ASSERT_EQ_UINT(after.hits, before.hits + 1);
+    
+    vfs_release_node(a);
+    vfs_release_node(b);
+    ASSERT_EQ(vfs_unlink("/DCHIT.TMP"), 0);
+}
+
+TEST_CASE(test_dcache_negative_entry) {
+    vfs_unlink("/DCNEG.TMP");
+    ASSERT_FALSE(dcache_test_exists("/DCNEG.TMP"));
+    
+    dcache_stats_t before, after;
+    dcache_get_stats(&before);
+    ASSERT_FALSE(dcache_test_exists("/DCNEG.TMP"));
+    dcache_get_stats(&after);
+    ASSERT_EQ_UINT(after.negative_hits, before.negative_hits + 1);
+    
+    // 创建后负项失效
+    ASSERT_EQ(vfs_create("/DCNEG.TMP"), 0);
+    ASSERT_TRUE(dcache_test_exists("/DCNEG.TMP"));
+    
+    ASSERT_EQ(vfs_unlink("/DCNEG.TMP"), 0);
+    ASSERT_FALSE(dcache_test_exists("/DCNEG.TMP"));
+}
+
+TEST_CASE(test_dcache_rename_invalidates) {
+    vfs_unlink("/DCOLD.TMP");
+    vfs_unlink("/DCNEW.TMP");
+    ASSERT_EQ(vfs_create("/DCOLD.TMP"), 0);
+    
+    // 两个名字都进入缓存（一正一负）
+    ASSERT_TRUE(dcache_test_exists("/DCOLD.TMP"));
+    ASSERT_FALSE(dcache_test_exists("/DCNEW.TMP"));
+    
+    ASSERT_EQ(vfs_rename("/DCOLD.TMP", "/DCNEW.TMP"), 0);
+    ASSERT_FALSE(dcache_test_exists("/DCOLD.TMP"));
+    ASSERT_TRUE(dcache_test_exists("/DCNEW.TMP"));
+    
+    ASSERT_EQ(vfs_unlink("/DCNEW.TMP"), 0);
+}
+
+TEST_CASE(test_dcache_rmdir_purges_children) {
+    vfs_unlink("/DCDIR/X.TMP");
+    vfs_unlink("/DCDIR");
+    ASSERT_EQ(vfs_mkdir("/DCDIR", FS_PERM_READ | FS_PERM_WRITE | FS_PERM_EXEC), 0);
+    
+    // 目录下的负项
+    ASSERT_FALSE(dcache_test_exists("/DCDIR/X.TMP"));
+    
+    // 删除并重建同名目录后，旧目录下的负项不能影响新目录
+    ASSERT_EQ(vfs_unlink("/DCDIR"), 0);
+    ASSERT_EQ(vfs_mkdir("/DCDIR", FS_PERM_READ | FS_PERM_WRITE | FS_PERM_EXEC), 0);
+    ASSERT_EQ(vfs_create("/DCDIR/X.TMP"), 0);
+    ASSERT_TRUE(dcache_test_exists("/DCDIR/X.TMP"));
+    
+    ASSERT_EQ(vfs_unlink("/DCDIR/X.TMP"), 0);
+    ASSERT_EQ(vfs_unlink("/DCDIR"), 0);
+}
+
+// ============================================================================
+// LRU 淘汰
+// ============================================================================
+
+TEST_CASE(test_dcache_lru_eviction) {
+    static fs_node_t dir;
+    char name[16];
+    fs_node_t *node;
+    
+    memset(&dir, 0, sizeof(dir));
+    dir.type = FS_DIRECTORY;
+    dir.flags = FS_NODE_FLAG_DCACHE;
+    
+    dcache_stats_t before, after;
+    dcache_get_stats(&before);
+    
+    // 填满整个缓存再多加一项，最早的条目被淘汰
+    for (uint32_t i = 0; i <= DCACHE_MAX_ENTRIES; i++) {
+        ksnprintf(name, sizeof(name), "n%u", i);
+        dcache_add(&dir, name, NULL);
+    }
+    
+    dcache_get_stats(&after);
+    ASSERT_EQ_UINT(after.entries, DCACHE_MAX_ENTRIES);
+    ASSERT_TRUE(after.evictions > before.evictions);
+    ASSERT_FALSE(dcache_lookup(&dir, "n0", &node));
+    
+    ksnprintf(name, sizeof(name), "n%u", DCACHE_MAX_ENTRIES);
+    ASSERT_TRUE(dcache_lookup(&dir, name, &node));
+    ASSERT_NULL(node);
+    
+    dcache_invalidate_dir(&dir);
+    ASSERT_FALSE(dcache_lookup(&dir, name, &node));
+}
+
+// ============================================================================
+// 深层路径解析耗时
+// ============================================================================
+
+#define DCACHE_BENCH_PATH       "/DCA/DCB/DCC/DCD/DCE.TMP"
+#define DCACHE_BENCH_LOOKUPS    20000
+
+static uint32_t dcache_bench_run(bool flush) {
+    uint64_t t0 = timer_get_uptime_ms();
+    for (uint32_t i = 0; i < DCACHE_BENCH_LOOKUPS; i++) {
+        if (flush) {
+            dcache_flush();
+        }
+        fs_node_t *node = vfs_path_to_node(DCACHE_BENCH_PATH);
+        if (!node) {
+            return 0xFFFFFFFFU;
+        }
+        vfs_release_node(node);
+    }
+    return (uint32_t)(timer_get_uptime_ms() - t0);
+}
+
+TEST_CASE(test_dcache_deep_path_lookup) {
+    uint32_t perm = FS_PERM_READ | FS_PERM_WRITE | FS_PERM_EXEC;
+    ASSERT_EQ(vfs_mkdir("/DCA", perm), 0);
+    ASSERT_EQ(vfs_mkdir("/DCA/DCB", perm), 0);
+    ASSERT_EQ(vfs_mkdir("/DCA/DCB/DCC", perm), 0);
+    ASSERT_EQ(vfs_mkdir("/DCA/DCB/DCC/DCD", perm), 0);
+    ASSERT_EQ(vfs_create(DCACHE_BENCH_PATH), 0);
+    
+    uint32_t uncached = dcache_bench_run(true);
+    uint32_t cached = dcache_bench_run(false);
+    ASSERT_NE_UINT(uncached, 0xFFFFFFFFU);
+    ASSERT_NE_UINT(cached, 0xFFFFFFFFU);
+    
+    kprintf("  %u lookups of %s: %u ms uncached, %u ms cached\n",
+            DCACHE_BENCH_LOOKUPS, DCACHE_BENCH_PATH, uncached, cached);
+    
+    vfs_unlink(DCACHE_BENCH_PATH);
+    vfs_unlink("/DCA/DCB/DCC/DCD");
+    vfs_unlink("/DCA/DCB/DCC");
+    vfs_unlink("/DCA/DCB");
+    vfs_unlink("/DCA");
+}
+
+// ============================================================================
+// 测试套件定义
+// ============================================================================
+
+TEST_SUITE(dcache_basic_tests) {
+    RUN_TEST(test_dcache_positive_hit);
+    RUN_TEST(test_dcache_negative_entry);
+    RUN_TEST(test_dcache_rename_invalidates);
+    RUN_TEST(test_dcache_rmdir_purges_children);
+}
+
+TEST_SUITE(dcache_lru_tests) {
+    RUN_TEST(test_dcache_lru_eviction);
+}
+
+TEST_SUITE(dcache_benchmark_tests) {
+    RUN_TEST(test_dcache_deep_path_lookup);
+}
+
+// ============================================================================
+// 运行所有测试
+// ============================================================================
+
+void run_dcache_tests(void) {
+    // 初始化测试框架
+    unittest_init();
+    
+    // 运行所有测试套件
+    RUN_SUITE(dcache_basic_tests);
+    RUN_SUITE(dcache_lru_tests);
+    RUN_SUITE(dcache_benchmark_tests);
+    
+    // 打印测试摘要
+    unittest_print_summary();
+}
+
+// ============================================================================
+// 模块注册
+// ============================================================================
+
+TEST_MODULE_DESC(dcache, FS, run_dcache_tests,
+    "Dentry cache tests - positive/negative entries, invalidation, LRU, lookup cost");
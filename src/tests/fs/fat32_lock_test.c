@@ -0,0 +1,353 @@
+// ============================================================================
+// fat32_lock_test.c - FAT32 细粒度锁测试
+// ============================================================================
+//
+// 模块名称: fat32_lock
+// 子系统: fs (文件系统)
+// 描述: 在内存盘上格式化一个小 FAT32 卷，测试多个内核线程并发访问不同文件
+//
+// 功能覆盖:
+//   - 4 个线程并发读取不同文件：数据正确，I/O 等待互相重叠，
+//     聚合吞吐量明显高于逐个读取
+//   - 4 个线程并发追加写不同文件：簇分配互不冲突，数据不串
+// ============================================================================
+
+#include <tests/ktest.h>
+#include <tests/fs/fat32_lock_test.h>
+#include <tests/test_module.h>
+#include <fs/fat32.h>
+#include <fs/blockdev.h>
+#include <fs/vfs.h>
+#include <kernel/task.h>
+#include <drivers/timer.h>
+#include <mm/heap.h>
+#include <lib/kprintf.h>
+#include <lib/string.h>
+#include <types.h>
+
+// ============================================================================
+// 内存盘与格式化
+// ============================================================================
+
+#define FLT_SECTOR_SIZE     512
+#define FLT_TOTAL_SECTORS   4096            // 2 MB
+#define FLT_SPC             8               // 每簇 4 KB
+#define FLT_RESERVED        32
+#define FLT_FAT_SECTORS     4
+#define FLT_CLUSTER_SIZE    (FLT_SECTOR_SIZE * FLT_SPC)
+
+#define FLT_THREADS         4
+#define FLT_FILE_SIZE       (4 * FLT_CLUSTER_SIZE)
+#define FLT_READ_PASSES     2
+#define FLT_IO_LATENCY_MS   10              // 模拟磁盘读取数据簇的等待
+#define FLT_TIMEOUT_MS      30000
+
+static uint8_t *flt_image = NULL;
+static volatile uint32_t flt_latency_ms = 0;
+static blockdev_t flt_dev;
+
+static int flt_dev_read(void *dev, uint32_t sector, uint32_t count, uint8_t *buffer) {
+    (void)dev;
+    memcpy(buffer, flt_image + sector * FLT_SECTOR_SIZE, count * FLT_SECTOR_SIZE);
+    // 只有整簇读取（数据）等待，FAT 表项的单扇区读取不等待
+    if (flt_latency_ms && count > 1) {
+        task_sleep(flt_latency_ms);
+    }
+    return 0;
+}
+
+static int flt_dev_write(void *dev, uint32_t sector, uint32_t count, const uint8_t *buffer) {
+    (void)dev;
+    memcpy(flt_image + sector * FLT_SECTOR_SIZE, buffer, count * FLT_SECTOR_SIZE);
+    return 0;
+}
+
+static void flt_put16(uint8_t *p, uint16_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void flt_put32(uint8_t *p, uint32_t v) {
+    flt_put16(p, (uint16_t)v);
+    flt_put16(p + 2, (uint16_t)(v >> 16));
+}
+
+/* 写入 BPB 和两份 FAT（簇 0、1 保留，簇 2 为空的根目录） */
+static void flt_format(void) {
+    memset(flt_image, 0, FLT_TOTAL_SECTORS * FLT_SECTOR_SIZE);
+
+    uint8_t *bpb = flt_image;
+    bpb[0] = 0xEB;
+    bpb[1] = 0x58;
+    bpb[2] = 0x90;
+    memcpy(bpb + 3, "MSWIN4.1", 8);
+    flt_put16(bpb + 11, FLT_SECTOR_SIZE);
+    bpb[13] = FLT_SPC;
+    flt_put16(bpb + 14, FLT_RESERVED);
+    bpb[16] = 2;                                // FAT 数量
+    bpb[21] = 0xF8;                             // 媒体类型
+    flt_put32(bpb + 32, FLT_TOTAL_SECTORS);
+    flt_put32(bpb + 36, FLT_FAT_SECTORS);
+    flt_put32(bpb + 44, 2);                     // 根目录簇
+    bpb[66] = 0x29;
+    memcpy(bpb + 71, "FLTTEST    ", 11);
+    memcpy(bpb + 82, "FAT32   ", 8);
+    flt_put16(bpb + 510, 0xAA55);
+
+    for (uint32_t i = 0; i < 2; i++) {
+        uint8_t *fat = flt_image + (FLT_RESERVED + i * FLT_FAT_SECTORS) * FLT_SECTOR_SIZE;
+        flt_put32(fat + 0, 0x0FFFFFF8);
+        flt_put32(fat + 4, 0x0FFFFFFF);
+        flt_put32(fat + 8, 0x0FFFFFFF);
+    }
+}
+
+static fs_node_t *flt_mount(void) {
+    flt_image = (uint8_t *)kmalloc(FLT_TOTAL_SECTORS * FLT_SECTOR_SIZE);
+    if (!flt_image) {
+        return NULL;
+    }
+    flt_format();
+
+    memset(&flt_dev, 0, sizeof(flt_dev));
+    strcpy(flt_dev.name, "fltram");
+    flt_dev.block_size = FLT_SECTOR_SIZE;
+    flt_dev.total_sectors = FLT_TOTAL_SECTORS;
+    flt_dev.read = flt_dev_read;
+    flt_dev.write = flt_dev_write;
+    flt_latency_ms = 0;
+
+    fs_node_t *root = fat32_init(&flt_dev);
+    if (!root) {
+        kfree(flt_image);
+        flt_image = NULL;
+    }
+    return root;
+}
+
+static void flt_unmount(fs_node_t *root) {
+    fat32_deinit(root);
+    kfree(flt_image);
+    flt_image = NULL;
+}
+
+static void flt_name(char *buf, uint32_t id) {
+    strcpy(buf, "FILE0.BIN");
+    buf[4] = (char)('0' + id);
+}
+
+static uint8_t flt_pattern(uint32_t id, uint32_t off) {
+    return (uint8_t)(id * 31 + off * 7 + (off >> 9));
+}
+
+/* 在根目录中创建文件并返回节点（带一个引用） */
+static fs_node_t *flt_create(fs_node_t *root, uint32_t id) {
+    char name[16];
+    flt_name(name, id);
+    if (root->ops->create(root, name) != 0) {
+        return NULL;
+    }
+    return vfs_finddir(root, name);
+}
+
+// ============================================================================
+// 并发读取
+// ============================================================================
+
+static fs_node_t *flt_nodes[FLT_THREADS];
+static volatile uint32_t flt_next_id = 0;
+static volatile uint32_t flt_done = 0;
+static volatile uint32_t flt_errors = 0;
+
+/* 以 1 KB 为单位读完整个文件并校验，重复 FLT_READ_PASSES 次 */
+static void flt_read_file(uint32_t id) {
+    uint8_t buf[1024];
+    for (uint32_t pass = 0; pass < FLT_READ_PASSES; pass++) {
+        for (uint32_t off = 0; off < FLT_FILE_SIZE; off += sizeof(buf)) {
+            if (vfs_read(flt_nodes[id], off, sizeof(buf), buf) != sizeof(buf)) {
+                __atomic_fetch_add(&flt_errors, 1, __ATOMIC_RELAXED);
+                return;
+            }
+            for (uint32_t i = 0; i < sizeof(buf); i++) {
+                if (buf[i] != flt_pattern(id, off + i)) {
+                    __atomic_fetch_add(&flt_errors, 1, __ATOMIC_RELAXED);
+                    return;
+                }
+            }
+        }
+    }
+}
+
+static void flt_reader_thread(void) {
+    uint32_t id = __atomic_fetch_add(&flt_next_id, 1, __ATOMIC_RELAXED);
+    flt_read_file(id);
+    __atomic_fetch_add(&flt_done, 1, __ATOMIC_RELEASE);
+}
+
+static bool flt_wait_done(uint64_t t0) {
+    while (__atomic_load_n(&flt_done, __ATOMIC_ACQUIRE) < FLT_THREADS) {
+        if (timer_get_uptime_ms() - t0 > FLT_TIMEOUT_MS) {
+            return false;
+        }
+        task_yield();
+    }
+    return true;
+}
+
+TEST_CASE(test_fat32_concurrent_readers) {
+    fs_node_t *root = flt_mount();
+    ASSERT_NOT_NULL(root);
+
+    // 每个文件先整簇写入，避免 1 KB 写入触发读-改-写
+    uint8_t *data = (uint8_t *)kmalloc(FLT_FILE_SIZE);
+    ASSERT_NOT_NULL(data);
+    for (uint32_t id = 0; id < FLT_THREADS; id++) {
+        flt_nodes[id] = flt_create(root, id);
+        ASSERT_NOT_NULL(flt_nodes[id]);
+        for (uint32_t i = 0; i < FLT_FILE_SIZE; i++) {
+            data[i] = flt_pattern(id, i);
+        }
+        ASSERT_EQ_UINT(vfs_write(flt_nodes[id], 0, FLT_FILE_SIZE, data), FLT_FILE_SIZE);
+    }
+    kfree(data);
+
+    flt_latency_ms = FLT_IO_LATENCY_MS;
+
+    // 基准：同一任务逐个读取
+    flt_errors = 0;
+    uint64_t t0 = timer_get_uptime_ms();
+    for (uint32_t id = 0; id < FLT_THREADS; id++) {
+        flt_read_file(id);
+    }
+    uint32_t serial_ms = (uint32_t)(timer_get_uptime_ms() - t0);
+    ASSERT_EQ_UINT(flt_errors, 0);
+
+    // 4 个线程各读一个文件
+    flt_next_id = 0;
+    flt_done = 0;
+    t0 = timer_get_uptime_ms();
+    for (uint32_t id = 0; id < FLT_THREADS; id++) {
+        ASSERT_NE_UINT(task_create_kernel_thread(flt_reader_thread, "fat32_rd"), 0);
+    }
+    bool finished = flt_wait_done(t0);
+    uint32_t parallel_ms = (uint32_t)(timer_get_uptime_ms() - t0);
+
+    flt_latency_ms = 0;
+    ASSERT_TRUE(finished);
+    ASSERT_EQ_UINT(flt_errors, 0);
+
+    uint32_t total_kb = FLT_THREADS * FLT_READ_PASSES * FLT_FILE_SIZE / 1024;
+    kprintf("    %u KB: serial %u ms (%u KB/s), %u threads %u ms (%u KB/s)\n",
+            total_kb, serial_ms, serial_ms ? total_kb * 1000 / serial_ms : 0,
+            FLT_THREADS, parallel_ms, parallel_ms ? total_kb * 1000 / parallel_ms : 0);
+
+    // 一个文件的 I/O 等待不再阻塞其它文件：至少快一倍
+    ASSERT_TRUE(parallel_ms * 2 < serial_ms);
+
+    // 超时时线程仍在访问卷，不能卸载
+    if (finished) {
+        for (uint32_t id = 0; id < FLT_THREADS; id++) {
+            vfs_release_node(flt_nodes[id]);
+        }
+        flt_unmount(root);
+    }
+}
+
+// ============================================================================
+// 并发写入
+// ============================================================================
+
+static void flt_writer_thread(void) {
+    uint32_t id = __atomic_fetch_add(&flt_next_id, 1, __ATOMIC_RELAXED);
+    uint8_t buf[1024];
+
+    // 小块追加：每个线程反复扩展自己的簇链，与其它线程交错分配簇
+    for (uint32_t off = 0; off < FLT_FILE_SIZE; off += sizeof(buf)) {
+        for (uint32_t i = 0; i < sizeof(buf); i++) {
+            buf[i] = flt_pattern(id, off + i);
+        }
+        if (vfs_write(flt_nodes[id], off, sizeof(buf), buf) != sizeof(buf)) {
+            __atomic_fetch_add(&flt_errors, 1, __ATOMIC_RELAXED);
+            break;
+        }
+        task_yield();
+    }
+    __atomic_fetch_add(&flt_done, 1, __ATOMIC_RELEASE);
+}
+
+TEST_CASE(test_fat32_concurrent_writers) {
+    fs_node_t *root = flt_mount();
+    ASSERT_NOT_NULL(root);
+
+    for (uint32_t id = 0; id < FLT_THREADS; id++) {
+        flt_nodes[id] = flt_create(root, id);
+        ASSERT_NOT_NULL(flt_nodes[id]);
+    }
+
+    flt_next_id = 0;
+    flt_done = 0;
+    flt_errors = 0;
+    uint64_t t0 = timer_get_uptime_ms();
+    for (uint32_t id = 0; id < FLT_THREADS; id++) {
+        ASSERT_NE_UINT(task_create_kernel_thread(flt_writer_thread, "fat32_wr"), 0);
+    }
+    bool finished = flt_wait_done(t0);
+    ASSERT_TRUE(finished);
+    ASSERT_EQ_UINT(flt_errors, 0);
+
+    // 每个文件都完整且只包含自己的数据
+    for (uint32_t id = 0; id < FLT_THREADS; id++) {
+        ASSERT_EQ_UINT(flt_nodes[id]->size, FLT_FILE_SIZE);
+    }
+    flt_errors = 0;
+    for (uint32_t id = 0; id < FLT_THREADS; id++) {
+        flt_read_file(id);
+    }
+    ASSERT_EQ_UINT(flt_errors, 0);
+
+    // 释放后重新查找：节点从目录项重建，大小已写回磁盘
+    for (uint32_t id = 0; id < FLT_THREADS; id++) {
+        vfs_release_node(flt_nodes[id]);
+    }
+    for (uint32_t id = 0; id < FLT_THREADS; id++) {
+        char name[16];
+        flt_name(name, id);
+        fs_node_t *node = vfs_finddir(root, name);
+        ASSERT_NOT_NULL(node);
+        ASSERT_EQ_UINT(node->size, FLT_FILE_SIZE);
+        vfs_release_node(node);
+    }
+
+    flt_unmount(root);
+}
+
+// ============================================================================
+// 测试套件定义
+// ============================================================================
+
+TEST_SUITE(fat32_lock_tests) {
+    RUN_TEST(test_fat32_concurrent_readers);
+    RUN_TEST(test_fat32_concurrent_writers);
+}
+
+// ============================================================================
+// 运行所有测试
+// ============================================================================
+
+void run_fat32_lock_tests(void) {
+    // 初始化测试框架
+    unittest_init();
+
+    // 运行所有测试套件
+    RUN_SUITE(fat32_lock_tests);
+
+    // 打印测试摘要
+    unittest_print_summary();
+}
+
+// ============================================================================
+// 模块注册
+// ============================================================================
+
+TEST_MODULE_DESC(fat32_lock, FS, run_fat32_lock_tests,
+    "FAT32 fine-grained locking - concurrent readers and writers on a RAM disk");
@@ -0,0 +1,123 @@
+// ============================================================================
+// icache_test.c - inode 缓存单元测试
+// ============================================================================
+//
+// 模块名称: icache
+// 子系统: fs (文件系统)
+// 描述: 测试 FAT32 节点经 inode 缓存共享
+//
+// 功能覆盖:
+//   - 同一文件的多次查找返回同一节点，写入对所有打开者可见
+//   - 空文件（没有簇）的 inode 编号互不相同
+//   - 删除后重建的同名文件不复用旧节点
+//   - 同类节点共享同一操作表
+// ============================================================================
+
+#include <tests/ktest.h>
+#include <tests/fs/icache_test.h>
+#include <tests/test_module.h>
+#include <fs/dcache.h>
+#include <fs/vfs.h>
+#include <lib/string.h>
+#include <types.h>
+
+// ============================================================================
+// 节点共享
+// ============================================================================
+
+TEST_CASE(test_icache_shared_node) {
+    vfs_unlink("/ICSHR.TMP");
+    ASSERT_EQ(vfs_create("/ICSHR.TMP"), 0);
+    
+    fs_node_t *a = vfs_path_to_node("/ICSHR.TMP");
+    ASSERT_NOT_NULL(a);
+    
+    // 清空目录项缓存，第二次查找走文件系统的 finddir
+    dcache_flush();
+    fs_node_t *b = vfs_path_to_node("/icshr.tmp");
+    ASSERT_NOT_NULL(b);
+    ASSERT_TRUE(a == b);
+    
+    uint8_t data[16];
+    memset(data, 'x', sizeof(data));
+    ASSERT_EQ_UINT(vfs_write(a, 0, sizeof(data), data), sizeof(data));
+    ASSERT_EQ_UINT(b->size, sizeof(data));
+    
+    vfs_release_node(b);
+    vfs_release_node(a);
+    vfs_unlink("/ICSHR.TMP");
+}
+
+TEST_CASE(test_icache_empty_files_distinct) {
+    vfs_unlink("/ICEMP1.TMP");
+    vfs_unlink("/ICEMP2.TMP");
+    ASSERT_EQ(vfs_create("/ICEMP1.TMP"), 0);
+    ASSERT_EQ(vfs_create("/ICEMP2.TMP"), 0);
+    
+    fs_node_t *a = vfs_path_to_node("/ICEMP1.TMP");
+    fs_node_t *b = vfs_path_to_node("/ICEMP2.TMP");
+    ASSERT_NOT_NULL(a);
+    ASSERT_NOT_NULL(b);
+    
+    // 两个文件都还没有簇，编号仍然不同，也不会共享节点
+    ASSERT_TRUE(a != b);
+    ASSERT_TRUE(a->inode != b->inode);
+    ASSERT_TRUE(a->ops == b->ops);
+    
+    vfs_release_node(b);
+    vfs_release_node(a);
+    vfs_unlink("/ICEMP1.TMP");
+    vfs_unlink("/ICEMP2.TMP");
+}
+
+TEST_CASE(test_icache_unlink_detaches) {
+    vfs_unlink("/ICDEL.TMP");
+    ASSERT_EQ(vfs_create("/ICDEL.TMP"), 0);
+    
+    fs_node_t *old = vfs_path_to_node("/ICDEL.TMP");
+    ASSERT_NOT_NULL(old);
+    
+    // 删除后重建：新文件很可能落在同一目录项槽位上（相同编号）
+    ASSERT_EQ(vfs_unlink("/ICDEL.TMP"), 0);
+    ASSERT_EQ(vfs_create("/ICDEL.TMP"), 0);
+    
+    fs_node_t *fresh = vfs_path_to_node("/ICDEL.TMP");
+    ASSERT_NOT_NULL(fresh);
+    ASSERT_TRUE(fresh != old);
+    
+    vfs_release_node(fresh);
+    vfs_release_node(old);
+    vfs_unlink("/ICDEL.TMP");
+}
+
+// ============================================================================
+// 测试套件定义
+// ============================================================================
+
+TEST_SUITE(icache_tests) {
+    RUN_TEST(test_icache_shared_node);
+    RUN_TEST(test_icache_empty_files_distinct);
+    RUN_TEST(test_icache_unlink_detaches);
+}
+
+// ============================================================================
+// 运行所有测试
+// ============================================================================
+
+void run_icache_tests(void) {
+    // 初始化测试框架
+    unittest_init();
+    
+    // 运行所有测试套件
+    RUN_SUITE(icache_tests);
+    
+    // 打印测试摘要
+    unittest_print_summary();
+}
+
+// ============================================================================
+// 模块注册
+// ============================================================================
+
+TEST_MODULE_DESC(icache, FS, run_icache_tests,
+    "Inode cache tests - shared FAT32 nodes, inode numbering, unlink detach");
@@ -0,0 +1,346 @@
+// ============================================================================
+// pipe_test.c - 管道单元测试
+// ============================================================================
+//
+// 模块名称: pipe
+// 子系统: fs (文件系统)
+// 描述: 测试管道环形缓冲区、缓冲区大小调整和吞吐量
+//
+// 功能覆盖:
+//   - 读写与环形缓冲区回绕
+//   - pipe_set_size(): 取整、上限、保留已有数据
+//   - vfs_poll(): 读端/写端就绪状态
+//   - 两个内核线程之间的吞吐量基准（默认 1 MB，make bench 为 64 MB）
+// ============================================================================
+
+#include <tests/ktest.h>
+#include <tests/fs/pipe_test.h>
+#include <tests/test_module.h>
+#include <fs/pipe.h>
+#include <fs/poll.h>
+#include <fs/vfs.h>
+#include <kernel/task.h>
+#include <drivers/timer.h>
+#include <mm/heap.h>
+#include <lib/kprintf.h>
+#include <lib/string.h>
+#include <types.h>
+
+// ============================================================================
+// 测试辅助函数
+// ============================================================================
+
+static fs_node_t *pipe_test_rnode = NULL;
+static fs_node_t *pipe_test_wnode = NULL;
+
+static bool pipe_test_open(void) {
+    pipe_test_rnode = NULL;
+    pipe_test_wnode = NULL;
+    return pipe_create(&pipe_test_rnode, &pipe_test_wnode) == 0;
+}
+
+static void pipe_test_close(void) {
+    if (pipe_test_wnode) {
+        vfs_close(pipe_test_wnode);
+        vfs_release_node(pipe_test_wnode);
+        pipe_test_wnode = NULL;
+    }
+    if (pipe_test_rnode) {
+        vfs_close(pipe_test_rnode);
+        vfs_release_node(pipe_test_rnode);
+        pipe_test_rnode = NULL;
+    }
+}
+
+static void pipe_test_fill(uint8_t *buf, uint32_t len, uint32_t seed) {
+    for (uint32_t i = 0; i < len; i++) {
+        buf[i] = (uint8_t)(seed + i * 7);
+    }
+}
+
+// ============================================================================
+// 基本读写测试
+// ============================================================================
+
+TEST_CASE(test_pipe_create_default_size) {
+    ASSERT_TRUE(pipe_test_open());
+    ASSERT_EQ(pipe_get_size(pipe_test_rnode), PIPE_DEFAULT_SIZE);
+    ASSERT_EQ(pipe_get_size(pipe_test_wnode), PIPE_DEFAULT_SIZE);
+    pipe_test_close();
+}
+
+TEST_CASE(test_pipe_read_write_wrap) {
+    static uint8_t src[3000];
+    static uint8_t dst[3000];
+    
+    ASSERT_TRUE(pipe_test_open());
+    ASSERT_EQ(pipe_set_size(pipe_test_wnode, PIPE_MIN_SIZE), PIPE_MIN_SIZE);
+    
+    // 读写位置推进到缓冲区尾部附近
+    pipe_test_fill(src, sizeof(src), 1);
+    ASSERT_EQ_UINT(vfs_write(pipe_test_wnode, 0, sizeof(src), src), sizeof(src));
+    ASSERT_EQ_UINT(vfs_read(pipe_test_rnode, 0, sizeof(dst), dst), sizeof(dst));
+    ASSERT_EQ(memcmp(src, dst, sizeof(src)), 0);
+    
+    // 第二次写入跨越缓冲区末尾回绕
+    pipe_test_fill(src, sizeof(src), 99);
+    ASSERT_EQ_UINT(vfs_write(pipe_test_wnode, 0, sizeof(src), src), sizeof(src));
+    ASSERT_EQ_UINT(vfs_read(pipe_test_rnode, 0, sizeof(dst), dst), sizeof(dst));
+    ASSERT_EQ(memcmp(src, dst, sizeof(src)), 0);
+    
+    pipe_test_close();
+}
+
+TEST_CASE(test_pipe_short_read) {
+    uint8_t src[100];
+    uint8_t dst[200];
+    
+    ASSERT_TRUE(pipe_test_open());
+    pipe_test_fill(src, sizeof(src), 5);
+    ASSERT_EQ_UINT(vfs_write(pipe_test_wnode, 0, sizeof(src), src), sizeof(src));
+    
+    // 有多少读多少，不阻塞等待填满
+    ASSERT_EQ_UINT(vfs_read(pipe_test_rnode, 0, sizeof(dst), dst), sizeof(src));
+    ASSERT_EQ(memcmp(src, dst, sizeof(src)), 0);
+    
+    pipe_test_close();
+}
+
+TEST_CASE(test_pipe_eof_after_write_close) {
+    uint8_t buf[16];
+    
+    ASSERT_TRUE(pipe_test_open());
+    vfs_close(pipe_test_wnode);
+    vfs_release_node(pipe_test_wnode);
+    pipe_test_wnode = NULL;
+    
+    ASSERT_EQ_UINT(vfs_read(pipe_test_rnode, 0, sizeof(buf), buf), 0);
+    pipe_test_close();
+}
+
+// ============================================================================
+// 缓冲区大小调整测试
+// ============================================================================
+
+TEST_CASE(test_pipe_set_size_rounds_up) {
+    ASSERT_TRUE(pipe_test_open());
+    ASSERT_EQ(pipe_set_size(pipe_test_wnode, 5000), 8192);
+    ASSERT_EQ(pipe_get_size(pipe_test_rnode), 8192);
+    ASSERT_EQ(pipe_set_size(pipe_test_wnode, 1), PIPE_MIN_SIZE);
+    pipe_test_close();
+}
+
+TEST_CASE(test_pipe_set_size_limits) {
+    ASSERT_TRUE(pipe_test_open());
+    ASSERT_EQ(pipe_set_size(pipe_test_wnode, PIPE_MAX_SIZE), PIPE_MAX_SIZE);
+    ASSERT_EQ(pipe_set_size(pipe_test_wnode, PIPE_MAX_SIZE + 1), -1);
+    ASSERT_EQ(pipe_set_size(pipe_test_wnode, 0), -1);
+    ASSERT_EQ(pipe_get_size(pipe_test_wnode), PIPE_MAX_SIZE);
+    pipe_test_close();
+}
+
+TEST_CASE(test_pipe_set_size_preserves_data) {
+    static uint8_t src[6000];
+    static uint8_t dst[6000];
+    
+    ASSERT_TRUE(pipe_test_open());
+    ASSERT_EQ(pipe_set_size(pipe_test_wnode, 8192), 8192);
+    
+    // 制造回绕状态：先推进读写位置
+    pipe_test_fill(src, 5000, 3);
+    vfs_write(pipe_test_wnode, 0, 5000, src);
+    vfs_read(pipe_test_rnode, 0, 5000, dst);
+    
+    pipe_test_fill(src, sizeof(src), 42);
+    ASSERT_EQ_UINT(vfs_write(pipe_test_wnode, 0, sizeof(src), src), sizeof(src));
+    
+    // 现有数据放不下时拒绝缩小
+    ASSERT_EQ(pipe_set_size(pipe_test_wnode, PIPE_MIN_SIZE), -1);
+    
+    // 扩容后数据顺序不变
+    ASSERT_EQ(pipe_set_size(pipe_test_wnode, 65536), 65536);
+    ASSERT_EQ_UINT(vfs_read(pipe_test_rnode, 0, sizeof(dst), dst), sizeof(dst));
+    ASSERT_EQ(memcmp(src, dst, sizeof(src)), 0);
+    
+    pipe_test_close();
+}
+
+TEST_CASE(test_pipe_poll_state) {
+    uint8_t byte = 0x5a;
+    
+    ASSERT_TRUE(pipe_test_open());
+    ASSERT_EQ_UINT(vfs_poll(pipe_test_rnode, NULL) & POLLIN, 0);
+    ASSERT_EQ_UINT(vfs_poll(pipe_test_wnode, NULL) & POLLOUT, POLLOUT);
+    
+    vfs_write(pipe_test_wnode, 0, 1, &byte);
+    ASSERT_EQ_UINT(vfs_poll(pipe_test_rnode, NULL) & POLLIN, POLLIN);
+    
+    pipe_test_close();
+}
+
+// ============================================================================
+// 吞吐量基准：两个内核线程之间传输数据（默认冒烟规模）
+// ============================================================================
+
+#define PIPE_BENCH_BYTES    KTEST_BENCH_SIZE(64U * 1024 * 1024, 1024U * 1024)
+#define PIPE_BENCH_CHUNK    (64U * 1024)
+#define PIPE_BENCH_TIMEOUT  120000          // 毫秒
+
+static uint8_t *pipe_bench_wbuf = NULL;
+static uint8_t *pipe_bench_rbuf = NULL;
+static volatile uint32_t pipe_bench_written = 0;
+static volatile uint32_t pipe_bench_read = 0;
+static volatile uint32_t pipe_bench_sum = 0;
+static volatile bool pipe_bench_writer_done = false;
+static volatile bool pipe_bench_reader_done = false;
+
+static void pipe_bench_writer(void) {
+    uint32_t total = 0;
+    while (total < PIPE_BENCH_BYTES) {
+        uint32_t n = vfs_write(pipe_test_wnode, 0, PIPE_BENCH_CHUNK, pipe_bench_wbuf);
+        if (n == 0) {
+            break;
+        }
+        total += n;
+    }
+    pipe_bench_written = total;
+    pipe_bench_writer_done = true;
+}
+
+static void pipe_bench_reader(void) {
+    uint32_t total = 0;
+    uint32_t sum = 0;
+    while (total < PIPE_BENCH_BYTES) {
+        uint32_t n = vfs_read(pipe_test_rnode, 0, PIPE_BENCH_CHUNK, pipe_bench_rbuf);
+        if (n == 0) {
+            break;
+        }
+        // 只抽查首字节，避免校验本身成为瓶颈
+        sum += pipe_bench_rbuf[0];
+        total += n;
+    }
+    pipe_bench_read = total;
+    pipe_bench_sum = sum;
+    pipe_bench_reader_done = true;
+}
+
+/**
+ * 运行一轮基准
+ * @return 两个线程都已结束返回 true；超时时线程仍在使用管道和缓冲区，返回 false
+ */
+static bool pipe_bench_run(uint32_t pipe_size) {
+    ASSERT_TRUE(pipe_test_open());
+    ASSERT_EQ(pipe_set_size(pipe_test_wnode, pipe_size), (int)pipe_size);
+    
+    pipe_bench_written = 0;
+    pipe_bench_read = 0;
+    pipe_bench_writer_done = false;
+    pipe_bench_reader_done = false;
+    
+    uint64_t t0 = timer_get_uptime_ms();
+    ASSERT_NE_UINT(task_create_kernel_thread(pipe_bench_reader, "pipe_bench_rd"), 0);
+    ASSERT_NE_UINT(task_create_kernel_thread(pipe_bench_writer, "pipe_bench_wr"), 0);
+    
+    while (!(pipe_bench_writer_done && pipe_bench_reader_done)) {
+        if (timer_get_uptime_ms() - t0 > PIPE_BENCH_TIMEOUT) {
+            break;
+        }
+        task_yield();
+    }
+    uint64_t elapsed = timer_get_uptime_ms() - t0;
+    
+    ASSERT_TRUE(pipe_bench_writer_done);
+    ASSERT_TRUE(pipe_bench_reader_done);
+    
+    // 超时时线程仍在使用管道，不能释放
+    if (!(pipe_bench_writer_done && pipe_bench_reader_done)) {
+        return false;
+    }
+    
+    ASSERT_EQ_UINT(pipe_bench_written, PIPE_BENCH_BYTES);
+    ASSERT_EQ_UINT(pipe_bench_read, PIPE_BENCH_BYTES);
+    
+    uint32_t ms = (uint32_t)elapsed;
+    kprintf("    pipe %7u bytes: %u ms, %u MB/s\n", pipe_size, ms,
+            ms ? (PIPE_BENCH_BYTES / 1024) / ms : PIPE_BENCH_BYTES / (1024 * 1024));
+    
+    pipe_test_close();
+    return true;
+}
+
+TEST_CASE(test_pipe_throughput) {
+    pipe_bench_wbuf = (uint8_t *)kmalloc(PIPE_BENCH_CHUNK);
+    pipe_bench_rbuf = (uint8_t *)kmalloc(PIPE_BENCH_CHUNK);
+    ASSERT_NOT_NULL(pipe_bench_wbuf);
+    ASSERT_NOT_NULL(pipe_bench_rbuf);
+    if (!pipe_bench_wbuf || !pipe_bench_rbuf) {
+        kfree(pipe_bench_wbuf);
+        kfree(pipe_bench_rbuf);
+        return;
+    }
+    pipe_test_fill(pipe_bench_wbuf, PIPE_BENCH_CHUNK, 0);
+    
+    kprintf("  pipe throughput (%u KB, %u KB chunks):\n", PIPE_BENCH_BYTES / 1024,
+            PIPE_BENCH_CHUNK / 1024);
+    
+    // 超时的线程还在使用共享的全局状态：不再开始下一轮，缓冲区也不能释放
+    if (!pipe_bench_run(PIPE_DEFAULT_SIZE) || !pipe_bench_run(PIPE_MAX_SIZE)) {
+        kprintf("    timed out, buffers leaked\n");
+        return;
+    }
+    
+    kfree(pipe_bench_wbuf);
+    kfree(pipe_bench_rbuf);
+    pipe_bench_wbuf = NULL;
+    pipe_bench_rbuf = NULL;
+}
+
+// ============================================================================
+// 测试套件定义
+// ============================================================================
+
+TEST_SUITE(pipe_basic_tests) {
+    RUN_TEST(test_pipe_create_default_size);
+    RUN_TEST(test_pipe_read_write_wrap);
+    RUN_TEST(test_pipe_short_read);
+    RUN_TEST(test_pipe_eof_after_write_close);
+}
+
+TEST_SUITE(pipe_size_tests) {
+    RUN_TEST(test_pipe_set_size_rounds_up);
+    RUN_TEST(test_pipe_set_size_limits);
+    RUN_TEST(test_pipe_set_size_preserves_data);
+}
+
+TEST_SUITE(pipe_poll_tests) {
+    RUN_TEST(test_pipe_poll_state);
+}
+
+TEST_SUITE(pipe_benchmark_tests) {
+    RUN_TEST(test_pipe_throughput);
+}
+
+// ============================================================================
+// 运行所有测试
+// ============================================================================
+
+void run_pipe_tests(void) {
+    // 初始化测试框架
+    unittest_init();
+    
+    // 运行所有测试套件
+    RUN_SUITE(pipe_basic_tests);
+    RUN_SUITE(pipe_size_tests);
+    RUN_SUITE(pipe_poll_tests);
+    RUN_SUITE(pipe_benchmark_tests);
+    
+    // 打印测试摘要
+    unittest_print_summary();
+}
+
+// ============================================================================
+// 模块注册
+// ============================================================================
+
+TEST_MODULE_DESC(pipe, FS, run_pipe_tests,
+    "Pipe tests - ring buffer copies, buffer resizing, poll state, throughput");
@@ -0,0 +1,372 @@
+// ============================================================================
+// poll_test.c - epoll / select 测试
+// ============================================================================
+//
+// 模块名称: poll
+// 子系统: fs (文件系统)
+// 描述: 在管道和 UDP socket 上检查 epoll_ctl/epoll_wait 与 select 的就绪和阻塞唤醒
+//
+// 功能覆盖:
+//   - epoll_ctl ADD/MOD/DEL：重复添加和删除不存在的项失败，MOD 更新用户数据
+//   - epoll_wait：管道无数据时超时，有数据时报告 EPOLLIN，阻塞后被写端唤醒
+//   - select 管道描述符：无数据时超时，阻塞后被写端唤醒
+//   - select socket 描述符：阻塞后被到达的 UDP 数据报唤醒
+// ============================================================================
+
+#include <tests/ktest.h>
+#include <tests/fs/poll_test.h>
+#include <tests/test_module.h>
+#include <fs/eventpoll.h>
+#include <fs/pipe.h>
+#include <fs/poll.h>
+#include <fs/vfs.h>
+#include <kernel/fd_table.h>
+#include <kernel/syscalls/fs.h>
+#include <kernel/task.h>
+#include <net/socket.h>
+#include <net/netbuf.h>
+#include <net/netdev.h>
+#include <net/udp.h>
+#include <net/ip.h>
+#include <drivers/timer.h>
+#include <mm/heap.h>
+#include <lib/kprintf.h>
+#include <lib/string.h>
+#include <types.h>
+
+#define PT_DELAY_MS         50
+#define PT_TIMEOUT_MS       5000
+#define PT_UDP_PORT         40123
+#define PT_EPOLL_DATA       7
+#define PT_EPOLL_DATA_MOD   9
+
+// ============================================================================
+// 辅助函数
+// ============================================================================
+
+/* 测试运行在没有 fd 表的内核任务里，临时挂一张 */
+static fd_table_t *pt_table;
+static fs_node_t *pt_rnode;
+static fs_node_t *pt_wnode;
+static int pt_rfd;
+static int pt_wfd;
+
+static void pt_teardown(void) {
+    task_t *current = task_get_current();
+    if (!pt_table) {
+        return;
+    }
+    for (int fd = 0; fd < MAX_FDS; fd++) {
+        if (pt_table->entries[fd].in_use) {
+            fd_table_free(pt_table, fd);
+        }
+    }
+    current->fd_table = NULL;
+    kfree(pt_table);
+    pt_table = NULL;
+}
+
+static bool pt_setup(void) {
+    task_t *current = task_get_current();
+    if (!current || current->fd_table) {
+        return false;
+    }
+    pt_table = (fd_table_t *)kmalloc(sizeof(fd_table_t));
+    if (!pt_table) {
+        return false;
+    }
+    fd_table_init(pt_table);
+    current->fd_table = pt_table;
+
+    pt_rfd = -1;
+    pt_wfd = -1;
+    if (pipe_create(&pt_rnode, &pt_wnode) != 0) {
+        pt_teardown();
+        return false;
+    }
+    // fd_table_alloc 增加引用，之后释放 pipe_create 的初始引用
+    pt_rfd = fd_table_alloc(pt_table, pt_rnode, O_RDONLY);
+    pt_wfd = fd_table_alloc(pt_table, pt_wnode, O_WRONLY);
+    vfs_release_node(pt_rnode);
+    vfs_release_node(pt_wnode);
+    if (pt_rfd < 0 || pt_wfd < 0) {
+        pt_teardown();
+        return false;
+    }
+    return true;
+}
+
+/* 读空管道，避免上一项测试的数据影响下一项 */
+static void pt_drain(void) {
+    uint8_t buf[16];
+    while (vfs_poll(pt_rnode, NULL) & POLLIN) {
+        vfs_read(pt_rnode, 0, sizeof(buf), buf);
+    }
+}
+
+static void pt_wait_done(volatile bool *done) {
+    uint64_t t0 = timer_get_uptime_ms();
+    while (!__atomic_load_n(done, __ATOMIC_ACQUIRE) &&
+           timer_get_uptime_ms() - t0 < PT_TIMEOUT_MS) {
+        task_yield();
+    }
+}
+
+/* 延迟写管道的线程：保证调用方先进入阻塞 */
+static volatile bool pt_writer_done;
+
+static void pt_writer_thread(void) {
+    uint8_t byte = 'x';
+    task_sleep(PT_DELAY_MS);
+    vfs_write(pt_wnode, 0, 1, &byte);
+    __atomic_store_n(&pt_writer_done, true, __ATOMIC_RELEASE);
+}
+
+/* 延迟注入 UDP 数据报的线程：绕过网卡直接交给 udp_input */
+static netdev_t pt_dev;
+static volatile bool pt_injector_done;
+
+static void pt_injector_thread(void) {
+    static const char payload[] = "ping";
+    task_sleep(PT_DELAY_MS);
+
+    netbuf_t *buf = netbuf_alloc(sizeof(udp_header_t) + sizeof(payload));
+    if (buf) {
+        udp_header_t *udp = (udp_header_t *)netbuf_put(buf, sizeof(udp_header_t) + sizeof(payload));
+        udp->src_port = htons(PT_UDP_PORT + 1);
+        udp->dst_port = htons(PT_UDP_PORT);
+        udp->length = htons(sizeof(udp_header_t) + sizeof(payload));
+        udp->checksum = 0;      // 0 表示不校验
+        memcpy(udp + 1, payload, sizeof(payload));
+        udp_input(&pt_dev, buf, IP_ADDR(10, 0, 2, 2), IP_ADDR(10, 0, 2, 15));
+    }
+    __atomic_store_n(&pt_injector_done, true, __ATOMIC_RELEASE);
+}
+
+// ============================================================================
+// 测试用例：epoll
+// ============================================================================
+
+TEST_CASE(test_epoll_ctl_add_mod_del) {
+    bool ready = pt_setup();
+    ASSERT_TRUE(ready);
+
+    int epfd = sys_epoll_create(1);
+
+    struct epoll_event ev;
+    struct epoll_event out[2];
+    ev.events = EPOLLIN;
+    ev.data.u64 = PT_EPOLL_DATA;
+    int add_ret = sys_epoll_ctl(epfd, EPOLL_CTL_ADD, pt_rfd, &ev);
+    int dup_ret = sys_epoll_ctl(epfd, EPOLL_CTL_ADD, pt_rfd, &ev);
+    int empty_ret = sys_epoll_wait(epfd, out, 2, 0);
+
+    uint8_t byte = 'a';
+    vfs_write(pt_wnode, 0, 1, &byte);
+    memset(out, 0, sizeof(out));
+    int ready_ret = sys_epoll_wait(epfd, out, 2, 0);
+    uint32_t ready_events = out[0].events;
+    uint64_t ready_data = out[0].data.u64;
+
+    // 水平触发：数据未读走时再次报告，MOD 后带新的用户数据
+    ev.data.u64 = PT_EPOLL_DATA_MOD;
+    int mod_ret = sys_epoll_ctl(epfd, EPOLL_CTL_MOD, pt_rfd, &ev);
+    memset(out, 0, sizeof(out));
+    int mod_wait_ret = sys_epoll_wait(epfd, out, 2, 0);
+    uint64_t mod_data = out[0].data.u64;
+
+    int del_ret = sys_epoll_ctl(epfd, EPOLL_CTL_DEL, pt_rfd, NULL);
+    int del_wait_ret = sys_epoll_wait(epfd, out, 2, 0);
+    int del_again_ret = sys_epoll_ctl(epfd, EPOLL_CTL_DEL, pt_rfd, NULL);
+    int mod_missing_ret = sys_epoll_ctl(epfd, EPOLL_CTL_MOD, pt_rfd, &ev);
+
+    pt_teardown();
+
+    ASSERT_TRUE(epfd >= 0);
+    ASSERT_EQ(0, add_ret);
+    ASSERT_EQ(-1, dup_ret);
+    ASSERT_EQ(0, empty_ret);
+    ASSERT_EQ(1, ready_ret);
+    ASSERT_TRUE((ready_events & EPOLLIN) != 0);
+    ASSERT_TRUE(ready_data == PT_EPOLL_DATA);
+    ASSERT_EQ(0, mod_ret);
+    ASSERT_EQ(1, mod_wait_ret);
+    ASSERT_TRUE(mod_data == PT_EPOLL_DATA_MOD);
+    ASSERT_EQ(0, del_ret);
+    ASSERT_EQ(0, del_wait_ret);
+    ASSERT_EQ(-1, del_again_ret);
+    ASSERT_EQ(-1, mod_missing_ret);
+}
+
+TEST_CASE(test_epoll_wait_blocks_until_write) {
+    bool ready = pt_setup();
+    ASSERT_TRUE(ready);
+
+    int epfd = sys_epoll_create(1);
+    struct epoll_event ev;
+    struct epoll_event out;
+    ev.events = EPOLLIN;
+    ev.data.u64 = PT_EPOLL_DATA;
+    int add_ret = sys_epoll_ctl(epfd, EPOLL_CTL_ADD, pt_rfd, &ev);
+
+    pt_writer_done = false;
+    uint32_t pid = task_create_kernel_thread(pt_writer_thread, "poll_writer");
+
+    uint64_t t0 = timer_get_uptime_ms();
+    memset(&out, 0, sizeof(out));
+    int wait_ret = pid ? sys_epoll_wait(epfd, &out, 1, PT_TIMEOUT_MS) : -1;
+    uint32_t elapsed = (uint32_t)(timer_get_uptime_ms() - t0);
+    pt_wait_done(&pt_writer_done);
+
+    pt_drain();
+    pt_teardown();
+
+    ASSERT_TRUE(epfd >= 0);
+    ASSERT_EQ(0, add_ret);
+    ASSERT_NE_UINT(0, pid);
+    ASSERT_EQ(1, wait_ret);
+    ASSERT_TRUE((out.events & EPOLLIN) != 0);
+    ASSERT_TRUE(out.data.u64 == PT_EPOLL_DATA);
+    // 由写端唤醒返回，而不是等到超时
+    ASSERT_TRUE(elapsed < PT_TIMEOUT_MS);
+    ASSERT_TRUE(pt_writer_done);
+}
+
+// ============================================================================
+// 测试用例：select
+// ============================================================================
+
+TEST_CASE(test_select_pipe_timeout) {
+    bool ready = pt_setup();
+    ASSERT_TRUE(ready);
+
+    // 描述符号不能与 socket 重叠，否则 select 会按 socket 查询
+    bool is_file = (socket_poll(pt_rfd, NULL) & POLLNVAL) != 0;
+
+    fd_set readfds;
+    FD_ZERO(&readfds);
+    FD_SET(pt_rfd, &readfds);
+    struct timeval tv = { 0, PT_DELAY_MS * 1000 };
+    int empty_ret = sys_select(pt_rfd + 1, &readfds, NULL, NULL, &tv);
+
+    // 写端总是可写
+    fd_set writefds;
+    FD_ZERO(&writefds);
+    FD_SET(pt_wfd, &writefds);
+    tv.tv_usec = 0;
+    int write_ret = sys_select(pt_wfd + 1, NULL, &writefds, NULL, &tv);
+    bool writable = FD_ISSET(pt_wfd, &writefds);
+
+    pt_teardown();
+
+    ASSERT_TRUE(is_file);
+    ASSERT_EQ(0, empty_ret);
+    ASSERT_FALSE(FD_ISSET(pt_rfd, &readfds));
+    ASSERT_EQ(1, write_ret);
+    ASSERT_TRUE(writable);
+}
+
+TEST_CASE(test_select_pipe_blocks_until_write) {
+    bool ready = pt_setup();
+    ASSERT_TRUE(ready);
+
+    bool is_file = (socket_poll(pt_rfd, NULL) & POLLNVAL) != 0;
+
+    pt_writer_done = false;
+    uint32_t pid = task_create_kernel_thread(pt_writer_thread, "poll_writer");
+
+    fd_set readfds;
+    FD_ZERO(&readfds);
+    FD_SET(pt_rfd, &readfds);
+    struct timeval tv = { PT_TIMEOUT_MS / 1000, 0 };
+    uint64_t t0 = timer_get_uptime_ms();
+    int ret = pid ? sys_select(pt_rfd + 1, &readfds, NULL, NULL, &tv) : -1;
+    uint32_t elapsed = (uint32_t)(timer_get_uptime_ms() - t0);
+    pt_wait_done(&pt_writer_done);
+
+    pt_drain();
+    pt_teardown();
+
+    ASSERT_TRUE(is_file);
+    ASSERT_NE_UINT(0, pid);
+    ASSERT_EQ(1, ret);
+    ASSERT_TRUE(FD_ISSET(pt_rfd, &readfds));
+    ASSERT_TRUE(elapsed < PT_TIMEOUT_MS);
+    ASSERT_TRUE(pt_writer_done);
+}
+
+TEST_CASE(test_select_socket_blocks_until_datagram) {
+    int sock = sys_socket(AF_INET, SOCK_DGRAM, 0);
+    ASSERT_TRUE(sock >= 0);
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(PT_UDP_PORT);
+    addr.sin_addr = 0;
+    int bind_ret = sys_bind(sock, (struct sockaddr *)&addr, sizeof(addr));
+
+    memset(&pt_dev, 0, sizeof(pt_dev));
+    pt_injector_done = false;
+    uint32_t pid = bind_ret == 0 ? task_create_kernel_thread(pt_injector_thread, "poll_inject") : 0;
+
+    fd_set readfds;
+    FD_ZERO(&readfds);
+    FD_SET(sock, &readfds);
+    struct timeval tv = { PT_TIMEOUT_MS / 1000, 0 };
+    uint64_t t0 = timer_get_uptime_ms();
+    int ret = pid ? sys_select(sock + 1, &readfds, NULL, NULL, &tv) : -1;
+    uint32_t elapsed = (uint32_t)(timer_get_uptime_ms() - t0);
+    pt_wait_done(&pt_injector_done);
+
+    char data[16];
+    memset(data, 0, sizeof(data));
+    ssize_t n = ret == 1 ? sys_recvfrom(sock, data, sizeof(data), 0, NULL, NULL) : -1;
+    sys_closesocket(sock);
+
+    ASSERT_EQ(0, bind_ret);
+    ASSERT_NE_UINT(0, pid);
+    ASSERT_EQ(1, ret);
+    ASSERT_TRUE(FD_ISSET(sock, &readfds));
+    ASSERT_TRUE(elapsed < PT_TIMEOUT_MS);
+    ASSERT_EQ(5, (int)n);
+    ASSERT_STR_EQ("ping", data);
+}
+
+// ============================================================================
+// 测试套件定义
+// ============================================================================
+
+TEST_SUITE(epoll_tests) {
+    RUN_TEST(test_epoll_ctl_add_mod_del);
+    RUN_TEST(test_epoll_wait_blocks_until_write);
+}
+
+TEST_SUITE(select_tests) {
+    RUN_TEST(test_select_pipe_timeout);
+    RUN_TEST(test_select_pipe_blocks_until_write);
+    RUN_TEST(test_select_socket_blocks_until_datagram);
+}
+
+// ============================================================================
+// 运行所有测试
+// ============================================================================
+
+void run_poll_tests(void) {
+    // 初始化测试框架
+    unittest_init();
+
+    // 运行所有测试套件
+    RUN_SUITE(epoll_tests);
+    RUN_SUITE(select_tests);
+
+    // 打印测试摘要
+    unittest_print_summary();
+}
+
+// ============================================================================
+// 模块注册
+// ============================================================================
+
+TEST_MODULE_DESC(poll, FS, run_poll_tests,
+    "epoll/select - ctl ADD/MOD/DEL, blocking wait on pipes and UDP sockets");
@@ -0,0 +1,444 @@
+// ============================================================================
+// readahead_test.c - FAT32 预读测试
+// ============================================================================
+//
+// 模块名称: readahead
+// 子系统: fs (文件系统)
+// 描述: 在带请求队列的内存盘上格式化一个小 FAT32 卷，测试顺序读检测和预读
+//
+// 功能覆盖:
+//   - 顺序读：窗口扩大，绝大多数簇由预读提供，数据正确
+//   - 随机读：不发起预读
+//   - 写入已预读的簇后再读到的是新数据，旧预读计为浪费
+//   - 读者等待在途预读期间簇被释放：槽位不会被其它簇复用，读者拿到原数据
+//   - /proc/readahead 内容
+// ============================================================================
+
+#include <tests/ktest.h>
+#include <tests/fs/readahead_test.h>
+#include <tests/test_module.h>
+#include <fs/fat32.h>
+#include <fs/bio.h>
+#include <fs/blockdev.h>
+#include <fs/vfs.h>
+#include <kernel/task.h>
+#include <drivers/timer.h>
+#include <mm/heap.h>
+#include <lib/kprintf.h>
+#include <lib/string.h>
+#include <types.h>
+
+// ============================================================================
+// 内存盘与格式化
+// ============================================================================
+
+#define RAT_SECTOR_SIZE     512
+#define RAT_TOTAL_SECTORS   4096            // 2 MB
+#define RAT_SPC             8               // 每簇 4 KB
+#define RAT_RESERVED        32
+#define RAT_FAT_SECTORS     4
+#define RAT_CLUSTER_SIZE    (RAT_SECTOR_SIZE * RAT_SPC)
+#define RAT_FILE_CLUSTERS   48
+#define RAT_FILE_SIZE       (RAT_FILE_CLUSTERS * RAT_CLUSTER_SIZE)
+#define RAT_DATA_START      (RAT_RESERVED + 2 * RAT_FAT_SECTORS)
+#define RAT_CLUSTER_SECTOR(c)   (RAT_DATA_START + ((c) - 2) * RAT_SPC)
+#define RAT_MAX_HELD        8
+
+static uint8_t *rat_image = NULL;
+static blockdev_t rat_dev;
+static uint32_t rat_data_reads;
+
+/* 异步模式：[rat_hold_start, rat_hold_end) 内的读请求先扣住，由测试完成 */
+static blk_request_t *rat_held[RAT_MAX_HELD];
+static uint32_t rat_held_count;
+static uint32_t rat_hold_start;
+static uint32_t rat_hold_end;
+
+static int rat_dev_read(void *dev, uint32_t sector, uint32_t count, uint8_t *buffer) {
+    (void)dev;
+    memcpy(buffer, rat_image + sector * RAT_SECTOR_SIZE, count * RAT_SECTOR_SIZE);
+    if (count > 1) {
+        rat_data_reads++;
+    }
+    return 0;
+}
+
+static int rat_dev_write(void *dev, uint32_t sector, uint32_t count, const uint8_t *buffer) {
+    (void)dev;
+    memcpy(rat_image + sector * RAT_SECTOR_SIZE, buffer, count * RAT_SECTOR_SIZE);
+    return 0;
+}
+
+static int rat_dev_submit(void *dev, blk_request_t *rq) {
+    if (!rq->write && rq->sector >= rat_hold_start && rq->sector < rat_hold_end &&
+        rat_held_count < RAT_MAX_HELD) {
+        rat_held[rat_held_count++] = rq;
+        return 0;
+    }
+    int ret = rq->write ? rat_dev_write(dev, rq->sector, rq->count, rq->buffer)
+                        : rat_dev_read(dev, rq->sector, rq->count, rq->buffer);
+    blk_request_done(rq, ret);
+    return 0;
+}
+
+/* 完成所有扣住的请求 */
+static void rat_release_held(void) {
+    rat_hold_start = rat_hold_end = 0;
+    while (rat_held_count > 0) {
+        blk_request_t *rq = rat_held[--rat_held_count];
+        blk_request_done(rq, rat_dev_read(NULL, rq->sector, rq->count, rq->buffer));
+    }
+}
+
+static void rat_put16(uint8_t *p, uint16_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void rat_put32(uint8_t *p, uint32_t v) {
+    rat_put16(p, (uint16_t)v);
+    rat_put16(p + 2, (uint16_t)(v >> 16));
+}
+
+/* 写入 BPB 和两份 FAT（簇 0、1 保留，簇 2 为空的根目录） */
+static void rat_format(void) {
+    memset(rat_image, 0, RAT_TOTAL_SECTORS * RAT_SECTOR_SIZE);
+
+    uint8_t *bpb = rat_image;
+    bpb[0] = 0xEB;
+    bpb[1] = 0x58;
+    bpb[2] = 0x90;
+    memcpy(bpb + 3, "MSWIN4.1", 8);
+    rat_put16(bpb + 11, RAT_SECTOR_SIZE);
+    bpb[13] = RAT_SPC;
+    rat_put16(bpb + 14, RAT_RESERVED);
+    bpb[16] = 2;                                // FAT 数量
+    bpb[21] = 0xF8;                             // 媒体类型
+    rat_put32(bpb + 32, RAT_TOTAL_SECTORS);
+    rat_put32(bpb + 36, RAT_FAT_SECTORS);
+    rat_put32(bpb + 44, 2);                     // 根目录簇
+    bpb[66] = 0x29;
+    memcpy(bpb + 71, "RATEST     ", 11);
+    memcpy(bpb + 82, "FAT32   ", 8);
+    rat_put16(bpb + 510, 0xAA55);
+
+    for (uint32_t i = 0; i < 2; i++) {
+        uint8_t *fat = rat_image + (RAT_RESERVED + i * RAT_FAT_SECTORS) * RAT_SECTOR_SIZE;
+        rat_put32(fat + 0, 0x0FFFFFF8);
+        rat_put32(fat + 4, 0x0FFFFFFF);
+        rat_put32(fat + 8, 0x0FFFFFFF);
+    }
+}
+
+static fs_node_t *rat_mount(bool async) {
+    rat_image = (uint8_t *)kmalloc(RAT_TOTAL_SECTORS * RAT_SECTOR_SIZE);
+    if (!rat_image) {
+        return NULL;
+    }
+    rat_format();
+
+    memset(&rat_dev, 0, sizeof(rat_dev));
+    strcpy(rat_dev.name, "ratram");
+    rat_dev.block_size = RAT_SECTOR_SIZE;
+    rat_dev.total_sectors = RAT_TOTAL_SECTORS;
+    rat_dev.read = rat_dev_read;
+    rat_dev.write = rat_dev_write;
+    rat_dev.submit = async ? rat_dev_submit : NULL;
+    rat_held_count = 0;
+    rat_hold_start = rat_hold_end = 0;
+    if (blk_queue_init(&rat_dev, async ? 4 : 1) != 0) {
+        kfree(rat_image);
+        rat_image = NULL;
+        return NULL;
+    }
+
+    fs_node_t *root = fat32_init(&rat_dev);
+    if (!root) {
+        blk_queue_destroy(&rat_dev);
+        kfree(rat_image);
+        rat_image = NULL;
+    }
+    return root;
+}
+
+static void rat_unmount(fs_node_t *root) {
+    fat32_deinit(root);
+    blk_queue_destroy(&rat_dev);
+    kfree(rat_image);
+    rat_image = NULL;
+}
+
+static uint8_t rat_pattern(uint32_t seed, uint32_t off) {
+    return (uint8_t)(seed * 29 + off * 3 + (off >> 12));
+}
+
+/* 创建文件并整簇写入 RAT_FILE_SIZE 字节，返回节点（带一个引用） */
+static fs_node_t *rat_create(fs_node_t *root, const char *name, uint32_t seed) {
+    if (root->ops->create(root, name) != 0) {
+        return NULL;
+    }
+    fs_node_t *node = vfs_finddir(root, name);
+    if (!node) {
+        return NULL;
+    }
+    uint8_t *data = (uint8_t *)kmalloc(RAT_FILE_SIZE);
+    if (!data) {
+        vfs_release_node(node);
+        return NULL;
+    }
+    for (uint32_t i = 0; i < RAT_FILE_SIZE; i++) {
+        data[i] = rat_pattern(seed, i);
+    }
+    uint32_t written = vfs_write(node, 0, RAT_FILE_SIZE, data);
+    kfree(data);
+    if (written != RAT_FILE_SIZE) {
+        vfs_release_node(node);
+        return NULL;
+    }
+    return node;
+}
+
+/* 读取一个簇并校验，返回 true 表示数据正确 */
+static bool rat_read_cluster(fs_node_t *node, uint32_t index, uint32_t seed, uint8_t *buf) {
+    uint32_t off = index * RAT_CLUSTER_SIZE;
+    if (vfs_read(node, off, RAT_CLUSTER_SIZE, buf) != RAT_CLUSTER_SIZE) {
+        return false;
+    }
+    for (uint32_t i = 0; i < RAT_CLUSTER_SIZE; i++) {
+        if (buf[i] != rat_pattern(seed, off + i)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool rat_contains(const char *text, const char *word) {
+    size_t n = strlen(word);
+    for (; *text; text++) {
+        if (strncmp(text, word, n) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// ============================================================================
+// 测试用例
+// ============================================================================
+
+TEST_CASE(test_readahead_sequential) {
+    fs_node_t *root = rat_mount(false);
+    ASSERT_NOT_NULL(root);
+    fs_node_t *node = rat_create(root, "SEQ.BIN", 1);
+    ASSERT_NOT_NULL(node);
+    uint8_t *buf = (uint8_t *)kmalloc(RAT_CLUSTER_SIZE);
+    ASSERT_NOT_NULL(buf);
+
+    fat32_ra_stats_t before, after;
+    fat32_readahead_get_stats(&before);
+    rat_data_reads = 0;
+
+    bool ok = true;
+    for (uint32_t i = 0; i < RAT_FILE_CLUSTERS && ok; i++) {
+        ok = rat_read_cluster(node, i, 1, buf);
+    }
+    fat32_readahead_get_stats(&after);
+    uint32_t hits = after.hits - before.hits;
+    uint32_t misses = after.misses - before.misses;
+
+    kprintf("    %u clusters: %u read-ahead hits, %u misses, %u issued, "
+            "%u device reads, %u window grows\n",
+            RAT_FILE_CLUSTERS, hits, misses, after.issued - before.issued,
+            rat_data_reads, after.grows - before.grows);
+
+    kfree(buf);
+    vfs_release_node(node);
+    rat_unmount(root);
+
+    ASSERT_TRUE(ok);
+    // 只有第一个簇同步读取，之后都由预读提供
+    ASSERT_TRUE(hits >= RAT_FILE_CLUSTERS - 1);
+    ASSERT_TRUE(after.grows > before.grows);
+    // 相邻簇合并成大请求：设备调用次数远少于簇数
+    ASSERT_TRUE(rat_data_reads < RAT_FILE_CLUSTERS / 2);
+}
+
+TEST_CASE(test_readahead_random) {
+    fs_node_t *root = rat_mount(false);
+    ASSERT_NOT_NULL(root);
+    fs_node_t *node = rat_create(root, "RND.BIN", 2);
+    ASSERT_NOT_NULL(node);
+    uint8_t *buf = (uint8_t *)kmalloc(RAT_CLUSTER_SIZE);
+    ASSERT_NOT_NULL(buf);
+
+    fat32_ra_stats_t before, after;
+    fat32_readahead_get_stats(&before);
+
+    // 每次跳 7 个簇：任何两次读取都不相邻
+    bool ok = true;
+    for (uint32_t k = 1; k <= 16 && ok; k++) {
+        ok = rat_read_cluster(node, (k * 7) % RAT_FILE_CLUSTERS, 2, buf);
+    }
+    fat32_readahead_get_stats(&after);
+
+    kfree(buf);
+    vfs_release_node(node);
+    rat_unmount(root);
+
+    ASSERT_TRUE(ok);
+    ASSERT_EQ_UINT(0, after.issued - before.issued);
+}
+
+TEST_CASE(test_readahead_write_invalidates) {
+    fs_node_t *root = rat_mount(false);
+    ASSERT_NOT_NULL(root);
+    fs_node_t *node = rat_create(root, "INV.BIN", 3);
+    ASSERT_NOT_NULL(node);
+    uint8_t *buf = (uint8_t *)kmalloc(RAT_CLUSTER_SIZE);
+    ASSERT_NOT_NULL(buf);
+
+    // 读前两个簇，预读覆盖到后面的簇
+    bool ok = rat_read_cluster(node, 0, 3, buf) && rat_read_cluster(node, 1, 3, buf);
+
+    fat32_ra_stats_t before, after;
+    fat32_readahead_get_stats(&before);
+
+    // 覆盖第 3 个簇后顺序读到它：必须是新数据
+    memset(buf, 0x5A, RAT_CLUSTER_SIZE);
+    uint32_t written = vfs_write(node, 2 * RAT_CLUSTER_SIZE, RAT_CLUSTER_SIZE, buf);
+    memset(buf, 0, RAT_CLUSTER_SIZE);
+    uint32_t got = vfs_read(node, 2 * RAT_CLUSTER_SIZE, RAT_CLUSTER_SIZE, buf);
+    bool fresh = true;
+    for (uint32_t i = 0; i < RAT_CLUSTER_SIZE; i++) {
+        if (buf[i] != 0x5A) {
+            fresh = false;
+            break;
+        }
+    }
+    fat32_readahead_get_stats(&after);
+
+    char text[512];
+    int len = fat32_readahead_dump(text, sizeof(text));
+
+    kfree(buf);
+    vfs_release_node(node);
+    rat_unmount(root);
+
+    ASSERT_TRUE(ok);
+    ASSERT_EQ_UINT(RAT_CLUSTER_SIZE, written);
+    ASSERT_EQ_UINT(RAT_CLUSTER_SIZE, got);
+    ASSERT_TRUE(fresh);
+    ASSERT_TRUE(after.wasted > before.wasted);
+    ASSERT_TRUE(len > 0);
+    ASSERT_TRUE(rat_contains(text, "wasted:"));
+}
+
+/* 读者线程：读 WAIT.BIN 的第 1 个簇，会等在扣住的预读 bio 上 */
+static fs_node_t *rat_waiter_node;
+static uint8_t *rat_waiter_buf;
+static volatile bool rat_waiter_done;
+static volatile uint32_t rat_waiter_got;
+
+static void rat_waiter_thread(void) {
+    rat_waiter_got = vfs_read(rat_waiter_node, RAT_CLUSTER_SIZE, RAT_CLUSTER_SIZE, rat_waiter_buf);
+    rat_waiter_done = true;
+}
+
+TEST_CASE(test_readahead_freed_while_waiting) {
+    fs_node_t *root = rat_mount(true);
+    ASSERT_NOT_NULL(root);
+    fs_node_t *victim = rat_create(root, "WAIT.BIN", 4);
+    ASSERT_NOT_NULL(victim);
+    fs_node_t *other = rat_create(root, "NEW.BIN", 5);
+    ASSERT_NOT_NULL(other);
+    uint8_t *buf = (uint8_t *)kmalloc(RAT_CLUSTER_SIZE);
+    rat_waiter_buf = (uint8_t *)kmalloc(RAT_CLUSTER_SIZE);
+    ASSERT_NOT_NULL(buf);
+    ASSERT_NOT_NULL(rat_waiter_buf);
+
+    // 新卷上 WAIT.BIN 从簇 3 开始连续分配
+    uint32_t first = RAT_CLUSTER_SECTOR(3);
+    ASSERT_EQ_UINT(rat_pattern(4, RAT_CLUSTER_SIZE),
+                   rat_image[(first + RAT_SPC) * RAT_SECTOR_SIZE]);
+
+    // 读第 0 个簇，向后预读的 bio 全部扣住
+    rat_hold_start = first + RAT_SPC;
+    rat_hold_end = first + RAT_FILE_CLUSTERS * RAT_SPC;
+    bool ok = rat_read_cluster(victim, 0, 4, buf);
+    uint32_t held = rat_held_count;
+
+    // 读者等在第 1 个簇的预读槽位上
+    rat_waiter_node = victim;
+    rat_waiter_done = false;
+    memset(rat_waiter_buf, 0, RAT_CLUSTER_SIZE);
+    ASSERT_NE_UINT(task_create_kernel_thread(rat_waiter_thread, "ra_waiter"), 0);
+    task_sleep(50);
+    bool waited = !rat_waiter_done;
+
+    // 删除文件使在途槽位作废，完成 bio 后立即让另一个文件的预读争用槽位
+    int removed = root->ops->unlink(root, "WAIT.BIN");
+    rat_release_held();
+    bool other_ok = rat_read_cluster(other, 0, 5, buf);
+
+    uint64_t t0 = timer_get_uptime_ms();
+    while (!rat_waiter_done && timer_get_uptime_ms() - t0 < 2000) {
+        task_sleep(10);
+    }
+    bool done = rat_waiter_done;
+
+    // 删除不清空数据：读者回退到同步读取，得到的是原文件内容
+    bool intact = rat_waiter_got == RAT_CLUSTER_SIZE;
+    for (uint32_t i = 0; i < RAT_CLUSTER_SIZE && intact; i++) {
+        intact = rat_waiter_buf[i] == rat_pattern(4, RAT_CLUSTER_SIZE + i);
+    }
+
+    ASSERT_TRUE(ok);
+    ASSERT_TRUE(held > 0);
+    ASSERT_TRUE(waited);
+    ASSERT_EQ(0, removed);
+    ASSERT_TRUE(other_ok);
+    ASSERT_TRUE(done);
+    ASSERT_TRUE(intact);
+
+    // 超时时读者仍在访问卷，不能卸载
+    if (done) {
+        kfree(buf);
+        kfree(rat_waiter_buf);
+        vfs_release_node(other);
+        vfs_release_node(victim);
+        rat_unmount(root);
+    }
+}
+
+// ============================================================================
+// 测试套件定义
+// ============================================================================
+
+TEST_SUITE(readahead_tests) {
+    RUN_TEST(test_readahead_sequential);
+    RUN_TEST(test_readahead_random);
+    RUN_TEST(test_readahead_write_invalidates);
+    RUN_TEST(test_readahead_freed_while_waiting);
+}
+
+// ============================================================================
+// 运行所有测试
+// ============================================================================
+
+void run_readahead_tests(void) {
+    // 初始化测试框架
+    unittest_init();
+
+    // 运行所有测试套件
+    RUN_SUITE(readahead_tests);
+
+    // 打印测试摘要
+    unittest_print_summary();
+}
+
+// ============================================================================
+// 模块注册
+// ============================================================================
+
+TEST_MODULE_DESC(readahead, FS, run_readahead_tests,
+    "FAT32 read-ahead - sequential detection, adaptive window, write invalidation");
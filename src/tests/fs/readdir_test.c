@@ -0,0 +1,216 @@
+// ============================================================================
+// readdir_test.c - 目录流游标单元测试
+// ============================================================================
+//
+// 模块名称: readdir
+// 子系统: fs (文件系统)
+// 描述: 测试基于游标的目录迭代（getdents64 的内核部分）
+//
+// 功能覆盖:
+//   - 分多次迭代得到的目录项与按索引 readdir 一致，无重复无遗漏
+//   - 游标清零后从头读起
+//   - ramfs 迭代过程中删除条目后继续迭代
+// ============================================================================
+
+#include <tests/ktest.h>
+#include <tests/fs/readdir_test.h>
+#include <tests/test_module.h>
+#include <fs/vfs.h>
+#include <fs/ramfs.h>
+#include <lib/kprintf.h>
+#include <lib/string.h>
+#include <types.h>
+
+#define READDIR_TEST_FILES      12
+#define READDIR_TEST_MAX_NAMES  32
+
+// ============================================================================
+// 测试辅助函数
+// ============================================================================
+
+/* 每次调用最多接收 limit 项，模拟 getdents64 的小缓冲区 */
+typedef struct readdir_collect {
+    uint32_t limit;
+    uint32_t taken;
+    uint32_t count;
+    char names[READDIR_TEST_MAX_NAMES][16];
+} readdir_collect_t;
+
+static int readdir_collect_fill(void *ctx, const char *name, uint32_t ino, uint8_t type) {
+    (void)ino; (void)type;
+    readdir_collect_t *c = (readdir_collect_t *)ctx;
+    if (c->taken >= c->limit || c->count >= READDIR_TEST_MAX_NAMES) {
+        return 1;
+    }
+    strncpy(c->names[c->count], name, sizeof(c->names[0]) - 1);
+    c->names[c->count][sizeof(c->names[0]) - 1] = '\0';
+    c->count++;
+    c->taken++;
+    return 0;
+}
+
+/* 反复迭代直到没有新目录项 */
+static void readdir_collect_all(fs_node_t *dir, dir_cursor_t *cursor, readdir_collect_t *c) {
+    for (;;) {
+        uint32_t before = c->count;
+        c->taken = 0;
+        if (vfs_iterate_dir(dir, cursor, readdir_collect_fill, c) != 0 || c->count == before) {
+            break;
+        }
+    }
+}
+
+static uint32_t readdir_count_name(readdir_collect_t *c, const char *name) {
+    uint32_t n = 0;
+    for (uint32_t i = 0; i < c->count; i++) {
+        if (strcasecmp(c->names[i], name) == 0) {
+            n++;
+        }
+    }
+    return n;
+}
+
+// ============================================================================
+// 游标迭代
+// ============================================================================
+
+TEST_CASE(test_readdir_cursor_matches_index) {
+    uint32_t perm = FS_PERM_READ | FS_PERM_WRITE | FS_PERM_EXEC;
+    char path[32];
+    
+    vfs_mkdir("/RDCUR", perm);
+    for (uint32_t i = 0; i < READDIR_TEST_FILES; i++) {
+        ksnprintf(path, sizeof(path), "/RDCUR/F%u.TXT", i);
+        vfs_create(path);
+    }
+    
+    fs_node_t *dir = vfs_path_to_node("/RDCUR");
+    ASSERT_NOT_NULL(dir);
+    
+    // 按索引逐项读取作为参照
+    uint32_t expected = 0;
+    while (vfs_readdir(dir, expected)) {
+        expected++;
+    }
+    
+    static readdir_collect_t c;
+    memset(&c, 0, sizeof(c));
+    c.limit = 5;
+    dir_cursor_t cursor = {0};
+    readdir_collect_all(dir, &cursor, &c);
+    
+    ASSERT_EQ_UINT(c.count, expected);
+    ASSERT_EQ_UINT(cursor.index, expected);
+    for (uint32_t i = 0; i < READDIR_TEST_FILES; i++) {
+        ksnprintf(path, sizeof(path), "F%u.TXT", i);
+        ASSERT_EQ_UINT(readdir_count_name(&c, path), 1);
+    }
+    
+    // 已到末尾：再次迭代不返回任何项
+    uint32_t before = c.count;
+    c.taken = 0;
+    ASSERT_EQ(vfs_iterate_dir(dir, &cursor, readdir_collect_fill, &c), 0);
+    ASSERT_EQ_UINT(c.count, before);
+    
+    vfs_release_node(dir);
+    for (uint32_t i = 0; i < READDIR_TEST_FILES; i++) {
+        ksnprintf(path, sizeof(path), "/RDCUR/F%u.TXT", i);
+        vfs_unlink(path);
+    }
+    vfs_unlink("/RDCUR");
+}
+
+TEST_CASE(test_readdir_cursor_rewind) {
+    fs_node_t *root = vfs_get_root();
+    ASSERT_NOT_NULL(root);
+    
+    static readdir_collect_t first, again;
+    memset(&first, 0, sizeof(first));
+    memset(&again, 0, sizeof(again));
+    first.limit = 1;
+    again.limit = 1;
+    
+    dir_cursor_t cursor = {0};
+    ASSERT_EQ(vfs_iterate_dir(root, &cursor, readdir_collect_fill, &first), 0);
+    if (first.count == 0) {
+        return;     // 空根目录
+    }
+    
+    // 清零游标即 rewinddir
+    memset(&cursor, 0, sizeof(cursor));
+    ASSERT_EQ(vfs_iterate_dir(root, &cursor, readdir_collect_fill, &again), 0);
+    ASSERT_EQ_UINT(again.count, 1);
+    ASSERT_STR_EQ(again.names[0], first.names[0]);
+}
+
+TEST_CASE(test_readdir_ramfs_unlink_midstream) {
+    fs_node_t *root = ramfs_create("rdtest");
+    ASSERT_NOT_NULL(root);
+    ASSERT_NOT_NULL(root->ops);
+    
+    char name[16];
+    for (uint32_t i = 0; i < 6; i++) {
+        ksnprintf(name, sizeof(name), "f%u", i);
+        ASSERT_EQ(root->ops->create(root, name), 0);
+    }
+    
+    static readdir_collect_t c;
+    memset(&c, 0, sizeof(c));
+    c.limit = 2;
+    dir_cursor_t cursor = {0};
+    ASSERT_EQ(vfs_iterate_dir(root, &cursor, readdir_collect_fill, &c), 0);
+    ASSERT_EQ_UINT(c.count, 2);
+    
+    // 删除一个尚未读到的条目：游标中的条目指针作废，按已读数量重新定位
+    const char *victim = NULL;
+    for (uint32_t i = 0; i < 6 && !victim; i++) {
+        ksnprintf(name, sizeof(name), "f%u", i);
+        if (readdir_count_name(&c, name) == 0) {
+            victim = name;
+        }
+    }
+    ASSERT_NOT_NULL(victim);
+    ASSERT_EQ(root->ops->unlink(root, victim), 0);
+    
+    c.limit = READDIR_TEST_MAX_NAMES;
+    readdir_collect_all(root, &cursor, &c);
+    ASSERT_EQ_UINT(c.count, 5);
+    ASSERT_EQ_UINT(readdir_count_name(&c, victim), 0);
+    
+    for (uint32_t i = 0; i < 6; i++) {
+        ksnprintf(name, sizeof(name), "f%u", i);
+        root->ops->unlink(root, name);
+    }
+}
+
+// ============================================================================
+// 测试套件定义
+// ============================================================================
+
+TEST_SUITE(readdir_cursor_tests) {
+    RUN_TEST(test_readdir_cursor_matches_index);
+    RUN_TEST(test_readdir_cursor_rewind);
+    RUN_TEST(test_readdir_ramfs_unlink_midstream);
+}
+
+// ============================================================================
+// 运行所有测试
+// ============================================================================
+
+void run_readdir_tests(void) {
+    // 初始化测试框架
+    unittest_init();
+    
+    // 运行所有测试套件
+    RUN_SUITE(readdir_cursor_tests);
+    
+    // 打印测试摘要
+    unittest_print_summary();
+}
+
+// ============================================================================
+// 模块注册
+// ============================================================================
+
+TEST_MODULE_DESC(readdir, FS, run_readdir_tests,
+    "Directory cursor tests - resumable iteration, rewind, ramfs unlink during iteration");
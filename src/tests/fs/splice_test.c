@@ -0,0 +1,299 @@
+// ============================================================================
+// splice_test.c - splice 单元测试
+// ============================================================================
+//
+// 模块名称: splice
+// 子系统: fs (文件系统)
+// 描述: 测试文件、管道之间的内核内数据搬运
+//
+// 功能覆盖:
+//   - vfs_splice(): 文件 -> 管道 -> 文件，偏移推进
+//   - vfs_splice(): 文件 -> 文件（中转缓冲区）
+//   - 同一个管道首尾相接被拒绝
+//   - 文件数据送入管道：read+write 与 splice 的吞吐量对比（默认 1 MB，make bench 为 32 MB）
+// ============================================================================
+
+#include <tests/ktest.h>
+#include <tests/fs/splice_test.h>
+#include <tests/test_module.h>
+#include <fs/splice.h>
+#include <fs/pipe.h>
+#include <fs/vfs.h>
+#include <kernel/task.h>
+#include <drivers/timer.h>
+#include <mm/heap.h>
+#include <lib/kprintf.h>
+#include <lib/string.h>
+#include <types.h>
+
+#define SPLICE_TEST_SRC     "/SPLSRC.TMP"
+#define SPLICE_TEST_DST     "/SPLDST.TMP"
+
+// ============================================================================
+// 测试辅助函数
+// ============================================================================
+
+static void splice_test_fill(uint8_t *buf, uint32_t len, uint32_t seed) {
+    for (uint32_t i = 0; i < len; i++) {
+        buf[i] = (uint8_t)(seed + i * 13);
+    }
+}
+
+// 创建文件并写入内容，返回节点（调用者负责释放）
+static fs_node_t *splice_test_make_file(const char *path, const uint8_t *data, uint32_t len) {
+    vfs_unlink(path);
+    if (vfs_create(path) != 0) {
+        return NULL;
+    }
+    fs_node_t *node = vfs_path_to_node(path);
+    if (!node) {
+        return NULL;
+    }
+    if (len && vfs_write(node, 0, len, (uint8_t *)data) != len) {
+        vfs_release_node(node);
+        return NULL;
+    }
+    return node;
+}
+
+static void splice_test_close_pipe(fs_node_t *rnode, fs_node_t *wnode) {
+    if (wnode) {
+        vfs_close(wnode);
+        vfs_release_node(wnode);
+    }
+    if (rnode) {
+        vfs_close(rnode);
+        vfs_release_node(rnode);
+    }
+}
+
+// ============================================================================
+// 正确性测试
+// ============================================================================
+
+TEST_CASE(test_splice_file_pipe_file) {
+    static uint8_t src[10000];
+    static uint8_t dst[10000];
+    fs_node_t *rnode = NULL, *wnode = NULL;
+    
+    splice_test_fill(src, sizeof(src), 7);
+    fs_node_t *in = splice_test_make_file(SPLICE_TEST_SRC, src, sizeof(src));
+    fs_node_t *out = splice_test_make_file(SPLICE_TEST_DST, NULL, 0);
+    ASSERT_NOT_NULL(in);
+    ASSERT_NOT_NULL(out);
+    ASSERT_EQ(pipe_create(&rnode, &wnode), 0);
+    
+    // 从偏移 100 开始送入管道
+    uint32_t in_off = 100;
+    ASSERT_EQ(vfs_splice(in, &in_off, wnode, NULL, 6000), 6000);
+    ASSERT_EQ_UINT(in_off, 6100);
+    
+    // 管道中的数据分两次搬到目标文件
+    uint32_t out_off = 0;
+    ASSERT_EQ(vfs_splice(rnode, NULL, out, &out_off, 4000), 4000);
+    ASSERT_EQ(vfs_splice(rnode, NULL, out, &out_off, 4000), 2000);
+    ASSERT_EQ_UINT(out_off, 6000);
+    
+    ASSERT_EQ_UINT(vfs_read(out, 0, 6000, dst), 6000);
+    ASSERT_EQ(memcmp(src + 100, dst, 6000), 0);
+    
+    // 源文件剩余部分不足请求长度时返回实际长度
+    ASSERT_EQ(vfs_splice(in, &in_off, wnode, NULL, 8000), 3900);
+    ASSERT_EQ_UINT(in_off, sizeof(src));
+    
+    splice_test_close_pipe(rnode, wnode);
+    vfs_release_node(in);
+    vfs_release_node(out);
+    vfs_unlink(SPLICE_TEST_SRC);
+    vfs_unlink(SPLICE_TEST_DST);
+}
+
+TEST_CASE(test_splice_file_to_file) {
+    static uint8_t src[SPLICE_CHUNK_SIZE + 5000];
+    static uint8_t dst[SPLICE_CHUNK_SIZE + 5000];
+    
+    splice_test_fill(src, sizeof(src), 31);
+    fs_node_t *in = splice_test_make_file(SPLICE_TEST_SRC, src, sizeof(src));
+    fs_node_t *out = splice_test_make_file(SPLICE_TEST_DST, NULL, 0);
+    ASSERT_NOT_NULL(in);
+    ASSERT_NOT_NULL(out);
+    
+    // 超过一个中转块，验证分块循环
+    uint32_t in_off = 0, out_off = 0;
+    ASSERT_EQ(vfs_splice(in, &in_off, out, &out_off, sizeof(src)), (ssize_t)sizeof(src));
+    ASSERT_EQ_UINT(in_off, sizeof(src));
+    ASSERT_EQ_UINT(out_off, sizeof(src));
+    
+    ASSERT_EQ_UINT(vfs_read(out, 0, sizeof(dst), dst), sizeof(dst));
+    ASSERT_EQ(memcmp(src, dst, sizeof(src)), 0);
+    
+    vfs_release_node(in);
+    vfs_release_node(out);
+    vfs_unlink(SPLICE_TEST_SRC);
+    vfs_unlink(SPLICE_TEST_DST);
+}
+
+TEST_CASE(test_splice_rejects_same_pipe) {
+    fs_node_t *rnode = NULL, *wnode = NULL;
+    uint8_t byte = 1;
+    
+    ASSERT_EQ(pipe_create(&rnode, &wnode), 0);
+    vfs_write(wnode, 0, 1, &byte);
+    ASSERT_EQ(vfs_splice(rnode, NULL, wnode, NULL, 1), -1);
+    
+    // 数据仍留在管道中
+    ASSERT_EQ_UINT(vfs_read(rnode, 0, 1, &byte), 1);
+    
+    splice_test_close_pipe(rnode, wnode);
+}
+
+// ============================================================================
+// 吞吐量基准：文件数据送入管道，由内核线程排空
+// ============================================================================
+
+#define SPLICE_BENCH_FILE_SIZE  (256U * 1024)
+#define SPLICE_BENCH_ROUNDS     KTEST_BENCH_SIZE(128, 4)   // 共 32 MB / 1 MB
+#define SPLICE_BENCH_BYTES      (SPLICE_BENCH_FILE_SIZE * SPLICE_BENCH_ROUNDS)
+#define SPLICE_BENCH_TIMEOUT    120000              // 毫秒
+
+static fs_node_t *splice_bench_rnode = NULL;
+static volatile uint32_t splice_bench_drained = 0;
+static volatile bool splice_bench_drain_done = false;
+
+// 丢弃数据，只抽查首字节
+static uint32_t splice_bench_discard(void *ctx, uint8_t *data, uint32_t len) {
+    *(uint32_t *)ctx += data[0];
+    return len;
+}
+
+static void splice_bench_drainer(void) {
+    uint32_t total = 0;
+    uint32_t sum = 0;
+    while (total < SPLICE_BENCH_BYTES) {
+        uint32_t n = pipe_splice_out(splice_bench_rnode, SPLICE_BENCH_BYTES - total,
+                                     splice_bench_discard, &sum);
+        if (n == 0) {
+            break;
+        }
+        total += n;
+    }
+    splice_bench_drained = total;
+    splice_bench_drain_done = true;
+}
+
+// 用 read+write 经中转缓冲区送入管道
+static uint32_t splice_bench_feed_copy(fs_node_t *in, fs_node_t *wnode, uint8_t *buf) {
+    uint32_t total = 0;
+    for (uint32_t round = 0; round < SPLICE_BENCH_ROUNDS; round++) {
+        for (uint32_t off = 0; off < SPLICE_BENCH_FILE_SIZE; off += SPLICE_CHUNK_SIZE) {
+            uint32_t r = vfs_read(in, off, SPLICE_CHUNK_SIZE, buf);
+            total += vfs_write(wnode, 0, r, buf);
+        }
+    }
+    return total;
+}
+
+// 用 splice 直接从文件读入管道缓冲区
+static uint32_t splice_bench_feed_splice(fs_node_t *in, fs_node_t *wnode) {
+    uint32_t total = 0;
+    for (uint32_t round = 0; round < SPLICE_BENCH_ROUNDS; round++) {
+        uint32_t off = 0;
+        ssize_t n = vfs_splice(in, &off, wnode, NULL, SPLICE_BENCH_FILE_SIZE);
+        if (n <= 0) {
+            break;
+        }
+        total += (uint32_t)n;
+    }
+    return total;
+}
+
+static void splice_bench_run(fs_node_t *in, uint8_t *buf, bool use_splice) {
+    fs_node_t *wnode = NULL;
+    ASSERT_EQ(pipe_create(&splice_bench_rnode, &wnode), 0);
+    
+    splice_bench_drained = 0;
+    splice_bench_drain_done = false;
+    
+    uint64_t t0 = timer_get_uptime_ms();
+    ASSERT_NE_UINT(task_create_kernel_thread(splice_bench_drainer, "splice_bench"), 0);
+    
+    uint32_t fed = use_splice ? splice_bench_feed_splice(in, wnode)
+                              : splice_bench_feed_copy(in, wnode, buf);
+    
+    while (!splice_bench_drain_done) {
+        if (timer_get_uptime_ms() - t0 > SPLICE_BENCH_TIMEOUT) {
+            break;
+        }
+        task_yield();
+    }
+    uint64_t elapsed = timer_get_uptime_ms() - t0;
+    
+    ASSERT_EQ_UINT(fed, SPLICE_BENCH_BYTES);
+    ASSERT_TRUE(splice_bench_drain_done);
+    ASSERT_EQ_UINT(splice_bench_drained, SPLICE_BENCH_BYTES);
+    
+    uint32_t ms = (uint32_t)elapsed;
+    kprintf("    %-11s: %u ms, %u MB/s\n", use_splice ? "splice" : "read+write", ms,
+            ms ? (SPLICE_BENCH_BYTES / 1024) / ms : SPLICE_BENCH_BYTES / (1024 * 1024));
+    
+    // 超时时线程仍在使用管道，不能释放
+    if (splice_bench_drain_done) {
+        splice_test_close_pipe(splice_bench_rnode, wnode);
+        splice_bench_rnode = NULL;
+    }
+}
+
+TEST_CASE(test_splice_throughput) {
+    uint8_t *buf = (uint8_t *)kmalloc(SPLICE_BENCH_FILE_SIZE);
+    ASSERT_NOT_NULL(buf);
+    splice_test_fill(buf, SPLICE_BENCH_FILE_SIZE, 0);
+    
+    fs_node_t *in = splice_test_make_file(SPLICE_TEST_SRC, buf, SPLICE_BENCH_FILE_SIZE);
+    ASSERT_NOT_NULL(in);
+    
+    kprintf("  file -> pipe throughput (%u KB from a %u KB file):\n", SPLICE_BENCH_BYTES / 1024,
+            SPLICE_BENCH_FILE_SIZE / 1024);
+    splice_bench_run(in, buf, false);
+    splice_bench_run(in, buf, true);
+    
+    vfs_release_node(in);
+    vfs_unlink(SPLICE_TEST_SRC);
+    kfree(buf);
+}
+
+// ============================================================================
+// 测试套件定义
+// ============================================================================
+
+TEST_SUITE(splice_basic_tests) {
+    RUN_TEST(test_splice_file_pipe_file);
+    RUN_TEST(test_splice_file_to_file);
+    RUN_TEST(test_splice_rejects_same_pipe);
+}
+
+TEST_SUITE(splice_benchmark_tests) {
+    RUN_TEST(test_splice_throughput);
+}
+
+// ============================================================================
+// 运行所有测试
+// ============================================================================
+
+void run_splice_tests(void) {
+    // 初始化测试框架
+    unittest_init();
+    
+    // 运行所有测试套件
+    RUN_SUITE(splice_basic_tests);
+    RUN_SUITE(splice_benchmark_tests);
+    
+    // 打印测试摘要
+    unittest_print_summary();
+}
+
+// ============================================================================
+// 模块注册
+// ============================================================================
+
+TEST_MODULE_DESC(splice, FS, run_splice_tests,
+    "Splice tests - file/pipe data movement without user copies, throughput");
@@ -13,6 +13,7 @@
 //   - 路径解析 (vfs_path_to_node)
 //   - 文件创建和删除 (vfs_create, vfs_unlink)
 //   - 目录创建 (vfs_mkdir)
+//   - 挂载点穿越、嵌套挂载与挂载路径检查 (vfs_mount, vfs_umount)
 //
 // **Feature: test-refactor**
 // **Validates: Requirements 4.1, 4.2**
@@ -519,6 +520,115 @@ TEST_CASE(test_vfs_dot_entry) {
     ASSERT_EQ_PTR(dot, root);
 }
 
+// ============================================================================
+// 挂载测试
+// ============================================================================
+
+/**
+ * @brief 测试路径解析穿越挂载点
+ *
+ * 挂载后路径进入挂载的文件系统，".." 回到挂载点所在目录，卸载后恢复
+ */
+TEST_CASE(test_vfs_mount_crossing) {
+    if (!vfs_test_setup()) {
+        return;
+    }
+    
+    fs_node_t *root = vfs_get_root();
+    fs_node_t *mnt_root = ramfs_create("tmnt");
+    ASSERT_NOT_NULL(mnt_root);
+    
+    vfs_mkdir("/TMNT", FS_PERM_READ | FS_PERM_WRITE | FS_PERM_EXEC);
+    ASSERT_EQ(vfs_mount("/TMNT", mnt_root), 0);
+    ASSERT_EQ(vfs_mount("/TMNT", mnt_root), -1);  // 重复挂载
+    
+    ASSERT_EQ_PTR(vfs_path_to_node("/TMNT"), mnt_root);
+    ASSERT_EQ_PTR(vfs_path_to_node("//TMNT/"), mnt_root);
+    ASSERT_EQ_PTR(vfs_path_to_node("/TMNT/.."), root);
+    
+    // 新文件落在挂载的文件系统中
+    ASSERT_EQ(vfs_create("/TMNT/inner"), 0);
+    fs_node_t *inner = vfs_finddir(mnt_root, "inner");
+    ASSERT_NOT_NULL(inner);
+    vfs_release_node(inner);
+    ASSERT_EQ(vfs_unlink("/TMNT/inner"), 0);
+    
+    ASSERT_EQ(vfs_umount("/TMNT"), 0);
+    ASSERT_EQ(vfs_umount("/TMNT"), -1);
+    
+    fs_node_t *covered = vfs_path_to_node("/TMNT");
+    ASSERT_NOT_NULL(covered);
+    ASSERT_TRUE(covered != mnt_root);
+    vfs_release_node(covered);
+    
+    vfs_unlink("/TMNT");
+}
+
+/**
+ * @brief 测试嵌套挂载：最深的挂载点优先
+ */
+TEST_CASE(test_vfs_mount_nested) {
+    if (!vfs_test_setup()) {
+        return;
+    }
+    
+    fs_node_t *outer = ramfs_create("touter");
+    fs_node_t *inner = ramfs_create("tinner");
+    ASSERT_NOT_NULL(outer);
+    ASSERT_NOT_NULL(inner);
+    
+    vfs_mkdir("/TNEST", FS_PERM_READ | FS_PERM_WRITE | FS_PERM_EXEC);
+    ASSERT_EQ(vfs_mount("/TNEST", outer), 0);
+    ASSERT_EQ(vfs_mkdir("/TNEST/sub", FS_PERM_READ | FS_PERM_WRITE | FS_PERM_EXEC), 0);
+    ASSERT_EQ(vfs_mount("/TNEST/sub", inner), 0);
+    
+    ASSERT_EQ_PTR(vfs_path_to_node("/TNEST"), outer);
+    ASSERT_EQ_PTR(vfs_path_to_node("/TNEST/sub"), inner);
+    ASSERT_EQ_PTR(vfs_path_to_node("/TNEST/sub/.."), outer);
+    ASSERT_EQ_PTR(vfs_path_to_node("/TNEST/sub/../sub"), inner);
+    ASSERT_EQ_PTR(vfs_path_to_node("/TNEST/./sub/."), inner);
+    
+    ASSERT_EQ(vfs_umount("/TNEST/sub"), 0);
+    ASSERT_EQ(vfs_umount("/TNEST"), 0);
+    vfs_unlink("/TNEST");
+}
+
+/**
+ * @brief 测试非法挂载路径被拒绝，合法的多级新路径一次建好
+ */
+TEST_CASE(test_vfs_mount_path_checks) {
+    if (!vfs_test_setup()) {
+        return;
+    }
+    
+    fs_node_t *fs = ramfs_create("tpath");
+    ASSERT_NOT_NULL(fs);
+    
+    ASSERT_EQ(vfs_mkdir("/TPATH", FS_PERM_READ | FS_PERM_WRITE | FS_PERM_EXEC), 0);
+    ASSERT_EQ(vfs_mkdir("/TPATH/sub", FS_PERM_READ | FS_PERM_WRITE | FS_PERM_EXEC), 0);
+    
+    // 分量超过 127 个字符：不能被截成两段
+    char longpath[160];
+    longpath[0] = '/';
+    memset(longpath + 1, 'L', 130);
+    longpath[131] = '\0';
+    ASSERT_EQ(vfs_mount(longpath, fs), -1);
+    
+    // 非规范路径
+    ASSERT_EQ(vfs_mount("/TPATH/./sub", fs), -1);
+    ASSERT_EQ(vfs_mount("/TPATH/sub/..", fs), -1);
+    
+    // 两级都不在挂载树中
+    ASSERT_EQ(vfs_mount("/TPATH/sub", fs), 0);
+    ASSERT_EQ_PTR(vfs_path_to_node("/TPATH/sub"), fs);
+    ASSERT_EQ(vfs_mount("/TPATH/sub/", fs), -1);  // 重复挂载
+    ASSERT_EQ(vfs_umount("/TPATH"), -1);          // 中间分量不是挂载点
+    ASSERT_EQ(vfs_umount("/TPATH/sub"), 0);
+    
+    vfs_unlink("/TPATH/sub");
+    vfs_unlink("/TPATH");
+}
+
 // ============================================================================
 // 测试套件定义
 // ============================================================================
@@ -573,6 +683,15 @@ TEST_SUITE(vfs_edge_tests) {
     RUN_TEST(test_vfs_dot_entry);
 }
 
+/**
+ * @brief 挂载测试套件
+ */
+TEST_SUITE(vfs_mount_tests) {
+    RUN_TEST(test_vfs_mount_crossing);
+    RUN_TEST(test_vfs_mount_nested);
+    RUN_TEST(test_vfs_mount_path_checks);
+}
+
 // ============================================================================
 // 模块运行函数
 // ============================================================================
@@ -585,6 +704,7 @@ TEST_SUITE(vfs_edge_tests) {
  *   2. vfs_file_tests - 文件操作测试
  *   3. vfs_dir_tests - 目录操作测试
  *   4. vfs_edge_tests - 边界条件测试
+ *   5. vfs_mount_tests - 挂载测试
  *
  * **Feature: test-refactor**
  * **Validates: Requirements 4.1, 4.2**
@@ -613,6 +733,9 @@ void run_vfs_tests(void) {
     // _Requirements: 4.1_
     RUN_SUITE(vfs_edge_tests);
 
+    // 套件 5: 挂载测试
+    RUN_SUITE(vfs_mount_tests);
+
     // 打印测试摘要
     unittest_print_summary();
 }
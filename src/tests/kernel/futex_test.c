@@ -0,0 +1,243 @@
+// ============================================================================
+// futex_test.c - futex 测试
+// ============================================================================
+//
+// 模块名称: futex
+// 子系统: kernel (内核核心)
+// 描述: 用内核线程驱动 futex_wait/futex_wake/futex_requeue，并用与用户库
+//       相同的三态互斥锁算法比较无竞争与有竞争时的加锁开销
+//
+// 功能覆盖:
+//   - 值不匹配返回 -EAGAIN，超时返回 -ETIMEDOUT，非法地址返回 -EFAULT
+//   - 唤醒数受 nr 限制，只唤醒同一地址上的等待者
+//   - requeue 唤醒一个，其余迁移到另一地址且不被唤醒
+//   - 多线程争用下互斥锁无丢失更新（加锁开销对比的完整规模需 make bench）
+// ============================================================================
+
+#include <tests/ktest.h>
+#include <tests/kernel/futex_test.h>
+#include <tests/test_module.h>
+#include <kernel/sync/futex.h>
+#include <kernel/sync/waitqueue.h>
+#include <kernel/task.h>
+#include <drivers/timer.h>
+#include <lib/kprintf.h>
+#include <types.h>
+
+#define FTX_WAITERS         3
+#define FTX_BENCH_THREADS   4
+#define FTX_BENCH_ITERS     KTEST_BENCH_SIZE(20000, 1000)
+#define FTX_TIMEOUT_MS      30000
+
+static volatile uint32_t ftx_word_a = 0;
+static volatile uint32_t ftx_word_b = 0;
+static volatile uint32_t ftx_woken = 0;         // 从 futex_wait 返回 0 的线程数
+static volatile uint32_t ftx_done = 0;
+static uint32_t ftx_pids[FTX_WAITERS];
+
+// ============================================================================
+// 辅助函数
+// ============================================================================
+
+static void ftx_waiter_thread(void) {
+    // 只在 ftx_word_a 仍为 0 时睡眠
+    if (futex_wait(&ftx_word_a, 0, WAIT_FOREVER) == 0) {
+        __atomic_fetch_add(&ftx_woken, 1, __ATOMIC_RELAXED);
+    }
+    __atomic_fetch_add(&ftx_done, 1, __ATOMIC_RELEASE);
+}
+
+/* 启动 n 个等待线程，等到它们都阻塞在 futex 上 */
+static bool ftx_start_waiters(uint32_t n) {
+    ftx_word_a = 0;
+    ftx_word_b = 0;
+    ftx_woken = 0;
+    ftx_done = 0;
+
+    for (uint32_t i = 0; i < n; i++) {
+        ftx_pids[i] = task_create_kernel_thread(ftx_waiter_thread, "futex_waiter");
+        if (ftx_pids[i] == 0) {
+            return false;
+        }
+    }
+
+    uint64_t t0 = timer_get_uptime_ms();
+    for (uint32_t i = 0; i < n; i++) {
+        task_t *task;
+        while ((task = task_get_by_pid(ftx_pids[i])) != NULL &&
+               task->state != TASK_BLOCKED) {
+            if (timer_get_uptime_ms() - t0 > FTX_TIMEOUT_MS) {
+                return false;
+            }
+            task_yield();
+        }
+    }
+    return true;
+}
+
+/* 等待已唤醒的线程退出 */
+static bool ftx_wait_done(uint32_t n) {
+    uint64_t t0 = timer_get_uptime_ms();
+    while (__atomic_load_n(&ftx_done, __ATOMIC_ACQUIRE) < n) {
+        if (timer_get_uptime_ms() - t0 > FTX_TIMEOUT_MS) {
+            return false;
+        }
+        task_yield();
+    }
+    return true;
+}
+
+// 与 user/lib/src/sync.c 相同的三态互斥锁：0 未锁定，1 已锁定，2 可能有等待者
+static volatile uint32_t ftx_mutex = 0;
+static volatile uint32_t ftx_counter = 0;
+
+static void ftx_mutex_lock(volatile uint32_t *m) {
+    uint32_t expected = 0;
+    if (__atomic_compare_exchange_n(m, &expected, 1, false,
+                                    __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+        return;
+    }
+    while (__atomic_exchange_n(m, 2, __ATOMIC_ACQUIRE) != 0) {
+        futex_wait(m, 2, WAIT_FOREVER);
+    }
+}
+
+static void ftx_mutex_unlock(volatile uint32_t *m) {
+    if (__atomic_fetch_sub(m, 1, __ATOMIC_RELEASE) != 1) {
+        __atomic_store_n(m, 0, __ATOMIC_RELEASE);
+        futex_wake(m, 1);
+    }
+}
+
+static void ftx_bench_thread(void) {
+    for (uint32_t i = 0; i < FTX_BENCH_ITERS; i++) {
+        ftx_mutex_lock(&ftx_mutex);
+        uint32_t value = ftx_counter;
+        if ((i & 255) == 0) {
+            task_yield();       // 持锁让出，制造真正的睡眠等待
+        }
+        ftx_counter = value + 1;
+        ftx_mutex_unlock(&ftx_mutex);
+    }
+    __atomic_fetch_add(&ftx_done, 1, __ATOMIC_RELEASE);
+}
+
+// ============================================================================
+// 测试用例
+// ============================================================================
+
+TEST_CASE(test_futex_wait_errors) {
+    static volatile uint32_t word = 5;
+
+    ASSERT_EQ(futex_wait(&word, 4, WAIT_FOREVER), -EAGAIN);
+    ASSERT_EQ(futex_wait(&word, 5, 0), -ETIMEDOUT);
+
+    uint64_t t0 = timer_get_uptime_ms();
+    ASSERT_EQ(futex_wait(&word, 5, 20), -ETIMEDOUT);
+    ASSERT_TRUE(timer_get_uptime_ms() - t0 >= 20);
+
+    // 未对齐和空地址
+    volatile uint32_t *unaligned = (volatile uint32_t *)((uintptr_t)&word + 1);
+    ASSERT_EQ(futex_wait(unaligned, 0, 0), -EFAULT);
+    ASSERT_EQ(futex_wake(NULL, 1), -EFAULT);
+    ASSERT_EQ(futex_wake(&word, 1), 0);
+}
+
+TEST_CASE(test_futex_wake) {
+    ASSERT_TRUE(ftx_start_waiters(FTX_WAITERS));
+
+    // 别的地址上没有等待者
+    ASSERT_EQ(futex_wake(&ftx_word_b, FTX_WAITERS), 0);
+
+    ftx_word_a = 1;
+    ASSERT_EQ(futex_wake(&ftx_word_a, 1), 1);
+    ASSERT_EQ(futex_wake(&ftx_word_a, FTX_WAITERS), FTX_WAITERS - 1);
+    ASSERT_EQ(futex_wake(&ftx_word_a, FTX_WAITERS), 0);
+
+    ASSERT_TRUE(ftx_wait_done(FTX_WAITERS));
+    ASSERT_EQ_UINT(ftx_woken, FTX_WAITERS);
+}
+
+TEST_CASE(test_futex_requeue) {
+    ASSERT_TRUE(ftx_start_waiters(FTX_WAITERS));
+
+    // 唤醒一个，其余迁移到 ftx_word_b 上继续睡眠
+    ftx_word_a = 1;
+    ASSERT_EQ(futex_requeue(&ftx_word_a, 1, &ftx_word_b, FTX_WAITERS), FTX_WAITERS);
+    ASSERT_TRUE(ftx_wait_done(1));
+    ASSERT_EQ(futex_wake(&ftx_word_a, FTX_WAITERS), 0);
+
+    for (uint32_t i = 0; i < 10; i++) {
+        task_yield();
+    }
+    ASSERT_EQ_UINT(ftx_done, 1);
+
+    ASSERT_EQ(futex_wake(&ftx_word_b, FTX_WAITERS), FTX_WAITERS - 1);
+    ASSERT_TRUE(ftx_wait_done(FTX_WAITERS));
+    ASSERT_EQ_UINT(ftx_woken, FTX_WAITERS);
+}
+
+TEST_CASE(test_futex_mutex_bench) {
+    ftx_mutex = 0;
+    ftx_counter = 0;
+    ftx_done = 0;
+
+    // 无竞争：只有原子指令
+    uint64_t t0 = timer_get_uptime_ms();
+    for (uint32_t i = 0; i < FTX_BENCH_THREADS * FTX_BENCH_ITERS; i++) {
+        ftx_mutex_lock(&ftx_mutex);
+        ftx_counter++;
+        ftx_mutex_unlock(&ftx_mutex);
+    }
+    uint32_t uncontended_ms = (uint32_t)(timer_get_uptime_ms() - t0);
+    ASSERT_EQ_UINT(ftx_counter, FTX_BENCH_THREADS * FTX_BENCH_ITERS);
+    ASSERT_EQ_UINT(ftx_mutex, 0);
+
+    // 有竞争：多个线程争用，持锁者会让出 CPU
+    ftx_counter = 0;
+    t0 = timer_get_uptime_ms();
+    for (uint32_t i = 0; i < FTX_BENCH_THREADS; i++) {
+        ASSERT_NE_UINT(task_create_kernel_thread(ftx_bench_thread, "futex_bench"), 0);
+    }
+    ASSERT_TRUE(ftx_wait_done(FTX_BENCH_THREADS));
+    uint32_t contended_ms = (uint32_t)(timer_get_uptime_ms() - t0);
+
+    ASSERT_EQ_UINT(ftx_counter, FTX_BENCH_THREADS * FTX_BENCH_ITERS);
+    ASSERT_EQ_UINT(ftx_mutex, 0);
+    kprintf("    %u lock/unlock: uncontended %u ms, contended (%u threads) %u ms\n",
+            FTX_BENCH_THREADS * FTX_BENCH_ITERS, uncontended_ms,
+            FTX_BENCH_THREADS, contended_ms);
+}
+
+// ============================================================================
+// 测试套件定义
+// ============================================================================
+
+TEST_SUITE(futex_tests) {
+    RUN_TEST(test_futex_wait_errors);
+    RUN_TEST(test_futex_wake);
+    RUN_TEST(test_futex_requeue);
+    RUN_TEST(test_futex_mutex_bench);
+}
+
+// ============================================================================
+// 运行所有测试
+// ============================================================================
+
+void run_futex_tests(void) {
+    // 初始化测试框架
+    unittest_init();
+
+    // 运行所有测试套件
+    RUN_SUITE(futex_tests);
+
+    // 打印测试摘要
+    unittest_print_summary();
+}
+
+// ============================================================================
+// 模块注册
+// ============================================================================
+
+TEST_MODULE_DESC(futex, KERNEL, run_futex_tests,
+    "Futex - wait/wake/requeue semantics and futex mutex contention cost");
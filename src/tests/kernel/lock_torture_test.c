@@ -0,0 +1,310 @@
+// ============================================================================
+// lock_torture_test.c - 自旋锁压力测试
+// ============================================================================
+//
+// 模块名称: lock_torture
+// 子系统: kernel (内核核心)
+// 描述: 多个内核线程反复争用同一把锁，检查互斥与计数，并在定时器中断里
+//       同时获取其他锁，验证等待中被中断打断后的嵌套获取
+//
+//       调度是协作式的，线程只在主动让出时切换。持有者在临界区内
+//       task_yield()，其他线程因此会看到锁被占用；等待方用 try_lock 加
+//       让出代替自旋，否则持有者得不到运行机会
+//
+// 功能覆盖:
+//   - 排队自旋锁（spinlock_t）：取号/叫号状态、互斥、无丢失更新
+//   - MCS 队列锁（qspinlock_t）：互斥、无丢失更新
+//   - 持有者在临界区内让出，其他线程实际遇到争用
+//   - 任务持有锁时被中断打断，中断处理程序获取另外的锁
+// ============================================================================
+
+#include <tests/ktest.h>
+#include <tests/kernel/lock_torture_test.h>
+#include <tests/test_module.h>
+#include <kernel/sync/spinlock.h>
+#include <kernel/sync/qspinlock.h>
+#include <kernel/task.h>
+#include <drivers/timer.h>
+#include <lib/kprintf.h>
+#include <types.h>
+
+#define LTT_THREADS         4
+#define LTT_ITERATIONS      4000
+#define LTT_HOLD_SPINS      16          // 临界区内的停顿，放大被中断打断的窗口
+#define LTT_HOLD_YIELD      4           // 每 4 次迭代在临界区内让出一次
+#define LTT_IRQ_INTERVAL_MS 10
+#define LTT_TIMEOUT_MS      20000
+
+// 任务侧对中断共享计数的更新次数（每 64 次迭代一次）
+#define LTT_IRQ_TASK_UPDATES    (LTT_THREADS * ((LTT_ITERATIONS + 63) / 64))
+
+typedef enum {
+    LTT_TICKET,
+    LTT_QSPIN,
+} ltt_lock_kind_t;
+
+static spinlock_t ltt_ticket;
+static qspinlock_t ltt_qspin;
+static volatile ltt_lock_kind_t ltt_kind;
+
+static volatile uint32_t ltt_counter = 0;     // 受锁保护，非原子读-改-写
+static volatile uint32_t ltt_holders = 0;     // 临界区内的线程数
+static volatile uint32_t ltt_violations = 0;
+static volatile uint32_t ltt_contended = 0;  // try_lock 失败的次数
+static volatile uint32_t ltt_done = 0;
+static volatile bool ltt_stop = false;        // 超时后通知工作线程提前退出
+static bool ltt_stuck = false;                // 上一轮的工作线程未能退出
+
+// 中断侧：定时器回调与任务都会获取的锁
+static spinlock_t ltt_irq_ticket;
+static qspinlock_t ltt_irq_qspin;
+static volatile uint32_t ltt_irq_counter = 0;
+static volatile uint32_t ltt_irq_hits = 0;
+
+static bool ltt_try_lock(void) {
+    if (ltt_kind == LTT_TICKET) {
+        return spinlock_try_lock(&ltt_ticket);
+    }
+    return qspin_try_lock(&ltt_qspin);
+}
+
+/* 协作式调度下持有者可能已让出，等待方不能原地自旋 */
+static void ltt_lock(void) {
+    while (!ltt_try_lock()) {
+        __atomic_fetch_add(&ltt_contended, 1, __ATOMIC_RELAXED);
+        task_yield();
+    }
+}
+
+static void ltt_unlock(void) {
+    if (ltt_kind == LTT_TICKET) {
+        spinlock_unlock(&ltt_ticket);
+    } else {
+        qspin_unlock(&ltt_qspin);
+    }
+}
+
+/* 在中断上下文中嵌套获取两种锁 */
+static void ltt_irq_callback(void *data) {
+    (void)data;
+    spinlock_lock(&ltt_irq_ticket);
+    qspin_lock(&ltt_irq_qspin);
+    ltt_irq_counter++;
+    qspin_unlock(&ltt_irq_qspin);
+    spinlock_unlock(&ltt_irq_ticket);
+    __atomic_fetch_add(&ltt_irq_hits, 1, __ATOMIC_RELAXED);
+}
+
+static void ltt_worker_thread(void) {
+    for (uint32_t i = 0; i < LTT_ITERATIONS; i++) {
+        if (__atomic_load_n(&ltt_stop, __ATOMIC_ACQUIRE)) {
+            break;
+        }
+
+        // 主锁在开中断状态下获取，持有期间可能被定时器打断
+        ltt_lock();
+
+        if (__atomic_add_fetch(&ltt_holders, 1, __ATOMIC_ACQ_REL) != 1) {
+            __atomic_fetch_add(&ltt_violations, 1, __ATOMIC_RELAXED);
+        }
+
+        uint32_t value = ltt_counter;
+        for (uint32_t s = 0; s < LTT_HOLD_SPINS; s++) {
+            cpu_relax();
+        }
+        // 持锁让出：其他线程在这段时间内尝试加锁
+        if ((i % LTT_HOLD_YIELD) == 0) {
+            task_yield();
+        }
+        ltt_counter = value + 1;
+
+        // 与中断共享的计数：关中断后按与中断相同的顺序加锁
+        if ((i % 64) == 0) {
+            bool irq_state;
+            spinlock_lock_irqsave(&ltt_irq_ticket, &irq_state);
+            qspin_lock(&ltt_irq_qspin);
+            ltt_irq_counter++;
+            qspin_unlock(&ltt_irq_qspin);
+            spinlock_unlock_irqrestore(&ltt_irq_ticket, irq_state);
+        }
+
+        __atomic_sub_fetch(&ltt_holders, 1, __ATOMIC_ACQ_REL);
+        ltt_unlock();
+        task_yield();
+    }
+    __atomic_fetch_add(&ltt_done, 1, __ATOMIC_RELEASE);
+}
+
+/* 等待已启动的工作线程全部退出 */
+static bool ltt_wait_workers(uint32_t started, uint64_t deadline) {
+    while (__atomic_load_n(&ltt_done, __ATOMIC_ACQUIRE) < started) {
+        if (timer_get_uptime_ms() > deadline) {
+            return false;
+        }
+        task_yield();
+    }
+    return true;
+}
+
+/* 运行一轮压力测试，返回是否在超时前完成 */
+static bool ltt_run(ltt_lock_kind_t kind, uint32_t *elapsed_ms) {
+    *elapsed_ms = 0;
+    // 上一轮的线程仍在运行时不能重置它们正在使用的锁和计数
+    if (ltt_stuck) {
+        kprintf("    previous workers still running, skipped\n");
+        return false;
+    }
+
+    spinlock_init(&ltt_ticket);
+    qspin_init(&ltt_qspin);
+    spinlock_init(&ltt_irq_ticket);
+    qspin_init(&ltt_irq_qspin);
+    ltt_kind = kind;
+    ltt_counter = 0;
+    ltt_holders = 0;
+    ltt_violations = 0;
+    ltt_contended = 0;
+    ltt_done = 0;
+    ltt_stop = false;
+    ltt_irq_counter = 0;
+    ltt_irq_hits = 0;
+
+    uint32_t timer_id = timer_register_callback(ltt_irq_callback, NULL,
+                                                LTT_IRQ_INTERVAL_MS, true);
+
+    uint64_t t0 = timer_get_uptime_ms();
+    uint32_t started = 0;
+    while (started < LTT_THREADS) {
+        if (task_create_kernel_thread(ltt_worker_thread, "lock_torture") == 0) {
+            break;
+        }
+        started++;
+    }
+
+    bool finished = ltt_wait_workers(started, t0 + LTT_TIMEOUT_MS) &&
+                    started == LTT_THREADS;
+    *elapsed_ms = (uint32_t)(timer_get_uptime_ms() - t0);
+
+    if (!finished) {
+        // 让剩下的线程尽快退出，确认退出后才允许下一轮
+        __atomic_store_n(&ltt_stop, true, __ATOMIC_RELEASE);
+        if (!ltt_wait_workers(started, timer_get_uptime_ms() + LTT_TIMEOUT_MS)) {
+            ltt_stuck = true;
+        }
+    }
+
+    if (timer_id != 0) {
+        timer_unregister_callback(timer_id);
+    }
+    return finished;
+}
+
+// ============================================================================
+// 测试用例
+// ============================================================================
+
+TEST_CASE(test_ticket_lock_state) {
+    spinlock_t lock;
+    spinlock_init(&lock);
+    ASSERT_FALSE(spinlock_is_locked(&lock));
+
+    // 取号后 next 前进，释放后叫号追上
+    spinlock_lock(&lock);
+    ASSERT_TRUE(spinlock_is_locked(&lock));
+    ASSERT_EQ_UINT(lock.tickets.owner, 0);
+    ASSERT_EQ_UINT(lock.tickets.next, 1);
+    ASSERT_FALSE(spinlock_try_lock(&lock));
+    spinlock_unlock(&lock);
+    ASSERT_EQ_UINT(lock.tickets.owner, 1);
+    ASSERT_FALSE(spinlock_is_locked(&lock));
+
+    // 多余的释放被忽略，锁仍可获取
+    spinlock_unlock(&lock);
+    ASSERT_EQ_UINT(lock.tickets.owner, 1);
+    ASSERT_TRUE(spinlock_try_lock(&lock));
+    spinlock_unlock(&lock);
+
+    // 号码回绕
+    lock.tickets.owner = 0xFFFF;
+    lock.tickets.next = 0xFFFF;
+    spinlock_lock(&lock);
+    ASSERT_TRUE(spinlock_is_locked(&lock));
+    spinlock_unlock(&lock);
+    ASSERT_EQ_UINT(lock.tickets.owner, 0);
+    ASSERT_EQ_UINT(lock.tickets.next, 0);
+}
+
+TEST_CASE(test_qspinlock_state) {
+    qspinlock_t lock;
+    qspin_init(&lock);
+    ASSERT_FALSE(qspin_is_locked(&lock));
+
+    bool irq_state;
+    qspin_lock_irqsave(&lock, &irq_state);
+    ASSERT_TRUE(qspin_is_locked(&lock));
+    ASSERT_FALSE(qspin_try_lock(&lock));
+    ASSERT_NULL(lock.tail);
+    qspin_unlock_irqrestore(&lock, irq_state);
+    ASSERT_FALSE(qspin_is_locked(&lock));
+
+    ASSERT_TRUE(qspin_try_lock(&lock));
+    qspin_unlock(&lock);
+}
+
+TEST_CASE(test_ticket_lock_torture) {
+    uint32_t ms = 0;
+    ASSERT_TRUE(ltt_run(LTT_TICKET, &ms));
+    ASSERT_EQ_UINT(ltt_violations, 0);
+    ASSERT_TRUE(ltt_contended > 0);
+    ASSERT_EQ_UINT(ltt_counter, LTT_THREADS * LTT_ITERATIONS);
+    ASSERT_FALSE(spinlock_is_locked(&ltt_ticket));
+    ASSERT_EQ_UINT(ltt_irq_counter, LTT_IRQ_TASK_UPDATES + ltt_irq_hits);
+    kprintf("    ticket: %u acquisitions in %u ms, %u contended, %u irq nestings\n",
+            LTT_THREADS * LTT_ITERATIONS, ms, ltt_contended, ltt_irq_hits);
+}
+
+TEST_CASE(test_qspinlock_torture) {
+    uint32_t ms = 0;
+    ASSERT_TRUE(ltt_run(LTT_QSPIN, &ms));
+    ASSERT_EQ_UINT(ltt_violations, 0);
+    ASSERT_TRUE(ltt_contended > 0);
+    ASSERT_EQ_UINT(ltt_counter, LTT_THREADS * LTT_ITERATIONS);
+    ASSERT_FALSE(qspin_is_locked(&ltt_qspin));
+    ASSERT_NULL(ltt_qspin.tail);
+    ASSERT_EQ_UINT(ltt_irq_counter, LTT_IRQ_TASK_UPDATES + ltt_irq_hits);
+    kprintf("    qspin:  %u acquisitions in %u ms, %u contended, %u irq nestings\n",
+            LTT_THREADS * LTT_ITERATIONS, ms, ltt_contended, ltt_irq_hits);
+}
+
+// ============================================================================
+// 测试套件定义
+// ============================================================================
+
+TEST_SUITE(lock_torture_tests) {
+    RUN_TEST(test_ticket_lock_state);
+    RUN_TEST(test_qspinlock_state);
+    RUN_TEST(test_ticket_lock_torture);
+    RUN_TEST(test_qspinlock_torture);
+}
+
+// ============================================================================
+// 运行所有测试
+// ============================================================================
+
+void run_lock_torture_tests(void) {
+    // 初始化测试框架
+    unittest_init();
+
+    // 运行所有测试套件
+    RUN_SUITE(lock_torture_tests);
+
+    // 打印测试摘要
+    unittest_print_summary();
+}
+
+// ============================================================================
+// 模块注册
+// ============================================================================
+
+TEST_MODULE_DESC(lock_torture, KERNEL, run_lock_torture_tests,
+    "Spinlock torture - ticket and MCS locks under thread contention and IRQ nesting");
@@ -3,6 +3,9 @@
 #include <kernel/sync/spinlock.h>
 #include <kernel/sync/mutex.h>
 #include <kernel/sync/semaphore.h>
+#include <kernel/sync/rwsem.h>
+#include <kernel/sync/rwlock.h>
+#include <kernel/sync/lockstat.h>
 
 static void test_spinlock_basic(void) {
     spinlock_t lock;
@@ -53,11 +56,127 @@ static void test_semaphore_basic(void) {
     ASSERT_EQ(1, semaphore_get_value(&sem));
 }
 
+static void test_rwsem_basic(void) {
+    rw_semaphore_t sem;
+    rwsem_init(&sem);
+
+    /* 读锁可以共享，持有读锁时写锁不可得 */
+    rwsem_read_lock(&sem);
+    ASSERT_TRUE(rwsem_try_read_lock(&sem));
+    ASSERT_EQ(2, (int)sem.readers);
+    ASSERT_FALSE(rwsem_try_write_lock(&sem));
+
+    rwsem_read_unlock(&sem);
+    rwsem_read_unlock(&sem);
+    ASSERT_EQ(0, (int)sem.readers);
+
+    /* 写锁独占 */
+    rwsem_write_lock(&sem);
+    ASSERT_TRUE(sem.writer);
+    ASSERT_FALSE(rwsem_try_read_lock(&sem));
+    ASSERT_FALSE(rwsem_try_write_lock(&sem));
+    rwsem_write_unlock(&sem);
+    ASSERT_FALSE(sem.writer);
+}
+
+static void test_rwsem_writer_preference(void) {
+    rw_semaphore_t sem;
+    rwsem_init(&sem);
+
+    /* 有写者排队时新的读者不能插队 */
+    sem.writers_waiting = 1;
+    ASSERT_FALSE(rwsem_try_read_lock(&sem));
+    sem.writers_waiting = 0;
+    ASSERT_TRUE(rwsem_try_read_lock(&sem));
+    rwsem_read_unlock(&sem);
+}
+
+static void test_rwlock_basic(void) {
+    rwlock_t lock;
+    rwlock_init(&lock);
+
+    rwlock_read_lock(&lock);
+    ASSERT_TRUE(rwlock_try_read_lock(&lock));
+    ASSERT_EQ(2, (int)atomic_read(&lock.state));
+    ASSERT_FALSE(rwlock_try_write_lock(&lock));
+    rwlock_read_unlock(&lock);
+    rwlock_read_unlock(&lock);
+
+    bool irq_state;
+    rwlock_write_lock_irqsave(&lock, &irq_state);
+    ASSERT_EQ_U(RWLOCK_WRITER, atomic_read(&lock.state));
+    ASSERT_FALSE(rwlock_try_read_lock(&lock));
+    ASSERT_FALSE(rwlock_try_write_lock(&lock));
+    rwlock_write_unlock_irqrestore(&lock, irq_state);
+    ASSERT_EQ(0, (int)atomic_read(&lock.state));
+}
+
+static void test_rwlock_writer_preference(void) {
+    rwlock_t lock;
+    rwlock_init(&lock);
+
+    /* 写者登记等待后，即使只有读者持有，新读者也不能进入 */
+    rwlock_read_lock(&lock);
+    atomic_set(&lock.writers_waiting, 1);
+    ASSERT_FALSE(rwlock_try_read_lock(&lock));
+    atomic_set(&lock.writers_waiting, 0);
+    ASSERT_TRUE(rwlock_try_read_lock(&lock));
+    rwlock_read_unlock(&lock);
+    rwlock_read_unlock(&lock);
+}
+
+static void test_lockstat_counting(void) {
+    mutex_t m;
+    mutex_init_named(&m, "test_mutex");
+    ASSERT_NOT_NULL(m.cls);
+
+    /* 同名锁共享一个类 */
+    ASSERT_EQ_PTR(m.cls, lockstat_class("test_mutex", LOCK_CLASS_MUTEX));
+
+    uint32_t acquired = atomic_read(&m.cls->acquisitions);
+    uint32_t contended = atomic_read(&m.cls->contended);
+
+    /* 递归获取不重复计数 */
+    mutex_lock(&m);
+    mutex_lock(&m);
+    mutex_unlock(&m);
+    mutex_unlock(&m);
+    ASSERT_TRUE(mutex_try_lock(&m));
+    mutex_unlock(&m);
+    ASSERT_EQ_U(acquired + 2, atomic_read(&m.cls->acquisitions));
+    ASSERT_EQ_U(contended, atomic_read(&m.cls->contended));
+
+    uint64_t start = lockstat_wait_begin(m.cls);
+    lockstat_wait_end(m.cls, start, false);
+    ASSERT_EQ_U(contended + 1, atomic_read(&m.cls->contended));
+
+    /* 未命名的锁不统计 */
+    rwlock_t anon;
+    rwlock_init(&anon);
+    ASSERT_NULL(anon.cls);
+
+    /* 表头之外至少有一行 */
+    char buf[2048];
+    int len = lockstat_dump(buf, sizeof(buf));
+    int lines = 0;
+    for (int i = 0; i < len && i < (int)sizeof(buf); i++) {
+        if (buf[i] == '\n') {
+            lines++;
+        }
+    }
+    ASSERT_TRUE(lines >= 2);
+}
+
 void run_sync_tests(void) {
     unittest_begin_suite("Synchronization Primitive Tests");
     unittest_run_test("spinlock basic operations", test_spinlock_basic);
     unittest_run_test("mutex recursive locking", test_mutex_recursive);
     unittest_run_test("semaphore basic operations", test_semaphore_basic);
+    unittest_run_test("rwsem shared readers and exclusive writer", test_rwsem_basic);
+    unittest_run_test("rwsem writer preference", test_rwsem_writer_preference);
+    unittest_run_test("rwlock shared readers and exclusive writer", test_rwlock_basic);
+    unittest_run_test("rwlock writer preference", test_rwlock_writer_preference);
+    unittest_run_test("lockstat acquisition and contention counting", test_lockstat_counting);
     unittest_end_suite();
 }
 
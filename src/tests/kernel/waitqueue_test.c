@@ -0,0 +1,291 @@
+// ============================================================================
+// waitqueue_test.c - 等待队列测试
+// ============================================================================
+//
+// 模块名称: waitqueue
+// 子系统: kernel (内核核心)
+// 描述: 用回调等待项和内核线程检查 wait_queue 的唤醒、摘除与条件等待
+//
+// 功能覆盖:
+//   - wake 通知全部等待项并传递 key，wake_one 只通知队首
+//   - remove 之后不再收到通知，队列为空
+//   - wake_match 按条件摘除并受 nr 限制，detach_all 清空队列
+//   - wait_queue_wait：条件不成立时超时，被其他线程唤醒后返回
+//   - task_wake/task_wakeup 只唤醒在对应对象上阻塞的任务
+// ============================================================================
+
+#include <tests/ktest.h>
+#include <tests/kernel/waitqueue_test.h>
+#include <tests/test_module.h>
+#include <kernel/sync/waitqueue.h>
+#include <kernel/task.h>
+#include <drivers/timer.h>
+#include <lib/kprintf.h>
+#include <types.h>
+
+#define WQT_ENTRIES         3
+#define WQT_TIMEOUT_MS      5000
+
+// ============================================================================
+// 辅助函数
+// ============================================================================
+
+/* 回调等待项：记录收到的通知次数和最后一次的 key */
+typedef struct {
+    uint32_t calls;
+    uint32_t key;
+} wqt_counter_t;
+
+static void wqt_callback(wait_queue_entry_t *entry, uint32_t key) {
+    wqt_counter_t *counter = (wqt_counter_t *)entry->data;
+    counter->calls++;
+    counter->key = key;
+}
+
+static void wqt_setup(wait_queue_t *wq, wait_queue_entry_t *entries, wqt_counter_t *counters) {
+    wait_queue_init(wq);
+    for (uint32_t i = 0; i < WQT_ENTRIES; i++) {
+        counters[i].calls = 0;
+        counters[i].key = 0;
+        wait_queue_entry_init_func(&entries[i], wqt_callback, &counters[i]);
+        wait_queue_add(wq, &entries[i]);
+    }
+}
+
+static bool wqt_match_data(wait_queue_entry_t *entry, void *arg) {
+    return entry->data == arg;
+}
+
+static bool wqt_match_any(wait_queue_entry_t *entry, void *arg) {
+    (void)entry;
+    (void)arg;
+    return true;
+}
+
+/* 条件等待：等待线程睡在 wqt_wq 上直到 wqt_flag 置位 */
+static wait_queue_t wqt_wq;
+static volatile bool wqt_flag;
+static volatile int wqt_wait_ret;
+static volatile bool wqt_done;
+
+static bool wqt_flag_set(void *arg) {
+    (void)arg;
+    return wqt_flag;
+}
+
+static void wqt_waiter_thread(void) {
+    wqt_wait_ret = wait_queue_wait(&wqt_wq, wqt_flag_set, NULL, WQT_TIMEOUT_MS);
+    __atomic_store_n(&wqt_done, true, __ATOMIC_RELEASE);
+}
+
+// ============================================================================
+// 测试用例
+// ============================================================================
+
+TEST_CASE(test_wq_wake_all) {
+    wait_queue_t wq;
+    wait_queue_entry_t entries[WQT_ENTRIES];
+    wqt_counter_t counters[WQT_ENTRIES];
+    wqt_setup(&wq, entries, counters);
+
+    ASSERT_TRUE(wait_queue_active(&wq));
+    wait_queue_wake(&wq, 0x5);
+    for (uint32_t i = 0; i < WQT_ENTRIES; i++) {
+        ASSERT_EQ_UINT(1, counters[i].calls);
+        ASSERT_EQ_UINT(0x5, counters[i].key);
+    }
+
+    // 回调项被通知后仍留在队列上
+    ASSERT_TRUE(wait_queue_active(&wq));
+    wait_queue_wake(&wq, 0);
+    ASSERT_EQ_UINT(2, counters[WQT_ENTRIES - 1].calls);
+
+    for (uint32_t i = 0; i < WQT_ENTRIES; i++) {
+        wait_queue_remove(&entries[i]);
+    }
+}
+
+TEST_CASE(test_wq_wake_one) {
+    wait_queue_t wq;
+    wait_queue_entry_t entries[WQT_ENTRIES];
+    wqt_counter_t counters[WQT_ENTRIES];
+    wqt_setup(&wq, entries, counters);
+
+    wait_queue_wake_one(&wq, 0x1);
+    ASSERT_EQ_UINT(1, counters[0].calls);
+    ASSERT_EQ_UINT(0, counters[1].calls);
+    ASSERT_EQ_UINT(0, counters[2].calls);
+
+    for (uint32_t i = 0; i < WQT_ENTRIES; i++) {
+        wait_queue_remove(&entries[i]);
+    }
+}
+
+TEST_CASE(test_wq_remove) {
+    wait_queue_t wq;
+    wait_queue_entry_t entries[WQT_ENTRIES];
+    wqt_counter_t counters[WQT_ENTRIES];
+    wqt_setup(&wq, entries, counters);
+
+    // 摘除中间项，其余仍按顺序相连
+    wait_queue_remove(&entries[1]);
+    ASSERT_NULL(entries[1].queue);
+    wait_queue_wake(&wq, 0);
+    ASSERT_EQ_UINT(1, counters[0].calls);
+    ASSERT_EQ_UINT(0, counters[1].calls);
+    ASSERT_EQ_UINT(1, counters[2].calls);
+
+    // 重复摘除无害
+    wait_queue_remove(&entries[1]);
+    wait_queue_remove(&entries[0]);
+    wait_queue_remove(&entries[2]);
+    ASSERT_FALSE(wait_queue_active(&wq));
+    ASSERT_NULL(wq.tail);
+
+    wait_queue_wake(&wq, 0);
+    ASSERT_EQ_UINT(1, counters[0].calls);
+}
+
+TEST_CASE(test_wq_wake_match_and_detach) {
+    wait_queue_t wq;
+    wait_queue_entry_t entries[WQT_ENTRIES];
+    wqt_counter_t counters[WQT_ENTRIES];
+    wqt_setup(&wq, entries, counters);
+
+    // 只唤醒并摘除数据匹配的项
+    ASSERT_EQ(1, wait_queue_wake_match(&wq, wqt_match_data, &counters[1], 5));
+    ASSERT_EQ_UINT(1, counters[1].calls);
+    ASSERT_NULL(entries[1].queue);
+    ASSERT_EQ_UINT(0, counters[0].calls);
+
+    // nr 限制唤醒数
+    ASSERT_EQ(1, wait_queue_wake_match(&wq, wqt_match_any, NULL, 1));
+    ASSERT_EQ_UINT(1, counters[0].calls);
+    ASSERT_EQ_UINT(0, counters[2].calls);
+
+    wait_queue_detach_all(&wq, 0x10);
+    ASSERT_EQ_UINT(1, counters[2].calls);
+    ASSERT_EQ_UINT(0x10, counters[2].key);
+    ASSERT_NULL(entries[2].queue);
+    ASSERT_FALSE(wait_queue_active(&wq));
+}
+
+TEST_CASE(test_wq_wait_timeout) {
+    wait_queue_init(&wqt_wq);
+    wqt_flag = false;
+
+    uint64_t t0 = timer_get_uptime_ms();
+    int ret = wait_queue_wait(&wqt_wq, wqt_flag_set, NULL, 30);
+    uint32_t elapsed = (uint32_t)(timer_get_uptime_ms() - t0);
+
+    ASSERT_EQ(-1, ret);
+    ASSERT_TRUE(elapsed >= 20);
+    // 超时返回时等待项已摘除
+    ASSERT_FALSE(wait_queue_active(&wqt_wq));
+}
+
+TEST_CASE(test_wq_wait_woken) {
+    wait_queue_init(&wqt_wq);
+    wqt_flag = false;
+    wqt_wait_ret = 1;
+    wqt_done = false;
+
+    uint32_t pid = task_create_kernel_thread(wqt_waiter_thread, "wq_waiter");
+    ASSERT_NE_UINT(0, pid);
+
+    // 等到线程挂在队列上
+    uint64_t t0 = timer_get_uptime_ms();
+    while (!wait_queue_active(&wqt_wq) && timer_get_uptime_ms() - t0 < WQT_TIMEOUT_MS) {
+        task_yield();
+    }
+    bool queued = wait_queue_active(&wqt_wq);
+
+    wqt_flag = true;
+    wait_queue_wake(&wqt_wq, 0);
+    while (!__atomic_load_n(&wqt_done, __ATOMIC_ACQUIRE) &&
+           timer_get_uptime_ms() - t0 < WQT_TIMEOUT_MS) {
+        task_yield();
+    }
+    uint32_t elapsed = (uint32_t)(timer_get_uptime_ms() - t0);
+
+    ASSERT_TRUE(queued);
+    ASSERT_TRUE(wqt_done);
+    ASSERT_EQ(0, wqt_wait_ret);
+    // 由唤醒返回，而不是等到超时
+    ASSERT_TRUE(elapsed < WQT_TIMEOUT_MS);
+    ASSERT_FALSE(wait_queue_active(&wqt_wq));
+}
+
+/* 睡眠线程：task_sleep 不应被其他等待对象上的唤醒提前结束 */
+static volatile bool wqt_sleep_done;
+
+static void wqt_sleeper_thread(void) {
+    task_sleep(200);
+    __atomic_store_n(&wqt_sleep_done, true, __ATOMIC_RELEASE);
+}
+
+TEST_CASE(test_wq_wake_skips_other_object) {
+    wqt_sleep_done = false;
+
+    uint32_t pid = task_create_kernel_thread(wqt_sleeper_thread, "wq_sleeper");
+    ASSERT_NE_UINT(0, pid);
+    task_yield();
+
+    task_t *sleeper = task_get_by_pid(pid);
+    // 睡眠线程不在 wqt_wq 上等待，按该对象唤醒必须失败
+    bool woke = sleeper ? task_wake(sleeper, &wqt_wq) : true;
+    task_wakeup(NULL);
+    task_yield();
+    bool early = __atomic_load_n(&wqt_sleep_done, __ATOMIC_ACQUIRE);
+
+    uint64_t t0 = timer_get_uptime_ms();
+    while (!__atomic_load_n(&wqt_sleep_done, __ATOMIC_ACQUIRE) &&
+           timer_get_uptime_ms() - t0 < WQT_TIMEOUT_MS) {
+        task_yield();
+    }
+
+    ASSERT_NOT_NULL(sleeper);
+    ASSERT_FALSE(woke);
+    ASSERT_FALSE(early);
+    ASSERT_TRUE(wqt_sleep_done);
+}
+
+// ============================================================================
+// 测试套件定义
+// ============================================================================
+
+TEST_SUITE(waitqueue_wake_tests) {
+    RUN_TEST(test_wq_wake_all);
+    RUN_TEST(test_wq_wake_one);
+    RUN_TEST(test_wq_remove);
+    RUN_TEST(test_wq_wake_match_and_detach);
+}
+
+TEST_SUITE(waitqueue_wait_tests) {
+    RUN_TEST(test_wq_wait_timeout);
+    RUN_TEST(test_wq_wait_woken);
+    RUN_TEST(test_wq_wake_skips_other_object);
+}
+
+// ============================================================================
+// 运行所有测试
+// ============================================================================
+
+void run_waitqueue_tests(void) {
+    // 初始化测试框架
+    unittest_init();
+
+    // 运行所有测试套件
+    RUN_SUITE(waitqueue_wake_tests);
+    RUN_SUITE(waitqueue_wait_tests);
+
+    // 打印测试摘要
+    unittest_print_summary();
+}
+
+// ============================================================================
+// 模块注册
+// ============================================================================
+
+TEST_MODULE_DESC(waitqueue, KERNEL, run_waitqueue_tests,
+    "Wait queues - wake/wake_one/wake_match, removal, conditional wait");
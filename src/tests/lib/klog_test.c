@@ -3,6 +3,8 @@
 // ============================================================================
 // 
 // 测试内核日志系统功能
+//
+// 日志环测试：记录计数、/proc/kmsg 格式与按打开文件的快照、超长截断、按等级限速
 // ============================================================================
 
 #include <tests/ktest.h>
@@ -11,6 +13,8 @@
 #include <lib/kprintf.h>
 #include <lib/string.h>
 #include <drivers/serial.h>
+#include <mm/heap.h>
+#include <fs/vfs.h>
 
 // ============================================================================
 // 测试用例：日志等级设置和获取
@@ -325,6 +329,156 @@ TEST_CASE(test_klog_nested_color_changes) {
     kconsole_set_color(KCOLOR_WHITE, KCOLOR_BLACK);
 }
 
+// ============================================================================
+// 测试用例：日志环
+// ============================================================================
+
+#define KLOG_TEST_RECORDS   8
+
+/**
+ * 在 /proc/kmsg 内容中找包含 marker 的行，返回行首
+ */
+static const char *klog_test_find(const char *text, const char *marker) {
+    size_t mlen = strlen(marker);
+    const char *line = text;
+    for (const char *p = text; *p; p++) {
+        if (*p == '\n') {
+            line = p + 1;
+        } else if (strncmp(p, marker, mlen) == 0) {
+            return line;
+        }
+    }
+    return NULL;
+}
+
+TEST_CASE(test_klog_ring_records) {
+    klog_stats_t before, after;
+    klog_get_stats(&before);
+    for (int i = 0; i < KLOG_TEST_RECORDS; i++) {
+        klog(LOG_INFO, "klog ring test %d\n", i);
+    }
+    klog_flush();
+    klog_get_stats(&after);
+    ASSERT_EQ_UINT(KLOG_TEST_RECORDS, after.records - before.records);
+
+    char *text = (char *)kmalloc(KLOG_DUMP_BUF_SIZE);
+    ASSERT_NOT_NULL(text);
+    int len = klog_dump(text, KLOG_DUMP_BUF_SIZE);
+    ASSERT_TRUE(len > 0);
+    const char *line = klog_test_find(text, "klog ring test 7");
+    if (line == NULL) {
+        kfree(text);
+        ASSERT_TRUE(false);
+    }
+    bool ok = (strncmp(line, "<6>[", 4) == 0);
+    kfree(text);
+    ASSERT_TRUE(ok);
+}
+
+/* vksnprintf 的 %s 一次最多展开 63 个字符，长消息由多段拼出 */
+#define KLOG_TEST_PART      ((KLOG_MSG_MAX - 1) / 3)
+#define KLOG_TEST_REM       ((KLOG_MSG_MAX - 1) - 3 * KLOG_TEST_PART)
+
+TEST_CASE(test_klog_ring_truncate) {
+    char part[KLOG_TEST_PART + 1];
+    memset(part, 'x', KLOG_TEST_PART);
+    part[KLOG_TEST_PART] = '\0';
+    const char *rem = part + KLOG_TEST_PART - KLOG_TEST_REM;
+
+    klog_stats_t before, after;
+
+    // 恰好 KLOG_MSG_MAX - 1 个字符：放得下，不算截断
+    klog_get_stats(&before);
+    klog(LOG_INFO, "%s%s%s%s", part, part, part, rem);
+    klog_get_stats(&after);
+    ASSERT_EQ_UINT(0, after.truncated - before.truncated);
+
+    // 多一个字符即截断
+    klog_get_stats(&before);
+    klog(LOG_INFO, "%s%s%s%s\n", part, part, part, rem);
+    klog_get_stats(&after);
+    ASSERT_EQ_UINT(1, after.truncated - before.truncated);
+}
+
+/**
+ * 读到 EOF，返回读到的字节数
+ */
+static uint32_t klog_test_read_all(fs_node_t *node, uint32_t offset, char *buf, uint32_t size) {
+    uint32_t total = 0;
+    while (total + 1 < size) {
+        uint32_t n = vfs_read(node, offset + total, size - 1 - total, (uint8_t *)buf + total);
+        if (n == 0) {
+            break;
+        }
+        total += n;
+    }
+    buf[total] = '\0';
+    return total;
+}
+
+TEST_CASE(test_klog_proc_snapshot_per_open) {
+    fs_node_t *a = vfs_path_to_node("/proc/kmsg");
+    fs_node_t *b = vfs_path_to_node("/proc/kmsg");
+    if (!a || !b) {
+        vfs_release_node(a);
+        vfs_release_node(b);
+        kprintf("    /proc not mounted, skipped\n");
+        return;
+    }
+    // 每次打开各自一个节点，快照互不影响
+    ASSERT_NE_PTR(a, b);
+
+    char *text = (char *)kmalloc(KLOG_DUMP_BUF_SIZE);
+    ASSERT_NOT_NULL(text);
+    if (text) {
+        // a 在偏移 0 处生成快照，之后 b 重新生成不应改变 a 剩下的内容
+        uint8_t first[64];
+        uint32_t head = vfs_read(a, 0, sizeof(first), first);
+        klog(LOG_INFO, "klog per-open snapshot marker\n");
+        klog_test_read_all(b, 0, text, KLOG_DUMP_BUF_SIZE);
+        bool b_has = klog_test_find(text, "klog per-open snapshot marker") != NULL;
+        klog_test_read_all(a, head, text, KLOG_DUMP_BUF_SIZE);
+        bool a_has = klog_test_find(text, "klog per-open snapshot marker") != NULL;
+        kfree(text);
+
+        ASSERT_TRUE(head > 0);
+        ASSERT_TRUE(b_has);
+        ASSERT_FALSE(a_has);
+    }
+
+    vfs_release_node(a);
+    vfs_release_node(b);
+}
+
+TEST_CASE(test_klog_ratelimit) {
+    klog_set_level(LOG_DEBUG);
+    klog_set_ratelimit(LOG_DEBUG, 5, 60000);
+
+    klog_stats_t before, after;
+    klog_get_stats(&before);
+    for (int i = 0; i < 20; i++) {
+        klog(LOG_DEBUG, "klog ratelimit test %d\n", i);
+    }
+    klog_get_stats(&after);
+
+    klog_set_ratelimit(LOG_DEBUG, KLOG_RATELIMIT_DEBUG_BURST, KLOG_RATELIMIT_INTERVAL_MS);
+    klog_set_level(LOG_INFO);
+
+    ASSERT_EQ_UINT(15, after.suppressed[LOG_DEBUG] - before.suppressed[LOG_DEBUG]);
+    ASSERT_EQ_UINT(5, after.records - before.records);
+}
+
+TEST_CASE(test_klog_ratelimit_unlimited) {
+    klog_stats_t before, after;
+    klog_get_stats(&before);
+    for (int i = 0; i < 20; i++) {
+        klog(LOG_WARN, "klog unlimited test %d\n", i);
+    }
+    klog_get_stats(&after);
+    ASSERT_EQ_UINT(0, after.suppressed[LOG_WARN] - before.suppressed[LOG_WARN]);
+    ASSERT_EQ_UINT(20, after.records - before.records);
+}
+
 // ============================================================================
 // 测试套件定义
 // ============================================================================
@@ -391,6 +545,14 @@ TEST_SUITE(klog_color_tests) {
     RUN_TEST(test_klog_nested_color_changes);
 }
 
+TEST_SUITE(klog_ring_tests) {
+    RUN_TEST(test_klog_ring_records);
+    RUN_TEST(test_klog_ring_truncate);
+    RUN_TEST(test_klog_proc_snapshot_per_open);
+    RUN_TEST(test_klog_ratelimit);
+    RUN_TEST(test_klog_ratelimit_unlimited);
+}
+
 // ============================================================================
 // 运行所有 klog 测试
 // ============================================================================
@@ -408,6 +570,7 @@ void run_klog_tests(void) {
     RUN_SUITE(klog_boundary_tests);
     RUN_SUITE(klog_level_property_tests);
     RUN_SUITE(klog_color_tests);
+    RUN_SUITE(klog_ring_tests);
     
     // 打印测试摘要
     unittest_print_summary();
@@ -13,11 +13,17 @@
 //   - checksum_partial(): 增量校验和累加
 //   - checksum_finish(): 校验和折叠和取反
 //   - checksum_verify(): 校验和验证
+//   - checksum_pseudo()/checksum_l4_partial(): 伪首部与延迟校验和
+//   - 与逐 16 位参考实现的一致性及吞吐量基准（64B - 9KB，完整规模需 make bench）
 // ============================================================================
 
 #include <tests/ktest.h>
 #include <tests/net/checksum_test.h>
 #include <net/checksum.h>
+#include <net/netbuf.h>
+#include <net/ip.h>
+#include <drivers/timer.h>
+#include <lib/kprintf.h>
 #include <lib/string.h>
 
 // ============================================================================
@@ -366,6 +372,175 @@ TEST_CASE(test_checksum_ip_header_simulation) {
     ASSERT_TRUE(result);
 }
 
+// ============================================================================
+// 测试用例：优化实现与参考实现的一致性
+// ============================================================================
+
+#define CHECKSUM_BENCH_MAX      9216            // 最大测试缓冲区（9KB 巨帧）
+#define CHECKSUM_BENCH_BYTES    KTEST_BENCH_SIZE(8 * 1024 * 1024, 64 * 1024) // 每个尺寸累计处理的字节数
+
+static uint8_t checksum_bench_buf[CHECKSUM_BENCH_MAX + 8];
+
+/**
+ * 参考实现：逐 16 位累加（原始 RFC 1071 写法）
+ */
+static uint32_t checksum_ref16(uint32_t sum, const uint8_t *data, int len) {
+    while (len > 1) {
+        sum += (uint32_t)data[0] | ((uint32_t)data[1] << 8);
+        data += 2;
+        len -= 2;
+    }
+    if (len == 1) {
+        sum += data[0];
+    }
+    return sum;
+}
+
+static void checksum_bench_fill(void) {
+    uint32_t x = 0x12345678;
+    for (int i = 0; i < CHECKSUM_BENCH_MAX + 8; i++) {
+        x = x * 1103515245 + 12345;
+        checksum_bench_buf[i] = (uint8_t)(x >> 16);
+    }
+}
+
+/**
+ * 测试各长度、各起始对齐下与参考实现结果一致
+ */
+TEST_CASE(test_checksum_matches_reference) {
+    checksum_bench_fill();
+    
+    for (int offset = 0; offset < 4; offset++) {
+        for (int len = 0; len <= 300; len++) {
+            const uint8_t *p = checksum_bench_buf + offset;
+            uint16_t expected = checksum_finish(checksum_ref16(0, p, len));
+            uint16_t actual = checksum((void *)p, len);
+            ASSERT_EQ_UINT(expected, actual);
+        }
+    }
+    
+    // 大缓冲区
+    uint16_t expected = checksum_finish(checksum_ref16(0, checksum_bench_buf, CHECKSUM_BENCH_MAX));
+    ASSERT_EQ_UINT(expected, checksum(checksum_bench_buf, CHECKSUM_BENCH_MAX));
+}
+
+/**
+ * 测试累加值很大时仍能正确累加（部分和不溢出）
+ */
+TEST_CASE(test_checksum_partial_large_sum) {
+    checksum_bench_fill();
+    
+    uint32_t sum = 0xFFFFFFF0u;
+    uint32_t ref = checksum_ref16(0, checksum_bench_buf, 1500);
+    // 参考值：把初始和与数据和分别折叠后相加
+    uint64_t total = (uint64_t)sum + ref;
+    while (total >> 16) {
+        total = (total & 0xFFFF) + (total >> 16);
+    }
+    
+    sum = checksum_partial(sum, checksum_bench_buf, 1500);
+    ASSERT_EQ_UINT((uint16_t)~total, checksum_finish(sum));
+}
+
+/**
+ * 测试伪首部和与按内存布局累加的结果一致
+ */
+TEST_CASE(test_checksum_pseudo) {
+    uint32_t src = 0x630A10AC;  // 172.16.10.99（网络字节序）
+    uint32_t dst = 0x0C0A10AC;  // 172.16.10.12
+    uint8_t pseudo[12];
+    
+    memcpy(pseudo, &src, 4);
+    memcpy(pseudo + 4, &dst, 4);
+    pseudo[8] = 0;
+    pseudo[9] = IP_PROTO_TCP;
+    pseudo[10] = 0x05;          // 长度 1400（网络字节序）
+    pseudo[11] = 0x78;
+    
+    uint16_t expected = (uint16_t)~checksum_finish(checksum_partial(0, pseudo, 12));
+    ASSERT_EQ_UINT(expected, checksum_pseudo(src, dst, IP_PROTO_TCP, 1400));
+}
+
+/**
+ * 测试延迟校验和的软件补全与直接计算结果相同
+ */
+TEST_CASE(test_checksum_l4_partial_help) {
+    checksum_bench_fill();
+    
+    netbuf_t *buf = netbuf_alloc(200);
+    ASSERT_NOT_NULL(buf);
+    uint8_t *l4 = netbuf_put(buf, 200);
+    memcpy(l4, checksum_bench_buf, 200);
+    
+    uint32_t src = 0x0100000A, dst = 0x0200000A;
+    uint16_t *field = (uint16_t *)(l4 + 16);
+    
+    // 直接计算
+    uint8_t pseudo[12];
+    memcpy(pseudo, &src, 4);
+    memcpy(pseudo + 4, &dst, 4);
+    pseudo[8] = 0;
+    pseudo[9] = IP_PROTO_TCP;
+    pseudo[10] = 0;
+    pseudo[11] = 200;
+    *field = 0;
+    uint32_t sum = checksum_partial(0, pseudo, 12);
+    sum = checksum_partial(sum, l4, 200);
+    uint16_t expected = checksum_finish(sum);
+    
+    // 延迟计算后软件补全
+    checksum_l4_partial(buf, l4, 16, src, dst, IP_PROTO_TCP, 200);
+    ASSERT_TRUE(buf->csum_flags & NETBUF_CSUM_PARTIAL);
+    ASSERT_EQ(0, netbuf_checksum_help(buf));
+    ASSERT_FALSE(buf->csum_flags & NETBUF_CSUM_PARTIAL);
+    ASSERT_EQ_UINT(expected, *field);
+    
+    netbuf_free(buf);
+}
+
+// ============================================================================
+// 基准测试：64B - 9KB 缓冲区吞吐量
+// ============================================================================
+
+/**
+ * 对比优化实现与逐 16 位参考实现的吞吐量（结果打印到控制台）
+ */
+TEST_CASE(test_checksum_benchmark) {
+    static const int sizes[] = { 64, 128, 256, 512, 1024, 1500, 4096, 9000 };
+    volatile uint32_t sink = 0;
+    
+    checksum_bench_fill();
+    kprintf("  checksum throughput (MB/s):\n");
+    kprintf("    size   optimized   16-bit ref\n");
+    
+    for (uint32_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        int len = sizes[i];
+        uint32_t iters = CHECKSUM_BENCH_BYTES / (uint32_t)len;
+        
+        uint64_t t0 = timer_get_uptime_ms();
+        for (uint32_t n = 0; n < iters; n++) {
+            sink += checksum_partial(0, checksum_bench_buf, len);
+        }
+        uint64_t t1 = timer_get_uptime_ms();
+        for (uint32_t n = 0; n < iters; n++) {
+            sink += checksum_ref16(0, checksum_bench_buf, len);
+        }
+        uint64_t t2 = timer_get_uptime_ms();
+        
+        uint32_t fast_ms = (uint32_t)(t1 - t0);
+        uint32_t ref_ms = (uint32_t)(t2 - t1);
+        uint32_t bytes_kb = (iters * (uint32_t)len) / 1024;
+        kprintf("    %4d   %9u   %10u\n", len,
+                fast_ms ? bytes_kb / fast_ms : bytes_kb,
+                ref_ms ? bytes_kb / ref_ms : bytes_kb);
+        
+        // 同一输入两种实现结果必须一致
+        ASSERT_EQ_UINT(checksum_finish(checksum_ref16(0, checksum_bench_buf, len)),
+                       checksum(checksum_bench_buf, len));
+    }
+    (void)sink;
+}
+
 // ============================================================================
 // 测试套件定义
 // ============================================================================
@@ -403,6 +578,17 @@ TEST_SUITE(checksum_boundary_tests) {
     RUN_TEST(test_checksum_ip_header_simulation);
 }
 
+TEST_SUITE(checksum_optimized_tests) {
+    RUN_TEST(test_checksum_matches_reference);
+    RUN_TEST(test_checksum_partial_large_sum);
+    RUN_TEST(test_checksum_pseudo);
+    RUN_TEST(test_checksum_l4_partial_help);
+}
+
+TEST_SUITE(checksum_benchmark_tests) {
+    RUN_TEST(test_checksum_benchmark);
+}
+
 // ============================================================================
 // 运行所有测试
 // ============================================================================
@@ -417,6 +603,8 @@ void run_checksum_tests(void) {
     RUN_SUITE(checksum_finish_tests);
     RUN_SUITE(checksum_verify_tests);
     RUN_SUITE(checksum_boundary_tests);
+    RUN_SUITE(checksum_optimized_tests);
+    RUN_SUITE(checksum_benchmark_tests);
     
     // 打印测试摘要
     unittest_print_summary();
@@ -14,15 +14,19 @@
 //   - netbuf_push(): 在数据前添加空间
 //   - netbuf_pull(): 从数据前移除空间
 //   - netbuf_put(): 在数据后添加空间
-//   - netbuf_clone(): 缓冲区复制
+//   - netbuf_clone(): 共享数据区的克隆
 //   - netbuf_reset(): 缓冲区重置
 //   - netbuf_headroom(): 获取头部空间
 //   - netbuf_tailroom(): 获取尾部空间
+//   - netbuf_share()/netbuf_unshare(): 数据块共享
+//   - netbuf_pool_*(): 池耗尽、归还、容量上限、min_free 统计
+//   - netbuf_add_frag()/netbuf_linearize(): 页分片
 // ============================================================================
 
 #include <tests/ktest.h>
 #include <tests/net/netbuf_test.h>
 #include <net/netbuf.h>
+#include <mm/pmm.h>
 #include <lib/string.h>
 
 // ============================================================================
@@ -311,7 +315,7 @@ TEST_CASE(test_netbuf_pull_overflow) {
 
 /**
  * 测试基本克隆操作
- * 克隆应该创建独立的副本
+ * 克隆与源共享数据区，只复制描述符
  */
 TEST_CASE(test_netbuf_clone_basic) {
     netbuf_t *buf = netbuf_alloc(256);
@@ -335,9 +339,10 @@ TEST_CASE(test_netbuf_clone_basic) {
         ASSERT_EQ_UINT(buf->data[i], clone->data[i]);
     }
     
-    // 验证是独立的缓冲区
-    ASSERT_NE_PTR(buf->head, clone->head);
-    ASSERT_NE_PTR(buf->data, clone->data);
+    // 数据区共享，描述符独立
+    ASSERT_NE_PTR(buf, clone);
+    ASSERT_EQ_PTR(buf->data, clone->data);
+    ASSERT_TRUE(netbuf_is_shared(buf));
     
     netbuf_free(buf);
     netbuf_free(clone);
@@ -353,8 +358,7 @@ TEST_CASE(test_netbuf_clone_null) {
 }
 
 /**
- * 测试克隆后修改不影响原缓冲区
- * 数据应该是独立的
+ * 测试克隆后先 unshare 再修改不影响原缓冲区
  */
 TEST_CASE(test_netbuf_clone_independence) {
     netbuf_t *buf = netbuf_alloc(256);
@@ -368,7 +372,9 @@ TEST_CASE(test_netbuf_clone_independence) {
     netbuf_t *clone = netbuf_clone(buf);
     ASSERT_NOT_NULL(clone);
     
-    // 修改克隆的数据
+    // 修改前取得独占副本
+    ASSERT_EQ(0, netbuf_unshare(clone));
+    ASSERT_FALSE(netbuf_is_shared(buf));
     memset(clone->data, 0xBB, 32);
     
     // 验证原缓冲区数据未改变
@@ -603,6 +609,293 @@ TEST_CASE(test_netbuf_packet_parse) {
 }
 
 
+// ============================================================================
+// 测试用例：池回收与共享
+// ============================================================================
+
+/**
+ * 测试池缓冲区回收
+ * 释放后立即以同样大小分配，应复用同一数据块
+ */
+TEST_CASE(test_netbuf_pool_recycle) {
+    netbuf_t *buf = netbuf_alloc(64);
+    ASSERT_NOT_NULL(buf);
+    
+    if (buf->block) {
+        netbuf_block_t *block = buf->block;
+        ASSERT_EQ_PTR(block->virt, buf->head);
+        ASSERT_EQ_UINT(1, atomic_read(&block->refcount));
+        netbuf_free(buf);
+        
+        buf = netbuf_alloc(64);
+        ASSERT_NOT_NULL(buf);
+        ASSERT_EQ_PTR(block, buf->block);
+    }
+    
+    netbuf_free(buf);
+}
+
+/**
+ * 测试 netbuf_share() 共享数据块
+ */
+TEST_CASE(test_netbuf_share_basic) {
+    netbuf_t *buf = netbuf_alloc(256);
+    ASSERT_NOT_NULL(buf);
+    memcpy(netbuf_put(buf, 4), "ABCD", 4);
+    
+    netbuf_t *shared = netbuf_share(buf);
+    ASSERT_NOT_NULL(shared);
+    ASSERT_NE_PTR(buf, shared);
+    ASSERT_EQ_UINT(4, shared->len);
+    ASSERT_TRUE(memcmp(shared->data, "ABCD", 4) == 0);
+    
+    if (buf->block) {
+        // 池缓冲区：数据区共享
+        ASSERT_EQ_PTR(buf->head, shared->head);
+        ASSERT_TRUE(netbuf_is_shared(buf));
+    }
+    
+    // 释放源后共享者仍然有效
+    netbuf_free(buf);
+    ASSERT_FALSE(netbuf_is_shared(shared));
+    ASSERT_TRUE(memcmp(shared->data, "ABCD", 4) == 0);
+    netbuf_free(shared);
+}
+
+/**
+ * 测试 netbuf_unshare() 复制后修改互不影响
+ */
+TEST_CASE(test_netbuf_unshare) {
+    netbuf_t *buf = netbuf_alloc(256);
+    ASSERT_NOT_NULL(buf);
+    memcpy(netbuf_put(buf, 4), "ABCD", 4);
+    
+    netbuf_t *shared = netbuf_share(buf);
+    ASSERT_NOT_NULL(shared);
+    ASSERT_EQ(0, netbuf_unshare(shared));
+    ASSERT_FALSE(netbuf_is_shared(shared));
+    ASSERT_FALSE(netbuf_is_shared(buf));
+    
+    shared->data[0] = 'X';
+    ASSERT_EQ_UINT('A', buf->data[0]);
+    ASSERT_TRUE(memcmp(shared->data, "XBCD", 4) == 0);
+    
+    netbuf_free(buf);
+    netbuf_free(shared);
+}
+
+/* 独立的测试池：每页 4 块，不影响全局尺寸级别 */
+#define NETBUF_TEST_POOL_BUF    (PAGE_SIZE / 4)
+
+/**
+ * 测试池耗尽
+ * 不可补充的池分配完后返回 NULL，并计入失败次数
+ */
+TEST_CASE(test_netbuf_pool_exhaustion) {
+    netbuf_pool_t pool;
+    ASSERT_EQ(0, netbuf_pool_init(&pool, NETBUF_TEST_POOL_BUF, 4, 4));
+    ASSERT_EQ_UINT(4, atomic_read(&pool.count));
+    
+    netbuf_t *bufs[4];
+    for (int i = 0; i < 4; i++) {
+        bufs[i] = netbuf_pool_alloc(&pool);
+        ASSERT_NOT_NULL(bufs[i]);
+        ASSERT_EQ_PTR(&pool, bufs[i]->block->pool);
+    }
+    ASSERT_EQ_UINT(0, atomic_read(&pool.free_count));
+    
+    ASSERT_NULL(netbuf_pool_alloc(&pool));
+    ASSERT_EQ_UINT(1, (uint32_t)pool.alloc_failures);
+    ASSERT_EQ_UINT(4, (uint32_t)pool.allocs);
+    
+    // 有缓冲区未归还时不能销毁
+    ASSERT_EQ(-1, netbuf_pool_destroy(&pool));
+    
+    for (int i = 0; i < 4; i++) {
+        netbuf_free(bufs[i]);
+    }
+    ASSERT_EQ(0, netbuf_pool_destroy(&pool));
+}
+
+/**
+ * 测试 netbuf_free() 归还到池
+ * 归还的块回到空闲栈，下一次分配复用它
+ */
+TEST_CASE(test_netbuf_pool_free_returns) {
+    netbuf_pool_t pool;
+    ASSERT_EQ(0, netbuf_pool_init(&pool, NETBUF_TEST_POOL_BUF, 4, 4));
+    
+    netbuf_t *buf = netbuf_pool_alloc(&pool);
+    ASSERT_NOT_NULL(buf);
+    netbuf_block_t *block = buf->block;
+    ASSERT_EQ_UINT(3, atomic_read(&pool.free_count));
+    
+    // 共享者仍持有引用时不归还
+    netbuf_t *shared = netbuf_share(buf);
+    ASSERT_NOT_NULL(shared);
+    netbuf_free(buf);
+    ASSERT_EQ_UINT(3, atomic_read(&pool.free_count));
+    netbuf_free(shared);
+    ASSERT_EQ_UINT(4, atomic_read(&pool.free_count));
+    
+    buf = netbuf_pool_alloc(&pool);
+    ASSERT_NOT_NULL(buf);
+    ASSERT_EQ_PTR(block, buf->block);
+    ASSERT_EQ_UINT(0, buf->len);
+    netbuf_free(buf);
+    
+    ASSERT_EQ(0, netbuf_pool_destroy(&pool));
+}
+
+/**
+ * 测试补充不超过 capacity
+ * 空闲数低于水位线时补充，达到容量后分配失败，refill 不再增加块
+ */
+TEST_CASE(test_netbuf_pool_growth_limit) {
+    netbuf_pool_t pool;
+    ASSERT_EQ(0, netbuf_pool_init(&pool, NETBUF_TEST_POOL_BUF, 4, 8));
+    ASSERT_EQ_UINT(4, atomic_read(&pool.count));
+    
+    netbuf_t *bufs[8];
+    for (int i = 0; i < 8; i++) {
+        bufs[i] = netbuf_pool_alloc(&pool);
+        ASSERT_NOT_NULL(bufs[i]);
+    }
+    ASSERT_EQ_UINT(8, atomic_read(&pool.count));
+    
+    ASSERT_NULL(netbuf_pool_alloc(&pool));
+    ASSERT_EQ_UINT(0, netbuf_pool_refill(&pool));
+    ASSERT_EQ_UINT(8, atomic_read(&pool.count));
+    
+    for (int i = 0; i < 8; i++) {
+        netbuf_free(bufs[i]);
+    }
+    ASSERT_EQ_UINT(8, atomic_read(&pool.free_count));
+    ASSERT_EQ(0, netbuf_pool_destroy(&pool));
+}
+
+/**
+ * 测试 min_free 记录历史最低空闲数
+ * 归还后空闲数恢复，min_free 保持最低值
+ */
+TEST_CASE(test_netbuf_pool_min_free) {
+    netbuf_pool_t pool;
+    ASSERT_EQ(0, netbuf_pool_init(&pool, NETBUF_TEST_POOL_BUF, 4, 4));
+    ASSERT_EQ_UINT(4, pool.min_free);
+    
+    netbuf_t *a = netbuf_pool_alloc(&pool);
+    netbuf_t *b = netbuf_pool_alloc(&pool);
+    netbuf_t *c = netbuf_pool_alloc(&pool);
+    ASSERT_NOT_NULL(a);
+    ASSERT_NOT_NULL(b);
+    ASSERT_NOT_NULL(c);
+    ASSERT_EQ_UINT(1, pool.min_free);
+    
+    netbuf_free(a);
+    netbuf_free(b);
+    netbuf_free(c);
+    ASSERT_EQ_UINT(4, atomic_read(&pool.free_count));
+    ASSERT_EQ_UINT(1, pool.min_free);
+    
+    // 回到更高水平后再分配一次不会抬高 min_free
+    netbuf_free(netbuf_pool_alloc(&pool));
+    ASSERT_EQ_UINT(1, pool.min_free);
+    
+    ASSERT_EQ(0, netbuf_pool_destroy(&pool));
+}
+
+/**
+ * 测试非法池参数被拒绝
+ */
+TEST_CASE(test_netbuf_pool_init_invalid) {
+    netbuf_pool_t pool;
+    // 不整除页大小、不超过 headroom、capacity < initial、initial 为 0
+    ASSERT_EQ(-1, netbuf_pool_init(&pool, 1000, 4, 4));
+    ASSERT_EQ(-1, netbuf_pool_init(&pool, NETBUF_HEADROOM, 4, 4));
+    ASSERT_EQ(-1, netbuf_pool_init(&pool, NETBUF_TEST_POOL_BUF, 8, 4));
+    ASSERT_EQ(-1, netbuf_pool_init(&pool, NETBUF_TEST_POOL_BUF, 0, 4));
+    ASSERT_NULL(netbuf_pool_alloc(NULL));
+}
+
+// ============================================================================
+// 测试用例：页分片
+// ============================================================================
+
+/**
+ * 测试分片挂载与线性化
+ */
+TEST_CASE(test_netbuf_frag_linearize) {
+    paddr_t page = pmm_alloc_frame();
+    ASSERT_TRUE(page != PADDR_INVALID);
+    uint8_t *page_virt = (uint8_t *)PHYS_TO_VIRT((uintptr_t)page);
+    memcpy(page_virt + 100, "payload", 7);
+    
+    netbuf_t *buf = netbuf_alloc(256);
+    ASSERT_NOT_NULL(buf);
+    memcpy(netbuf_put(buf, 3), "hdr", 3);
+    
+    ASSERT_EQ(0, netbuf_add_frag(buf, page, 100, 7));
+    ASSERT_EQ_UINT(1, buf->nr_frags);
+    ASSERT_EQ_UINT(3, buf->len);
+    ASSERT_EQ_UINT(10, netbuf_total_len(buf));
+    ASSERT_EQ_PTR(page_virt + 100, netbuf_frag_addr(&buf->frags[0]));
+    
+    ASSERT_EQ(0, netbuf_linearize(buf));
+    ASSERT_EQ_UINT(0, buf->nr_frags);
+    ASSERT_EQ_UINT(10, buf->len);
+    ASSERT_TRUE(memcmp(buf->data, "hdrpayload", 10) == 0);
+    
+    netbuf_free(buf);
+    pmm_free_frame(page);
+}
+
+/**
+ * 测试 tailroom 不足时线性化换到更大的数据块
+ */
+TEST_CASE(test_netbuf_frag_linearize_grow) {
+    paddr_t page = pmm_alloc_frame();
+    ASSERT_TRUE(page != PADDR_INVALID);
+    uint8_t *page_virt = (uint8_t *)PHYS_TO_VIRT((uintptr_t)page);
+    memset(page_virt, 0x5A, 1400);
+    
+    // 只够放协议头的小缓冲区，分片比 tailroom 大
+    netbuf_t *buf = netbuf_alloc(20);
+    ASSERT_NOT_NULL(buf);
+    memcpy(netbuf_put(buf, 3), "hdr", 3);
+    uint32_t data_off = (uint32_t)(buf->data - buf->head);
+    ASSERT_EQ(0, netbuf_add_frag(buf, page, 0, 1400));
+    ASSERT_TRUE(netbuf_tailroom(buf) < 1400);
+    
+    ASSERT_EQ(0, netbuf_linearize(buf));
+    ASSERT_EQ_UINT(0, buf->nr_frags);
+    ASSERT_EQ_UINT(1403, buf->len);
+    ASSERT_EQ_UINT(data_off, (uint32_t)(buf->data - buf->head));
+    ASSERT_TRUE(memcmp(buf->data, "hdr", 3) == 0);
+    ASSERT_EQ_UINT(0x5A, buf->data[3]);
+    ASSERT_EQ_UINT(0x5A, buf->data[1402]);
+    
+    netbuf_free(buf);
+    pmm_free_frame(page);
+}
+
+/**
+ * 测试非法分片被拒绝
+ */
+TEST_CASE(test_netbuf_frag_invalid) {
+    netbuf_t *buf = netbuf_alloc(64);
+    ASSERT_NOT_NULL(buf);
+    
+    // 跨页、零长度、未对齐页地址
+    ASSERT_EQ(-1, netbuf_add_frag(buf, 0x100000, PAGE_SIZE - 4, 8));
+    ASSERT_EQ(-1, netbuf_add_frag(buf, 0x100000, 0, 0));
+    ASSERT_EQ(-1, netbuf_add_frag(buf, 0x100010, 0, 8));
+    ASSERT_EQ(-1, netbuf_add_frag(NULL, 0x100000, 0, 8));
+    ASSERT_EQ_UINT(0, buf->nr_frags);
+    
+    netbuf_free(buf);
+}
+
+
 // ============================================================================
 // 测试套件定义
 // ============================================================================
@@ -662,6 +955,23 @@ TEST_SUITE(netbuf_data_tests) {
     RUN_TEST(test_netbuf_packet_parse);
 }
 
+TEST_SUITE(netbuf_pool_tests) {
+    RUN_TEST(test_netbuf_pool_recycle);
+    RUN_TEST(test_netbuf_share_basic);
+    RUN_TEST(test_netbuf_unshare);
+    RUN_TEST(test_netbuf_pool_exhaustion);
+    RUN_TEST(test_netbuf_pool_free_returns);
+    RUN_TEST(test_netbuf_pool_growth_limit);
+    RUN_TEST(test_netbuf_pool_min_free);
+    RUN_TEST(test_netbuf_pool_init_invalid);
+}
+
+TEST_SUITE(netbuf_frag_tests) {
+    RUN_TEST(test_netbuf_frag_linearize);
+    RUN_TEST(test_netbuf_frag_linearize_grow);
+    RUN_TEST(test_netbuf_frag_invalid);
+}
+
 // ============================================================================
 // 运行所有测试
 // ============================================================================
@@ -680,6 +990,8 @@ void run_netbuf_tests(void) {
     RUN_SUITE(netbuf_reset_tests);
     RUN_SUITE(netbuf_room_tests);
     RUN_SUITE(netbuf_data_tests);
+    RUN_SUITE(netbuf_pool_tests);
+    RUN_SUITE(netbuf_frag_tests);
     
     // 打印测试摘要
     unittest_print_summary();
@@ -43,10 +43,18 @@
 #define F_GETLK     5           // 获取记录锁
 #define F_SETLK     6           // 设置记录锁（非阻塞）
 #define F_SETLKW    7           // 设置记录锁（阻塞）
+#define F_SETPIPE_SZ 1031       // 设置管道缓冲区大小（最大 1 MB）
+#define F_GETPIPE_SZ 1032       // 获取管道缓冲区大小
 
 // 文件描述符标志
 #define FD_CLOEXEC  1           // exec 时关闭
 
+// splice() 标志（兼容保留，内核忽略）
+#define SPLICE_F_MOVE       0x01
+#define SPLICE_F_NONBLOCK   0x02
+#define SPLICE_F_MORE       0x04
+#define SPLICE_F_GIFT       0x08
+
 // ============================================================================
 // 文件模式（权限）
 // ============================================================================
@@ -96,5 +104,29 @@ int fcntl(int fd, int cmd, ...);
  */
 int creat(const char *pathname, mode_t mode);
 
+struct iovec;
+
+/**
+ * @brief 在管道和文件之间搬运数据（一端必须是管道）
+ * @param fd_in 源文件描述符
+ * @param off_in 源偏移（NULL 使用文件偏移；管道必须为 NULL）
+ * @param fd_out 目标文件描述符
+ * @param off_out 目标偏移（同上）
+ * @param len 最多搬运的字节数
+ * @param flags SPLICE_F_*
+ * @return 搬运的字节数，0 表示源已到末尾，-1 失败
+ */
+ssize_t splice(int fd_in, off_t *off_in, int fd_out, off_t *off_out, size_t len, unsigned int flags);
+
+/**
+ * @brief 把用户内存直接写入管道
+ * @param fd 管道写端
+ * @param iov 分段数组
+ * @param nr_segs 分段数
+ * @param flags SPLICE_F_*
+ * @return 写入的字节数，-1 失败
+ */
+ssize_t vmsplice(int fd, const struct iovec *iov, size_t nr_segs, unsigned int flags);
+
 #endif // _FCNTL_H_
 
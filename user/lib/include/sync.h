@@ -0,0 +1,73 @@
+/**
+ * @file sync.h
+ * @brief 基于 futex 的互斥锁与条件变量
+ * 
+ * 无竞争时加锁和解锁各只有一条原子指令，不进入内核；只有需要睡眠或
+ * 唤醒等待者时才调用 futex。对象可以静态初始化，也可以放在共享内存中。
+ */
+
+#ifndef _SYNC_H_
+#define _SYNC_H_
+
+#include <types.h>
+
+// ============================================================================
+// 互斥锁
+// ============================================================================
+
+/* state：0 未锁定，1 已锁定无等待者，2 已锁定且可能有等待者 */
+typedef struct {
+    volatile uint32_t state;
+} mutex_t;
+
+#define MUTEX_INITIALIZER   { 0 }
+
+void mutex_init(mutex_t *m);
+void mutex_lock(mutex_t *m);
+
+/**
+ * @brief 尝试加锁
+ * @return 0 成功，-EBUSY 已被持有
+ */
+int mutex_trylock(mutex_t *m);
+void mutex_unlock(mutex_t *m);
+
+// ============================================================================
+// 条件变量
+// ============================================================================
+
+typedef struct {
+    volatile uint32_t seq;          // 每次 signal/broadcast 加一
+    volatile uint32_t waiters;      // 等待者数，无人等待时不进入内核
+    mutex_t *mutex;                 // 等待者使用的互斥锁（broadcast 迁移目标）
+} cond_t;
+
+#define COND_INITIALIZER    { 0, 0, NULL }
+
+void cond_init(cond_t *c);
+
+/**
+ * @brief 释放 m 并等待，返回前重新获得 m
+ * 
+ * 与 POSIX 一样可能虚假唤醒，调用者应在循环中检查条件。
+ */
+void cond_wait(cond_t *c, mutex_t *m);
+
+/**
+ * @brief 带超时的 cond_wait
+ * @param timeout 相对超时
+ * @return 0 被唤醒（或虚假唤醒），-ETIMEDOUT 超时；返回时都已重新获得 m
+ */
+int cond_timedwait(cond_t *c, mutex_t *m, const struct timespec *timeout);
+
+void cond_signal(cond_t *c);
+
+/**
+ * @brief 唤醒全部等待者
+ * 
+ * 只唤醒一个，其余直接迁移到互斥锁上等待，由解锁依次唤醒，
+ * 避免所有等待者同时醒来争抢同一把锁。
+ */
+void cond_broadcast(cond_t *c);
+
+#endif // _SYNC_H_
@@ -0,0 +1,75 @@
+/**
+ * @file sys/epoll.h
+ * @brief epoll 事件通知
+ * 
+ * 接口与 Linux 兼容。CastorOS 的 socket 描述符与文件描述符是两个独立的
+ * 编号空间，监视 socket 时在 op 中加上 EPOLL_CTL_SOCK。
+ */
+
+#ifndef _SYS_EPOLL_H_
+#define _SYS_EPOLL_H_
+
+#include <types.h>
+
+// ============================================================================
+// 事件与操作
+// ============================================================================
+
+#define EPOLLIN         0x0001      // 有数据可读
+#define EPOLLPRI        0x0002      // 有紧急数据
+#define EPOLLOUT        0x0004      // 可以写入
+#define EPOLLERR        0x0008      // 错误（总是报告）
+#define EPOLLHUP        0x0010      // 挂断（总是报告）
+#define EPOLLRDHUP      0x2000      // 对端关闭写方向
+#define EPOLLONESHOT    (1U << 30)  // 报告一次后停止监视
+#define EPOLLET         (1U << 31)  // 边沿触发
+
+#define EPOLL_CTL_ADD   1
+#define EPOLL_CTL_DEL   2
+#define EPOLL_CTL_MOD   3
+#define EPOLL_CTL_SOCK  0x100       // fd 为 socket 描述符
+
+typedef union epoll_data {
+    void *ptr;
+    int fd;
+    uint32_t u32;
+    uint64_t u64;
+} epoll_data_t;
+
+struct epoll_event {
+    uint32_t events;
+    epoll_data_t data;
+} __attribute__((packed));
+
+// ============================================================================
+// epoll 函数
+// ============================================================================
+
+/**
+ * @brief 创建 epoll 实例
+ * @param size 必须大于 0（不限制监视数量）
+ * @return epoll 文件描述符，-1 错误
+ */
+int epoll_create(int size);
+
+/**
+ * @brief 添加、修改或删除监视的描述符
+ * @param epfd epoll 文件描述符
+ * @param op EPOLL_CTL_ADD/MOD/DEL，socket 需或上 EPOLL_CTL_SOCK
+ * @param fd 目标描述符
+ * @param event 关注的事件和用户数据
+ * @return 0 成功，-1 错误
+ */
+int epoll_ctl(int epfd, int op, int fd, struct epoll_event *event);
+
+/**
+ * @brief 等待事件
+ * @param epfd epoll 文件描述符
+ * @param events 输出数组
+ * @param maxevents 数组长度
+ * @param timeout 超时（毫秒），-1 无限等待
+ * @return 就绪事件数，0 超时，-1 错误
+ */
+int epoll_wait(int epfd, struct epoll_event *events, int maxevents, int timeout);
+
+#endif // _SYS_EPOLL_H_
@@ -0,0 +1,33 @@
+/**
+ * @file sys/futex.h
+ * @brief 快速用户态互斥
+ * 
+ * 接口与 Linux futex(2) 的 WAIT/WAKE/REQUEUE 兼容。内核按物理地址散列
+ * 等待者，FUTEX_PRIVATE_FLAG 被接受但不改变行为。一般不直接使用，
+ * 见 <sync.h> 中的互斥锁和条件变量。
+ */
+
+#ifndef _SYS_FUTEX_H_
+#define _SYS_FUTEX_H_
+
+#include <types.h>
+
+#define FUTEX_WAIT          0
+#define FUTEX_WAKE          1
+#define FUTEX_REQUEUE       3
+#define FUTEX_PRIVATE_FLAG  128
+
+/**
+ * @brief futex 操作
+ * @param uaddr futex 字地址（4 字节对齐）
+ * @param op FUTEX_WAIT / FUTEX_WAKE / FUTEX_REQUEUE
+ * @param val WAIT：期望值；WAKE/REQUEUE：最多唤醒数
+ * @param timeout WAIT：超时（NULL 不超时）；REQUEUE：强制转换的最多迁移数
+ * @param uaddr2 REQUEUE 的目标 futex 字
+ * @return WAIT 成功返回 0，WAKE/REQUEUE 返回任务数；
+ *         失败返回负的错误码（-EAGAIN、-ETIMEDOUT、-EFAULT、-EINVAL）
+ */
+int futex(uint32_t *uaddr, int op, uint32_t val,
+          const struct timespec *timeout, uint32_t *uaddr2);
+
+#endif // _SYS_FUTEX_H_
@@ -0,0 +1,36 @@
+/**
+ * @file sys/sendfile.h
+ * @brief 在内核中把文件数据发送到另一个描述符
+ * 
+ * CastorOS 的 socket 描述符与文件描述符是两个独立的编号空间，
+ * 发送到 socket 时使用 sendfile_socket()。
+ */
+
+#ifndef _SYS_SENDFILE_H_
+#define _SYS_SENDFILE_H_
+
+#include <types.h>
+
+#define SENDFILE_F_SOCK 0x01    // out_fd 为 socket 描述符
+
+/**
+ * @brief 把 in_fd 的数据复制到 out_fd（文件或管道）
+ * @param out_fd 目标文件描述符
+ * @param in_fd 源文件描述符
+ * @param offset 源偏移（NULL 使用并更新文件偏移，否则更新 *offset）
+ * @param count 最多复制的字节数
+ * @return 复制的字节数，-1 失败
+ */
+ssize_t sendfile(int out_fd, int in_fd, off_t *offset, size_t count);
+
+/**
+ * @brief 把 in_fd 的数据发送到已连接的 TCP socket
+ * @param sockfd socket 描述符
+ * @param in_fd 源文件描述符（文件或管道）
+ * @param offset 源偏移（同 sendfile）
+ * @param count 最多发送的字节数
+ * @return 发送的字节数，-1 失败
+ */
+ssize_t sendfile_socket(int sockfd, int in_fd, off_t *offset, size_t count);
+
+#endif // _SYS_SENDFILE_H_
@@ -43,6 +43,7 @@ enum {
     SYS_GETPPID         = 0x0005,
     SYS_SCHED_YIELD     = 0x0006,
     SYS_CLONE           = 0x0007,
+    SYS_FUTEX           = 0x0008,  // 快速用户态互斥（WAIT/WAKE/REQUEUE）
 
     // -------------------- 文件与文件系统 (0x01xx) --------------------
     SYS_OPEN            = 0x0100,
@@ -64,6 +65,13 @@ enum {
     SYS_DUP             = 0x0110,
     SYS_DUP2            = 0x0111,
     SYS_IOCTL           = 0x0112,
+    SYS_EPOLL_CREATE    = 0x0113,
+    SYS_EPOLL_CTL       = 0x0114,
+    SYS_EPOLL_WAIT      = 0x0115,
+    SYS_SPLICE          = 0x0116,
+    SYS_SENDFILE        = 0x0117,
+    SYS_VMSPLICE        = 0x0118,
+    SYS_GETDENTS64      = 0x0119,
 
     // -------------------- 内存管理 (0x02xx) --------------------
     SYS_BRK             = 0x0200,
@@ -0,0 +1,18 @@
+/**
+ * @file sys/uio.h
+ * @brief 分散/聚集 I/O 向量
+ */
+
+#ifndef _SYS_UIO_H_
+#define _SYS_UIO_H_
+
+#include <types.h>
+
+#define UIO_MAXIOV  1024        // 单次调用最多的分段数
+
+struct iovec {
+    void *iov_base;             // 起始地址
+    size_t iov_len;             // 长度
+};
+
+#endif // _SYS_UIO_H_
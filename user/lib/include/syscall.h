@@ -44,6 +44,7 @@ int wait(int *wstatus);
 // 目录操作
 int mkdir(const char *path, uint32_t mode);
 int getdents(int fd, uint32_t index, struct dirent *dirent);
+int getdents64(int fd, void *buf, uint32_t count);   // 返回写入字节数，0 表示末尾
 int stat(const char *path, struct stat *buf);
 int fstat(int fd, struct stat *buf);
 int rename(const char *oldpath, const char *newpath);
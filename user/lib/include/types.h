@@ -83,6 +83,15 @@ struct dirent {
     char     d_name[256];
 };
 
+// getdents64 返回的变长记录，按 d_reclen 前进到下一项
+struct dirent64 {
+    uint64_t d_ino;
+    int64_t  d_off;
+    uint16_t d_reclen;
+    uint8_t  d_type;
+    char     d_name[];
+};
+
 #define WNOHANG    1
 #define WUNTRACED  2
 
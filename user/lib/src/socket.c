@@ -96,7 +96,7 @@ int select(int nfds, fd_set *readfds, fd_set *writefds,
 
 int fcntl(int fd, int cmd, ...) {
     int arg = 0;
-    if (cmd == F_SETFL || cmd == F_SETFD || cmd == F_DUPFD) {
+    if (cmd == F_SETFL || cmd == F_SETFD || cmd == F_DUPFD || cmd == F_SETPIPE_SZ) {
         __builtin_va_list ap;
         __builtin_va_start(ap, cmd);
         arg = __builtin_va_arg(ap, int);
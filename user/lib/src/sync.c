@@ -0,0 +1,105 @@
+/**
+ * @file sync.c
+ * @brief 基于 futex 的互斥锁与条件变量
+ * 
+ * 互斥锁采用三态算法（Drepper, "Futexes Are Tricky"）：解锁时只有
+ * 状态为 2 才调用 FUTEX_WAKE，因此无竞争路径完全在用户态完成。
+ */
+
+#include <sync.h>
+#include <sys/futex.h>
+#include <errno.h>
+
+#define FUTEX_NR_ALL    0x7FFFFFFF
+
+// ============================================================================
+// 互斥锁
+// ============================================================================
+
+void mutex_init(mutex_t *m) {
+    __atomic_store_n(&m->state, 0, __ATOMIC_RELEASE);
+}
+
+int mutex_trylock(mutex_t *m) {
+    uint32_t expected = 0;
+    if (__atomic_compare_exchange_n(&m->state, &expected, 1, false,
+                                    __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+        return 0;
+    }
+    return -EBUSY;
+}
+
+/* 按"可能有等待者"加锁：从条件变量醒来的任务也用它，保证解锁会唤醒下一个 */
+static void mutex_lock_contended(mutex_t *m) {
+    while (__atomic_exchange_n(&m->state, 2, __ATOMIC_ACQUIRE) != 0) {
+        futex((uint32_t *)&m->state, FUTEX_WAIT, 2, NULL, NULL);
+    }
+}
+
+void mutex_lock(mutex_t *m) {
+    uint32_t expected = 0;
+    if (__atomic_compare_exchange_n(&m->state, &expected, 1, false,
+                                    __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+        return;
+    }
+    mutex_lock_contended(m);
+}
+
+void mutex_unlock(mutex_t *m) {
+    if (__atomic_fetch_sub(&m->state, 1, __ATOMIC_RELEASE) != 1) {
+        // 原状态为 2：可能有人在等
+        __atomic_store_n(&m->state, 0, __ATOMIC_RELEASE);
+        futex((uint32_t *)&m->state, FUTEX_WAKE, 1, NULL, NULL);
+    }
+}
+
+// ============================================================================
+// 条件变量
+// ============================================================================
+
+void cond_init(cond_t *c) {
+    c->mutex = NULL;
+    __atomic_store_n(&c->waiters, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&c->seq, 0, __ATOMIC_RELEASE);
+}
+
+int cond_timedwait(cond_t *c, mutex_t *m, const struct timespec *timeout) {
+    c->mutex = m;
+    __atomic_fetch_add(&c->waiters, 1, __ATOMIC_SEQ_CST);
+    uint32_t seq = __atomic_load_n(&c->seq, __ATOMIC_SEQ_CST);
+
+    mutex_unlock(m);
+    // seq 在解锁后被改变时内核返回 -EAGAIN，不会丢失唤醒
+    int ret = futex((uint32_t *)&c->seq, FUTEX_WAIT, seq, timeout, NULL);
+    mutex_lock_contended(m);
+
+    __atomic_fetch_sub(&c->waiters, 1, __ATOMIC_RELAXED);
+    return ret == -ETIMEDOUT ? -ETIMEDOUT : 0;
+}
+
+void cond_wait(cond_t *c, mutex_t *m) {
+    (void)cond_timedwait(c, m, NULL);
+}
+
+void cond_signal(cond_t *c) {
+    __atomic_fetch_add(&c->seq, 1, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&c->waiters, __ATOMIC_SEQ_CST) != 0) {
+        futex((uint32_t *)&c->seq, FUTEX_WAKE, 1, NULL, NULL);
+    }
+}
+
+void cond_broadcast(cond_t *c) {
+    __atomic_fetch_add(&c->seq, 1, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&c->waiters, __ATOMIC_SEQ_CST) == 0) {
+        return;
+    }
+
+    mutex_t *m = c->mutex;
+    if (m == NULL) {
+        futex((uint32_t *)&c->seq, FUTEX_WAKE, FUTEX_NR_ALL, NULL, NULL);
+        return;
+    }
+    // 被唤醒的那个以状态 2 重新加锁，之后每次解锁都会唤醒下一个迁移过去的等待者
+    futex((uint32_t *)&c->seq, FUTEX_REQUEUE, 1,
+          (const struct timespec *)(uintptr_t)FUTEX_NR_ALL, (uint32_t *)&m->state);
+}
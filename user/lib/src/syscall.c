@@ -14,6 +14,10 @@
 #include <sys/syscall.h>
 #include <unistd.h>
 #include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/sendfile.h>
+#include <sys/uio.h>
+#include <sys/futex.h>
 #include <string.h>
 
 /* 简化的指针转换宏 */
@@ -57,6 +61,12 @@ int wait(int *wstatus) {
     return waitpid(-1, wstatus, 0);
 }
 
+int futex(uint32_t *uaddr, int op, uint32_t val,
+          const struct timespec *timeout, uint32_t *uaddr2) {
+    return (int)syscall5(SYS_FUTEX, PTR_TO_ARG(uaddr), (syscall_arg_t)op, (syscall_arg_t)val,
+                         PTR_TO_ARG(timeout), PTR_TO_ARG(uaddr2));
+}
+
 // ============================================================================
 // 文件系统
 // ============================================================================
@@ -122,6 +132,11 @@ int getdents(int fd, uint32_t index, struct dirent *dirent) {
                          (syscall_arg_t)index, PTR_TO_ARG(dirent));
 }
 
+int getdents64(int fd, void *buf, uint32_t count) {
+    return (int)syscall3(SYS_GETDENTS64, (syscall_arg_t)fd, 
+                         PTR_TO_ARG(buf), (syscall_arg_t)count);
+}
+
 int stat(const char *path, struct stat *buf) {
     return (int)syscall2(SYS_STAT, PTR_TO_ARG(path), PTR_TO_ARG(buf));
 }
@@ -156,6 +171,42 @@ int ioctl(int fd, unsigned long request, ...) {
                          (syscall_arg_t)request, PTR_TO_ARG(argp));
 }
 
+int epoll_create(int size) {
+    return (int)syscall1(SYS_EPOLL_CREATE, (syscall_arg_t)size);
+}
+
+int epoll_ctl(int epfd, int op, int fd, struct epoll_event *event) {
+    return (int)syscall4(SYS_EPOLL_CTL, (syscall_arg_t)epfd, (syscall_arg_t)op,
+                         (syscall_arg_t)fd, PTR_TO_ARG(event));
+}
+
+int epoll_wait(int epfd, struct epoll_event *events, int maxevents, int timeout) {
+    return (int)syscall4(SYS_EPOLL_WAIT, (syscall_arg_t)epfd, PTR_TO_ARG(events),
+                         (syscall_arg_t)maxevents, (syscall_arg_t)timeout);
+}
+
+ssize_t splice(int fd_in, off_t *off_in, int fd_out, off_t *off_out, size_t len, unsigned int flags) {
+    (void)flags;
+    return (ssize_t)syscall5(SYS_SPLICE, (syscall_arg_t)fd_in, PTR_TO_ARG(off_in),
+                             (syscall_arg_t)fd_out, PTR_TO_ARG(off_out), (syscall_arg_t)len);
+}
+
+ssize_t vmsplice(int fd, const struct iovec *iov, size_t nr_segs, unsigned int flags) {
+    (void)flags;
+    return (ssize_t)syscall3(SYS_VMSPLICE, (syscall_arg_t)fd, PTR_TO_ARG(iov),
+                             (syscall_arg_t)nr_segs);
+}
+
+ssize_t sendfile(int out_fd, int in_fd, off_t *offset, size_t count) {
+    return (ssize_t)syscall5(SYS_SENDFILE, (syscall_arg_t)out_fd, (syscall_arg_t)in_fd,
+                             PTR_TO_ARG(offset), (syscall_arg_t)count, 0);
+}
+
+ssize_t sendfile_socket(int sockfd, int in_fd, off_t *offset, size_t count) {
+    return (ssize_t)syscall5(SYS_SENDFILE, (syscall_arg_t)sockfd, (syscall_arg_t)in_fd,
+                             PTR_TO_ARG(offset), (syscall_arg_t)count, SENDFILE_F_SOCK);
+}
+
 int rename(const char *oldpath, const char *newpath) {
     return (int)syscall2(SYS_RENAME, PTR_TO_ARG(oldpath), PTR_TO_ARG(newpath));
 }
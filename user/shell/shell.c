@@ -550,6 +550,7 @@ static int cmd_history(int argc, char **argv);
 static int cmd_uname(int argc, char **argv);
 static int cmd_uptime(int argc, char **argv);
 static int cmd_date(int argc, char **argv);
+static int cmd_dmesg(int argc, char **argv);
 static int cmd_free(int argc, char **argv);
 static int cmd_ps(int argc, char **argv);
 static int cmd_reboot(int argc, char **argv);
@@ -621,6 +622,7 @@ static const shell_command_t commands[] = {
     {"uname",    "Print system information",       "uname [-a]",        cmd_uname},
     {"uptime",   "Show system uptime",             "uptime",            cmd_uptime},
     {"date",     "Display current date and time",  "date",              cmd_date},
+    {"dmesg",    "Show kernel log buffer",         "dmesg [-l debug|info|warn|err]", cmd_dmesg},
     
     // 内存管理命令
     {"free",     "Display memory usage",           "free",              cmd_free},
@@ -943,6 +945,75 @@ static int cmd_date(int argc, char **argv) {
     return 0;
 }
 
+/**
+ * dmesg 命令 - 显示内核日志环（/proc/kmsg）
+ * 每行形如 "<级别>[秒.毫秒] 消息"，级别为 syslog 编号（越小越严重）
+ * -l 只显示指定等级及更严重的记录
+ */
+#define DMESG_LINE_MAX  256
+
+static void dmesg_print_line(const char *line, int max_level) {
+    int level = 6;
+    if (line[0] == '<' && isdigit((unsigned char)line[1]) && line[2] == '>') {
+        level = line[1] - '0';
+        line += 3;
+    }
+    if (level <= max_level) {
+        printf("%s\n", line);
+    }
+}
+
+static int cmd_dmesg(int argc, char **argv) {
+    int max_level = 7;
+    if (argc == 3 && strcmp(argv[1], "-l") == 0) {
+        if (strcmp(argv[2], "debug") == 0) {
+            max_level = 7;
+        } else if (strcmp(argv[2], "info") == 0) {
+            max_level = 6;
+        } else if (strcmp(argv[2], "warn") == 0) {
+            max_level = 4;
+        } else if (strcmp(argv[2], "err") == 0) {
+            max_level = 3;
+        } else {
+            printf("dmesg: unknown level '%s'\n", argv[2]);
+            return -1;
+        }
+    } else if (argc != 1) {
+        printf("Usage: dmesg [-l debug|info|warn|err]\n");
+        return -1;
+    }
+
+    int fd = open("/proc/kmsg", O_RDONLY, 0);
+    if (fd < 0) {
+        printf("Error: Failed to open /proc/kmsg\n");
+        return -1;
+    }
+
+    // 日志内容较大，按块读取后拼成行
+    static char buffer[2048];
+    char line[DMESG_LINE_MAX];
+    size_t len = 0;
+    int bytes_read;
+    while ((bytes_read = read(fd, buffer, sizeof(buffer))) > 0) {
+        for (int i = 0; i < bytes_read; i++) {
+            if (buffer[i] == '\n') {
+                line[len] = '\0';
+                dmesg_print_line(line, max_level);
+                len = 0;
+            } else if (len < sizeof(line) - 1) {
+                line[len++] = buffer[i];
+            }
+        }
+    }
+    if (len > 0) {
+        line[len] = '\0';
+        dmesg_print_line(line, max_level);
+    }
+
+    close(fd);
+    return 0;
+}
+
 /**
  * free 命令 - 显示内存使用情况（紧凑格式）
  * 输出同时发送到屏幕和串口
@@ -1583,30 +1654,34 @@ static int cmd_ls(int argc, char **argv) {
     printf("Directory: %s\n", path);
     printf("================================================================================\n");
     
-    // 读取目录项
-    struct dirent entry;
-    uint32_t index = 0;
+    // 批量读取目录项：每次系统调用填满缓冲区，内核从上次的位置继续
+    static char dirbuf[2048] __attribute__((aligned(8)));
     int count = 0;
+    int nread;
     
-    while (getdents(fd, index, &entry) == 0) {
-        // 根据文件类型设置颜色和显示格式
-        if (entry.d_type == DT_DIR) {
-            printf("%-20s <DIR>\n", entry.d_name);
-        } else if (entry.d_type == DT_REG) {
-            // 对于常规文件，尝试获取文件大小
-            // 注意：这里简化处理，不获取文件大小
-            printf("%-20s\n", entry.d_name);
-        } else if (entry.d_type == DT_CHR) {
-            printf("%-20s <CHR>\n", entry.d_name);
-        } else if (entry.d_type == DT_BLK) {
-            printf("%-20s <BLK>\n", entry.d_name);
-        } else if (entry.d_type == DT_LNK) {
-            printf("%-20s <LNK>\n", entry.d_name);
-        } else {
-            printf("%-20s\n", entry.d_name);
+    while ((nread = getdents64(fd, dirbuf, sizeof(dirbuf))) > 0) {
+        for (int pos = 0; pos < nread; ) {
+            struct dirent64 *entry = (struct dirent64 *)(dirbuf + pos);
+            
+            // 根据文件类型设置颜色和显示格式
+            if (entry->d_type == DT_DIR) {
+                printf("%-20s <DIR>\n", entry->d_name);
+            } else if (entry->d_type == DT_REG) {
+                // 对于常规文件，尝试获取文件大小
+                // 注意：这里简化处理，不获取文件大小
+                printf("%-20s\n", entry->d_name);
+            } else if (entry->d_type == DT_CHR) {
+                printf("%-20s <CHR>\n", entry->d_name);
+            } else if (entry->d_type == DT_BLK) {
+                printf("%-20s <BLK>\n", entry->d_name);
+            } else if (entry->d_type == DT_LNK) {
+                printf("%-20s <LNK>\n", entry->d_name);
+            } else {
+                printf("%-20s\n", entry->d_name);
+            }
+            count++;
+            pos += entry->d_reclen;
         }
-        count++;
-        index++;
     }
     
     if (count == 0) {
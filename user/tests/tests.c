@@ -4,6 +4,9 @@
 #include <syscall.h>
 #include <stdio.h>
 #include <types.h>
+#include <errno.h>
+#include <sync.h>
+#include <sys/futex.h>
 
 // 辅助函数：获取文件类型字符串
 static const char *get_file_type(uint32_t mode) {
@@ -311,6 +314,87 @@ static void test_mmap(void) {
     printf("\n[Summary] mmap/munmap tests completed\n");
 }
 
+// 读取周期计数器（用于基准测试）
+static uint64_t read_cycles(void) {
+#if defined(ARCH_ARM64)
+    uint64_t cnt;
+    __asm__ volatile("mrs %0, cntvct_el0" : "=r"(cnt));
+    return cnt;
+#else
+    uint32_t lo, hi;
+    __asm__ volatile("rdtsc" : "=a"(lo), "=d"(hi));
+    return ((uint64_t)hi << 32) | lo;
+#endif
+}
+
+#define FUTEX_BENCH_ITERATIONS  100000
+
+// 测试 futex 及基于它的互斥锁/条件变量
+static void test_futex(void) {
+    printf("\n=== Testing futex() / mutex / cond ===\n");
+
+    static uint32_t word = 0;
+    static mutex_t m = MUTEX_INITIALIZER;
+    static cond_t c = COND_INITIALIZER;
+
+    // 测试 1: 值不匹配时立即返回
+    printf("\n[1] FUTEX_WAIT with stale value:\n");
+    int ret = futex(&word, FUTEX_WAIT, 1, NULL, NULL);
+    printf("  %s: returned %d (expected %d)\n", ret == -EAGAIN ? "OK" : "Error", ret, -EAGAIN);
+
+    // 测试 2: 超时
+    printf("\n[2] FUTEX_WAIT timeout (20 ms):\n");
+    struct timespec ts = { 0, 20 * 1000000 };
+    ret = futex(&word, FUTEX_WAIT, 0, &ts, NULL);
+    printf("  %s: returned %d (expected %d)\n", ret == -ETIMEDOUT ? "OK" : "Error", ret, -ETIMEDOUT);
+
+    // 测试 3: 无等待者时唤醒
+    printf("\n[3] FUTEX_WAKE with no waiters:\n");
+    ret = futex(&word, FUTEX_WAKE, 1, NULL, NULL);
+    printf("  %s: woke %d\n", ret == 0 ? "OK" : "Error", ret);
+
+    // 测试 4: 互斥锁状态
+    printf("\n[4] mutex trylock:\n");
+    mutex_lock(&m);
+    ret = mutex_trylock(&m);
+    printf("  %s: trylock on held mutex returned %d\n", ret == -EBUSY ? "OK" : "Error", ret);
+    mutex_unlock(&m);
+    ret = mutex_trylock(&m);
+    printf("  %s: trylock on free mutex returned %d\n", ret == 0 ? "OK" : "Error", ret);
+    mutex_unlock(&m);
+
+    // 测试 5: 条件变量超时后重新持有互斥锁
+    printf("\n[5] cond_timedwait timeout (20 ms):\n");
+    mutex_lock(&m);
+    ret = cond_timedwait(&c, &m, &ts);
+    printf("  %s: returned %d, mutex state %u\n",
+           (ret == -ETIMEDOUT && m.state != 0) ? "OK" : "Error", ret, m.state);
+    mutex_unlock(&m);
+
+    // 测试 6: 基准测试（无竞争路径完全在用户态，对比一次进入内核的开销）
+    printf("\n[6] Benchmark (%u iterations):\n", FUTEX_BENCH_ITERATIONS);
+    uint64_t t0 = read_cycles();
+    for (uint32_t i = 0; i < FUTEX_BENCH_ITERATIONS; i++) {
+        mutex_lock(&m);
+        mutex_unlock(&m);
+    }
+    uint64_t t1 = read_cycles();
+    for (uint32_t i = 0; i < FUTEX_BENCH_ITERATIONS; i++) {
+        cond_signal(&c);
+    }
+    uint64_t t2 = read_cycles();
+    for (uint32_t i = 0; i < FUTEX_BENCH_ITERATIONS; i++) {
+        futex(&word, FUTEX_WAKE, 1, NULL, NULL);
+    }
+    uint64_t t3 = read_cycles();
+    printf("  mutex lock+unlock:   %u cycles/op\n", (uint32_t)((t1 - t0) / FUTEX_BENCH_ITERATIONS));
+    printf("  cond_signal (idle):  %u cycles/op\n", (uint32_t)((t2 - t1) / FUTEX_BENCH_ITERATIONS));
+    printf("  futex WAKE syscall:  %u cycles/op\n", (uint32_t)((t3 - t2) / FUTEX_BENCH_ITERATIONS));
+    printf("  (contended cost is measured by the kernel futex test)\n");
+
+    printf("\n[Summary] futex tests completed\n");
+}
+
 // 主函数
 void _start(void) {
     printf("========================================\n");
@@ -328,6 +412,9 @@ void _start(void) {
     // 运行 mmap/munmap 测试
     test_mmap();
     
+    // 运行 futex 测试
+    test_futex();
+    
     printf("\n========================================\n");
     printf("    All tests completed!\n");
     printf("========================================\n");